@@ -0,0 +1,94 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------------
+// Type Alias
+//--------------------------------------------------------------------------------------------------------
+using BenchClock = std::chrono::steady_clock;
+
+
+//--------------------------------------------------------------------------------------------------------
+//	 milliseconds between two time points
+//--------------------------------------------------------------------------------------------------------
+inline double ElapsedMs(BenchClock::time_point begin, BenchClock::time_point end)
+{
+	return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 unsigned argument at index or the default value
+//--------------------------------------------------------------------------------------------------------
+inline uint32_t ArgU32(int argc, char** argv, int index, uint32_t defaultValue)
+{
+	return (index < argc) ? static_cast<uint32_t>(strtoul(argv[index], nullptr, 10)) : defaultValue;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 one line per check, MISMATCH when it fails
+//--------------------------------------------------------------------------------------------------------
+inline bool Check(const char* name, bool passed)
+{
+	printf("  %-52s %s\n", name, passed ? "ok" : "MISMATCH");
+	return passed;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 median of the samples (sorts them)
+//--------------------------------------------------------------------------------------------------------
+inline double Median(std::vector<double>& samples)
+{
+	std::sort(samples.begin(), samples.end());
+	return samples[samples.size() / 2];
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 nearest-rank percentile of sorted values, 0 when there are none
+//--------------------------------------------------------------------------------------------------------
+inline double Percentile(const std::vector<double>& sorted, double fraction)
+{
+	if (sorted.empty())
+	{
+		return 0.0;
+	}
+	size_t index = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+	return sorted[std::min(std::max(index, size_t(1)), sorted.size()) - 1];
+}
+
+
+//--------------------------------------------------------------------------------------------------------
+// Benchmarks (argv[0] is the benchmark name)
+//--------------------------------------------------------------------------------------------------------
+int RunArchiveBenchmark(int argc, char** argv);
+int RunBarriersBenchmark(int argc, char** argv);
+int RunBvhBenchmark(int argc, char** argv);
+int RunCullingBenchmark(int argc, char** argv);
+int RunDeferredReleaseBenchmark(int argc, char** argv);
+int RunDescriptorsBenchmark(int argc, char** argv);
+int RunDrawSortBenchmark(int argc, char** argv);
+int RunFrameBenchmark(int argc, char** argv);
+int RunFrameTimelineBenchmark(int argc, char** argv);
+int RunGpuMemoryBenchmark(int argc, char** argv);
+int RunMeshLoadBenchmark(int argc, char** argv);
+int RunMeshOptBenchmark(int argc, char** argv);
+int RunPipelineCacheBenchmark(int argc, char** argv);
+int RunProfilerBenchmark(int argc, char** argv);
+int RunRecordingBenchmark(int argc, char** argv);
+int RunRenderGraphBenchmark(int argc, char** argv);
+int RunRasterBenchmark(int argc, char** argv);
+int RunShaderStoreBenchmark(int argc, char** argv);
+int RunStreamingBenchmark(int argc, char** argv);
+int RunTransformBenchmark(int argc, char** argv);
+int RunUploadRingBenchmark(int argc, char** argv);
+int RunUploadsBenchmark(int argc, char** argv);
+int RunVertexFormatBenchmark(int argc, char** argv);
@@ -0,0 +1,439 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <AssetArchive.h>
+#include <AssetStreamer.h>
+#include <Lz4Codec.h>
+#include <MeshFile.h>
+#include <ShaderTypes.h>
+#include <WorkerPool.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultAssetCount = 256; // files of the set
+	const uint32_t DefaultAverageKB = 256; // average size of a file
+	const uint32_t TextureInterval = 4; // every 4th asset is block-compressed texels, which LZ4 doesn't shrink
+	const uint32_t IterationCount = 7; // passes measured per variant
+	const uint32_t StreamTimeoutMs = 5000; // longest wait for the streamer check
+
+	//----------------------------------------------------------------------------------------------------
+	// whole file into memory (what loading a loose asset costs)
+	//----------------------------------------------------------------------------------------------------
+	bool ReadFile(const std::string& path, std::vector<uint8_t>& data)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			return false;
+		}
+
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0, std::ios::beg);
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())));
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// write data as a file
+	//----------------------------------------------------------------------------------------------------
+	bool WriteFile(const std::string& path, const std::vector<uint8_t>& data)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		return static_cast<bool>(file.flush());
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// sum of every 8th byte, makes sure the contents were at hand
+	//----------------------------------------------------------------------------------------------------
+	uint64_t Touch(const uint8_t* pData, size_t size)
+	{
+		uint64_t sum = 0;
+		for (size_t i = 0; i < size; i += 8)
+		{
+			sum += pData[i];
+		}
+		return sum;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// random bytes (stand in for block-compressed texels)
+	//----------------------------------------------------------------------------------------------------
+	void FillRandom(std::vector<uint8_t>& data, uint32_t& seed)
+	{
+		for (uint8_t& byte : data)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			byte = static_cast<uint8_t>(seed >> 24);
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// contents of a mesh file of about the size in KB (a wavy strip of colored vertices)
+	//----------------------------------------------------------------------------------------------------
+	bool BuildMesh(const std::string& path, uint32_t sizeKB, std::vector<uint8_t>& data)
+	{
+		// 28 bytes per vertex and about 3 indices of 4 bytes
+		uint32_t vertexCount = std::max(sizeKB * 1024 / 40, 3u);
+		std::vector<Vertex> vertices(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; ++i)
+		{
+			float t = static_cast<float>(i % 256) / 256.f;
+			vertices[i].Position = DirectX::XMFLOAT3(static_cast<float>(i / 2), static_cast<float>(i & 1), t);
+			vertices[i].Color = DirectX::XMFLOAT4(t, 1.f - t, 0.5f, 1.f);
+		}
+
+		std::vector<uint32_t> indices;
+		indices.reserve(size_t(vertexCount - 2) * 3);
+		for (uint32_t i = 0; i + 2 < vertexCount; ++i)
+		{
+			uint32_t triangle[] = { i, i + 1, i + 2 };
+			indices.insert(indices.end(), triangle, triangle + 3);
+		}
+
+		MeshFileSubmesh submesh = {};
+		submesh.IndexCount = static_cast<uint32_t>(indices.size());
+		submesh.BoundsMax[0] = static_cast<float>(vertexCount / 2);
+		submesh.BoundsMax[1] = submesh.BoundsMax[2] = 1.f;
+
+		MeshFileDesc desc = {};
+		desc.VertexCount = vertexCount;
+		desc.StreamCount = 1;
+		desc.pStreams[0] = vertices.data();
+		desc.Strides[0] = sizeof(Vertex);
+		desc.Layouts[0] = MeshVertexLayout::PositionColor;
+		desc.pIndices = indices.data();
+		desc.IndexCount = submesh.IndexCount;
+		desc.IndexFormat = GfxFormat::R32_Uint;
+		desc.pSubmeshes = &submesh;
+		desc.SubmeshCount = 1;
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			desc.BoundsMax[i] = submesh.BoundsMax[i];
+		}
+		return MeshFile::Write(path.c_str(), desc) && ReadFile(path, data);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// LZ4 blocks of awkward inputs decompress to the input, damaged blocks are rejected
+	//----------------------------------------------------------------------------------------------------
+	bool RunCodecChecks()
+	{
+		// empty, shorter than a match may start, runs with periods below 8 bytes, random and long literal runs
+		uint32_t seed = 7u;
+		std::vector<std::vector<uint8_t>> inputs;
+		std::vector<bool> repetitive;
+		for (size_t size : { size_t(0), size_t(1), size_t(12), size_t(13), size_t(100) })
+		{
+			inputs.emplace_back(size, static_cast<uint8_t>('a'));
+			repetitive.push_back(false);
+		}
+		for (uint32_t period : { 1u, 3u, 7u, 8u, 13u })
+		{
+			inputs.emplace_back(70000);
+			repetitive.push_back(true);
+			for (size_t i = 0; i < inputs.back().size(); ++i)
+			{
+				inputs.back()[i] = static_cast<uint8_t>(i % period);
+			}
+		}
+		inputs.emplace_back(100000);
+		repetitive.push_back(false);
+		FillRandom(inputs.back(), seed);
+		inputs.emplace_back(AssetArchiveChunkSize);
+		repetitive.push_back(false);
+		FillRandom(inputs.back(), seed);
+		memset(inputs.back().data() + 1000, 0, 20000);
+
+		Lz4Codec codec;
+		bool roundTrip = true;
+		bool shrunk = true;
+		std::vector<uint8_t> block;
+		std::vector<uint8_t> output;
+		for (size_t i = 0; i < inputs.size(); ++i)
+		{
+			const std::vector<uint8_t>& input = inputs[i];
+			block.resize(Lz4Codec::GetCompressBound(input.size()));
+			size_t size = codec.Compress(input.data(), input.size(), block.data(), block.size());
+			output.assign(input.size() + 1, 0xcd);
+			roundTrip &= size > 0 && Lz4Codec::Decompress(block.data(), size, output.data(), input.size())
+				&& std::equal(input.begin(), input.end(), output.begin()) && output[input.size()] == 0xcd;
+			shrunk &= !repetitive[i] || size < input.size() / 16;
+		}
+		bool passed = Check("lz4 blocks round trip", roundTrip && shrunk);
+
+		// every truncation and a wrong size of a repetitive block fail without touching memory beyond the output
+		const std::vector<uint8_t>& input = inputs[6];
+		block.resize(Lz4Codec::GetCompressBound(input.size()));
+		size_t size = codec.Compress(input.data(), input.size(), block.data(), block.size());
+		bool rejected = !Lz4Codec::Decompress(block.data(), size, output.data(), input.size() - 1)
+			&& !Lz4Codec::Decompress(block.data(), size, output.data(), input.size() + 1);
+		for (size_t cut = 0; cut < size; ++cut)
+		{
+			rejected &= !Lz4Codec::Decompress(block.data(), cut, output.data(), input.size());
+		}
+
+		// a block too small for the output makes Compress() give up
+		rejected &= codec.Compress(inputs.back().data(), inputs.back().size(), block.data(), 100) == 0;
+		passed &= Check("damaged lz4 blocks rejected", rejected);
+		return passed;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// lookups, contents, placement and the streamer reading from the archive
+	//----------------------------------------------------------------------------------------------------
+	bool RunArchiveChecks(const std::filesystem::path& directory, const std::vector<std::string>& paths,
+		const std::vector<std::vector<uint8_t>>& contents, const std::string& archivePath, WorkerPool& pool)
+	{
+		AssetArchive archive;
+		if (!Check("archive opens", archive.Open(archivePath.c_str())))
+		{
+			return false;
+		}
+
+		// meshes compress, texels don't and stay in place
+		bool found = archive.GetEntryCount() == paths.size();
+		bool placed = true;
+		std::vector<uint8_t> serial;
+		std::vector<uint8_t> parallel;
+		bool intact = true;
+		for (size_t i = 0; i < paths.size(); ++i)
+		{
+			const AssetArchiveEntry* pEntry = archive.Find(paths[i].c_str());
+			found &= pEntry != nullptr;
+			if (pEntry == nullptr)
+			{
+				continue;
+			}
+
+			bool texture = (i % TextureInterval) == TextureInterval - 1;
+			const uint8_t* pData = archive.GetData(*pEntry);
+			placed &= texture ? (pData != nullptr && (reinterpret_cast<uintptr_t>(pData) % AssetArchiveAlignment) == 0) : (pData == nullptr);
+			intact &= archive.Read(*pEntry, serial) && archive.Read(*pEntry, parallel, &pool) && serial == contents[i] && parallel == contents[i];
+		}
+
+		std::string backslashes = paths[0];
+		std::replace(backslashes.begin(), backslashes.end(), '/', '\\');
+		found &= archive.Find(backslashes.c_str()) == archive.Find(paths[0].c_str()) && archive.Find("missing/asset.bin") == nullptr;
+		bool passed = Check("every path found, missing ones not", found);
+		passed &= Check("texels stored aligned, meshes compressed", placed);
+		passed &= Check("contents intact (serial and parallel chunks)", intact);
+
+		// a truncated archive or a damaged table doesn't open
+		std::vector<uint8_t> file;
+		ReadFile(archivePath, file);
+		std::string damagedPath = (directory / "Damaged.bin").string();
+		std::vector<uint8_t> truncated(file.begin(), file.begin() + file.size() / 2);
+		WriteFile(damagedPath, truncated);
+		bool refused = !archive.Open(damagedPath.c_str());
+		std::vector<uint8_t> damaged = file;
+		reinterpret_cast<AssetArchiveEntry*>(damaged.data() + reinterpret_cast<const AssetArchiveHeader*>(damaged.data())->EntriesOffset)->ChunkCount += 1;
+		WriteFile(damagedPath, damaged);
+		refused &= !archive.Open(damagedPath.c_str());
+		passed &= Check("damaged archives refused", refused);
+
+		// assets missing as loose files arrive from the archive
+		archive.Open(archivePath.c_str());
+		AssetStreamer streamer;
+		streamer.SetArchive(&archive);
+		streamer.Init(1);
+		uint32_t handle = streamer.Request(paths[0].c_str(), AssetType::Mesh, 1.f);
+		bool delivered = false;
+		BenchClock::time_point end = BenchClock::now() + std::chrono::milliseconds(StreamTimeoutMs);
+		while (!delivered && BenchClock::now() < end)
+		{
+			streamer.Update(0, [&](StreamedAsset& asset) { delivered = asset.Handle == handle && asset.Succeeded && asset.Data == contents[0]; });
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		streamer.Term();
+		passed &= Check("streamer reads archived assets", delivered);
+		return passed;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 codec and archive checks, then read throughput of loose files against the archive
+//--------------------------------------------------------------------------------------------------------
+int RunArchiveBenchmark(int argc, char** argv)
+{
+	uint32_t assetCount = std::max(ArgU32(argc, argv, 1, DefaultAssetCount), TextureInterval);
+	uint32_t averageKB = std::max(ArgU32(argc, argv, 2, DefaultAverageKB), 1u);
+
+	printf("archive: codec checks\n");
+	int result = RunCodecChecks() ? 0 : 1;
+
+	std::error_code error;
+	std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "ReLearnD3D12_archive";
+	std::filesystem::remove_all(directory, error);
+	std::filesystem::create_directories(directory / "assets", error);
+
+	// meshes between half and one and a half times the average size, every 4th asset random texels
+	std::vector<std::string> paths(assetCount);
+	std::vector<std::string> loosePaths(assetCount);
+	std::vector<std::vector<uint8_t>> contents(assetCount);
+	std::vector<AssetArchiveSource> sources(assetCount);
+	uint64_t looseSize = 0;
+	uint32_t seed = 12345u;
+	for (uint32_t i = 0; i < assetCount; ++i)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		uint32_t sizeKB = averageKB / 2 + (seed >> 8) % averageKB + 1;
+		bool texture = (i % TextureInterval) == TextureInterval - 1;
+		paths[i] = "assets/" + std::to_string(i) + (texture ? ".dds" : ".mesh");
+		loosePaths[i] = (directory / paths[i]).string();
+
+		bool written = true;
+		if (texture)
+		{
+			contents[i].resize(size_t(sizeKB) * 1024);
+			FillRandom(contents[i], seed);
+			written = WriteFile(loosePaths[i], contents[i]);
+		}
+		else
+		{
+			written = BuildMesh(loosePaths[i], sizeKB, contents[i]);
+		}
+		if (!written)
+		{
+			printf("archive: cannot write %s\n", loosePaths[i].c_str());
+			return 1;
+		}
+
+		sources[i] = { paths[i].c_str(), contents[i].data(), contents[i].size(), true };
+		looseSize += contents[i].size();
+	}
+
+	// the same set packed with compression and stored only
+	WorkerPool pool;
+	pool.Init(WorkerPool::GetHardwareWorkerCount());
+	std::string packedPath = (directory / "Assets.bin").string();
+	std::string storedPath = (directory / "Stored.bin").string();
+	auto begin = BenchClock::now();
+	bool written = AssetArchive::Write(packedPath.c_str(), sources.data(), assetCount, &pool);
+	double packMs = ElapsedMs(begin, BenchClock::now());
+	for (AssetArchiveSource& source : sources)
+	{
+		source.Compress = false;
+	}
+	written &= AssetArchive::Write(storedPath.c_str(), sources.data(), assetCount);
+	if (!written)
+	{
+		printf("archive: cannot write the archives\n");
+		return 1;
+	}
+	uint64_t packedSize = std::filesystem::file_size(packedPath, error);
+	uint64_t storedSize = std::filesystem::file_size(storedPath, error);
+
+	printf("archive: archive checks\n");
+	result |= RunArchiveChecks(directory, paths, contents, packedPath, pool) ? 0 : 1;
+
+	printf("archive: %u assets, %.1f MB loose, %.1f MB packed (%.1f%%, %.1f ms to pack on %u workers), %.1f MB stored\n",
+		assetCount, double(looseSize) / (1024.0 * 1024.0), double(packedSize) / (1024.0 * 1024.0), 100.0 * packedSize / looseSize,
+		packMs, pool.GetWorkerCount(), double(storedSize) / (1024.0 * 1024.0));
+
+	// lookups by path in the table at the front of the mapping
+	{
+		AssetArchive archive;
+		begin = BenchClock::now();
+		archive.Open(packedPath.c_str());
+		double openMs = ElapsedMs(begin, BenchClock::now());
+
+		uint32_t found = 0;
+		begin = BenchClock::now();
+		for (uint32_t pass = 0; pass < IterationCount; ++pass)
+		{
+			for (const std::string& path : paths)
+			{
+				found += (archive.Find(path.c_str()) != nullptr) ? 1 : 0;
+			}
+		}
+		double findMs = ElapsedMs(begin, BenchClock::now());
+		printf("archive: open %.3f ms, %.1f ns per lookup%s\n", openMs, findMs * 1e6 / (double(IterationCount) * assetCount),
+			(found == IterationCount * assetCount) ? "" : "  MISMATCH");
+		result |= (found == IterationCount * assetCount) ? 0 : 1;
+	}
+
+	// every variant ends with the contents of every asset at hand and sums them (the page cache is warm for all
+	// of them, reads from a cold drive favor the packed archive by its smaller size)
+	enum Variant { Loose, StoredCopy, StoredInPlace, Packed, PackedParallel, VariantCount };
+	static const char* const VariantNames[] = { "loose files", "stored copy", "stored in place", "packed", "packed parallel" };
+	std::vector<double> samples[VariantCount];
+	std::vector<uint8_t> data;
+	uint64_t sink = 0;
+	for (uint32_t i = 0; i <= IterationCount; ++i)
+	{
+		for (uint32_t variant = 0; variant < VariantCount; ++variant)
+		{
+			begin = BenchClock::now();
+			AssetArchive archive;
+			bool match = (variant == Loose) || archive.Open((variant == Packed || variant == PackedParallel) ? packedPath.c_str() : storedPath.c_str());
+			for (uint32_t a = 0; a < assetCount && match; ++a)
+			{
+				const uint8_t* pData = nullptr;
+				const AssetArchiveEntry* pEntry = (variant != Loose) ? archive.Find(paths[a].c_str()) : nullptr;
+				if (variant == Loose)
+				{
+					match &= ReadFile(loosePaths[a], data);
+					pData = data.data();
+				}
+				else if (variant == StoredInPlace)
+				{
+					match &= pEntry != nullptr;
+					pData = match ? archive.GetData(*pEntry) : nullptr;
+					match &= pData != nullptr;
+				}
+				else
+				{
+					match &= pEntry != nullptr && archive.Read(*pEntry, data, (variant == PackedParallel) ? &pool : nullptr);
+					pData = data.data();
+				}
+
+				if (match)
+				{
+					sink += Touch(pData, contents[a].size());
+					match &= (i > 0) || memcmp(pData, contents[a].data(), contents[a].size()) == 0;
+				}
+			}
+			double ms = ElapsedMs(begin, BenchClock::now());
+
+			if (i > 0)
+			{
+				samples[variant].push_back(ms);
+			}
+			result |= match ? 0 : 1;
+		}
+	}
+
+	uint64_t sizes[] = { looseSize, storedSize, storedSize, packedSize, packedSize };
+	printf("%16s %10s %10s %10s %10s\n", "variant", "disk MB", "ms", "MB/s", "speedup");
+	double looseMs = Median(samples[Loose]);
+	for (uint32_t variant = 0; variant < VariantCount; ++variant)
+	{
+		double ms = Median(samples[variant]);
+		printf("%16s %10.1f %10.3f %10.1f %9.2fx\n", VariantNames[variant], double(sizes[variant]) / (1024.0 * 1024.0), ms,
+			(ms > 0.0) ? double(looseSize) / (1024.0 * 1024.0) / (ms / 1000.0) : 0.0, (ms > 0.0) ? looseMs / ms : 0.0);
+	}
+
+	// keeps the reads and sums from being optimized away
+	if (sink == 1)
+	{
+		printf("\n");
+	}
+
+	pool.Term();
+	std::filesystem::remove_all(directory, error);
+	return result;
+}
@@ -0,0 +1,292 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <CommandListPool.h>
+#include <RecordingDevice.h>
+#include <ResourceStateTracker.h>
+#include <WorkerPool.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultTransitionCount = 1000000; // transitions of the timed part
+	const uint32_t DefaultResourceCount = 64; // resources the timed transitions cycle through
+	const uint32_t TransitionsPerDraw = 4; // transitions between two flushes of the timed part
+	const uint32_t TextureSubresources = 4; // subresources of the texture of the checks
+	const uint32_t ListCount = 4; // command lists of the pool checks
+
+	const GfxResourceState CycleStates[] = {
+		GfxResourceState::RenderTarget,
+		GfxResourceState::GenericRead,
+		GfxResourceState::VertexAndConstantBuffer, // covered by GenericRead, dropped
+		GfxResourceState::CopyDest,
+		GfxResourceState::CopyDest, // redundant, dropped
+		GfxResourceState::CopySource,
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// whether a barrier has the expected contents
+	//----------------------------------------------------------------------------------------------------
+	bool IsBarrier(const GfxResourceBarrier& barrier, GfxResource* pResource, uint32_t subresource, GfxResourceState before, GfxResourceState after, GfxResourceBarrierFlags flags = GfxResourceBarrierFlags::None)
+	{
+		return barrier.pResource == pResource && barrier.Subresource == subresource
+			&& barrier.StateBefore == before && barrier.StateAfter == after && barrier.Flags == flags;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// resolution rules of a single tracker and of the committed states
+	//----------------------------------------------------------------------------------------------------
+	bool RunChecks(GfxDevice& device, GfxCommandList* pCmdList)
+	{
+		GfxBufferDesc desc = { 256, GfxHeapType::Default, GfxResourceState::Common };
+		GfxPtr<GfxResource> pBuffer;
+		GfxPtr<GfxResource> pOther;
+		GfxPtr<GfxResource> pTexture;
+		if (!device.CreateBuffer(desc, pBuffer) || !device.CreateBuffer(desc, pOther) || !device.CreateBuffer(desc, pTexture))
+		{
+			return false;
+		}
+
+		ResourceStates states;
+		states.Register(pBuffer.get(), GfxResourceState::Present);
+		states.Register(pOther.get(), GfxResourceState::GenericRead);
+		states.Register(pTexture.get(), GfxResourceState::Common, TextureSubresources);
+
+		ResourceStateTracker tracker;
+		const std::vector<GfxResourceBarrier>& queued = tracker.GetQueuedBarriers();
+		bool passed = true;
+
+		// the first list starts from the committed states, a repeated transition is dropped
+		tracker.Reset(&states, true);
+		tracker.Transition(pBuffer.get(), GfxResourceState::RenderTarget);
+		tracker.Transition(pBuffer.get(), GfxResourceState::RenderTarget);
+		passed &= Check("known first use, redundant transition dropped",
+			queued.size() == 1 && IsBarrier(queued[0], pBuffer.get(), GfxAllSubresources, GfxResourceState::Present, GfxResourceState::RenderTarget)
+			&& tracker.GetStats().ElidedCount == 1 && tracker.GetPendingBarriers().empty());
+
+		// transitions queued twice before a flush become one, there and back cancels out
+		tracker.Transition(pBuffer.get(), GfxResourceState::CopySource);
+		bool merged = queued.size() == 1 && IsBarrier(queued[0], pBuffer.get(), GfxAllSubresources, GfxResourceState::Present, GfxResourceState::CopySource);
+		tracker.Transition(pBuffer.get(), GfxResourceState::Present);
+		passed &= Check("queued transitions merged, round trip cancelled", merged && queued.empty());
+
+		// a read state covers the read states it is made of
+		tracker.Transition(pOther.get(), GfxResourceState::VertexAndConstantBuffer);
+		tracker.Transition(pOther.get(), GfxResourceState::IndexBuffer);
+		passed &= Check("read states covered by GenericRead", queued.empty() && tracker.GetStats().ElidedCount == 6);
+
+		// several barriers go out with a single call
+		tracker.Transition(pBuffer.get(), GfxResourceState::CopyDest);
+		tracker.Transition(pOther.get(), GfxResourceState::CopyDest);
+		tracker.FlushBarriers(pCmdList);
+		passed &= Check("one call per flush", queued.empty() && tracker.GetStats().BarrierCount == 2 && tracker.GetStats().BatchCount == 1);
+
+		// subresources diverge, a transition of the whole resource then needs one barrier per subresource
+		tracker.Transition(pTexture.get(), GfxResourceState::RenderTarget, 1);
+		tracker.FlushBarriers(pCmdList);
+		tracker.Transition(pTexture.get(), GfxResourceState::CopySource);
+		bool perSubresource = queued.size() == TextureSubresources
+			&& IsBarrier(queued[0], pTexture.get(), 0, GfxResourceState::Common, GfxResourceState::CopySource)
+			&& IsBarrier(queued[1], pTexture.get(), 1, GfxResourceState::RenderTarget, GfxResourceState::CopySource);
+		tracker.FlushBarriers(pCmdList);
+		tracker.Transition(pTexture.get(), GfxResourceState::CopyDest);
+		passed &= Check("subresources apart, then together again", perSubresource && queued.size() == 1
+			&& IsBarrier(queued[0], pTexture.get(), GfxAllSubresources, GfxResourceState::CopySource, GfxResourceState::CopyDest));
+		tracker.FlushBarriers(pCmdList);
+
+		// split barriers are begun and ended, a transition to the target ends them
+		tracker.BeginTransition(pBuffer.get(), GfxResourceState::GenericRead);
+		bool begun = queued.size() == 1 && IsBarrier(queued[0], pBuffer.get(), GfxAllSubresources, GfxResourceState::CopyDest, GfxResourceState::GenericRead, GfxResourceBarrierFlags::BeginOnly);
+		tracker.FlushBarriers(pCmdList);
+		tracker.Transition(pBuffer.get(), GfxResourceState::GenericRead);
+		passed &= Check("split barrier begun and ended", begun && queued.size() == 1
+			&& IsBarrier(queued[0], pBuffer.get(), GfxAllSubresources, GfxResourceState::CopyDest, GfxResourceState::GenericRead, GfxResourceBarrierFlags::EndOnly));
+		tracker.FlushBarriers(pCmdList);
+
+		// the first list commits what it left behind
+		std::vector<GfxResourceBarrier> fixups;
+		states.Resolve(tracker, fixups);
+		GfxResourceState buffer = GfxResourceState::Common;
+		GfxResourceState texture = GfxResourceState::Common;
+		passed &= Check("first list commits its final states", fixups.empty()
+			&& states.GetState(pBuffer.get(), GfxAllSubresources, buffer) && buffer == GfxResourceState::GenericRead
+			&& states.GetState(pTexture.get(), 3, texture) && texture == GfxResourceState::CopyDest);
+
+		// a later list doesn't know the states, its first uses are resolved at submission
+		tracker.Reset(&states, false);
+		tracker.Transition(pBuffer.get(), GfxResourceState::GenericRead);
+		tracker.Transition(pOther.get(), GfxResourceState::RenderTarget);
+		tracker.Transition(pTexture.get(), GfxResourceState::RenderTarget, 2);
+		tracker.Transition(pOther.get(), GfxResourceState::CopySource);
+		bool pending = tracker.GetPendingBarriers().size() == 3 && queued.size() == 1;
+		tracker.FlushBarriers(pCmdList);
+		fixups.clear();
+		states.Resolve(tracker, fixups);
+		passed &= Check("pending first uses resolved at submission", pending && fixups.size() == 2
+			&& IsBarrier(fixups[0], pOther.get(), GfxAllSubresources, GfxResourceState::CopyDest, GfxResourceState::RenderTarget)
+			&& IsBarrier(fixups[1], pTexture.get(), 2, GfxResourceState::CopyDest, GfxResourceState::RenderTarget)
+			&& states.GetState(pOther.get(), GfxAllSubresources, buffer) && buffer == GfxResourceState::CopySource);
+		return passed;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// lists of a pool share a render target, one list of them also writes a buffer another list left
+	//----------------------------------------------------------------------------------------------------
+	bool RunPoolChecks(GfxDevice& device)
+	{
+		GfxBufferDesc desc = { 256, GfxHeapType::Default, GfxResourceState::Common };
+		GfxPtr<GfxResource> pTarget;
+		GfxPtr<GfxResource> pBuffer;
+		GfxPtr<GfxCommandQueue> pQueue;
+		WorkerPool workers;
+		ResourceStates states;
+		CommandListPool cmdLists;
+		if (!device.CreateBuffer(desc, pTarget) || !device.CreateBuffer(desc, pBuffer)
+			|| !device.CreateCommandQueue(GfxCommandListType::Direct, pQueue)
+			|| !workers.Init(2) || !cmdLists.Init(&device, GfxCommandListType::Direct, 1, ListCount, &states))
+		{
+			return false;
+		}
+
+		states.Register(pTarget.get(), GfxResourceState::Present);
+		states.Register(pBuffer.get(), GfxResourceState::GenericRead);
+
+		bool passed = true;
+		for (uint32_t frame = 0; frame < 2; ++frame)
+		{
+			// the second frame copies into the buffer from a list in the middle and reads it in the last list,
+			// neither list knows the state the buffer is in before it
+			cmdLists.Record(workers, 0, ListCount, [&](GfxCommandList* pCmdList, uint32_t listIndex)
+			{
+				ResourceStateTracker* pTracker = cmdLists.GetStateTracker(listIndex);
+				pTracker->Transition(pTarget.get(), GfxResourceState::RenderTarget);
+				if (frame == 1 && listIndex == 2)
+				{
+					pTracker->Transition(pBuffer.get(), GfxResourceState::CopyDest);
+				}
+				if (frame == 1 && listIndex == 3)
+				{
+					pTracker->Transition(pBuffer.get(), GfxResourceState::GenericRead);
+				}
+				pTracker->FlushBarriers(pCmdList);
+				pCmdList->DrawIndexedInstanced(6, 1, 0, 0, 0);
+				if (listIndex == ListCount - 1)
+				{
+					pTracker->Transition(pTarget.get(), GfxResourceState::Present);
+				}
+			});
+			cmdLists.Execute(pQueue.get());
+
+			const ResourceBarrierStats& stats = cmdLists.GetBarrierStats();
+			GfxResourceState target = GfxResourceState::Common;
+			GfxResourceState buffer = GfxResourceState::Common;
+			bool committed = states.GetState(pTarget.get(), GfxAllSubresources, target) && target == GfxResourceState::Present
+				&& states.GetState(pBuffer.get(), GfxAllSubresources, buffer) && buffer == GfxResourceState::GenericRead;
+			if (frame == 0)
+			{
+				passed &= Check("pool: render target shared by every list", stats.BarrierCount == 2 && stats.FixupCount == 0 && committed);
+			}
+			else
+			{
+				passed &= Check("pool: first uses in later lists fixed up", stats.BarrierCount == 4 && stats.FixupCount == 2 && committed);
+			}
+		}
+
+		workers.Term();
+		return passed;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 resolution rules of the state tracker, then transitions per second against one call per barrier
+//--------------------------------------------------------------------------------------------------------
+int RunBarriersBenchmark(int argc, char** argv)
+{
+	uint32_t transitionCount = std::max(ArgU32(argc, argv, 1, DefaultTransitionCount), 1u);
+	uint32_t resourceCount = std::max(ArgU32(argc, argv, 2, DefaultResourceCount), 1u);
+
+	RecordingDevice device;
+	GfxPtr<GfxCommandAllocator> pAllocator;
+	GfxPtr<GfxCommandList> pCmdList;
+	if (!device.CreateCommandAllocator(GfxCommandListType::Direct, pAllocator)
+		|| !device.CreateCommandList(GfxCommandListType::Direct, pAllocator.get(), pCmdList))
+	{
+		printf("barriers: cannot create the command list\n");
+		return 1;
+	}
+
+	printf("barriers: resolution checks\n");
+	bool passed = RunChecks(device, pCmdList.get());
+	pCmdList->Close();
+	passed &= RunPoolChecks(device);
+	int result = passed ? 0 : 1;
+
+	// resources cycle through states, some of the requests are redundant or covered
+	std::vector<GfxPtr<GfxResource>> pResources(resourceCount);
+	ResourceStates states;
+	GfxBufferDesc desc = { 256, GfxHeapType::Default, GfxResourceState::Common };
+	for (GfxPtr<GfxResource>& pResource : pResources)
+	{
+		if (!device.CreateBuffer(desc, pResource))
+		{
+			printf("barriers: cannot create the resources\n");
+			return 1;
+		}
+		states.Register(pResource.get(), GfxResourceState::Common);
+	}
+
+	printf("barriers: %u transitions over %u resources, flushed every %u\n", transitionCount, resourceCount, TransitionsPerDraw);
+	printf("%10s %12s %12s %12s %14s\n", "path", "barriers", "calls", "elided", "ns/transition");
+
+	// one call per requested transition, the way Render() used to build them
+	pAllocator->Reset();
+	pCmdList->Reset(pAllocator.get(), nullptr);
+	std::vector<GfxResourceState> current(resourceCount, GfxResourceState::Common);
+	const uint32_t stateCount = static_cast<uint32_t>(sizeof(CycleStates) / sizeof(CycleStates[0]));
+	auto begin = BenchClock::now();
+	for (uint32_t i = 0; i < transitionCount; ++i)
+	{
+		uint32_t resource = i % resourceCount;
+		GfxResourceBarrier barrier = { pResources[resource].get(), GfxAllSubresources, current[resource], CycleStates[(i / resourceCount) % stateCount], GfxResourceBarrierFlags::None, GfxResourceBarrierType::Transition };
+		pCmdList->ResourceBarrier(1, &barrier);
+		current[resource] = barrier.StateAfter;
+	}
+	double directMs = ElapsedMs(begin, BenchClock::now());
+	pCmdList->Close();
+	printf("%10s %12u %12u %12u %14.2f\n", "direct", transitionCount, transitionCount, 0u, directMs * 1000000.0 / transitionCount);
+
+	// the tracker drops what isn't needed and batches the rest
+	pAllocator->Reset();
+	pCmdList->Reset(pAllocator.get(), nullptr);
+	ResourceStateTracker tracker;
+	tracker.Reset(&states, true);
+	begin = BenchClock::now();
+	for (uint32_t i = 0; i < transitionCount; ++i)
+	{
+		uint32_t resource = i % resourceCount;
+		tracker.Transition(pResources[resource].get(), CycleStates[(i / resourceCount) % stateCount]);
+		if ((i + 1) % TransitionsPerDraw == 0)
+		{
+			tracker.FlushBarriers(pCmdList.get());
+		}
+	}
+	tracker.FlushBarriers(pCmdList.get());
+	double trackedMs = ElapsedMs(begin, BenchClock::now());
+	pCmdList->Close();
+
+	const ResourceBarrierStats& stats = tracker.GetStats();
+	bool match = stats.BarrierCount + stats.ElidedCount == transitionCount;
+	result |= match ? 0 : 1;
+	printf("%10s %12llu %12llu %12llu %14.2f%s\n", "tracked",
+		static_cast<unsigned long long>(stats.BarrierCount), static_cast<unsigned long long>(stats.BatchCount),
+		static_cast<unsigned long long>(stats.ElidedCount), trackedMs * 1000000.0 / transitionCount, match ? "" : "  MISMATCH");
+	return result;
+}
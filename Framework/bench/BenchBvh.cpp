@@ -0,0 +1,300 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <Bvh.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t ObjectCounts[] = { 10000, 100000, 1000000 }; // scene sizes without an argument
+	const uint32_t DefaultQueryCount = 100000; // rays and points per scene
+	const uint32_t VerifiedQueryCount = 200; // queries also answered by brute force
+	const uint32_t BuildRepeatCount = 3; // builds measured per scene
+	const float SceneSize = 400.f; // edge length of the cube the objects are scattered in
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// BvhScene structure - boxes of the synthetic scene
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct BvhScene
+	{
+		std::vector<float> CenterX, CenterY, CenterZ; // centers
+		std::vector<float> ExtentX, ExtentY, ExtentZ; // half size
+
+		BoxBounds GetBounds() const
+		{
+			return { CenterX.data(), CenterY.data(), CenterZ.data(), ExtentX.data(), ExtentY.data(), ExtentZ.data() };
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Random structure - LCG shared by the scene and the queries
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Random
+	{
+		uint32_t Seed = 12345u;
+
+		// [0, 1)
+		float Next()
+		{
+			Seed = Seed * 1664525u + 1013904223u;
+			return float(Seed >> 8) / float(1u << 24);
+		}
+
+		// [-size / 2, size / 2)
+		float Centered(float size) { return (Next() - 0.5f) * size; }
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// objects scattered in a cube with clusters, which is where the SAH pays off
+	//----------------------------------------------------------------------------------------------------
+	void BuildScene(uint32_t count, Random& random, BvhScene& scene)
+	{
+		scene = BvhScene();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			bool clustered = (i % 4) != 0;
+			float spread = clustered ? SceneSize * 0.05f : SceneSize;
+			float clusterX = clustered ? float((i / 4) % 8) * 40.f - 140.f : 0.f;
+			scene.CenterX.push_back(clusterX + random.Centered(spread));
+			scene.CenterY.push_back(random.Centered(spread));
+			scene.CenterZ.push_back(random.Centered(spread));
+			scene.ExtentX.push_back(0.25f + random.Next());
+			scene.ExtentY.push_back(0.25f + random.Next());
+			scene.ExtentZ.push_back(0.25f + random.Next());
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// same slab test as the tree, nearest box with the lower index winning ties
+	//----------------------------------------------------------------------------------------------------
+	bool RaycastBruteForce(const BvhScene& scene, const float* pOrigin, const float* pDir, float maxDistance, BvhHit& hit)
+	{
+		float invDir[3] = { 1.f / pDir[0], 1.f / pDir[1], 1.f / pDir[2] };
+		hit.Object = UINT32_MAX;
+		hit.Distance = maxDistance;
+
+		for (uint32_t i = 0; i < scene.CenterX.size(); ++i)
+		{
+			float center[3] = { scene.CenterX[i], scene.CenterY[i], scene.CenterZ[i] };
+			float extent[3] = { scene.ExtentX[i], scene.ExtentY[i], scene.ExtentZ[i] };
+
+			float tNear = 0.f;
+			float tFar = hit.Distance;
+			for (uint32_t a = 0; a < 3; ++a)
+			{
+				float t0 = ((center[a] - extent[a]) - pOrigin[a]) * invDir[a];
+				float t1 = ((center[a] + extent[a]) - pOrigin[a]) * invDir[a];
+				tNear = std::max(tNear, std::min(t0, t1));
+				tFar = std::min(tFar, std::max(t0, t1));
+			}
+
+			if (tNear <= tFar && (tNear < hit.Distance || (tNear == hit.Distance && i < hit.Object)))
+			{
+				hit.Object = i;
+				hit.Distance = tNear;
+			}
+		}
+		return hit.Object != UINT32_MAX;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// number of boxes containing the point
+	//----------------------------------------------------------------------------------------------------
+	uint32_t QueryPointBruteForce(const BvhScene& scene, const float* pPoint)
+	{
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < scene.CenterX.size(); ++i)
+		{
+			bool inside = fabsf(pPoint[0] - scene.CenterX[i]) <= scene.ExtentX[i]
+				&& fabsf(pPoint[1] - scene.CenterY[i]) <= scene.ExtentY[i]
+				&& fabsf(pPoint[2] - scene.CenterZ[i]) <= scene.ExtentZ[i];
+			count += inside ? 1 : 0;
+		}
+		return count;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// build, refit, culling and picking on one scene, returns false on a mismatch
+	//----------------------------------------------------------------------------------------------------
+	bool RunScene(uint32_t objectCount, uint32_t queryCount)
+	{
+		Random random;
+		BvhScene scene;
+		BuildScene(objectCount, random, scene);
+		BoxBounds bounds = scene.GetBounds();
+		bool match = true;
+
+		// build
+		Bvh bvh;
+		std::vector<double> samples;
+		for (uint32_t i = 0; i < BuildRepeatCount; ++i)
+		{
+			auto begin = BenchClock::now();
+			bvh.Build(bounds, objectCount);
+			auto end = BenchClock::now();
+			samples.push_back(ElapsedMs(begin, end));
+		}
+		double buildMs = Median(samples);
+		BvhStats stats = bvh.ComputeStats();
+
+		// refit after every object moved a little
+		for (uint32_t i = 0; i < objectCount; ++i)
+		{
+			scene.CenterX[i] += random.Centered(4.f);
+			scene.CenterY[i] += random.Centered(4.f);
+			scene.CenterZ[i] += random.Centered(4.f);
+		}
+		auto refitBegin = BenchClock::now();
+		bvh.Refit(bounds);
+		auto refitEnd = BenchClock::now();
+		double refitMs = ElapsedMs(refitBegin, refitEnd);
+		float refitCost = bvh.ComputeStats().SahCost;
+
+		printf("bvh: %u objects, %u nodes, depth %u, leaves of up to %u, SAH cost %.4f (%.4f after refit)\n",
+			objectCount, stats.NodeCount, stats.MaxDepth, stats.MaxLeafObjects, stats.SahCost, refitCost);
+		printf("bvh:   build %.3f ms (%.1f ns/object), refit %.3f ms (%.1f ns/object)\n",
+			buildMs, buildMs * 1e6 / objectCount, refitMs, refitMs * 1e6 / objectCount);
+
+		// frustum culling, flat against hierarchical
+		DirectX::XMMATRIX viewProj = DirectX::XMMatrixMultiply(
+			DirectX::XMMatrixLookAtRH(
+				DirectX::XMVectorSet(0.f, 0.f, 5.f, 0.f),
+				DirectX::XMVectorZero(),
+				DirectX::XMVectorSet(0.f, 1.f, 0.f, 0.f)),
+			DirectX::XMMatrixPerspectiveFovRH(DirectX::XMConvertToRadians(37.5f), 16.f / 9.f, 1.f, 1000.f));
+		Frustum frustum = FrustumCuller::ExtractFrustum(viewProj);
+
+		FrustumCuller culler;
+		std::vector<uint32_t> flat(objectCount);
+		std::vector<uint32_t> tree(objectCount);
+		uint32_t flatCount = 0;
+		uint32_t treeCount = 0;
+
+		std::vector<double> flatMs;
+		std::vector<double> treeMs;
+		for (uint32_t i = 0; i < 11; ++i)
+		{
+			auto begin = BenchClock::now();
+			flatCount = culler.CullBoxes(frustum, bounds, objectCount, flat.data());
+			auto middle = BenchClock::now();
+			treeCount = bvh.CullFrustum(frustum, tree.data());
+			auto end = BenchClock::now();
+			flatMs.push_back(ElapsedMs(begin, middle));
+			treeMs.push_back(ElapsedMs(middle, end));
+		}
+
+		std::sort(tree.begin(), tree.begin() + treeCount);
+		bool cullMatch = flatCount == treeCount && std::equal(flat.begin(), flat.begin() + flatCount, tree.begin());
+		match &= cullMatch;
+
+		double flatMedian = Median(flatMs);
+		double treeMedian = Median(treeMs);
+		printf("bvh:   culling %u visible, flat SIMD %.3f ms, tree %.3f ms (%.2fx)%s\n",
+			treeCount, flatMedian, treeMedian, (treeMedian > 0.0) ? flatMedian / treeMedian : 0.0, cullMatch ? "" : "  MISMATCH");
+
+		// rays from random points toward random points, like picking through a scene
+		std::vector<float> rays(size_t(queryCount) * 6);
+		for (float& value : rays)
+		{
+			value = random.Centered(SceneSize);
+		}
+		for (uint32_t i = 0; i < queryCount; ++i)
+		{
+			float* pRay = &rays[size_t(i) * 6];
+			pRay[3] -= pRay[0];
+			pRay[4] -= pRay[1];
+			pRay[5] -= pRay[2];
+		}
+
+		uint32_t hitCount = 0;
+		auto rayBegin = BenchClock::now();
+		for (uint32_t i = 0; i < queryCount; ++i)
+		{
+			const float* pRay = &rays[size_t(i) * 6];
+			BvhHit hit;
+			hitCount += bvh.Raycast(DirectX::XMFLOAT3(pRay[0], pRay[1], pRay[2]), DirectX::XMFLOAT3(pRay[3], pRay[4], pRay[5]), 1.f, hit) ? 1 : 0;
+		}
+		auto rayEnd = BenchClock::now();
+		double rayMs = ElapsedMs(rayBegin, rayEnd);
+
+		uint32_t verified = std::min(queryCount, VerifiedQueryCount);
+		uint32_t rayMismatches = 0;
+		auto bruteBegin = BenchClock::now();
+		for (uint32_t i = 0; i < verified; ++i)
+		{
+			const float* pRay = &rays[size_t(i) * 6];
+			BvhHit expected;
+			BvhHit hit;
+			bool expectedHit = RaycastBruteForce(scene, pRay, pRay + 3, 1.f, expected);
+			bool treeHit = bvh.Raycast(DirectX::XMFLOAT3(pRay[0], pRay[1], pRay[2]), DirectX::XMFLOAT3(pRay[3], pRay[4], pRay[5]), 1.f, hit);
+			rayMismatches += (expectedHit != treeHit || (treeHit && hit.Object != expected.Object)) ? 1 : 0;
+		}
+		auto bruteEnd = BenchClock::now();
+		double bruteRayUs = ElapsedMs(bruteBegin, bruteEnd) * 1000.0 / verified;
+		match &= (rayMismatches == 0);
+
+		printf("bvh:   raycast %.2f us/ray (%u of %u hit), brute force %.2f us/ray%s\n",
+			rayMs * 1000.0 / queryCount, hitCount, queryCount, bruteRayUs, (rayMismatches == 0) ? "" : "  MISMATCH");
+
+		// points inside the clusters
+		uint32_t containing = 0;
+		uint32_t pointMismatches = 0;
+		auto pointBegin = BenchClock::now();
+		for (uint32_t i = 0; i < queryCount; ++i)
+		{
+			const float* pPoint = &rays[size_t(i) * 6] + 3;
+			float point[3] = { pPoint[0] * 0.05f, pPoint[1] * 0.05f, pPoint[2] * 0.05f };
+			containing += bvh.QueryPoint(DirectX::XMFLOAT3(point[0], point[1], point[2]), nullptr, 0);
+		}
+		auto pointEnd = BenchClock::now();
+		double pointMs = ElapsedMs(pointBegin, pointEnd);
+
+		for (uint32_t i = 0; i < verified; ++i)
+		{
+			const float* pPoint = &rays[size_t(i) * 6] + 3;
+			float point[3] = { pPoint[0] * 0.05f, pPoint[1] * 0.05f, pPoint[2] * 0.05f };
+			uint32_t treeResult = bvh.QueryPoint(DirectX::XMFLOAT3(point[0], point[1], point[2]), nullptr, 0);
+			pointMismatches += (treeResult != QueryPointBruteForce(scene, point)) ? 1 : 0;
+		}
+		match &= (pointMismatches == 0);
+
+		printf("bvh:   point query %.2f us/point (%.2f boxes each)%s\n",
+			pointMs * 1000.0 / queryCount, double(containing) / queryCount, (pointMismatches == 0) ? "" : "  MISMATCH");
+
+		return match;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 build, refit and query throughput of the BVH on synthetic scenes
+//--------------------------------------------------------------------------------------------------------
+int RunBvhBenchmark(int argc, char** argv)
+{
+	uint32_t objectCount = ArgU32(argc, argv, 1, 0);
+	uint32_t queryCount = std::max(ArgU32(argc, argv, 2, DefaultQueryCount), 1u);
+
+	bool match = true;
+	if (objectCount > 0)
+	{
+		match &= RunScene(objectCount, queryCount);
+	}
+	else
+	{
+		for (uint32_t count : ObjectCounts)
+		{
+			match &= RunScene(count, queryCount);
+		}
+	}
+
+	return match ? 0 : 1;
+}
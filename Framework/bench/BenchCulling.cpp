@@ -0,0 +1,183 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <FrustumCuller.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t ObjectCounts[] = { 10000, 100000, 1000000 }; // scene sizes
+	const uint32_t DefaultIterationCount = 20; // iterations measured per variant
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// CullingScene structure - bounds of the synthetic scene
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct CullingScene
+	{
+		std::vector<float> CenterX, CenterY, CenterZ; // centers
+		std::vector<float> Radius; // sphere radius
+		std::vector<float> ExtentX, ExtentY, ExtentZ; // box half size
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// objects in a cube around the camera, a few percent of them end up in the frustum
+	//----------------------------------------------------------------------------------------------------
+	void BuildScene(uint32_t count, CullingScene& scene)
+	{
+		uint32_t seed = 12345u;
+		auto random = [&seed]()
+		{
+			seed = seed * 1664525u + 1013904223u;
+			return float(seed >> 8) / float(1u << 24);
+		};
+
+		scene = CullingScene();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			scene.CenterX.push_back(random() * 400.f - 200.f);
+			scene.CenterY.push_back(random() * 400.f - 200.f);
+			scene.CenterZ.push_back(random() * 400.f - 200.f);
+
+			float ex = 0.5f + random() * 2.f;
+			float ey = 0.5f + random() * 2.f;
+			float ez = 0.5f + random() * 2.f;
+			scene.ExtentX.push_back(ex);
+			scene.ExtentY.push_back(ey);
+			scene.ExtentZ.push_back(ez);
+			scene.Radius.push_back(sqrtf(ex * ex + ey * ey + ez * ez));
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// one plane at a time, straight from the definition
+	//----------------------------------------------------------------------------------------------------
+	uint32_t CullReference(const Frustum& frustum, const CullingScene& scene, bool boxes, uint32_t* pVisible)
+	{
+		uint32_t visibleCount = 0;
+		for (uint32_t i = 0; i < scene.CenterX.size(); ++i)
+		{
+			bool visible = true;
+			for (const DirectX::XMFLOAT4& plane : frustum.Planes)
+			{
+				float d = plane.x * scene.CenterX[i] + plane.y * scene.CenterY[i] + plane.z * scene.CenterZ[i] + plane.w;
+				float r = boxes
+					? fabsf(plane.x) * scene.ExtentX[i] + fabsf(plane.y) * scene.ExtentY[i] + fabsf(plane.z) * scene.ExtentZ[i]
+					: scene.Radius[i];
+				if (d + r < 0.f)
+				{
+					visible = false;
+					break;
+				}
+			}
+
+			if (visible)
+			{
+				pVisible[visibleCount++] = i;
+			}
+		}
+		return visibleCount;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 scalar reference against the SIMD culler on 1...N workers, spheres and boxes at 10k/100k/1M objects
+//--------------------------------------------------------------------------------------------------------
+int RunCullingBenchmark(int argc, char** argv)
+{
+	uint32_t maxWorkers = std::max(ArgU32(argc, argv, 1, WorkerPool::GetHardwareWorkerCount()), 1u);
+	uint32_t iterationCount = std::max(ArgU32(argc, argv, 2, DefaultIterationCount), 1u);
+
+	// camera of App::OnInit() pulled back into the scene
+	DirectX::XMMATRIX viewProj = DirectX::XMMatrixMultiply(
+		DirectX::XMMatrixLookAtRH(
+			DirectX::XMVectorSet(0.f, 0.f, 5.f, 0.f),
+			DirectX::XMVectorZero(),
+			DirectX::XMVectorSet(0.f, 1.f, 0.f, 0.f)),
+		DirectX::XMMatrixPerspectiveFovRH(DirectX::XMConvertToRadians(37.5f), 16.f / 9.f, 1.f, 1000.f));
+	Frustum frustum = FrustumCuller::ExtractFrustum(viewProj);
+
+	WorkerPool workers;
+	FrustumCuller culler;
+	CullingScene scene;
+
+	printf("culling: median of %u iterations (%u hardware threads)\n", iterationCount, WorkerPool::GetHardwareWorkerCount());
+	printf("%8s %6s %10s %8s %10s %12s %10s\n", "objects", "bounds", "variant", "visible", "ms", "ns/object", "speedup");
+
+	int result = 0;
+	for (uint32_t objectCount : ObjectCounts)
+	{
+		BuildScene(objectCount, scene);
+		SphereBounds spheres = { scene.CenterX.data(), scene.CenterY.data(), scene.CenterZ.data(), scene.Radius.data() };
+		BoxBounds boxes = { scene.CenterX.data(), scene.CenterY.data(), scene.CenterZ.data(), scene.ExtentX.data(), scene.ExtentY.data(), scene.ExtentZ.data() };
+
+		std::vector<uint32_t> expected(objectCount);
+		std::vector<uint32_t> visible(objectCount);
+
+		for (uint32_t pass = 0; pass < 2; ++pass)
+		{
+			bool useBoxes = (pass == 1);
+			const char* pBoundsName = useBoxes ? "box" : "sphere";
+
+			// warm-up run of each variant is not measured
+			std::vector<double> samples;
+			uint32_t expectedCount = 0;
+			for (uint32_t i = 0; i <= iterationCount; ++i)
+			{
+				auto begin = BenchClock::now();
+				expectedCount = CullReference(frustum, scene, useBoxes, expected.data());
+				auto end = BenchClock::now();
+				if (i > 0)
+				{
+					samples.push_back(ElapsedMs(begin, end));
+				}
+			}
+			double baseline = Median(samples);
+			printf("%8u %6s %10s %8u %10.3f %12.3f %9.2fx\n",
+				objectCount, pBoundsName, "scalar", expectedCount, baseline, baseline * 1e6 / objectCount, 1.0);
+
+			for (uint32_t workerCount = 1; workerCount <= maxWorkers; ++workerCount)
+			{
+				if (!workers.Init(workerCount))
+				{
+					return 1;
+				}
+
+				samples.clear();
+				uint32_t visibleCount = 0;
+				for (uint32_t i = 0; i <= iterationCount; ++i)
+				{
+					auto begin = BenchClock::now();
+					visibleCount = useBoxes
+						? culler.CullBoxes(frustum, boxes, objectCount, visible.data(), &workers)
+						: culler.CullSpheres(frustum, spheres, objectCount, visible.data(), &workers);
+					auto end = BenchClock::now();
+					if (i > 0)
+					{
+						samples.push_back(ElapsedMs(begin, end));
+					}
+				}
+
+				bool match = visibleCount == expectedCount && std::equal(expected.begin(), expected.begin() + visibleCount, visible.begin());
+				double ms = Median(samples);
+				char variant[16];
+				snprintf(variant, sizeof(variant), "simd x%u", workerCount);
+				printf("%8u %6s %10s %8u %10.3f %12.3f %9.2fx%s\n",
+					objectCount, pBoundsName, variant, visibleCount, ms, ms * 1e6 / objectCount,
+					(ms > 0.0) ? baseline / ms : 0.0, match ? "" : "  MISMATCH");
+
+				result |= match ? 0 : 1;
+			}
+		}
+	}
+
+	return result;
+}
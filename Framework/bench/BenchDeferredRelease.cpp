@@ -0,0 +1,160 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <DeferredReleaseQueue.h>
+#include <FrameTimeline.h>
+#include <RecordingDevice.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultFrameCount = 200; // frames measured per variant
+	const uint32_t DefaultStreamCount = 8; // buffers replaced per frame
+	const uint32_t DefaultGpuTime = 3000; // GPU time of a frame in microseconds
+	const uint32_t CpuTime = 2000; // CPU time of a frame in microseconds
+	const uint32_t FramesInFlight = 2; // frames the CPU may run ahead
+	const uint32_t ResidentCount = 64; // buffers alive at any time
+	const uint64_t BufferSize = 64 * 1024; // size of a streamed buffer
+
+	//----------------------------------------------------------------------------------------------------
+	// keep the CPU busy like recording would
+	//----------------------------------------------------------------------------------------------------
+	void Spin(uint32_t microseconds)
+	{
+		auto end = BenchClock::now() + std::chrono::microseconds(microseconds);
+		while (BenchClock::now() < end)
+		{
+			/* NOTHING */
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// StreamResult structure
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct StreamResult
+	{
+		double FrameMs; // average frame time
+		double WaitMs; // time spent waiting for the GPU (flushes and frame slots)
+		uint64_t PeakBytes; // most memory held by released buffers
+		uint64_t EarlyFrees; // items freed before the GPU was done with them
+		bool AllFreed; // whether nothing was left behind
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// replace buffers every frame, freeing the old ones after a flush or through the queue
+	//----------------------------------------------------------------------------------------------------
+	bool RunStream(bool deferred, uint32_t frameCount, uint32_t streamCount, uint32_t gpuTime, StreamResult& result)
+	{
+		RecordingDevice device;
+		device.SetGpuWorkTime(gpuTime, gpuTime / 4);
+
+		GfxPtr<GfxCommandQueue> pQueue;
+		FrameTimeline timeline;
+		DeferredReleaseQueue releases;
+		GfxBufferDesc desc = { BufferSize, GfxHeapType::Upload, GfxResourceState::GenericRead };
+		if (!device.CreateCommandQueue(GfxCommandListType::Direct, pQueue) || !timeline.Init(&device, pQueue.get(), FramesInFlight))
+		{
+			return false;
+		}
+
+		std::vector<GfxPtr<GfxResource>> buffers(ResidentCount);
+		for (GfxPtr<GfxResource>& pBuffer : buffers)
+		{
+			if (!device.CreateBuffer(desc, pBuffer))
+			{
+				return false;
+			}
+		}
+
+		result = StreamResult();
+		uint32_t next = 0;
+		auto begin = BenchClock::now();
+		for (uint32_t frame = 0; frame < frameCount; ++frame)
+		{
+			timeline.BeginFrame();
+			releases.Collect(timeline.GetCompletedValue());
+
+			// streaming updates come first, recording the frame follows
+			for (uint32_t i = 0; i < streamCount; ++i)
+			{
+				GfxPtr<GfxResource>& pBuffer = buffers[next];
+				next = (next + 1) % ResidentCount;
+
+				if (deferred)
+				{
+					// the check runs when the item is freed, the buffer goes right after it
+					uint64_t value = timeline.GetFrameValue();
+					FrameTimeline* pTimeline = &timeline;
+					uint64_t* pEarlyFrees = &result.EarlyFrees;
+					releases.Release([pTimeline, value, pEarlyFrees]() { *pEarlyFrees += (pTimeline->GetCompletedValue() < value) ? 1 : 0; }, value);
+					releases.Release(std::move(pBuffer), value, BufferSize);
+				}
+				else
+				{
+					// without the queue the only safe point is an idle GPU
+					auto flushBegin = BenchClock::now();
+					timeline.WaitIdle();
+					result.WaitMs += ElapsedMs(flushBegin, BenchClock::now());
+					pBuffer.reset();
+				}
+
+				if (!device.CreateBuffer(desc, pBuffer))
+				{
+					return false;
+				}
+			}
+
+			Spin(CpuTime);
+			pQueue->ExecuteCommandLists(0, nullptr);
+			timeline.EndFrame();
+		}
+		timeline.WaitIdle();
+		releases.Collect(timeline.GetCompletedValue());
+
+		result.FrameMs = ElapsedMs(begin, BenchClock::now()) / frameCount;
+		result.WaitMs = (result.WaitMs + timeline.GetStats().StallMs) / frameCount;
+		result.PeakBytes = releases.GetStats().PeakPendingBytes;
+		result.AllFreed = releases.GetPendingCount() == 0 && releases.GetStats().FreeCount == releases.GetStats().ReleaseCount;
+		return true;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 stream buffers in and out every frame: flush before freeing against the deferred release queue
+//--------------------------------------------------------------------------------------------------------
+int RunDeferredReleaseBenchmark(int argc, char** argv)
+{
+	uint32_t frameCount = std::max(ArgU32(argc, argv, 1, DefaultFrameCount), 1u);
+	uint32_t streamCount = std::max(ArgU32(argc, argv, 2, DefaultStreamCount), 1u);
+	uint32_t gpuTime = ArgU32(argc, argv, 3, DefaultGpuTime);
+
+	printf("deferredrelease: %u frames, %u of %u buffers (%llu KB) replaced per frame, CPU %.2f ms, GPU %.2f ms, %u frames in flight\n",
+		frameCount, streamCount, ResidentCount, static_cast<unsigned long long>(BufferSize / 1024), CpuTime / 1000.0, gpuTime / 1000.0, FramesInFlight);
+	printf("%10s %10s %12s %12s %12s\n", "variant", "frame ms", "GPU wait ms", "peak held KB", "early frees");
+
+	int result = 0;
+	for (bool deferred : { false, true })
+	{
+		StreamResult stream;
+		if (!RunStream(deferred, frameCount, streamCount, gpuTime, stream))
+		{
+			printf("deferredrelease: cannot create the objects\n");
+			return 1;
+		}
+
+		bool match = stream.EarlyFrees == 0 && stream.AllFreed;
+		result |= match ? 0 : 1;
+		printf("%10s %10.3f %12.3f %12.1f %12llu%s\n", deferred ? "deferred" : "flush", stream.FrameMs, stream.WaitMs,
+			double(stream.PeakBytes) / 1024.0, static_cast<unsigned long long>(stream.EarlyFrees), match ? "" : "  MISMATCH");
+	}
+
+	return result;
+}
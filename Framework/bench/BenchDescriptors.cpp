@@ -0,0 +1,255 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <DescriptorAllocator.h>
+#include <RecordingDevice.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultOperationCount = 1000000; // allocations and frees of the timed part
+	const uint32_t DefaultLiveCount = 4096; // descriptors alive at once in the timed part
+	const uint32_t CheckPageSize = 8; // descriptors per page of the pool checks
+	const uint32_t CheckRingSize = 8; // descriptors of the ring checks
+	const uint32_t FragmentPageSize = 16; // descriptors per page of the fragmentation check
+	const uint32_t FragmentCount = 12; // descriptors allocated by the fragmentation check, every other one freed
+	const uint32_t TableSize = 8; // descriptors per staged table of the timed part
+	const uint32_t FramesInFlight = 2; // frames the simulated GPU lags behind
+
+	//----------------------------------------------------------------------------------------------------
+	// descriptor copies recorded by the device so far
+	//----------------------------------------------------------------------------------------------------
+	std::vector<RecordCopyDescriptors> GetCopies(const RecordingDevice& device)
+	{
+		std::vector<RecordCopyDescriptors> copies;
+		device.GetStream().ForEach([&copies](RecordOp op, const void* pPayload, uint32_t)
+		{
+			if (op == RecordOp::CopyDescriptors)
+			{
+				RecordCopyDescriptors copy;
+				memcpy(&copy, pPayload, sizeof(copy));
+				copies.push_back(copy);
+			}
+		});
+		return copies;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// page growth, scattered frees, free list reuse and the counters of the pool
+	//----------------------------------------------------------------------------------------------------
+	bool RunPoolChecks(RecordingDevice& device)
+	{
+		DescriptorPool pool;
+		if (!Check("pool initialized", pool.Init(&device, GfxDescriptorHeapType::CBV_SRV_UAV, CheckPageSize)))
+		{
+			return false;
+		}
+
+		// a page is handed out from its first slot on, one more descriptor adds the second page
+		uint32_t increment = pool.GetIncrementSize();
+		std::vector<DescriptorHandle> handles(CheckPageSize + 1);
+		bool allocated = true;
+		for (uint32_t i = 0; i < handles.size(); ++i)
+		{
+			allocated &= pool.Allocate(handles[i]) && handles[i].Index == i;
+		}
+		bool contiguous = true;
+		for (uint32_t i = 1; i < CheckPageSize; ++i)
+		{
+			contiguous &= handles[i].CPU.ptr == handles[0].CPU.ptr + size_t(i) * increment;
+		}
+		DescriptorPoolStats stats = pool.GetStats();
+		bool passed = Check("slots in order, second page on demand", allocated && contiguous
+			&& stats.PageCount == 2 && stats.Capacity == 2 * CheckPageSize && stats.Allocated == CheckPageSize + 1);
+
+		// every other slot of the first page and the only slot of the second one are freed
+		for (uint32_t i = 1; i < CheckPageSize; i += 2)
+		{
+			pool.Free(handles[i]);
+		}
+		pool.Free(handles[CheckPageSize]);
+		stats = pool.GetStats();
+		bool invalidated = !handles[1].IsValid() && handles[1].CPU.ptr == 0;
+		pool.Free(handles[1]);
+		passed &= Check("scattered frees counted, handles invalidated", invalidated && stats.Allocated == CheckPageSize / 2
+			&& stats.PeakAllocated == CheckPageSize + 1 && pool.GetStats().Allocated == stats.Allocated);
+
+		// slots 1, 3 and 5 are holes below slot 6, slot 7 and the empty second page are runs at the end
+		passed &= Check("fragmentation counts the holes of the pages", stats.Fragmentation == 3.f / 12.f);
+
+		// the freed slots are reused (last freed first) before another page is added
+		DescriptorHandle reused[CheckPageSize / 2 + 1];
+		bool reuse = true;
+		for (DescriptorHandle& handle : reused)
+		{
+			reuse &= pool.Allocate(handle);
+		}
+		stats = pool.GetStats();
+		passed &= Check("free list reused before a new page", reuse && reused[0].Index == CheckPageSize
+			&& reused[1].Index == CheckPageSize - 1 && reused[1].CPU.ptr == handles[0].CPU.ptr + size_t(CheckPageSize - 1) * increment
+			&& stats.PageCount == 2 && stats.Allocated == CheckPageSize + 1 && stats.Fragmentation == 0.f);
+		return passed;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// a dense prefix is compact, freeing every other descriptor leaves a hole below each survivor
+	//----------------------------------------------------------------------------------------------------
+	bool RunFragmentationCheck(RecordingDevice& device)
+	{
+		DescriptorPool pool;
+		std::vector<DescriptorHandle> handles(FragmentCount);
+		bool allocated = pool.Init(&device, GfxDescriptorHeapType::CBV_SRV_UAV, FragmentPageSize);
+		for (DescriptorHandle& handle : handles)
+		{
+			allocated &= pool.Allocate(handle);
+		}
+		bool compact = allocated && pool.GetStats().Fragmentation == 0.f;
+
+		for (uint32_t i = 1; i < FragmentCount; i += 2)
+		{
+			pool.Free(handles[i]);
+		}
+
+		// the highest used slot is FragmentCount - 2, the odd slots below it are holes, everything above isn't
+		uint32_t holes = FragmentCount / 2 - 1;
+		uint32_t freeCount = FragmentPageSize - FragmentCount / 2;
+		return Check("dense prefix compact, every other one freed", compact
+			&& pool.GetStats().Fragmentation == float(holes) / float(freeCount));
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// merged copies, full ring and retirement by fence value of the staging ring
+	//----------------------------------------------------------------------------------------------------
+	bool RunRingChecks(RecordingDevice& device)
+	{
+		DescriptorPool pool;
+		DescriptorRing ring;
+		if (!Check("ring initialized", pool.Init(&device, GfxDescriptorHeapType::CBV_SRV_UAV, CheckPageSize)
+			&& ring.Init(&device, GfxDescriptorHeapType::CBV_SRV_UAV, CheckRingSize)))
+		{
+			return false;
+		}
+
+		std::vector<DescriptorHandle> handles(CheckPageSize);
+		for (DescriptorHandle& handle : handles)
+		{
+			pool.Allocate(handle);
+		}
+
+		// neighbours in the pool are copied with one call, a gap starts another
+		GfxCpuDescriptorHandle sources[] = { handles[0].CPU, handles[1].CPU, handles[2].CPU, handles[5].CPU, handles[6].CPU };
+		const uint32_t sourceCount = static_cast<uint32_t>(sizeof(sources) / sizeof(sources[0]));
+		size_t copiesBefore = GetCopies(device).size();
+		GfxGpuDescriptorHandle table = {};
+		bool staged = ring.Stage(sources, sourceCount, table) && table.ptr == ring.GetHeap()->GetGPUDescriptorHandleForHeapStart().ptr;
+		std::vector<RecordCopyDescriptors> copies = GetCopies(device);
+		bool merged = copies.size() == copiesBefore + 2
+			&& copies[copiesBefore].NumDescriptors == 3 && copies[copiesBefore].Src == handles[0].CPU.ptr
+			&& copies[copiesBefore + 1].NumDescriptors == 2 && copies[copiesBefore + 1].Src == handles[5].CPU.ptr
+			&& copies[copiesBefore + 1].Dest == ring.GetHeap()->GetCPUDescriptorHandleForHeapStart().ptr + 3 * pool.GetIncrementSize();
+		bool passed = Check("neighbouring descriptors copied with one call", staged && merged);
+
+		// the table of frame 1 holds the ring until the fence reaches it
+		ring.EndFrame(1);
+		bool full = !ring.Stage(sources, sourceCount, table) && ring.GetStats().FailedAllocations == 1;
+		ring.Retire(0);
+		bool held = !ring.Stage(sources, sourceCount, table);
+		ring.Retire(1);
+		bool reclaimed = ring.GetUsedCount() == 0 && ring.Stage(sources, sourceCount, table);
+		ring.EndFrame(2);
+		passed &= Check("full ring returns false until Retire", full && held && reclaimed);
+
+		// the second table skipped the 3 slots at the end of the ring
+		const LinearRingStats& stats = ring.GetStats();
+		passed &= Check("descriptors per frame counted", stats.FrameCount == 2 && stats.PeakFrameUnits == sourceCount + 3
+			&& stats.GetAverageFrameUnits() == (2 * sourceCount + 3) / 2.0);
+		return passed;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 rules of the descriptor pool and staging ring on the recording backend, then their costs
+//--------------------------------------------------------------------------------------------------------
+int RunDescriptorsBenchmark(int argc, char** argv)
+{
+	uint32_t operationCount = std::max(ArgU32(argc, argv, 1, DefaultOperationCount), 1u);
+	uint32_t liveCount = std::max(ArgU32(argc, argv, 2, DefaultLiveCount), TableSize);
+
+	RecordingDevice device;
+	printf("descriptors: checks\n");
+	bool passed = RunPoolChecks(device);
+	passed &= RunFragmentationCheck(device);
+	passed &= RunRingChecks(device);
+	int result = passed ? 0 : 1;
+
+	// random frees and allocations around the live count, the pool grows to it once
+	DescriptorPool pool;
+	DescriptorRing ring;
+	uint32_t tableCount = operationCount / TableSize;
+	if (!pool.Init(&device, GfxDescriptorHeapType::CBV_SRV_UAV) || !ring.Init(&device, GfxDescriptorHeapType::CBV_SRV_UAV, TableSize * 64 * (FramesInFlight + 1)))
+	{
+		printf("descriptors: cannot initialize the pool\n");
+		return 1;
+	}
+
+	std::vector<DescriptorHandle> live(liveCount);
+	for (DescriptorHandle& handle : live)
+	{
+		pool.Allocate(handle);
+	}
+
+	uint32_t seed = 12345u;
+	auto begin = BenchClock::now();
+	for (uint32_t i = 0; i < operationCount; ++i)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		DescriptorHandle& handle = live[(seed >> 8) % liveCount];
+		pool.Free(handle);
+		pool.Allocate(handle);
+	}
+	double churnMs = ElapsedMs(begin, BenchClock::now());
+	DescriptorPoolStats stats = pool.GetStats();
+
+	// tables of scattered descriptors, 64 per frame on a simulated fence (the copies are recorded as well)
+	std::vector<GfxCpuDescriptorHandle> sources(TableSize);
+	uint64_t frame = 1;
+	begin = BenchClock::now();
+	for (uint32_t i = 0; i < tableCount; ++i)
+	{
+		for (uint32_t j = 0; j < TableSize; ++j)
+		{
+			sources[j] = live[(i * 7 + j * 131) % liveCount].CPU;
+		}
+
+		GfxGpuDescriptorHandle table;
+		if (!ring.Stage(sources.data(), TableSize, table))
+		{
+			break;
+		}
+		if ((i + 1) % 64 == 0)
+		{
+			ring.EndFrame(frame++);
+			ring.Retire((frame > FramesInFlight) ? frame - FramesInFlight : 0);
+		}
+	}
+	double stageMs = ElapsedMs(begin, BenchClock::now());
+	bool steady = ring.GetStats().FailedAllocations == 0;
+	result |= steady ? 0 : 1;
+
+	printf("descriptors: %u frees and allocations over %u live descriptors, %u tables of %u\n", operationCount, liveCount, tableCount, TableSize);
+	printf("%10s %10s %10s %10s %14s %16s\n", "pages", "capacity", "peak", "fragment", "ns/alloc+free", "ns/staged table");
+	printf("%10u %10u %10u %10.2f %14.2f %16.2f%s\n",
+		stats.PageCount, stats.Capacity, stats.PeakAllocated, stats.Fragmentation,
+		churnMs * 1000000.0 / operationCount, (tableCount > 0) ? stageMs * 1000000.0 / tableCount : 0.0,
+		steady ? "" : "  MISMATCH");
+	return result;
+}
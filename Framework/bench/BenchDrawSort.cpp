@@ -0,0 +1,191 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <DrawQueue.h>
+#include <algorithm>
+#include <cstdio>
+#include <set>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultKeyCount = 1000000; // draws of the frame
+	const uint32_t DefaultIterationCount = 9; // sorts measured per variant
+	const uint32_t PipelineCount = 32; // pipelines of the scene
+	const uint32_t MaterialCount = 512; // materials of the scene
+	const uint32_t TransparentPass = 2; // drawn back to front after the opaque (0) and alpha tested (1) passes
+
+	//----------------------------------------------------------------------------------------------------
+	// draws in the order of the objects: most are opaque, a tenth each alpha tested and transparent, every
+	// material belongs to one pipeline
+	//----------------------------------------------------------------------------------------------------
+	void BuildDraws(uint32_t count, std::vector<DrawPacket>& packets)
+	{
+		uint32_t seed = 12345u;
+		auto random = [&seed]()
+		{
+			seed = seed * 1664525u + 1013904223u;
+			return seed >> 8;
+		};
+
+		packets.resize(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint32_t kind = random() % 10;
+			uint32_t pass = (kind < 8) ? 0 : (kind == 8) ? 1 : TransparentPass;
+			uint32_t material = random() % MaterialCount;
+			float depth = 1.f + static_cast<float>(random() % 100000) * 0.01f;
+			packets[i].Key = DrawQueue::MakeKey(pass, material % PipelineCount, material, depth, pass == TransparentPass);
+			packets[i].Payload = i;
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// radix order against a stable comparison sort
+	//----------------------------------------------------------------------------------------------------
+	bool SortsLikeStableSort(DrawQueue& queue, const std::vector<DrawPacket>& packets)
+	{
+		queue.Reset();
+		for (const DrawPacket& packet : packets)
+		{
+			queue.Push(packet.Key, packet.Payload);
+		}
+		queue.Sort();
+
+		std::vector<DrawPacket> expected = packets;
+		std::stable_sort(expected.begin(), expected.end(), [](const DrawPacket& a, const DrawPacket& b) { return a.Key < b.Key; });
+		bool equal = queue.GetCount() == expected.size();
+		for (uint32_t i = 0; i < queue.GetCount() && equal; ++i)
+		{
+			equal = queue.GetPackets()[i].Key == expected[i].Key && queue.GetPackets()[i].Payload == expected[i].Payload;
+		}
+		return equal;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// order, stability, skipped digits, key fields and binds of the sorted order
+	//----------------------------------------------------------------------------------------------------
+	bool RunChecks(const std::vector<DrawPacket>& draws)
+	{
+		DrawQueue queue;
+
+		// the scene, a frame below the radix threshold, and draws which only differ in a few depths (ties)
+		std::vector<DrawPacket> small(draws.begin(), draws.begin() + std::min<size_t>(draws.size(), 100));
+		std::vector<DrawPacket> ties(4096);
+		for (uint32_t i = 0; i < ties.size(); ++i)
+		{
+			ties[i] = DrawPacket{ DrawQueue::MakeKey(0, 3, 7, static_cast<float>((i * 7) % 5)), i };
+		}
+		bool passed = Check("radix order equals a stable sort", SortsLikeStableSort(queue, draws) && SortsLikeStableSort(queue, small));
+		passed &= Check("equal keys keep their order, constant digits skipped", SortsLikeStableSort(queue, ties) && queue.GetSortPassCount() <= 4);
+
+		uint64_t key = DrawQueue::MakeKey(DrawQueue::MaxPasses - 1, 1234, 54321, 2.f);
+		bool fields = DrawQueue::GetPass(key) == DrawQueue::MaxPasses - 1 && DrawQueue::GetPipeline(key) == 1234 && DrawQueue::GetMaterial(key) == 54321
+			&& DrawQueue::MakeKey(0, 1, 1, 1.f) < DrawQueue::MakeKey(0, 1, 1, 2.f) && DrawQueue::MakeKey(0, 1, 1, -1.f) < DrawQueue::MakeKey(0, 1, 1, 0.5f)
+			&& DrawQueue::MakeKey(2, 1, 1, 1.f, true) > DrawQueue::MakeKey(2, 1, 1, 2.f, true) && DrawQueue::MakeKey(0, 9, 9, 1e9f) < DrawQueue::MakeKey(1, 0, 0, 0.f);
+		passed &= Check("key fields round trip, depth orders within them", fields);
+
+		// sorted, every pipeline and material is bound once per pass
+		std::set<uint64_t> pipelines;
+		std::set<uint64_t> materials;
+		for (const DrawPacket& packet : draws)
+		{
+			pipelines.insert(packet.Key >> (32 + DrawQueue::MaterialBits));
+			materials.insert(packet.Key >> 32);
+		}
+		SortsLikeStableSort(queue, draws);
+		DrawStateChanges changes = DrawQueue::CountStateChanges(queue.GetPackets(), queue.GetCount());
+		passed &= Check("sorted draws bind every state once per pass", changes.PassChanges == 3
+			&& changes.PipelineChanges == pipelines.size() && changes.MaterialChanges == materials.size());
+		return passed;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 radix sort of draw keys against comparison sorts, then the binds of the sorted submission
+//--------------------------------------------------------------------------------------------------------
+int RunDrawSortBenchmark(int argc, char** argv)
+{
+	uint32_t keyCount = std::max(ArgU32(argc, argv, 1, DefaultKeyCount), 1000u);
+	uint32_t iterationCount = std::max(ArgU32(argc, argv, 2, DefaultIterationCount), 1u);
+
+	std::vector<DrawPacket> draws;
+	BuildDraws(keyCount, draws);
+
+	printf("drawsort: checks\n");
+	int result = RunChecks(draws) ? 0 : 1;
+
+	// every sort starts from the order of the objects, filling the queue isn't measured
+	enum Variant { Radix, StdSort, StdStableSort, VariantCount };
+	static const char* const VariantNames[] = { "radix", "std::sort", "std::stable_sort" };
+	std::vector<double> samples[VariantCount];
+	DrawQueue queue;
+	queue.Reserve(keyCount);
+	std::vector<DrawPacket> packets;
+	uint32_t sortPasses = 0;
+	for (uint32_t i = 0; i <= iterationCount; ++i)
+	{
+		for (uint32_t variant = 0; variant < VariantCount; ++variant)
+		{
+			double ms = 0.0;
+			auto byKey = [](const DrawPacket& a, const DrawPacket& b) { return a.Key < b.Key; };
+			if (variant == Radix)
+			{
+				queue.Reset();
+				for (const DrawPacket& packet : draws)
+				{
+					queue.Push(packet.Key, packet.Payload);
+				}
+
+				auto begin = BenchClock::now();
+				queue.Sort();
+				ms = ElapsedMs(begin, BenchClock::now());
+				sortPasses = queue.GetSortPassCount();
+			}
+			else
+			{
+				packets = draws;
+				auto begin = BenchClock::now();
+				if (variant == StdSort)
+				{
+					std::sort(packets.begin(), packets.end(), byKey);
+				}
+				else
+				{
+					std::stable_sort(packets.begin(), packets.end(), byKey);
+				}
+				ms = ElapsedMs(begin, BenchClock::now());
+			}
+
+			// warm-up pass
+			if (i > 0)
+			{
+				samples[variant].push_back(ms);
+			}
+		}
+	}
+
+	printf("drawsort: %u draws, %u pipelines, %u materials, 3 passes, radix sorted %u of 8 digits\n",
+		keyCount, PipelineCount, MaterialCount, sortPasses);
+	printf("%18s %10s %12s %10s\n", "sort", "ms", "Mkeys/s", "speedup");
+	double radixMs = Median(samples[Radix]);
+	for (uint32_t variant = 0; variant < VariantCount; ++variant)
+	{
+		double ms = Median(samples[variant]);
+		printf("%18s %10.3f %12.1f %9.2fx\n", VariantNames[variant], ms, (ms > 0.0) ? keyCount / (ms * 1000.0) : 0.0, (ms > 0.0) ? radixMs / ms : 0.0);
+	}
+
+	// binds of the frame submitted in object order and in key order
+	DrawStateChanges unsorted = DrawQueue::CountStateChanges(draws.data(), keyCount);
+	DrawStateChanges sorted = DrawQueue::CountStateChanges(queue.GetPackets(), queue.GetCount());
+	printf("%18s %10s %12s %12s\n", "submission", "passes", "pipelines", "materials");
+	printf("%18s %10u %12u %12u\n", "object order", unsorted.PassChanges, unsorted.PipelineChanges, unsorted.MaterialChanges);
+	printf("%18s %10u %12u %12u\n", "key order", sorted.PassChanges, sorted.PipelineChanges, sorted.MaterialChanges);
+	return result;
+}
@@ -0,0 +1,395 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <App.h>
+#include <MeshFile.h>
+#include <ShaderTypes.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <new>
+#include <string>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultFrameCount = 600; // frames measured per scene
+	const uint32_t MinWarmupFrames = 16; // frames left out while pipelines compile and the rings fill up
+	const uint32_t QuadVertexCount = 4; // vertices of the built-in quad
+	const uint32_t MaxStreamingFrames = 100000; // frames a streamed mesh may take before the scene gives up
+
+	std::atomic<uint64_t> g_AllocCount(0); // calls of operator new since the start
+	std::atomic<uint64_t> g_AllocBytes(0); // bytes requested from operator new since the start
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// FrameScene structure - synthetic scene drawn by the App
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct FrameScene
+	{
+		const char* Name; // name in the report
+		uint32_t ObjectCount; // quads (or meshes) laid out on the grid
+		uint32_t VertexCount; // vertices per object (the built-in quad for 4 and less)
+		uint32_t FramesInFlight; // frames the CPU may run ahead of the GPU
+		bool Instancing; // one draw for every object instead of one draw each
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// FrameResult structure - measurements of a scene
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct FrameResult
+	{
+		uint32_t FrameCount; // frames measured (after the warm-up)
+		uint32_t MeshVertexCount; // vertices per object actually drawn
+		uint32_t IndexCount; // indices per object
+		double MeanMs; // average CPU time of a frame
+		double P50Ms; // median
+		double P95Ms; // 95th percentile
+		double P99Ms; // 99th percentile
+		double MaxMs; // slowest frame
+		double AllocsPerFrame; // operator new calls per frame
+		double BytesPerFrame; // bytes allocated per frame
+		uint32_t MaxAllocs; // most operator new calls of a single frame
+		double DrawsPerFrame; // draw calls per frame
+		double ObjectsPerFrame; // objects surviving culling per frame
+		double BarriersPerFrame; // resource barriers per frame
+		double RingBytesPerFrame; // upload ring bytes handed out per frame
+		uint64_t RingPeakBytes; // most upload ring bytes of a single frame
+		double FramesPerSecond; // frames / total CPU time
+		double DrawsPerSecond; // draw calls / total CPU time
+	};
+
+	const FrameScene DefaultScenes[] = {
+		{ "single-quad", 1, QuadVertexCount, 2, true },
+		{ "quads-1k-draws", 1024, QuadVertexCount, 2, false },
+		{ "quads-10k-instanced", 10000, QuadVertexCount, 2, true },
+		{ "quads-4k-draws-1-in-flight", 4096, QuadVertexCount, 1, false },
+		{ "quads-4k-draws-3-in-flight", 4096, QuadVertexCount, 3, false },
+		{ "mesh-64k-verts-64-draws", 64, 65536, 2, false },
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// square grid mesh with at least the number of vertices
+	//----------------------------------------------------------------------------------------------------
+	bool WriteGridMesh(const std::string& path, uint32_t vertexCount, uint32_t& meshVertexCount)
+	{
+		uint32_t n = std::max(static_cast<uint32_t>(std::ceil(std::sqrt(double(vertexCount)))), 2u);
+
+		std::vector<Vertex> vertices(size_t(n) * n);
+		for (uint32_t y = 0; y < n; ++y)
+		{
+			for (uint32_t x = 0; x < n; ++x)
+			{
+				float u = float(x) / float(n - 1);
+				float v = float(y) / float(n - 1);
+				Vertex& vertex = vertices[size_t(y) * n + x];
+				vertex.Position = DirectX::XMFLOAT3(u - 0.5f, v - 0.5f, 0.f);
+				vertex.Color = DirectX::XMFLOAT4(u, v, 1.f - u, 1.f);
+			}
+		}
+
+		std::vector<uint32_t> indices;
+		indices.reserve(size_t(n - 1) * (n - 1) * 6);
+		for (uint32_t y = 0; y + 1 < n; ++y)
+		{
+			for (uint32_t x = 0; x + 1 < n; ++x)
+			{
+				uint32_t i = y * n + x;
+				uint32_t quad[] = { i, i + 1, i + n + 1, i, i + n + 1, i + n };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+		}
+
+		MeshFileSubmesh submesh = {};
+		submesh.IndexCount = static_cast<uint32_t>(indices.size());
+		submesh.BoundsMin[0] = submesh.BoundsMin[1] = -0.5f;
+		submesh.BoundsMax[0] = submesh.BoundsMax[1] = 0.5f;
+
+		MeshFileDesc desc = {};
+		desc.VertexCount = static_cast<uint32_t>(vertices.size());
+		desc.StreamCount = 1;
+		desc.pStreams[0] = vertices.data();
+		desc.Strides[0] = sizeof(Vertex);
+		desc.Layouts[0] = MeshVertexLayout::PositionColor;
+		desc.pIndices = indices.data();
+		desc.IndexCount = submesh.IndexCount;
+		desc.IndexFormat = GfxFormat::R32_Uint;
+		desc.pSubmeshes = &submesh;
+		desc.SubmeshCount = 1;
+		memcpy(desc.BoundsMin, submesh.BoundsMin, sizeof(desc.BoundsMin));
+		memcpy(desc.BoundsMax, submesh.BoundsMax, sizeof(desc.BoundsMax));
+
+		meshVertexCount = desc.VertexCount;
+		return MeshFile::Write(path.c_str(), desc);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// drive the frame loop of the App on the recording backend, false when the App didn't come up
+	//----------------------------------------------------------------------------------------------------
+	bool RunScene(const FrameScene& scene, uint32_t frameCount, FrameResult& result)
+	{
+		result = FrameResult();
+		result.MeshVertexCount = QuadVertexCount;
+
+		std::string meshPath;
+		std::error_code error;
+		if (scene.VertexCount > QuadVertexCount)
+		{
+			meshPath = (std::filesystem::temp_directory_path(error) / "ReLearnD3D12_frame.mesh").string();
+			if (!WriteGridMesh(meshPath, scene.VertexCount, result.MeshVertexCount))
+			{
+				return false;
+			}
+		}
+
+		// the first frames compile pipelines and grow the rings, they are left out (counted from the first
+		// frame with geometry, a mesh streams in while empty frames run)
+		uint32_t warmupFrames = std::max(MinWarmupFrames, frameCount / 10);
+		uint32_t totalFrames = warmupFrames + frameCount + MaxStreamingFrames;
+		uint32_t firstFrame = UINT32_MAX;
+
+		std::vector<double> frameMs;
+		std::vector<uint32_t> frameAllocs;
+		frameMs.reserve(frameCount);
+		frameAllocs.reserve(frameCount);
+		uint64_t drawCount = 0;
+		uint64_t objectCount = 0;
+		uint64_t barrierCount = 0;
+		uint64_t ringBytes = 0;
+		uint64_t allocBytes = 0;
+
+		App app(960, 540, GfxBackend::Recording, scene.ObjectCount, scene.Instancing, meshPath.empty() ? nullptr : meshPath.c_str(), scene.FramesInFlight);
+
+		// the callback itself stays out of the measurements, so the clock and the counters are read last
+		BenchClock::time_point frameBegin = BenchClock::now();
+		uint64_t allocsBegin = g_AllocCount.load(std::memory_order_relaxed);
+		uint64_t bytesBegin = g_AllocBytes.load(std::memory_order_relaxed);
+		bool initialized = app.Run(totalFrames, [&](uint32_t frame)
+		{
+			BenchClock::time_point frameEnd = BenchClock::now();
+			uint64_t allocsEnd = g_AllocCount.load(std::memory_order_relaxed);
+			uint64_t bytesEnd = g_AllocBytes.load(std::memory_order_relaxed);
+			if (firstFrame == UINT32_MAX && app.GetIndexCount() > 0)
+			{
+				firstFrame = frame;
+			}
+
+			if (firstFrame != UINT32_MAX && frame >= firstFrame + warmupFrames)
+			{
+				frameMs.push_back(ElapsedMs(frameBegin, frameEnd));
+				frameAllocs.push_back(static_cast<uint32_t>(allocsEnd - allocsBegin));
+				allocBytes += bytesEnd - bytesBegin;
+				drawCount += app.GetDrawCount();
+				objectCount += app.GetVisibleCount();
+				barrierCount += app.GetBarrierStats().BarrierCount;
+				ringBytes += app.GetUploadRingStats().LastFrameUnits;
+				result.RingPeakBytes = std::max(result.RingPeakBytes, app.GetUploadRingStats().LastFrameUnits);
+				result.IndexCount = app.GetIndexCount();
+				if (frameMs.size() == frameCount)
+				{
+					app.Quit();
+				}
+			}
+
+			frameBegin = BenchClock::now();
+			allocsBegin = g_AllocCount.load(std::memory_order_relaxed);
+			bytesBegin = g_AllocBytes.load(std::memory_order_relaxed);
+		});
+
+		if (!meshPath.empty())
+		{
+			std::filesystem::remove(meshPath, error);
+		}
+
+		result.FrameCount = static_cast<uint32_t>(frameMs.size());
+		if (!initialized || result.FrameCount == 0)
+		{
+			return false;
+		}
+
+		double totalMs = 0.0;
+		uint64_t totalAllocs = 0;
+		for (uint32_t i = 0; i < result.FrameCount; ++i)
+		{
+			totalMs += frameMs[i];
+			totalAllocs += frameAllocs[i];
+			result.MaxAllocs = std::max(result.MaxAllocs, frameAllocs[i]);
+		}
+
+		std::sort(frameMs.begin(), frameMs.end());
+		double frames = double(result.FrameCount);
+		double seconds = totalMs / 1000.0;
+		result.MeanMs = totalMs / frames;
+		result.P50Ms = Percentile(frameMs, 0.50);
+		result.P95Ms = Percentile(frameMs, 0.95);
+		result.P99Ms = Percentile(frameMs, 0.99);
+		result.MaxMs = frameMs.back();
+		result.AllocsPerFrame = double(totalAllocs) / frames;
+		result.BytesPerFrame = double(allocBytes) / frames;
+		result.DrawsPerFrame = double(drawCount) / frames;
+		result.ObjectsPerFrame = double(objectCount) / frames;
+		result.BarriersPerFrame = double(barrierCount) / frames;
+		result.RingBytesPerFrame = double(ringBytes) / frames;
+		result.FramesPerSecond = (seconds > 0.0) ? frames / seconds : 0.0;
+		result.DrawsPerSecond = (seconds > 0.0) ? double(drawCount) / seconds : 0.0;
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// report of every scene for regression tracking
+	//----------------------------------------------------------------------------------------------------
+	bool WriteJson(const char* path, const std::vector<FrameScene>& scenes, const std::vector<FrameResult>& results)
+	{
+		FILE* pFile = fopen(path, "w");
+		if (pFile == nullptr)
+		{
+			return false;
+		}
+
+		fprintf(pFile, "{\n  \"benchmark\": \"frame\",\n  \"backend\": \"recording\",\n  \"scenes\": [\n");
+		for (size_t i = 0; i < scenes.size(); ++i)
+		{
+			const FrameScene& scene = scenes[i];
+			const FrameResult& result = results[i];
+			fprintf(pFile, "    {\n");
+			fprintf(pFile, "      \"name\": \"%s\",\n", scene.Name);
+			fprintf(pFile, "      \"objects\": %u,\n", scene.ObjectCount);
+			fprintf(pFile, "      \"vertices\": %u,\n", result.MeshVertexCount);
+			fprintf(pFile, "      \"framesInFlight\": %u,\n", scene.FramesInFlight);
+			fprintf(pFile, "      \"instancing\": %s,\n", scene.Instancing ? "true" : "false");
+			fprintf(pFile, "      \"frames\": %u,\n", result.FrameCount);
+			fprintf(pFile, "      \"cpuMs\": { \"mean\": %.6f, \"p50\": %.6f, \"p95\": %.6f, \"p99\": %.6f, \"max\": %.6f },\n",
+				result.MeanMs, result.P50Ms, result.P95Ms, result.P99Ms, result.MaxMs);
+			fprintf(pFile, "      \"allocsPerFrame\": %.3f,\n", result.AllocsPerFrame);
+			fprintf(pFile, "      \"maxAllocsPerFrame\": %u,\n", result.MaxAllocs);
+			fprintf(pFile, "      \"bytesPerFrame\": %.1f,\n", result.BytesPerFrame);
+			fprintf(pFile, "      \"drawsPerFrame\": %.3f,\n", result.DrawsPerFrame);
+			fprintf(pFile, "      \"objectsPerFrame\": %.3f,\n", result.ObjectsPerFrame);
+			fprintf(pFile, "      \"barriersPerFrame\": %.3f,\n", result.BarriersPerFrame);
+			fprintf(pFile, "      \"uploadRingBytesPerFrame\": %.1f,\n", result.RingBytesPerFrame);
+			fprintf(pFile, "      \"uploadRingPeakBytes\": %llu,\n", static_cast<unsigned long long>(result.RingPeakBytes));
+			fprintf(pFile, "      \"framesPerSecond\": %.3f,\n", result.FramesPerSecond);
+			fprintf(pFile, "      \"drawsPerSecond\": %.1f\n", result.DrawsPerSecond);
+			fprintf(pFile, "    }%s\n", (i + 1 < scenes.size()) ? "," : "");
+		}
+		fprintf(pFile, "  ]\n}\n");
+
+		bool written = (ferror(pFile) == 0);
+		return (fclose(pFile) == 0) && written;
+	}
+
+} // namespace /* anonymous */
+
+
+//--------------------------------------------------------------------------------------------------------
+// Allocation counters (operator new of the whole Benchmark executable goes through them)
+//--------------------------------------------------------------------------------------------------------
+void* operator new(size_t size)
+{
+	g_AllocCount.fetch_add(1, std::memory_order_relaxed);
+	g_AllocBytes.fetch_add(size, std::memory_order_relaxed);
+	void* p = malloc((size > 0) ? size : 1);
+	if (p == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+// the standard library takes temporary buffers (std::stable_sort) through the nothrow form
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	g_AllocCount.fetch_add(1, std::memory_order_relaxed);
+	g_AllocBytes.fetch_add(size, std::memory_order_relaxed);
+	return malloc((size > 0) ? size : 1);
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 CPU frame times of the App's frame loop on synthetic scenes, without a GPU
+//--------------------------------------------------------------------------------------------------------
+int RunFrameBenchmark(int argc, char** argv)
+{
+	uint32_t frameCount = std::max(ArgU32(argc, argv, 1, DefaultFrameCount), 1u);
+	const char* pJsonPath = (argc > 2 && strcmp(argv[2], "-") != 0) ? argv[2] : nullptr;
+
+	// a scene on the command line replaces the default set
+	std::vector<FrameScene> scenes;
+	if (argc > 3)
+	{
+		FrameScene scene = {};
+		scene.Name = "custom";
+		scene.ObjectCount = std::max(ArgU32(argc, argv, 3, 1), 1u);
+		scene.VertexCount = ArgU32(argc, argv, 4, QuadVertexCount);
+		scene.FramesInFlight = ArgU32(argc, argv, 5, 2);
+		scene.Instancing = ArgU32(argc, argv, 6, 0) != 0;
+		scenes.push_back(scene);
+	}
+	else
+	{
+		scenes.assign(std::begin(DefaultScenes), std::end(DefaultScenes));
+	}
+
+	printf("frame: %u frames per scene on the recording backend\n", frameCount);
+	printf("%-28s %8s %8s %8s %8s %8s %9s %10s %9s %10s %12s %11s %12s\n",
+		"scene", "mean ms", "p50 ms", "p95 ms", "p99 ms", "max ms", "allocs/f", "KB/f", "draws/f", "barriers/f", "Kdraws/s", "ring KB/f", "ring peak KB");
+
+	int result = 0;
+	std::vector<FrameResult> results(scenes.size());
+	for (size_t i = 0; i < scenes.size(); ++i)
+	{
+		const FrameScene& scene = scenes[i];
+		FrameResult& frame = results[i];
+		if (!RunScene(scene, frameCount, frame))
+		{
+			printf("%-28s cannot run the scene\n", scene.Name);
+			result = 1;
+			continue;
+		}
+
+		// every frame records one draw per visible object, or a single one once instancing is up, and the
+		// back buffer goes to the render target and back whatever the number of command lists
+		bool match = frame.FrameCount == frameCount
+			&& (scene.Instancing ? frame.DrawsPerFrame <= 1.0 : frame.DrawsPerFrame == frame.ObjectsPerFrame)
+			&& frame.BarriersPerFrame == 2.0;
+		result |= match ? 0 : 1;
+		printf("%-28s %8.4f %8.4f %8.4f %8.4f %8.4f %9.2f %10.2f %9.1f %10.2f %12.2f %11.2f %12.2f%s\n",
+			scene.Name, frame.MeanMs, frame.P50Ms, frame.P95Ms, frame.P99Ms, frame.MaxMs,
+			frame.AllocsPerFrame, frame.BytesPerFrame / 1024.0, frame.DrawsPerFrame, frame.BarriersPerFrame, frame.DrawsPerSecond / 1000.0,
+			frame.RingBytesPerFrame / 1024.0, static_cast<double>(frame.RingPeakBytes) / 1024.0, match ? "" : "  MISMATCH");
+	}
+
+	if (pJsonPath != nullptr)
+	{
+		if (!WriteJson(pJsonPath, scenes, results))
+		{
+			printf("frame: cannot write %s\n", pJsonPath);
+			return 1;
+		}
+		printf("frame: report written to %s\n", pJsonPath);
+	}
+
+	return result;
+}
@@ -0,0 +1,108 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <CommandListPool.h>
+#include <FrameTimeline.h>
+#include <RecordingDevice.h>
+#include <WorkerPool.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultFrameCount = 200; // frames measured per frames in flight
+	const uint32_t DefaultCpuTime = 4000; // CPU time of a frame in microseconds
+	const uint32_t DefaultGpuTime = 5000; // average GPU time of a frame in microseconds
+	const uint32_t DefaultGpuJitter = 3000; // largest deviation of the GPU time in microseconds
+
+	//----------------------------------------------------------------------------------------------------
+	// keep the CPU busy like recording would (sleeping is too coarse)
+	//----------------------------------------------------------------------------------------------------
+	void Spin(uint32_t microseconds)
+	{
+		auto end = BenchClock::now() + std::chrono::microseconds(microseconds);
+		while (BenchClock::now() < end)
+		{
+			/* NOTHING */
+		}
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 frame loop over 1 to 4 frames in flight against a simulated GPU with varying frame times
+//--------------------------------------------------------------------------------------------------------
+int RunFrameTimelineBenchmark(int argc, char** argv)
+{
+	uint32_t frameCount = std::max(ArgU32(argc, argv, 1, DefaultFrameCount), 1u);
+	uint32_t cpuTime = ArgU32(argc, argv, 2, DefaultCpuTime);
+	uint32_t gpuTime = ArgU32(argc, argv, 3, DefaultGpuTime);
+	uint32_t gpuJitter = ArgU32(argc, argv, 4, DefaultGpuJitter);
+
+	WorkerPool workers;
+	if (!workers.Init(1))
+	{
+		return 1;
+	}
+
+	printf("frametimeline: %u frames, CPU %.2f ms, GPU %.2f +- %.2f ms per frame\n",
+		frameCount, cpuTime / 1000.0, gpuTime / 1000.0, gpuJitter / 1000.0);
+	printf("%8s %10s %8s %10s %10s %10s %9s %9s\n", "inflight", "frame ms", "fps", "stall avg", "stall p95", "stall max", "stalled", "GPU busy");
+
+	int result = 0;
+	for (uint32_t framesInFlight = 1; framesInFlight <= FrameTimeline::MaxFramesInFlight; ++framesInFlight)
+	{
+		RecordingDevice device;
+		device.SetGpuWorkTime(gpuTime, gpuJitter);
+
+		GfxPtr<GfxCommandQueue> pQueue;
+		GfxPtr<GfxSwapChain> pSwapChain;
+		GfxSwapChainDesc swapChainDesc = { 960, 540, 2, GfxFormat::R8G8B8A8_Unorm, nullptr };
+		FrameTimeline timeline;
+		CommandListPool cmdLists;
+		if (!device.CreateCommandQueue(GfxCommandListType::Direct, pQueue)
+			|| !device.CreateSwapChain(pQueue.get(), swapChainDesc, pSwapChain)
+			|| !timeline.Init(&device, pQueue.get(), framesInFlight)
+			|| !cmdLists.Init(&device, GfxCommandListType::Direct, framesInFlight, 1))
+		{
+			printf("frametimeline: cannot create the objects\n");
+			return 1;
+		}
+
+		// the slot's allocator is reset by Record(), which the timeline must only allow once its frame is done
+		std::vector<double> stalls;
+		stalls.reserve(frameCount);
+		auto begin = BenchClock::now();
+		for (uint32_t frame = 0; frame < frameCount; ++frame)
+		{
+			uint32_t slot = timeline.BeginFrame();
+			stalls.push_back(timeline.GetStats().LastStallMs);
+			result |= (timeline.GetCompletedValue() + framesInFlight >= timeline.GetFrameValue()) ? 0 : 1;
+
+			Spin(cpuTime);
+			cmdLists.Record(workers, slot, 1, [](GfxCommandList*, uint32_t) { /* NOTHING */ });
+			cmdLists.Execute(pQueue.get());
+			pSwapChain->Present(1);
+			timeline.EndFrame();
+		}
+		timeline.WaitIdle();
+		double totalMs = ElapsedMs(begin, BenchClock::now());
+
+		const FrameTimelineStats& stats = timeline.GetStats();
+		std::sort(stalls.begin(), stalls.end());
+		double frameMs = totalMs / frameCount;
+		printf("%8u %10.3f %8.1f %10.3f %10.3f %10.3f %8.1f%% %8.1f%%\n",
+			framesInFlight, frameMs, 1000.0 / frameMs, stats.StallMs / frameCount, Percentile(stalls, 0.95), stats.MaxStallMs,
+			100.0 * double(stats.StallCount) / double(frameCount), 100.0 * (gpuTime / 1000.0) * frameCount / totalMs);
+	}
+
+	workers.Term();
+	printf("%s\n", (result == 0) ? "CPU stayed within the frames in flight" : "MISMATCH: CPU ran ahead of the frames in flight");
+	return result;
+}
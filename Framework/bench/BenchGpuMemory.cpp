@@ -0,0 +1,342 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <GpuMemoryAllocator.h>
+#include <RecordingDevice.h>
+#include <TlsfAllocator.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultOperations = 200000; // allocations and frees of each fuzz run
+	const uint32_t DefaultSeed = 12345; // seed of the fuzz runs
+	const uint32_t ValidateEvery = 1000; // operations between two full consistency checks
+	const uint32_t LiveCount = 4096; // allocations kept alive by the timed loops
+	const uint32_t BufferCount = 1000; // small buffers of the committed vs. sub-allocated comparison
+	const uint64_t CommittedAlignment = 64 * 1024; // memory a committed buffer takes at least
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Random structure - LCG driving the fuzz runs
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Random
+	{
+		uint32_t Seed;
+
+		// [0, range)
+		uint32_t Next(uint32_t range)
+		{
+			Seed = Seed * 1664525u + 1013904223u;
+			return static_cast<uint32_t>((uint64_t(Seed >> 8) * range) >> 24);
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// FuzzConfig structure - allocator and request shape of a fuzz run
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct FuzzConfig
+	{
+		const char* Name; // name of the run
+		uint64_t Capacity; // units of the allocator
+		uint64_t Granularity; // units per granule
+		uint32_t MaxSize; // largest request
+		uint32_t MaxAlignmentShift; // alignments from 1 to 1 << MaxAlignmentShift
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// round up to a power of two alignment
+	//----------------------------------------------------------------------------------------------------
+	inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// ranges sorted by offset never overlap and their sizes add up to the used size
+	//----------------------------------------------------------------------------------------------------
+	bool CheckRanges(const TlsfAllocator& allocator, std::vector<TlsfAllocation> ranges)
+	{
+		std::sort(ranges.begin(), ranges.end(), [](const TlsfAllocation& a, const TlsfAllocation& b) { return a.Offset < b.Offset; });
+
+		uint64_t used = 0;
+		for (size_t i = 0; i < ranges.size(); ++i)
+		{
+			if (i > 0 && ranges[i - 1].Offset + ranges[i - 1].Size > ranges[i].Offset)
+			{
+				return false;
+			}
+			used += ranges[i].Size;
+		}
+
+		TlsfStats stats = allocator.GetStats();
+		return allocator.Validate() && stats.UsedSize == used && stats.AllocationCount == ranges.size();
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// random allocations and frees, every result and the whole allocator checked along the way
+	//----------------------------------------------------------------------------------------------------
+	bool RunFuzz(const FuzzConfig& config, uint32_t operations, uint32_t seed)
+	{
+		TlsfAllocator allocator;
+		allocator.Reset(config.Capacity, config.Granularity);
+
+		Random random = { seed };
+		std::vector<TlsfAllocation> live;
+		uint32_t failures = 0;
+		uint32_t rejected = 0;
+		size_t peak = 0;
+		double fragmentation = 0.0; // share of the free units outside of the largest block summed over the checks
+		uint32_t checks = 0;
+		bool passed = true;
+		for (uint32_t i = 0; i < operations && passed; ++i)
+		{
+			// phases that mostly allocate and mostly free, so that the allocator fills up and empties again
+			bool filling = ((i / (operations / 8 + 1)) % 2) == 0;
+			if (live.empty() || random.Next(100) < (filling ? 70u : 30u))
+			{
+				// mostly small requests with a tail of large ones
+				uint64_t size = (random.Next(8) == 0) ? 1 + random.Next(config.MaxSize) : 1 + random.Next(config.MaxSize / 64 + 1);
+				uint64_t alignment = 1ull << random.Next(config.MaxAlignmentShift + 1);
+				TlsfAllocation allocation = {};
+				if (allocator.Allocate(size, alignment, allocation))
+				{
+					passed &= (allocation.Offset % alignment == 0) && (allocation.Size >= size)
+						&& (allocation.Size % config.Granularity == 0) && (allocation.Offset + allocation.Size <= config.Capacity);
+					live.push_back(allocation);
+					peak = std::max(peak, live.size());
+				}
+				else
+				{
+					// a failure is only allowed when no free block could hold the range at its worst padding
+					TlsfStats stats = allocator.GetStats();
+					uint64_t worst = AlignUp(size, config.Granularity) + std::max(alignment, config.Granularity) - config.Granularity;
+					rejected += (stats.LargestFreeBlock >= worst) ? 1 : 0;
+					failures++;
+				}
+			}
+			else
+			{
+				size_t index = random.Next(static_cast<uint32_t>(live.size()));
+				allocator.Free(live[index]);
+				passed &= (live[index].Node == TlsfAllocator::InvalidNode);
+				live[index] = live.back();
+				live.pop_back();
+			}
+
+			if (i % ValidateEvery == 0)
+			{
+				passed &= CheckRanges(allocator, live);
+				fragmentation += allocator.GetStats().GetFragmentation();
+				checks++;
+			}
+		}
+		passed &= (rejected == 0) && CheckRanges(allocator, live);
+
+		// everything freed merges back into a single block
+		for (TlsfAllocation& allocation : live)
+		{
+			allocator.Free(allocation);
+		}
+		TlsfStats stats = allocator.GetStats();
+		passed &= allocator.IsEmpty() && allocator.Validate() && stats.FreeBlockCount == 1 && stats.LargestFreeBlock == config.Capacity;
+
+		char name[96];
+		snprintf(name, sizeof(name), "%s: %zu live at most, %u full, %.0f%% fragmented", config.Name, peak, failures, fragmentation * 100.0 / checks);
+		return Check(name, passed);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// placement on the headless device: ranges of shared heaps, dedicated heaps for large requests
+	//----------------------------------------------------------------------------------------------------
+	bool RunAllocatorChecks()
+	{
+		RecordingDevice device;
+		GpuMemoryAllocator memory;
+		if (!memory.Init(&device, 1024 * 1024))
+		{
+			return Check("allocator initialized", false);
+		}
+
+		GpuAllocation upload[3] = {};
+		bool allocated = true;
+		for (GpuAllocation& allocation : upload)
+		{
+			allocated &= memory.Allocate(GfxHeapType::Upload, 1000, allocation);
+		}
+		bool passed = Check("small buffers share one heap and one buffer", allocated
+			&& upload[0].pResource == upload[1].pResource && upload[1].pResource == upload[2].pResource
+			&& memory.GetStats().HeapCount == 1 && memory.GetStats().HeapCreations == 1);
+
+		bool placed = true;
+		for (uint32_t i = 0; i < 3 && allocated; ++i)
+		{
+			const GpuAllocation& allocation = upload[i];
+			placed &= (allocation.Offset % GpuMemoryAllocator::DefaultAlignment == 0)
+				&& (allocation.GPU == allocation.pResource->GetGPUVirtualAddress() + allocation.Offset) && (allocation.pCPU != nullptr);
+			for (uint32_t j = 0; j < i; ++j)
+			{
+				placed &= (allocation.Offset >= upload[j].Offset + upload[j].Size) || (upload[j].Offset >= allocation.Offset + allocation.Size);
+			}
+		}
+		if (placed)
+		{
+			// mapped for good, writing every byte of the ranges must stay inside the heap
+			for (const GpuAllocation& allocation : upload)
+			{
+				memset(allocation.pCPU, 0xcd, static_cast<size_t>(allocation.Size));
+			}
+		}
+		passed &= Check("ranges aligned, disjoint and mapped", placed);
+
+		GpuAllocation local = {};
+		GpuAllocation large = {};
+		bool heaps = memory.Allocate(GfxHeapType::Default, 4096, local) && memory.Allocate(GfxHeapType::Upload, 3 * 1024 * 1024, large);
+		heaps &= (local.pCPU == nullptr) && (local.pResource != upload[0].pResource) && (large.pResource != upload[0].pResource)
+			&& memory.GetStats().HeapCount == 3;
+		memory.Free(large);
+		heaps &= (large.Block == GpuMemoryAllocator::InvalidBlock) && memory.GetStats().HeapCount == 2;
+		passed &= Check("default heap apart, dedicated heap freed with it", heaps);
+
+		// freed ranges are handed out again without new heaps
+		for (GpuAllocation& allocation : upload)
+		{
+			memory.Free(allocation);
+		}
+		memory.Free(local);
+		GpuMemoryStats stats = memory.GetStats();
+		GpuAllocation again = {};
+		bool reused = stats.AllocationCount == 0 && stats.UsedBytes == 0 && memory.Allocate(GfxHeapType::Upload, 1000, again)
+			&& memory.GetStats().HeapCreations == 3;
+		memory.Free(again);
+		passed &= Check("freed ranges reused without new heaps", reused);
+
+		memory.Term();
+		return passed;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// nanoseconds per allocation and free with LiveCount allocations around
+	//----------------------------------------------------------------------------------------------------
+	double TimeTlsf(uint32_t operations, uint32_t seed)
+	{
+		TlsfAllocator allocator;
+		allocator.Reset(64ull * 1024 * 1024, 256);
+
+		Random random = { seed };
+		std::vector<TlsfAllocation> live(LiveCount);
+		for (TlsfAllocation& allocation : live)
+		{
+			allocator.Allocate(256 + random.Next(16 * 1024), 256, allocation);
+		}
+
+		auto begin = BenchClock::now();
+		for (uint32_t i = 0; i < operations; ++i)
+		{
+			TlsfAllocation& allocation = live[random.Next(LiveCount)];
+			allocator.Free(allocation);
+			allocator.Allocate(256 + random.Next(16 * 1024), 256, allocation);
+		}
+		return ElapsedMs(begin, BenchClock::now()) * 1e6 / (2.0 * operations);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// the same through the GPU allocator (mutex and heap lookup included)
+	//----------------------------------------------------------------------------------------------------
+	double TimeGpuMemory(uint32_t operations, uint32_t seed)
+	{
+		RecordingDevice device;
+		GpuMemoryAllocator memory;
+		memory.Init(&device, 64 * 1024 * 1024);
+
+		Random random = { seed };
+		std::vector<GpuAllocation> live(LiveCount);
+		for (GpuAllocation& allocation : live)
+		{
+			memory.Allocate(GfxHeapType::Default, 256 + random.Next(16 * 1024), allocation);
+		}
+
+		auto begin = BenchClock::now();
+		for (uint32_t i = 0; i < operations; ++i)
+		{
+			GpuAllocation& allocation = live[random.Next(LiveCount)];
+			memory.Free(allocation);
+			memory.Allocate(GfxHeapType::Default, 256 + random.Next(16 * 1024), allocation);
+		}
+		double ns = ElapsedMs(begin, BenchClock::now()) * 1e6 / (2.0 * operations);
+
+		memory.Term();
+		return ns;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 TLSF fuzz checks, placement checks, memory of small buffers committed vs. sub-allocated, then timing
+//--------------------------------------------------------------------------------------------------------
+int RunGpuMemoryBenchmark(int argc, char** argv)
+{
+	uint32_t operations = std::max(ArgU32(argc, argv, 1, DefaultOperations), 1u);
+	uint32_t seed = ArgU32(argc, argv, 2, DefaultSeed);
+
+	const FuzzConfig configs[] = {
+		{ "units", 1 << 20, 1, 4096, 6 },
+		{ "bytes by 256", 16 * 1024 * 1024, 256, 1024 * 1024, 16 },
+		{ "crowded", 64 * 1024, 16, 8192, 12 },
+	};
+
+	printf("gpumemory: %u operations per fuzz run, seed %u\n", operations, seed);
+	bool passed = true;
+	for (const FuzzConfig& config : configs)
+	{
+		passed &= RunFuzz(config, operations, seed);
+	}
+	passed &= RunAllocatorChecks();
+	int result = passed ? 0 : 1;
+
+	// the constant buffers and meshes of a scene: a committed resource takes at least 64 KB and a kernel
+	// allocation each, sub-allocated they share a few heaps
+	RecordingDevice device;
+	GpuMemoryAllocator memory;
+	if (!memory.Init(&device))
+	{
+		printf("gpumemory: cannot initialize the allocator\n");
+		return 1;
+	}
+
+	Random random = { seed };
+	std::vector<GpuAllocation> buffers(BufferCount);
+	uint64_t requested = 0;
+	bool allocated = true;
+	for (GpuAllocation& buffer : buffers)
+	{
+		uint64_t size = 256 + random.Next(4096);
+		allocated &= memory.Allocate(GfxHeapType::Upload, size, buffer);
+		requested += size;
+	}
+	GpuMemoryStats stats = memory.GetStats();
+	result |= allocated ? 0 : 1;
+
+	printf("gpumemory: %u buffers, %llu KB requested\n", BufferCount, static_cast<unsigned long long>(requested / 1024));
+	printf("%14s %12s %12s %14s%s\n", "", "reserved KB", "heaps", "fragmented %", allocated ? "" : "  MISMATCH");
+	printf("%14s %12llu %12u %14s\n", "committed", static_cast<unsigned long long>(BufferCount * CommittedAlignment / 1024), BufferCount, "-");
+	printf("%14s %12llu %12llu %14.1f\n", "sub-allocated", static_cast<unsigned long long>(stats.ReservedBytes / 1024),
+		static_cast<unsigned long long>(stats.HeapCreations), stats.GetFragmentation() * 100.0);
+
+	for (GpuAllocation& buffer : buffers)
+	{
+		memory.Free(buffer);
+	}
+	memory.Term();
+
+	printf("gpumemory: ns per allocation or free, %u live\n", LiveCount);
+	printf("%14s %12.1f\n", "tlsf", TimeTlsf(operations, seed));
+	printf("%14s %12.1f\n", "gpu allocator", TimeGpuMemory(operations, seed));
+	return result;
+}
@@ -0,0 +1,79 @@
+//--------------------------------------------------------
+// Includes
+//--------------------------------------------------------
+#include "Bench.h"
+#include <cstdio>
+#include <cstring>
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------
+	// list of benchmarks
+	//----------------------------------------------------
+	struct BenchEntry
+	{
+		const char* Name; // name on the command line
+		int (*Run)(int argc, char** argv); // entry point
+		const char* Usage; // arguments
+	};
+
+	const BenchEntry Benchmarks[] = {
+		{ "recording", RunRecordingBenchmark, "[draws] [max workers] [frames]" },
+		{ "uploadring", RunUploadRingBenchmark, "[allocations per frame] [frames]" },
+		{ "descriptors", RunDescriptorsBenchmark, "[operations] [live descriptors]" },
+		{ "raster", RunRasterBenchmark, "[width] [height] [max workers] [frames] [image.ppm] [golden.ppm]" },
+		{ "transforms", RunTransformBenchmark, "[objects] [iterations]" },
+		{ "culling", RunCullingBenchmark, "[max workers] [iterations]" },
+		{ "bvh", RunBvhBenchmark, "[objects] [queries]" },
+		{ "meshload", RunMeshLoadBenchmark, "[megabytes] [files]" },
+		{ "meshopt", RunMeshOptBenchmark, "[grid size] [torus segments]" },
+		{ "vertexformat", RunVertexFormatBenchmark, "[vertices] [iterations]" },
+		{ "pipelinecache", RunPipelineCacheBenchmark, "[permutations] [compile us] [compile threads]" },
+		{ "shaderstore", RunShaderStoreBenchmark, "[permutations] [average KB]" },
+		{ "frametimeline", RunFrameTimelineBenchmark, "[frames] [cpu us] [gpu us] [gpu jitter us]" },
+		{ "deferredrelease", RunDeferredReleaseBenchmark, "[frames] [buffers per frame] [gpu us]" },
+		{ "profiler", RunProfilerBenchmark, "[scopes per thread] [threads]" },
+		{ "barriers", RunBarriersBenchmark, "[transitions] [resources]" },
+		{ "frame", RunFrameBenchmark, "[frames] [report.json|-] [objects] [vertices] [frames in flight] [instancing]" },
+		{ "rendergraph", RunRenderGraphBenchmark, "[passes] [iterations]" },
+		{ "gpumemory", RunGpuMemoryBenchmark, "[operations] [seed]" },
+		{ "uploads", RunUploadsBenchmark, "[megabytes] [frames]" },
+		{ "streaming", RunStreamingBenchmark, "[assets] [frames]" },
+		{ "archive", RunArchiveBenchmark, "[assets] [average KB]" },
+		{ "drawsort", RunDrawSortBenchmark, "[keys] [iterations]" },
+	};
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------
+// "Benchmark" runs everything with default arguments,
+// "Benchmark <name> [args...]" runs one benchmark
+//--------------------------------------------------------
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		int result = 0;
+		for (const BenchEntry& entry : Benchmarks)
+		{
+			char* args[] = { const_cast<char*>(entry.Name) };
+			result |= entry.Run(1, args);
+		}
+		return result;
+	}
+
+	for (const BenchEntry& entry : Benchmarks)
+	{
+		if (strcmp(argv[1], entry.Name) == 0)
+		{
+			return entry.Run(argc - 1, argv + 1);
+		}
+	}
+
+	printf("usage: %s [benchmark [args...]]\n", argv[0]);
+	for (const BenchEntry& entry : Benchmarks)
+	{
+		printf("  %s %s\n", entry.Name, entry.Usage);
+	}
+	return 1;
+}
@@ -0,0 +1,229 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <MeshFile.h>
+#include <ShaderTypes.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultMegabytes = 512; // total size of the mesh set
+	const uint32_t DefaultFileCount = 8; // files the set is split into
+	const uint32_t IterationCount = 5; // loads measured per variant
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// LoadTarget structure - stands in for the upload buffers of App::CreateGeometry()
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct LoadTarget
+	{
+		std::vector<uint8_t> Vertices; // vertex buffer
+		std::vector<uint8_t> Indices; // index buffer
+		uint64_t VertexSize; // bytes written to Vertices
+		uint64_t IndexSize; // bytes written to Indices
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// grid mesh of about the size in bytes
+	//----------------------------------------------------------------------------------------------------
+	bool WriteGridMesh(const std::string& path, uint64_t size, uint32_t& seed)
+	{
+		// a grid of n x n vertices has 6 (n - 1)^2 indices, about 24 + 28 bytes per vertex
+		uint32_t n = 2;
+		while (uint64_t(n + 1) * (n + 1) * (sizeof(Vertex) + 6 * sizeof(uint32_t)) <= size)
+		{
+			n++;
+		}
+
+		std::vector<Vertex> vertices(size_t(n) * n);
+		for (uint32_t y = 0; y < n; ++y)
+		{
+			for (uint32_t x = 0; x < n; ++x)
+			{
+				seed = seed * 1664525u + 1013904223u;
+				float h = float(seed >> 8) / float(1u << 24);
+				Vertex& vertex = vertices[size_t(y) * n + x];
+				vertex.Position = DirectX::XMFLOAT3(float(x) / float(n - 1) * 2.f - 1.f, float(y) / float(n - 1) * 2.f - 1.f, h * 0.1f);
+				vertex.Color = DirectX::XMFLOAT4(h, 1.f - h, 0.5f, 1.f);
+			}
+		}
+
+		std::vector<uint32_t> indices;
+		indices.reserve(size_t(n - 1) * (n - 1) * 6);
+		for (uint32_t y = 0; y + 1 < n; ++y)
+		{
+			for (uint32_t x = 0; x + 1 < n; ++x)
+			{
+				uint32_t i = y * n + x;
+				uint32_t quad[] = { i, i + 1, i + n + 1, i, i + n + 1, i + n };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+		}
+
+		MeshFileSubmesh submesh = {};
+		submesh.IndexCount = static_cast<uint32_t>(indices.size());
+		submesh.BoundsMin[0] = submesh.BoundsMin[1] = -1.f;
+		submesh.BoundsMax[0] = submesh.BoundsMax[1] = 1.f;
+		submesh.BoundsMax[2] = 0.1f;
+
+		MeshFileDesc desc = {};
+		desc.VertexCount = static_cast<uint32_t>(vertices.size());
+		desc.StreamCount = 1;
+		desc.pStreams[0] = vertices.data();
+		desc.Strides[0] = sizeof(Vertex);
+		desc.Layouts[0] = MeshVertexLayout::PositionColor;
+		desc.pIndices = indices.data();
+		desc.IndexCount = submesh.IndexCount;
+		desc.IndexFormat = GfxFormat::R32_Uint;
+		desc.pSubmeshes = &submesh;
+		desc.SubmeshCount = 1;
+		memcpy(desc.BoundsMin, submesh.BoundsMin, sizeof(desc.BoundsMin));
+		memcpy(desc.BoundsMax, submesh.BoundsMax, sizeof(desc.BoundsMax));
+		return MeshFile::Write(path.c_str(), desc);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// read the whole file into a heap buffer, then copy the streams out of it
+	//----------------------------------------------------------------------------------------------------
+	bool LoadRead(const std::string& path, std::vector<uint8_t>& buffer, LoadTarget& target)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			return false;
+		}
+
+		buffer.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0, std::ios::beg);
+		if (!file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size())))
+		{
+			return false;
+		}
+
+		MeshFileHeader header;
+		memcpy(&header, buffer.data(), sizeof(header));
+		memcpy(target.Vertices.data(), buffer.data() + header.Streams[0].Offset, static_cast<size_t>(header.Streams[0].Size));
+		memcpy(target.Indices.data(), buffer.data() + header.Indices.Offset, static_cast<size_t>(header.Indices.Size));
+		target.VertexSize = header.Streams[0].Size;
+		target.IndexSize = header.Indices.Size;
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// map the file and copy the streams straight out of the mapping
+	//----------------------------------------------------------------------------------------------------
+	bool LoadMapped(const std::string& path, LoadTarget& target)
+	{
+		MeshFile mesh;
+		if (!mesh.Open(path.c_str()))
+		{
+			return false;
+		}
+
+		const MeshFileHeader& header = mesh.GetHeader();
+		memcpy(target.Vertices.data(), mesh.GetStreamData(0), static_cast<size_t>(header.Streams[0].Size));
+		memcpy(target.Indices.data(), mesh.GetIndexData(), static_cast<size_t>(header.Indices.Size));
+		target.VertexSize = header.Streams[0].Size;
+		target.IndexSize = header.Indices.Size;
+		return true;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 load a set of mesh files with read() + copy against mmap + copy (the page cache is warm for both)
+//--------------------------------------------------------------------------------------------------------
+int RunMeshLoadBenchmark(int argc, char** argv)
+{
+	uint32_t megabytes = std::max(ArgU32(argc, argv, 1, DefaultMegabytes), 1u);
+	uint32_t fileCount = std::max(ArgU32(argc, argv, 2, DefaultFileCount), 1u);
+
+	std::error_code error;
+	std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "ReLearnD3D12_meshload";
+	std::filesystem::create_directories(directory, error);
+
+	// the set is written once, both variants read the same files
+	std::vector<std::string> paths;
+	uint64_t totalSize = 0;
+	uint32_t seed = 12345u;
+	for (uint32_t i = 0; i < fileCount; ++i)
+	{
+		std::string path = (directory / ("mesh" + std::to_string(i) + ".mesh")).string();
+		if (!WriteGridMesh(path, uint64_t(megabytes) * 1024 * 1024 / fileCount, seed))
+		{
+			printf("meshload: cannot write %s\n", path.c_str());
+			return 1;
+		}
+		paths.push_back(path);
+		totalSize += std::filesystem::file_size(path, error);
+	}
+
+	// destination is allocated and touched up front like a persistently mapped upload buffer
+	LoadTarget readTarget = {};
+	LoadTarget mappedTarget = {};
+	for (LoadTarget* pTarget : { &readTarget, &mappedTarget })
+	{
+		pTarget->Vertices.assign(static_cast<size_t>(totalSize / fileCount), 0);
+		pTarget->Indices.assign(static_cast<size_t>(totalSize / fileCount), 0);
+	}
+
+	printf("meshload: %u files, %.1f MB, median of %u loads of the whole set\n", fileCount, double(totalSize) / (1024.0 * 1024.0), IterationCount);
+	printf("%12s %10s %10s %10s\n", "variant", "ms", "GB/s", "speedup");
+
+	int result = 0;
+	std::vector<uint8_t> buffer;
+	std::vector<double> readSamples;
+	std::vector<double> mappedSamples;
+	for (uint32_t i = 0; i <= IterationCount; ++i)
+	{
+		bool match = true;
+
+		auto begin = BenchClock::now();
+		for (const std::string& path : paths)
+		{
+			match &= LoadRead(path, buffer, readTarget);
+		}
+		auto end = BenchClock::now();
+		if (i > 0)
+		{
+			readSamples.push_back(ElapsedMs(begin, end));
+		}
+
+		begin = BenchClock::now();
+		for (const std::string& path : paths)
+		{
+			match &= LoadMapped(path, mappedTarget);
+		}
+		end = BenchClock::now();
+		if (i > 0)
+		{
+			mappedSamples.push_back(ElapsedMs(begin, end));
+		}
+
+		// both variants leave the last file of the set in the destination
+		match &= readTarget.VertexSize == mappedTarget.VertexSize && readTarget.IndexSize == mappedTarget.IndexSize
+			&& memcmp(readTarget.Vertices.data(), mappedTarget.Vertices.data(), static_cast<size_t>(readTarget.VertexSize)) == 0
+			&& memcmp(readTarget.Indices.data(), mappedTarget.Indices.data(), static_cast<size_t>(readTarget.IndexSize)) == 0;
+		result |= match ? 0 : 1;
+	}
+
+	double readMs = Median(readSamples);
+	double mappedMs = Median(mappedSamples);
+	double gigabytes = double(totalSize) / (1024.0 * 1024.0 * 1024.0);
+	printf("%12s %10.3f %10.2f %9.2fx\n", "read+copy", readMs, gigabytes * 1000.0 / readMs, 1.0);
+	printf("%12s %10.3f %10.2f %9.2fx%s\n", "mmap+copy", mappedMs, gigabytes * 1000.0 / mappedMs,
+		(mappedMs > 0.0) ? readMs / mappedMs : 0.0, (result == 0) ? "" : "  MISMATCH");
+
+	std::filesystem::remove_all(directory, error);
+	return result;
+}
@@ -0,0 +1,325 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <MeshOptimizer.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultGridSize = 256; // vertices per side of the grid (65536 still fits 16-bit indices)
+	const uint32_t DefaultTorusSegments = 768; // segments around the torus, a quarter of that around the tube (too many for 16-bit indices)
+	const uint32_t OverdrawResolution = 256; // pixels per side of the overdraw views
+	const float PI = 3.14159265f;
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// MeshVertex structure - position and the index the vertex was generated with
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct MeshVertex
+	{
+		float Position[3]; // position
+		uint32_t Id; // original index, survives OptimizeVertexFetch()
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// TestMesh structure
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct TestMesh
+	{
+		const char* pName; // name in the output
+		std::vector<MeshVertex> Vertices; // vertices
+		std::vector<uint32_t> Indices; // triangle list with consistent outward winding
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// shuffle the triangles and the vertices the way an unordered exporter would leave them
+	//----------------------------------------------------------------------------------------------------
+	void Shuffle(TestMesh& mesh)
+	{
+		uint32_t seed = 12345u;
+		auto random = [&seed](uint32_t count)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			return static_cast<uint32_t>((uint64_t(seed) * count) >> 32);
+		};
+
+		uint32_t triangleCount = static_cast<uint32_t>(mesh.Indices.size() / 3);
+		for (uint32_t t = triangleCount - 1; t > 0; --t)
+		{
+			uint32_t other = random(t + 1);
+			std::swap_ranges(&mesh.Indices[t * 3], &mesh.Indices[t * 3] + 3, &mesh.Indices[other * 3]);
+		}
+
+		uint32_t vertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+		std::vector<uint32_t> remap(vertexCount);
+		for (uint32_t v = 0; v < vertexCount; ++v)
+		{
+			remap[v] = v;
+		}
+		for (uint32_t v = vertexCount - 1; v > 0; --v)
+		{
+			std::swap(remap[v], remap[random(v + 1)]);
+		}
+
+		std::vector<MeshVertex> vertices(vertexCount);
+		for (uint32_t v = 0; v < vertexCount; ++v)
+		{
+			vertices[remap[v]] = mesh.Vertices[v];
+		}
+		mesh.Vertices.swap(vertices);
+		for (uint32_t& index : mesh.Indices)
+		{
+			index = remap[index];
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// regular grid in the xy plane facing +z
+	//----------------------------------------------------------------------------------------------------
+	void BuildGrid(uint32_t size, TestMesh& mesh)
+	{
+		mesh.pName = "grid";
+		mesh.Vertices.clear();
+		mesh.Indices.clear();
+		for (uint32_t y = 0; y < size; ++y)
+		{
+			for (uint32_t x = 0; x < size; ++x)
+			{
+				MeshVertex vertex = { { float(x), float(y), 0.f }, y * size + x };
+				mesh.Vertices.push_back(vertex);
+			}
+		}
+
+		for (uint32_t y = 0; y + 1 < size; ++y)
+		{
+			for (uint32_t x = 0; x + 1 < size; ++x)
+			{
+				uint32_t i = y * size + x;
+				uint32_t quad[] = { i, i + 1, i + size + 1, i, i + size + 1, i + size };
+				mesh.Indices.insert(mesh.Indices.end(), quad, quad + 6);
+			}
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// torus around the z axis, occludes itself from the side
+	//----------------------------------------------------------------------------------------------------
+	void BuildTorus(uint32_t segments, TestMesh& mesh)
+	{
+		uint32_t rings = std::max(segments / 4, 3u);
+		mesh.pName = "torus";
+		mesh.Vertices.clear();
+		mesh.Indices.clear();
+		for (uint32_t i = 0; i < segments; ++i)
+		{
+			float u = 2.f * PI * float(i) / float(segments);
+			for (uint32_t j = 0; j < rings; ++j)
+			{
+				float v = 2.f * PI * float(j) / float(rings);
+				float r = 1.f + 0.4f * cosf(v);
+				MeshVertex vertex = { { r * cosf(u), r * sinf(u), 0.4f * sinf(v) }, i * rings + j };
+				mesh.Vertices.push_back(vertex);
+			}
+		}
+
+		for (uint32_t i = 0; i < segments; ++i)
+		{
+			for (uint32_t j = 0; j < rings; ++j)
+			{
+				uint32_t a = i * rings + j;
+				uint32_t b = ((i + 1) % segments) * rings + j;
+				uint32_t c = ((i + 1) % segments) * rings + (j + 1) % rings;
+				uint32_t d = i * rings + (j + 1) % rings;
+				uint32_t quad[] = { a, b, c, a, c, d };
+				mesh.Indices.insert(mesh.Indices.end(), quad, quad + 6);
+			}
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// triangles as sorted lists of original vertex ids (rotated to the smallest id, winding kept)
+	//----------------------------------------------------------------------------------------------------
+	std::vector<uint64_t> TriangleKeys(const TestMesh& mesh)
+	{
+		std::vector<uint64_t> keys;
+		for (size_t t = 0; t < mesh.Indices.size(); t += 3)
+		{
+			uint32_t ids[3] = { mesh.Vertices[mesh.Indices[t]].Id, mesh.Vertices[mesh.Indices[t + 1]].Id, mesh.Vertices[mesh.Indices[t + 2]].Id };
+			uint32_t first = (ids[0] < ids[1]) ? ((ids[0] < ids[2]) ? 0 : 2) : ((ids[1] < ids[2]) ? 1 : 2);
+			keys.push_back((uint64_t(ids[first]) << 42) | (uint64_t(ids[(first + 1) % 3]) << 21) | ids[(first + 2) % 3]);
+		}
+		std::sort(keys.begin(), keys.end());
+		return keys;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// fragments shaded per covered pixel, front faces rendered orthographically from the 6 axis directions
+	//----------------------------------------------------------------------------------------------------
+	float AnalyzeOverdraw(const TestMesh& mesh)
+	{
+		float boundsMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+		float boundsMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		for (const MeshVertex& vertex : mesh.Vertices)
+		{
+			for (uint32_t a = 0; a < 3; ++a)
+			{
+				boundsMin[a] = std::min(boundsMin[a], vertex.Position[a]);
+				boundsMax[a] = std::max(boundsMax[a], vertex.Position[a]);
+			}
+		}
+		float extent = std::max(std::max(boundsMax[0] - boundsMin[0], boundsMax[1] - boundsMin[1]), boundsMax[2] - boundsMin[2]);
+		float scale = float(OverdrawResolution - 1) / std::max(extent, FLT_MIN);
+
+		std::vector<float> depth(OverdrawResolution * OverdrawResolution);
+		uint64_t shaded = 0;
+		uint64_t covered = 0;
+		for (uint32_t view = 0; view < 6; ++view)
+		{
+			uint32_t axis = view / 2;
+			float sign = (view & 1) ? -1.f : 1.f;
+			uint32_t axisU = (axis + 1) % 3;
+			uint32_t axisV = (axis + 2) % 3;
+			std::fill(depth.begin(), depth.end(), FLT_MAX);
+
+			for (size_t t = 0; t < mesh.Indices.size(); t += 3)
+			{
+				const float* p[3] = { mesh.Vertices[mesh.Indices[t]].Position, mesh.Vertices[mesh.Indices[t + 1]].Position, mesh.Vertices[mesh.Indices[t + 2]].Position };
+
+				// the viewer sits at sign * infinity on the axis
+				float e1[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+				float e2[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+				float normal = e1[axisU] * e2[axisV] - e1[axisV] * e2[axisU];
+				if (normal * sign <= 0.f)
+				{
+					continue;
+				}
+
+				float x[3], y[3], z[3];
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					x[k] = (p[k][axisU] - boundsMin[axisU]) * scale;
+					y[k] = (p[k][axisV] - boundsMin[axisV]) * scale;
+					z[k] = -sign * p[k][axis];
+				}
+
+				float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+				int32_t minX = std::max(static_cast<int32_t>(floorf(std::min(std::min(x[0], x[1]), x[2]))), 0);
+				int32_t maxX = std::min(static_cast<int32_t>(ceilf(std::max(std::max(x[0], x[1]), x[2]))), int32_t(OverdrawResolution) - 1);
+				int32_t minY = std::max(static_cast<int32_t>(floorf(std::min(std::min(y[0], y[1]), y[2]))), 0);
+				int32_t maxY = std::min(static_cast<int32_t>(ceilf(std::max(std::max(y[0], y[1]), y[2]))), int32_t(OverdrawResolution) - 1);
+				for (int32_t py = minY; py <= maxY; ++py)
+				{
+					for (int32_t px = minX; px <= maxX; ++px)
+					{
+						float sx = float(px) + 0.5f;
+						float sy = float(py) + 0.5f;
+						float w0 = ((x[2] - x[1]) * (sy - y[1]) - (y[2] - y[1]) * (sx - x[1])) / area;
+						float w1 = ((x[0] - x[2]) * (sy - y[2]) - (y[0] - y[2]) * (sx - x[2])) / area;
+						float w2 = 1.f - w0 - w1;
+						if (w0 < 0.f || w1 < 0.f || w2 < 0.f)
+						{
+							continue;
+						}
+
+						float d = w0 * z[0] + w1 * z[1] + w2 * z[2];
+						float& stored = depth[py * OverdrawResolution + px];
+						if (d < stored)
+						{
+							stored = d;
+							shaded++;
+						}
+					}
+				}
+			}
+
+			for (float d : depth)
+			{
+				covered += (d != FLT_MAX) ? 1 : 0;
+			}
+		}
+
+		return (covered > 0) ? float(double(shaded) / double(covered)) : 0.f;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// one row of the table
+	//----------------------------------------------------------------------------------------------------
+	void PrintStage(MeshOptimizer& optimizer, const TestMesh& mesh, const char* pStage, double ms)
+	{
+		uint32_t indexCount = static_cast<uint32_t>(mesh.Indices.size());
+		uint32_t vertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+		VertexCacheStats cache = optimizer.AnalyzeVertexCache(mesh.Indices.data(), indexCount, vertexCount);
+		VertexCacheStats cache32 = optimizer.AnalyzeVertexCache(mesh.Indices.data(), indexCount, vertexCount, 32);
+		VertexFetchStats fetch = optimizer.AnalyzeVertexFetch(mesh.Indices.data(), indexCount, vertexCount, sizeof(MeshVertex));
+		printf("%6s %13s %8.3f %8.3f %8.3f %10.3f %9.3f %10.3f\n",
+			mesh.pName, pStage, cache.ACMR, cache.ATVR, cache32.ACMR, fetch.Overfetch, AnalyzeOverdraw(mesh), ms);
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 ACMR/ATVR (FIFO 16 and 32), overfetch and overdraw after each MeshOptimizer stage on shuffled meshes
+//--------------------------------------------------------------------------------------------------------
+int RunMeshOptBenchmark(int argc, char** argv)
+{
+	uint32_t gridSize = std::max(ArgU32(argc, argv, 1, DefaultGridSize), 2u);
+	uint32_t torusSegments = std::max(ArgU32(argc, argv, 2, DefaultTorusSegments), 3u);
+
+	printf("meshopt: shuffled input, FIFO post-transform cache, %u byte vertices\n", uint32_t(sizeof(MeshVertex)));
+	printf("%6s %13s %8s %8s %8s %10s %9s %10s\n", "mesh", "stage", "ACMR", "ATVR", "ACMR32", "overfetch", "overdraw", "ms");
+
+	int result = 0;
+	for (uint32_t m = 0; m < 2; ++m)
+	{
+		TestMesh mesh;
+		if (m == 0)
+		{
+			BuildGrid(gridSize, mesh);
+		}
+		else
+		{
+			BuildTorus(torusSegments, mesh);
+		}
+		Shuffle(mesh);
+		std::vector<uint64_t> expected = TriangleKeys(mesh);
+
+		MeshOptimizer optimizer;
+		uint32_t indexCount = static_cast<uint32_t>(mesh.Indices.size());
+		uint32_t vertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+		PrintStage(optimizer, mesh, "input", 0.0);
+
+		auto begin = BenchClock::now();
+		optimizer.OptimizeVertexCache(mesh.Indices.data(), indexCount, vertexCount);
+		auto end = BenchClock::now();
+		PrintStage(optimizer, mesh, "vertex cache", ElapsedMs(begin, end));
+
+		begin = BenchClock::now();
+		optimizer.OptimizeOverdraw(mesh.Indices.data(), indexCount, mesh.Vertices[0].Position, sizeof(MeshVertex), vertexCount);
+		end = BenchClock::now();
+		PrintStage(optimizer, mesh, "overdraw", ElapsedMs(begin, end));
+
+		begin = BenchClock::now();
+		vertexCount = optimizer.OptimizeVertexFetch(mesh.Vertices.data(), vertexCount, sizeof(MeshVertex), mesh.Indices.data(), indexCount);
+		end = BenchClock::now();
+		mesh.Vertices.resize(vertexCount);
+		PrintStage(optimizer, mesh, "vertex fetch", ElapsedMs(begin, end));
+
+		bool fits = MeshOptimizer::Fits16BitIndices(vertexCount);
+		bool match = TriangleKeys(mesh) == expected;
+		printf("%6s %u vertices, %u triangles, index buffer %u KB (%s)%s\n",
+			mesh.pName, vertexCount, indexCount / 3, indexCount * (fits ? 2 : 4) / 1024, fits ? "16-bit" : "32-bit",
+			match ? "" : "  MISMATCH");
+
+		result |= match ? 0 : 1;
+	}
+
+	return result;
+}
@@ -0,0 +1,313 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <PipelineCache.h>
+#include <RecordingDevice.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultPermutationCount = 256; // pipelines of the simulated level
+	const uint32_t DefaultCompileTime = 2000; // simulated driver compile time in microseconds
+	const uint32_t DefaultThreadCount = 4; // compile threads of the async scenarios
+	const uint32_t PermutationsPerFrame = 32; // pipelines the level requests per frame while loading
+	const uint32_t UsersPerPipeline = 4; // objects sharing each pipeline (all of them request it)
+	const uint32_t ShaderSize = 4096; // bytes of fake bytecode per shader
+	const uint32_t KeyIterations = 20; // iterations of the key measurement
+	const double FrameBudgetMs = 16.6; // frames longer than this count as stalls
+
+	//----------------------------------------------------------------------------------------------------
+	// permutations of the desc with storage for everything it points at
+	//----------------------------------------------------------------------------------------------------
+	struct Permutations
+	{
+		std::vector<std::vector<uint8_t>> Shaders; // vertex shaders then pixel shaders
+		std::vector<GfxInputElementDesc> Elements; // float layout (2) then packed layout (2)
+		std::vector<GfxGraphicsPipelineDesc> Descs;
+	};
+
+	void BuildPermutations(uint32_t count, GfxRootSignature* pRootSignature, Permutations& perms)
+	{
+		// one vertex shader per permutation, pixel shaders shared by groups of eight
+		uint32_t seed = 777u;
+		uint32_t psCount = (count + 7) / 8;
+		perms.Shaders.resize(count + psCount);
+		for (std::vector<uint8_t>& shader : perms.Shaders)
+		{
+			shader.resize(ShaderSize);
+			for (uint8_t& byte : shader)
+			{
+				seed = seed * 1664525u + 1013904223u;
+				byte = static_cast<uint8_t>(seed >> 24);
+			}
+		}
+
+		const GfxFormat positionFormats[] = { GfxFormat::R32G32B32_Float, GfxFormat::R16G16B16A16_Snorm };
+		const GfxFormat colorFormats[] = { GfxFormat::R32G32B32A32_Float, GfxFormat::R8G8B8A8_Unorm };
+		for (uint32_t layout = 0; layout < 2; ++layout)
+		{
+			GfxInputElementDesc position = { "POSITION", 0, positionFormats[layout], 0, GfxAppendAlignedElement, GfxInputClassification::PerVertexData, 0 };
+			GfxInputElementDesc color = { "COLOR", 0, colorFormats[layout], 0, GfxAppendAlignedElement, GfxInputClassification::PerVertexData, 0 };
+			perms.Elements.push_back(position);
+			perms.Elements.push_back(color);
+		}
+
+		const GfxCullMode cullModes[] = { GfxCullMode::None, GfxCullMode::Front, GfxCullMode::Back };
+		const GfxFormat targetFormats[] = { GfxFormat::R8G8B8A8_Unorm_sRGB, GfxFormat::R8G8B8A8_Unorm };
+		perms.Descs.resize(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			GfxGraphicsPipelineDesc& desc = perms.Descs[i];
+			desc = GfxGraphicsPipelineDesc();
+			desc.pRootSignature = pRootSignature;
+			desc.VS = { perms.Shaders[i].data(), perms.Shaders[i].size() };
+			desc.PS = { perms.Shaders[count + i / 8].data(), perms.Shaders[count + i / 8].size() };
+			desc.pInputElementDescs = &perms.Elements[(i % 2) * 2];
+			desc.NumInputElements = 2;
+			desc.RasterizerState.FillMode = GfxFillMode::Solid;
+			desc.RasterizerState.CullMode = cullModes[(i / 2) % 3];
+			desc.BlendState.BlendEnable = ((i / 6) % 2) != 0;
+			desc.BlendState.SrcBlend = desc.BlendState.BlendEnable ? GfxBlend::SrcAlpha : GfxBlend::One;
+			desc.BlendState.DestBlend = desc.BlendState.BlendEnable ? GfxBlend::InvSrcAlpha : GfxBlend::Zero;
+			desc.BlendState.BlendOp = GfxBlendOp::Add;
+			desc.BlendState.SrcBlendAlpha = GfxBlend::One;
+			desc.BlendState.DestBlendAlpha = GfxBlend::Zero;
+			desc.BlendState.BlendOpAlpha = GfxBlendOp::Add;
+			desc.BlendState.RenderTargetWriteMask = GfxColorWriteEnableAll;
+			desc.DepthStencilState.DepthFunc = GfxComparisonFunc::Less;
+			desc.PrimitiveTopology = GfxPrimitiveTopology::TriangleList;
+			desc.RTVFormat = targetFormats[(i / 12) % 2];
+			desc.DSVFormat = GfxFormat::Unknown;
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// keys are unique, independent of where the desc lives and change with every field
+	//----------------------------------------------------------------------------------------------------
+	bool CheckKeys(const Permutations& perms, uint64_t rootSignatureKey)
+	{
+		std::unordered_set<uint64_t> keys;
+		for (const GfxGraphicsPipelineDesc& desc : perms.Descs)
+		{
+			keys.insert(PipelineCache::ComputeKey(desc, rootSignatureKey));
+		}
+
+		// deep copy of the first desc at other addresses
+		const GfxGraphicsPipelineDesc& original = perms.Descs[0];
+		uint64_t originalKey = PipelineCache::ComputeKey(original, rootSignatureKey);
+		std::vector<uint8_t> vs(static_cast<const uint8_t*>(original.VS.pShaderBytecode), static_cast<const uint8_t*>(original.VS.pShaderBytecode) + original.VS.BytecodeLength);
+		std::vector<uint8_t> ps(static_cast<const uint8_t*>(original.PS.pShaderBytecode), static_cast<const uint8_t*>(original.PS.pShaderBytecode) + original.PS.BytecodeLength);
+		std::string names[2] = { original.pInputElementDescs[0].SemanticName, original.pInputElementDescs[1].SemanticName };
+		GfxInputElementDesc elements[2] = { original.pInputElementDescs[0], original.pInputElementDescs[1] };
+		elements[0].SemanticName = names[0].c_str();
+		elements[1].SemanticName = names[1].c_str();
+		GfxGraphicsPipelineDesc copy = original;
+		copy.pRootSignature = nullptr;
+		copy.VS = { vs.data(), vs.size() };
+		copy.PS = { ps.data(), ps.size() };
+		copy.pInputElementDescs = elements;
+		bool stable = PipelineCache::ComputeKey(copy, rootSignatureKey) == originalKey;
+
+		// single field changes
+		uint32_t detected = 0;
+		uint32_t changeCount = 0;
+		auto check = [&](GfxGraphicsPipelineDesc& desc, uint64_t rootKey)
+		{
+			changeCount++;
+			detected += (PipelineCache::ComputeKey(desc, rootKey) != originalKey) ? 1 : 0;
+			desc = copy;
+		};
+
+		GfxGraphicsPipelineDesc changed = copy;
+		check(changed, rootSignatureKey + 1);
+		vs[ShaderSize / 2] ^= 1;
+		check(changed, rootSignatureKey);
+		vs[ShaderSize / 2] ^= 1;
+		changed.PS.BytecodeLength--;
+		check(changed, rootSignatureKey);
+		elements[1].SemanticIndex = 1;
+		check(changed, rootSignatureKey);
+		elements[1].SemanticIndex = 0;
+		names[1][0] = 'K';
+		check(changed, rootSignatureKey);
+		names[1][0] = 'C';
+		changed.NumInputElements = 1;
+		check(changed, rootSignatureKey);
+		changed.RasterizerState.FrontCounterClockwise = true;
+		check(changed, rootSignatureKey);
+		changed.BlendState.RenderTargetWriteMask = 0x7;
+		check(changed, rootSignatureKey);
+		changed.DepthStencilState.DepthFunc = GfxComparisonFunc::LessEqual;
+		check(changed, rootSignatureKey);
+		changed.DSVFormat = GfxFormat::R32_Uint;
+		check(changed, rootSignatureKey);
+
+		bool unique = keys.size() == perms.Descs.size();
+		printf("keys: %u/%u unique, %s across copies, %u/%u single field changes detected\n",
+			uint32_t(keys.size()), uint32_t(perms.Descs.size()), stable ? "stable" : "UNSTABLE", detected, changeCount);
+		return unique && stable && detected == changeCount;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// load a level: requests while the frames run, every object draws with its pipeline or the fallback
+	//----------------------------------------------------------------------------------------------------
+	bool RunScenario(const char* pName, uint32_t threadCount, const char* pLibraryPath, uint32_t compileTime, uint32_t permutationCount)
+	{
+		RecordingDevice device;
+		device.SetPipelineCompileTime(compileTime);
+
+		GfxRootParameter param = { GfxRootParameterType::CBV, 0, 0, GfxShaderVisibility::Vertex, GfxDescriptorRangeType::CBV, 0 };
+		GfxRootSignatureDesc rootDesc = { 1, &param, true };
+		GfxPtr<GfxRootSignature> pRootSignature;
+		if (!device.CreateRootSignature(rootDesc, pRootSignature))
+		{
+			return false;
+		}
+
+		Permutations perms;
+		BuildPermutations(permutationCount, pRootSignature.get(), perms);
+
+		// what a renderer draws with while the real pipeline compiles
+		GfxPtr<GfxPipelineState> pFallback;
+		device.SetPipelineCompileTime(0);
+		if (!device.CreateGraphicsPipelineState(perms.Descs[0], pFallback))
+		{
+			return false;
+		}
+		device.SetPipelineCompileTime(compileTime);
+
+		PipelineCache cache;
+		auto begin = BenchClock::now();
+		if (!cache.Init(&device, threadCount, pLibraryPath))
+		{
+			return false;
+		}
+
+		uint64_t rootSignatureKey = PipelineCache::ComputeKey(rootDesc);
+		std::vector<PipelineHandle> handles;
+		uint32_t frameCount = 0;
+		uint32_t stallCount = 0;
+		double maxFrameMs = 0.0;
+		for (;;)
+		{
+			auto frameBegin = BenchClock::now();
+			uint32_t first = static_cast<uint32_t>(handles.size());
+			uint32_t last = std::min(first + PermutationsPerFrame, permutationCount);
+			for (uint32_t i = first; i < last; ++i)
+			{
+				for (uint32_t user = 0; user < UsersPerPipeline; ++user)
+				{
+					PipelineHandle handle = cache.Request(perms.Descs[i], rootSignatureKey);
+					if (user == 0)
+					{
+						handles.push_back(handle);
+					}
+				}
+			}
+
+			bool missing = false;
+			for (PipelineHandle handle : handles)
+			{
+				missing |= cache.Get(handle, pFallback.get()) == pFallback.get();
+			}
+			auto frameEnd = BenchClock::now();
+
+			double frameMs = ElapsedMs(frameBegin, frameEnd);
+			maxFrameMs = std::max(maxFrameMs, frameMs);
+			stallCount += (frameMs > FrameBudgetMs) ? 1 : 0;
+			frameCount++;
+
+			if (handles.size() == permutationCount && !missing)
+			{
+				break;
+			}
+
+			// the rest of the frame
+			if (frameMs < FrameBudgetMs)
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>((FrameBudgetMs - frameMs) * 1000.0)));
+			}
+		}
+		double readyMs = ElapsedMs(begin, BenchClock::now());
+
+		cache.Term();
+		PipelineCacheStats stats = cache.GetStats();
+		double hitRate = (stats.RequestCount > 0) ? 100.0 * stats.HitCount / stats.RequestCount : 0.0;
+		printf("%-12s %7u %10.1f %10.2f %7u %8llu %8.1f%% %9llu %9llu %10.3f %10.1f\n",
+			pName, frameCount, readyMs, maxFrameMs, stallCount,
+			static_cast<unsigned long long>(stats.HitchCount), hitRate,
+			static_cast<unsigned long long>(stats.LibraryLoadCount),
+			static_cast<unsigned long long>(stats.CompileCount),
+			(stats.CompileCount > 0) ? stats.CompileMs / stats.CompileCount : 0.0,
+			stats.MaxReadyMs);
+		return stats.FailureCount == 0 && stats.LibraryLoadCount + stats.CompileCount == permutationCount;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 pipeline keys, then loading a level with synchronous and background compiles, cold and warm
+//--------------------------------------------------------------------------------------------------------
+int RunPipelineCacheBenchmark(int argc, char** argv)
+{
+	uint32_t permutationCount = std::max(ArgU32(argc, argv, 1, DefaultPermutationCount), 1u);
+	uint32_t compileTime = ArgU32(argc, argv, 2, DefaultCompileTime);
+	uint32_t threadCount = std::max(ArgU32(argc, argv, 3, DefaultThreadCount), 1u);
+
+	// keys without any device
+	Permutations perms;
+	BuildPermutations(permutationCount, nullptr, perms);
+
+	std::vector<double> samples;
+	uint64_t checksum = 0;
+	for (uint32_t i = 0; i <= KeyIterations; ++i)
+	{
+		auto begin = BenchClock::now();
+		for (const GfxGraphicsPipelineDesc& desc : perms.Descs)
+		{
+			checksum ^= PipelineCache::ComputeKey(desc, 1);
+		}
+		auto end = BenchClock::now();
+		if (i > 0)
+		{
+			samples.push_back(ElapsedMs(begin, end));
+		}
+	}
+	std::sort(samples.begin(), samples.end());
+	double keyMs = samples[samples.size() / 2];
+	printf("pipelinecache: %u permutations, %u us simulated compile, %u compile threads, %u requests per pipeline\n",
+		permutationCount, compileTime, threadCount, UsersPerPipeline);
+	printf("keys: %.1f ns per desc (%u bytes of bytecode), checksum %016llx\n",
+		keyMs * 1e6 / permutationCount, 2 * ShaderSize, static_cast<unsigned long long>(checksum));
+
+	int result = CheckKeys(perms, 1) ? 0 : 1;
+
+	std::error_code error;
+	std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "ReLearnD3D12_pipelinecache";
+	std::filesystem::create_directories(directory, error);
+	std::string syncPath = (directory / "sync.bin").string();
+	std::string asyncPath = (directory / "async.bin").string();
+	std::filesystem::remove(syncPath, error);
+	std::filesystem::remove(asyncPath, error);
+
+	printf("%-12s %7s %10s %10s %7s %8s %9s %9s %9s %10s %10s\n",
+		"scenario", "frames", "ready ms", "max frame", "stalls", "hitches", "hit rate", "lib loads", "compiled", "compile ms", "max ready");
+	bool ok = RunScenario("sync cold", 0, syncPath.c_str(), compileTime, permutationCount);
+	ok &= RunScenario("sync warm", 0, syncPath.c_str(), compileTime, permutationCount);
+	ok &= RunScenario("async cold", threadCount, asyncPath.c_str(), compileTime, permutationCount);
+	ok &= RunScenario("async warm", threadCount, asyncPath.c_str(), compileTime, permutationCount);
+	result |= ok ? 0 : 1;
+
+	std::filesystem::remove_all(directory, error);
+	return result;
+}
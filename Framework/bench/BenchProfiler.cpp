@@ -0,0 +1,267 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <CommandListPool.h>
+#include <FrameTimeline.h>
+#include <GpuProfiler.h>
+#include <Profiler.h>
+#include <RecordingDevice.h>
+#include <WorkerPool.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultScopeCount = 100000; // outer scopes per thread (each holds one inner scope)
+	const uint32_t DefaultThreadCount = 4; // threads recording at the same time
+	const uint32_t GpuFrameCount = 64; // frames of the GPU part
+	const uint32_t GpuTime = 2000; // GPU time of a frame in microseconds
+	const uint32_t FramesInFlight = 2; // frames the CPU may run ahead in the GPU part
+
+	std::atomic<uint64_t> g_Sink(0); // keeps the measured loops from being optimized away
+
+	//----------------------------------------------------------------------------------------------------
+	// nested scopes like a frame would open them
+	//----------------------------------------------------------------------------------------------------
+	void RecordScopes(uint32_t count)
+	{
+		uint64_t sum = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			PROFILE_SCOPE("Outer");
+			sum += i;
+			{
+				PROFILE_SCOPE("Inner");
+				sum ^= sum >> 3;
+			}
+		}
+		g_Sink.fetch_add(sum, std::memory_order_relaxed);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// the loop of RecordScopes() without scopes
+	//----------------------------------------------------------------------------------------------------
+	void RecordNothing(uint32_t count)
+	{
+		uint64_t sum = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			sum += i;
+			sum ^= sum >> 3;
+		}
+		g_Sink.fetch_add(sum, std::memory_order_relaxed);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// nanoseconds per scope of the fastest of a few runs
+	//----------------------------------------------------------------------------------------------------
+	double MeasureScopeNs(void (*func)(uint32_t), uint32_t count)
+	{
+		double best = 1e30;
+		for (uint32_t run = 0; run < 3; ++run)
+		{
+			Profiler::Reset();
+			auto begin = BenchClock::now();
+			func(count);
+			best = std::min(best, ElapsedMs(begin, BenchClock::now()));
+		}
+		return best * 1000000.0 / (2.0 * count);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// structure check of the written trace: balanced brackets outside strings and one "X" per event
+	//----------------------------------------------------------------------------------------------------
+	bool CheckTrace(const std::string& path, uint64_t eventCount, uint64_t& size)
+	{
+		std::ifstream file(path, std::ios::binary);
+		std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		size = text.size();
+		if (text.compare(0, 15, "{\"traceEvents\":") != 0)
+		{
+			return false;
+		}
+
+		int64_t nesting = 0;
+		bool inString = false;
+		for (size_t i = 0; i < text.size(); ++i)
+		{
+			char c = text[i];
+			if (inString)
+			{
+				i += (c == '\\') ? 1 : 0;
+				inString = (c != '"');
+				continue;
+			}
+
+			inString = (c == '"');
+			nesting += (c == '{' || c == '[') ? 1 : (c == '}' || c == ']') ? -1 : 0;
+			if (nesting < 0)
+			{
+				return false;
+			}
+		}
+
+		uint64_t completeEvents = 0;
+		for (size_t pos = text.find("\"ph\":\"X\""); pos != std::string::npos; pos = text.find("\"ph\":\"X\"", pos + 1))
+		{
+			completeEvents++;
+		}
+		return nesting == 0 && !inString && completeEvents == eventCount;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// frames with two nested GPU regions on the simulated GPU, stats of the GPU profiler afterwards
+	//----------------------------------------------------------------------------------------------------
+	bool RunGpuFrames(GpuProfilerStats& stats)
+	{
+		RecordingDevice device;
+		device.SetGpuWorkTime(GpuTime, 0);
+
+		WorkerPool workers;
+		GfxPtr<GfxCommandQueue> pQueue;
+		FrameTimeline timeline;
+		CommandListPool cmdLists;
+		GpuProfiler gpuProfiler;
+		if (!workers.Init(1)
+			|| !device.CreateCommandQueue(GfxCommandListType::Direct, pQueue)
+			|| !timeline.Init(&device, pQueue.get(), FramesInFlight)
+			|| !cmdLists.Init(&device, GfxCommandListType::Direct, FramesInFlight, 1)
+			|| !gpuProfiler.Init(&device, pQueue.get(), FramesInFlight, 4))
+		{
+			return false;
+		}
+
+		for (uint32_t frame = 0; frame < GpuFrameCount; ++frame)
+		{
+			PROFILE_SCOPE("Frame");
+			uint32_t slot = timeline.BeginFrame();
+			gpuProfiler.BeginFrame(slot);
+
+			cmdLists.Record(workers, slot, 1, [&gpuProfiler](GfxCommandList* pCmdList, uint32_t)
+			{
+				uint32_t frameRegion = gpuProfiler.BeginRegion(pCmdList, "GPU frame", 0);
+				uint32_t drawRegion = gpuProfiler.BeginRegion(pCmdList, "Draws", 1);
+				for (uint32_t i = 0; i < 16; ++i)
+				{
+					pCmdList->DrawIndexedInstanced(6, 1, 0, 0, 0);
+				}
+				gpuProfiler.EndRegion(pCmdList, drawRegion);
+				gpuProfiler.EndRegion(pCmdList, frameRegion);
+				gpuProfiler.EndFrame(pCmdList);
+			});
+			cmdLists.Execute(pQueue.get());
+			timeline.EndFrame();
+		}
+		timeline.WaitIdle();
+
+		// the last frames of every slot are read back once the slots come round again
+		for (uint32_t i = 0; i < FramesInFlight; ++i)
+		{
+			gpuProfiler.BeginFrame(timeline.BeginFrame());
+			timeline.EndFrame();
+		}
+
+		stats = gpuProfiler.GetStats();
+		workers.Term();
+		return true;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 cost of a scope disabled and enabled, threads recording at once, GPU regions and trace export
+//--------------------------------------------------------------------------------------------------------
+int RunProfilerBenchmark(int argc, char** argv)
+{
+	uint32_t scopeCount = std::max(ArgU32(argc, argv, 1, DefaultScopeCount), 1u);
+	uint32_t threadCount = std::max(ArgU32(argc, argv, 2, DefaultThreadCount), 1u);
+	int result = 0;
+
+	// a full track drops events, keep the measured ones within the capacity
+	uint32_t capacity = Profiler::ChunkEventCount * Profiler::MaxChunkCount / 2;
+	scopeCount = std::min(scopeCount, capacity);
+
+	printf("profiler: %u nested scope pairs per thread, %u threads\n", scopeCount, threadCount);
+	Profiler::SetThreadName("Main");
+
+	// single thread cost against the bare loop
+	double bareNs = MeasureScopeNs(RecordNothing, scopeCount);
+	Profiler::SetEnabled(false);
+	double disabledNs = MeasureScopeNs(RecordScopes, scopeCount);
+	Profiler::SetEnabled(true);
+	double enabledNs = MeasureScopeNs(RecordScopes, scopeCount);
+	result |= (Profiler::GetEventCount() == 2ull * scopeCount) ? 0 : 1;
+	printf("%10s %12s\n", "scope", "ns/scope");
+	printf("%10s %12.2f\n%10s %12.2f\n%10s %12.2f\n", "none", bareNs, "disabled", disabledNs - bareNs, "enabled", enabledNs - bareNs);
+
+	// threads record at once, nothing on the hot path synchronizes
+	Profiler::Reset();
+	auto begin = BenchClock::now();
+	{
+		std::vector<std::thread> threads;
+		for (uint32_t t = 0; t < threadCount; ++t)
+		{
+			threads.emplace_back([scopeCount, t]()
+			{
+				Profiler::SetThreadName(("Recorder " + std::to_string(t)).c_str());
+				RecordScopes(scopeCount);
+			});
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+	double threadedMs = ElapsedMs(begin, BenchClock::now());
+	uint64_t threadedEvents = Profiler::GetEventCount();
+	bool threadedMatch = threadedEvents == 2ull * scopeCount * threadCount && Profiler::GetDroppedCount() == 0;
+	result |= threadedMatch ? 0 : 1;
+	printf("threads: %llu events in %.3f ms (%.1f M events/s)%s\n",
+		static_cast<unsigned long long>(threadedEvents), threadedMs, double(threadedEvents) / threadedMs / 1000.0, threadedMatch ? "" : "  MISMATCH");
+
+	// GPU regions of the simulated GPU land on the GPU track next to the frames of the CPU
+	Profiler::Reset();
+	GpuProfilerStats gpu = {};
+	if (!RunGpuFrames(gpu))
+	{
+		printf("profiler: cannot create the GPU objects\n");
+		return 1;
+	}
+	// timestamps are spread over the commands of a submission, the regions leave out the first and last few
+	double gpuMs = GpuTime / 1000.0;
+	bool gpuMatch = gpu.FrameCount == GpuFrameCount && gpu.RegionCount == 2ull * GpuFrameCount && gpu.DroppedCount == 0
+		&& gpu.LastFrameMs > gpuMs * 0.75 && gpu.LastFrameMs <= gpuMs * 1.01;
+	result |= gpuMatch ? 0 : 1;
+	printf("gpu: %llu frames, %llu regions read back, last frame %.3f ms of %.3f ms simulated%s\n",
+		static_cast<unsigned long long>(gpu.FrameCount), static_cast<unsigned long long>(gpu.RegionCount), gpu.LastFrameMs, gpuMs,
+		gpuMatch ? "" : "  MISMATCH");
+
+	// trace of the GPU part
+	Profiler::SetEnabled(false);
+	std::error_code error;
+	std::string path = (std::filesystem::temp_directory_path(error) / "ReLearnD3D12_profiler.json").string();
+	begin = BenchClock::now();
+	bool written = Profiler::WriteChromeTrace(path.c_str());
+	double exportMs = ElapsedMs(begin, BenchClock::now());
+	uint64_t traceSize = 0;
+	bool traceMatch = written && CheckTrace(path, Profiler::GetEventCount(), traceSize);
+	result |= traceMatch ? 0 : 1;
+	printf("trace: %llu events, %.1f KB written in %.3f ms%s\n",
+		static_cast<unsigned long long>(Profiler::GetEventCount()), double(traceSize) / 1024.0, exportMs, traceMatch ? "" : "  MISMATCH");
+
+	std::filesystem::remove(path, error);
+	Profiler::Reset();
+	return result;
+}
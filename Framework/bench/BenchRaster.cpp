@@ -0,0 +1,243 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <SoftRasterizer.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultWidth = 960; // width of the sample window
+	const uint32_t DefaultHeight = 540; // height of the sample window
+	const uint32_t DefaultFrameCount = 20; // frames measured per worker count
+	const uint32_t StressQuadCount = 20000; // quads of the throughput scene
+	const float ClearColor[] = { 0.25f, 0.25f, 0.25f, 1.0f }; // same as App::Render()
+
+	//----------------------------------------------------------------------------------------------------
+	// quad and camera of App::OnInit() at the first frame
+	//----------------------------------------------------------------------------------------------------
+	void SampleScene(uint32_t width, uint32_t height, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, Transform& transform)
+	{
+		vertices = {
+			{ DirectX::XMFLOAT3(-1.f,  1.f, 0.f), DirectX::XMFLOAT4(1.f, 0.f, 0.f, 1.f) },
+			{ DirectX::XMFLOAT3( 1.f,  1.f, 0.f), DirectX::XMFLOAT4(0.f, 1.f, 0.f, 1.f) },
+			{ DirectX::XMFLOAT3( 1.f, -1.f, 0.f), DirectX::XMFLOAT4(0.f, 0.f, 1.f, 1.f) },
+			{ DirectX::XMFLOAT3(-1.f, -1.f, 0.f), DirectX::XMFLOAT4(1.f, 0.f, 1.f, 1.f) }
+		};
+		indices = { 0, 1, 2, 0, 2, 3 };
+
+		DirectX::XMVECTOR eyePos = DirectX::XMVectorSet(0.f, 0.f, 5.f, 0.f);
+		DirectX::XMVECTOR targetPos = DirectX::XMVectorZero();
+		DirectX::XMVECTOR upward = DirectX::XMVectorSet(0.f, 1.f, 0.f, 0.f);
+		float aspect = static_cast<float>(width) / static_cast<float>(height);
+
+		transform.World = DirectX::XMMatrixRotationY(0.025f);
+		transform.View = DirectX::XMMatrixLookAtRH(eyePos, targetPos, upward);
+		transform.Proj = DirectX::XMMatrixPerspectiveFovRH(DirectX::XMConvertToRadians(37.5f), aspect, 1.f, 1000.f);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// many small colored quads scattered in front of the camera
+	//----------------------------------------------------------------------------------------------------
+	void StressScene(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		uint32_t seed = 12345u;
+		auto random = [&seed]()
+		{
+			seed = seed * 1664525u + 1013904223u;
+			return float(seed >> 8) / float(1u << 24);
+		};
+
+		vertices.clear();
+		indices.clear();
+		for (uint32_t i = 0; i < StressQuadCount; ++i)
+		{
+			float cx = random() * 6.f - 3.f;
+			float cy = random() * 3.4f - 1.7f;
+			float cz = random() * 2.f - 1.f;
+			float size = 0.02f + random() * 0.1f;
+			DirectX::XMFLOAT4 color(random(), random(), random(), 1.f);
+
+			uint32_t base = static_cast<uint32_t>(vertices.size());
+			vertices.push_back({ DirectX::XMFLOAT3(cx - size, cy + size, cz), color });
+			vertices.push_back({ DirectX::XMFLOAT3(cx + size, cy + size, cz), color });
+			vertices.push_back({ DirectX::XMFLOAT3(cx + size, cy - size, cz), DirectX::XMFLOAT4(1.f, 1.f, 1.f, 1.f) });
+			vertices.push_back({ DirectX::XMFLOAT3(cx - size, cy - size, cz), color });
+			indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// FNV-1a over the visible pixels
+	//----------------------------------------------------------------------------------------------------
+	uint64_t HashImage(const SoftRasterizer& rasterizer)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (uint32_t y = 0; y < rasterizer.GetHeight(); ++y)
+		{
+			const uint32_t* pRow = rasterizer.GetPixels() + size_t(y) * rasterizer.GetPitch();
+			for (uint32_t x = 0; x < rasterizer.GetWidth(); ++x)
+			{
+				hash = (hash ^ pRow[x]) * 1099511628211ull;
+			}
+		}
+		return hash;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// largest channel difference against a binary PPM, returns -1 when the file doesn't match in size
+	//----------------------------------------------------------------------------------------------------
+	int CompareImage(const SoftRasterizer& rasterizer, const char* path, uint32_t& diffPixels)
+	{
+		FILE* pFile = fopen(path, "rb");
+		if (pFile == nullptr)
+		{
+			return -1;
+		}
+
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t maxValue = 0;
+		int fields = fscanf(pFile, "P6 %u %u %u", &width, &height, &maxValue);
+		fgetc(pFile); // single whitespace after the header
+
+		std::vector<uint8_t> data(size_t(width) * height * 3);
+		bool valid = fields == 3 && maxValue == 255
+			&& width == rasterizer.GetWidth() && height == rasterizer.GetHeight()
+			&& fread(data.data(), 1, data.size(), pFile) == data.size();
+		fclose(pFile);
+
+		if (!valid)
+		{
+			return -1;
+		}
+
+		int maxDiff = 0;
+		diffPixels = 0;
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			const uint32_t* pRow = rasterizer.GetPixels() + size_t(y) * rasterizer.GetPitch();
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				int pixelDiff = 0;
+				for (uint32_t c = 0; c < 3; ++c)
+				{
+					int value = int((pRow[x] >> (c * 8)) & 0xff);
+					pixelDiff = std::max(pixelDiff, abs(value - int(data[(size_t(y) * width + x) * 3 + c])));
+				}
+				diffPixels += (pixelDiff > 0) ? 1 : 0;
+				maxDiff = std::max(maxDiff, pixelDiff);
+			}
+		}
+		return maxDiff;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 reference image of the sample scene and throughput of the software rasterizer on 1...N workers
+//--------------------------------------------------------------------------------------------------------
+int RunRasterBenchmark(int argc, char** argv)
+{
+	uint32_t width = ArgU32(argc, argv, 1, DefaultWidth);
+	uint32_t height = ArgU32(argc, argv, 2, DefaultHeight);
+	uint32_t maxWorkers = std::max(ArgU32(argc, argv, 3, WorkerPool::GetHardwareWorkerCount()), 1u);
+	uint32_t frameCount = std::max(ArgU32(argc, argv, 4, DefaultFrameCount), 1u);
+	const char* pImagePath = (argc > 5) ? argv[5] : nullptr;
+	const char* pGoldenPath = (argc > 6) ? argv[6] : nullptr;
+
+	SoftRasterizer rasterizer;
+	WorkerPool workers;
+	if (!rasterizer.Init(width, height) || !workers.Init(maxWorkers))
+	{
+		printf("raster: invalid size %ux%u\n", width, height);
+		return 1;
+	}
+
+	// sample scene (App uses no culling)
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	Transform transform;
+	SampleScene(width, height, vertices, indices, transform);
+
+	rasterizer.BeginFrame(ClearColor);
+	rasterizer.DrawIndexed(vertices.data(), uint32_t(vertices.size()), indices.data(), uint32_t(indices.size()), transform);
+	rasterizer.EndFrame(workers);
+
+	printf("raster: sample scene %ux%u, %llu pixels shaded, hash %016llx\n",
+		width, height, (unsigned long long)rasterizer.GetStats().PixelsShaded, (unsigned long long)HashImage(rasterizer));
+
+	if (pImagePath != nullptr && !rasterizer.SaveImage(pImagePath))
+	{
+		printf("raster: failed to write %s\n", pImagePath);
+		return 1;
+	}
+
+	if (pGoldenPath != nullptr)
+	{
+		uint32_t diffPixels = 0;
+		int maxDiff = CompareImage(rasterizer, pGoldenPath, diffPixels);
+		if (maxDiff < 0 || maxDiff > 1)
+		{
+			printf("raster: MISMATCH against %s (max diff %d, %u pixels)\n", pGoldenPath, maxDiff, diffPixels);
+			return 1;
+		}
+		printf("raster: matches %s (max diff %d, %u pixels)\n", pGoldenPath, maxDiff, diffPixels);
+	}
+
+	// throughput scene
+	StressScene(vertices, indices);
+	printf("raster: %u triangles, median of %u frames (%u hardware threads)\n",
+		uint32_t(indices.size() / 3), frameCount, WorkerPool::GetHardwareWorkerCount());
+	printf("%8s %10s %10s %10s %10s %18s\n", "workers", "ms", "Mtri/s", "Mpix/s", "speedup", "hash");
+
+	double baseline = 0.0;
+	for (uint32_t workerCount = 1; workerCount <= maxWorkers; ++workerCount)
+	{
+		if (!workers.Init(workerCount))
+		{
+			return 1;
+		}
+
+		// one warm-up frame sizes the bins
+		std::vector<double> frameMs;
+		uint64_t pixels = 0;
+		for (uint32_t frame = 0; frame <= frameCount; ++frame)
+		{
+			rasterizer.ResetStats();
+
+			auto begin = BenchClock::now();
+			rasterizer.BeginFrame(ClearColor);
+			rasterizer.DrawIndexed(vertices.data(), uint32_t(vertices.size()), indices.data(), uint32_t(indices.size()), transform, &workers);
+			rasterizer.EndFrame(workers);
+			auto end = BenchClock::now();
+
+			if (frame > 0)
+			{
+				frameMs.push_back(ElapsedMs(begin, end));
+				pixels = rasterizer.GetStats().PixelsShaded;
+			}
+		}
+
+		double ms = Median(frameMs);
+		if (workerCount == 1)
+		{
+			baseline = ms;
+		}
+
+		printf("%8u %10.3f %10.2f %10.2f %9.2fx   %016llx\n",
+			workerCount, ms,
+			(indices.size() / 3) / (ms * 1000.0),
+			pixels / (ms * 1000.0),
+			(ms > 0.0) ? baseline / ms : 0.0,
+			(unsigned long long)HashImage(rasterizer));
+	}
+
+	return 0;
+}
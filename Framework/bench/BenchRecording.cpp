@@ -0,0 +1,226 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <CommandListPool.h>
+#include <RecordingDevice.h>
+#include <WorkerPool.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultDrawCount = 100000; // draws recorded per frame
+	const uint32_t DefaultFrameCount = 20; // frames measured per worker count
+	const uint64_t ConstantStride = 256; // distance between the constant buffers of two draws
+	const uint32_t LargeBarrierCount = 4096; // barriers of one batch, more payload than 16 bits can describe
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// RecordingScene structure - objects every worker binds
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct RecordingScene
+	{
+		GfxPtr<GfxDevice> pDevice;
+		GfxPtr<GfxCommandQueue> pQueue;
+		GfxPtr<GfxSwapChain> pSwapChain;
+		GfxPtr<GfxFence> pFence;
+		GfxPtr<GfxRootSignature> pRootSignature;
+		GfxPtr<GfxPipelineState> pPSO;
+		GfxPtr<GfxResource> pConstants;
+		GfxVertexBufferView VBV;
+		GfxIndexBufferView IBV;
+		GfxViewport Viewport;
+		GfxRect Scissor;
+		uint32_t DrawCount;
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// create the headless device and the objects the draws reference
+	//----------------------------------------------------------------------------------------------------
+	bool InitScene(uint32_t drawCount, RecordingScene& scene)
+	{
+		if (!CreateGfxDevice(GfxBackend::Recording, scene.pDevice)
+			|| !scene.pDevice->CreateCommandQueue(GfxCommandListType::Direct, scene.pQueue)
+			|| !scene.pDevice->CreateFence(0, scene.pFence))
+		{
+			return false;
+		}
+
+		GfxSwapChainDesc swapChainDesc = { 960, 540, 2, GfxFormat::R8G8B8A8_Unorm, nullptr };
+		if (!scene.pDevice->CreateSwapChain(scene.pQueue.get(), swapChainDesc, scene.pSwapChain))
+		{
+			return false;
+		}
+
+		GfxRootParameter param = {};
+		param.ParameterType = GfxRootParameterType::CBV;
+		param.ShaderVisibility = GfxShaderVisibility::Vertex;
+
+		GfxRootSignatureDesc rootDesc = { 1, &param, true };
+		if (!scene.pDevice->CreateRootSignature(rootDesc, scene.pRootSignature))
+		{
+			return false;
+		}
+
+		GfxGraphicsPipelineDesc psoDesc = {};
+		psoDesc.pRootSignature = scene.pRootSignature.get();
+		if (!scene.pDevice->CreateGraphicsPipelineState(psoDesc, scene.pPSO))
+		{
+			return false;
+		}
+
+		GfxBufferDesc bufferDesc = { ConstantStride * drawCount, GfxHeapType::Upload, GfxResourceState::GenericRead };
+		if (!scene.pDevice->CreateBuffer(bufferDesc, scene.pConstants))
+		{
+			return false;
+		}
+
+		scene.VBV = { 0x10000, 4 * 28, 28 };
+		scene.IBV = { 0x20000, 6 * 4, GfxFormat::R32_Uint };
+		scene.Viewport = { 0.f, 0.f, 960.f, 540.f, 0.f, 1.f };
+		scene.Scissor = { 0, 0, 960, 540 };
+		scene.DrawCount = drawCount;
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// record one share of the draws
+	//----------------------------------------------------------------------------------------------------
+	void RecordDraws(const RecordingScene& scene, GfxCommandList* pCmdList, uint32_t listIndex, uint32_t listCount)
+	{
+		pCmdList->SetGraphicsRootSignature(scene.pRootSignature.get());
+		pCmdList->SetPipelineState(scene.pPSO.get());
+		pCmdList->IASetPrimitiveTopology(GfxPrimitiveTopology::TriangleList);
+		pCmdList->IASetVertexBuffers(0, 1, &scene.VBV);
+		pCmdList->IASetIndexBuffer(&scene.IBV);
+		pCmdList->RSSetViewports(1, &scene.Viewport);
+		pCmdList->RSSetScissorRects(1, &scene.Scissor);
+
+		GfxGpuVirtualAddress constants = scene.pConstants->GetGPUVirtualAddress();
+		uint32_t first = static_cast<uint32_t>(uint64_t(scene.DrawCount) * listIndex / listCount);
+		uint32_t last = static_cast<uint32_t>(uint64_t(scene.DrawCount) * (listIndex + 1) / listCount);
+		for (uint32_t i = first; i < last; ++i)
+		{
+			pCmdList->SetGraphicsRootConstantBufferView(0, constants + i * ConstantStride);
+			pCmdList->DrawIndexedInstanced(6, 1, 0, 0, 0);
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// a record larger than 64 KB keeps its size, the record behind it is read from the right place
+	//----------------------------------------------------------------------------------------------------
+	bool CheckLargeRecord()
+	{
+		std::vector<RecordBarrier> barriers(LargeBarrierCount, RecordBarrier());
+		for (uint32_t i = 0; i < LargeBarrierCount; ++i)
+		{
+			barriers[i].ResourceId = i;
+		}
+
+		RecordStream stream;
+		RecordCount head = { 0, LargeBarrierCount };
+		RecordPresent present = { 1, 0 };
+		stream.Write(RecordOp::ResourceBarrier, head, LargeBarrierCount, barriers.data());
+		stream.Write(RecordOp::Present, present);
+
+		uint32_t index = 0;
+		bool passed = stream.GetCommandCount() == 2;
+		stream.ForEach([&](RecordOp op, const void* pPayload, uint32_t size)
+		{
+			if (index == 0)
+			{
+				RecordBarrier last;
+				memcpy(&last, static_cast<const uint8_t*>(pPayload) + size - sizeof(last), sizeof(last));
+				passed &= op == RecordOp::ResourceBarrier && size == sizeof(head) + sizeof(RecordBarrier) * LargeBarrierCount
+					&& last.ResourceId == LargeBarrierCount - 1;
+			}
+			else
+			{
+				passed &= index == 1 && op == RecordOp::Present && size == sizeof(present);
+			}
+			index++;
+		});
+		return Check("barrier batch beyond 64 KB recorded whole", passed && index == 2);
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 recording time of one frame of draws on 1...N workers
+//--------------------------------------------------------------------------------------------------------
+int RunRecordingBenchmark(int argc, char** argv)
+{
+	uint32_t drawCount = std::max(ArgU32(argc, argv, 1, DefaultDrawCount), 1u);
+	uint32_t maxWorkers = std::max(ArgU32(argc, argv, 2, WorkerPool::GetHardwareWorkerCount()), 1u);
+	uint32_t frameCount = std::max(ArgU32(argc, argv, 3, DefaultFrameCount), 1u);
+
+	RecordingScene scene;
+	if (!InitScene(drawCount, scene))
+	{
+		printf("recording: failed to create the headless device\n");
+		return 1;
+	}
+
+	printf("recording: checks\n");
+	int result = CheckLargeRecord() ? 0 : 1;
+
+	printf("recording: %u draws, median of %u frames (%u hardware threads)\n",
+		drawCount, frameCount, WorkerPool::GetHardwareWorkerCount());
+	printf("%8s %12s %12s %10s %11s\n", "workers", "record ms", "submit ms", "speedup", "efficiency");
+
+	double baseline = 0.0;
+	uint64_t fenceValue = 0;
+	for (uint32_t workerCount = 1; workerCount <= maxWorkers; ++workerCount)
+	{
+		WorkerPool workers;
+		CommandListPool cmdLists;
+		if (!workers.Init(workerCount)
+			|| !cmdLists.Init(scene.pDevice.get(), GfxCommandListType::Direct, 1, workerCount))
+		{
+			return 1;
+		}
+
+		// one warm-up frame grows the command streams to their steady size
+		std::vector<double> recordMs;
+		std::vector<double> submitMs;
+		for (uint32_t frame = 0; frame <= frameCount; ++frame)
+		{
+			auto begin = BenchClock::now();
+			cmdLists.Record(workers, 0, workerCount, [&scene, workerCount](GfxCommandList* pCmdList, uint32_t listIndex)
+			{
+				RecordDraws(scene, pCmdList, listIndex, workerCount);
+			});
+			auto recorded = BenchClock::now();
+			cmdLists.Execute(scene.pQueue.get());
+			auto submitted = BenchClock::now();
+
+			// retire the frame on the simulated GPU
+			scene.pSwapChain->Present(0);
+			scene.pQueue->Signal(scene.pFence.get(), ++fenceValue);
+
+			if (frame > 0)
+			{
+				recordMs.push_back(ElapsedMs(begin, recorded));
+				submitMs.push_back(ElapsedMs(recorded, submitted));
+			}
+		}
+
+		double record = Median(recordMs);
+		if (workerCount == 1)
+		{
+			baseline = record;
+		}
+
+		double speedup = (record > 0.0) ? baseline / record : 0.0;
+		printf("%8u %12.3f %12.3f %9.2fx %10.0f%%\n",
+			workerCount, record, Median(submitMs), speedup, 100.0 * speedup / workerCount);
+	}
+
+	return result;
+}
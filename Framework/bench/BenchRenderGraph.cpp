@@ -0,0 +1,370 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <CommandListPool.h>
+#include <RecordingDevice.h>
+#include <RenderGraph.h>
+#include <ResourceStateTracker.h>
+#include <WorkerPool.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultPassCount = 256; // passes of the timed graph
+	const uint32_t DefaultIterations = 1000; // frames of the timed graph
+	const uint32_t ListCount = 4; // command lists of the pool
+	const uint32_t WorkerCount = 4; // threads recording the lists
+	const uint32_t ParallelEvery = 8; // every that many passes of the timed graph is recorded in parts
+	const uint64_t TransientSize = 64 * 1024; // bytes of a transient buffer of the timed graph
+
+	//----------------------------------------------------------------------------------------------------
+	// pass that draws once per part
+	//----------------------------------------------------------------------------------------------------
+	void Draw(GfxCommandList* pCmdList, uint32_t, uint32_t)
+	{
+		pCmdList->DrawIndexedInstanced(6, 1, 0, 0, 0);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// device objects shared by the checks
+	//----------------------------------------------------------------------------------------------------
+	struct Context
+	{
+		RecordingDevice Device; // headless device
+		GfxPtr<GfxCommandQueue> pQueue; // queue the lists are executed on
+		WorkerPool Workers; // threads recording the lists
+		ResourceStates States; // committed states
+		CommandListPool CmdLists; // lists with state trackers
+
+		bool Init()
+		{
+			return Device.CreateCommandQueue(GfxCommandListType::Direct, pQueue) && Workers.Init(WorkerCount)
+				&& CmdLists.Init(&Device, GfxCommandListType::Direct, 1, ListCount, &States);
+		}
+
+		// imported resource registered in state
+		bool Import(GfxPtr<GfxResource>& pResource, GfxResourceState state)
+		{
+			GfxBufferDesc desc = { 256, GfxHeapType::Default, GfxResourceState::Common };
+			if (!Device.CreateBuffer(desc, pResource))
+			{
+				return false;
+			}
+			States.Register(pResource.get(), state);
+			return true;
+		}
+
+		// records and submits the compiled graph
+		const ResourceBarrierStats& Submit(RenderGraph& graph)
+		{
+			graph.Record(Workers, CmdLists, 0);
+			CmdLists.Execute(pQueue.get());
+			return CmdLists.GetBarrierStats();
+		}
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// passes nothing depends on are culled, chains of them as well
+	//----------------------------------------------------------------------------------------------------
+	bool RunCullChecks(Context& context)
+	{
+		GfxPtr<GfxResource> pTarget;
+		RenderGraph graph;
+		if (!context.Import(pTarget, GfxResourceState::Present) || !graph.Init(&context.Device, &context.States))
+		{
+			return false;
+		}
+
+		// unused writes and a chain ending in one are culled, writers of imported resources and passes with
+		// side effects stay and run in declaration order
+		std::vector<uint32_t> order;
+		auto record = [&order](uint32_t pass) { return [&order, pass](GfxCommandList*, uint32_t, uint32_t) { order.push_back(pass); }; };
+
+		graph.Reset();
+		uint32_t target = graph.ImportResource("Target", pTarget.get());
+		uint32_t unused = graph.CreateBuffer("Unused", 256);
+		uint32_t first = graph.CreateBuffer("Chain 1", 256);
+		uint32_t second = graph.CreateBuffer("Chain 2", 256);
+		uint32_t lonely = graph.AddPass("Lonely", record(0));
+		graph.Write(lonely, unused, GfxResourceState::CopyDest);
+		uint32_t chain0 = graph.AddPass("Chain 0", record(1));
+		graph.Write(chain0, first, GfxResourceState::CopyDest);
+		uint32_t chain1 = graph.AddPass("Chain 1", record(2));
+		graph.Read(chain1, first, GfxResourceState::CopySource);
+		graph.Write(chain1, second, GfxResourceState::CopyDest);
+		uint32_t draw = graph.AddPass("Draw", record(3));
+		graph.Write(draw, target, GfxResourceState::RenderTarget);
+		uint32_t readback = graph.AddPass("Readback", record(4));
+		graph.SetSideEffect(readback);
+
+		bool compiled = graph.Compile(1);
+		context.Submit(graph);
+		const RenderGraphStats& stats = graph.GetStats();
+		bool passed = Check("unused pass and chain culled, others in order", compiled
+			&& graph.IsPassCulled(lonely) && graph.IsPassCulled(chain0) && graph.IsPassCulled(chain1)
+			&& !graph.IsPassCulled(draw) && !graph.IsPassCulled(readback)
+			&& stats.CulledCount == 3 && stats.TransientCount == 0 && order == std::vector<uint32_t>({ 3, 4 }));
+
+		// a transient read before anything wrote it has no contents
+		graph.Reset();
+		target = graph.ImportResource("Target", pTarget.get());
+		first = graph.CreateBuffer("Unwritten", 256);
+		draw = graph.AddPass("Draw", Draw);
+		graph.Read(draw, first, GfxResourceState::CopySource);
+		graph.Write(draw, target, GfxResourceState::RenderTarget);
+		passed &= Check("read of an unwritten transient rejected", !graph.Compile(1));
+
+		graph.Term();
+		return passed;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// reads next to each other share one state, transients apart alias the same memory
+	//----------------------------------------------------------------------------------------------------
+	bool RunResourceChecks(Context& context)
+	{
+		GfxPtr<GfxResource> pTarget;
+		RenderGraph graph;
+		if (!context.Import(pTarget, GfxResourceState::RenderTarget) || !graph.Init(&context.Device, &context.States))
+		{
+			return false;
+		}
+
+		// vertex and index reads of a buffer written before them need one barrier to the combined state
+		graph.Reset();
+		uint32_t target = graph.ImportResource("Target", pTarget.get());
+		uint32_t geometry = graph.CreateBuffer("Geometry", 1024);
+		uint32_t upload = graph.AddPass("Upload", Draw);
+		graph.Write(upload, geometry, GfxResourceState::CopyDest);
+		uint32_t vertices = graph.AddPass("Vertices", Draw);
+		graph.Read(vertices, geometry, GfxResourceState::VertexAndConstantBuffer);
+		graph.Write(vertices, target, GfxResourceState::RenderTarget);
+		uint32_t indices = graph.AddPass("Indices", Draw);
+		graph.Read(indices, geometry, GfxResourceState::IndexBuffer);
+		graph.Write(indices, target, GfxResourceState::RenderTarget);
+
+		bool compiled = graph.Compile(1);
+		const ResourceBarrierStats& barriers = context.Submit(graph);
+		bool passed = Check("vertex and index reads combined into one barrier", compiled
+			&& barriers.BarrierCount == 2 && barriers.FixupCount == 0);
+
+		// 1 KB lives in passes 0-1, 2 KB in 1-2 and 512 B in 2-3: the last is placed where the first was
+		graph.Reset();
+		target = graph.ImportResource("Target", pTarget.get());
+		uint32_t a = graph.CreateBuffer("A", 1024);
+		uint32_t b = graph.CreateBuffer("B", 2048);
+		uint32_t c = graph.CreateBuffer("C", 512);
+		uint32_t pass0 = graph.AddPass("Write A", Draw);
+		graph.Write(pass0, a, GfxResourceState::CopyDest);
+		uint32_t pass1 = graph.AddPass("A to B", Draw);
+		graph.Read(pass1, a, GfxResourceState::CopySource);
+		graph.Write(pass1, b, GfxResourceState::CopyDest);
+		uint32_t pass2 = graph.AddPass("B to C", Draw);
+		graph.Read(pass2, b, GfxResourceState::CopySource);
+		graph.Write(pass2, c, GfxResourceState::CopyDest);
+		uint32_t pass3 = graph.AddPass("Draw C", Draw);
+		graph.Read(pass3, c, GfxResourceState::VertexAndConstantBuffer);
+		graph.Write(pass3, target, GfxResourceState::RenderTarget);
+
+		compiled = graph.Compile(1);
+		context.Submit(graph);
+		const RenderGraphStats& stats = graph.GetStats();
+		uint32_t firstA = 0, lastA = 0, firstC = 0, lastC = 0;
+		bool lifetimes = graph.GetLifetime(a, firstA, lastA) && graph.GetLifetime(c, firstC, lastC)
+			&& firstA == pass0 && lastA == pass1 && firstC == pass2 && lastC == pass3;
+		passed &= Check("transients apart alias the same memory", compiled && lifetimes
+			&& stats.TransientCount == 3 && stats.TransientBufferCount == 3 && stats.AliasCount == 1
+			&& stats.TransientHeapSize == 2 * GfxPlacementAlignment && graph.GetResource(a) != graph.GetResource(c)
+			&& graph.GetResource(a)->GetGPUVirtualAddress() == graph.GetResource(c)->GetGPUVirtualAddress()
+			&& graph.GetResource(a)->GetGPUVirtualAddress() != graph.GetResource(b)->GetGPUVirtualAddress());
+
+		// C starts with an aliasing barrier and goes to its first state (no fix-up, states committed)
+		GfxResourceState state = GfxResourceState::Common;
+		passed &= Check("aliased buffer transitioned to its first use", context.CmdLists.GetBarrierStats().FixupCount == 0
+			&& context.States.GetState(graph.GetResource(c), GfxAllSubresources, state) && state == GfxResourceState::VertexAndConstantBuffer);
+
+		graph.Term();
+		return passed;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// transitions placed ahead of their use, parts spread over the lists
+	//----------------------------------------------------------------------------------------------------
+	bool RunScheduleChecks(Context& context)
+	{
+		GfxPtr<GfxResource> pTarget;
+		GfxPtr<GfxResource> pSource;
+		GfxPtr<GfxResource> pScratch;
+		RenderGraph graph;
+		if (!context.Import(pTarget, GfxResourceState::Present) || !context.Import(pSource, GfxResourceState::Common)
+			|| !context.Import(pScratch, GfxResourceState::Common) || !graph.Init(&context.Device, &context.States))
+		{
+			return false;
+		}
+
+		// a buffer written by the first pass and read by the third is transitioned while the second runs
+		graph.Reset();
+		uint32_t target = graph.ImportResource("Target", pTarget.get());
+		uint32_t buffer = graph.CreateBuffer("Buffer", 256);
+		uint32_t fill = graph.AddPass("Fill", Draw);
+		graph.Write(fill, buffer, GfxResourceState::CopyDest);
+		uint32_t clear = graph.AddPass("Clear", Draw);
+		graph.Write(clear, target, GfxResourceState::RenderTarget);
+		uint32_t draw = graph.AddPass("Draw", Draw);
+		graph.Read(draw, buffer, GfxResourceState::VertexAndConstantBuffer);
+		graph.Write(draw, target, GfxResourceState::RenderTarget);
+
+		bool compiled = graph.Compile(ListCount);
+		const ResourceBarrierStats& barriers = context.Submit(graph);
+		bool passed = Check("split barrier across a pass in between", compiled
+			&& graph.GetStats().SplitCount == 1 && graph.GetStats().JobCount == 1 && barriers.BarrierCount == 4);
+
+		// the second list starts with a buffer the first list wrote and with one the frame hasn't used yet,
+		// both are handed over by the first list so nothing is left for submission
+		graph.Reset();
+		target = graph.ImportResource("Target", pTarget.get());
+		uint32_t source = graph.ImportResource("Source", pSource.get());
+		uint32_t scratch = graph.ImportResource("Scratch", pScratch.get());
+		uint32_t write = graph.AddPass("Write scratch", Draw);
+		graph.Write(write, scratch, GfxResourceState::CopyDest);
+		uint32_t wide = graph.AddPass("Wide", Draw, 2);
+		graph.Write(wide, target, GfxResourceState::RenderTarget);
+		uint32_t copy = graph.AddPass("Copy", Draw);
+		graph.Read(copy, scratch, GfxResourceState::CopySource);
+		graph.Read(copy, source, GfxResourceState::CopySource);
+		graph.Write(copy, target, GfxResourceState::RenderTarget);
+		uint32_t present = graph.AddPass("Present", Draw);
+		graph.Read(present, target, GfxResourceState::Present);
+		graph.SetSideEffect(present);
+
+		compiled = graph.Compile(ListCount);
+		const ResourceBarrierStats& handed = context.Submit(graph);
+		GfxResourceState state = GfxResourceState::Common;
+		passed &= Check("later list prepared by the first, no fix-ups", compiled
+			&& graph.GetStats().JobCount == 2 && graph.GetStats().HandoverCount == 2 && handed.FixupCount == 0
+			&& context.States.GetState(pTarget.get(), GfxAllSubresources, state) && state == GfxResourceState::Present);
+
+		// parts beyond the command lists are folded into the others
+		graph.Reset();
+		target = graph.ImportResource("Target", pTarget.get());
+		std::atomic<uint32_t> calls(0);
+		std::atomic<uint32_t> partCounts(0);
+		uint32_t parallel = graph.AddPass("Parallel", [&calls, &partCounts](GfxCommandList*, uint32_t, uint32_t partCount)
+		{
+			calls++;
+			partCounts += partCount;
+		}, 16);
+		graph.Write(parallel, target, GfxResourceState::RenderTarget);
+
+		compiled = graph.Compile(ListCount);
+		context.Submit(graph);
+		passed &= Check("parts clamped to the command lists", compiled && graph.GetStats().JobCount == ListCount
+			&& graph.GetPartCount(parallel) == ListCount && calls == ListCount && partCounts == ListCount * ListCount);
+
+		graph.Term();
+		return passed;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 scheduling rules of the render graph, then the cost of declaring, compiling and recording a frame
+//--------------------------------------------------------------------------------------------------------
+int RunRenderGraphBenchmark(int argc, char** argv)
+{
+	uint32_t passCount = std::max(ArgU32(argc, argv, 1, DefaultPassCount), 1u);
+	uint32_t iterations = std::max(ArgU32(argc, argv, 2, DefaultIterations), 1u);
+
+	Context context;
+	if (!context.Init())
+	{
+		printf("rendergraph: cannot create the command lists\n");
+		return 1;
+	}
+
+	printf("rendergraph: scheduling checks\n");
+	bool passed = RunCullChecks(context);
+	passed &= RunResourceChecks(context);
+	passed &= RunScheduleChecks(context);
+	int result = passed ? 0 : 1;
+
+	// a chain of passes, each reads what the one before wrote, every few passes are recorded in parts
+	GfxPtr<GfxResource> pTarget;
+	RenderGraph graph;
+	if (!context.Import(pTarget, GfxResourceState::Present) || !graph.Init(&context.Device, &context.States))
+	{
+		printf("rendergraph: cannot create the target\n");
+		return 1;
+	}
+
+	double declareMs = 0.0;
+	double compileMs = 0.0;
+	double recordMs = 0.0;
+	for (uint32_t i = 0; i < iterations; ++i)
+	{
+		auto begin = BenchClock::now();
+		graph.Reset();
+		uint32_t target = graph.ImportResource("Target", pTarget.get());
+		uint32_t previous = RenderGraph::InvalidHandle;
+		for (uint32_t p = 0; p < passCount; ++p)
+		{
+			uint32_t pass = graph.AddPass("Pass", Draw, (p % ParallelEvery == ParallelEvery - 1) ? ListCount : 1);
+			if (previous != RenderGraph::InvalidHandle)
+			{
+				graph.Read(pass, previous, GfxResourceState::VertexAndConstantBuffer);
+			}
+
+			if (p + 1 < passCount)
+			{
+				previous = graph.CreateBuffer("Transient", TransientSize);
+				graph.Write(pass, previous, GfxResourceState::CopyDest);
+			}
+			else
+			{
+				graph.Write(pass, target, GfxResourceState::RenderTarget);
+			}
+		}
+		uint32_t present = graph.AddPass("Present", Draw);
+		graph.Read(present, target, GfxResourceState::Present);
+	graph.SetSideEffect(present);
+		graph.SetSideEffect(present);
+
+		auto declared = BenchClock::now();
+		if (!graph.Compile(ListCount))
+		{
+			printf("rendergraph: compile failed\n");
+			return 1;
+		}
+
+		auto compiled = BenchClock::now();
+		context.Submit(graph);
+		auto recorded = BenchClock::now();
+
+		declareMs += ElapsedMs(begin, declared);
+		compileMs += ElapsedMs(declared, compiled);
+		recordMs += ElapsedMs(compiled, recorded);
+	}
+
+	const RenderGraphStats& stats = graph.GetStats();
+	const ResourceBarrierStats& barriers = context.CmdLists.GetBarrierStats();
+	bool match = stats.CulledCount == 0 && stats.TransientBufferCount == 2 && stats.TransientHeapSize == 2 * TransientSize
+		&& barriers.FixupCount == 0;
+	result |= match ? 0 : 1;
+	printf("rendergraph: %u passes, %u iterations, %u command lists\n", passCount + 1, iterations, ListCount);
+	printf("%10s %10s %10s %10s %10s %10s %12s %12s %12s%s\n", "jobs", "transients", "buffers", "heap KB", "splits", "handovers",
+		"declare us", "compile us", "record us", match ? "" : "  MISMATCH");
+	printf("%10u %10u %10u %10llu %10u %10u %12.2f %12.2f %12.2f\n", stats.JobCount, stats.TransientCount, stats.TransientBufferCount,
+		static_cast<unsigned long long>(stats.TransientHeapSize / 1024), stats.SplitCount, stats.HandoverCount, declareMs * 1000.0 / iterations, compileMs * 1000.0 / iterations, recordMs * 1000.0 / iterations);
+
+	graph.Term();
+	context.Workers.Term();
+	return result;
+}
@@ -0,0 +1,221 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <ShaderStore.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultPermutationCount = 512; // permutations of the set
+	const uint32_t DefaultAverageKB = 8; // average size of a compiled shader
+	const uint32_t DuplicateInterval = 4; // every 4th permutation compiles to the bytecode of the one before
+	const uint32_t IterationCount = 7; // startups measured per variant
+
+	//----------------------------------------------------------------------------------------------------
+	// whole file into memory (what App did per shader before the store)
+	//----------------------------------------------------------------------------------------------------
+	bool ReadFile(const std::string& path, std::vector<uint8_t>& data)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			return false;
+		}
+
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0, std::ios::beg);
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())));
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// write data as a file
+	//----------------------------------------------------------------------------------------------------
+	bool WriteFile(const std::string& path, const std::vector<uint8_t>& data)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		return static_cast<bool>(file.flush());
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 startup with loose .cso files against the packed store, then hot reload of watched files
+//--------------------------------------------------------------------------------------------------------
+int RunShaderStoreBenchmark(int argc, char** argv)
+{
+	uint32_t permutationCount = std::max(ArgU32(argc, argv, 1, DefaultPermutationCount), 2u);
+	uint32_t averageKB = std::max(ArgU32(argc, argv, 2, DefaultAverageKB), 1u);
+
+	std::error_code error;
+	std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "ReLearnD3D12_shaderstore";
+	std::filesystem::remove_all(directory, error);
+	std::filesystem::create_directories(directory, error);
+
+	// random bytecode between half and one and a half times the average size
+	std::vector<std::string> names(permutationCount);
+	std::vector<std::string> paths(permutationCount);
+	std::vector<std::vector<uint8_t>> blobs(permutationCount);
+	std::vector<ShaderStoreSource> sources(permutationCount);
+	uint64_t looseSize = 0;
+	uint32_t seed = 12345u;
+	for (uint32_t i = 0; i < permutationCount; ++i)
+	{
+		names[i] = "Bench|VARIANT=" + std::to_string(i);
+		paths[i] = (directory / ("Bench_" + std::to_string(i) + ".cso")).string();
+		if (i % DuplicateInterval == DuplicateInterval - 1)
+		{
+			blobs[i] = blobs[i - 1];
+		}
+		else
+		{
+			seed = seed * 1664525u + 1013904223u;
+			size_t size = (size_t(averageKB) * 1024 / 2 + (seed >> 8) % (size_t(averageKB) * 1024)) & ~size_t(3);
+			blobs[i].resize(size);
+			for (uint8_t& byte : blobs[i])
+			{
+				seed = seed * 1664525u + 1013904223u;
+				byte = static_cast<uint8_t>(seed >> 24);
+			}
+		}
+
+		if (!WriteFile(paths[i], blobs[i]))
+		{
+			printf("shaderstore: cannot write %s\n", paths[i].c_str());
+			return 1;
+		}
+		sources[i] = { names[i].c_str(), blobs[i].data(), blobs[i].size() };
+		looseSize += blobs[i].size();
+	}
+
+	std::string storePath = (directory / "Shaders.bin").string();
+	auto begin = BenchClock::now();
+	bool written = ShaderStore::Write(storePath.c_str(), sources.data(), permutationCount);
+	double packMs = ElapsedMs(begin, BenchClock::now());
+	if (!written)
+	{
+		printf("shaderstore: cannot write %s\n", storePath.c_str());
+		return 1;
+	}
+	uint64_t storeSize = std::filesystem::file_size(storePath, error);
+
+	printf("shaderstore: %u permutations, %.1f KB loose in %u files, %.1f KB packed in 1 file (%.1f ms to pack)\n",
+		permutationCount, double(looseSize) / 1024.0, permutationCount, double(storeSize) / 1024.0, packMs);
+
+	// every variant ends with the bytecode of every permutation at hand, "+hash" also reads every byte
+	// like PipelineCache::ComputeKey() does (the page cache is warm for all of them)
+	int result = 0;
+	std::vector<std::vector<uint8_t>> loaded(permutationCount);
+	std::vector<double> samples[4];
+	uint64_t sink = 0;
+	for (uint32_t i = 0; i <= IterationCount; ++i)
+	{
+		for (uint32_t variant = 0; variant < 4; ++variant)
+		{
+			bool packed = (variant & 1) != 0;
+			bool hash = (variant & 2) != 0;
+			loaded.assign(permutationCount, std::vector<uint8_t>());
+
+			begin = BenchClock::now();
+			ShaderStore store;
+			bool match = packed ? store.Open(storePath.c_str()) : true;
+			for (uint32_t p = 0; p < permutationCount; ++p)
+			{
+				GfxShaderBytecode bytecode = { nullptr, 0 };
+				if (packed)
+				{
+					bytecode = store.Find(names[p].c_str());
+				}
+				else if (ReadFile(paths[p], loaded[p]))
+				{
+					bytecode = { loaded[p].data(), loaded[p].size() };
+				}
+
+				match &= bytecode.BytecodeLength == blobs[p].size();
+				sink += hash ? ShaderStore::ComputeContentHash(bytecode.pShaderBytecode, bytecode.BytecodeLength) : uintptr_t(bytecode.pShaderBytecode);
+			}
+			auto end = BenchClock::now();
+
+			if (i > 0)
+			{
+				samples[variant].push_back(ElapsedMs(begin, end));
+			}
+
+			// contents are compared outside of the measurement
+			for (uint32_t p = 0; p < permutationCount && match && i == 0; ++p)
+			{
+				GfxShaderBytecode bytecode = packed ? store.Find(names[p].c_str()) : GfxShaderBytecode{ loaded[p].data(), loaded[p].size() };
+				match &= memcmp(bytecode.pShaderBytecode, blobs[p].data(), blobs[p].size()) == 0;
+			}
+			result |= match ? 0 : 1;
+		}
+	}
+
+	static const char* const VariantNames[] = { "loose", "store", "loose+hash", "store+hash" };
+	printf("%12s %10s %12s %10s\n", "variant", "ms", "us/shader", "speedup");
+	for (uint32_t variant = 0; variant < 4; ++variant)
+	{
+		double ms = Median(samples[variant]);
+		double baseMs = Median(samples[variant & 2]);
+		printf("%12s %10.3f %12.2f %9.2fx\n", VariantNames[variant], ms, ms * 1000.0 / permutationCount, (ms > 0.0) ? baseMs / ms : 0.0);
+	}
+
+	// hot reload: every loose file watched (no compile command), one changes, one is saved unchanged
+	{
+		ShaderStore store;
+		store.Open(storePath.c_str());
+		for (uint32_t p = 0; p < permutationCount; ++p)
+		{
+			store.AddWatch(names[p].c_str(), paths[p].c_str(), paths[p].c_str(), nullptr);
+		}
+
+		begin = BenchClock::now();
+		uint32_t idleReloads = store.PollChanges();
+		double pollMs = ElapsedMs(begin, BenchClock::now());
+
+		// time stamps are moved explicitly, file systems with coarse times would miss a quick rewrite
+		uint32_t changed = permutationCount / 2;
+		uint32_t saved = changed + 1;
+		std::vector<uint8_t> edited = blobs[changed];
+		edited[0] ^= 0xff;
+		WriteFile(paths[changed], edited);
+		for (uint32_t p : { changed, saved })
+		{
+			std::filesystem::last_write_time(paths[p], std::filesystem::last_write_time(paths[p], error) + std::chrono::seconds(5), error);
+		}
+
+		begin = BenchClock::now();
+		uint32_t reloads = store.PollChanges();
+		double reloadMs = ElapsedMs(begin, BenchClock::now());
+
+		GfxShaderBytecode reloaded = store.Find(names[changed].c_str());
+		GfxShaderBytecode kept = store.Find(names[saved].c_str());
+		bool match = idleReloads == 0 && reloads == 1 && store.GetGeneration() == 1
+			&& reloaded.BytecodeLength == edited.size() && memcmp(reloaded.pShaderBytecode, edited.data(), edited.size()) == 0
+			&& kept.BytecodeLength == blobs[saved].size() && memcmp(kept.pShaderBytecode, blobs[saved].data(), blobs[saved].size()) == 0;
+		result |= match ? 0 : 1;
+
+		printf("hot reload: %u watches polled in %.3f ms (%.2f us each), 1 edit + 1 unchanged save -> %u reloaded in %.3f ms, %u distinct blobs%s\n",
+			permutationCount, pollMs, pollMs * 1000.0 / permutationCount, reloads, reloadMs, store.GetBlobCount(), match ? "" : "  MISMATCH");
+	}
+
+	// keeps the lookups and hashes from being optimized away
+	if (sink == 1)
+	{
+		printf("\n");
+	}
+
+	std::filesystem::remove_all(directory, error);
+	return result;
+}
@@ -0,0 +1,473 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <AssetStreamer.h>
+#include <LockFreeQueue.h>
+#include <MeshFile.h>
+#include <RecordingDevice.h>
+#include <ShaderTypes.h>
+#include <UploadQueue.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultAssetCount = 256; // mesh files along the camera path
+	const uint32_t DefaultFrameCount = 600; // frames of each run
+	const uint32_t IoThreadCount = 2; // I/O threads of the streamer
+	const uint32_t FrameWorkUs = 1000; // CPU time of a frame besides streaming
+	const uint32_t DriveLatencyUs = 100; // simulated access time of the drive (the files sit in the page cache)
+	const uint32_t DriveMBps = 1000; // simulated bandwidth of the drive
+	const uint32_t MinAssetKB = 32; // smallest mesh file
+	const uint32_t MaxAssetKB = 1024; // largest mesh file
+	const uint32_t ClusterSize = 16; // assets placed at the same distance, they come into view together
+	const float ViewDistance = 20.f; // assets closer than this (and ahead) are visible
+	const uint32_t QueueProducers = 4; // threads pushing into the lock-free queue check
+	const uint32_t QueueValues = 100000; // values pushed by each of them
+	const uint64_t Budgets[] = { 0, 4 * 1024 * 1024, 1024 * 1024, 256 * 1024 }; // bytes per frame (0 unlimited)
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// StreamedObject structure - asset placed along the camera path
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct StreamedObject
+	{
+		float Z; // position along the path
+		uint32_t Handle; // request of the streamer (InvalidHandle when not requested or released)
+		bool Loaded; // whether the asset was delivered
+		bool Done; // whether the object was drawn or passed
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// RunResult structure
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct RunResult
+	{
+		double MeanMs; // average frame time
+		double P99Ms; // 99th percentile frame time
+		double MaxMs; // slowest frame
+		double VisibleP50Ms; // median time from request to first frame drawing the asset
+		double VisibleP95Ms; // 95th percentile of it
+		StreamStats Stats; // totals of the streamer
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// busy wait, stands in for CPU work
+	//----------------------------------------------------------------------------------------------------
+	void Spin(uint64_t nanoseconds)
+	{
+		BenchClock::time_point end = BenchClock::now() + std::chrono::nanoseconds(nanoseconds);
+		while (BenchClock::now() < end)
+		{
+			/* DO_NOTHING */
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// mesh file of about the size in KB (a triangle strip of vertices written as a list)
+	//----------------------------------------------------------------------------------------------------
+	bool WriteMesh(const std::string& path, uint32_t sizeKB)
+	{
+		// 28 bytes per vertex and about 3 indices of 4 bytes
+		uint32_t vertexCount = std::max(sizeKB * 1024 / 40, 3u);
+		std::vector<Vertex> vertices(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; ++i)
+		{
+			float t = static_cast<float>(i) / static_cast<float>(vertexCount);
+			vertices[i].Position = DirectX::XMFLOAT3(t, static_cast<float>(i & 1), 0.f);
+			vertices[i].Color = DirectX::XMFLOAT4(t, 1.f - t, 0.5f, 1.f);
+		}
+
+		std::vector<uint32_t> indices;
+		indices.reserve(size_t(vertexCount - 2) * 3);
+		for (uint32_t i = 0; i + 2 < vertexCount; ++i)
+		{
+			uint32_t triangle[] = { i, i + 1, i + 2 };
+			indices.insert(indices.end(), triangle, triangle + 3);
+		}
+
+		MeshFileSubmesh submesh = {};
+		submesh.IndexCount = static_cast<uint32_t>(indices.size());
+		submesh.BoundsMax[0] = submesh.BoundsMax[1] = 1.f;
+
+		MeshFileDesc desc = {};
+		desc.VertexCount = vertexCount;
+		desc.StreamCount = 1;
+		desc.pStreams[0] = vertices.data();
+		desc.Strides[0] = sizeof(Vertex);
+		desc.Layouts[0] = MeshVertexLayout::PositionColor;
+		desc.pIndices = indices.data();
+		desc.IndexCount = submesh.IndexCount;
+		desc.IndexFormat = GfxFormat::R32_Uint;
+		desc.pSubmeshes = &submesh;
+		desc.SubmeshCount = 1;
+		desc.BoundsMax[0] = desc.BoundsMax[1] = 1.f;
+		return MeshFile::Write(path.c_str(), desc);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// small file of raw bytes
+	//----------------------------------------------------------------------------------------------------
+	bool WriteBlob(const std::string& path, uint32_t size)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		std::vector<char> data(size, 'x');
+		file.write(data.data(), static_cast<std::streamsize>(data.size()));
+		return static_cast<bool>(file.flush());
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// several producers and one consumer, nothing lost or reordered per producer
+	//----------------------------------------------------------------------------------------------------
+	bool CheckQueue()
+	{
+		LockFreeQueue<uint64_t> queue;
+		if (!queue.Init(64))
+		{
+			return Check("lock-free queue initialized", false);
+		}
+
+		std::vector<std::thread> producers;
+		for (uint32_t p = 0; p < QueueProducers; ++p)
+		{
+			producers.emplace_back([&queue, p]
+			{
+				for (uint64_t i = 0; i < QueueValues; ++i)
+				{
+					while (!queue.Push((uint64_t(p) << 32) | i))
+					{
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+
+		std::vector<uint64_t> next(QueueProducers, 0);
+		bool ordered = true;
+		for (uint64_t received = 0; received < uint64_t(QueueProducers) * QueueValues;)
+		{
+			uint64_t value = 0;
+			if (!queue.Pop(value))
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			uint32_t producer = static_cast<uint32_t>(value >> 32);
+			ordered &= producer < QueueProducers && (value & 0xffffffffu) == next[producer];
+			next[producer] = (value & 0xffffffffu) + 1;
+			received++;
+		}
+
+		for (std::thread& producer : producers)
+		{
+			producer.join();
+		}
+
+		uint64_t rest = 0;
+		return Check("lock-free queue delivers every value in order", ordered && !queue.Pop(rest));
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// deliver until nothing is pending, the delivered user data in order
+	//----------------------------------------------------------------------------------------------------
+	std::vector<uint64_t> Drain(AssetStreamer& streamer, uint64_t budget, uint32_t& maxPerUpdate, uint32_t& failed)
+	{
+		std::vector<uint64_t> order;
+		maxPerUpdate = 0;
+		failed = 0;
+		while (streamer.GetPendingCount() > 0)
+		{
+			uint32_t count = streamer.Update(budget, [&](StreamedAsset& asset)
+			{
+				order.push_back(asset.UserData);
+				failed += asset.Succeeded ? 0 : 1;
+				streamer.Release(asset.Handle);
+			});
+			maxPerUpdate = std::max(maxPerUpdate, count);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return order;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// order, cancellation, budget and failures with one I/O thread held back by a gate
+	//----------------------------------------------------------------------------------------------------
+	bool RunChecks(const std::filesystem::path& directory)
+	{
+		bool passed = CheckQueue();
+
+		std::string blob = (directory / "blob.bin").string();
+		std::string corrupt = (directory / "corrupt.mesh").string();
+		if (!WriteBlob(blob, 4096) || !WriteBlob(corrupt, 4096))
+		{
+			return Check("check files written", false);
+		}
+
+		// the texture decoder holds the only I/O thread until the gate opens, the rest queues up meanwhile
+		std::atomic<bool> gate(false);
+		AssetStreamer streamer;
+		streamer.SetDecoder(AssetType::Texture, [&gate](std::vector<uint8_t>&)
+		{
+			while (!gate.load(std::memory_order_acquire))
+			{
+				std::this_thread::yield();
+			}
+			return true;
+		});
+		if (!streamer.Init(1))
+		{
+			return Check("streamer initialized", false);
+		}
+
+		const float priorities[] = { 0.3f, 0.9f, 0.1f, 0.7f, 0.5f, 0.2f, 0.8f, 0.4f };
+		uint32_t handles[8] = {};
+		streamer.Request(blob.c_str(), AssetType::Texture, 10.f, 100);
+		for (uint32_t i = 0; i < 8; ++i)
+		{
+			handles[i] = streamer.Request(blob.c_str(), AssetType::Shader, priorities[i], i);
+		}
+
+		// the lowest moves to the front, another one is cancelled
+		streamer.SetPriority(handles[2], 5.f);
+		streamer.Release(handles[4]);
+		gate.store(true, std::memory_order_release);
+
+		uint32_t maxPerUpdate = 0;
+		uint32_t failed = 0;
+		std::vector<uint64_t> order = Drain(streamer, UINT64_MAX, maxPerUpdate, failed);
+		std::vector<uint64_t> expected = { 100, 2, 1, 6, 3, 7, 0, 5 };
+		passed &= Check("requests load by priority, changes included", order == expected);
+		passed &= Check("released request is never delivered", streamer.GetStats().CancelledCount == 1 && streamer.GetStats().DeliveredCount == 8);
+
+		// everything completes before the first update, a budget of zero still delivers one per frame
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			streamer.Request(blob.c_str(), AssetType::Shader, 1.f, i);
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		order = Drain(streamer, 0, maxPerUpdate, failed);
+		passed &= Check("budget spreads deliveries over frames", order.size() == 4 && maxPerUpdate == 1 && streamer.GetStats().DeferredCount > 0);
+
+		// unreadable files and data the decoder rejects arrive as failures
+		streamer.Request((directory / "missing.mesh").string().c_str(), AssetType::Mesh, 1.f);
+		streamer.Request(corrupt.c_str(), AssetType::Mesh, 1.f);
+		order = Drain(streamer, UINT64_MAX, maxPerUpdate, failed);
+		passed &= Check("missing and corrupt files are delivered as failures", order.size() == 2 && failed == 2 && streamer.GetStats().FailedCount == 2);
+
+		streamer.Term();
+		return passed;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// camera flying past clusters of assets, each frame streams, uploads and spins for the rest of its work
+	//----------------------------------------------------------------------------------------------------
+	bool RunScene(const std::vector<std::string>& paths, uint32_t frameCount, bool streaming, uint64_t budget, RunResult& result)
+	{
+		RecordingDevice device;
+		GfxPtr<GfxCommandQueue> pDirect;
+		GfxPtr<GfxFence> pFence;
+		UploadQueue uploads;
+		if (!device.CreateCommandQueue(GfxCommandListType::Direct, pDirect) || !device.CreateFence(0, pFence) || !uploads.Init(&device))
+		{
+			return false;
+		}
+
+		// every asset gets a range of a default heap (placed buffers of the recording backend have no memory)
+		uint64_t slotSize = (uint64_t(MaxAssetKB) * 1024 * 2 + GfxPlacementAlignment - 1) & ~(GfxPlacementAlignment - 1);
+		GfxPtr<GfxHeap> pHeap;
+		GfxPtr<GfxResource> pBuffer;
+		GfxBufferDesc desc = { slotSize * paths.size(), GfxHeapType::Default, GfxResourceState::Common };
+		if (!device.CreateHeap(GfxHeapDesc{ desc.Size, GfxHeapType::Default }, pHeap) || !device.CreatePlacedBuffer(pHeap.get(), 0, desc, pBuffer))
+		{
+			return false;
+		}
+
+		// the I/O threads wait for the simulated drive instead of taking CPU time from the frames
+		AssetStreamer streamer;
+		streamer.SetDecoder(AssetType::Mesh, [](std::vector<uint8_t>& data)
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(DriveLatencyUs + data.size() / DriveMBps));
+			return MeshFile::IsValid(data.data(), data.size());
+		});
+		if (!streamer.Init(IoThreadCount))
+		{
+			return false;
+		}
+
+		// clusters every 10 units, the camera passes all of them during the run
+		std::vector<StreamedObject> objects(paths.size());
+		for (size_t i = 0; i < objects.size(); ++i)
+		{
+			objects[i] = StreamedObject{ ViewDistance + 10.f * static_cast<float>(i / ClusterSize) + 0.1f * static_cast<float>(i % ClusterSize), AssetStreamer::InvalidHandle, false, false };
+		}
+		float speed = (objects.back().Z + ViewDistance) / static_cast<float>(frameCount);
+
+		std::vector<double> frameMs;
+		frameMs.reserve(frameCount);
+		float camera = 0.f;
+		for (uint32_t frame = 0; frame < frameCount; ++frame)
+		{
+			BenchClock::time_point begin = BenchClock::now();
+			uploads.Retire();
+			camera += speed;
+
+			// assets come into view ahead of the camera, the nearest first, the ones passed are dropped
+			if (streaming)
+			{
+				for (StreamedObject& object : objects)
+				{
+					float distance = object.Z - camera;
+					if (object.Done || distance > ViewDistance)
+					{
+						continue;
+					}
+
+					float priority = AssetStreamer::ComputePriority(std::max(distance, 0.f), distance >= 0.f);
+					if (distance < 0.f)
+					{
+						streamer.Release(object.Handle);
+						object.Handle = AssetStreamer::InvalidHandle;
+						object.Done = true;
+					}
+					else if (object.Handle == AssetStreamer::InvalidHandle)
+					{
+						object.Handle = streamer.Request(paths[&object - objects.data()].c_str(), AssetType::Mesh, priority, uint64_t(&object - objects.data()));
+					}
+					else if (!object.Loaded)
+					{
+						streamer.SetPriority(object.Handle, priority);
+					}
+				}
+
+				streamer.Update((budget == 0) ? UINT64_MAX : budget, [&](StreamedAsset& asset)
+				{
+					StreamedObject& object = objects[asset.UserData];
+					object.Loaded = asset.Succeeded && uploads.Upload(pBuffer.get(), asset.UserData * slotSize, asset.Data.data(), asset.Data.size());
+				});
+
+				// the draws of this frame wait for the copies, the assets delivered are on screen
+				for (StreamedObject& object : objects)
+				{
+					if (object.Loaded && !object.Done)
+					{
+						streamer.MarkVisible(object.Handle);
+						streamer.Release(object.Handle);
+						object.Handle = AssetStreamer::InvalidHandle;
+						object.Done = true;
+					}
+				}
+			}
+
+			Spin(uint64_t(FrameWorkUs) * 1000);
+			uploads.Submit();
+			uploads.Sync(pDirect.get());
+			pDirect->Signal(pFence.get(), frame + 1);
+			frameMs.push_back(ElapsedMs(begin, BenchClock::now()));
+		}
+		pFence->Wait(frameCount);
+
+		std::vector<double> visibleMs(streamer.GetVisibleLatencies().begin(), streamer.GetVisibleLatencies().end());
+		std::sort(visibleMs.begin(), visibleMs.end());
+		std::sort(frameMs.begin(), frameMs.end());
+		double totalMs = 0.0;
+		for (double ms : frameMs)
+		{
+			totalMs += ms;
+		}
+
+		result.MeanMs = totalMs / frameCount;
+		result.P99Ms = Percentile(frameMs, 0.99);
+		result.MaxMs = frameMs.back();
+		result.VisibleP50Ms = Percentile(visibleMs, 0.50);
+		result.VisibleP95Ms = Percentile(visibleMs, 0.95);
+		result.Stats = streamer.GetStats();
+
+		streamer.Term();
+		uploads.Term();
+		return true;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 streamer checks, then frame times and time to first visible under heavy streaming per upload budget
+//--------------------------------------------------------------------------------------------------------
+int RunStreamingBenchmark(int argc, char** argv)
+{
+	uint32_t assetCount = std::max(ArgU32(argc, argv, 1, DefaultAssetCount), 1u);
+	uint32_t frameCount = std::max(ArgU32(argc, argv, 2, DefaultFrameCount), 1u);
+
+	std::error_code error;
+	std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "ReLearnD3D12_streaming";
+	std::filesystem::remove_all(directory, error);
+	std::filesystem::create_directories(directory, error);
+
+	printf("streaming: streamer checks\n");
+	int result = RunChecks(directory) ? 0 : 1;
+
+	// sizes spread evenly between the smallest and the largest file
+	std::vector<std::string> paths(assetCount);
+	uint64_t totalKB = 0;
+	uint32_t seed = 12345;
+	for (uint32_t i = 0; i < assetCount; ++i)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		uint32_t sizeKB = MinAssetKB + (seed >> 8) % (MaxAssetKB - MinAssetKB + 1);
+		paths[i] = (directory / ("asset" + std::to_string(i) + ".mesh")).string();
+		if (!WriteMesh(paths[i], sizeKB))
+		{
+			printf("streaming: cannot write %s\n", paths[i].c_str());
+			std::filesystem::remove_all(directory, error);
+			return 1;
+		}
+		totalKB += sizeKB;
+	}
+
+	printf("streaming: %u assets (%llu MB) in clusters of %u, %u frames of %u us, %u I/O threads, drive %u us + %u MB/s\n",
+		assetCount, static_cast<unsigned long long>(totalKB / 1024), ClusterSize, frameCount, FrameWorkUs, IoThreadCount, DriveLatencyUs, DriveMBps);
+	printf("%-12s %9s %9s %9s %12s %12s %10s %9s %9s\n", "budget", "mean ms", "p99 ms", "max ms", "visible p50", "visible p95", "delivered", "deferred", "cancelled");
+
+	RunResult idle = {};
+	if (!RunScene(paths, frameCount, false, 0, idle))
+	{
+		printf("streaming: cannot create the scene\n");
+		std::filesystem::remove_all(directory, error);
+		return 1;
+	}
+	printf("%-12s %9.3f %9.3f %9.3f %12s %12s %10s %9s %9s\n", "no streaming", idle.MeanMs, idle.P99Ms, idle.MaxMs, "-", "-", "-", "-", "-");
+
+	for (uint64_t budget : Budgets)
+	{
+		RunResult run = {};
+		if (!RunScene(paths, frameCount, true, budget, run))
+		{
+			printf("streaming: cannot create the scene\n");
+			result = 1;
+			break;
+		}
+
+		char name[32] = "unlimited";
+		if (budget > 0)
+		{
+			snprintf(name, sizeof(name), "%llu KB", static_cast<unsigned long long>(budget / 1024));
+		}
+		printf("%-12s %9.3f %9.3f %9.3f %9.3f ms %9.3f ms %10llu %9llu %9llu\n", name, run.MeanMs, run.P99Ms, run.MaxMs, run.VisibleP50Ms, run.VisibleP95Ms,
+			static_cast<unsigned long long>(run.Stats.DeliveredCount), static_cast<unsigned long long>(run.Stats.DeferredCount),
+			static_cast<unsigned long long>(run.Stats.CancelledCount));
+	}
+
+	std::filesystem::remove_all(directory, error);
+	return result;
+}
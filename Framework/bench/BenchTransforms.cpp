@@ -0,0 +1,183 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <TransformSystem.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultObjectCount = 100000; // objects per iteration
+	const uint32_t DefaultIterationCount = 20; // iterations measured per variant
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// ObjectMatrices structure - same layout as a per-object constant buffer
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct alignas(16) ObjectMatrices
+	{
+		DirectX::XMFLOAT4X4 World; // world matrix
+		DirectX::XMFLOAT4X4 WorldViewProj; // world-view-projection matrix
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// objects scattered around the origin with random orientation and scale
+	//----------------------------------------------------------------------------------------------------
+	void BuildObjects(uint32_t count, TransformSystem& transforms)
+	{
+		uint32_t seed = 12345u;
+		auto random = [&seed]()
+		{
+			seed = seed * 1664525u + 1013904223u;
+			return float(seed >> 8) / float(1u << 24);
+		};
+
+		transforms.Clear();
+		transforms.Reserve(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			DirectX::XMFLOAT3 position(random() * 200.f - 100.f, random() * 200.f - 100.f, random() * 200.f - 100.f);
+			DirectX::XMVECTOR axis = DirectX::XMVector3Normalize(
+				DirectX::XMVectorSet(random() - 0.5f, random() - 0.5f, random() - 0.5f + 1e-3f, 0.f));
+
+			DirectX::XMFLOAT4 rotation;
+			DirectX::XMStoreFloat4(&rotation, DirectX::XMQuaternionRotationAxis(axis, random() * 6.2831853f));
+
+			float scale = 0.5f + random();
+			transforms.Add(position, rotation, DirectX::XMFLOAT3(scale, scale * 0.5f + 0.25f, scale));
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// per-object reference with the DirectXMath calls
+	//----------------------------------------------------------------------------------------------------
+	void ComputeReference(TransformSystem& transforms, const DirectX::XMMATRIX& viewProj, ObjectMatrices* pOutput)
+	{
+		const float* px = transforms.GetPositionX();
+		const float* py = transforms.GetPositionY();
+		const float* pz = transforms.GetPositionZ();
+		const float* qx = transforms.GetRotationX();
+		const float* qy = transforms.GetRotationY();
+		const float* qz = transforms.GetRotationZ();
+		const float* qw = transforms.GetRotationW();
+		const float* sx = transforms.GetScaleX();
+		const float* sy = transforms.GetScaleY();
+		const float* sz = transforms.GetScaleZ();
+
+		for (uint32_t i = 0; i < transforms.GetCount(); ++i)
+		{
+			DirectX::XMMATRIX world = DirectX::XMMatrixMultiply(
+				DirectX::XMMatrixMultiply(
+					DirectX::XMMatrixScaling(sx[i], sy[i], sz[i]),
+					DirectX::XMMatrixRotationQuaternion(DirectX::XMVectorSet(qx[i], qy[i], qz[i], qw[i]))),
+				DirectX::XMMatrixTranslation(px[i], py[i], pz[i]));
+
+			DirectX::XMStoreFloat4x4(&pOutput[i].World, world);
+			DirectX::XMStoreFloat4x4(&pOutput[i].WorldViewProj, DirectX::XMMatrixMultiply(world, viewProj));
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// largest element difference relative to the element magnitude (at least 1)
+	//----------------------------------------------------------------------------------------------------
+	float MaxError(const std::vector<ObjectMatrices>& a, const std::vector<ObjectMatrices>& b)
+	{
+		float maxError = 0.f;
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			const float* pA = &a[i].World.m[0][0];
+			const float* pB = &b[i].World.m[0][0];
+			for (uint32_t j = 0; j < 32; ++j)
+			{
+				float error = fabsf(pA[j] - pB[j]) / std::max(fabsf(pA[j]), 1.f);
+				maxError = std::max(maxError, error);
+			}
+		}
+		return maxError;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 per-object XMMatrix* calls against the SoA kernels, world and world-view-projection per object
+//--------------------------------------------------------------------------------------------------------
+int RunTransformBenchmark(int argc, char** argv)
+{
+	uint32_t objectCount = std::max(ArgU32(argc, argv, 1, DefaultObjectCount), 1u);
+	uint32_t iterationCount = std::max(ArgU32(argc, argv, 2, DefaultIterationCount), 1u);
+
+	TransformSystem transforms;
+	BuildObjects(objectCount, transforms);
+
+	DirectX::XMMATRIX viewProj = DirectX::XMMatrixMultiply(
+		DirectX::XMMatrixLookAtRH(
+			DirectX::XMVectorSet(0.f, 50.f, 250.f, 0.f),
+			DirectX::XMVectorZero(),
+			DirectX::XMVectorSet(0.f, 1.f, 0.f, 0.f)),
+		DirectX::XMMatrixPerspectiveFovRH(DirectX::XMConvertToRadians(37.5f), 16.f / 9.f, 1.f, 1000.f));
+
+	std::vector<ObjectMatrices> reference(objectCount);
+	std::vector<ObjectMatrices> result(objectCount);
+
+	TransformOutput output = {};
+	output.pWorld = &result[0].World;
+	output.pWorldViewProj = &result[0].WorldViewProj;
+	output.Stride = sizeof(ObjectMatrices);
+
+	printf("transforms: %u objects, median of %u iterations\n", objectCount, iterationCount);
+	printf("%12s %10s %12s %10s\n", "variant", "ms", "ns/object", "speedup");
+
+	// warm-up pass of each variant touches the output
+	std::vector<double> referenceMs;
+	for (uint32_t i = 0; i <= iterationCount; ++i)
+	{
+		auto begin = BenchClock::now();
+		ComputeReference(transforms, viewProj, reference.data());
+		auto end = BenchClock::now();
+		if (i > 0)
+		{
+			referenceMs.push_back(ElapsedMs(begin, end));
+		}
+	}
+	double baseline = Median(referenceMs);
+	printf("%12s %10.3f %12.2f %9.2fx\n", "XMMatrix", baseline, baseline * 1e6 / objectCount, 1.0);
+
+	const bool writeCombined[] = { false, true };
+	for (bool streamStores : writeCombined)
+	{
+		output.WriteCombined = streamStores;
+
+		std::vector<double> soaMs;
+		for (uint32_t i = 0; i <= iterationCount; ++i)
+		{
+			auto begin = BenchClock::now();
+			transforms.Compute(0, objectCount, viewProj, output);
+			auto end = BenchClock::now();
+			if (i > 0)
+			{
+				soaMs.push_back(ElapsedMs(begin, end));
+			}
+		}
+
+		double ms = Median(soaMs);
+		printf("%12s %10.3f %12.2f %9.2fx\n",
+			streamStores ? "SoA stream" : "SoA",
+			ms, ms * 1e6 / objectCount, (ms > 0.0) ? baseline / ms : 0.0);
+	}
+
+	float maxError = MaxError(reference, result);
+	printf("transforms: max relative error %g\n", maxError);
+	if (maxError > 1e-4f)
+	{
+		printf("transforms: MISMATCH against XMMatrix\n");
+		return 1;
+	}
+
+	return 0;
+}
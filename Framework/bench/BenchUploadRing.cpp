@@ -0,0 +1,133 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <UploadRing.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultAllocationCount = 10000; // allocations per frame of the timed part
+	const uint32_t DefaultFrameCount = 200; // frames of the timed part
+	const uint32_t FramesInFlight = 2; // frames the simulated GPU lags behind
+	const uint64_t CheckCapacity = 4096; // bytes of the ring of the checks
+	const uint64_t CheckAllocationSize = 1000; // bytes per allocation of the checks (padded to 1024)
+	const GfxGpuVirtualAddress GpuBase = 0x10000; // made-up GPU address of the caller-owned memory
+
+	//----------------------------------------------------------------------------------------------------
+	// whether an allocation points into the memory at the offset, on both sides
+	//----------------------------------------------------------------------------------------------------
+	bool IsAllocation(const UploadAllocation& allocation, uint8_t* pBase, uint64_t offset)
+	{
+		return allocation.pCPU == pBase + offset && allocation.GPU == GpuBase + offset && allocation.Offset == offset;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// placement, full ring, retirement by fence value and wrap-around over caller-owned memory
+	//----------------------------------------------------------------------------------------------------
+	bool RunChecks()
+	{
+		std::vector<uint8_t> memory(CheckCapacity);
+		UploadRing ring;
+		if (!Check("ring over caller-owned memory", ring.Init(memory.data(), GpuBase, CheckCapacity) && ring.GetBuffer() == nullptr))
+		{
+			return false;
+		}
+
+		// frame 1 takes three aligned blocks, the fence value it signals is 1
+		uint64_t completedValue = 0;
+		UploadAllocation a = {};
+		UploadAllocation b = {};
+		UploadAllocation c = {};
+		bool placed = ring.Allocate(CheckAllocationSize, a) && ring.Allocate(CheckAllocationSize, b) && ring.Allocate(CheckAllocationSize, c)
+			&& IsAllocation(a, memory.data(), 0) && IsAllocation(b, memory.data(), 1024) && IsAllocation(c, memory.data(), 2048);
+		ring.EndFrame(1);
+		bool passed = Check("allocations aligned, CPU and GPU side agree", placed);
+
+		// frame 2 takes the last block, the next one doesn't fit before the GPU is done with frame 1
+		UploadAllocation d = {};
+		UploadAllocation e = {};
+		bool last = ring.Allocate(CheckAllocationSize, d) && IsAllocation(d, memory.data(), 3072);
+		bool full = !ring.Allocate(CheckAllocationSize, e) && ring.GetStats().FailedAllocations == 1;
+		passed &= Check("full ring returns false", last && full);
+
+		// the fence hasn't moved, then reaches frame 1
+		ring.Retire(completedValue);
+		bool held = !ring.Allocate(CheckAllocationSize, e) && ring.GetPendingFrameCount() == 1;
+		completedValue = 1;
+		ring.Retire(completedValue);
+		bool reclaimed = ring.GetPendingFrameCount() == 0 && ring.GetUsedBytes() == 1024;
+		passed &= Check("region reclaimed only after Retire", held && reclaimed);
+
+		// the tail end is skipped, the allocation starts over at the beginning of the memory
+		bool wrapped = ring.Allocate(CheckAllocationSize, e) && IsAllocation(e, memory.data(), 0) && ring.GetUsedBytes() == 2048;
+		ring.EndFrame(2);
+		passed &= Check("allocation wraps around to the start", wrapped);
+
+		// frame 1 took 3048 bytes with the padding, frame 2 took 1024 at the end and 1024 with the skipped tail
+		const LinearRingStats& stats = ring.GetStats();
+		passed &= Check("peak and average bytes per frame", stats.FrameCount == 2 && stats.PeakFrameUnits == 3048
+			&& stats.LastFrameUnits == 2048 && stats.GetAverageFrameUnits() == 2548.0);
+		return passed;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 rules of the upload ring on a simulated fence, then allocations per second with frames in flight
+//--------------------------------------------------------------------------------------------------------
+int RunUploadRingBenchmark(int argc, char** argv)
+{
+	uint32_t allocationCount = std::max(ArgU32(argc, argv, 1, DefaultAllocationCount), 1u);
+	uint32_t frameCount = std::max(ArgU32(argc, argv, 2, DefaultFrameCount), 1u);
+
+	printf("uploadring: checks\n");
+	int result = RunChecks() ? 0 : 1;
+
+	// constant buffers of one draw each, the ring holds the frames in flight plus the one being written
+	std::vector<uint8_t> memory(size_t(allocationCount) * UploadRing::DefaultAlignment * (FramesInFlight + 1));
+	UploadRing ring;
+	if (!ring.Init(memory.data(), GpuBase, memory.size()))
+	{
+		printf("uploadring: cannot initialize the ring\n");
+		return 1;
+	}
+
+	// the simulated GPU finishes a frame FramesInFlight frames after it was submitted
+	auto begin = BenchClock::now();
+	for (uint32_t frame = 1; frame <= frameCount; ++frame)
+	{
+		ring.Retire((frame > FramesInFlight) ? frame - FramesInFlight : 0);
+		for (uint32_t i = 0; i < allocationCount; ++i)
+		{
+			UploadAllocation allocation;
+			uint64_t size = 64 + (i % 4) * 64;
+			if (ring.Allocate(size, allocation))
+			{
+				static_cast<uint8_t*>(allocation.pCPU)[0] = static_cast<uint8_t>(i);
+			}
+		}
+		ring.EndFrame(frame);
+	}
+	double ms = ElapsedMs(begin, BenchClock::now());
+
+	const LinearRingStats& stats = ring.GetStats();
+	bool steady = stats.FailedAllocations == 0;
+	result |= steady ? 0 : 1;
+	printf("uploadring: %u frames of %u allocations, %u frames in flight, %llu KB ring\n",
+		frameCount, allocationCount, FramesInFlight, static_cast<unsigned long long>(ring.GetCapacity() / 1024));
+	printf("%14s %14s %14s %10s\n", "ns/alloc", "peak KB/f", "average KB/f", "failed");
+	printf("%14.2f %14.1f %14.1f %10llu%s\n",
+		ms * 1000000.0 / (double(frameCount) * allocationCount),
+		static_cast<double>(stats.PeakFrameUnits) / 1024.0,
+		stats.GetAverageFrameUnits() / 1024.0,
+		static_cast<unsigned long long>(stats.FailedAllocations),
+		steady ? "" : "  MISMATCH");
+	return result;
+}
@@ -0,0 +1,243 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <RecordingDevice.h>
+#include <UploadQueue.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultMegabytes = 256; // data uploaded per buffer size
+	const uint32_t DefaultFrameCount = 64; // frames the data is spread over
+	const uint32_t GpuTime = 100; // simulated time of a submission in microseconds
+	const uint64_t StagingSize = 4 * 1024 * 1024; // staging ring of the timed runs
+	const uint64_t CheckStagingSize = 1024 * 1024; // staging ring of the checks (smaller than the largest upload)
+	const uint64_t BufferSizes[] = { 4 * 1024, 64 * 1024, 1024 * 1024 }; // sizes of the timed buffers
+
+	//----------------------------------------------------------------------------------------------------
+	// pattern that differs for every byte of every upload
+	//----------------------------------------------------------------------------------------------------
+	void Fill(std::vector<uint8_t>& data, uint32_t seed)
+	{
+		for (size_t i = 0; i < data.size(); ++i)
+		{
+			data[i] = static_cast<uint8_t>((i * 31u + seed * 7u + (i >> 12)) & 0xff);
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// records of an op in the stream of the frame being built
+	//----------------------------------------------------------------------------------------------------
+	uint32_t CountOps(const RecordingDevice& device, RecordOp op)
+	{
+		uint32_t count = 0;
+		device.GetStream().ForEach([op, &count](RecordOp recorded, const void*, uint32_t) { count += (recorded == op) ? 1 : 0; });
+		return count;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// contents, merged copies, synchronization and back pressure on the simulated queues
+	//----------------------------------------------------------------------------------------------------
+	bool RunChecks()
+	{
+		RecordingDevice device;
+		GfxPtr<GfxCommandQueue> pDirect;
+		UploadQueue uploads;
+		if (!device.CreateCommandQueue(GfxCommandListType::Direct, pDirect) || !uploads.Init(&device, CheckStagingSize))
+		{
+			return Check("upload queue initialized", false);
+		}
+
+		// a small buffer, one at an offset and one three times the staging ring
+		const uint64_t sizes[] = { 100, 64 * 1024, 3 * CheckStagingSize };
+		const uint64_t offsets[] = { 0, 4096, 0 };
+		GfxPtr<GfxResource> pBuffers[3];
+		std::vector<uint8_t> data[3];
+		bool uploaded = true;
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			GfxBufferDesc desc = { offsets[i] + sizes[i], GfxHeapType::Default, GfxResourceState::Common };
+			data[i].resize(static_cast<size_t>(sizes[i]));
+			Fill(data[i], i);
+			uploaded &= device.CreateBuffer(desc, pBuffers[i]) && uploads.Upload(pBuffers[i].get(), offsets[i], data[i].data(), sizes[i]);
+		}
+		uint64_t value = uploads.Submit();
+
+		bool copied = uploaded;
+		for (uint32_t i = 0; i < 3 && copied; ++i)
+		{
+			void* pData = nullptr;
+			copied &= pBuffers[i]->Map(&pData) && memcmp(static_cast<uint8_t*>(pData) + offsets[i], data[i].data(), data[i].size()) == 0;
+		}
+		bool passed = Check("data larger than the staging ring arrives intact", copied);
+
+		// 12 chunks of a quarter ring, the ring wraps twice: the chunks between the wraps are one copy each
+		const UploadStats& stats = uploads.GetStats();
+		passed &= Check("contiguous chunks merged into one copy", stats.CopyCount < 2 + (3 * CheckStagingSize) / (CheckStagingSize / 4)
+			&& stats.CopyCount == CountOps(device, RecordOp::CopyBufferRegion) && stats.BatchCount >= 3);
+
+		// one GPU wait per new batch, nothing when nothing new was submitted
+		bool synced = uploads.Sync(pDirect.get()) && !uploads.Sync(pDirect.get()) && uploads.Submit() == value && !uploads.Sync(pDirect.get());
+		passed &= Check("direct queue waits once per new batch", synced && stats.SyncCount == 1 && CountOps(device, RecordOp::Wait) == 1);
+
+		// a slow GPU runs out of command lists and staging memory, the CPU waits and nothing is lost (the data is
+		// prepared first, so that the submissions follow each other faster than the GPU gets through them)
+		const uint32_t submitCount = 2 * UploadQueue::MaxBatches;
+		std::vector<uint8_t> chunks(static_cast<size_t>(submitCount * CheckStagingSize / 4));
+		Fill(chunks, 10);
+		device.SetGpuWorkTime(10000, 0);
+		bool intact = true;
+		for (uint32_t i = 0; i < submitCount; ++i)
+		{
+			uint64_t offset = i * CheckStagingSize / 4;
+			intact &= uploads.Upload(pBuffers[2].get(), offset, chunks.data() + offset, CheckStagingSize / 4);
+			uploads.Submit();
+		}
+		void* pData = nullptr;
+		intact &= pBuffers[2]->Map(&pData) && memcmp(pData, chunks.data(), chunks.size()) == 0;
+		passed &= Check("back pressure stalls the CPU instead of overwriting", intact && stats.StallCount > 0);
+
+		uploads.Term();
+		return passed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// RunResult structure
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct RunResult
+	{
+		double MegabytesPerSecond; // data moved per second of CPU time
+		UploadStats Stats; // totals of the upload queue (empty for the upload heap)
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// former path: every buffer is a committed upload resource written through its mapping
+	//----------------------------------------------------------------------------------------------------
+	bool RunUploadHeap(uint64_t totalSize, uint64_t bufferSize, RunResult& result)
+	{
+		RecordingDevice device;
+		std::vector<uint8_t> data(static_cast<size_t>(bufferSize));
+		Fill(data, 1);
+
+		uint64_t count = totalSize / bufferSize;
+		GfxBufferDesc desc = { bufferSize, GfxHeapType::Upload, GfxResourceState::GenericRead };
+		auto begin = BenchClock::now();
+		for (uint64_t i = 0; i < count; ++i)
+		{
+			GfxPtr<GfxResource> pBuffer;
+			void* pData = nullptr;
+			if (!device.CreateBuffer(desc, pBuffer) || !pBuffer->Map(&pData))
+			{
+				return false;
+			}
+			memcpy(pData, data.data(), data.size());
+			pBuffer->Unmap();
+		}
+		double ms = ElapsedMs(begin, BenchClock::now());
+
+		result = RunResult();
+		result.MegabytesPerSecond = (count * bufferSize) / (1024.0 * 1024.0) / (ms / 1000.0);
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// copy queue: the buffers of a frame are staged, submitted as one batch and waited for by the frame
+	//----------------------------------------------------------------------------------------------------
+	bool RunCopyQueue(uint64_t totalSize, uint64_t bufferSize, uint32_t frameCount, RunResult& result)
+	{
+		RecordingDevice device;
+		device.SetGpuWorkTime(GpuTime, 0);
+		GfxPtr<GfxCommandQueue> pDirect;
+		UploadQueue uploads;
+		if (!device.CreateCommandQueue(GfxCommandListType::Direct, pDirect) || !uploads.Init(&device, StagingSize))
+		{
+			return false;
+		}
+
+		// destinations stand for sub-allocations of a default heap, placed without backing memory
+		GfxPtr<GfxHeap> pHeap;
+		GfxPtr<GfxResource> pDestination;
+		uint64_t heapSize = (totalSize + GfxPlacementAlignment - 1) & ~(GfxPlacementAlignment - 1);
+		GfxBufferDesc desc = { heapSize, GfxHeapType::Default, GfxResourceState::Common };
+		if (!device.CreateHeap(GfxHeapDesc{ heapSize, GfxHeapType::Default }, pHeap) || !device.CreatePlacedBuffer(pHeap.get(), 0, desc, pDestination))
+		{
+			return false;
+		}
+
+		std::vector<uint8_t> data(static_cast<size_t>(bufferSize));
+		Fill(data, 1);
+
+		uint64_t count = totalSize / bufferSize;
+		uint64_t perFrame = std::max<uint64_t>(count / frameCount, 1);
+		auto begin = BenchClock::now();
+		for (uint64_t i = 0; i < count;)
+		{
+			uploads.Retire();
+			for (uint64_t end = std::min(count, i + perFrame); i < end; ++i)
+			{
+				if (!uploads.Upload(pDestination.get(), i * bufferSize, data.data(), bufferSize))
+				{
+					return false;
+				}
+			}
+			uploads.Submit();
+			uploads.Sync(pDirect.get());
+		}
+		GfxPtr<GfxFence> pFence;
+		if (!device.CreateFence(0, pFence))
+		{
+			return false;
+		}
+		pDirect->Signal(pFence.get(), 1);
+		pFence->Wait(1);
+		double ms = ElapsedMs(begin, BenchClock::now());
+
+		result.MegabytesPerSecond = (count * bufferSize) / (1024.0 * 1024.0) / (ms / 1000.0);
+		result.Stats = uploads.GetStats();
+		uploads.Term();
+		return true;
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 batching checks on the simulated queues, then upload throughput and synchronization per buffer size
+//--------------------------------------------------------------------------------------------------------
+int RunUploadsBenchmark(int argc, char** argv)
+{
+	uint64_t totalSize = uint64_t(std::max(ArgU32(argc, argv, 1, DefaultMegabytes), 1u)) * 1024 * 1024;
+	uint32_t frameCount = std::max(ArgU32(argc, argv, 2, DefaultFrameCount), 1u);
+
+	printf("uploads: batching checks\n");
+	int result = RunChecks() ? 0 : 1;
+
+	printf("uploads: %llu MB per buffer size over %u frames, staging %llu KB, GPU %u us per batch\n",
+		static_cast<unsigned long long>(totalSize / (1024 * 1024)), frameCount,
+		static_cast<unsigned long long>(StagingSize / 1024), GpuTime);
+	printf("%-12s %10s %10s %10s %10s %12s %10s %10s\n", "path", "buffer KB", "MB/s", "copies", "batches", "syncs/frame", "stalls", "stall ms");
+	for (uint64_t bufferSize : BufferSizes)
+	{
+		RunResult heap;
+		RunResult queue;
+		if (!RunUploadHeap(totalSize, bufferSize, heap) || !RunCopyQueue(totalSize, bufferSize, frameCount, queue))
+		{
+			printf("uploads: cannot create the buffers\n");
+			return 1;
+		}
+
+		printf("%-12s %10llu %10.1f %10s %10s %12s %10s %10s\n", "upload heap", static_cast<unsigned long long>(bufferSize / 1024),
+			heap.MegabytesPerSecond, "-", "-", "-", "-", "-");
+		printf("%-12s %10llu %10.1f %10llu %10llu %12.2f %10llu %10.2f\n", "copy queue", static_cast<unsigned long long>(bufferSize / 1024),
+			queue.MegabytesPerSecond, static_cast<unsigned long long>(queue.Stats.CopyCount), static_cast<unsigned long long>(queue.Stats.BatchCount),
+			static_cast<double>(queue.Stats.SyncCount) / frameCount, static_cast<unsigned long long>(queue.Stats.StallCount), queue.Stats.StallMs);
+	}
+	return result;
+}
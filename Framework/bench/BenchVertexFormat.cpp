@@ -0,0 +1,127 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include <VertexFormat.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t DefaultVertexCount = 1000000; // vertices encoded per iteration
+	const uint32_t DefaultIterationCount = 20; // iterations measured per variant
+
+	//----------------------------------------------------------------------------------------------------
+	// one component at a time, straight from the definition of the formats
+	//----------------------------------------------------------------------------------------------------
+	void EncodeReference(const Vertex* pSource, uint32_t count, const VertexQuantization& quantization, PackedVertex* pDest)
+	{
+		const float* pScale = &quantization.Scale.x;
+		const float* pOffset = &quantization.Offset.x;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const float* pPosition = &pSource[i].Position.x;
+			for (uint32_t a = 0; a < 3; ++a)
+			{
+				float snorm = std::min(std::max((pPosition[a] - pOffset[a]) * ((1.f / pScale[a]) * 32767.f), -32767.f), 32767.f);
+				pDest[i].Position[a] = static_cast<int16_t>(lrintf(snorm));
+			}
+			pDest[i].Position[3] = 0;
+
+			const float* pColor = &pSource[i].Color.x;
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				pDest[i].Color[c] = static_cast<uint8_t>(lrintf(std::min(std::max(pColor[c], 0.f), 1.f) * 255.f));
+			}
+		}
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+//	 float to packed vertex encoding, reference against VertexFormat::Encode(), and the quantization error
+//--------------------------------------------------------------------------------------------------------
+int RunVertexFormatBenchmark(int argc, char** argv)
+{
+	uint32_t vertexCount = std::max(ArgU32(argc, argv, 1, DefaultVertexCount), 1u);
+	uint32_t iterationCount = std::max(ArgU32(argc, argv, 2, DefaultIterationCount), 1u);
+
+	// scene sized positions (a 400 unit cube) and colors, a few of them out of range to exercise clamping
+	uint32_t seed = 12345u;
+	auto random = [&seed]()
+	{
+		seed = seed * 1664525u + 1013904223u;
+		return float(seed >> 8) / float(1u << 24);
+	};
+
+	std::vector<Vertex> vertices(vertexCount);
+	float boundsMin[3] = { 1e30f, 1e30f, 1e30f };
+	float boundsMax[3] = { -1e30f, -1e30f, -1e30f };
+	for (Vertex& vertex : vertices)
+	{
+		vertex.Position = DirectX::XMFLOAT3(random() * 400.f - 200.f, random() * 100.f, random() * 400.f - 200.f);
+		vertex.Color = DirectX::XMFLOAT4(random(), random(), random(), random() * 1.1f - 0.05f);
+
+		const float* pPosition = &vertex.Position.x;
+		for (uint32_t a = 0; a < 3; ++a)
+		{
+			boundsMin[a] = std::min(boundsMin[a], pPosition[a]);
+			boundsMax[a] = std::max(boundsMax[a], pPosition[a]);
+		}
+	}
+	VertexQuantization quantization = VertexFormat::ComputeQuantization(boundsMin, boundsMax);
+
+	std::vector<PackedVertex> expected(vertexCount);
+	std::vector<PackedVertex> packed(vertexCount);
+
+	printf("vertexformat: %u vertices, %u -> %u bytes per vertex (%.1f%% of the bandwidth), median of %u iterations\n",
+		vertexCount, uint32_t(sizeof(Vertex)), uint32_t(sizeof(PackedVertex)), 100.0 * sizeof(PackedVertex) / sizeof(Vertex), iterationCount);
+	printf("%10s %10s %12s %12s %10s\n", "variant", "ms", "ns/vertex", "MB/s in", "speedup");
+
+	int result = 0;
+	double baseline = 0.0;
+	for (uint32_t variant = 0; variant < 2; ++variant)
+	{
+		std::vector<double> samples;
+		for (uint32_t i = 0; i <= iterationCount; ++i)
+		{
+			auto begin = BenchClock::now();
+			if (variant == 0)
+			{
+				EncodeReference(vertices.data(), vertexCount, quantization, expected.data());
+			}
+			else
+			{
+				VertexFormat::Encode(vertices.data(), vertexCount, quantization, packed.data());
+			}
+			auto end = BenchClock::now();
+			if (i > 0)
+			{
+				samples.push_back(ElapsedMs(begin, end));
+			}
+		}
+
+		double ms = Median(samples);
+		baseline = (variant == 0) ? ms : baseline;
+		bool match = (variant == 0) || memcmp(expected.data(), packed.data(), vertexCount * sizeof(PackedVertex)) == 0;
+		printf("%10s %10.3f %12.3f %12.1f %9.2fx%s\n",
+			(variant == 0) ? "reference" : "encode", ms, ms * 1e6 / vertexCount,
+			double(vertexCount) * sizeof(Vertex) / (ms * 1e3), (ms > 0.0) ? baseline / ms : 0.0, match ? "" : "  MISMATCH");
+		result |= match ? 0 : 1;
+	}
+
+	// half a step of 1/32767 of the half size is the bound of the position error per axis
+	VertexQuantizationError error = VertexFormat::MeasureError(vertices.data(), packed.data(), vertexCount, quantization);
+	float extent = std::max(std::max(boundsMax[0] - boundsMin[0], boundsMax[1] - boundsMin[1]), boundsMax[2] - boundsMin[2]);
+	printf("position error: max %.6f rms %.6f (%.2e of the extent), color error: max %.6f (out of range alpha clamped)\n",
+		error.MaxPosition, error.RmsPosition, error.MaxPosition / extent, error.MaxColor);
+
+	return result;
+}
@@ -3,47 +3,44 @@
 //--------------------------------------------------------------------------------------------------------
 // Includes
 //--------------------------------------------------------------------------------------------------------
+#if defined(_WIN32)
 #include <Windows.h>
+#endif
 #include <cstdint>
-#include <d3d12.h>
-#include <dxgi1_4.h>
-#include <wrl/client.h>
-#include <d3dcompiler.h>
-#include <DirectXMath.h>
+#include <GfxDevice.h>
+#include <AssetStreamer.h>
+#include <CommandListPool.h>
+#include <DeferredReleaseQueue.h>
+#include <DescriptorAllocator.h>
+#include <DrawQueue.h>
+#include <FrameTimeline.h>
+#include <FrustumCuller.h>
+#include <GpuMemoryAllocator.h>
+#include <GpuProfiler.h>
+#include <PipelineCache.h>
+#include <RenderGraph.h>
+#include <ResourceStateTracker.h>
+#include <ShaderStore.h>
+#include <ShaderTypes.h>
+#include <TransformSystem.h>
+#include <UploadQueue.h>
+#include <UploadRing.h>
+#include <VertexFormat.h>
+#include <WorkerPool.h>
+#include <XMath.h>
+#include <functional>
+#include <string>
+#include <vector>
 
 
-//--------------------------------------------------------------------------------------------------------
-// Linker
-//--------------------------------------------------------------------------------------------------------
-#pragma comment(lib, "d3d12.lib")
-#pragma comment(lib, "dxgi.lib")
-#pragma comment(lib, "d3dcompiler.lib")
-
-
-//--------------------------------------------------------------------------------------------------------
-// Type Alias
-//--------------------------------------------------------------------------------------------------------
-template<typename T> using ComPtr = Microsoft::WRL::ComPtr<T>;
-
-
-//////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Transform structure
-//////////////////////////////////////////////////////////////////////////////////////////////////////////
-struct alignas(256) Transform
-{
-	DirectX::XMMATRIX World; // world matrix
-	DirectX::XMMATRIX View; // view matrix
-	DirectX::XMMATRIX Proj; // projection matrix
-};
-
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 // ConstantBufferView structure
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename T> struct ConstantBufferView
 {
-	D3D12_CONSTANT_BUFFER_VIEW_DESC Desc; // configuration of constant buffer
-	D3D12_CPU_DESCRIPTOR_HANDLE HandleCPU; // CPU descriptor handle
-	D3D12_GPU_DESCRIPTOR_HANDLE HandleGPU; // GPU descriptor handle
+	GfxConstantBufferViewDesc Desc; // configuration of constant buffer
+	GfxCpuDescriptorHandle HandleCPU; // CPU descriptor handle
+	GfxGpuDescriptorHandle HandleGPU; // GPU descriptor handle
 	T* pBuffer; // pointer to the start of buffer
 };
 
@@ -62,50 +59,128 @@ public:
 	//====================================================================================================
 	// Public variables
 	//====================================================================================================
-	/* NOTHING */
+	using FrameFunc = std::function<void(uint32_t frame)>;
 
 	//====================================================================================================
 	// Public methods
 	//====================================================================================================
-	App(uint32_t width, uint32_t height);
+	// quads are laid out on a grid, instancing draws all of them with a single call, pMeshPath replaces the
+	// quad geometry with a MeshFile (float or packed vertices)
+	App(uint32_t width, uint32_t height, GfxBackend backend = GetDefaultGfxBackend(), uint32_t quadCount = 1, bool instancing = true, const char* pMeshPath = nullptr, uint32_t framesInFlight = 2);
 	virtual ~App();
-	void Run();
+
+	// false when the App could not be initialized (no frame has run)
+	bool Run();
+	bool Run(uint32_t frameCount);
+
+	// onFrameEnd is called after every frame (frame timings and counters of benchmarks)
+	bool Run(uint32_t frameCount, const FrameFunc& onFrameEnd);
+
+	// ends Run() after the current frame (callbacks of benchmarks that stop on a condition)
+	void Quit() { m_Quit = true; }
+
+	// pipeline cache totals of the last run
+	PipelineCacheStats GetPipelineStats() const { return m_PipelineCache.GetStats(); }
+	FrameTimelineStats GetFrameStats() const { return m_Timeline.GetStats(); }
+	GpuProfilerStats GetGpuStats() const { return m_GpuProfiler.GetStats(); }
+	ResourceBarrierStats GetBarrierStats() const { return m_CmdLists.GetBarrierStats(); }
+	RenderGraphStats GetGraphStats() const { return m_RenderGraph.GetStats(); }
+	UploadStats GetUploadStats() const { return m_Uploads.GetStats(); }
+	StreamStats GetStreamStats() const { return m_Streamer.GetStats(); }
+	const LinearRingStats& GetUploadRingStats() const { return m_UploadRing.GetStats(); }
+	DescriptorPoolStats GetDescriptorStats() const { return m_DescriptorStats; }
+	uint32_t GetFramesInFlight() const { return m_FramesInFlight; }
+
+	// scene and barriers of the latest frame
+	uint32_t GetDrawCount() const { return m_DrawCount; }
+	uint32_t GetVisibleCount() const { return m_VisibleCount; }
+	uint32_t GetIndexCount() const { return m_IndexCount; }
 
 private:
 	//====================================================================================================
 	// Private variables
 	//====================================================================================================
-	static const uint32_t FrameCount = 2; // number of frame buffer
-
+	static const uint32_t BackBufferCount = 2; // number of frame buffer
+	static const uint64_t UploadRingSize = 2 * 1024 * 1024; // size of upload ring for constant data (per-quad data is added)
+	static const uint32_t MaxRecordWorkers = 8; // upper limit of threads recording command lists
+	static const uint32_t MinDrawsPerList = 64; // draws below which another command list isn't worth it
+	static const uint32_t PipelineCompileThreads = 1; // background threads compiling pipelines
+	static const uint32_t ShaderPollInterval = 30; // frames between checks of the watched shader sources
+	static const uint32_t InstanceElementCount = 5; // rows of the world matrix and color of InstanceData
+	static const uint32_t StreamThreads = 2; // I/O threads reading streamed assets
+	static const uint64_t StreamBudget = 4 * 1024 * 1024; // bytes of streamed assets uploaded per frame
+
+#if defined(_WIN32)
 	HINSTANCE m_hInst; // Instance handle
 	HWND m_hWnd; // Window handle
+#endif
 	uint32_t m_Width; // Width of the window
 	uint32_t m_Height; // Height of the window
-
-	ComPtr<ID3D12Device> m_pDevice; // device
-	ComPtr<ID3D12CommandQueue> m_pQueue; // command queue
-	ComPtr<IDXGISwapChain3> m_pSwapChain; // swap chain
-	ComPtr<ID3D12Resource> m_pColorBuffer[FrameCount]; // color buffer
-	ComPtr<ID3D12CommandAllocator> m_pCmdAllocator[FrameCount]; // command allocator
-	ComPtr<ID3D12GraphicsCommandList> m_pCmdList; // command list
-	ComPtr<ID3D12DescriptorHeap> m_pHeapRTV; // descriptor heap for render target view
-	ComPtr<ID3D12Fence> m_pFence; // fence
-	ComPtr<ID3D12DescriptorHeap> m_pHeapCBV; // descriptor heap for constant buffer view
-	ComPtr<ID3D12Resource> m_pVB; // vertex buffer
-	ComPtr<ID3D12Resource> m_pIB; // index buffer
-	ComPtr<ID3D12Resource> m_pCB[FrameCount]; // constant buffer
-	ComPtr<ID3D12RootSignature> m_pRootSignature; // root signature
-	ComPtr<ID3D12PipelineState> m_pPSO; // pipeline state object
-
-	HANDLE m_FenceEvent; // fence event
-	uint64_t m_FenceCounter[FrameCount]; // fence counter
-	uint32_t m_FrameIndex; // index of frame
-	D3D12_CPU_DESCRIPTOR_HANDLE m_HandleRTV[FrameCount]; // CPU descriptor for render target view
-	D3D12_VERTEX_BUFFER_VIEW m_VBV; // vertex buffer view
-	D3D12_INDEX_BUFFER_VIEW m_IBV; // index buffer view
-	D3D12_VIEWPORT m_Viewport; // viewport
-	D3D12_RECT m_Scissor; // scissor rectangle
-	ConstantBufferView<Transform> m_CBV[FrameCount]; // constant buffer view
+	GfxBackend m_Backend; // backend of the device
+	uint32_t m_QuadCount; // number of quads
+	bool m_Instancing; // whether the quads are drawn instanced
+	bool m_Quit; // set by Quit(), ends the frame loop
+	uint32_t m_FramesInFlight; // frames the CPU may run ahead of the GPU
+	std::string m_MeshPath; // mesh file drawn instead of the quad (empty for the built-in quad)
+
+	GfxPtr<GfxDevice> m_pDevice; // device
+	GfxPtr<GfxCommandQueue> m_pQueue; // command queue
+	GfxPtr<GfxSwapChain> m_pSwapChain; // swap chain
+	GfxResource* m_pColorBuffer[BackBufferCount]; // color buffer (owned by swap chain)
+	WorkerPool m_Workers; // threads recording command lists
+	ResourceStates m_ResourceStates; // states of the resources between frames (back buffers)
+	CommandListPool m_CmdLists; // command lists and their per-frame allocators
+	RenderGraph m_RenderGraph; // passes of the frame, recorded into m_CmdLists
+	DescriptorPool m_PoolRTV; // descriptors for render target view
+	DescriptorPoolStats m_DescriptorStats; // counters of m_PoolRTV at the end of the last run
+	FrameTimeline m_Timeline; // fence values of the frames in flight
+	DeferredReleaseQueue m_ReleaseQueue; // objects freed once the GPU is past the last frame using them
+	GpuProfiler m_GpuProfiler; // timestamps around the command lists (invalid without timestamp queries)
+	GpuMemoryAllocator m_GpuMemory; // heaps the buffers are sub-allocated from
+	UploadQueue m_Uploads; // copies into default heap buffers on the copy queue
+	AssetStreamer m_Streamer; // assets read and decoded on I/O threads while frames run
+	uint32_t m_MeshHandle; // streamed mesh until its first frame on screen (InvalidHandle afterwards)
+	GpuAllocation m_VB; // vertex buffer
+	GpuAllocation m_IB; // index buffer
+	GfxPtr<GfxRootSignature> m_pRootSignature; // root signature
+	uint64_t m_RootSignatureKey; // key of the root signature desc (part of the pipeline keys)
+	GfxInputElementDesc m_InputElements[VertexFormat::MaxElements + InstanceElementCount]; // vertex layout, then the instance layout
+	uint32_t m_VertexElementCount; // elements of the vertex layout in m_InputElements
+	ShaderStore m_Shaders; // compiled shaders (packed file or loose files, reloaded when sources change)
+	uint32_t m_ShaderGeneration; // generation of m_Shaders the pipelines were requested with
+	uint32_t m_ShaderPollFrames; // frames since the watched sources were checked
+	PipelineCache m_PipelineCache; // pipeline state objects, compiled in the background
+	PipelineHandle m_PSO; // pipeline state object
+	PipelineHandle m_PSOInstanced; // pipeline state object of the instanced variant
+	GfxPipelineState* m_pReadyPSO; // latest ready base pipeline (stands in while a reloaded one compiles)
+	GfxPipelineState* m_pReadyPSOInstanced; // latest ready instanced pipeline
+	GfxPipelineState* m_pDrawPSO; // pipeline state object of this frame
+	bool m_DrawInstanced; // whether this frame draws instanced (not until the instanced variant is compiled)
+
+	uint32_t m_BackBufferIndex; // index of the back buffer drawn to
+	uint32_t m_FrameSlot; // slot of the per-frame resources of this frame
+	DescriptorHandle m_HandleRTV[BackBufferCount]; // CPU descriptor for render target view
+	GfxVertexBufferView m_VBV; // vertex buffer view
+	GfxIndexBufferView m_IBV; // index buffer view
+	uint32_t m_IndexCount; // indices drawn per quad
+	MeshVertexLayout m_VertexLayout; // layout of the vertex buffer
+	VertexQuantization m_Quantization; // dequantization of the positions (written to every Transform)
+	float m_MeshRadius; // bounding sphere radius of the geometry around its origin
+	GfxVertexBufferView m_InstanceVBV; // per-instance data of the current frame
+	GfxViewport m_Viewport; // viewport
+	GfxRect m_Scissor; // scissor rectangle
+	ConstantBufferView<Transform> m_CBV[FrameTimeline::MaxFramesInFlight]; // constant buffer view
+	UploadRing m_UploadRing; // per-frame upload memory for constant data
+	TransformSystem m_Transforms; // quad transforms (SoA)
+	std::vector<DirectX::XMFLOAT4> m_QuadColors; // color of each quad
+	std::vector<float> m_QuadRadius; // bounding sphere radius of each quad (centered on its position)
+	FrustumCuller m_Culler; // visibility test of the quads
+	std::vector<uint32_t> m_VisibleQuads; // indices of the quads drawn this frame
+	uint32_t m_VisibleCount; // number of valid entries in m_VisibleQuads
+	DrawQueue m_DrawQueue; // visible quads sorted by pass, pipeline, material and depth
+	uint32_t m_DrawCount; // draw calls recorded this frame
+	DirectX::XMMATRIX m_View; // view matrix
+	DirectX::XMMATRIX m_Proj; // projection matrix
 	float m_RotateAngle; // angle of rotation
 
 	//====================================================================================================
@@ -113,16 +188,27 @@ private:
 	//====================================================================================================
 	bool InitApp();
 	void TermApp();
+#if defined(_WIN32)
 	bool InitWnd();
 	void TermWnd();
-	void MainLoop();
+#endif
+	void MainLoop(uint32_t frameCount, const FrameFunc& onFrameEnd);
 	bool InitD3D();
 	void TermD3D();
 	void Render();
+	bool AllocateUpload(uint64_t size, uint64_t alignment, UploadAllocation& allocation);
+	bool WriteTransforms();
+	void RecordCommands(GfxCommandList* pCmdList, uint32_t part, uint32_t partCount);
 	void WaitGPU();
 	void Present(uint32_t interval);
+	bool LoadShaders();
+	bool RequestPipelines();
+	bool CreateGeometry(const void* pVertices, uint64_t vertexSize, uint32_t vertexStride, const void* pIndices, uint32_t indexCount, GfxFormat indexFormat);
+	void OnAssetStreamed(StreamedAsset& asset);
 	bool OnInit();
 	void OnTerm();
 
+#if defined(_WIN32)
 	static LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wp, LPARAM lp);
+#endif
 };
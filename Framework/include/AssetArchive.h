@@ -0,0 +1,144 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <MappedFile.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------------
+// Forward Declarations
+//--------------------------------------------------------------------------------------------------------
+class WorkerPool;
+
+
+//--------------------------------------------------------------------------------------------------------
+// Constant Values
+//--------------------------------------------------------------------------------------------------------
+constexpr uint32_t AssetArchiveMagic = 0x4B415041u; // "APAK" read as little endian
+constexpr uint32_t AssetArchiveVersion = 1; // bumped whenever the layout below changes
+constexpr uint32_t AssetArchiveChunkSize = 64 * 1024; // decompressed size of every chunk but the last of an entry
+constexpr uint64_t AssetArchiveAlignment = 256; // placement of uncompressed entries (and of the tables) in the file
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetArchiveEntry structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct AssetArchiveEntry
+{
+	uint64_t PathKey; // AssetArchive::ComputePathKey() of the path (the table is sorted by it)
+	uint64_t Size; // of the contents in bytes
+	uint64_t Offset; // of the contents (uncompressed) or of the first chunk from the start of the file
+	uint32_t FirstChunk; // index into the chunk table
+	uint32_t ChunkCount; // 0 when the contents are stored uncompressed
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetArchiveChunk structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct AssetArchiveChunk
+{
+	uint64_t Offset; // of the LZ4 block from the start of the file
+	uint32_t StoredSize; // of the block, equal to Size when the chunk didn't compress and is stored as is
+	uint32_t Size; // decompressed size (AssetArchiveChunkSize but for the last chunk of an entry)
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetArchiveHeader structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct AssetArchiveHeader
+{
+	uint32_t Magic; // AssetArchiveMagic
+	uint32_t Version; // AssetArchiveVersion
+	uint32_t EntryCount; // number of assets
+	uint32_t ChunkCount; // number of compressed chunks of all assets
+	uint64_t FileSize; // size of the whole file
+	uint64_t EntriesOffset; // of the AssetArchiveEntry table
+	uint64_t ChunksOffset; // of the AssetArchiveChunk table
+	uint64_t DataOffset; // of the first chunk or uncompressed entry (end of the tables)
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetArchiveSource structure (input of AssetArchive::Write)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct AssetArchiveSource
+{
+	const char* pPath; // path the asset is looked up by, e.g. "meshes/rock.mesh"
+	const void* pData; // contents
+	size_t Size; // of the contents in bytes
+	bool Compress; // false keeps the contents uncompressed (zero-copy reads)
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetArchive class
+//
+// Assets packed into one file which is mapped on open. The tables sit right behind the header, so a lookup
+// is a binary search over the hashed paths in the first pages of the mapping. Contents are either stored
+// uncompressed and aligned, so GetData() hands out a pointer into the mapping without a read or a copy, or
+// split into chunks of 64 KB compressed as LZ4 blocks, which Read() decompresses independently of each
+// other (on the workers of a pool, if one is given). Entries that don't shrink by an eighth are stored
+// uncompressed. Read() is const and may be called from any number of threads.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class AssetArchive
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	/* NOTHING */
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	AssetArchive();
+
+	// map and validate an archive
+	bool Open(const char* path);
+	void Close();
+
+	// entry of the path (nullptr if not in the archive)
+	const AssetArchiveEntry* Find(uint64_t pathKey) const;
+	const AssetArchiveEntry* Find(const char* path) const { return Find(ComputePathKey(path)); }
+
+	// contents in the mapping, nullptr for compressed entries (valid until Close())
+	const uint8_t* GetData(const AssetArchiveEntry& entry) const;
+
+	// contents into pDest (entry.Size bytes), chunks are spread over the workers of pPool, false on corrupt data
+	bool Read(const AssetArchiveEntry& entry, void* pDest, WorkerPool* pPool = nullptr) const;
+	bool Read(const AssetArchiveEntry& entry, std::vector<uint8_t>& data, WorkerPool* pPool = nullptr) const;
+
+	bool IsOpen() const { return m_pHeader != nullptr; }
+	uint32_t GetEntryCount() const { return (m_pHeader != nullptr) ? m_pHeader->EntryCount : 0; }
+	uint32_t GetChunkCount() const { return (m_pHeader != nullptr) ? m_pHeader->ChunkCount : 0; }
+	uint64_t GetFileSize() const { return m_File.GetSize(); }
+
+	// FNV-1a of the path, '\\' counts as '/'
+	static uint64_t ComputePathKey(const char* path);
+
+	// write an archive, chunks are compressed on the workers of pPool (offline tools, not meant for the frame loop)
+	static bool Write(const char* path, const AssetArchiveSource* pSources, uint32_t count, WorkerPool* pPool = nullptr);
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	MappedFile m_File; // archive
+	const AssetArchiveHeader* m_pHeader; // header in the mapping (nullptr if not open)
+	const AssetArchiveEntry* m_pEntries; // entry table in the mapping
+	const AssetArchiveChunk* m_pChunks; // chunk table in the mapping
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	bool Validate() const;
+	bool ReadChunk(const AssetArchiveChunk& chunk, uint8_t* pDest) const;
+};
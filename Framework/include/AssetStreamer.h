@@ -0,0 +1,227 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <LockFreeQueue.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------------
+// Forward Declarations
+//--------------------------------------------------------------------------------------------------------
+class AssetArchive;
+
+
+//--------------------------------------------------------------------------------------------------------
+// Enumerations
+//--------------------------------------------------------------------------------------------------------
+enum class AssetType : uint32_t
+{
+	Mesh = 0, // MeshFile, validated before delivery
+	Shader, // compiled shader blob
+	Texture, // texels in the layout of the owner
+	Count
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// StreamedAsset structure (handed to the render thread by AssetStreamer::Update)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct StreamedAsset
+{
+	uint32_t Handle; // returned by Request(), valid until Release()
+	AssetType Type; // kind of asset
+	uint64_t UserData; // value passed to Request()
+	bool Succeeded; // false when the file couldn't be read or the decoder rejected it (Data is empty)
+	std::vector<uint8_t> Data; // decoded contents (only valid during the delivery)
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// StreamStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct StreamStats
+{
+	uint64_t RequestCount; // Request() calls
+	uint64_t DeliveredCount; // assets handed to the render thread
+	uint64_t DeliveredBytes; // decoded bytes handed to the render thread
+	uint64_t FailedCount; // unreadable files or data the decoder rejected
+	uint64_t CancelledCount; // released before they were delivered
+	uint64_t DeferredCount; // deliveries pushed to a later frame by the budget (once per frame)
+	uint32_t MaxQueued; // most requests waiting for an I/O thread at once
+	double ReadMs; // time the I/O threads spent reading
+	double DecodeMs; // time the I/O threads spent decoding
+	double DeliverMs; // time from Request() to delivery, summed over the delivered assets
+	uint64_t VisibleCount; // assets marked visible
+	double VisibleMs; // time from Request() to MarkVisible(), summed over the visible assets
+	double MaxVisibleMs; // slowest of these
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetStreamer class
+//
+// Loads assets while frames keep running. Request() queues a file with a priority (higher first, see
+// ComputePriority) that SetPriority() may change until an I/O thread picks it. The I/O threads read the
+// whole file, run the decoder of its type and push the result into a lock-free completion queue. Update()
+// on the render thread drains that queue and hands the results over by priority until the bytes of the
+// frame exceed the budget; at least one asset is delivered per frame so that large ones get through, the
+// rest waits for the next frame. Release() cancels a request or ends the life of a delivered handle, and
+// MarkVisible() records how long the asset took from Request() to its first frame on screen. Everything
+// but the decoders belongs to the render thread.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class AssetStreamer
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint32_t InvalidHandle = UINT32_MAX; // handle of failed requests
+	static const uint32_t DefaultCompletionCapacity = 256; // results the I/O threads may get ahead of Update()
+
+	// turns the file contents into what the render thread uploads, false rejects the asset (I/O threads)
+	using DecodeFunc = std::function<bool(std::vector<uint8_t>& data)>;
+
+	// receives every asset delivered by Update()
+	using DeliverFunc = std::function<void(StreamedAsset& asset)>;
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	AssetStreamer();
+	~AssetStreamer();
+
+	// ioThreadCount threads read and decode, meshes are validated by default and the other types pass through
+	bool Init(uint32_t ioThreadCount, uint32_t completionCapacity = DefaultCompletionCapacity);
+
+	// waits for the reads in flight, undelivered assets are dropped
+	void Term();
+
+	// replaces the decoder of a type (before the first request of that type)
+	void SetDecoder(AssetType type, const DecodeFunc& decode);
+
+	// paths found in the archive are read from it instead of from loose files (before the first request)
+	void SetArchive(const AssetArchive* pArchive) { m_pArchive = pArchive; }
+
+	// queue a file, returns InvalidHandle when the streamer isn't initialized
+	uint32_t Request(const char* path, AssetType type, float priority, uint64_t userData = 0);
+
+	// takes effect while the request waits for an I/O thread
+	void SetPriority(uint32_t handle, float priority);
+
+	// cancels a pending request, frees a delivered one
+	void Release(uint32_t handle);
+
+	// first frame the asset is drawn in (once per handle)
+	void MarkVisible(uint32_t handle);
+
+	// deliver completed assets by priority until budgetBytes is exceeded, returns the number delivered
+	uint32_t Update(uint64_t budgetBytes, const DeliverFunc& deliver);
+
+	// requests neither delivered nor released
+	uint32_t GetPendingCount() const { return m_PendingCount; }
+	const StreamStats& GetStats() const { return m_Stats; }
+
+	// time from Request() to MarkVisible() of every visible asset (percentiles of benchmarks)
+	const std::vector<float>& GetVisibleLatencies() const { return m_VisibleLatencies; }
+
+	// visible assets come before every invisible one, nearer ones first within each group
+	static float ComputePriority(float distance, bool visible);
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	using Clock = std::chrono::steady_clock;
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// RequestState enumeration
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	enum class RequestState : uint32_t
+	{
+		Free = 0, // slot unused
+		Queued, // waiting for an I/O thread
+		Loading, // read or decoded by an I/O thread, or waiting for delivery
+		Delivered, // handed to the render thread
+		Cancelled, // released while loading, freed when its completion arrives
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// RequestSlot structure - state of a handle
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct RequestSlot
+	{
+		std::string Path; // file to read
+		AssetType Type; // decoder to run
+		RequestState State; // progress
+		float Priority; // higher is picked first
+		uint64_t Sequence; // order of requests of the same priority
+		uint64_t UserData; // value passed to Request()
+		Clock::time_point RequestTime; // Request() call
+		bool Visible; // whether MarkVisible() was called
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// QueueKey structure - order of the queued requests
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct QueueKey
+	{
+		float Priority; // higher first
+		uint64_t Sequence; // then older first
+		uint32_t Handle; // slot of the request
+
+		bool operator < (const QueueKey& other) const
+		{
+			return (Priority != other.Priority) ? Priority > other.Priority : Sequence < other.Sequence;
+		}
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Completion structure - result of an I/O thread
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Completion
+	{
+		uint32_t Handle; // slot of the request
+		float Priority; // of the request when Update() sorts the results
+		uint64_t Sequence; // of the request
+		bool Succeeded; // whether the file was read and decoded
+		double ReadMs; // time reading
+		double DecodeMs; // time decoding
+		std::vector<uint8_t> Data; // decoded contents
+	};
+
+	std::vector<std::thread> m_Threads; // I/O threads
+	std::mutex m_Mutex; // guards m_Requests, m_Queue, m_FreeHandles and m_Quit
+	std::condition_variable m_WakeCondition; // signaled on new requests or quit
+	std::vector<RequestSlot> m_Requests; // slots indexed by handle
+	std::vector<uint32_t> m_FreeHandles; // unused slots
+	std::set<QueueKey> m_Queue; // requests waiting for an I/O thread, most urgent first
+	uint64_t m_NextSequence; // sequence of the next request
+	bool m_Quit; // whether I/O threads should exit
+	DecodeFunc m_Decoders[static_cast<uint32_t>(AssetType::Count)]; // per type, empty passes the data through
+	const AssetArchive* m_pArchive; // searched before loose files (nullptr for loose files only)
+	LockFreeQueue<Completion*> m_Completions; // results on their way to the render thread
+	std::vector<Completion*> m_Ready; // results Update() took from m_Completions but didn't deliver yet
+	uint32_t m_PendingCount; // requests neither delivered nor released
+	StreamStats m_Stats; // totals since Init()
+	std::vector<float> m_VisibleLatencies; // milliseconds from Request() to MarkVisible()
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	void ThreadMain(uint32_t threadIndex);
+	void FreeHandle(uint32_t handle);
+};
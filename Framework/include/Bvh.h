@@ -0,0 +1,116 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <FrustumCuller.h>
+#include <XMath.h>
+#include <cstdint>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// BvhNode structure (32 bytes, two per cache line)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct BvhNode
+{
+	float Min[3]; // lower corner of the bounds
+	uint32_t First; // first child (inner node) or first entry of Bvh::GetObjectIndices() (leaf)
+	float Max[3]; // upper corner of the bounds
+	uint32_t Count; // number of objects (0 for inner nodes, whose children are First and First + 1)
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// BvhStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct BvhStats
+{
+	uint32_t NodeCount; // inner nodes and leaves
+	uint32_t LeafCount; // leaves
+	uint32_t MaxDepth; // longest path from the root (root is depth 0)
+	uint32_t MaxLeafObjects; // largest leaf
+	float SahCost; // surface area heuristic cost relative to testing every object
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// BvhHit structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct BvhHit
+{
+	uint32_t Object; // index of the object
+	float Distance; // ray parameter of the entry point (0 when the origin is inside)
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Bvh class
+//
+// Binary AABB tree over object bounds, built top down with a 16-bin SAH and stored as a flat node array
+// whose children are always allocated in pairs after their parent. Every object of a subtree lies in one
+// contiguous range of the object index list, and the leaf boxes are copied in that order so that leaf
+// tests read memory linearly. Refit() keeps the topology and only recomputes bounds, which is enough while
+// objects move moderately; rebuild when the query cost degrades.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class Bvh
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint32_t BinCount = 16; // SAH candidates per axis
+	static const uint32_t MaxLeafObjects = 8; // leaves are split at least down to this size
+	static const uint32_t MaxDepth = 64; // traversal stack depth (deeper subtrees become leaves)
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	Bvh();
+
+	bool Build(const BoxBounds& bounds, uint32_t count);
+	void Clear();
+
+	// update all bounds after objects moved (same objects as Build())
+	void Refit(const BoxBounds& bounds);
+
+	// hierarchical frustum test, pVisible needs room for GetObjectCount() indices (order follows the tree)
+	uint32_t CullFrustum(const Frustum& frustum, uint32_t* pVisible) const;
+
+	// nearest object box hit by origin + t * direction for 0 <= t <= maxDistance
+	bool Raycast(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& direction, float maxDistance, BvhHit& hit) const;
+
+	// objects whose box contains the point, returns the total number even if it exceeds maxResults
+	uint32_t QueryPoint(const DirectX::XMFLOAT3& point, uint32_t* pResults, uint32_t maxResults) const;
+
+	uint32_t GetObjectCount() const { return static_cast<uint32_t>(m_Indices.size()); }
+	const std::vector<BvhNode>& GetNodes() const { return m_Nodes; }
+	const std::vector<uint32_t>& GetObjectIndices() const { return m_Indices; }
+	BvhStats ComputeStats() const;
+
+private:
+	//====================================================================================================
+	// Private structures
+	//====================================================================================================
+	struct Box
+	{
+		float Center[3]; // center (same values as the BoxBounds streams)
+		float Extent[3]; // half size
+	};
+
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	std::vector<BvhNode> m_Nodes; // node 0 is the root
+	std::vector<uint32_t> m_Indices; // object indices in leaf order
+	std::vector<Box> m_Boxes; // object boxes in leaf order
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	void LoadBoxes(const BoxBounds& bounds);
+	void RefitNodes();
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <ResourceStateTracker.h>
+#include <WorkerPool.h>
+#include <functional>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// CommandListPool class
+//
+// Command lists recorded in parallel on a WorkerPool. Every list owns one allocator per frame in flight,
+// so no allocator is shared between two threads or between two frames. The lists are submitted in index
+// order with one ExecuteCommandLists() call, whichever worker recorded them.
+// With ResourceStates every list gets a ResourceStateTracker: barriers still queued at the end of a list
+// are flushed before it is closed, and at submission the first uses of the lists after the first are
+// resolved against the committed states, the barriers this takes are recorded into a fix-up list of the
+// same frame that goes right in front of the list.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class CommandListPool
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	using RecordFunc = std::function<void(GfxCommandList* pCmdList, uint32_t listIndex)>;
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	CommandListPool();
+	~CommandListPool();
+
+	// pStates enables the state trackers (it has to outlive the pool)
+	bool Init(GfxDevice* pDevice, GfxCommandListType type, uint32_t frameCount, uint32_t listCount, ResourceStates* pStates = nullptr);
+	void Term();
+
+	// reset the allocators of frameIndex and record listCount lists in parallel (the GPU must be done
+	// with the previous use of frameIndex)
+	void Record(WorkerPool& workers, uint32_t frameIndex, uint32_t listCount, const RecordFunc& func);
+
+	// submit the lists of the last Record() in index order
+	void Execute(GfxCommandQueue* pQueue);
+
+	uint32_t GetMaxListCount() const { return static_cast<uint32_t>(m_pCmdLists.size()); }
+	uint32_t GetRecordedListCount() const { return m_RecordedCount; }
+
+	// tracker of a list while it is recorded (nullptr without ResourceStates)
+	ResourceStateTracker* GetStateTracker(uint32_t listIndex) { return m_pStates != nullptr ? &m_Trackers[listIndex] : nullptr; }
+
+	// barriers of the lists of the last Execute()
+	const ResourceBarrierStats& GetBarrierStats() const { return m_BarrierStats; }
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	uint32_t m_FrameCount; // number of frames in flight
+	std::vector<GfxPtr<GfxCommandAllocator>> m_pAllocators; // allocators (frame major)
+	std::vector<GfxPtr<GfxCommandList>> m_pCmdLists; // command lists
+	std::vector<GfxCommandList*> m_pRecorded; // lists of the last Record() in submission order
+	uint32_t m_RecordedCount; // number of lists of the last Record()
+	uint32_t m_RecordedFrame; // frame index of the last Record()
+	ResourceStates* m_pStates; // committed resource states (nullptr without state tracking)
+	std::vector<ResourceStateTracker> m_Trackers; // state tracker of each list
+	std::vector<GfxPtr<GfxCommandAllocator>> m_pFixupAllocators; // allocators of the fix-up lists (frame major)
+	std::vector<GfxPtr<GfxCommandList>> m_pFixupLists; // barriers resolved at submission, one per list
+	std::vector<GfxCommandList*> m_pSubmit; // fix-up and recorded lists of Execute()
+	std::vector<GfxResourceBarrier> m_Fixups; // barriers resolved for the list being submitted
+	ResourceBarrierStats m_BarrierStats; // barriers of the last Execute()
+};
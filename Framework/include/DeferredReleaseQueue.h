@@ -0,0 +1,96 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <DescriptorAllocator.h>
+#include <deque>
+#include <functional>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DeferredReleaseStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct DeferredReleaseStats
+{
+	uint64_t ReleaseCount; // items queued
+	uint64_t FreeCount; // items freed
+	uint64_t PendingCount; // items waiting for the GPU
+	uint64_t PendingBytes; // bytes held by the waiting items (as reported by the callers)
+	uint64_t PeakPendingBytes; // highest PendingBytes
+	uint64_t FreedBytes; // bytes freed
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DeferredReleaseQueue class
+//
+// Objects, descriptors and other ranges the GPU may still read are queued with the fence value of the last
+// frame that used them and freed by Collect() once the fence has passed it, so nothing has to wait for the
+// GPU to go idle. Values are expected in submission order (the frame values of FrameTimeline); the queue
+// belongs to one thread.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class DeferredReleaseQueue
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	/* NOTHING */
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	DeferredReleaseQueue();
+	~DeferredReleaseQueue();
+
+	// frees everything at once, the GPU has to be idle
+	void Term();
+
+	// destroy the object (any GfxPtr converts) once the fence reaches fenceValue, size is only counted
+	void Release(GfxPtr<GfxObject> pObject, uint64_t fenceValue, uint64_t size = 0);
+
+	// return the descriptor to its pool once the fence reaches fenceValue (handle is invalidated)
+	void Release(DescriptorPool* pPool, DescriptorHandle& handle, uint64_t fenceValue);
+
+	// call free once the fence reaches fenceValue (upload ranges and other sub-allocations)
+	void Release(std::function<void()> free, uint64_t fenceValue, uint64_t size = 0);
+
+	// free everything queued with a value less than or equal to completedValue, returns the number freed
+	uint32_t Collect(uint64_t completedValue);
+
+	uint32_t GetPendingCount() const { return static_cast<uint32_t>(m_Entries.size()); }
+	uint64_t GetPendingBytes() const { return m_Stats.PendingBytes; }
+
+	// totals since construction
+	const DeferredReleaseStats& GetStats() const { return m_Stats; }
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	struct Entry
+	{
+		uint64_t FenceValue; // value after which the GPU no longer reads the item
+		uint64_t Size; // bytes held
+		GfxPtr<GfxObject> pObject; // object to destroy (nullptr if none)
+		DescriptorPool* pPool; // pool of Descriptor (nullptr if none)
+		DescriptorHandle Descriptor; // descriptor to return
+		std::function<void()> Free; // callback to run (empty if none)
+	};
+
+	std::deque<Entry> m_Entries; // items waiting for the GPU in release order
+	DeferredReleaseStats m_Stats; // totals since construction
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	void Push(Entry&& entry);
+	void FreeEntry(Entry& entry);
+};
@@ -0,0 +1,161 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <LinearRing.h>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DescriptorHandle structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct DescriptorHandle
+{
+	static const uint32_t InvalidIndex = 0xffffffff;
+
+	GfxCpuDescriptorHandle CPU; // CPU handle of the descriptor
+	uint32_t Index; // slot in the pool (InvalidIndex when not allocated)
+
+	bool IsValid() const { return Index != InvalidIndex; }
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DescriptorPoolStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct DescriptorPoolStats
+{
+	uint32_t Allocated; // descriptors in use
+	uint32_t PeakAllocated; // most descriptors in use at once
+	uint32_t Capacity; // descriptors in all pages
+	uint32_t PageCount; // number of heaps
+	float Fragmentation; // free slots below the highest used slot of their page over all free slots (0 = compact)
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DescriptorPool class
+//
+// Persistent CPU-only descriptors of one heap type. Heaps are added as fixed-size pages on demand and
+// freed slots are recycled through a free list, so Allocate and Free are O(1). Descriptors which shaders
+// read are copied into a DescriptorRing before drawing.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class DescriptorPool
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint32_t DefaultPageSize = 256; // descriptors per heap page
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	DescriptorPool();
+	~DescriptorPool();
+
+	bool Init(GfxDevice* pDevice, GfxDescriptorHeapType type, uint32_t pageSize = DefaultPageSize);
+	void Term();
+
+	// returns false only when a new page could not be created
+	bool Allocate(DescriptorHandle& handle);
+
+	// return the slot to the free list and invalidate the handle
+	void Free(DescriptorHandle& handle);
+
+	GfxDescriptorHeapType GetType() const { return m_Type; }
+	uint32_t GetIncrementSize() const { return m_IncrementSize; }
+	DescriptorPoolStats GetStats() const;
+
+private:
+	//====================================================================================================
+	// Private structures
+	//====================================================================================================
+	struct Page
+	{
+		GfxPtr<GfxDescriptorHeap> pHeap; // CPU-only heap
+		GfxCpuDescriptorHandle Start; // CPU handle of the first descriptor
+		uint32_t UsedCount; // descriptors in use
+	};
+
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	GfxDevice* m_pDevice; // device creating the pages
+	GfxDescriptorHeapType m_Type; // type of descriptors
+	uint32_t m_PageSize; // descriptors per page
+	uint32_t m_IncrementSize; // distance between two descriptors
+	std::vector<Page> m_Pages; // heap pages
+	std::vector<uint32_t> m_FreeList; // free slot indices (stack, lowest index on top)
+	uint32_t m_Allocated; // descriptors in use
+	uint32_t m_PeakAllocated; // most descriptors in use at once
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	bool AddPage();
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DescriptorRing class
+//
+// Per-frame staging area in one shader-visible heap. Descriptor tables are allocated linearly each frame
+// and recycled by fence value, so the heap is bound once per command list.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class DescriptorRing
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	DescriptorRing();
+	~DescriptorRing();
+
+	bool Init(GfxDevice* pDevice, GfxDescriptorHeapType type, uint32_t capacity);
+	void Term();
+
+	// reserve count contiguous descriptors, returns false when the ring is full
+	bool Allocate(uint32_t count, GfxCpuDescriptorHandle& cpu, GfxGpuDescriptorHandle& gpu);
+
+	// copy count CPU-only descriptors into a contiguous table (runs of neighbouring sources are copied
+	// with one call)
+	bool Stage(const GfxCpuDescriptorHandle* pSources, uint32_t count, GfxGpuDescriptorHandle& table);
+
+	// recycle the tables of frames whose fence value is less than or equal to completedValue
+	void Retire(uint64_t completedValue) { m_Ring.Retire(completedValue); }
+
+	// close the current frame, its tables are recycled once the fence reaches fenceValue
+	void EndFrame(uint64_t fenceValue) { m_Ring.EndFrame(fenceValue); }
+
+	GfxDescriptorHeap* GetHeap() const { return m_pHeap.get(); }
+	uint32_t GetCapacity() const { return static_cast<uint32_t>(m_Ring.GetCapacity()); }
+	uint32_t GetUsedCount() const { return static_cast<uint32_t>(m_Ring.GetUsed()); }
+
+	// units are descriptors, kept after Term() until the next Init()
+	const LinearRingStats& GetStats() const { return m_Ring.GetStats(); }
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	GfxDevice* m_pDevice; // device copying the descriptors
+	GfxPtr<GfxDescriptorHeap> m_pHeap; // shader visible heap
+	GfxDescriptorHeapType m_Type; // type of descriptors
+	GfxCpuDescriptorHandle m_CPUStart; // CPU handle of the first descriptor
+	GfxGpuDescriptorHandle m_GPUStart; // GPU handle of the first descriptor
+	uint32_t m_IncrementSize; // distance between two descriptors
+	LinearRing m_Ring; // bookkeeping of the heap in descriptors
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DrawPacket structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct DrawPacket
+{
+	uint64_t Key; // DrawQueue::MakeKey(), the order of submission
+	uint32_t Payload; // index of the draw data of the owner
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DrawStateChanges structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct DrawStateChanges
+{
+	uint32_t PassChanges; // draws starting another pass
+	uint32_t PipelineChanges; // draws binding another pipeline (including the first draw of every pass)
+	uint32_t MaterialChanges; // draws binding another material (including every pipeline change)
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DrawQueue class
+//
+// Draws of a frame as 64-bit sort keys plus a payload index, sorted once per frame and submitted in key
+// order. From the most significant bits down a key holds the pass, the pipeline, the material and the
+// depth, so the sorted draws change pipelines and materials as rarely as possible and each group is drawn
+// front to back (or back to front for blending). Sort() is a stable least significant digit radix sort of
+// 8-bit digits; a histogram of every digit is built in one read of the keys, and digits which are equal in
+// all keys (unused passes, a single pipeline) are skipped. Scratch memory is kept between frames.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class DrawQueue
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint32_t PassBits = 4; // bits 63...60
+	static const uint32_t PipelineBits = 12; // bits 59...48
+	static const uint32_t MaterialBits = 16; // bits 47...32, the depth takes the lower 32 bits
+	static const uint32_t MaxPasses = 1u << PassBits;
+	static const uint32_t MaxPipelines = 1u << PipelineBits;
+	static const uint32_t MaxMaterials = 1u << MaterialBits;
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	DrawQueue();
+
+	// forget the draws of the previous frame
+	void Reset() { m_Packets.clear(); }
+	void Reserve(uint32_t count);
+	void Push(uint64_t key, uint32_t payload) { m_Packets.push_back(DrawPacket{ key, payload }); }
+
+	// ascending keys, draws of equal keys keep the order they were pushed in
+	void Sort();
+
+	const DrawPacket* GetPackets() const { return m_Packets.data(); }
+	uint32_t GetCount() const { return static_cast<uint32_t>(m_Packets.size()); }
+
+	// digits scattered by the last Sort() (at most 8)
+	uint32_t GetSortPassCount() const { return m_SortPassCount; }
+
+	// fields are masked to their bits, depth is the distance from the camera (negative counts as 0)
+	static uint64_t MakeKey(uint32_t pass, uint32_t pipeline, uint32_t material, float depth, bool backToFront = false);
+
+	static uint32_t GetPass(uint64_t key) { return static_cast<uint32_t>(key >> (64 - PassBits)); }
+	static uint32_t GetPipeline(uint64_t key) { return static_cast<uint32_t>(key >> (32 + MaterialBits)) & (MaxPipelines - 1); }
+	static uint32_t GetMaterial(uint64_t key) { return static_cast<uint32_t>(key >> 32) & (MaxMaterials - 1); }
+
+	// binds needed to submit the draws in the given order
+	static DrawStateChanges CountStateChanges(const DrawPacket* pPackets, uint32_t count);
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	static const uint32_t DigitBits = 8; // bits sorted per pass
+	static const uint32_t DigitCount = 64 / DigitBits; // passes over a whole key
+	static const uint32_t RadixThreshold = 256; // fewer draws are sorted by comparison
+
+	std::vector<DrawPacket> m_Packets; // draws of the frame (sorted after Sort())
+	std::vector<DrawPacket> m_Scratch; // other buffer of the radix passes
+	std::vector<uint32_t> m_Histograms; // (1 << DigitBits) counters per digit
+	uint32_t m_SortPassCount; // digits scattered by the last Sort()
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// FrameTimelineStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct FrameTimelineStats
+{
+	uint64_t FrameCount; // frames begun
+	uint64_t StallCount; // frames which had to wait for the GPU in BeginFrame()
+	uint64_t FlushCount; // calls of WaitIdle()
+	double StallMs; // time spent waiting in BeginFrame()
+	double MaxStallMs; // longest wait in BeginFrame()
+	double LastStallMs; // wait of the latest BeginFrame()
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// FrameTimeline class
+//
+// One fence whose value grows by one per frame. The CPU runs up to framesInFlight frames ahead of the GPU:
+// BeginFrame() waits until the frame which used the slot framesInFlight frames ago has completed, so that
+// per-frame resources indexed by the slot can be reused. Everything used by a frame is retired with
+// GetFrameValue() and can be recycled once GetCompletedValue() reaches it. Back buffers are independent
+// of the slots and still follow the swap chain.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class FrameTimeline
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint32_t MaxFramesInFlight = 4; // upper limit of frames the CPU may run ahead
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	FrameTimeline();
+	~FrameTimeline();
+
+	// framesInFlight is clamped to [1, MaxFramesInFlight]
+	bool Init(GfxDevice* pDevice, GfxCommandQueue* pQueue, uint32_t framesInFlight);
+
+	// waits for the GPU before the fence goes away
+	void Term();
+
+	// wait until the slot of the next frame is free, returns the slot
+	uint32_t BeginFrame();
+
+	// signal the end of the current frame on the queue, returns its fence value
+	uint64_t EndFrame();
+
+	// wait until the GPU has finished every frame ended so far
+	void WaitIdle();
+
+	uint32_t GetFramesInFlight() const { return m_FramesInFlight; }
+	uint32_t GetFrameSlot() const { return m_FrameSlot; }
+
+	// value the current frame is signaled with
+	uint64_t GetFrameValue() const { return m_FrameValue; }
+	uint64_t GetCompletedValue() const { return m_pFence->GetCompletedValue(); }
+	GfxFence* GetFence() const { return m_pFence.get(); }
+
+	// totals since Init()
+	const FrameTimelineStats& GetStats() const { return m_Stats; }
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	GfxCommandQueue* m_pQueue; // queue the frames are submitted to
+	GfxPtr<GfxFence> m_pFence; // fence of the timeline
+	uint32_t m_FramesInFlight; // number of slots
+	uint32_t m_FrameSlot; // slot of the current frame
+	uint64_t m_FrameValue; // fence value of the current frame
+	uint64_t m_SlotValues[MaxFramesInFlight]; // fence value of the latest frame of each slot
+	FrameTimelineStats m_Stats; // totals since Init()
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <WorkerPool.h>
+#include <XMath.h>
+#include <cstdint>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Frustum structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct Frustum
+{
+	DirectX::XMFLOAT4 Planes[6]; // left, right, bottom, top, near, far (xyz: inward normal, w: distance)
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SphereBounds structure (one stream per component, count entries each)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct SphereBounds
+{
+	const float* pCenterX; // center
+	const float* pCenterY;
+	const float* pCenterZ;
+	const float* pRadius; // radius
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// BoxBounds structure (one stream per component, count entries each)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct BoxBounds
+{
+	const float* pCenterX; // center
+	const float* pCenterY;
+	const float* pCenterZ;
+	const float* pExtentX; // half size
+	const float* pExtentY;
+	const float* pExtentZ;
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// FrustumCuller class
+//
+// Tests world space bounds against the 6 planes of a view-projection matrix, 4 (SSE) or 8 (AVX) objects
+// at a time. Large inputs are split into chunks spread over a WorkerPool; each chunk writes its visible
+// indices into its own part of the output, which is compacted afterwards, so the list stays in
+// ascending order whatever the number of workers.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class FrustumCuller
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint32_t ChunkSize = 4096; // objects per job
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	FrustumCuller();
+
+	// planes of the row-vector view-projection matrix (D3D clip space, 0 <= z <= w)
+	static Frustum ExtractFrustum(const DirectX::XMMATRIX& viewProj);
+
+	// pVisible needs room for count indices, returns the number of visible objects
+	uint32_t CullSpheres(const Frustum& frustum, const SphereBounds& bounds, uint32_t count, uint32_t* pVisible, WorkerPool* pWorkers = nullptr);
+	uint32_t CullBoxes(const Frustum& frustum, const BoxBounds& bounds, uint32_t count, uint32_t* pVisible, WorkerPool* pWorkers = nullptr);
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	std::vector<uint32_t> m_ChunkVisible; // visible objects per chunk of the last call
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	template<typename Bounds> uint32_t Cull(const Frustum& frustum, const Bounds& bounds, uint32_t count, uint32_t* pVisible, WorkerPool* pWorkers);
+};
@@ -0,0 +1,588 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+
+//--------------------------------------------------------------------------------------------------------
+// Type Alias
+//--------------------------------------------------------------------------------------------------------
+template<typename T> using GfxPtr = std::unique_ptr<T>;
+using GfxGpuVirtualAddress = uint64_t;
+
+
+//--------------------------------------------------------------------------------------------------------
+// Forward Declarations
+//--------------------------------------------------------------------------------------------------------
+class GfxResource;
+class GfxCommandAllocator;
+class GfxCommandList;
+class GfxCommandQueue;
+class GfxDescriptorHeap;
+class GfxFence;
+class GfxHeap;
+class GfxPipelineState;
+class GfxQueryHeap;
+class GfxRootSignature;
+class GfxSwapChain;
+
+
+//--------------------------------------------------------------------------------------------------------
+// Enumerations
+//
+// Values mirror their D3D12/DXGI counterparts so that the D3D12 backend can translate them with a cast.
+//--------------------------------------------------------------------------------------------------------
+enum class GfxBackend : uint8_t
+{
+	D3D12, // Direct3D 12 (Windows only)
+	Recording, // headless backend which records every call into a command stream
+};
+
+enum class GfxFormat : uint32_t
+{
+	Unknown = 0,
+	R32G32B32A32_Float = 2,
+	R32G32B32_Float = 6,
+	R16G16B16A16_Float = 10,
+	R16G16B16A16_Snorm = 13,
+	R32G32_Float = 16,
+	R8G8B8A8_Unorm = 28,
+	R8G8B8A8_Unorm_sRGB = 29,
+	R32_Uint = 42,
+	R16_Uint = 57,
+};
+
+enum class GfxHeapType : uint32_t
+{
+	Default = 1,
+	Upload = 2,
+	Readback = 3,
+};
+
+enum class GfxResourceState : uint32_t
+{
+	Common = 0,
+	VertexAndConstantBuffer = 0x1,
+	IndexBuffer = 0x2,
+	RenderTarget = 0x4,
+	CopyDest = 0x400,
+	CopySource = 0x800,
+	GenericRead = 0x1 | 0x2 | 0x40 | 0x80 | 0x200 | 0x800,
+	Present = 0,
+};
+
+enum class GfxResourceBarrierFlags : uint32_t
+{
+	None = 0,
+	BeginOnly = 0x1,
+	EndOnly = 0x2,
+};
+
+enum class GfxResourceBarrierType : uint32_t
+{
+	Transition = 0,
+	Aliasing = 1,
+};
+
+enum class GfxCommandListType : uint32_t
+{
+	Direct = 0,
+	Compute = 2,
+	Copy = 3,
+};
+
+enum class GfxDescriptorHeapType : uint32_t
+{
+	CBV_SRV_UAV = 0,
+	Sampler = 1,
+	RTV = 2,
+	DSV = 3,
+};
+
+enum class GfxPrimitiveTopology : uint32_t
+{
+	TriangleList = 4,
+};
+
+enum class GfxInputClassification : uint32_t
+{
+	PerVertexData = 0,
+	PerInstanceData = 1,
+};
+
+enum class GfxRootParameterType : uint32_t
+{
+	DescriptorTable = 0,
+	CBV = 2,
+};
+
+enum class GfxDescriptorRangeType : uint32_t
+{
+	SRV = 0,
+	UAV = 1,
+	CBV = 2,
+};
+
+enum class GfxShaderVisibility : uint32_t
+{
+	All = 0,
+	Vertex = 1,
+	Pixel = 5,
+};
+
+enum class GfxFillMode : uint32_t
+{
+	Wireframe = 2,
+	Solid = 3,
+};
+
+enum class GfxCullMode : uint32_t
+{
+	None = 1,
+	Front = 2,
+	Back = 3,
+};
+
+enum class GfxBlend : uint32_t
+{
+	Zero = 1,
+	One = 2,
+	SrcAlpha = 5,
+	InvSrcAlpha = 6,
+};
+
+enum class GfxBlendOp : uint32_t
+{
+	Add = 1,
+};
+
+enum class GfxComparisonFunc : uint32_t
+{
+	Never = 1,
+	Less = 2,
+	LessEqual = 4,
+	Always = 8,
+};
+
+constexpr uint32_t GfxAllSubresources = 0xffffffff;
+constexpr uint64_t GfxPlacementAlignment = 0x10000; // offset alignment of placed resources in a heap (64 KB)
+constexpr uint32_t GfxAppendAlignedElement = 0xffffffff;
+constexpr uint8_t GfxColorWriteEnableAll = 0xf;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Descriptor handle structures
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct GfxCpuDescriptorHandle
+{
+	size_t ptr;
+};
+
+struct GfxGpuDescriptorHandle
+{
+	uint64_t ptr;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// View structures
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct GfxVertexBufferView
+{
+	GfxGpuVirtualAddress BufferLocation; // GPU address of the vertex data
+	uint32_t SizeInBytes; // size of the vertex data
+	uint32_t StrideInBytes; // size of one vertex
+};
+
+struct GfxIndexBufferView
+{
+	GfxGpuVirtualAddress BufferLocation; // GPU address of the index data
+	uint32_t SizeInBytes; // size of the index data
+	GfxFormat Format; // format of one index
+};
+
+struct GfxConstantBufferViewDesc
+{
+	GfxGpuVirtualAddress BufferLocation; // GPU address of the constant data
+	uint32_t SizeInBytes; // size of the constant data (multiple of 256)
+};
+
+struct GfxViewport
+{
+	float TopLeftX;
+	float TopLeftY;
+	float Width;
+	float Height;
+	float MinDepth;
+	float MaxDepth;
+};
+
+struct GfxRect
+{
+	int32_t left;
+	int32_t top;
+	int32_t right;
+	int32_t bottom;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GfxResourceBarrier structure
+//
+// Aliasing barriers only use pResource: the placed resource that starts using memory other placed
+// resources used before it (nullptr for any).
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct GfxResourceBarrier
+{
+	GfxResource* pResource; // resource to transition
+	uint32_t Subresource; // subresource index or GfxAllSubresources
+	GfxResourceState StateBefore; // state before the barrier
+	GfxResourceState StateAfter; // state after the barrier
+	GfxResourceBarrierFlags Flags; // halves of a split barrier (None for a complete one)
+	GfxResourceBarrierType Type; // Transition unless given
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Creation descriptors
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct GfxBufferDesc
+{
+	uint64_t Size; // size in bytes
+	GfxHeapType HeapType; // heap the buffer lives in
+	GfxResourceState InitialState; // state on creation
+};
+
+struct GfxHeapDesc
+{
+	uint64_t Size; // size in bytes (multiple of GfxPlacementAlignment)
+	GfxHeapType HeapType; // memory of the heap
+};
+
+struct GfxDescriptorHeapDesc
+{
+	GfxDescriptorHeapType Type; // type of descriptors
+	uint32_t NumDescriptors; // number of descriptors
+	bool ShaderVisible; // whether shaders can reference the heap
+};
+
+struct GfxSwapChainDesc
+{
+	uint32_t Width; // width of back buffers
+	uint32_t Height; // height of back buffers
+	uint32_t BufferCount; // number of back buffers
+	GfxFormat Format; // format of back buffers
+	void* pNativeWindow; // HWND on Windows, ignored by headless backends
+};
+
+struct GfxRootParameter
+{
+	GfxRootParameterType ParameterType; // type of parameter
+	uint32_t ShaderRegister; // (first) register bound to
+	uint32_t RegisterSpace; // register space bound to
+	GfxShaderVisibility ShaderVisibility; // stages which see the parameter
+	GfxDescriptorRangeType RangeType; // descriptor table only: type of the single range
+	uint32_t NumDescriptors; // descriptor table only: number of descriptors in the range
+};
+
+struct GfxRootSignatureDesc
+{
+	uint32_t NumParameters; // number of root parameters
+	const GfxRootParameter* pParameters; // root parameters
+	bool AllowInputLayout; // whether the input assembler is used
+};
+
+struct GfxInputElementDesc
+{
+	const char* SemanticName;
+	uint32_t SemanticIndex;
+	GfxFormat Format;
+	uint32_t InputSlot;
+	uint32_t AlignedByteOffset;
+	GfxInputClassification InputSlotClass;
+	uint32_t InstanceDataStepRate;
+};
+
+struct GfxShaderBytecode
+{
+	const void* pShaderBytecode;
+	size_t BytecodeLength;
+};
+
+struct GfxRasterizerDesc
+{
+	GfxFillMode FillMode;
+	GfxCullMode CullMode;
+	bool FrontCounterClockwise;
+	bool DepthClipEnable;
+};
+
+struct GfxRenderTargetBlendDesc
+{
+	bool BlendEnable;
+	GfxBlend SrcBlend;
+	GfxBlend DestBlend;
+	GfxBlendOp BlendOp;
+	GfxBlend SrcBlendAlpha;
+	GfxBlend DestBlendAlpha;
+	GfxBlendOp BlendOpAlpha;
+	uint8_t RenderTargetWriteMask;
+};
+
+struct GfxDepthStencilDesc
+{
+	bool DepthEnable;
+	bool DepthWriteEnable;
+	GfxComparisonFunc DepthFunc;
+};
+
+struct GfxGraphicsPipelineDesc
+{
+	GfxRootSignature* pRootSignature; // root signature
+	GfxShaderBytecode VS; // vertex shader
+	GfxShaderBytecode PS; // pixel shader
+	const GfxInputElementDesc* pInputElementDescs; // input layout
+	uint32_t NumInputElements; // number of input elements
+	GfxRasterizerDesc RasterizerState; // rasterizer state
+	GfxRenderTargetBlendDesc BlendState; // blend state shared by all render targets
+	GfxDepthStencilDesc DepthStencilState; // depth stencil state
+	GfxPrimitiveTopology PrimitiveTopology; // topology (triangle list only)
+	GfxFormat RTVFormat; // format of render target
+	GfxFormat DSVFormat; // format of depth stencil
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GfxObject class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GfxObject
+{
+public:
+	virtual ~GfxObject() = default;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GfxResource class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GfxResource : public GfxObject
+{
+public:
+	virtual bool Map(void** ppData) = 0;
+	virtual void Unmap() = 0;
+	virtual GfxGpuVirtualAddress GetGPUVirtualAddress() const = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GfxDescriptorHeap class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GfxDescriptorHeap : public GfxObject
+{
+public:
+	virtual GfxCpuDescriptorHandle GetCPUDescriptorHandleForHeapStart() const = 0;
+	virtual GfxGpuDescriptorHandle GetGPUDescriptorHandleForHeapStart() const = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GfxRootSignature class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GfxRootSignature : public GfxObject
+{
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GfxPipelineState class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GfxPipelineState : public GfxObject
+{
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GfxPipelineLibrary class
+//
+// Compiled pipelines stored under 64-bit keys and serialized to a blob which a later run passes back to
+// CreatePipelineLibrary(). Loading fails when the key is missing or the desc differs from the stored
+// one. Methods may be called from any thread, but not for the same key at the same time.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GfxPipelineLibrary : public GfxObject
+{
+public:
+	virtual bool LoadGraphicsPipeline(uint64_t key, const GfxGraphicsPipelineDesc& desc, GfxPtr<GfxPipelineState>& pPipelineState) = 0;
+	virtual bool StorePipeline(uint64_t key, GfxPipelineState* pPipelineState) = 0;
+	virtual size_t GetSerializedSize() const = 0;
+	virtual bool Serialize(void* pData, size_t size) const = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GfxQueryHeap class
+//
+// Timestamp queries written by GfxCommandList::EndQuery() and copied to a buffer by ResolveQueryData()
+// (8 bytes per query, ticks of GfxCommandQueue::GetTimestampFrequency()).
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GfxQueryHeap : public GfxObject
+{
+public:
+	virtual uint32_t GetCount() const = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GfxHeap class
+//
+// Memory placed buffers are created in, buffers of the heap only.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GfxHeap : public GfxObject
+{
+public:
+	virtual uint64_t GetSize() const = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GfxCommandAllocator class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GfxCommandAllocator : public GfxObject
+{
+public:
+	virtual void Reset() = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GfxFence class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GfxFence : public GfxObject
+{
+public:
+	virtual uint64_t GetCompletedValue() const = 0;
+
+	// block the calling thread until the fence reaches the value
+	virtual void Wait(uint64_t value) = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GfxCommandList class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GfxCommandList : public GfxObject
+{
+public:
+	virtual void Reset(GfxCommandAllocator* pAllocator, GfxPipelineState* pInitialState) = 0;
+	virtual void Close() = 0;
+
+	virtual void ResourceBarrier(uint32_t numBarriers, const GfxResourceBarrier* pBarriers) = 0;
+	virtual void OMSetRenderTargets(uint32_t numRenderTargets, const GfxCpuDescriptorHandle* pRenderTargets) = 0;
+	virtual void ClearRenderTargetView(GfxCpuDescriptorHandle renderTarget, const float color[4]) = 0;
+	virtual void SetGraphicsRootSignature(GfxRootSignature* pRootSignature) = 0;
+	virtual void SetDescriptorHeaps(uint32_t numHeaps, GfxDescriptorHeap* const* ppHeaps) = 0;
+	virtual void SetGraphicsRootConstantBufferView(uint32_t rootParameterIndex, GfxGpuVirtualAddress bufferLocation) = 0;
+	virtual void SetGraphicsRootDescriptorTable(uint32_t rootParameterIndex, GfxGpuDescriptorHandle baseDescriptor) = 0;
+	virtual void SetPipelineState(GfxPipelineState* pPipelineState) = 0;
+	virtual void IASetPrimitiveTopology(GfxPrimitiveTopology topology) = 0;
+	virtual void IASetVertexBuffers(uint32_t startSlot, uint32_t numViews, const GfxVertexBufferView* pViews) = 0;
+	virtual void IASetIndexBuffer(const GfxIndexBufferView* pView) = 0;
+	virtual void RSSetViewports(uint32_t numViewports, const GfxViewport* pViewports) = 0;
+	virtual void RSSetScissorRects(uint32_t numRects, const GfxRect* pRects) = 0;
+	virtual void DrawIndexedInstanced(
+		uint32_t indexCountPerInstance,
+		uint32_t instanceCount,
+		uint32_t startIndexLocation,
+		int32_t baseVertexLocation,
+		uint32_t startInstanceLocation) = 0;
+
+	// timestamp of the point the GPU reaches the query, resolved into a readback buffer
+	virtual void EndQuery(GfxQueryHeap* pQueryHeap, uint32_t index) = 0;
+	virtual void ResolveQueryData(
+		GfxQueryHeap* pQueryHeap,
+		uint32_t startIndex,
+		uint32_t numQueries,
+		GfxResource* pDestBuffer,
+		uint64_t alignedDestOffset) = 0;
+
+	// buffer to buffer copy (all list types, copy lists rely on the implicit promotion from Common)
+	virtual void CopyBufferRegion(
+		GfxResource* pDstBuffer,
+		uint64_t dstOffset,
+		GfxResource* pSrcBuffer,
+		uint64_t srcOffset,
+		uint64_t numBytes) = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GfxCommandQueue class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GfxCommandQueue : public GfxObject
+{
+public:
+	virtual void ExecuteCommandLists(uint32_t numCommandLists, GfxCommandList* const* ppCommandLists) = 0;
+	virtual void Signal(GfxFence* pFence, uint64_t value) = 0;
+
+	// work submitted afterwards starts once the fence reaches the value (the CPU doesn't block)
+	virtual void Wait(GfxFence* pFence, uint64_t value) = 0;
+
+	// ticks per second of the timestamps written on this queue
+	virtual uint64_t GetTimestampFrequency() const = 0;
+
+	// GPU timestamp and std::chrono::steady_clock time in nanoseconds sampled at the same moment
+	virtual bool GetClockCalibration(uint64_t& gpuTimestamp, uint64_t& cpuNanoseconds) const = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GfxSwapChain class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GfxSwapChain : public GfxObject
+{
+public:
+	// back buffers are owned by the swap chain
+	virtual GfxResource* GetBuffer(uint32_t index) const = 0;
+	virtual uint32_t GetCurrentBackBufferIndex() const = 0;
+	virtual void Present(uint32_t syncInterval) = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GfxDevice class
+//
+// Create* methods may be called from any thread, like those of ID3D12Device.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GfxDevice : public GfxObject
+{
+public:
+	virtual GfxBackend GetBackend() const = 0;
+
+	// headless devices have no window and accept empty shader bytecode
+	virtual bool IsHeadless() const = 0;
+
+	virtual bool CreateCommandQueue(GfxCommandListType type, GfxPtr<GfxCommandQueue>& pQueue) = 0;
+	virtual bool CreateSwapChain(GfxCommandQueue* pQueue, const GfxSwapChainDesc& desc, GfxPtr<GfxSwapChain>& pSwapChain) = 0;
+	virtual bool CreateCommandAllocator(GfxCommandListType type, GfxPtr<GfxCommandAllocator>& pAllocator) = 0;
+	virtual bool CreateCommandList(GfxCommandListType type, GfxCommandAllocator* pAllocator, GfxPtr<GfxCommandList>& pCmdList) = 0;
+	virtual bool CreateFence(uint64_t initialValue, GfxPtr<GfxFence>& pFence) = 0;
+	virtual bool CreateDescriptorHeap(const GfxDescriptorHeapDesc& desc, GfxPtr<GfxDescriptorHeap>& pHeap) = 0;
+	virtual bool CreateBuffer(const GfxBufferDesc& desc, GfxPtr<GfxResource>& pResource) = 0;
+	virtual bool CreateHeap(const GfxHeapDesc& desc, GfxPtr<GfxHeap>& pHeap) = 0;
+
+	// buffer at offset (a multiple of GfxPlacementAlignment) of pHeap, desc.HeapType has to match the heap
+	virtual bool CreatePlacedBuffer(GfxHeap* pHeap, uint64_t offset, const GfxBufferDesc& desc, GfxPtr<GfxResource>& pResource) = 0;
+	virtual bool CreateRootSignature(const GfxRootSignatureDesc& desc, GfxPtr<GfxRootSignature>& pRootSignature) = 0;
+	virtual bool CreateGraphicsPipelineState(const GfxGraphicsPipelineDesc& desc, GfxPtr<GfxPipelineState>& pPipelineState) = 0;
+
+	// pBlob is a serialized library (nullptr for an empty one) and must stay valid while the library lives
+	virtual bool CreatePipelineLibrary(const void* pBlob, size_t blobSize, GfxPtr<GfxPipelineLibrary>& pLibrary) = 0;
+	virtual bool CreateTimestampQueryHeap(uint32_t count, GfxPtr<GfxQueryHeap>& pQueryHeap) = 0;
+
+	virtual uint32_t GetDescriptorHandleIncrementSize(GfxDescriptorHeapType type) const = 0;
+	virtual void CreateConstantBufferView(const GfxConstantBufferViewDesc& desc, GfxCpuDescriptorHandle destDescriptor) = 0;
+	virtual void CreateRenderTargetView(GfxResource* pResource, GfxFormat format, GfxCpuDescriptorHandle destDescriptor) = 0;
+	virtual void CopyDescriptorsSimple(
+		uint32_t numDescriptors,
+		GfxCpuDescriptorHandle destDescriptorRangeStart,
+		GfxCpuDescriptorHandle srcDescriptorRangeStart,
+		GfxDescriptorHeapType type) = 0;
+};
+
+
+//--------------------------------------------------------------------------------------------------------
+// Factory
+//--------------------------------------------------------------------------------------------------------
+
+// create a device of the backend, returns false if the backend is unavailable on this platform
+bool CreateGfxDevice(GfxBackend backend, GfxPtr<GfxDevice>& pDevice);
+
+// default backend of the platform (D3D12 on Windows, Recording elsewhere)
+GfxBackend GetDefaultGfxBackend();
@@ -0,0 +1,123 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <TlsfAllocator.h>
+#include <mutex>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GpuAllocation structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct GpuAllocation
+{
+	GfxResource* pResource; // buffer the range lives in (owned by the allocator)
+	void* pCPU; // CPU pointer of the range (upload and readback memory, nullptr otherwise)
+	GfxGpuVirtualAddress GPU; // GPU virtual address of the range
+	uint64_t Offset; // offset of the range in pResource
+	uint64_t Size; // size requested
+	uint32_t Block; // heap of the allocator, GpuMemoryAllocator::InvalidBlock when nothing is allocated
+	TlsfAllocation Range; // range in the heap
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GpuMemoryStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct GpuMemoryStats
+{
+	uint32_t HeapCount; // heaps reserved
+	uint64_t ReservedBytes; // bytes of the heaps
+	uint64_t UsedBytes; // bytes of the live allocations (rounded up to the granularity)
+	uint64_t LargestFreeBlock; // largest range any heap can still hand out at once
+	uint32_t AllocationCount; // live allocations
+	uint32_t FreeBlockCount; // free ranges over all heaps
+	uint64_t HeapCreations; // heaps created since Init() (each is one kernel allocation)
+
+	// share of the free bytes outside of the largest free range
+	double GetFragmentation() const
+	{
+		uint64_t free = ReservedBytes - UsedBytes;
+		return (free > 0) ? 1.0 - static_cast<double>(LargestFreeBlock) / static_cast<double>(free) : 0.0;
+	}
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GpuMemoryAllocator class
+//
+// Buffers sub-allocated from large heaps instead of one committed resource each. Every heap of a heap type
+// is covered by a single placed buffer (persistently mapped when the CPU can map it), and allocations are
+// ranges of it handed out by a TlsfAllocator at their own alignment, so a small buffer no longer takes
+// 64 KB and a kernel allocation. Requests larger than a heap get a heap of their own, which goes with
+// them. Free() has to wait until the GPU is done with the range (DeferredReleaseQueue). Thread safe.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GpuMemoryAllocator
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint64_t DefaultHeapSize = 16 * 1024 * 1024; // bytes of a shared heap
+	static const uint64_t DefaultAlignment = 256; // constant buffer placement alignment
+	static const uint64_t Granularity = 256; // smallest range handed out
+	static const uint32_t InvalidBlock = UINT32_MAX; // block of an empty allocation
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	GpuMemoryAllocator();
+	~GpuMemoryAllocator();
+
+	// heapSize is rounded up to GfxPlacementAlignment, heaps are only created when needed
+	bool Init(GfxDevice* pDevice, uint64_t heapSize = DefaultHeapSize);
+
+	// the GPU is idle, live allocations become invalid
+	void Term();
+
+	// size bytes of heapType memory aligned to alignment (power of two, at most GfxPlacementAlignment)
+	bool Allocate(GfxHeapType heapType, uint64_t size, uint64_t alignment, GpuAllocation& allocation);
+	bool Allocate(GfxHeapType heapType, uint64_t size, GpuAllocation& allocation) { return Allocate(heapType, size, DefaultAlignment, allocation); }
+
+	// returns the range, allocation is emptied (the GPU must be done with it)
+	void Free(GpuAllocation& allocation);
+
+	GpuMemoryStats GetStats() const;
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Block structure - heap and the buffer covering it
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Block
+	{
+		GfxPtr<GfxHeap> pHeap; // memory (nullptr for an unused entry)
+		GfxPtr<GfxResource> pBuffer; // placed buffer over the whole heap
+		uint8_t* pCPU; // mapped start of pBuffer (nullptr for default heaps)
+		GfxHeapType HeapType; // memory of the heap
+		bool Dedicated; // created for one request larger than the shared heap size
+		TlsfAllocator Ranges; // ranges of the heap
+	};
+
+	GfxDevice* m_pDevice; // device the heaps are created on
+	uint64_t m_HeapSize; // bytes of a shared heap
+	std::vector<Block> m_Blocks; // heaps (unused entries are reused)
+	uint64_t m_HeapCreations; // heaps created since Init()
+	mutable std::mutex m_Mutex; // guards the members above
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	uint32_t CreateBlock(GfxHeapType heapType, uint64_t size, bool dedicated);
+	void DestroyBlock(uint32_t index);
+};
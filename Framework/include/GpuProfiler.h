@@ -0,0 +1,103 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <atomic>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GpuProfilerStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct GpuProfilerStats
+{
+	uint64_t FrameCount; // frames whose timestamps have been read back
+	uint64_t RegionCount; // regions read back
+	uint64_t DroppedCount; // regions begun after the frame ran out of queries
+	double LastFrameMs; // first begin to last end of the latest frame read back
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GpuProfiler class
+//
+// Timestamp pairs around command list regions. Every frame slot owns a range of a query heap and of a
+// readback buffer: EndFrame() resolves the slot's whole range at the end of the frame's last command list
+// and BeginFrame() reads it once the timeline hands the slot out again, so nothing ever waits for the GPU.
+// Resolving the whole range lets lists recorded in parallel still open regions after EndFrame() has been
+// recorded, the number of regions is only taken at the next BeginFrame(). Timestamps are converted to
+// steady_clock time through the queue's clock calibration and added to the Profiler's GPU track while it
+// is enabled. Regions may be opened from any thread.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GpuProfiler
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint32_t InvalidRegion = UINT32_MAX; // region of a frame out of queries
+	static const uint32_t CalibrationInterval = 256; // frames between clock calibrations
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	GpuProfiler();
+	~GpuProfiler();
+
+	// fails when the device has no timestamp queries on the queue
+	bool Init(GfxDevice* pDevice, GfxCommandQueue* pQueue, uint32_t framesInFlight, uint32_t maxRegionsPerFrame);
+
+	// the GPU is idle
+	void Term();
+
+	// read back the slot's previous frame (its fence has completed) and start a new one in it
+	void BeginFrame(uint32_t slot);
+
+	// timestamp at the start of a region, returns the region passed to EndRegion()
+	uint32_t BeginRegion(GfxCommandList* pCmdList, const char* name, uint32_t depth = 0);
+	void EndRegion(GfxCommandList* pCmdList, uint32_t region);
+
+	// resolve the frame's timestamps, recorded into the last command list executed in the frame
+	void EndFrame(GfxCommandList* pCmdList);
+
+	uint32_t GetMaxRegions() const { return m_MaxRegions; }
+	bool IsValid() const { return m_pQueryHeap != nullptr; }
+
+	// totals since Init()
+	const GpuProfilerStats& GetStats() const { return m_Stats; }
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	GfxCommandQueue* m_pQueue; // queue the timestamps are written on
+	GfxPtr<GfxQueryHeap> m_pQueryHeap; // two queries per region and slot
+	GfxPtr<GfxResource> m_pReadback; // resolved timestamps, mapped while initialized
+	const uint64_t* m_pTimestamps; // mapped m_pReadback
+	uint32_t m_FramesInFlight; // number of slots
+	uint32_t m_MaxRegions; // regions per slot
+	uint32_t m_FrameSlot; // slot of the current frame
+	std::atomic<uint32_t> m_RegionCount; // regions begun in the current frame
+	bool m_FrameResolved; // whether EndFrame() has been called for the current frame
+	std::vector<const char*> m_Names; // region names per slot
+	std::vector<uint32_t> m_Depths; // region depths per slot
+	std::vector<uint32_t> m_ResolvedCounts; // regions resolved in the latest frame of each slot
+	double m_TickNs; // nanoseconds per timestamp tick
+	uint64_t m_CalibrationGpu; // GPU timestamp of the latest calibration
+	uint64_t m_CalibrationCpu; // steady_clock nanoseconds of the latest calibration
+	uint32_t m_CalibrationFrames; // frames since the latest calibration
+	GpuProfilerStats m_Stats; // totals since Init()
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	void Calibrate();
+	uint64_t ToCpuTime(uint64_t timestamp) const;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <cstdint>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// LinearRingStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct LinearRingStats
+{
+	uint64_t FrameCount; // number of finished frames
+	uint64_t TotalUnits; // units handed out over all finished frames (alignment padding included)
+	uint64_t PeakFrameUnits; // most units handed out in one frame
+	uint64_t LastFrameUnits; // units handed out in the last finished frame
+	uint64_t FailedAllocations; // allocations which didn't fit
+
+	double GetAverageFrameUnits() const
+	{
+		return (FrameCount > 0) ? static_cast<double>(TotalUnits) / static_cast<double>(FrameCount) : 0.0;
+	}
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// LinearRing class
+//
+// Bookkeeping of a fence-retired ring in abstract units (bytes, descriptors...). Allocations of a frame
+// are tagged with the fence value signaled at the end of that frame and recycled once the fence has
+// passed it. Owns no memory and never talks to a device.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class LinearRing
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint32_t MaxPendingFrames = 16; // frames which may be in flight at once
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	LinearRing();
+
+	// empty ring of the capacity, the statistics are kept (they outlive Term() of the owners)
+	void Reset(uint64_t capacity);
+	void ResetStats() { m_Stats = LinearRingStats(); }
+
+	// reserve size units aligned to alignment (power of two), returns false when the ring is full
+	bool Allocate(uint64_t size, uint64_t alignment, uint64_t& offset);
+
+	// recycle the regions of frames whose fence value is less than or equal to completedValue
+	void Retire(uint64_t completedValue);
+
+	// close the current frame, its region is recycled once the fence reaches fenceValue
+	void EndFrame(uint64_t fenceValue);
+
+	uint64_t GetCapacity() const { return m_Capacity; }
+	uint64_t GetUsed() const { return m_Head - m_Tail; }
+	uint32_t GetPendingFrameCount() const { return m_PendingCount; }
+	const LinearRingStats& GetStats() const { return m_Stats; }
+
+private:
+	//====================================================================================================
+	// Private structures
+	//====================================================================================================
+	struct PendingFrame
+	{
+		uint64_t FenceValue; // fence value which proves the GPU is done with the frame
+		uint64_t End; // head position at the end of the frame
+	};
+
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	uint64_t m_Capacity; // number of units
+	uint64_t m_Head; // monotonic position of the next allocation
+	uint64_t m_Tail; // monotonic position of the oldest unit in use
+	uint64_t m_FrameStart; // head position at the start of the current frame
+	PendingFrame m_Pending[MaxPendingFrames]; // frames waiting on the GPU (circular)
+	uint32_t m_PendingFirst; // index of the oldest pending frame
+	uint32_t m_PendingCount; // number of pending frames
+	LinearRingStats m_Stats; // statistics
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// LockFreeQueue class
+//
+// Bounded FIFO that any number of threads push to and pop from without a lock. Every cell carries a
+// sequence number telling whether it is free for the push of the current lap or holds a value for the pop
+// of the current lap, so a producer and a consumer only meet on the cell they both touch. Push() fails when
+// the queue is full and Pop() when it is empty, neither ever blocks. Values are copied, small ones (a
+// pointer or an index) suit it best.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename T> class LockFreeQueue
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	/* NOTHING */
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	LockFreeQueue()
+		: m_Mask(0)
+		, m_PushPosition(0)
+		, m_PopPosition(0)
+	{
+		/* DO_NOTHING */
+	}
+
+	// capacity is rounded up to a power of two, no other thread may use the queue meanwhile
+	bool Init(uint32_t capacity)
+	{
+		if (capacity == 0 || capacity > (1u << 31))
+		{
+			return false;
+		}
+
+		size_t count = 1;
+		while (count < capacity)
+		{
+			count <<= 1;
+		}
+
+		m_pCells.reset(new Cell[count]);
+		for (size_t i = 0; i < count; ++i)
+		{
+			m_pCells[i].Sequence.store(i, std::memory_order_relaxed);
+		}
+		m_Mask = count - 1;
+		m_PushPosition.store(0, std::memory_order_relaxed);
+		m_PopPosition.store(0, std::memory_order_relaxed);
+		return true;
+	}
+
+	// values still queued are dropped
+	void Term()
+	{
+		m_pCells.reset();
+		m_Mask = 0;
+	}
+
+	// false when the queue is full
+	bool Push(const T& value)
+	{
+		size_t position = m_PushPosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell& cell = m_pCells[position & m_Mask];
+			size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+			if (difference == 0)
+			{
+				// the cell is free for this lap, claim it before writing
+				if (m_PushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					cell.Value = value;
+					cell.Sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (difference < 0)
+			{
+				// the value of the previous lap hasn't been popped yet
+				return false;
+			}
+			else
+			{
+				// another producer claimed the cell first
+				position = m_PushPosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// false when the queue is empty
+	bool Pop(T& value)
+	{
+		size_t position = m_PopPosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell& cell = m_pCells[position & m_Mask];
+			size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+			if (difference == 0)
+			{
+				// the cell holds a value of this lap, claim it before reading
+				if (m_PopPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					value = cell.Value;
+					cell.Sequence.store(position + m_Mask + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (difference < 0)
+			{
+				// nothing pushed into the cell yet
+				return false;
+			}
+			else
+			{
+				// another consumer claimed the cell first
+				position = m_PopPosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	uint32_t GetCapacity() const { return static_cast<uint32_t>(m_pCells != nullptr ? m_Mask + 1 : 0); }
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Cell structure - one slot of the ring
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Cell
+	{
+		std::atomic<size_t> Sequence; // position a push (== position) or a pop (== position + 1) expects
+		T Value; // queued value
+	};
+
+	std::unique_ptr<Cell[]> m_pCells; // ring of cells (power of two)
+	size_t m_Mask; // cell count - 1
+	alignas(64) std::atomic<size_t> m_PushPosition; // next position producers claim (own cache line)
+	alignas(64) std::atomic<size_t> m_PopPosition; // next position consumers claim (own cache line)
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lz4Codec class
+//
+// Compression in the LZ4 block format (no frame header, no checksum), so blocks stay readable by any LZ4
+// implementation. Compress() is the greedy single pass of the reference "fast" mode: 4 byte sequences are
+// hashed into a table of recent positions and the step grows while nothing matches, which keeps
+// incompressible data cheap. Decompress() checks every length and offset against both buffers and fails on
+// corrupt blocks instead of reading or writing out of bounds. The hash table is kept between calls, one
+// instance per thread; Decompress() has no state.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class Lz4Codec
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint32_t MaxDistance = 65535; // farthest match an offset of the format reaches
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	Lz4Codec();
+
+	// returns the size of the block, 0 when it doesn't fit into capacity (GetCompressBound() always fits)
+	size_t Compress(const void* pSource, size_t size, void* pDest, size_t capacity);
+
+	// size must be the exact decompressed size, false on corrupt blocks
+	static bool Decompress(const void* pSource, size_t sourceSize, void* pDest, size_t size);
+
+	// largest block of size bytes of input (incompressible data grows by a little)
+	static size_t GetCompressBound(size_t size) { return size + size / 255 + 16; }
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	static const uint32_t HashBits = 12; // 4096 positions, the table stays in the L1 cache
+
+	std::vector<uint32_t> m_HashTable; // position of the last sequence per hash
+};
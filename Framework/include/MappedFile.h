@@ -0,0 +1,53 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MappedFile class
+//
+// Read-only view of a whole file (mmap / MapViewOfFile). Pages are faulted in by the OS on first access,
+// so opening costs no reads and no heap memory; the view stays valid until Close().
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class MappedFile
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	/* NOTHING */
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	MappedFile();
+	~MappedFile();
+
+	// sequential asks the OS to read ahead aggressively (whole file copies)
+	bool Open(const char* path, bool sequential = false);
+	void Close();
+
+	bool IsOpen() const { return m_pData != nullptr; }
+	const uint8_t* GetData() const { return m_pData; }
+	uint64_t GetSize() const { return m_Size; }
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	const uint8_t* m_pData; // start of the view
+	uint64_t m_Size; // size of the file
+#if defined(_WIN32)
+	void* m_hFile; // file handle
+	void* m_hMapping; // file mapping handle
+#endif
+};
@@ -0,0 +1,161 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <MappedFile.h>
+#include <cstdint>
+
+
+//--------------------------------------------------------------------------------------------------------
+// Constant Values
+//--------------------------------------------------------------------------------------------------------
+constexpr uint32_t MeshFileMagic = 0x4853454Du; // "MESH" read as little endian
+constexpr uint32_t MeshFileVersion = 1; // bumped whenever the layout below changes
+constexpr uint32_t MeshFileMaxStreams = 4; // vertex streams per file
+constexpr uint64_t MeshFileAlignment = 256; // placement of every stream and table in the file
+
+
+//--------------------------------------------------------------------------------------------------------
+// Enumerations
+//--------------------------------------------------------------------------------------------------------
+enum class MeshVertexLayout : uint32_t
+{
+	PositionColor = 0, // Vertex of ShaderTypes.h (float3 position, float4 color)
+	PackedPositionColor = 1, // PackedVertex of ShaderTypes.h, dequantized with the bounds of the file
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MeshFileStream structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct MeshFileStream
+{
+	uint64_t Offset; // from the start of the file
+	uint64_t Size; // VertexCount * Stride
+	uint32_t Stride; // bytes per vertex
+	MeshVertexLayout Layout; // element layout of the stream
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MeshFileRange structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct MeshFileRange
+{
+	uint64_t Offset; // from the start of the file
+	uint64_t Size; // bytes
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MeshFileSubmesh structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct MeshFileSubmesh
+{
+	uint32_t IndexStart; // first index of the submesh
+	uint32_t IndexCount; // multiple of 3 (triangle list)
+	uint32_t BaseVertex; // added to every index of the submesh
+	uint32_t Reserved; // zero
+	float BoundsMin[3]; // lower corner of the positions referenced
+	float BoundsMax[3]; // upper corner of the positions referenced
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MeshFileHeader structure (first bytes of the file, everything is little endian)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct MeshFileHeader
+{
+	uint32_t Magic; // MeshFileMagic
+	uint32_t Version; // MeshFileVersion
+	uint64_t FileSize; // total size, catches truncated files
+	uint32_t VertexCount; // vertices of every stream
+	uint32_t IndexCount; // indices of the index stream
+	GfxFormat IndexFormat; // R16_Uint or R32_Uint
+	uint32_t StreamCount; // used entries of Streams
+	uint32_t SubmeshCount; // entries of the submesh table
+	uint32_t Reserved; // zero
+	float BoundsMin[3]; // lower corner of all positions
+	float BoundsMax[3]; // upper corner of all positions
+	MeshFileStream Streams[MeshFileMaxStreams]; // vertex streams
+	MeshFileRange Indices; // index stream
+	MeshFileRange Submeshes; // MeshFileSubmesh table
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MeshFileDesc structure (input of MeshFile::Write)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct MeshFileDesc
+{
+	uint32_t VertexCount; // vertices of every stream
+	uint32_t StreamCount; // used entries of pStreams/Strides/Layouts
+	const void* pStreams[MeshFileMaxStreams]; // vertex data
+	uint32_t Strides[MeshFileMaxStreams]; // bytes per vertex
+	MeshVertexLayout Layouts[MeshFileMaxStreams]; // element layout of each stream
+	const void* pIndices; // index data
+	uint32_t IndexCount; // number of indices
+	GfxFormat IndexFormat; // R16_Uint or R32_Uint
+	const MeshFileSubmesh* pSubmeshes; // submesh table
+	uint32_t SubmeshCount; // entries of pSubmeshes
+	float BoundsMin[3]; // lower corner of all positions
+	float BoundsMax[3]; // upper corner of all positions
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MeshFile class
+//
+// Binary mesh container read through a file mapping. Open() validates the header and the table ranges and
+// nothing else, so the vertex and index streams are handed out as pointers into the mapping and can be
+// copied straight into upload memory. The pointers stay valid until Close().
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class MeshFile
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	/* NOTHING */
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	MeshFile();
+
+	// sequential suits loaders that copy every stream once
+	bool Open(const char* path, bool sequential = true);
+	void Close();
+
+	bool IsOpen() const { return m_pHeader != nullptr; }
+	const MeshFileHeader& GetHeader() const { return *m_pHeader; }
+	const void* GetStreamData(uint32_t stream) const { return m_File.GetData() + m_pHeader->Streams[stream].Offset; }
+	const void* GetIndexData() const { return m_File.GetData() + m_pHeader->Indices.Offset; }
+	const MeshFileSubmesh* GetSubmeshes() const { return reinterpret_cast<const MeshFileSubmesh*>(m_File.GetData() + m_pHeader->Submeshes.Offset); }
+
+	// bytes per index of the format
+	static uint32_t GetIndexSize(GfxFormat format);
+
+	// bytes per vertex of the layout (0 for unknown layouts)
+	static uint32_t GetVertexSize(MeshVertexLayout layout);
+
+	static bool Write(const char* path, const MeshFileDesc& desc);
+
+	// header and tables of a whole file in memory (pData aligned like the header), the streams aren't read
+	static bool IsValid(const void* pData, uint64_t size);
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	MappedFile m_File; // mapping of the whole file
+	const MeshFileHeader* m_pHeader; // start of the mapping (nullptr until validated)
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	/* NOTHING */
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// VertexCacheStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct VertexCacheStats
+{
+	uint32_t VerticesShaded; // post-transform cache misses
+	float ACMR; // average cache miss ratio, shaded vertices per triangle (0.5 ... 3, lower is better)
+	float ATVR; // average transformed vertex ratio, shaded vertices per referenced vertex (1 is ideal)
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// VertexFetchStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct VertexFetchStats
+{
+	uint64_t BytesFetched; // cache lines loaded by shaded vertices, in bytes
+	float Overfetch; // bytes fetched per byte of referenced vertex data (1 is ideal)
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MeshOptimizer class
+//
+// Offline reordering of indexed triangle lists, applied in this order:
+//   OptimizeVertexCache() - triangle order for the post-transform cache (Forsyth's linear-speed scoring)
+//   OptimizeOverdraw()    - clusters of that order sorted outside-in (Sander et al.), bounded ACMR loss
+//   OptimizeVertexFetch() - vertex order of first use, unreferenced vertices are dropped
+// The analysis methods simulate a FIFO post-transform cache and a cache of 64 byte lines for the vertex
+// fetch. Scratch memory is kept between calls, one instance per thread.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class MeshOptimizer
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint32_t CacheSize = 32; // entries of the LRU cache modelled by the vertex cache optimizer
+	static const uint32_t AnalyzeCacheSize = 16; // default entries of the FIFO cache of the analysis
+	static const uint32_t FetchLineSize = 64; // bytes per cache line of the fetch analysis
+	static const uint32_t FetchCacheSize = 16 * 1024; // bytes of the fetch cache of the analysis
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	MeshOptimizer();
+
+	// indices are rewritten in place, all of them must be below vertexCount
+	void OptimizeVertexCache(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount);
+
+	// run after OptimizeVertexCache(), ACMR grows by at most the threshold factor (1.05 = 5 percent)
+	void OptimizeOverdraw(uint32_t* pIndices, uint32_t indexCount, const float* pPositions, uint32_t positionStride, uint32_t vertexCount, float threshold = 1.05f);
+
+	// vertices are rewritten in place, returns the number of vertices left
+	uint32_t OptimizeVertexFetch(void* pVertices, uint32_t vertexCount, uint32_t vertexStride, uint32_t* pIndices, uint32_t indexCount);
+
+	VertexCacheStats AnalyzeVertexCache(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = AnalyzeCacheSize);
+	VertexFetchStats AnalyzeVertexFetch(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t vertexStride);
+
+	// 16-bit indices address vertices [0, 65535]
+	static bool Fits16BitIndices(uint32_t vertexCount) { return vertexCount <= 0x10000u; }
+
+	// indices must fit, see Fits16BitIndices()
+	static void Convert16BitIndices(const uint32_t* pSource, uint32_t indexCount, uint16_t* pDest);
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	std::vector<uint32_t> m_Offsets; // first entry of each vertex in m_Adjacency
+	std::vector<uint32_t> m_Adjacency; // triangles of each vertex
+	std::vector<uint32_t> m_Remaining; // triangles not emitted yet per vertex
+	std::vector<float> m_VertexScore; // score per vertex
+	std::vector<float> m_TriangleScore; // score per triangle (negative once emitted)
+	std::vector<uint32_t> m_Clusters; // first triangle of each cluster
+	std::vector<uint32_t> m_Order; // sorted clusters or vertex remap
+	std::vector<float> m_SortKeys; // sort key per cluster
+	std::vector<uint32_t> m_Stamps; // FIFO time stamp per vertex or cache line
+	std::vector<uint32_t> m_Output; // reordered indices
+	std::vector<uint8_t> m_Vertices; // reordered vertex data
+};
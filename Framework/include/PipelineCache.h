@@ -0,0 +1,152 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <MappedFile.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------------
+// Type Alias
+//--------------------------------------------------------------------------------------------------------
+using PipelineHandle = uint32_t;
+
+//--------------------------------------------------------------------------------------------------------
+// Constant Values
+//--------------------------------------------------------------------------------------------------------
+constexpr PipelineHandle InvalidPipelineHandle = 0xffffffff;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PipelineCacheStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct PipelineCacheStats
+{
+	uint64_t RequestCount; // calls of Request()
+	uint64_t HitCount; // requests of a desc which had been requested before (ready or not)
+	uint64_t LibraryLoadCount; // pipelines loaded from the disk library
+	uint64_t CompileCount; // pipelines compiled by the driver
+	uint64_t FailureCount; // pipelines which could neither be loaded nor compiled
+	uint64_t HitchCount; // calls of Get() which returned the fallback because the pipeline wasn't ready
+	double CompileMs; // time spent compiling
+	double MaxCompileMs; // longest compile
+	double LoadMs; // time spent loading from the library
+	double MaxReadyMs; // longest time from request to ready (queueing included)
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PipelineCache class
+//
+// Graphics pipelines keyed by a stable 64-bit hash of everything in their desc (bytecode, input layout,
+// states and formats; the root signature by a key of its desc since pointers differ between runs). New
+// descs are copied and compiled on background threads, Get() hands out the fallback until the pipeline
+// is ready. Compiled pipelines are stored into a pipeline library which is written to disk on Term(), so
+// that later runs load them instead of compiling. Request(), Get() and Wait() belong to one thread.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class PipelineCache
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	/* NOTHING */
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	PipelineCache();
+	~PipelineCache();
+
+	// threadCount 0 compiles inside Request(), pLibraryPath nullptr runs without disk library
+	bool Init(GfxDevice* pDevice, uint32_t threadCount, const char* pLibraryPath);
+
+	// drops queued requests, waits for running compiles and writes the library if pipelines were added
+	void Term();
+
+	// queue the pipeline of the desc unless it has been requested before (the desc is copied)
+	PipelineHandle Request(const GfxGraphicsPipelineDesc& desc, uint64_t rootSignatureKey);
+
+	// pipeline of the handle, or pFallback while it is compiling or if it failed (counted as a hitch)
+	GfxPipelineState* Get(PipelineHandle handle, GfxPipelineState* pFallback = nullptr);
+
+	// block until the pipeline is ready (a queued pipeline is compiled on the calling thread), false if it failed
+	bool Wait(PipelineHandle handle);
+	void WaitAll();
+
+	uint64_t GetKey(PipelineHandle handle) const;
+	uint32_t GetPipelineCount() const { return static_cast<uint32_t>(m_Entries.size()); }
+	uint32_t GetPendingCount() const;
+	bool HasLibrary() const { return m_pLibrary != nullptr; }
+
+	// totals since Init() (kept after Term())
+	PipelineCacheStats GetStats() const;
+
+	// stable keys (FNV-1a style over the values of the fields, never over pointers or padding)
+	static uint64_t ComputeKey(const GfxGraphicsPipelineDesc& desc, uint64_t rootSignatureKey);
+	static uint64_t ComputeKey(const GfxRootSignatureDesc& desc);
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	enum class EntryState : uint32_t
+	{
+		Queued,
+		Compiling,
+		Ready,
+		Failed
+	};
+
+	struct Entry
+	{
+		uint64_t Key; // key of the desc
+		std::atomic<EntryState> State; // progress, Ready publishes pPipelineState
+		GfxPtr<GfxPipelineState> pPipelineState; // compiled or loaded pipeline
+		GfxGraphicsPipelineDesc Desc; // copy of the desc pointing into the members below (freed when done)
+		std::vector<GfxInputElementDesc> Elements; // input layout
+		std::string SemanticNames; // semantic names back to back with their terminators
+		std::vector<uint8_t> Bytecode; // vertex shader followed by pixel shader
+		std::chrono::steady_clock::time_point RequestTime; // time of the first request
+	};
+
+	GfxDevice* m_pDevice; // device the pipelines are created on
+	std::vector<std::unique_ptr<Entry>> m_Entries; // entries by handle
+	std::unordered_map<uint64_t, PipelineHandle> m_Lookup; // handle by key
+	std::vector<std::thread> m_Threads; // compile threads
+	mutable std::mutex m_Mutex; // guards m_Queue, m_Stats and m_Quit
+	std::condition_variable m_WakeCondition; // signaled on new requests or quit
+	std::condition_variable m_DoneCondition; // signaled when a pipeline is ready or failed
+	std::deque<Entry*> m_Queue; // entries waiting for a compile thread
+	PipelineCacheStats m_Stats; // totals since Init()
+	bool m_Quit; // whether compile threads should exit
+	GfxPtr<GfxPipelineLibrary> m_pLibrary; // pipelines stored on disk (nullptr without)
+	MappedFile m_LibraryFile; // serialized library, referenced by m_pLibrary
+	std::string m_LibraryPath; // path of the library file
+	std::atomic<bool> m_LibraryDirty; // whether pipelines were stored since the file was read
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	void ThreadMain();
+	void Compile(Entry& entry);
+	void OpenLibrary();
+	bool SaveLibrary();
+};
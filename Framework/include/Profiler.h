@@ -0,0 +1,125 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <cstdint>
+
+
+//--------------------------------------------------------------------------------------------------------
+// Switches
+//--------------------------------------------------------------------------------------------------------
+
+// 0 compiles PROFILE_SCOPE away entirely, the profiler itself stays available for GPU events and export
+#if !defined(PROFILER_ENABLED)
+#define PROFILER_ENABLED 1
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ProfileEvent structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct ProfileEvent
+{
+	const char* Name; // static string naming the scope
+	uint64_t BeginNs; // steady_clock time in nanoseconds
+	uint64_t EndNs; // steady_clock time in nanoseconds
+	uint32_t Depth; // number of scopes open around it on the same track
+	uint32_t Padding;
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Profiler class
+//
+// Hierarchical scopes recorded per thread. Every thread appends to a buffer of its own which is
+// registered once under a lock, after that a scope costs two clock reads and a store without any
+// synchronization. Events are published with a release store of the count, so WriteChromeTrace() may
+// run while other threads keep recording. GPU regions are added to a track of their own (see GpuProfiler).
+// Names must be string literals or otherwise outlive the profiler.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class Profiler
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint32_t ChunkEventCount = 4096; // events per allocation of a track
+	static const uint32_t MaxChunkCount = 256; // chunks per track, events beyond are dropped and counted
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+
+	// recording is off until enabled, disabled scopes cost a call and a relaxed load
+	static void SetEnabled(bool enabled);
+	static bool IsEnabled();
+
+	// name of the calling thread's track ("Thread N" until set)
+	static void SetThreadName(const char* name);
+
+	// steady_clock time in nanoseconds
+	static uint64_t Now();
+
+	// scopes of the calling thread (use PROFILE_SCOPE rather than calling these directly)
+	static uint32_t BeginScope();
+	static void EndScope(const char* name, uint64_t beginNs, uint32_t depth);
+
+	// region which ran on the GPU, in steady_clock nanoseconds
+	static void AddGpuEvent(const char* name, uint64_t beginNs, uint64_t endNs, uint32_t depth);
+
+	// forget recorded events, no scope may be open on another thread meanwhile
+	static void Reset();
+
+	// events recorded so far on every track and events lost to full tracks
+	static uint64_t GetEventCount();
+	static uint64_t GetDroppedCount();
+
+	// write every track as Chrome trace event JSON (chrome://tracing, ui.perfetto.dev)
+	static bool WriteChromeTrace(const char* path);
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ProfileScope class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const char* name)
+		: m_Name(name)
+		, m_Depth(Profiler::IsEnabled() ? Profiler::BeginScope() : UINT32_MAX)
+		, m_BeginNs((m_Depth != UINT32_MAX) ? Profiler::Now() : 0)
+	{ /* DO_NOTHING */ }
+
+	~ProfileScope()
+	{
+		if (m_Depth != UINT32_MAX)
+		{
+			Profiler::EndScope(m_Name, m_BeginNs, m_Depth);
+		}
+	}
+
+private:
+	const char* m_Name; // name of the scope
+	uint32_t m_Depth; // depth on the thread's track, UINT32_MAX while disabled
+	uint64_t m_BeginNs; // start time
+};
+
+
+//--------------------------------------------------------------------------------------------------------
+// Macros
+//--------------------------------------------------------------------------------------------------------
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILER_ENABLED
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,356 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------------
+// Enumerations
+//--------------------------------------------------------------------------------------------------------
+enum class RecordOp : uint16_t
+{
+	// device
+	CreateCommandQueue,
+	CreateSwapChain,
+	CreateCommandAllocator,
+	CreateCommandList,
+	CreateFence,
+	CreateDescriptorHeap,
+	CreateBuffer,
+	CreateRootSignature,
+	CreateGraphicsPipelineState,
+	CreateConstantBufferView,
+	CreateRenderTargetView,
+	CopyDescriptors,
+	CreatePipelineLibrary,
+	LoadGraphicsPipeline,
+	CreateQueryHeap,
+	CreateHeap,
+	CreatePlacedBuffer,
+
+	// command list
+	Reset,
+	Close,
+	ResourceBarrier,
+	OMSetRenderTargets,
+	ClearRenderTargetView,
+	SetGraphicsRootSignature,
+	SetDescriptorHeaps,
+	SetGraphicsRootConstantBufferView,
+	SetGraphicsRootDescriptorTable,
+	SetPipelineState,
+	IASetPrimitiveTopology,
+	IASetVertexBuffers,
+	IASetIndexBuffer,
+	RSSetViewports,
+	RSSetScissorRects,
+	DrawIndexedInstanced,
+	EndQuery,
+	ResolveQueryData,
+	CopyBufferRegion,
+
+	// queue and swap chain
+	ExecuteCommandLists,
+	Signal,
+	Wait,
+	Present,
+
+	Count
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Record payloads
+//
+// Every record is a RecordHeader followed by Size bytes of payload, padded to 4 bytes. Objects are
+// referenced by the id the recording device assigned on creation. Variable length payloads start with
+// the fixed part below and are followed by Count elements.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct RecordHeader
+{
+	uint16_t Op; // RecordOp
+	uint16_t Reserved; // zero, keeps the payload 4-byte aligned
+	uint32_t Size; // size of payload in bytes (batches of thousands of barriers don't fit in 16 bits)
+};
+
+struct RecordCreate
+{
+	uint32_t Id; // id of the created object
+	uint32_t Param; // type, count or format depending on the op
+	uint64_t Size; // size in bytes for buffers
+};
+
+struct RecordCreatePlaced
+{
+	uint32_t Id; // id of the created buffer
+	uint32_t HeapId; // id of the heap
+	uint64_t Offset; // offset in the heap
+	uint64_t Size; // size in bytes
+};
+
+struct RecordCreateView
+{
+	uint64_t Location; // GPU address or resource id
+	uint64_t Dest; // destination CPU descriptor handle
+	uint32_t Param; // size in bytes or format
+	uint32_t Padding;
+};
+
+struct RecordObject
+{
+	uint32_t Id; // id of the object, 0 for nullptr
+};
+
+struct RecordCount
+{
+	uint32_t Start; // start slot (where applicable)
+	uint32_t Count; // number of trailing elements
+};
+
+struct RecordBarrier
+{
+	uint32_t ResourceId;
+	uint32_t Subresource;
+	uint32_t StateBefore;
+	uint32_t StateAfter;
+	uint32_t Flags;
+	uint32_t Type; // GfxResourceBarrierType
+};
+
+struct RecordClear
+{
+	uint64_t Handle;
+	float Color[4];
+};
+
+struct RecordRootCBV
+{
+	uint32_t RootParameterIndex;
+	uint32_t Padding;
+	uint64_t BufferLocation;
+};
+
+struct RecordCopyDescriptors
+{
+	uint64_t Dest; // first destination CPU descriptor handle
+	uint64_t Src; // first source CPU descriptor handle
+	uint32_t NumDescriptors;
+	uint32_t Type; // GfxDescriptorHeapType
+};
+
+struct RecordDrawIndexed
+{
+	uint32_t IndexCountPerInstance;
+	uint32_t InstanceCount;
+	uint32_t StartIndexLocation;
+	int32_t BaseVertexLocation;
+	uint32_t StartInstanceLocation;
+};
+
+struct RecordQuery
+{
+	uint32_t QueryHeapId;
+	uint32_t StartIndex;
+	uint32_t NumQueries; // 1 for EndQuery
+	uint32_t DestId; // destination buffer (0 for EndQuery)
+	uint64_t DestOffset;
+};
+
+struct RecordCopy
+{
+	uint32_t DstId;
+	uint32_t SrcId;
+	uint64_t DstOffset;
+	uint64_t SrcOffset;
+	uint64_t NumBytes;
+};
+
+struct RecordSignal // Signal and Wait
+{
+	uint32_t FenceId;
+	uint32_t Padding;
+	uint64_t Value;
+};
+
+struct RecordPresent
+{
+	uint32_t SyncInterval;
+	uint32_t BackBufferIndex;
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordStream class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class RecordStream
+{
+public:
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	RecordStream();
+
+	// keeps the capacity so that steady-state recording does not allocate
+	void Clear();
+
+	// reserve a record and return the pointer to its payload
+	void* Allocate(RecordOp op, uint32_t payloadSize);
+
+	// append records of another stream
+	void Append(const RecordStream& other);
+
+	template<typename T> void Write(RecordOp op, const T& payload)
+	{
+		memcpy(Allocate(op, sizeof(T)), &payload, sizeof(T));
+	}
+
+	template<typename THead, typename TElem> void Write(RecordOp op, const THead& head, uint32_t count, const TElem* pElems)
+	{
+		uint8_t* ptr = static_cast<uint8_t*>(Allocate(op, static_cast<uint32_t>(sizeof(THead) + sizeof(TElem) * count)));
+		memcpy(ptr, &head, sizeof(THead));
+		if (count > 0)
+		{
+			memcpy(ptr + sizeof(THead), pElems, sizeof(TElem) * count);
+		}
+	}
+
+	// visit every record as func(RecordOp op, const void* pPayload, uint32_t size)
+	template<typename Func> void ForEach(Func func) const
+	{
+		size_t offset = 0;
+		while (offset < m_Buffer.size())
+		{
+			RecordHeader header;
+			memcpy(&header, m_Buffer.data() + offset, sizeof(header));
+			func(static_cast<RecordOp>(header.Op), m_Buffer.data() + offset + sizeof(header), header.Size);
+			offset += sizeof(header) + AlignSize(header.Size);
+		}
+	}
+
+	const uint8_t* GetData() const { return m_Buffer.data(); }
+	size_t GetSize() const { return m_Buffer.size(); }
+	uint32_t GetCommandCount() const { return m_CommandCount; }
+
+	static uint32_t AlignSize(uint32_t size) { return (size + 3u) & ~3u; }
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	std::vector<uint8_t> m_Buffer; // packed records
+	uint32_t m_CommandCount; // number of records
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct RecordStats
+{
+	uint64_t FrameCount; // number of presented frames
+	uint64_t CommandCount; // number of recorded commands
+	uint64_t ByteCount; // number of recorded bytes
+	uint64_t OpCount[static_cast<size_t>(RecordOp::Count)]; // number of commands per op
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordingDevice class
+//
+// Headless backend. Every device, queue and command list call is encoded into a compact RecordStream
+// and the simulated GPU completes work as soon as it is signaled, unless it is given a time per submission:
+// then submissions run back to back on a simulated GPU timeline and fences complete when it gets there. The stream of the frame currently being
+// built is swapped out on Present so memory stays bounded however long the loop runs. Pipeline creation
+// can be given a simulated compile time so that caches and background compilation have something to hide.
+// Timestamps are steady_clock nanoseconds spread over the submission's slot on the GPU timeline by
+// command index, and resolves copy them to the buffer when the command lists are executed.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class RecordingDevice : public GfxDevice
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	friend class RecordingCommandQueue;
+	friend class RecordingSwapChain;
+	friend class RecordingPipelineLibrary;
+
+public:
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	RecordingDevice();
+	~RecordingDevice() override;
+
+	GfxBackend GetBackend() const override { return GfxBackend::Recording; }
+	bool IsHeadless() const override { return true; }
+
+	bool CreateCommandQueue(GfxCommandListType type, GfxPtr<GfxCommandQueue>& pQueue) override;
+	bool CreateSwapChain(GfxCommandQueue* pQueue, const GfxSwapChainDesc& desc, GfxPtr<GfxSwapChain>& pSwapChain) override;
+	bool CreateCommandAllocator(GfxCommandListType type, GfxPtr<GfxCommandAllocator>& pAllocator) override;
+	bool CreateCommandList(GfxCommandListType type, GfxCommandAllocator* pAllocator, GfxPtr<GfxCommandList>& pCmdList) override;
+	bool CreateFence(uint64_t initialValue, GfxPtr<GfxFence>& pFence) override;
+	bool CreateDescriptorHeap(const GfxDescriptorHeapDesc& desc, GfxPtr<GfxDescriptorHeap>& pHeap) override;
+	bool CreateBuffer(const GfxBufferDesc& desc, GfxPtr<GfxResource>& pResource) override;
+	bool CreateHeap(const GfxHeapDesc& desc, GfxPtr<GfxHeap>& pHeap) override;
+	bool CreatePlacedBuffer(GfxHeap* pHeap, uint64_t offset, const GfxBufferDesc& desc, GfxPtr<GfxResource>& pResource) override;
+	bool CreateRootSignature(const GfxRootSignatureDesc& desc, GfxPtr<GfxRootSignature>& pRootSignature) override;
+	bool CreateGraphicsPipelineState(const GfxGraphicsPipelineDesc& desc, GfxPtr<GfxPipelineState>& pPipelineState) override;
+	bool CreatePipelineLibrary(const void* pBlob, size_t blobSize, GfxPtr<GfxPipelineLibrary>& pLibrary) override;
+	bool CreateTimestampQueryHeap(uint32_t count, GfxPtr<GfxQueryHeap>& pQueryHeap) override;
+
+	uint32_t GetDescriptorHandleIncrementSize(GfxDescriptorHeapType type) const override;
+	void CreateConstantBufferView(const GfxConstantBufferViewDesc& desc, GfxCpuDescriptorHandle destDescriptor) override;
+	void CreateRenderTargetView(GfxResource* pResource, GfxFormat format, GfxCpuDescriptorHandle destDescriptor) override;
+	void CopyDescriptorsSimple(
+		uint32_t numDescriptors,
+		GfxCpuDescriptorHandle destDescriptorRangeStart,
+		GfxCpuDescriptorHandle srcDescriptorRangeStart,
+		GfxDescriptorHeapType type) override;
+
+	// records of the frame being built
+	const RecordStream& GetStream() const { return m_Stream; }
+
+	// records of the last presented frame
+	const RecordStream& GetLastFrameStream() const { return m_LastFrameStream; }
+
+	// totals since creation
+	const RecordStats& GetStats() const { return m_Stats; }
+
+	// time CreateGraphicsPipelineState() blocks the calling thread for, like a driver compile (loads are free)
+	void SetPipelineCompileTime(uint32_t microseconds) { m_PipelineCompileTime = microseconds; }
+
+	// time the simulated GPU spends on each ExecuteCommandLists(), varied uniformly by up to jitter (0 is instant)
+	void SetGpuWorkTime(uint32_t microseconds, uint32_t jitterMicroseconds);
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	RecordStream m_Stream; // records of the frame being built
+	RecordStream m_LastFrameStream; // records of the last presented frame
+	RecordStats m_Stats; // totals since creation
+	std::mutex m_Mutex; // guards m_Stream and the counters below (objects are created from any thread)
+	std::atomic<uint32_t> m_NextId; // id given to the next object
+	uint32_t m_NextHeapIndex; // index given to the next descriptor heap
+	GfxGpuVirtualAddress m_NextAddress; // virtual address given to the next buffer
+	uint32_t m_PipelineCompileTime; // simulated compile time of a pipeline in microseconds
+	uint32_t m_GpuWorkTime; // simulated time of a submission in microseconds
+	uint32_t m_GpuJitter; // largest deviation from m_GpuWorkTime in microseconds
+	uint32_t m_GpuSeed; // state of the generator varying the submission times
+	std::chrono::steady_clock::time_point m_GpuIdleTime; // time the simulated GPU finishes the work submitted so far
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	uint32_t NewId();
+	bool LoadGraphicsPipeline(uint32_t libraryId, GfxPtr<GfxPipelineState>& pPipelineState);
+	void Submit(const RecordStream& stream);
+	std::chrono::steady_clock::time_point ScheduleGpuWork();
+	void EndFrame();
+};
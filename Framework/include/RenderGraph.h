@@ -0,0 +1,247 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <CommandListPool.h>
+#include <DeferredReleaseQueue.h>
+#include <ResourceStateTracker.h>
+#include <TlsfAllocator.h>
+#include <WorkerPool.h>
+#include <functional>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RenderGraphStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct RenderGraphStats
+{
+	uint32_t PassCount; // passes declared
+	uint32_t CulledCount; // passes whose results nobody used
+	uint32_t JobCount; // command lists recorded
+	uint32_t TransientCount; // transient resources used by the kept passes
+	uint32_t TransientBufferCount; // placed buffers backing them (same range and size share one)
+	uint64_t TransientHeapSize; // bytes of the heap the transients are placed in
+	uint32_t AliasCount; // transients placed over memory an earlier transient of the frame used
+	uint32_t SplitCount; // split barriers begun right after the previous use
+	uint32_t HandoverCount; // transitions at the end of a list for the first use in a later list
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RenderGraph class
+//
+// Passes of a frame declared with the resources they read and write, in the order they take effect.
+// Compile() culls the passes nothing depends on (passes with side effects and writers of imported
+// resources always stay), merges consecutive reads into one combined read state, computes the lifetimes
+// of the transient buffers and places them in one heap with a TlsfAllocator, so that buffers whose
+// lifetimes don't overlap alias the same memory (an aliasing barrier precedes the first use of a buffer
+// over memory an earlier one used), and splits the
+// passes into jobs: passes follow each other in one command list, parallel passes spread their parts
+// over several lists. Record() records the jobs in parallel through a CommandListPool with state
+// trackers. Every pass transitions its resources before it executes, a transition to a pass further
+// down the same list is begun as a split barrier right after the previous use, and a state a later list
+// starts with is handed over at the end of the list that used the resource last (the first list for a
+// resource the frame hasn't used yet), so that no fix-up list is needed at submission. The graph is
+// declared again every frame, the storage is kept between frames.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class RenderGraph
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	using ExecuteFunc = std::function<void(GfxCommandList* pCmdList, uint32_t part, uint32_t partCount)>;
+
+	static const uint32_t InvalidHandle = UINT32_MAX; // resource or pass that couldn't be declared
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	RenderGraph();
+	~RenderGraph();
+
+	// transient buffers are created on pDevice and registered in pStates, memory the graph replaces goes
+	// through pReleaseQueue (released at once without one)
+	bool Init(GfxDevice* pDevice, ResourceStates* pStates, DeferredReleaseQueue* pReleaseQueue = nullptr);
+
+	// the GPU is idle
+	void Term();
+
+	// start declaring a frame
+	void Reset();
+
+	// resource owned outside of the graph (its state is taken from the ResourceStates)
+	uint32_t ImportResource(const char* name, GfxResource* pResource);
+
+	// buffer only valid within the frame, created (or reused) by Compile() when a kept pass uses it
+	uint32_t CreateBuffer(const char* name, uint64_t size);
+
+	// partCount above 1 records the pass into that many command lists in parallel
+	uint32_t AddPass(const char* name, ExecuteFunc execute, uint32_t partCount = 1);
+	void Read(uint32_t pass, uint32_t resource, GfxResourceState state, uint32_t subresource = GfxAllSubresources);
+	void Write(uint32_t pass, uint32_t resource, GfxResourceState state, uint32_t subresource = GfxAllSubresources);
+
+	// the pass is kept even when nothing reads what it writes (presentation, readbacks)
+	void SetSideEffect(uint32_t pass);
+
+	// false when a kept pass reads a transient buffer before anything has written it, memory replaced by
+	// the frame is released once the GPU reaches fenceValue
+	bool Compile(uint32_t maxListCount, uint64_t fenceValue = 0);
+
+	// records the jobs (cmdLists has to be initialized with the same ResourceStates)
+	void Record(WorkerPool& workers, CommandListPool& cmdLists, uint32_t frameIndex);
+
+	bool IsPassCulled(uint32_t pass) const { return m_Passes[pass].Culled; }
+	uint32_t GetPartCount(uint32_t pass) const { return m_Passes[pass].PartCount; }
+	GfxResource* GetResource(uint32_t resource) const { return m_Resources[resource].pResource; }
+
+	// first and last kept pass using the resource, false when no kept pass does
+	bool GetLifetime(uint32_t resource, uint32_t& firstPass, uint32_t& lastPass) const;
+
+	// results of the last Compile()
+	const RenderGraphStats& GetStats() const { return m_Stats; }
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Use structure - resource access of a pass
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Use
+	{
+		uint32_t Resource; // handle of the resource
+		uint32_t Subresource; // subresource index or GfxAllSubresources
+		GfxResourceState State; // state the pass needs (combined with the reads next to it by Compile())
+		bool Write; // whether the pass changes the contents
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Pass structure
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Pass
+	{
+		const char* Name; // name in the profiler
+		ExecuteFunc Execute; // records the commands of a part
+		std::vector<Use> Uses; // resources the pass accesses (kept across Reset() to reuse the storage)
+		uint32_t PartCount; // command lists of the pass (clamped by Compile())
+		bool SideEffect; // never culled
+		bool Culled; // result of Compile()
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Resource structure
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Resource
+	{
+		const char* Name; // name of the resource
+		GfxResource* pResource; // imported resource or transient buffer assigned by Compile()
+		uint64_t Size; // size of a transient buffer
+		bool Imported; // owned outside of the graph
+		uint32_t FirstPass; // first kept pass using it (InvalidHandle when none)
+		uint32_t LastPass; // last kept pass using it
+		uint32_t Storage; // first resource of the frame on the same buffer (itself when imported)
+		TlsfAllocation Range; // range of the transient heap
+		bool Aliased; // an earlier transient of the frame used part of the range
+		uint32_t FirstItem; // item of the first use (InvalidHandle when none)
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// TransientBuffer structure
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct TransientBuffer
+	{
+		GfxPtr<GfxResource> pBuffer; // buffer placed in the transient heap
+		uint64_t Offset; // offset in the heap
+		uint64_t Size; // size of the buffer
+		bool Used; // whether a resource of the frame is on it
+		uint32_t Owner; // first resource assigned in the frame
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Item structure - part of a pass recorded into a job
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Item
+	{
+		uint32_t Pass; // pass index
+		uint32_t Part; // part of the pass
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Job structure - items of a command list
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Job
+	{
+		uint32_t FirstItem; // first entry of m_Items
+		uint32_t ItemCount; // entries of m_Items
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Transition structure - transition placed after an item or at the end of a job
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Transition
+	{
+		uint32_t Index; // item (split barriers) or job (handovers)
+		uint32_t Resource; // handle of the resource
+		uint32_t Subresource; // subresource index or GfxAllSubresources
+		GfxResourceState State; // state of the next use
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// LastUse structure - latest access of a subresource while Compile() walks the items
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct LastUse
+	{
+		uint32_t Resource; // handle of the resource
+		uint32_t Subresource; // subresource index or GfxAllSubresources
+		uint32_t Item; // item of the access
+		uint32_t Job; // job of the access
+		GfxResourceState State; // state of the access
+		uint32_t RunStart; // first pass of the reads since the last write
+		uint32_t RunLength; // reads since the last write
+		uint32_t RunState; // read states of the run combined
+		bool RunCombinable; // whether every state of the run is a read state
+	};
+
+	GfxDevice* m_pDevice; // device the transient buffers are created on
+	ResourceStates* m_pStates; // committed states of imported and transient resources
+	DeferredReleaseQueue* m_pReleaseQueue; // replaced heaps and buffers (nullptr to release at once)
+	GfxPtr<GfxHeap> m_pHeap; // memory of the transient buffers
+	std::vector<Pass> m_Passes; // declared passes (kept across Reset() to reuse the storage)
+	uint32_t m_PassCount; // valid entries of m_Passes
+	std::vector<Resource> m_Resources; // declared resources
+	std::vector<TransientBuffer> m_Buffers; // buffers backing transient resources, kept across frames
+	std::vector<uint32_t> m_Order; // transient resources by first pass (scratch of Compile())
+	std::vector<uint32_t> m_Active; // transients placed and not over yet (scratch of Compile())
+	TlsfAllocator m_Placement; // ranges of the transient heap (scratch of Compile())
+	std::vector<uint32_t> m_Pages; // transient placed last on each 64 KB of the heap (scratch of Compile())
+	std::vector<Item> m_Items; // items in submission order
+	std::vector<Job> m_Jobs; // jobs in submission order
+	std::vector<Transition> m_Splits; // split barriers by item
+	std::vector<Transition> m_Handovers; // transitions by job
+	std::vector<LastUse> m_LastUses; // scratch of Compile()
+	std::vector<bool> m_Needed; // scratch of the culling
+	RenderGraphStats m_Stats; // results of the last Compile()
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	void AddUse(uint32_t pass, uint32_t resource, GfxResourceState state, uint32_t subresource, bool write);
+	void Cull();
+	bool CombineReads();
+	void FinishReadRun(LastUse& last, uint32_t end);
+	bool AssignBuffers(uint64_t fenceValue);
+	void ReleaseBuffer(TransientBuffer& buffer, uint64_t fenceValue);
+	void BuildJobs(uint32_t maxListCount);
+	void PlaceTransitions();
+	LastUse& FindLastUse(uint32_t resource, uint32_t subresource);
+	void RecordJob(ResourceStateTracker* pTracker, GfxCommandList* pCmdList, uint32_t jobIndex);
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------------
+// Forward Declarations
+//--------------------------------------------------------------------------------------------------------
+class ResourceStateTracker;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ResourceBarrierStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct ResourceBarrierStats
+{
+	uint64_t BarrierCount; // barriers recorded (each half of a split barrier counts)
+	uint64_t BatchCount; // ResourceBarrier() calls
+	uint64_t ElidedCount; // transitions dropped because the state already matched or was merged away
+	uint64_t FixupCount; // barriers of first uses resolved at submission (part of BarrierCount)
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ResourceStates class
+//
+// States of the resources as of the command lists submitted so far. Resolve() has to be called for every
+// tracked command list in submission order: it returns the barriers that bring the resources from their
+// committed states to the states the list expected on first use, then takes the states the list left
+// them in. Resources that are never registered are not tracked across command lists.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class ResourceStates
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	/* NOTHING */
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	ResourceStates();
+	~ResourceStates();
+
+	// every subresource starts in state
+	void Register(GfxResource* pResource, GfxResourceState state, uint32_t subresourceCount = 1);
+	void Unregister(GfxResource* pResource);
+	void Clear();
+
+	// 1 for resources that are not registered
+	uint32_t GetSubresourceCount(GfxResource* pResource) const;
+
+	// false for resources that are not registered
+	bool GetState(GfxResource* pResource, uint32_t subresource, GfxResourceState& state) const;
+
+	// appends the barriers the list needs in front of it, then commits the list's final states
+	void Resolve(const ResourceStateTracker& tracker, std::vector<GfxResourceBarrier>& fixups);
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	mutable std::mutex m_Mutex; // guards m_States (lists look states up while recording in parallel)
+	std::unordered_map<GfxResource*, std::vector<GfxResourceState>> m_States; // state of each subresource
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	/* NOTHING */
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ResourceStateTracker class
+//
+// States of the resources used by one command list while it is recorded. Transitions are queued and
+// written with a single ResourceBarrier() call by FlushBarriers(), which goes in front of the next draw or
+// copy. Transitions to the current state (or to read states the current read state already covers) are
+// dropped, and a queued transition that is transitioned again before the flush is merged into one.
+// The first use of a resource in a list has no known state before it: lists that start a submission look
+// it up in the ResourceStates, the others keep it pending for ResourceStates::Resolve(). Split barriers
+// are begun and ended explicitly, any other transition of the subresource in between ends them first.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class ResourceStateTracker
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	friend class ResourceStates;
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	/* NOTHING */
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	ResourceStateTracker();
+	~ResourceStateTracker();
+
+	// start of a command list, knownAtStart when no list is submitted between the committed states and it
+	void Reset(ResourceStates* pStates, bool knownAtStart);
+
+	void Transition(GfxResource* pResource, GfxResourceState state, uint32_t subresource = GfxAllSubresources);
+
+	// split barrier, the GPU may overlap the transition with the work recorded in between
+	void BeginTransition(GfxResource* pResource, GfxResourceState state, uint32_t subresource = GfxAllSubresources);
+	void EndTransition(GfxResource* pResource, uint32_t subresource = GfxAllSubresources);
+
+	// the placed resource starts using memory other placed resources used before it
+	void AliasingBarrier(GfxResource* pResourceAfter);
+
+	// records the queued barriers with one call
+	void FlushBarriers(GfxCommandList* pCmdList);
+
+	// barriers queued since the last flush
+	const std::vector<GfxResourceBarrier>& GetQueuedBarriers() const { return m_Queued; }
+
+	// first uses of resources (StateAfter is the state expected, StateBefore is unknown)
+	const std::vector<GfxResourceBarrier>& GetPendingBarriers() const { return m_Pending; }
+
+	// state of a subresource used by the list, false when the list hasn't used it
+	bool GetState(GfxResource* pResource, uint32_t subresource, GfxResourceState& state) const;
+
+	// totals since Reset()
+	const ResourceBarrierStats& GetStats() const { return m_Stats; }
+
+	// whether a resource in state current can be used as requested without a barrier
+	static bool IsCovered(GfxResourceState current, GfxResourceState requested);
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	static const uint8_t StateKnown = 0x1; // the list has used the subresource
+	static const uint8_t StateSplit = 0x2; // a split barrier has begun and not ended
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// SubresourceState structure
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct SubresourceState
+	{
+		GfxResourceState State; // current state (the target while a split barrier is in progress)
+		GfxResourceState SplitBefore; // state before the split barrier in progress
+		uint8_t Flags; // StateKnown and StateSplit
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Entry structure
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Entry
+	{
+		GfxResource* pResource; // resource used by the list
+		std::vector<SubresourceState> Subresources; // state of each subresource
+	};
+
+	ResourceStates* m_pStates; // committed states (subresource counts and, for the first list, states)
+	bool m_KnownAtStart; // whether first uses take their state from m_pStates
+	std::vector<Entry> m_Entries; // resources used by the list (kept across Reset() to reuse the storage)
+	uint32_t m_EntryCount; // valid entries of m_Entries
+	std::vector<GfxResourceBarrier> m_Queued; // barriers of the next flush
+	std::vector<GfxResourceBarrier> m_Pending; // first uses left to ResourceStates::Resolve()
+	ResourceBarrierStats m_Stats; // totals since Reset()
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	Entry& FindEntry(GfxResource* pResource);
+	const Entry* FindEntry(GfxResource* pResource) const;
+	void TransitionSubresource(Entry& entry, uint32_t index, GfxResourceState state, GfxResourceBarrierFlags flags);
+	void EndSplit(Entry& entry, uint32_t index);
+	void Queue(GfxResource* pResource, uint32_t subresource, GfxResourceState before, GfxResourceState after, GfxResourceBarrierFlags flags);
+};
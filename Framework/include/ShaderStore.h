@@ -0,0 +1,141 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <MappedFile.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------------
+// Constant Values
+//--------------------------------------------------------------------------------------------------------
+constexpr uint32_t ShaderStoreMagic = 0x52444853u; // "SHDR" read as little endian
+constexpr uint32_t ShaderStoreVersion = 1; // bumped whenever the layout below changes
+constexpr uint64_t ShaderStoreAlignment = 16; // placement of the table and of every blob in the file
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ShaderStoreEntry structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct ShaderStoreEntry
+{
+	uint64_t PermutationKey; // ShaderStore::ComputePermutationKey() of the name (the table is sorted by it)
+	uint64_t ContentHash; // ShaderStore::ComputeContentHash() of the bytecode
+	uint64_t Offset; // of the bytecode from the start of the file (shared by equal content)
+	uint64_t Size; // of the bytecode in bytes
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ShaderStoreHeader structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct ShaderStoreHeader
+{
+	uint32_t Magic; // ShaderStoreMagic
+	uint32_t Version; // ShaderStoreVersion
+	uint32_t EntryCount; // number of permutations
+	uint32_t BlobCount; // number of distinct bytecode blobs
+	uint64_t FileSize; // size of the whole file
+	uint64_t EntriesOffset; // of the ShaderStoreEntry table
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ShaderStoreSource structure (input of ShaderStore::Write)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct ShaderStoreSource
+{
+	const char* pName; // permutation name, e.g. "SimpleVS" or "Lit|SKINNED=1"
+	const void* pBytecode; // compiled shader
+	size_t Size; // of the compiled shader in bytes
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ShaderStore class
+//
+// Compiled shaders of all permutations packed into one file which is mapped on startup: a table sorted by
+// permutation key points at the blobs, and permutations with identical bytecode share one blob. Lookups
+// return pointers into the mapping, so nothing is read or copied until the bytecode is used. Loose files
+// and watched sources override the packed bytecode; PollChanges() rebuilds changed sources and swaps in
+// the new bytecode. Bytecode of a permutation stays valid until it is reloaded or the store is closed.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class ShaderStore
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	/* NOTHING */
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	ShaderStore();
+
+	// map and validate a packed file
+	bool Open(const char* path);
+
+	// unmap and forget loose files and watches
+	void Close();
+
+	// read a loose bytecode file as the permutation (used over the packed bytecode)
+	bool LoadFile(const char* pName, const char* pBytecodePath);
+
+	// bytecode of the permutation ({ nullptr, 0 } if unknown)
+	GfxShaderBytecode Find(uint64_t permutationKey) const;
+	GfxShaderBytecode Find(const char* pName) const { return Find(ComputePermutationKey(pName)); }
+
+	// rebuild the permutation when pSourcePath changes: run pCompileCommand (may be empty) and read pBytecodePath
+	void AddWatch(const char* pName, const char* pSourcePath, const char* pBytecodePath, const char* pCompileCommand);
+
+	// check the watched sources, returns the number of permutations which got new bytecode
+	uint32_t PollChanges();
+
+	bool IsOpen() const { return m_pHeader != nullptr; }
+	uint32_t GetEntryCount() const { return (m_pHeader != nullptr) ? m_pHeader->EntryCount : 0; }
+	uint32_t GetBlobCount() const { return (m_pHeader != nullptr) ? m_pHeader->BlobCount : 0; }
+
+	// incremented whenever PollChanges() swapped in bytecode
+	uint32_t GetGeneration() const { return m_Generation; }
+
+	static uint64_t ComputePermutationKey(const char* pName);
+	static uint64_t ComputeContentHash(const void* pData, size_t size);
+
+	// write a packed file (offline tools, not meant for the frame loop)
+	static bool Write(const char* path, const ShaderStoreSource* pSources, uint32_t count);
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	struct Watch
+	{
+		uint64_t PermutationKey; // permutation rebuilt from the source
+		std::string SourcePath; // file whose time stamp is watched
+		std::string BytecodePath; // output of the compile command
+		std::string CompileCommand; // run on change, empty when something else rebuilds the bytecode
+		std::filesystem::file_time_type LastWrite; // time stamp of the source when last checked
+	};
+
+	MappedFile m_File; // packed file
+	const ShaderStoreHeader* m_pHeader; // header in the mapping (nullptr if not open)
+	const ShaderStoreEntry* m_pEntries; // entry table in the mapping
+	std::unordered_map<uint64_t, std::vector<uint8_t>> m_Overrides; // loose and reloaded bytecode by key
+	std::vector<Watch> m_Watches; // watched sources
+	uint32_t m_Generation; // number of PollChanges() calls which swapped in bytecode
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	bool Validate() const;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <XMath.h>
+#include <cstdint>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Vertex structure (VSInput of SimpleVS.hlsl)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct Vertex
+{
+	DirectX::XMFLOAT3 Position; // position coordinates
+	DirectX::XMFLOAT4 Color; // color of vertex
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PackedVertex structure (VSInput of SimpleVS.hlsl with the quantized input layout, 12 bytes)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct PackedVertex
+{
+	int16_t Position[4]; // R16G16B16A16_SNORM, decoded with Transform::PositionScale/PositionOffset (w is 0)
+	uint8_t Color[4]; // R8G8B8A8_UNORM
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Transform structure (cbuffer Transform of SimpleVS.hlsl)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct alignas(256) Transform
+{
+	DirectX::XMMATRIX World; // world matrix
+	DirectX::XMMATRIX View; // view matrix
+	DirectX::XMMATRIX Proj; // projection matrix
+	DirectX::XMFLOAT4 PositionScale; // input position * scale + offset (1 and 0 for float positions)
+	DirectX::XMFLOAT4 PositionOffset;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// InstanceData structure (per-instance VSInput of SimpleInstancedVS.hlsl)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct InstanceData
+{
+	DirectX::XMFLOAT4X4 World; // world matrix
+	DirectX::XMFLOAT4 Color; // multiplied with the vertex color
+};
@@ -0,0 +1,139 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <ShaderTypes.h>
+#include <WorkerPool.h>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SoftRasterizerStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct SoftRasterizerStats
+{
+	uint64_t TrianglesSubmitted; // triangles passed to DrawIndexed()
+	uint64_t TrianglesCulled; // triangles dropped by culling, clipping or zero area
+	uint64_t TrianglesClipped; // triangles which went through the clipper
+	uint64_t TrianglesBinned; // triangles which reached the tiles
+	uint64_t BinEntries; // triangle references over all tiles
+	uint64_t PixelsShaded; // pixels written by the pixel stage
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SoftRasterizer class
+//
+// CPU reference of the SimpleVS/SimplePS pipeline on an R8G8B8A8_UNORM_SRGB target. Draws are vertex
+// shaded and binned into tiles as they come, EndFrame() rasterizes the tiles on a WorkerPool. Coverage
+// uses 4-bit subpixel edge functions with the top-left rule, colors are interpolated perspective-correct.
+// Triangles keep submission order within a tile, so the image doesn't depend on the number of workers.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class SoftRasterizer
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint32_t TileSize = 64; // width and height of one tile in pixels
+	static const uint32_t MaxSize = 8192; // largest width or height of the target
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	SoftRasterizer();
+	~SoftRasterizer();
+
+	bool Init(uint32_t width, uint32_t height);
+	void Term();
+
+	void SetViewport(const GfxViewport& viewport);
+	void SetCullMode(GfxCullMode cullMode, bool frontCounterClockwise);
+
+	// start a frame cleared to the linear color
+	void BeginFrame(const float clearColor[4]);
+
+	// vertex shade and bin triangle list (vertex shading is spread over workers when given)
+	void DrawIndexed(
+		const Vertex* pVertices,
+		uint32_t vertexCount,
+		const uint32_t* pIndices,
+		uint32_t indexCount,
+		const Transform& transform,
+		WorkerPool* pWorkers = nullptr);
+
+	// rasterize all tiles, the image is valid afterwards
+	void EndFrame(WorkerPool& workers);
+
+	uint32_t GetWidth() const { return m_Width; }
+	uint32_t GetHeight() const { return m_Height; }
+	uint32_t GetPitch() const { return m_Pitch; } // pixels per row
+	const uint32_t* GetPixels() const { return m_Pixels.data(); } // RGBA8 sRGB, red in the low byte
+	const SoftRasterizerStats& GetStats() const { return m_Stats; }
+	void ResetStats() { m_Stats = SoftRasterizerStats(); }
+
+	// binary PPM (alpha is dropped)
+	bool SaveImage(const char* path) const;
+
+private:
+	//====================================================================================================
+	// Private structures
+	//====================================================================================================
+	struct ClipVertex
+	{
+		float Position[4]; // clip space position
+		float Color[4]; // color
+	};
+
+	struct Plane
+	{
+		float Base; // value at the center of pixel (0, 0)
+		float DX; // change per pixel to the right
+		float DY; // change per pixel downward
+	};
+
+	struct SetupTriangle
+	{
+		int64_t EdgeA[3]; // x coefficient of the edge functions (subpixels)
+		int64_t EdgeB[3]; // y coefficient of the edge functions (subpixels)
+		int64_t EdgeC[3]; // constant of the edge functions, top-left bias included
+		int32_t MinX, MinY, MaxX, MaxY; // pixel bounds clamped to the viewport (inclusive)
+		Plane InvW; // 1/w
+		Plane ColorOverW[4]; // color/w
+	};
+
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	uint32_t m_Width; // width of the target
+	uint32_t m_Height; // height of the target
+	uint32_t m_Pitch; // width rounded up to whole tiles
+	uint32_t m_TilesX; // tiles per row
+	uint32_t m_TilesY; // tiles per column
+	std::vector<uint32_t> m_Pixels; // target (m_Pitch x whole tiles)
+	GfxViewport m_Viewport; // viewport
+	GfxCullMode m_CullMode; // cull mode
+	bool m_FrontCCW; // whether counter clockwise triangles are front faces
+	uint32_t m_ClearColor; // clear color of this frame (packed)
+	std::vector<ClipVertex> m_Shaded; // vertex shader output of the current draw
+	std::vector<SetupTriangle> m_Triangles; // triangles of this frame
+	std::vector<std::vector<uint32_t>> m_Bins; // triangle indices per tile in submission order
+	std::vector<uint64_t> m_TilePixels; // pixels shaded per tile in the last EndFrame()
+	SoftRasterizerStats m_Stats; // statistics
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	void ShadeVertices(const Vertex* pVertices, uint32_t first, uint32_t last, const DirectX::XMFLOAT4X4& wvp);
+	void ClipAndSetup(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2);
+	void SetupAndBin(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2);
+	void RasterizeTile(uint32_t tileIndex);
+	template<bool TestEdges> uint64_t RasterizeBlock(const SetupTriangle& tri, uint32_t edgeMask, int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+};
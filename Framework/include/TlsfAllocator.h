@@ -0,0 +1,131 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TlsfAllocation structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct TlsfAllocation
+{
+	uint64_t Offset; // offset of the range (aligned as requested)
+	uint64_t Size; // size of the range (the request rounded up to the granularity)
+	uint32_t Node; // block of the allocator, TlsfAllocator::InvalidNode when nothing is allocated
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TlsfStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct TlsfStats
+{
+	uint64_t Capacity; // units managed
+	uint64_t UsedSize; // units of the live allocations
+	uint64_t LargestFreeBlock; // largest range that can still be allocated at once
+	uint32_t AllocationCount; // live allocations
+	uint32_t FreeBlockCount; // free ranges (adjacent ones are always merged)
+
+	// share of the free units outside of the largest free range (0 when free memory is contiguous)
+	double GetFragmentation() const
+	{
+		uint64_t free = Capacity - UsedSize;
+		return (free > 0) ? 1.0 - static_cast<double>(LargestFreeBlock) / static_cast<double>(free) : 0.0;
+	}
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TlsfAllocator class
+//
+// Two-level segregated fit bookkeeping of a range of abstract units (bytes of a heap, offsets of a
+// transient plan...). Free blocks are kept in lists by size class, 16 classes per power of two, and two
+// bitmaps find a class with a block large enough in constant time. Sizes are rounded up to the search
+// class, so the first block of that list fits without walking it. Freed blocks are merged with their free
+// neighbours at once. Owns no memory and never talks to a device.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TlsfAllocator
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint32_t InvalidNode = UINT32_MAX; // node of an empty allocation
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	TlsfAllocator();
+	~TlsfAllocator();
+
+	// empty allocator of capacity units, offsets and sizes are multiples of granularity (power of two)
+	void Reset(uint64_t capacity, uint64_t granularity = 1);
+
+	// range of size units aligned to alignment (power of two), false when no free block is large enough
+	bool Allocate(uint64_t size, uint64_t alignment, TlsfAllocation& allocation);
+
+	// returns the range, allocation is emptied
+	void Free(TlsfAllocation& allocation);
+
+	uint64_t GetCapacity() const { return m_Capacity; }
+	uint64_t GetGranularity() const { return m_Granularity; }
+	uint32_t GetAllocationCount() const { return m_AllocationCount; }
+	bool IsEmpty() const { return m_AllocationCount == 0; }
+	TlsfStats GetStats() const;
+
+	// walks every block and checks the lists and bitmaps against them (fuzz checks)
+	bool Validate() const;
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	static const uint32_t SecondLevelBits = 4; // size classes per power of two as a shift
+	static const uint32_t SecondLevelCount = 1u << SecondLevelBits; // size classes per power of two
+	static const uint32_t FirstLevelCount = 64; // powers of two (the first one holds the smallest sizes)
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Node structure - block of the range, free or allocated
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Node
+	{
+		uint64_t Offset; // start in granules
+		uint64_t Size; // size in granules
+		uint32_t PrevPhysical; // neighbour before it (InvalidNode for the first block)
+		uint32_t NextPhysical; // neighbour after it (InvalidNode for the last block)
+		uint32_t PrevFree; // previous block of the size class list (free blocks)
+		uint32_t NextFree; // next block of the size class list (free blocks), next unused node otherwise
+		bool Free; // whether the block is in a size class list
+	};
+
+	uint64_t m_Capacity; // units managed
+	uint64_t m_Granularity; // units per granule
+	uint32_t m_GranularityShift; // log2 of m_Granularity
+	std::vector<Node> m_Nodes; // blocks (kept across Reset() to reuse the storage)
+	uint32_t m_UnusedNodes; // first node not describing a block
+	uint64_t m_FirstLevelMap; // bit per first level with a non-empty class
+	uint32_t m_SecondLevelMap[FirstLevelCount]; // bit per non-empty class of each first level
+	uint32_t m_Heads[FirstLevelCount][SecondLevelCount]; // first free block of each class
+	uint64_t m_UsedGranules; // granules of the live allocations
+	uint32_t m_AllocationCount; // live allocations
+	uint32_t m_FreeBlockCount; // blocks in the class lists
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	static void Mapping(uint64_t granules, uint32_t& firstLevel, uint32_t& secondLevel);
+	uint32_t FindFree(uint64_t granules) const;
+	void InsertFree(uint32_t node);
+	void RemoveFree(uint32_t node);
+	uint32_t NewNode();
+	void DeleteNode(uint32_t node);
+	uint32_t Split(uint32_t node, uint64_t granules);
+};
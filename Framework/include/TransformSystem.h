@@ -0,0 +1,99 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <XMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TransformOutput structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct TransformOutput
+{
+	void* pWorld; // first world matrix (nullptr to skip)
+	void* pWorldViewProj; // first world-view-projection matrix (nullptr to skip)
+	size_t Stride; // bytes from the matrices of one object to the next (at least 64)
+	bool WriteCombined; // destination is mapped upload memory, written with streaming stores
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TransformSystem class
+//
+// Position, rotation quaternion and scale of many objects stored as separate float streams, so that the
+// matrix kernels read 4 (SSE) or 8 (AVX) objects per load. Matrices come out in XMFLOAT4X4 layout,
+// equal to XMMatrixScaling * XMMatrixRotationQuaternion * XMMatrixTranslation.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TransformSystem
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint32_t LaneCount = 8; // streams are padded to a multiple of this
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	TransformSystem();
+
+	void Reserve(uint32_t capacity);
+	void Clear();
+
+	// returns the index of the new object
+	uint32_t Add(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT4& rotation, const DirectX::XMFLOAT3& scale);
+
+	void SetPosition(uint32_t index, const DirectX::XMFLOAT3& position);
+	void SetRotation(uint32_t index, const DirectX::XMFLOAT4& rotation);
+	void SetScale(uint32_t index, const DirectX::XMFLOAT3& scale);
+
+	// build the matrices of objects [first, first + count), viewProj is only read for pWorldViewProj
+	void Compute(uint32_t first, uint32_t count, const DirectX::XMMATRIX& viewProj, const TransformOutput& output) const;
+
+	// same for the objects pIndices[0...count), e.g. a visible list (matrix i belongs to pIndices[i])
+	void ComputeIndexed(const uint32_t* pIndices, uint32_t count, const DirectX::XMMATRIX& viewProj, const TransformOutput& output) const;
+
+	uint32_t GetCount() const { return m_Count; }
+
+	// streams for batch updates (valid up to GetCount())
+	float* GetPositionX() { return m_Streams[PositionX].data(); }
+	float* GetPositionY() { return m_Streams[PositionY].data(); }
+	float* GetPositionZ() { return m_Streams[PositionZ].data(); }
+	float* GetRotationX() { return m_Streams[RotationX].data(); }
+	float* GetRotationY() { return m_Streams[RotationY].data(); }
+	float* GetRotationZ() { return m_Streams[RotationZ].data(); }
+	float* GetRotationW() { return m_Streams[RotationW].data(); }
+	float* GetScaleX() { return m_Streams[ScaleX].data(); }
+	float* GetScaleY() { return m_Streams[ScaleY].data(); }
+	float* GetScaleZ() { return m_Streams[ScaleZ].data(); }
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	enum Stream
+	{
+		PositionX, PositionY, PositionZ,
+		RotationX, RotationY, RotationZ, RotationW,
+		ScaleX, ScaleY, ScaleZ,
+		StreamCount
+	};
+
+	std::vector<float> m_Streams[StreamCount]; // one stream per component (padded)
+	uint32_t m_Count; // number of objects
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	void Grow(uint32_t count);
+	void ComputeObjects(const uint32_t* pIndices, uint32_t first, uint32_t count, const DirectX::XMMATRIX& viewProj, const TransformOutput& output) const;
+};
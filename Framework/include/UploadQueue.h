@@ -0,0 +1,125 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <UploadRing.h>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// UploadStats structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct UploadStats
+{
+	uint64_t UploadCount; // Upload() calls
+	uint64_t UploadedBytes; // bytes staged and copied
+	uint64_t CopyCount; // CopyBufferRegion() recorded (adjacent ranges are merged into one)
+	uint64_t BatchCount; // submissions to the copy queue
+	uint64_t SyncCount; // waits of other queues on the copy queue
+	uint64_t StallCount; // CPU waits for staging memory or a command list still in flight
+	double StallMs; // time of these waits
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// UploadQueue class
+//
+// Copies data into buffers on a queue of its own, so that static data can live in default heaps instead
+// of being read over the bus from upload memory. Upload() writes the data into a staging UploadRing and
+// queues a copy (contiguous ranges of the same buffer are merged), Submit() records every queued copy
+// into one command list of the copy queue and signals its fence, and Sync() makes another queue wait for
+// the batches submitted so far on the GPU, once per new batch, without blocking the CPU. Staging memory
+// is recycled when the fence passes a batch; the CPU only waits when the ring or the command lists run
+// out. Destinations have to be buffers in the Common state (copy queues promote them to CopyDest and
+// they decay back after the batch) that the GPU doesn't use until the batch is synchronized; other
+// ranges of the same buffer may be in use meanwhile, buffers are simultaneous access. Not thread safe.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class UploadQueue
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint64_t DefaultStagingSize = 8 * 1024 * 1024; // bytes of the staging ring
+	static const uint64_t StagingAlignment = 16; // alignment of the staged ranges
+	static const uint32_t MaxBatches = 4; // submissions in flight at once
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	UploadQueue();
+	~UploadQueue();
+
+	// creates the copy queue, its fence and command lists and the staging ring
+	bool Init(GfxDevice* pDevice, uint64_t stagingSize = DefaultStagingSize);
+
+	// waits for the batches in flight
+	void Term();
+
+	// queue a copy of size bytes of pData into pDst at dstOffset (larger data is split into chunks)
+	bool Upload(GfxResource* pDst, uint64_t dstOffset, const void* pData, uint64_t size);
+
+	// submit the queued copies as one batch, returns the fence value every batch so far completes at
+	uint64_t Submit();
+
+	// pQueue starts on work submitted afterwards once the batches so far are done, false when it already
+	// waits for all of them
+	bool Sync(GfxCommandQueue* pQueue);
+
+	// recycle the staging memory of the batches done
+	void Retire();
+
+	bool IsComplete(uint64_t fenceValue) const { return m_pFence->GetCompletedValue() >= fenceValue; }
+	uint64_t GetSubmittedValue() const { return m_SubmittedValue; }
+	uint32_t GetQueuedCount() const { return static_cast<uint32_t>(m_Copies.size()); }
+	GfxCommandQueue* GetQueue() const { return m_pQueue.get(); }
+	const UploadStats& GetStats() const { return m_Stats; }
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Batch structure - command list of a submission
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Batch
+	{
+		GfxPtr<GfxCommandAllocator> pAllocator; // memory of the commands
+		GfxPtr<GfxCommandList> pCmdList; // copies of the batch
+		uint64_t FenceValue; // value signaled after the batch (0 before the first use)
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Copy structure - range of the staging ring to copy
+	/////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Copy
+	{
+		GfxResource* pDst; // destination buffer
+		uint64_t DstOffset; // offset in pDst
+		uint64_t SrcOffset; // offset in the staging buffer
+		uint64_t Size; // bytes to copy
+	};
+
+	GfxPtr<GfxCommandQueue> m_pQueue; // copy queue
+	GfxPtr<GfxFence> m_pFence; // signaled after every batch
+	UploadRing m_Staging; // staged data, recycled by fence value
+	Batch m_Batches[MaxBatches]; // command lists used in turn
+	uint32_t m_NextBatch; // entry of m_Batches the next submission records into
+	std::vector<Copy> m_Copies; // copies queued since the last Submit()
+	uint64_t m_SubmittedValue; // fence value of the last batch
+	uint64_t m_SyncedValue; // fence value other queues last waited for
+	UploadStats m_Stats; // totals since Init()
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	bool Stage(uint64_t size, UploadAllocation& allocation);
+	void WaitForBatch(uint64_t fenceValue);
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <LinearRing.h>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// UploadAllocation structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct UploadAllocation
+{
+	void* pCPU; // CPU pointer into the persistently mapped buffer
+	GfxGpuVirtualAddress GPU; // GPU virtual address of the same bytes
+	uint64_t Offset; // offset from the start of the buffer
+	uint64_t Size; // size requested
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// UploadRing class
+//
+// Linear allocator over one persistently mapped upload buffer, retired by fence value through LinearRing.
+// It only needs a CPU pointer and a GPU base address, so it can run over plain memory with a simulated
+// fence.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class UploadRing
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint64_t DefaultAlignment = 256; // constant buffer placement alignment
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	UploadRing();
+	~UploadRing();
+
+	// create and map an upload buffer of the capacity on the device
+	bool Init(GfxDevice* pDevice, uint64_t capacity);
+
+	// use caller-owned memory (no device needed)
+	bool Init(void* pCPUBase, GfxGpuVirtualAddress gpuBase, uint64_t capacity);
+
+	void Term();
+
+	// hand out size bytes aligned to alignment (power of two), returns false when the ring is full
+	bool Allocate(uint64_t size, uint64_t alignment, UploadAllocation& allocation);
+	bool Allocate(uint64_t size, UploadAllocation& allocation) { return Allocate(size, DefaultAlignment, allocation); }
+
+	// recycle the regions of frames whose fence value is less than or equal to completedValue
+	void Retire(uint64_t completedValue) { m_Ring.Retire(completedValue); }
+
+	// close the current frame, its region is recycled once the fence reaches fenceValue
+	void EndFrame(uint64_t fenceValue) { m_Ring.EndFrame(fenceValue); }
+
+	// buffer the allocations live in (nullptr when memory is caller-owned)
+	GfxResource* GetBuffer() const { return m_pBuffer.get(); }
+
+	uint64_t GetCapacity() const { return m_Ring.GetCapacity(); }
+	uint64_t GetUsedBytes() const { return m_Ring.GetUsed(); }
+	uint32_t GetPendingFrameCount() const { return m_Ring.GetPendingFrameCount(); }
+
+	// units are bytes, kept after Term() until the next Init()
+	const LinearRingStats& GetStats() const { return m_Ring.GetStats(); }
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	GfxPtr<GfxResource> m_pBuffer; // upload buffer (nullptr when memory is caller-owned)
+	uint8_t* m_pCPUBase; // mapped start of the buffer
+	GfxGpuVirtualAddress m_GPUBase; // GPU address of the buffer
+	LinearRing m_Ring; // bookkeeping of the buffer in bytes
+};
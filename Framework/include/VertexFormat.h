@@ -0,0 +1,69 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <MeshFile.h>
+#include <ShaderTypes.h>
+#include <cstdint>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// VertexQuantization structure (same values as Transform::PositionScale/PositionOffset)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct VertexQuantization
+{
+	DirectX::XMFLOAT4 Scale; // decoded = SNORM value * Scale + Offset (w unused)
+	DirectX::XMFLOAT4 Offset;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// VertexQuantizationError structure
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct VertexQuantizationError
+{
+	float MaxPosition; // largest distance between an original and a decoded position
+	float RmsPosition; // root mean square of that distance
+	float MaxColor; // largest difference of a color component (1/510 at best for 8 bits)
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// VertexFormat class
+//
+// Input layouts and encoders of the MeshVertexLayout values. Packed vertices store the position as 16-bit
+// SNORM relative to the bounds of the mesh and the color as RGBA8 UNORM (12 instead of 28 bytes); the
+// shader maps the position back with the dequantization of the constant buffer, which is the identity
+// for float positions, so both layouts share the same shaders.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class VertexFormat
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	static const uint32_t MaxElements = 2; // input elements of a layout
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	// per-vertex elements of the layout in inputSlot, returns their number (0 for unknown layouts)
+	static uint32_t GetInputLayout(MeshVertexLayout layout, uint32_t inputSlot, GfxInputElementDesc* pElements);
+
+	// dequantization that spans the bounds
+	static VertexQuantization ComputeQuantization(const float boundsMin[3], const float boundsMax[3]);
+
+	// dequantization of float positions
+	static VertexQuantization GetIdentityQuantization();
+
+	static void Encode(const Vertex* pSource, uint32_t count, const VertexQuantization& quantization, PackedVertex* pDest);
+	static void Decode(const PackedVertex* pSource, uint32_t count, const VertexQuantization& quantization, Vertex* pDest);
+
+	static VertexQuantizationError MeasureError(const Vertex* pOriginal, const PackedVertex* pEncoded, uint32_t count, const VertexQuantization& quantization);
+};
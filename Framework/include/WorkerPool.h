@@ -0,0 +1,73 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// WorkerPool class
+//
+// Fixed set of threads which run the jobs of one Dispatch() at a time. The calling thread takes part as
+// worker 0, so a pool of one worker runs everything inline. Jobs are picked in index order but may finish
+// in any order, so each job should write to its own slot.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class WorkerPool
+{
+	//====================================================================================================
+	// List of friend classes and methods
+	//====================================================================================================
+	/* NOTHING */
+
+public:
+	//====================================================================================================
+	// Public variables
+	//====================================================================================================
+	using Job = std::function<void(uint32_t jobIndex, uint32_t workerIndex)>;
+
+	//====================================================================================================
+	// Public methods
+	//====================================================================================================
+	WorkerPool();
+	~WorkerPool();
+
+	// workerCount includes the calling thread
+	bool Init(uint32_t workerCount);
+	void Term();
+
+	// run job for every index in [0, jobCount) and return once all of them are done
+	void Dispatch(uint32_t jobCount, const Job& job);
+
+	uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_Threads.size()) + 1; }
+
+	// number of hardware threads (at least one)
+	static uint32_t GetHardwareWorkerCount();
+
+private:
+	//====================================================================================================
+	// Private variables
+	//====================================================================================================
+	std::vector<std::thread> m_Threads; // helper threads (workers 1...N-1)
+	std::mutex m_Mutex; // guards everything below except m_NextJob
+	std::condition_variable m_WakeCondition; // signaled on new dispatch or quit
+	std::condition_variable m_DoneCondition; // signaled when the last helper leaves a dispatch
+	const Job* m_pJob; // job of the current dispatch
+	uint32_t m_JobCount; // number of jobs of the current dispatch
+	std::atomic<uint32_t> m_NextJob; // index of the next job to pick
+	uint32_t m_BusyThreads; // helpers still working on the current dispatch
+	uint64_t m_Generation; // incremented on every dispatch
+	bool m_Quit; // whether helpers should exit
+
+	//====================================================================================================
+	// Private methods
+	//====================================================================================================
+	void ThreadMain(uint32_t workerIndex);
+	void RunJobs(const Job& job, uint32_t jobCount, uint32_t workerIndex);
+};
@@ -0,0 +1,322 @@
+#pragma once
+
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#if defined(_WIN32) || __has_include(<DirectXMath.h>)
+#include <DirectXMath.h>
+#define XMATH_HAS_DIRECTXMATH 1
+#else
+#include <cmath>
+#include <cstdint>
+#define XMATH_HAS_DIRECTXMATH 0
+#endif
+
+
+#if !XMATH_HAS_DIRECTXMATH
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Portable subset of DirectXMath
+//
+// Used only on platforms where DirectXMath.h is not installed (e.g. the headless Linux build). It keeps
+// the row-vector conventions and memory layout of the real library so that constant buffer contents are
+// identical on every backend.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+namespace DirectX {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	constexpr float XM_PI = 3.141592654f;
+	constexpr float XM_2PI = 6.283185307f;
+	constexpr float XM_PIDIV2 = 1.570796327f;
+
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// XMVECTOR structure
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct alignas(16) XMVECTOR
+	{
+		float v[4]; // x, y, z, w
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// XMMATRIX structure
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct alignas(16) XMMATRIX
+	{
+		XMVECTOR r[4]; // rows
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// XMFLOAT2 structure
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct XMFLOAT2
+	{
+		float x;
+		float y;
+
+		XMFLOAT2() = default;
+		constexpr XMFLOAT2(float _x, float _y) : x(_x), y(_y) {}
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// XMFLOAT3 structure
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct XMFLOAT3
+	{
+		float x;
+		float y;
+		float z;
+
+		XMFLOAT3() = default;
+		constexpr XMFLOAT3(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// XMFLOAT4 structure
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct XMFLOAT4
+	{
+		float x;
+		float y;
+		float z;
+		float w;
+
+		XMFLOAT4() = default;
+		constexpr XMFLOAT4(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// XMFLOAT4X4 structure
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct XMFLOAT4X4
+	{
+		float m[4][4];
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// scalar helpers
+	//----------------------------------------------------------------------------------------------------
+	inline constexpr float XMConvertToRadians(float degrees) { return degrees * (XM_PI / 180.f); }
+	inline constexpr float XMConvertToDegrees(float radians) { return radians * (180.f / XM_PI); }
+
+	//----------------------------------------------------------------------------------------------------
+	// vector functions
+	//----------------------------------------------------------------------------------------------------
+	inline XMVECTOR XMVectorSet(float x, float y, float z, float w) { return XMVECTOR{ { x, y, z, w } }; }
+	inline XMVECTOR XMVectorZero() { return XMVECTOR{ { 0.f, 0.f, 0.f, 0.f } }; }
+	inline float XMVectorGetX(const XMVECTOR& v) { return v.v[0]; }
+	inline float XMVectorGetY(const XMVECTOR& v) { return v.v[1]; }
+	inline float XMVectorGetZ(const XMVECTOR& v) { return v.v[2]; }
+	inline float XMVectorGetW(const XMVECTOR& v) { return v.v[3]; }
+
+	inline XMVECTOR XMVectorSubtract(const XMVECTOR& a, const XMVECTOR& b)
+	{
+		return XMVECTOR{ { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } };
+	}
+
+	inline XMVECTOR XMVectorNegate(const XMVECTOR& a)
+	{
+		return XMVECTOR{ { -a.v[0], -a.v[1], -a.v[2], -a.v[3] } };
+	}
+
+	inline float XMVector3DotScalar(const XMVECTOR& a, const XMVECTOR& b)
+	{
+		return a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2];
+	}
+
+	inline XMVECTOR XMVector3Cross(const XMVECTOR& a, const XMVECTOR& b)
+	{
+		return XMVECTOR{ {
+			a.v[1] * b.v[2] - a.v[2] * b.v[1],
+			a.v[2] * b.v[0] - a.v[0] * b.v[2],
+			a.v[0] * b.v[1] - a.v[1] * b.v[0],
+			0.f } };
+	}
+
+	inline XMVECTOR XMVector3Normalize(const XMVECTOR& a)
+	{
+		float length = std::sqrt(XMVector3DotScalar(a, a));
+		float inv = (length > 0.f) ? 1.f / length : 0.f;
+		return XMVECTOR{ { a.v[0] * inv, a.v[1] * inv, a.v[2] * inv, a.v[3] * inv } };
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// quaternion functions
+	//----------------------------------------------------------------------------------------------------
+	inline XMVECTOR XMQuaternionIdentity() { return XMVECTOR{ { 0.f, 0.f, 0.f, 1.f } }; }
+
+	inline XMVECTOR XMQuaternionRotationAxis(const XMVECTOR& axis, float angle)
+	{
+		XMVECTOR n = XMVector3Normalize(axis);
+		float s = std::sin(0.5f * angle);
+		return XMVECTOR{ { n.v[0] * s, n.v[1] * s, n.v[2] * s, std::cos(0.5f * angle) } };
+	}
+
+	inline XMVECTOR XMVector4Transform(const XMVECTOR& v, const XMMATRIX& m)
+	{
+		XMVECTOR result;
+		for (int c = 0; c < 4; ++c)
+		{
+			result.v[c] = v.v[0] * m.r[0].v[c] + v.v[1] * m.r[1].v[c] + v.v[2] * m.r[2].v[c] + v.v[3] * m.r[3].v[c];
+		}
+		return result;
+	}
+
+	inline XMVECTOR XMLoadFloat3(const XMFLOAT3* p) { return XMVECTOR{ { p->x, p->y, p->z, 0.f } }; }
+	inline XMVECTOR XMLoadFloat4(const XMFLOAT4* p) { return XMVECTOR{ { p->x, p->y, p->z, p->w } }; }
+	inline void XMStoreFloat3(XMFLOAT3* p, const XMVECTOR& v) { p->x = v.v[0]; p->y = v.v[1]; p->z = v.v[2]; }
+	inline void XMStoreFloat4(XMFLOAT4* p, const XMVECTOR& v) { p->x = v.v[0]; p->y = v.v[1]; p->z = v.v[2]; p->w = v.v[3]; }
+
+	//----------------------------------------------------------------------------------------------------
+	// matrix functions
+	//----------------------------------------------------------------------------------------------------
+	inline XMMATRIX XMMatrixSet(
+		float m00, float m01, float m02, float m03,
+		float m10, float m11, float m12, float m13,
+		float m20, float m21, float m22, float m23,
+		float m30, float m31, float m32, float m33)
+	{
+		return XMMATRIX{ {
+			{ { m00, m01, m02, m03 } },
+			{ { m10, m11, m12, m13 } },
+			{ { m20, m21, m22, m23 } },
+			{ { m30, m31, m32, m33 } } } };
+	}
+
+	inline XMMATRIX XMMatrixIdentity()
+	{
+		return XMMatrixSet(
+			1.f, 0.f, 0.f, 0.f,
+			0.f, 1.f, 0.f, 0.f,
+			0.f, 0.f, 1.f, 0.f,
+			0.f, 0.f, 0.f, 1.f);
+	}
+
+	inline XMMATRIX XMMatrixMultiply(const XMMATRIX& a, const XMMATRIX& b)
+	{
+		XMMATRIX result;
+		for (int r = 0; r < 4; ++r)
+		{
+			result.r[r] = XMVector4Transform(a.r[r], b);
+		}
+		return result;
+	}
+
+	inline XMMATRIX XMMatrixTranspose(const XMMATRIX& m)
+	{
+		XMMATRIX result;
+		for (int r = 0; r < 4; ++r)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				result.r[r].v[c] = m.r[c].v[r];
+			}
+		}
+		return result;
+	}
+
+	inline XMMATRIX XMMatrixTranslation(float x, float y, float z)
+	{
+		return XMMatrixSet(
+			1.f, 0.f, 0.f, 0.f,
+			0.f, 1.f, 0.f, 0.f,
+			0.f, 0.f, 1.f, 0.f,
+			  x,   y,   z, 1.f);
+	}
+
+	inline XMMATRIX XMMatrixScaling(float x, float y, float z)
+	{
+		return XMMatrixSet(
+			  x, 0.f, 0.f, 0.f,
+			0.f,   y, 0.f, 0.f,
+			0.f, 0.f,   z, 0.f,
+			0.f, 0.f, 0.f, 1.f);
+	}
+
+	inline XMMATRIX XMMatrixRotationY(float angle)
+	{
+		float s = std::sin(angle);
+		float c = std::cos(angle);
+		return XMMatrixSet(
+			  c, 0.f,  -s, 0.f,
+			0.f, 1.f, 0.f, 0.f,
+			  s, 0.f,   c, 0.f,
+			0.f, 0.f, 0.f, 1.f);
+	}
+
+	inline XMMATRIX XMMatrixRotationQuaternion(const XMVECTOR& q)
+	{
+		float x = q.v[0], y = q.v[1], z = q.v[2], w = q.v[3];
+		float xx = x * x, yy = y * y, zz = z * z;
+		float xy = x * y, xz = x * z, yz = y * z;
+		float wx = w * x, wy = w * y, wz = w * z;
+		return XMMatrixSet(
+			1.f - 2.f * (yy + zz), 2.f * (xy + wz), 2.f * (xz - wy), 0.f,
+			2.f * (xy - wz), 1.f - 2.f * (xx + zz), 2.f * (yz + wx), 0.f,
+			2.f * (xz + wy), 2.f * (yz - wx), 1.f - 2.f * (xx + yy), 0.f,
+			0.f, 0.f, 0.f, 1.f);
+	}
+
+	inline XMMATRIX XMMatrixLookToLH(const XMVECTOR& eyePos, const XMVECTOR& eyeDir, const XMVECTOR& upDir)
+	{
+		XMVECTOR r2 = XMVector3Normalize(eyeDir);
+		XMVECTOR r0 = XMVector3Normalize(XMVector3Cross(upDir, r2));
+		XMVECTOR r1 = XMVector3Cross(r2, r0);
+		XMVECTOR negEye = XMVectorNegate(eyePos);
+
+		float d0 = XMVector3DotScalar(r0, negEye);
+		float d1 = XMVector3DotScalar(r1, negEye);
+		float d2 = XMVector3DotScalar(r2, negEye);
+
+		return XMMatrixSet(
+			r0.v[0], r1.v[0], r2.v[0], 0.f,
+			r0.v[1], r1.v[1], r2.v[1], 0.f,
+			r0.v[2], r1.v[2], r2.v[2], 0.f,
+			d0, d1, d2, 1.f);
+	}
+
+	inline XMMATRIX XMMatrixLookAtRH(const XMVECTOR& eyePos, const XMVECTOR& focusPos, const XMVECTOR& upDir)
+	{
+		XMVECTOR negEyeDir = XMVectorSubtract(eyePos, focusPos);
+		return XMMatrixLookToLH(eyePos, negEyeDir, upDir);
+	}
+
+	inline XMMATRIX XMMatrixPerspectiveFovRH(float fovAngleY, float aspectRatio, float nearZ, float farZ)
+	{
+		float height = std::cos(0.5f * fovAngleY) / std::sin(0.5f * fovAngleY);
+		float width = height / aspectRatio;
+		float range = farZ / (nearZ - farZ);
+		return XMMatrixSet(
+			width, 0.f, 0.f, 0.f,
+			0.f, height, 0.f, 0.f,
+			0.f, 0.f, range, -1.f,
+			0.f, 0.f, range * nearZ, 0.f);
+	}
+
+	inline XMMATRIX XMLoadFloat4x4(const XMFLOAT4X4* p)
+	{
+		XMMATRIX result;
+		for (int r = 0; r < 4; ++r)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				result.r[r].v[c] = p->m[r][c];
+			}
+		}
+		return result;
+	}
+
+	inline void XMStoreFloat4x4(XMFLOAT4X4* p, const XMMATRIX& m)
+	{
+		for (int r = 0; r < 4; ++r)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				p->m[r][c] = m.r[r].v[c];
+			}
+		}
+	}
+
+} // namespace DirectX
+#endif // !XMATH_HAS_DIRECTXMATH
@@ -0,0 +1,5 @@
+//--------------------------------------------------------------------------------------------------------
+// SimpleVS.hlsl with the world matrix and color read from the per-instance vertex stream
+//--------------------------------------------------------------------------------------------------------
+#define ENABLE_INSTANCING 1
+#include "SimpleVS.hlsl"
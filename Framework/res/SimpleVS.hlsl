@@ -1,7 +1,18 @@
+#ifndef ENABLE_INSTANCING
+#define ENABLE_INSTANCING 0 // SimpleInstancedVS.hlsl builds the variant with per-instance data
+#endif
+
 struct VSInput
 {
-    float3 Position : POSITION; // position coordinates
-    float4 Color : COLOR; // color of vertex
+    float3 Position : POSITION; // position coordinates (R32G32B32_FLOAT or R16G16B16A16_SNORM)
+    float4 Color : COLOR; // color of vertex (R32G32B32A32_FLOAT or R8G8B8A8_UNORM)
+#if ENABLE_INSTANCING
+    float4 World0 : WORLD0; // rows of the world matrix (InstanceData::World)
+    float4 World1 : WORLD1;
+    float4 World2 : WORLD2;
+    float4 World3 : WORLD3;
+    float4 InstanceColor : COLOR1; // color of instance (InstanceData::Color)
+#endif
 };
 
 struct VSOutput
@@ -15,6 +26,8 @@ cbuffer Transform : register(b0)
     float4x4 World : packoffset(c0); // world matrix
     float4x4 View : packoffset(c4); // view matrix
     float4x4 Proj : packoffset(c8); // projection matrix
+    float4 PositionScale : packoffset(c12); // dequantization of the position (1 for float positions)
+    float4 PositionOffset : packoffset(c13); // (0 for float positions)
 };
 
 //--------------------------------------------------------------------------------------------------------
@@ -24,13 +37,24 @@ VSOutput main(VSInput input)
 {
     VSOutput output = (VSOutput) 0;
     
-    float4 localPos = float4(input.Position, 1.f);
+    // SNORM positions arrive in [-1, 1] and are scaled back to the bounds of the mesh
+    float4 localPos = float4(input.Position * PositionScale.xyz + PositionOffset.xyz, 1.f);
+#if ENABLE_INSTANCING
+    // rows are stored like XMFLOAT4X4, so the position is a row vector here
+    float4 instancePos = localPos.x * input.World0 + localPos.y * input.World1 + localPos.z * input.World2 + input.World3;
+    float4 worldPos = mul(World, instancePos);
+#else
     float4 worldPos = mul(World, localPos);
+#endif
     float4 viewPos = mul(View, worldPos);
     float4 projPos = mul(Proj, viewPos);
     
     output.Position = projPos;
+#if ENABLE_INSTANCING
+    output.Color = input.Color * input.InstanceColor;
+#else
     output.Color = input.Color;
+#endif
     
     return output;
 }
\ No newline at end of file
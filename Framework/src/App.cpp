@@ -2,7 +2,15 @@
 // Includes
 //--------------------------------------------------------------------------------------------------------
 #include <App.h>
+#include <MeshFile.h>
+#include <Profiler.h>
+#include <algorithm>
 #include <cassert>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
 
 
 namespace /* anonymous */ {
@@ -10,18 +18,29 @@ namespace /* anonymous */ {
 	//----------------------------------------------------------------------------------------------------
 	// Constant Values
 	//----------------------------------------------------------------------------------------------------
+#if defined(_WIN32)
 	const auto ClassName = TEXT("SampleWindowClass");
+#endif
+	const char* const PipelineLibraryPath = "PipelineLibrary.bin"; // compiled pipelines kept between runs
+	const char* const ShaderStorePath = "Shaders.bin"; // packed shaders written by ShaderPacker (loose .cso files without)
 
-
-	//////////////////////////////////////////////////////////////////////////////////////////////////////
-	// Vertex structure
-	//////////////////////////////////////////////////////////////////////////////////////////////////////
-	struct Vertex
+	// shaders of the sample: permutation name, compiled file, source (relative to the project directory) and profile
+	struct ShaderFile
 	{
-		DirectX::XMFLOAT3 Position; // position coordinates
-		DirectX::XMFLOAT4 Color; // color of vertex
+		const char* pName;
+		const char* pBytecodePath;
+		const char* pSourcePath;
+		const char* pProfile;
 	};
 
+	const ShaderFile ShaderFiles[] = {
+		{ "SimpleVS", "SimpleVS.cso", "../res/SimpleVS.hlsl", "vs_5_0" },
+		{ "SimpleInstancedVS", "SimpleInstancedVS.cso", "../res/SimpleInstancedVS.hlsl", "vs_5_0" },
+		{ "SimplePS", "SimplePS.cso", "../res/SimplePS.hlsl", "ps_5_0" },
+	};
+
+
+
 } // namespace /* anonymous */
 
 
@@ -32,26 +51,56 @@ namespace /* anonymous */ {
 //--------------------------------------------------------------------------------------------------------
 //	 constructor
 //--------------------------------------------------------------------------------------------------------
-App::App(uint32_t width, uint32_t height)
-	: m_hInst(nullptr)
-	, m_hWnd(nullptr)
-	, m_Width(width)
+App::App(uint32_t width, uint32_t height, GfxBackend backend, uint32_t quadCount, bool instancing, const char* pMeshPath, uint32_t framesInFlight)
+	: m_Width(width)
 	, m_Height(height)
+	, m_Backend(backend)
+	, m_QuadCount((quadCount > 0) ? quadCount : 1)
+	, m_Instancing(instancing)
+	, m_Quit(false)
+	, m_FramesInFlight((framesInFlight < 1) ? 1 : (framesInFlight > FrameTimeline::MaxFramesInFlight) ? FrameTimeline::MaxFramesInFlight : framesInFlight)
+	, m_MeshPath((pMeshPath != nullptr) ? pMeshPath : "")
 	, m_pDevice(nullptr)
 	, m_pQueue(nullptr)
 	, m_pSwapChain(nullptr)
-	, m_pCmdList(nullptr)
-	, m_pHeapRTV(nullptr)
-	, m_pFence(nullptr)
-	, m_FrameIndex(0)
+	, m_DescriptorStats()
+	, m_MeshHandle(AssetStreamer::InvalidHandle)
+	, m_RootSignatureKey(0)
+	, m_VertexElementCount(0)
+	, m_ShaderGeneration(0)
+	, m_ShaderPollFrames(0)
+	, m_PSO(InvalidPipelineHandle)
+	, m_PSOInstanced(InvalidPipelineHandle)
+	, m_pReadyPSO(nullptr)
+	, m_pReadyPSOInstanced(nullptr)
+	, m_pDrawPSO(nullptr)
+	, m_DrawInstanced(false)
+	, m_BackBufferIndex(0)
+	, m_FrameSlot(0)
+	, m_IndexCount(0)
+	, m_VertexLayout(MeshVertexLayout::PositionColor)
+	, m_Quantization(VertexFormat::GetIdentityQuantization())
+	, m_MeshRadius(0.f)
+	, m_VisibleCount(0)
+	, m_DrawCount(0)
 	, m_RotateAngle(0.f)
 {
-	for (uint32_t i = 0u; i < FrameCount; ++i)
+#if defined(_WIN32)
+	m_hInst = nullptr;
+	m_hWnd = nullptr;
+#endif
+
+	for (uint32_t i = 0u; i < BackBufferCount; ++i)
 	{
 		m_pColorBuffer[i] = nullptr;
-		m_pCmdAllocator[i] = nullptr;
-		m_FenceCounter[i] = 0;
+		m_HandleRTV[i].CPU.ptr = 0;
+		m_HandleRTV[i].Index = DescriptorHandle::InvalidIndex;
 	}
+
+	m_VB = GpuAllocation();
+	m_VB.Block = GpuMemoryAllocator::InvalidBlock;
+	m_IB = GpuAllocation();
+	m_IB.Block = GpuMemoryAllocator::InvalidBlock;
 }
 
 //--------------------------------------------------------------------------------------------------------
@@ -65,14 +114,33 @@ App::~App()
 //--------------------------------------------------------------------------------------------------------
 //	 run
 //--------------------------------------------------------------------------------------------------------
-void App::Run()
+bool App::Run()
+{
+	return Run(0);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 run for the number of frames (0 runs until the window is closed)
+//--------------------------------------------------------------------------------------------------------
+bool App::Run(uint32_t frameCount)
 {
-	if (InitApp())
+	return Run(frameCount, FrameFunc());
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 run with a callback at the end of every frame
+//--------------------------------------------------------------------------------------------------------
+bool App::Run(uint32_t frameCount, const FrameFunc& onFrameEnd)
+{
+	m_Quit = false;
+	bool initialized = InitApp();
+	if (initialized)
 	{
-		MainLoop();
+		MainLoop(frameCount, onFrameEnd);
 	}
 
 	TermApp();
+	return initialized;
 }
 
 //--------------------------------------------------------------------------------------------------------
@@ -80,11 +148,13 @@ void App::Run()
 //--------------------------------------------------------------------------------------------------------
 bool App::InitApp()
 {
-	// initialize window
-	if (!InitWnd())
+#if defined(_WIN32)
+	// initialize window (headless backends don't need one)
+	if (m_Backend == GfxBackend::D3D12 && !InitWnd())
 	{
 		return false;
 	}
+#endif
 
 	// initialize Direct3D 12
 	if (!InitD3D())
@@ -107,12 +177,23 @@ bool App::InitApp()
 //--------------------------------------------------------------------------------------------------------
 void App::TermApp()
 {
+	// wait for completion of GPU processing
+	if (m_pQueue != nullptr && m_Timeline.GetFence() != nullptr)
+	{
+		WaitGPU();
+	}
+
+	// processing on termination
+	OnTerm();
 	// end processing of Direct3D 12
 	TermD3D();
+#if defined(_WIN32)
 	// terminate window
 	TermWnd();
+#endif
 }
 
+#if defined(_WIN32)
 //--------------------------------------------------------------------------------------------------------
 //	 initialization of window
 //--------------------------------------------------------------------------------------------------------
@@ -202,25 +283,50 @@ void App::TermWnd()
 	m_hInst = nullptr;
 	m_hWnd = nullptr;
 }
+#endif // defined(_WIN32)
 
 //--------------------------------------------------------------------------------------------------------
 //	 main loop
 //--------------------------------------------------------------------------------------------------------
-void App::MainLoop()
+void App::MainLoop(uint32_t frameCount, const FrameFunc& onFrameEnd)
 {
-	MSG msg = {};
+	uint32_t frame = 0;
 
-	while (WM_QUIT != msg.message)
+#if defined(_WIN32)
+	if (m_hWnd != nullptr)
 	{
-		if (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE) == TRUE)
+		MSG msg = {};
+
+		while (WM_QUIT != msg.message && !m_Quit && (frameCount == 0 || frame < frameCount))
 		{
-			TranslateMessage(&msg);
-			DispatchMessage(&msg);
+			if (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE) == TRUE)
+			{
+				TranslateMessage(&msg);
+				DispatchMessage(&msg);
+			}
+			else
+			{
+				Render();
+				if (onFrameEnd)
+				{
+					onFrameEnd(frame);
+				}
+				frame++;
+			}
 		}
-		else
+		return;
+	}
+#endif
+
+	// headless loop
+	while (!m_Quit && (frameCount == 0 || frame < frameCount))
+	{
+		Render();
+		if (onFrameEnd)
 		{
-			Render();
+			onFrameEnd(frame);
 		}
+		frame++;
 	}
 }
 
@@ -229,313 +335,438 @@ void App::MainLoop()
 //--------------------------------------------------------------------------------------------------------
 bool App::InitD3D()
 {
-#if defined(DEBUG) || defined(_DEBUG)
+	// generate device
+	if (!CreateGfxDevice(m_Backend, m_pDevice))
 	{
-		ComPtr<ID3D12Debug> debug;
-		auto hr = D3D12GetDebugInterface(IID_PPV_ARGS(debug.GetAddressOf()));
-
-		// enable debug layer
-		if (SUCCEEDED(hr))
-		{
-			debug->EnableDebugLayer();
-		}
+		return false;
 	}
-#endif
 
-	// generate device
-	HRESULT hr = D3D12CreateDevice(
-		nullptr,
-		D3D_FEATURE_LEVEL_11_0,
-		IID_PPV_ARGS(m_pDevice.GetAddressOf()));
-	if (FAILED(hr))
+	// generate command queue
+	if (!m_pDevice->CreateCommandQueue(GfxCommandListType::Direct, m_pQueue))
 	{
 		return false;
 	}
 
-	// generate command queue
+	// generate swap chain
 	{
-		D3D12_COMMAND_QUEUE_DESC desc = {};
-		desc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
-		desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
-		desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
-		desc.NodeMask = 0;
+		// settings of swap chain
+		GfxSwapChainDesc desc = {};
+		desc.Width = m_Width;
+		desc.Height = m_Height;
+		desc.BufferCount = BackBufferCount;
+		desc.Format = GfxFormat::R8G8B8A8_Unorm;
+#if defined(_WIN32)
+		desc.pNativeWindow = m_hWnd;
+#else
+		desc.pNativeWindow = nullptr;
+#endif
 
-		hr = m_pDevice->CreateCommandQueue(&desc, IID_PPV_ARGS(m_pQueue.GetAddressOf()));
-		if (FAILED(hr))
+		// generate swap chain
+		if (!m_pDevice->CreateSwapChain(m_pQueue.get(), desc, m_pSwapChain))
 		{
 			return false;
 		}
+
+		// get index of back buffer
+		m_BackBufferIndex = m_pSwapChain->GetCurrentBackBufferIndex();
 	}
 
-	// generate swap chain
+	// generate fence timeline (per-frame resources below are made for each frame in flight)
+	if (!m_Timeline.Init(m_pDevice.get(), m_pQueue.get(), m_FramesInFlight))
+	{
+		return false;
+	}
+
+	// generate recording threads and command lists (one list per thread)
 	{
-		// generate DXGI factory
-		ComPtr<IDXGIFactory4> pFactory = nullptr;
-		hr = CreateDXGIFactory1(IID_PPV_ARGS(pFactory.GetAddressOf()));
-		if (FAILED(hr))
+		uint32_t workerCount = WorkerPool::GetHardwareWorkerCount();
+		if (workerCount > MaxRecordWorkers)
+		{
+			workerCount = MaxRecordWorkers;
+		}
+
+		if (!m_Workers.Init(workerCount))
 		{
 			return false;
 		}
 
-		// settings of swap chain
-		DXGI_SWAP_CHAIN_DESC desc = {};
-		desc.BufferDesc.Width = m_Width;
-		desc.BufferDesc.Height = m_Height;
-		desc.BufferDesc.RefreshRate.Numerator = 60;
-		desc.BufferDesc.RefreshRate.Denominator = 1;
-		desc.BufferDesc.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
-		desc.BufferDesc.Scaling = DXGI_MODE_SCALING_UNSPECIFIED;
-		desc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-		desc.SampleDesc.Count = 1;
-		desc.SampleDesc.Quality = 0;
-		desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-		desc.BufferCount = FrameCount;
-		desc.OutputWindow = m_hWnd;
-		desc.Windowed = TRUE;
-		desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
-		desc.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
+		if (!m_CmdLists.Init(m_pDevice.get(), GfxCommandListType::Direct, m_Timeline.GetFramesInFlight(), workerCount, &m_ResourceStates))
+		{
+			return false;
+		}
 
-		// generate swap chain
-		ComPtr<IDXGISwapChain> pSwapChain = nullptr;
-		hr = pFactory->CreateSwapChain(m_pQueue.Get(), &desc, pSwapChain.GetAddressOf());
-		if (FAILED(hr))
+		if (!m_RenderGraph.Init(m_pDevice.get(), &m_ResourceStates, &m_ReleaseQueue))
 		{
 			return false;
 		}
 
-		// get IDXGISwapChain3
-		hr = pSwapChain.As(&m_pSwapChain);
-		if (FAILED(hr))
+		// buffers are sub-allocated from a few large heaps instead of one committed resource each
+		if (!m_GpuMemory.Init(m_pDevice.get()))
 		{
 			return false;
 		}
 
-		// get index of back buffer
-		m_FrameIndex = m_pSwapChain->GetCurrentBackBufferIndex();
+		// static data is copied into default heaps on a copy queue of its own
+		if (!m_Uploads.Init(m_pDevice.get()))
+		{
+			return false;
+		}
 
-		// release unnecessary things
-		pFactory.Reset();
-		pSwapChain.Reset();
+		// one GPU region per command list, frames simply go untimed without timestamp queries
+		m_GpuProfiler.Init(m_pDevice.get(), m_pQueue.get(), m_Timeline.GetFramesInFlight(), MaxRecordWorkers);
 	}
 
-	// generate command allocator
+	// generate render target view
 	{
-		for (uint32_t i = 0u; i < FrameCount; ++i)
+		// generate descriptor pool
+		if (!m_PoolRTV.Init(m_pDevice.get(), GfxDescriptorHeapType::RTV))
 		{
-			hr = m_pDevice->CreateCommandAllocator(
-				D3D12_COMMAND_LIST_TYPE_DIRECT,
-				IID_PPV_ARGS(m_pCmdAllocator[i].GetAddressOf()));
-			if (FAILED(hr))
+			return false;
+		}
+
+		for (uint32_t i = 0u; i < BackBufferCount; ++i)
+		{
+			m_pColorBuffer[i] = m_pSwapChain->GetBuffer(i);
+			if (m_pColorBuffer[i] == nullptr || !m_PoolRTV.Allocate(m_HandleRTV[i]))
 			{
 				return false;
 			}
+
+			// generate render target view
+			m_pDevice->CreateRenderTargetView(m_pColorBuffer[i], GfxFormat::R8G8B8A8_Unorm_sRGB, m_HandleRTV[i].CPU);
+			m_ResourceStates.Register(m_pColorBuffer[i], GfxResourceState::Present);
 		}
 	}
 
-	// generate command list
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 termination for Direct3D
+//--------------------------------------------------------------------------------------------------------
+void App::TermD3D()
+{
+	// abandon fence (the fence owns its event)
+	m_Timeline.Term();
+	m_GpuProfiler.Term();
+
+	// abandon render target (the counters of the pool are kept for the report of the run)
+	m_DescriptorStats = m_PoolRTV.GetStats();
+	for (uint32_t i = 0u; i < BackBufferCount; ++i)
 	{
-		hr = m_pDevice->CreateCommandList(
-			0,
-			D3D12_COMMAND_LIST_TYPE_DIRECT,
-			m_pCmdAllocator[m_FrameIndex].Get(),
-			nullptr,
-			IID_PPV_ARGS(m_pCmdList.GetAddressOf()));
-		if (FAILED(hr))
+		m_PoolRTV.Free(m_HandleRTV[i]);
+		m_ResourceStates.Unregister(m_pColorBuffer[i]);
+		m_pColorBuffer[i] = nullptr;
+	}
+	m_PoolRTV.Term();
+
+	// abandon command lists and the heaps buffers are placed in (once the copies into them are done)
+	m_Uploads.Term();
+	m_GpuMemory.Term();
+	m_RenderGraph.Term();
+	m_CmdLists.Term();
+	m_Workers.Term();
+
+	// abandon swap chain
+	m_pSwapChain.reset();
+
+	// abandon command queue
+	m_pQueue.reset();
+
+	// abandon device
+	m_pDevice.reset();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 rendering
+//--------------------------------------------------------------------------------------------------------
+void App::Render()
+{
+	PROFILE_SCOPE("Render");
+
+	// wait until the resources of this frame's slot are no longer in use by the GPU
+	m_FrameSlot = m_Timeline.BeginFrame();
+	m_GpuProfiler.BeginFrame(m_FrameSlot);
+
+	// recycle upload memory the GPU has finished reading, free what was released before
+	m_UploadRing.Retire(m_Timeline.GetCompletedValue());
+	m_ReleaseQueue.Collect(m_Timeline.GetCompletedValue());
+	m_Uploads.Retire();
+
+	// streamed assets go to the copy queue within the budget of the frame, the draws below wait for them
+	m_Streamer.Update(StreamBudget, [this](StreamedAsset& asset) { OnAssetStreamed(asset); });
+
+	// rebuilt shaders are picked up by new pipelines, the old ones draw until those are compiled
+	if (++m_ShaderPollFrames >= ShaderPollInterval)
+	{
+		m_ShaderPollFrames = 0;
+		m_Shaders.PollChanges();
+		if (m_Shaders.GetGeneration() != m_ShaderGeneration)
 		{
-			return false;
+			RequestPipelines();
 		}
 	}
 
-	// generate render target view
+	// the per-draw path stands in until the instanced pipeline has been compiled
+	m_pReadyPSO = m_PipelineCache.Get(m_PSO, m_pReadyPSO);
+	m_pReadyPSOInstanced = m_Instancing ? m_PipelineCache.Get(m_PSOInstanced, m_pReadyPSOInstanced) : nullptr;
+	m_DrawInstanced = (m_pReadyPSOInstanced != nullptr);
+	m_pDrawPSO = m_DrawInstanced ? m_pReadyPSOInstanced : m_pReadyPSO;
+
+	// update parameters
 	{
-		// settings of descriptor heap
-		D3D12_DESCRIPTOR_HEAP_DESC desc = {};
-		desc.NumDescriptors = FrameCount;
-		desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-		desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-		desc.NodeMask = 0;
+		PROFILE_SCOPE("Update");
+		m_RotateAngle += 0.025f;
 
-		// generate descriptor heap
-		hr = m_pDevice->CreateDescriptorHeap(&desc, IID_PPV_ARGS(m_pHeapRTV.GetAddressOf()));
-		if (FAILED(hr))
+		// every quad spins around its own Y axis
+		DirectX::XMFLOAT4 rotation;
+		DirectX::XMStoreFloat4(&rotation, DirectX::XMQuaternionRotationAxis(DirectX::XMVectorSet(0.f, 1.f, 0.f, 0.f), m_RotateAngle));
+		std::fill_n(m_Transforms.GetRotationY(), m_QuadCount, rotation.y);
+		std::fill_n(m_Transforms.GetRotationW(), m_QuadCount, rotation.w);
+
+		// only quads whose bounding sphere touches the view frustum are submitted
+		SphereBounds bounds = { m_Transforms.GetPositionX(), m_Transforms.GetPositionY(), m_Transforms.GetPositionZ(), m_QuadRadius.data() };
+		Frustum frustum = FrustumCuller::ExtractFrustum(DirectX::XMMatrixMultiply(m_View, m_Proj));
+		m_VisibleCount = m_Culler.CullSpheres(frustum, bounds, m_QuadCount, m_VisibleQuads.data(), &m_Workers);
+
+		// nothing to draw until the geometry has streamed in
+		if (m_IndexCount == 0)
 		{
-			return false;
+			m_VisibleCount = 0;
 		}
 
-		D3D12_CPU_DESCRIPTOR_HANDLE handle = m_pHeapRTV->GetCPUDescriptorHandleForHeapStart();
-		uint32_t incrementSize = m_pDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
-
-		for (uint32_t i = 0u; i < FrameCount; ++i)
+		// submission order of the draws, the transforms and instances below are written in it (one pass and one
+		// pipeline without materials so far, which leaves the quads front to back to hide the ones behind early)
 		{
-			hr = m_pSwapChain->GetBuffer(i, IID_PPV_ARGS(m_pColorBuffer[i].GetAddressOf()));
-			if (FAILED(hr))
+			PROFILE_SCOPE("SortDraws");
+			DirectX::XMFLOAT4X4 view;
+			DirectX::XMStoreFloat4x4(&view, m_View);
+			const float* pX = m_Transforms.GetPositionX();
+			const float* pY = m_Transforms.GetPositionY();
+			const float* pZ = m_Transforms.GetPositionZ();
+
+			m_DrawQueue.Reset();
+			for (uint32_t i = 0; i < m_VisibleCount; ++i)
 			{
-				return false;
+				// view space looks down -Z
+				uint32_t quad = m_VisibleQuads[i];
+				float depth = -(view.m[0][2] * pX[quad] + view.m[1][2] * pY[quad] + view.m[2][2] * pZ[quad] + view.m[3][2]);
+				m_DrawQueue.Push(DrawQueue::MakeKey(0, 0, 0, depth), quad);
 			}
+			m_DrawQueue.Sort();
 
-			D3D12_RENDER_TARGET_VIEW_DESC viewDesc = {};
-			viewDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
-			viewDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
-			viewDesc.Texture2D.MipSlice = 0;
-			viewDesc.Texture2D.PlaneSlice = 0;
-
-			// generate render target view
-			m_pDevice->CreateRenderTargetView(m_pColorBuffer[i].Get(), &viewDesc, handle);
+			const DrawPacket* pPackets = m_DrawQueue.GetPackets();
+			for (uint32_t i = 0; i < m_VisibleCount; ++i)
+			{
+				m_VisibleQuads[i] = pPackets[i].Payload;
+			}
+		}
 
-			m_HandleRTV[i] = handle;
-			handle.ptr += incrementSize;
+		// a frame without room for its transforms draws nothing, it is still submitted and presented below
+		if (!WriteTransforms())
+		{
+			m_VisibleCount = 0;
 		}
 	}
 
-	// generate fence
+	// the frame submitted first with the streamed mesh on screen ends its request
+	if (m_MeshHandle != AssetStreamer::InvalidHandle && m_VisibleCount > 0)
 	{
-		// reset fence counter
-		for (uint32_t i = 0u; i < FrameCount; ++i)
+		m_Streamer.MarkVisible(m_MeshHandle);
+		m_Streamer.Release(m_MeshHandle);
+		m_MeshHandle = AssetStreamer::InvalidHandle;
+	}
+
+	// draws are recorded in parallel, each part gets at least MinDrawsPerList draws
+	uint32_t drawCount = m_DrawInstanced ? 1 : m_VisibleCount;
+	m_DrawCount = drawCount;
+	uint32_t partCount = (drawCount + MinDrawsPerList - 1) / MinDrawsPerList;
+
+	// passes of the frame, the graph places the barriers and spreads the parts over the command lists
+	bool recorded = false;
+	{
+		PROFILE_SCOPE("Record");
+		m_RenderGraph.Reset();
+		uint32_t colorBuffer = m_RenderGraph.ImportResource("Back buffer", m_pColorBuffer[m_BackBufferIndex]);
+
+		uint32_t clear = m_RenderGraph.AddPass("Clear", [this](GfxCommandList* pCmdList, uint32_t, uint32_t)
 		{
-			m_FenceCounter[i] = 0;
-		}
+			float clearColor[] = { 0.25f, 0.25f, 0.25f, 1.0f };
+			pCmdList->ClearRenderTargetView(m_HandleRTV[m_BackBufferIndex].CPU, clearColor);
+		});
+		m_RenderGraph.Write(clear, colorBuffer, GfxResourceState::RenderTarget);
 
-		// generate fence
-		hr = m_pDevice->CreateFence(
-			m_FenceCounter[m_FrameIndex],
-			D3D12_FENCE_FLAG_NONE,
-			IID_PPV_ARGS(m_pFence.GetAddressOf()));
-		if (FAILED(hr))
+		uint32_t draw = m_RenderGraph.AddPass("Draw", [this](GfxCommandList* pCmdList, uint32_t part, uint32_t partCount)
 		{
-			return false;
+			RecordCommands(pCmdList, part, partCount);
+		}, std::max(partCount, 1u));
+		m_RenderGraph.Write(draw, colorBuffer, GfxResourceState::RenderTarget);
+
+		// resolves the timestamps of the frame at the end of the last list
+		uint32_t present = m_RenderGraph.AddPass("Present", [this](GfxCommandList* pCmdList, uint32_t, uint32_t)
+		{
+			m_GpuProfiler.EndFrame(pCmdList);
+		});
+		m_RenderGraph.Read(present, colorBuffer, GfxResourceState::Present);
+		m_RenderGraph.SetSideEffect(present);
+
+		// a frame the graph can't schedule submits nothing but is still ended, its timestamps are never resolved
+		// and the profiler reads nothing back for it
+		recorded = m_RenderGraph.Compile(m_CmdLists.GetMaxListCount(), m_Timeline.GetFrameValue());
+		if (recorded)
+		{
+			m_RenderGraph.Record(m_Workers, m_CmdLists, m_FrameSlot);
+		}
+		else
+		{
+			printf("render graph: frame %llu doesn't compile, nothing drawn\n", static_cast<unsigned long long>(m_Timeline.GetFrameValue()));
 		}
+	}
 
-		m_FenceCounter[m_FrameIndex]++;
+	// memory of this frame is released once the fence signaled in Present() is reached
+	m_UploadRing.EndFrame(m_Timeline.GetFrameValue());
 
-		// generate event
-		m_FenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-		if (m_FenceEvent == nullptr)
+	// execute command (lists are submitted in recording order), after the copies of new geometry
+	{
+		PROFILE_SCOPE("Execute");
+		m_Uploads.Submit();
+		m_Uploads.Sync(m_pQueue.get());
+		if (recorded)
 		{
-			return false;
+			m_CmdLists.Execute(m_pQueue.get());
 		}
 	}
 
-	// close command list
-	m_pCmdList->Close();
-
-	return true;
+	// show on screen
+	Present(1);
 }
 
 //--------------------------------------------------------------------------------------------------------
-//	 termination for Direct3D
+//	 sub-allocate upload memory of this frame, waits for in-flight frames once when the ring is full
 //--------------------------------------------------------------------------------------------------------
-void App::TermD3D()
+bool App::AllocateUpload(uint64_t size, uint64_t alignment, UploadAllocation& allocation)
 {
-	// wait for completion of GPU processing
-	WaitGPU();
-
-	// abandon event
-	if (m_FenceEvent != nullptr)
+	if (m_UploadRing.Allocate(size, alignment, allocation))
 	{
-		CloseHandle(m_FenceEvent);
-		m_FenceEvent = nullptr;
+		return true;
 	}
 
-	// abandon fence
-	m_pFence.Reset();
-
-	// abandon render target
-	m_pHeapRTV.Reset();
-	for (uint32_t i = 0u; i < FrameCount; ++i)
-	{
-		m_pColorBuffer[i].Reset();
-	}
-
-	// abandon command list
-	m_pCmdList.Reset();
-
-	for (uint32_t i = 0u; i < FrameCount; ++i)
-	{
-		m_pCmdAllocator[i].Reset();
-	}
-
-	// abandon swap chain
-	m_pSwapChain.Reset();
-
-	// abandon command queue
-	m_pQueue.Reset();
-
-	// abandon device
-	m_pDevice.Reset();
+	WaitGPU();
+	m_UploadRing.Retire(m_Timeline.GetCompletedValue());
+	return m_UploadRing.Allocate(size, alignment, allocation);
 }
 
 //--------------------------------------------------------------------------------------------------------
-//	 rendering
+//	 write the constant buffers (and instances) of the visible quads to upload memory, false when the ring is full
 //--------------------------------------------------------------------------------------------------------
-void App::Render()
+bool App::WriteTransforms()
 {
-	// update parameters
+	// sub-allocate constant buffers of this frame (one per visible quad without instancing)
+	uint32_t transformCount = m_DrawInstanced ? 1 : std::max(m_VisibleCount, 1u);
+	UploadAllocation allocation;
+	if (!AllocateUpload(uint64_t(transformCount) * sizeof(Transform), UploadRing::DefaultAlignment, allocation))
 	{
-		m_RotateAngle += 0.025f;
-		m_CBV[m_FrameIndex].pBuffer->World = DirectX::XMMatrixRotationY(m_RotateAngle);
+		printf("upload ring: no room for %u transforms in frame %llu, nothing drawn\n", transformCount, static_cast<unsigned long long>(m_Timeline.GetFrameValue()));
+		return false;
 	}
 
-	// initiate recording command
-	m_pCmdAllocator[m_FrameIndex]->Reset();
-	m_pCmdList->Reset(m_pCmdAllocator[m_FrameIndex].Get(), nullptr);
+	// update constant buffer view (root CBVs take the address, no descriptor is needed)
+	ConstantBufferView<Transform>& cbv = m_CBV[m_FrameSlot];
+	cbv.Desc.BufferLocation = allocation.GPU;
+	cbv.Desc.SizeInBytes = sizeof(Transform);
+	cbv.pBuffer = static_cast<Transform*>(allocation.pCPU);
 
-	// settings of resource barrier
-	D3D12_RESOURCE_BARRIER barrier = {};
-	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-	barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-	barrier.Transition.pResource = m_pColorBuffer[m_FrameIndex].Get();
-	barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
-	barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
-	barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+	// settings of transformation matrix
+	for (uint32_t i = 0; i < transformCount; ++i)
+	{
+		cbv.pBuffer[i].View = m_View;
+		cbv.pBuffer[i].Proj = m_Proj;
+		cbv.pBuffer[i].PositionScale = m_Quantization.Scale;
+		cbv.pBuffer[i].PositionOffset = m_Quantization.Offset;
+	}
 
-	// resource barrier
-	m_pCmdList->ResourceBarrier(1, &barrier);
+	// upload heaps of the headless backends are ordinary cached memory
+	TransformOutput output = {};
+	output.Stride = sizeof(Transform);
+	output.WriteCombined = !m_pDevice->IsHeadless();
 
-	// set render target
-	m_pCmdList->OMSetRenderTargets(1, &m_HandleRTV[m_FrameIndex], FALSE, nullptr);
+	if (m_DrawInstanced)
+	{
+		// world matrices and colors go to the per-instance stream, the constant buffer keeps an identity
+		UploadAllocation instances;
+		if (!AllocateUpload(uint64_t(std::max(m_VisibleCount, 1u)) * sizeof(InstanceData), 16, instances))
+		{
+			printf("upload ring: no room for %u instances in frame %llu, nothing drawn\n", m_VisibleCount, static_cast<unsigned long long>(m_Timeline.GetFrameValue()));
+			return false;
+		}
 
-	// set clear color
-	float clearColor[] = { 0.25f, 0.25f, 0.25f, 1.0f };
+		InstanceData* pInstances = static_cast<InstanceData*>(instances.pCPU);
+		for (uint32_t i = 0; i < m_VisibleCount; ++i)
+		{
+			pInstances[i].Color = m_QuadColors[m_VisibleQuads[i]];
+		}
 
-	// clear render target view
-	m_pCmdList->ClearRenderTargetView(m_HandleRTV[m_FrameIndex], clearColor, 0, nullptr);
+		cbv.pBuffer->World = DirectX::XMMatrixIdentity();
+		output.pWorld = &pInstances->World;
+		output.Stride = sizeof(InstanceData);
 
-	// rendering
+		m_InstanceVBV.BufferLocation = instances.GPU;
+		m_InstanceVBV.SizeInBytes = static_cast<uint32_t>(m_VisibleCount * sizeof(InstanceData));
+		m_InstanceVBV.StrideInBytes = sizeof(InstanceData);
+	}
+	else
 	{
-		m_pCmdList->SetGraphicsRootSignature(m_pRootSignature.Get());
-		m_pCmdList->SetDescriptorHeaps(1, m_pHeapCBV.GetAddressOf());
-		m_pCmdList->SetGraphicsRootConstantBufferView(0, m_CBV[m_FrameIndex].Desc.BufferLocation);
-		m_pCmdList->SetPipelineState(m_pPSO.Get());
+		output.pWorld = &cbv.pBuffer->World;
+	}
 
-		m_pCmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-		m_pCmdList->IASetVertexBuffers(0, 1, &m_VBV);
-		m_pCmdList->IASetIndexBuffer(&m_IBV);
-		m_pCmdList->RSSetViewports(1, &m_Viewport);
-		m_pCmdList->RSSetScissorRects(1, &m_Scissor);
+	m_Transforms.ComputeIndexed(m_VisibleQuads.data(), m_VisibleCount, DirectX::XMMatrixIdentity(), output);
+	return true;
+}
 
-		m_pCmdList->DrawIndexedInstanced(6, 1, 0, 0, 0);
-	}
+//--------------------------------------------------------------------------------------------------------
+//	 record one share of the draws (called on worker threads, the render graph has placed the barriers)
+//--------------------------------------------------------------------------------------------------------
+void App::RecordCommands(GfxCommandList* pCmdList, uint32_t part, uint32_t partCount)
+{
+	PROFILE_SCOPE("RecordCommands");
+	uint32_t region = m_GpuProfiler.BeginRegion(pCmdList, "Draw list");
 
-	// settings of resource barrier
-	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-	barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-	barrier.Transition.pResource = m_pColorBuffer[m_FrameIndex].Get();
-	barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
-	barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
-	barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+	// rendering (state isn't inherited between command lists)
+	{
+		pCmdList->OMSetRenderTargets(1, &m_HandleRTV[m_BackBufferIndex].CPU);
+		pCmdList->SetGraphicsRootSignature(m_pRootSignature.get());
+		pCmdList->SetGraphicsRootConstantBufferView(0, m_CBV[m_FrameSlot].Desc.BufferLocation);
 
-	// resource barrier
-	m_pCmdList->ResourceBarrier(1, &barrier);
+		pCmdList->IASetPrimitiveTopology(GfxPrimitiveTopology::TriangleList);
+		pCmdList->IASetIndexBuffer(&m_IBV);
+		pCmdList->RSSetViewports(1, &m_Viewport);
+		pCmdList->RSSetScissorRects(1, &m_Scissor);
 
-	// finish recording command
-	m_pCmdList->Close();
+		if (m_DrawInstanced && m_VisibleCount > 0)
+		{
+			// slot 0 steps per vertex, slot 1 per instance
+			GfxVertexBufferView views[] = { m_VBV, m_InstanceVBV };
+			pCmdList->SetPipelineState(m_pDrawPSO);
+			pCmdList->IASetVertexBuffers(0, 2, views);
+			pCmdList->DrawIndexedInstanced(m_IndexCount, m_VisibleCount, 0, 0, 0);
+		}
+		else if (!m_DrawInstanced)
+		{
+			// one constant buffer per quad
+			pCmdList->SetPipelineState(m_pDrawPSO);
+			pCmdList->IASetVertexBuffers(0, 1, &m_VBV);
 
-	// execute command
-	ID3D12CommandList* ppCmdLists[] = { m_pCmdList.Get()};
-	m_pQueue->ExecuteCommandLists(1, ppCmdLists);
+			uint32_t first = m_VisibleCount * part / partCount;
+			uint32_t last = m_VisibleCount * (part + 1) / partCount;
+			for (uint32_t i = first; i < last; ++i)
+			{
+				pCmdList->SetGraphicsRootConstantBufferView(0, m_CBV[m_FrameSlot].Desc.BufferLocation + i * sizeof(Transform));
+				pCmdList->DrawIndexedInstanced(m_IndexCount, 1, 0, 0, 0);
+			}
+		}
+	}
 
-	// show on screen
-	Present(1);
+	m_GpuProfiler.EndRegion(pCmdList, region);
 }
 
 //--------------------------------------------------------------------------------------------------------
@@ -543,21 +774,11 @@ void App::Render()
 //--------------------------------------------------------------------------------------------------------
 void App::WaitGPU()
 {
+	PROFILE_SCOPE("WaitGPU");
 	assert(m_pQueue != nullptr);
-	assert(m_pFence != nullptr);
-	assert(m_FenceEvent != nullptr);
 
-	// signal
-	m_pQueue->Signal(m_pFence.Get(), m_FenceCounter[m_FrameIndex]);
-
-	// set event on completion of GPU processing
-	m_pFence->SetEventOnCompletion(m_FenceCounter[m_FrameIndex], m_FenceEvent);
-
-	// wait for signal
-	WaitForSingleObjectEx(m_FenceEvent, INFINITE, FALSE);
-
-	// increment counter
-	m_FenceCounter[m_FrameIndex]++;
+	// every frame ended so far, the current one hasn't been submitted yet
+	m_Timeline.WaitIdle();
 }
 
 //--------------------------------------------------------------------------------------------------------
@@ -565,25 +786,91 @@ void App::WaitGPU()
 //--------------------------------------------------------------------------------------------------------
 void App::Present(uint32_t interval)
 {
+	PROFILE_SCOPE("Present");
+
 	// show on screen
-	m_pSwapChain->Present(interval, 0);
+	m_pSwapChain->Present(interval);
 
-	// signal
-	const uint64_t currentValue = m_FenceCounter[m_FrameIndex];
-	m_pQueue->Signal(m_pFence.Get(), currentValue);
+	// signal (the next BeginFrame() waits only if its slot is still in flight)
+	m_Timeline.EndFrame();
 
 	// update back buffer index
-	m_FrameIndex = m_pSwapChain->GetCurrentBackBufferIndex();
+	m_BackBufferIndex = m_pSwapChain->GetCurrentBackBufferIndex();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 create vertex buffer and index buffer in device local memory, the data goes through the copy queue
+//--------------------------------------------------------------------------------------------------------
+bool App::CreateGeometry(const void* pVertices, uint64_t vertexSize, uint32_t vertexStride, const void* pIndices, uint32_t indexCount, GfxFormat indexFormat)
+{
+	uint64_t indexSize = uint64_t(indexCount) * MeshFile::GetIndexSize(indexFormat);
+	if (vertexSize > UINT32_MAX || indexSize == 0 || indexSize > UINT32_MAX)
+	{
+		return false;
+	}
+
+	// earlier frames may still draw the old geometry, it goes once the GPU is past the current frame
+	m_ReleaseQueue.Release([this, vb = m_VB, ib = m_IB]() mutable { m_GpuMemory.Free(vb); m_GpuMemory.Free(ib); }, m_Timeline.GetFrameValue(), m_VB.Size + m_IB.Size);
+	m_VB = GpuAllocation();
+	m_VB.Block = GpuMemoryAllocator::InvalidBlock;
+	m_IB = GpuAllocation();
+	m_IB.Block = GpuMemoryAllocator::InvalidBlock;
+
+	// generate vertex buffer
+	{
+		// range of a default heap, filled by the copy queue before the next frame draws
+		if (!m_GpuMemory.Allocate(GfxHeapType::Default, vertexSize, m_VB) || !m_Uploads.Upload(m_VB.pResource, m_VB.Offset, pVertices, vertexSize))
+		{
+			return false;
+		}
 
-	// wait if preparation for next frame hasn't been done
-	if (m_pFence->GetCompletedValue() < m_FenceCounter[m_FrameIndex])
+		// configuration of vertex buffer view
+		m_VBV.BufferLocation = m_VB.GPU;
+		m_VBV.SizeInBytes = static_cast<uint32_t>(vertexSize);
+		m_VBV.StrideInBytes = vertexStride;
+	}
+
+	// generate index buffer
 	{
-		m_pFence->SetEventOnCompletion(m_FenceCounter[m_FrameIndex], m_FenceEvent);
-		WaitForSingleObjectEx(m_FenceEvent, INFINITE, FALSE);
+		// range of a default heap, filled by the copy queue before the next frame draws
+		if (!m_GpuMemory.Allocate(GfxHeapType::Default, indexSize, m_IB) || !m_Uploads.Upload(m_IB.pResource, m_IB.Offset, pIndices, indexSize))
+		{
+			return false;
+		}
+
+		// settings of index buffer view
+		m_IBV.BufferLocation = m_IB.GPU;
+		m_IBV.Format = indexFormat;
+		m_IBV.SizeInBytes = static_cast<uint32_t>(indexSize);
 	}
 
-	// increment fence counter of next frame
-	m_FenceCounter[m_FrameIndex] = currentValue + 1;
+	m_IndexCount = indexCount;
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 take on an asset delivered by the streamer (render thread, within the budget of the frame)
+//--------------------------------------------------------------------------------------------------------
+void App::OnAssetStreamed(StreamedAsset& asset)
+{
+	if (asset.Handle != m_MeshHandle)
+	{
+		m_Streamer.Release(asset.Handle);
+		return;
+	}
+
+	// the pipelines were made for the layout of the header read in OnInit(), the file must still match it
+	const MeshFileHeader* pHeader = reinterpret_cast<const MeshFileHeader*>(asset.Data.data());
+	bool matches = asset.Succeeded && pHeader->Streams[0].Layout == m_VertexLayout && pHeader->Streams[0].Stride == MeshFile::GetVertexSize(m_VertexLayout)
+		&& pHeader->VertexCount > 0 && pHeader->IndexCount > 0;
+	if (!matches || !CreateGeometry(asset.Data.data() + pHeader->Streams[0].Offset, pHeader->Streams[0].Size, pHeader->Streams[0].Stride,
+		asset.Data.data() + pHeader->Indices.Offset, pHeader->IndexCount, pHeader->IndexFormat))
+	{
+		// the quads stay empty
+		m_IndexCount = 0;
+		m_Streamer.Release(m_MeshHandle);
+		m_MeshHandle = AssetStreamer::InvalidHandle;
+	}
 }
 
 //--------------------------------------------------------------------------------------------------------
@@ -591,7 +878,14 @@ void App::Present(uint32_t interval)
 //--------------------------------------------------------------------------------------------------------
 bool App::OnInit()
 {
-	// generate vertex buffer
+	// assets requested from now on arrive while frames run
+	if (!m_Streamer.Init(StreamThreads))
+	{
+		return false;
+	}
+
+	// generate vertex buffer and index buffer
+	if (m_MeshPath.empty())
 	{
 		// vertex data
 		Vertex vertices[] = {
@@ -601,359 +895,175 @@ bool App::OnInit()
 			{ DirectX::XMFLOAT3(-1.f, -1.f, 0.f), DirectX::XMFLOAT4(1.f, 0.f, 1.f, 1.f) }
 		};
 
-		// heap property
-		D3D12_HEAP_PROPERTIES prop = {};
-		prop.Type = D3D12_HEAP_TYPE_UPLOAD;
-		prop.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-		prop.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-		prop.CreationNodeMask = 1;
-		prop.VisibleNodeMask = 1;
-
-		// configuration of resource
-		D3D12_RESOURCE_DESC desc = {};
-		desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-		desc.Alignment = 0;
-		desc.Width = sizeof(vertices);
-		desc.Height = 1;
-		desc.DepthOrArraySize = 1;
-		desc.MipLevels = 1;
-		desc.Format = DXGI_FORMAT_UNKNOWN;
-		desc.SampleDesc.Count = 1;
-		desc.SampleDesc.Quality = 0;
-		desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-		desc.Flags = D3D12_RESOURCE_FLAG_NONE;
-
-		// generate resource
-		HRESULT hr = m_pDevice->CreateCommittedResource(
-			&prop,
-			D3D12_HEAP_FLAG_NONE,
-			&desc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(m_pVB.GetAddressOf()));
-		if (FAILED(hr))
-		{
-			return false;
-		}
+		// 16-bit indices halve the index fetch, MeshConverter picks them whenever the mesh fits
+		uint16_t indices[] = { 0, 1, 2, 0, 2, 3 };
 
-		// memory mapping
-		void* ptr = nullptr;
-		hr = m_pVB->Map(0, nullptr, &ptr); // translate physical address to logical address
-		if (FAILED(hr))
+		if (!CreateGeometry(vertices, sizeof(vertices), sizeof(Vertex), indices, 6, GfxFormat::R16_Uint))
 		{
 			return false;
 		}
 
-		// set vertex data to mapping destination
-		memcpy(ptr, vertices, sizeof(vertices));
-
-		// unmap memory
-		m_pVB->Unmap(0, nullptr);
+		m_VertexLayout = MeshVertexLayout::PositionColor;
+		m_Quantization = VertexFormat::GetIdentityQuantization();
 
-		// configuration of vertex buffer view
-		m_VBV.BufferLocation = m_pVB->GetGPUVirtualAddress();
-		m_VBV.SizeInBytes = static_cast<UINT>(sizeof(vertices));
-		m_VBV.StrideInBytes = static_cast<UINT>(sizeof(Vertex));
+		m_MeshRadius = 1.41421356f;
 	}
-
-	// generate index buffer
+	else
 	{
-		uint32_t indices[] = { 0, 1, 2, 0, 2, 3 };
-
-		// heap property
-		D3D12_HEAP_PROPERTIES prop = {};
-		prop.Type = D3D12_HEAP_TYPE_UPLOAD;
-		prop.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-		prop.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-		prop.CreationNodeMask = 1;
-		prop.VisibleNodeMask = 1;
-
-		// settings of resource
-		D3D12_RESOURCE_DESC desc = {};
-		desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-		desc.Alignment = 0;
-		desc.Width = sizeof(indices);
-		desc.Height = 1;
-		desc.DepthOrArraySize = 1;
-		desc.MipLevels = 1;
-		desc.Format = DXGI_FORMAT_UNKNOWN;
-		desc.SampleDesc.Count = 1;
-		desc.SampleDesc.Quality = 0;
-		desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-		desc.Flags = D3D12_RESOURCE_FLAG_NONE;
-
-		// generate resurce
-		HRESULT hr = m_pDevice->CreateCommittedResource(
-			&prop,
-			D3D12_HEAP_FLAG_NONE,
-			&desc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(m_pIB.GetAddressOf()));
-		if (FAILED(hr))
+		// the header decides the pipelines and the bounds, the streams are read by the streamer while the
+		// first frames run (only the header and the submesh table of the mapping are touched here)
+		MeshFile mesh;
+		if (!mesh.Open(m_MeshPath.c_str(), false))
 		{
 			return false;
 		}
 
-		// mapping
-		void* ptr = nullptr;
-		hr = m_pIB->Map(0, nullptr, &ptr);
-		if (FAILED(hr))
+		const MeshFileHeader& header = mesh.GetHeader();
+		const MeshFileStream& stream = header.Streams[0];
+		if (stream.Stride != MeshFile::GetVertexSize(stream.Layout) || header.VertexCount == 0 || header.IndexCount == 0)
 		{
 			return false;
 		}
 
-		// set index data to mapping destination
-		memcpy(ptr, indices, sizeof(indices));
-
-		// unmap memory
-		m_pIB->Unmap(0, nullptr);
-
-		// settings of index buffer view
-		m_IBV.BufferLocation = m_pIB->GetGPUVirtualAddress();
-		m_IBV.Format = DXGI_FORMAT_R32_UINT;
-		m_IBV.SizeInBytes = sizeof(indices);
-	}
+		m_MeshHandle = m_Streamer.Request(m_MeshPath.c_str(), AssetType::Mesh, AssetStreamer::ComputePriority(0.f, true));
+		if (m_MeshHandle == AssetStreamer::InvalidHandle)
+		{
+			return false;
+		}
 
-	// generate descriptor heap for constant buffer
-	{
-		D3D12_DESCRIPTOR_HEAP_DESC desc = {};
-		desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-		desc.NumDescriptors = 1 * FrameCount;
-		desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-		desc.NodeMask = 0;
+		// packed positions are relative to the bounds of the file
+		m_VertexLayout = stream.Layout;
+		m_Quantization = (stream.Layout == MeshVertexLayout::PackedPositionColor)
+			? VertexFormat::ComputeQuantization(header.BoundsMin, header.BoundsMax)
+			: VertexFormat::GetIdentityQuantization();
 
-		HRESULT hr = m_pDevice->CreateDescriptorHeap(
-			&desc,
-			IID_PPV_ARGS(m_pHeapCBV.GetAddressOf()));
-		if (FAILED(hr))
+		// sphere around the origin of the mesh, which is the position of each quad
+		float radiusSq = 0.f;
+		for (uint32_t i = 0; i < 3; ++i)
 		{
-			return false;
+			float extent = std::max(fabsf(header.BoundsMin[i]), fabsf(header.BoundsMax[i]));
+			radiusSq += extent * extent;
 		}
+		m_MeshRadius = sqrtf(radiusSq);
 	}
 
 	// generate constant buffer
 	{
-		// heap properties
-		D3D12_HEAP_PROPERTIES prop = {};
-		prop.Type = D3D12_HEAP_TYPE_UPLOAD;
-		prop.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-		prop.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-		prop.CreationNodeMask = 1;
-		prop.VisibleNodeMask = 1;
-
-		// configuration of resource
-		D3D12_RESOURCE_DESC desc = {};
-		desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-		desc.Alignment = 0;
-		desc.Width = sizeof(Transform);
-		desc.Height = 1;
-		desc.DepthOrArraySize = 1;
-		desc.MipLevels = 1;
-		desc.Format = DXGI_FORMAT_UNKNOWN;
-		desc.SampleDesc.Count = 1;
-		desc.SampleDesc.Quality = 0;
-		desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-		desc.Flags = D3D12_RESOURCE_FLAG_NONE;
-
-		size_t incrementSize = m_pDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-
-		for (uint32_t i = 0; i < FrameCount; ++i)
-		{
-			// generate resource
-			HRESULT hr = m_pDevice->CreateCommittedResource(
-				&prop,
-				D3D12_HEAP_FLAG_NONE,
-				&desc,
-				D3D12_RESOURCE_STATE_GENERIC_READ,
-				nullptr,
-				IID_PPV_ARGS(m_pCB[i].GetAddressOf()));
-			if (FAILED(hr))
-			{
-				return false;
-			}
-
-			D3D12_GPU_VIRTUAL_ADDRESS address = m_pCB[i]->GetGPUVirtualAddress();
-			D3D12_CPU_DESCRIPTOR_HANDLE handleCPU = m_pHeapCBV->GetCPUDescriptorHandleForHeapStart();
-			D3D12_GPU_DESCRIPTOR_HANDLE handleGPU = m_pHeapCBV->GetGPUDescriptorHandleForHeapStart();
-
-			handleCPU.ptr += incrementSize * i;
-			handleGPU.ptr += incrementSize * i;
+		// one persistently mapped ring shared by every frame in flight, sub-allocated per draw in Render()
+		uint64_t ringSize = UploadRingSize + uint64_t(m_Timeline.GetFramesInFlight()) * m_QuadCount * sizeof(Transform);
+		if (!m_UploadRing.Init(m_pDevice.get(), ringSize))
+		{
+			return false;
+		}
 
-			// settings of constant buffer view
-			m_CBV[i].HandleCPU = handleCPU;
-			m_CBV[i].HandleGPU = handleGPU;
-			m_CBV[i].Desc.BufferLocation = address;
+		for (uint32_t i = 0; i < m_Timeline.GetFramesInFlight(); ++i)
+		{
+			// settings of constant buffer view (bound as a root CBV, the buffer location is assigned every frame)
+			m_CBV[i].HandleCPU.ptr = 0;
+			m_CBV[i].HandleGPU.ptr = 0;
+			m_CBV[i].Desc.BufferLocation = 0;
 			m_CBV[i].Desc.SizeInBytes = sizeof(Transform);
+			m_CBV[i].pBuffer = nullptr;
+		}
 
-			// create constant buffer view
-			m_pDevice->CreateConstantBufferView(&m_CBV[i].Desc, handleCPU);
+		DirectX::XMVECTOR eyePos = DirectX::XMVectorSet(0.f, 0.f, 5.f, 0.f);
+		DirectX::XMVECTOR targetPos = DirectX::XMVectorZero();
+		DirectX::XMVECTOR upward = DirectX::XMVectorSet(0.f, 1.f, 0.f, 0.f);
 
-			// mapping
-			hr = m_pCB[i]->Map(0, nullptr, reinterpret_cast<void**>(&m_CBV[i].pBuffer));
-			if (FAILED(hr))
-			{
-				return false;
-			}
-
-			DirectX::XMVECTOR eyePos = DirectX::XMVectorSet(0.f, 0.f, 5.f, 0.f);
-			DirectX::XMVECTOR targetPos = DirectX::XMVectorZero();
-			DirectX::XMVECTOR upward = DirectX::XMVectorSet(0.f, 1.f, 0.f, 0.f);
+		float fovY = DirectX::XMConvertToRadians(37.5f);
+		float aspect = static_cast<float>(m_Width) / static_cast<float>(m_Height);
 
-			float fovY = DirectX::XMConvertToRadians(37.5f);
-			float aspect = static_cast<float>(m_Width) / static_cast<float>(m_Height);
+		// settings of transformation matrix
+		m_View = DirectX::XMMatrixLookAtRH(eyePos, targetPos, upward);
+		m_Proj = DirectX::XMMatrixPerspectiveFovRH(fovY, aspect, 1.f, 1000.f); // why right handed?
 
-			// settings of transformation matrix
-			m_CBV[i].pBuffer->World = DirectX::XMMatrixIdentity();
-			m_CBV[i].pBuffer->View = DirectX::XMMatrixLookAtRH(eyePos, targetPos, upward);
-			m_CBV[i].pBuffer->Proj = DirectX::XMMatrixPerspectiveFovRH(fovY, aspect, 1.f, 1000.f); // why right handed?
+		// quads on a square grid twice the view height, the rows above and below are culled (a single quad
+		// keeps its original size)
+		uint32_t columns = 1;
+		while (columns * columns < m_QuadCount)
+		{
+			columns++;
+		}
+		float cellSize = 6.4f / static_cast<float>(columns);
+		float quadScale = (m_QuadCount > 1) ? cellSize * 0.4f : 1.f;
+
+		m_Transforms.Clear();
+		m_Transforms.Reserve(m_QuadCount);
+		m_QuadColors.resize(m_QuadCount);
+		m_QuadRadius.assign(m_QuadCount, quadScale * m_MeshRadius);
+		m_VisibleQuads.resize(m_QuadCount);
+		m_VisibleCount = 0;
+		m_DrawQueue.Reserve(m_QuadCount);
+		for (uint32_t i = 0; i < m_QuadCount; ++i)
+		{
+			float u = (static_cast<float>(i % columns) + 0.5f) / static_cast<float>(columns);
+			float v = (static_cast<float>(i / columns) + 0.5f) / static_cast<float>(columns);
+			m_Transforms.Add(
+				DirectX::XMFLOAT3((u - 0.5f) * cellSize * columns, (0.5f - v) * cellSize * columns, 0.f),
+				DirectX::XMFLOAT4(0.f, 0.f, 0.f, 1.f),
+				DirectX::XMFLOAT3(quadScale, quadScale, quadScale));
+			m_QuadColors[i] = (m_QuadCount > 1) ? DirectX::XMFLOAT4(0.5f + 0.5f * u, 0.5f + 0.5f * v, 1.f - 0.5f * u, 1.f) : DirectX::XMFLOAT4(1.f, 1.f, 1.f, 1.f);
 		}
 	}
 
-	// generate root signature
+	// generate root signature (its key becomes part of the pipeline keys)
 	{
-		D3D12_ROOT_SIGNATURE_FLAGS flag = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
-		flag |= D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS;
-		flag |= D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS;
-		flag |= D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS;
-
 		// configuration of root parameter
-		D3D12_ROOT_PARAMETER param = {};
-		param.ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
-		param.Descriptor.ShaderRegister = 0;
-		param.Descriptor.RegisterSpace = 0;
-		param.ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+		GfxRootParameter param = {};
+		param.ParameterType = GfxRootParameterType::CBV;
+		param.ShaderRegister = 0;
+		param.RegisterSpace = 0;
+		param.ShaderVisibility = GfxShaderVisibility::Vertex;
 
 		// configuration of root signature
-		D3D12_ROOT_SIGNATURE_DESC desc = {};
+		GfxRootSignatureDesc desc = {};
 		desc.NumParameters = 1;
-		desc.NumStaticSamplers = 0;
 		desc.pParameters = &param;
-		desc.pStaticSamplers = nullptr;
-		desc.Flags = flag;
-
-		ComPtr<ID3DBlob> pBlob;
-		ComPtr<ID3DBlob> pErrorBlob;
-
-		// serialize
-		HRESULT hr = D3D12SerializeRootSignature(
-			&desc,
-			D3D_ROOT_SIGNATURE_VERSION_1_0,
-			pBlob.GetAddressOf(),
-			pErrorBlob.GetAddressOf());
-		if (FAILED(hr))
-		{
-			return false;
-		}
+		desc.AllowInputLayout = true;
 
 		// generate root signature
-		hr = m_pDevice->CreateRootSignature(
-			0,
-			pBlob->GetBufferPointer(),
-			pBlob->GetBufferSize(),
-			IID_PPV_ARGS(m_pRootSignature.GetAddressOf()));
-		if (FAILED(hr))
+		if (!m_pDevice->CreateRootSignature(desc, m_pRootSignature))
 		{
 			return false;
 		}
+		m_RootSignatureKey = PipelineCache::ComputeKey(desc);
 	}
 
 	// generate pipeline state
 	{
-		// configuration of input layout
-		D3D12_INPUT_ELEMENT_DESC elements[2];
-		elements[0].SemanticName = "POSITION";
-		elements[0].SemanticIndex = 0;
-		elements[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-		elements[0].InputSlot = 0;
-		elements[0].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
-		elements[0].InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
-		elements[0].InstanceDataStepRate = 0;
-
-		elements[1].SemanticName = "COLOR";
-		elements[1].SemanticIndex = 0;
-		elements[1].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-		elements[1].InputSlot = 0;
-		elements[1].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
-		elements[1].InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
-		elements[1].InstanceDataStepRate = 0;
-
-		// configuration of rasterizer state
-		D3D12_RASTERIZER_DESC descRS = {};
-		descRS.FillMode = D3D12_FILL_MODE_SOLID;
-		descRS.CullMode = D3D12_CULL_MODE_NONE; // I'd change here later - just as the experiment
-		descRS.FrontCounterClockwise = FALSE;
-		descRS.DepthBias = D3D12_DEFAULT_DEPTH_BIAS;
-		descRS.DepthBiasClamp = D3D12_DEFAULT_DEPTH_BIAS_CLAMP;
-		descRS.SlopeScaledDepthBias = D3D12_DEFAULT_SLOPE_SCALED_DEPTH_BIAS;
-		descRS.DepthClipEnable = FALSE;
-		descRS.MultisampleEnable = FALSE;
-		descRS.AntialiasedLineEnable = FALSE;
-		descRS.ForcedSampleCount = 0;
-		descRS.ConservativeRaster = D3D12_CONSERVATIVE_RASTERIZATION_MODE_OFF;
-
-		// blend settings of render target
-		D3D12_RENDER_TARGET_BLEND_DESC descRTBS = {
-			FALSE,
-			FALSE,
-			D3D12_BLEND_ONE,
-			D3D12_BLEND_ZERO,
-			D3D12_BLEND_OP_ADD,
-			D3D12_BLEND_ONE,
-			D3D12_BLEND_ZERO,
-			D3D12_BLEND_OP_ADD,
-			D3D12_LOGIC_OP_NOOP,
-			D3D12_COLOR_WRITE_ENABLE_ALL
-		};
-
-		// configuration of blend state
-		D3D12_BLEND_DESC descBS;
-		descBS.AlphaToCoverageEnable = FALSE;
-		descBS.IndependentBlendEnable = FALSE;
-		for (UINT i = 0; i < D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
+		// input layout of the vertex buffer, the instanced variant appends slot 1
+		m_VertexElementCount = VertexFormat::GetInputLayout(m_VertexLayout, 0, m_InputElements);
+		if (m_VertexElementCount == 0)
 		{
-			descBS.RenderTarget[i] = descRTBS;
+			return false;
 		}
 
-		ComPtr<ID3DBlob> pVSBlob;
-		ComPtr<ID3DBlob> pPSBlob;
+		// rows of the world matrix and color of InstanceData
+		for (uint32_t i = 0; i < InstanceElementCount; ++i)
+		{
+			GfxInputElementDesc& element = m_InputElements[m_VertexElementCount + i];
+			element.SemanticName = (i < 4) ? "WORLD" : "COLOR";
+			element.SemanticIndex = (i < 4) ? i : 1;
+			element.Format = GfxFormat::R32G32B32A32_Float;
+			element.InputSlot = 1;
+			element.AlignedByteOffset = GfxAppendAlignedElement;
+			element.InputSlotClass = GfxInputClassification::PerInstanceData;
+			element.InstanceDataStepRate = 1;
+		}
 
-		// read vertex shader
-		HRESULT hr = D3DReadFileToBlob(L"SimpleVS.cso", pVSBlob.GetAddressOf());
-		if (FAILED(hr))
+		if (!LoadShaders())
 		{
 			return false;
 		}
 
-		hr = D3DReadFileToBlob(L"SimplePS.cso", pPSBlob.GetAddressOf());
-		if (FAILED(hr))
+		// pipelines are loaded from the library when a previous run compiled them
+		if (!m_PipelineCache.Init(m_pDevice.get(), PipelineCompileThreads, PipelineLibraryPath))
 		{
 			return false;
 		}
 
-		// configuration of pipeline state
-		D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = {};
-		desc.InputLayout = { elements, _countof(elements) };
-		desc.pRootSignature = m_pRootSignature.Get();
-		desc.VS = { pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize() };
-		desc.PS = { pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize() };
-		desc.RasterizerState = descRS;
-		desc.BlendState = descBS;
-		desc.DepthStencilState.DepthEnable = FALSE;
-		desc.DepthStencilState.StencilEnable = FALSE;
-		desc.SampleMask = UINT_MAX;
-		desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-		desc.NumRenderTargets = 1;
-		desc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
-		desc.DSVFormat = DXGI_FORMAT_UNKNOWN;
-		desc.SampleDesc.Count = 1;
-		desc.SampleDesc.Quality = 0;
-
-		// generate pipeline state
-		hr = m_pDevice->CreateGraphicsPipelineState(
-			&desc,
-			IID_PPV_ARGS(m_pPSO.GetAddressOf()));
-		if (FAILED(hr))
+		// every frame needs the base variant, so it is waited for
+		if (!RequestPipelines() || !m_PipelineCache.Wait(m_PSO))
 		{
 			return false;
 		}
@@ -969,34 +1079,130 @@ bool App::OnInit()
 		m_Viewport.MaxDepth = 1.f;
 
 		m_Scissor.left = 0;
-		m_Scissor.right = m_Width;
+		m_Scissor.right = static_cast<int32_t>(m_Width);
 		m_Scissor.top = 0;
-		m_Scissor.bottom = m_Height;
+		m_Scissor.bottom = static_cast<int32_t>(m_Height);
 	}
 
 	return true;
 }
 
 //--------------------------------------------------------------------------------------------------------
-// processing on termination
+//	 find the compiled shaders and watch their sources
 //--------------------------------------------------------------------------------------------------------
-void App::OnTerm()
+bool App::LoadShaders()
 {
-	for (uint32_t i = 0; i < FrameCount; ++i)
+	// a packed file is mapped at once, loose files are read one by one
+	m_Shaders.Open(ShaderStorePath);
+	for (const ShaderFile& shader : ShaderFiles)
 	{
-		if (m_pCB[i].Get() != nullptr)
+		// headless backends run without compiled shaders
+		if (m_Shaders.Find(shader.pName).pShaderBytecode == nullptr
+			&& !m_Shaders.LoadFile(shader.pName, shader.pBytecodePath)
+			&& !m_pDevice->IsHeadless())
 		{
-			m_pCB[i]->Unmap(0, nullptr);
-			memset(&m_CBV[i], 0, sizeof(m_CBV[i]));
+			return false;
 		}
-		m_pCB[i].Reset();
+
+#if defined(_WIN32)
+		// edited sources are rebuilt with the options of the project
+		if (!m_pDevice->IsHeadless())
+		{
+			std::string command = std::string("fxc /nologo /T ") + shader.pProfile + " /E main /Fo " + shader.pBytecodePath + " " + shader.pSourcePath;
+			m_Shaders.AddWatch(shader.pName, shader.pSourcePath, shader.pBytecodePath, command.c_str());
+		}
+#endif
 	}
 
-	m_pIB.Reset();
-	m_pVB.Reset();
-	m_pPSO.Reset();
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 request the pipelines of the current shaders (the cache returns the existing ones if nothing changed)
+//--------------------------------------------------------------------------------------------------------
+bool App::RequestPipelines()
+{
+	// configuration of rasterizer state
+	GfxRasterizerDesc descRS = {};
+	descRS.FillMode = GfxFillMode::Solid;
+	descRS.CullMode = GfxCullMode::None; // I'd change here later - just as the experiment
+	descRS.FrontCounterClockwise = false;
+	descRS.DepthClipEnable = false;
+
+	// blend settings of render target
+	GfxRenderTargetBlendDesc descRTBS = {
+		false,
+		GfxBlend::One,
+		GfxBlend::Zero,
+		GfxBlendOp::Add,
+		GfxBlend::One,
+		GfxBlend::Zero,
+		GfxBlendOp::Add,
+		GfxColorWriteEnableAll
+	};
+
+	// configuration of pipeline state
+	GfxGraphicsPipelineDesc desc = {};
+	desc.pInputElementDescs = m_InputElements;
+	desc.NumInputElements = m_VertexElementCount;
+	desc.pRootSignature = m_pRootSignature.get();
+	desc.VS = m_Shaders.Find("SimpleVS");
+	desc.PS = m_Shaders.Find("SimplePS");
+	desc.RasterizerState = descRS;
+	desc.BlendState = descRTBS;
+	desc.DepthStencilState.DepthEnable = false;
+	desc.DepthStencilState.DepthWriteEnable = false;
+	desc.DepthStencilState.DepthFunc = GfxComparisonFunc::Less;
+	desc.PrimitiveTopology = GfxPrimitiveTopology::TriangleList;
+	desc.RTVFormat = GfxFormat::R8G8B8A8_Unorm_sRGB;
+	desc.DSVFormat = GfxFormat::Unknown;
+	m_PSO = m_PipelineCache.Request(desc, m_RootSignatureKey);
+
+	// instanced variant compiles in the background (the desc is copied)
+	desc.NumInputElements = m_VertexElementCount + InstanceElementCount;
+	desc.VS = m_Shaders.Find("SimpleInstancedVS");
+	m_PSOInstanced = m_PipelineCache.Request(desc, m_RootSignatureKey);
+
+	m_ShaderGeneration = m_Shaders.GetGeneration();
+	return (m_PSO != InvalidPipelineHandle) && (m_PSOInstanced != InvalidPipelineHandle);
+}
+
+//--------------------------------------------------------------------------------------------------------
+// processing on termination
+//--------------------------------------------------------------------------------------------------------
+void App::OnTerm()
+{
+	// reads in flight are waited for, assets that didn't arrive are dropped
+	m_Streamer.Term();
+	m_MeshHandle = AssetStreamer::InvalidHandle;
+
+	// the GPU is idle, everything released during the run can go (descriptors before their pools)
+	m_ReleaseQueue.Term();
+
+	for (uint32_t i = 0; i < FrameTimeline::MaxFramesInFlight; ++i)
+	{
+		memset(&m_CBV[i], 0, sizeof(m_CBV[i]));
+	}
+	m_Transforms.Clear();
+	m_QuadColors.clear();
+	m_QuadRadius.clear();
+	m_VisibleQuads.clear();
+	m_DrawQueue.Reset();
+	m_UploadRing.Term();
+
+	m_GpuMemory.Free(m_IB);
+	m_GpuMemory.Free(m_VB);
+	m_pDrawPSO = nullptr;
+	m_pReadyPSOInstanced = nullptr;
+	m_pReadyPSO = nullptr;
+	m_PSOInstanced = InvalidPipelineHandle;
+	m_PSO = InvalidPipelineHandle;
+	m_PipelineCache.Term();
+	m_Shaders.Close();
+	m_pRootSignature.reset();
 }
 
+#if defined(_WIN32)
 //--------------------------------------------------------------------------------------------------------
 //	 window procedure
 //--------------------------------------------------------------------------------------------------------
@@ -1019,3 +1225,4 @@ LRESULT App::WndProc(HWND hWnd, UINT msg, WPARAM wp, LPARAM lp)
 
 	return DefWindowProc(hWnd, msg, wp, lp);
 }
+#endif // defined(_WIN32)
@@ -0,0 +1,445 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <AssetArchive.h>
+#include <Lz4Codec.h>
+#include <WorkerPool.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+
+
+namespace /* anonymous */ {
+
+	// the header and the tables are read in place from the mapping, their layout must not depend on the compiler
+	static_assert(sizeof(AssetArchiveHeader) == 48, "AssetArchiveHeader layout changed, bump AssetArchiveVersion");
+	static_assert(sizeof(AssetArchiveEntry) == 32, "AssetArchiveEntry layout changed, bump AssetArchiveVersion");
+	static_assert(sizeof(AssetArchiveChunk) == 16, "AssetArchiveChunk layout changed, bump AssetArchiveVersion");
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint64_t FnvOffsetBasis = 0xcbf29ce484222325ull; // FNV-1a 64-bit start value (keys are stored in files)
+	const uint64_t FnvPrime = 0x100000001b3ull; // FNV-1a 64-bit multiplier
+	const uint32_t StoreThreshold = 8; // entries are compressed when they shrink by at least 1/8
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// PendingChunk structure - chunk of a source while the archive is written
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct PendingChunk
+	{
+		uint32_t Source; // index of the source
+		uint64_t SourceOffset; // of the chunk in the contents of the source
+		uint32_t Size; // decompressed size
+		std::vector<uint8_t> Block; // LZ4 block, empty when the chunk is stored as is
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// offset rounded up to the placement of uncompressed entries and the tables
+	//----------------------------------------------------------------------------------------------------
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return (offset + AssetArchiveAlignment - 1) & ~(AssetArchiveAlignment - 1);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// zeros up to the next placement boundary
+	//----------------------------------------------------------------------------------------------------
+	void WritePadding(std::ofstream& file, uint64_t& offset)
+	{
+		static const char Zeros[AssetArchiveAlignment] = {};
+		uint64_t aligned = AlignOffset(offset);
+		file.write(Zeros, static_cast<std::streamsize>(aligned - offset));
+		offset = aligned;
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetArchive class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+AssetArchive::AssetArchive()
+	: m_pHeader(nullptr)
+	, m_pEntries(nullptr)
+	, m_pChunks(nullptr)
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 map and validate an archive
+//--------------------------------------------------------------------------------------------------------
+bool AssetArchive::Open(const char* path)
+{
+	Close();
+
+	// lookups jump around the table and assets are read in any order
+	if (!m_File.Open(path, false))
+	{
+		return false;
+	}
+
+	if (!Validate())
+	{
+		m_File.Close();
+		return false;
+	}
+
+	m_pHeader = reinterpret_cast<const AssetArchiveHeader*>(m_File.GetData());
+	m_pEntries = reinterpret_cast<const AssetArchiveEntry*>(m_File.GetData() + m_pHeader->EntriesOffset);
+	m_pChunks = reinterpret_cast<const AssetArchiveChunk*>(m_File.GetData() + m_pHeader->ChunksOffset);
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 unmap
+//--------------------------------------------------------------------------------------------------------
+void AssetArchive::Close()
+{
+	m_pHeader = nullptr;
+	m_pEntries = nullptr;
+	m_pChunks = nullptr;
+	m_File.Close();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 entry of a path key
+//--------------------------------------------------------------------------------------------------------
+const AssetArchiveEntry* AssetArchive::Find(uint64_t pathKey) const
+{
+	if (m_pHeader == nullptr)
+	{
+		return nullptr;
+	}
+
+	const AssetArchiveEntry* pEnd = m_pEntries + m_pHeader->EntryCount;
+	const AssetArchiveEntry* pEntry = std::lower_bound(m_pEntries, pEnd, pathKey,
+		[](const AssetArchiveEntry& entry, uint64_t key) { return entry.PathKey < key; });
+	return (pEntry != pEnd && pEntry->PathKey == pathKey) ? pEntry : nullptr;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 uncompressed contents in the mapping
+//--------------------------------------------------------------------------------------------------------
+const uint8_t* AssetArchive::GetData(const AssetArchiveEntry& entry) const
+{
+	return (entry.ChunkCount == 0) ? m_File.GetData() + entry.Offset : nullptr;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 contents of an entry into memory
+//--------------------------------------------------------------------------------------------------------
+bool AssetArchive::Read(const AssetArchiveEntry& entry, void* pDest, WorkerPool* pPool) const
+{
+	uint8_t* pBytes = static_cast<uint8_t*>(pDest);
+	if (entry.ChunkCount == 0)
+	{
+		if (entry.Size > 0)
+		{
+			memcpy(pBytes, GetData(entry), static_cast<size_t>(entry.Size));
+		}
+		return true;
+	}
+
+	// chunks decompress into their own range of the destination, in any order
+	const AssetArchiveChunk* pChunks = m_pChunks + entry.FirstChunk;
+	if (pPool == nullptr || pPool->GetWorkerCount() == 1 || entry.ChunkCount == 1)
+	{
+		for (uint32_t i = 0; i < entry.ChunkCount; ++i)
+		{
+			if (!ReadChunk(pChunks[i], pBytes + uint64_t(i) * AssetArchiveChunkSize))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	std::atomic<bool> succeeded(true);
+	pPool->Dispatch(entry.ChunkCount, [this, pChunks, pBytes, &succeeded](uint32_t jobIndex, uint32_t)
+	{
+		if (!ReadChunk(pChunks[jobIndex], pBytes + uint64_t(jobIndex) * AssetArchiveChunkSize))
+		{
+			succeeded.store(false, std::memory_order_relaxed);
+		}
+	});
+	return succeeded.load(std::memory_order_relaxed);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 contents of an entry into a vector
+//--------------------------------------------------------------------------------------------------------
+bool AssetArchive::Read(const AssetArchiveEntry& entry, std::vector<uint8_t>& data, WorkerPool* pPool) const
+{
+	data.resize(static_cast<size_t>(entry.Size));
+	return Read(entry, data.data(), pPool);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 key of a path
+//--------------------------------------------------------------------------------------------------------
+uint64_t AssetArchive::ComputePathKey(const char* path)
+{
+	uint64_t hash = FnvOffsetBasis;
+	for (const char* p = path; *p != '\0'; ++p)
+	{
+		uint8_t c = (*p == '\\') ? '/' : static_cast<uint8_t>(*p);
+		hash = (hash ^ c) * FnvPrime;
+	}
+	return hash;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 write an archive
+//--------------------------------------------------------------------------------------------------------
+bool AssetArchive::Write(const char* path, const AssetArchiveSource* pSources, uint32_t count, WorkerPool* pPool)
+{
+	// table sorted by path key, paths must not collide
+	std::vector<AssetArchiveEntry> entries(count);
+	std::vector<uint32_t> sourceOfEntry(count);
+	std::vector<PendingChunk> pending;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		entries[i] = AssetArchiveEntry();
+		entries[i].PathKey = ComputePathKey(pSources[i].pPath);
+		entries[i].Size = pSources[i].Size;
+		sourceOfEntry[i] = i;
+
+		for (uint64_t offset = 0; pSources[i].Compress && offset < pSources[i].Size; offset += AssetArchiveChunkSize)
+		{
+			uint32_t size = static_cast<uint32_t>(std::min<uint64_t>(pSources[i].Size - offset, AssetArchiveChunkSize));
+			pending.push_back(PendingChunk{ i, offset, size, std::vector<uint8_t>() });
+		}
+	}
+
+	std::sort(sourceOfEntry.begin(), sourceOfEntry.end(), [&entries](uint32_t a, uint32_t b) { return entries[a].PathKey < entries[b].PathKey; });
+	for (uint32_t i = 1; i < count; ++i)
+	{
+		if (entries[sourceOfEntry[i - 1]].PathKey == entries[sourceOfEntry[i]].PathKey)
+		{
+			return false;
+		}
+	}
+
+	// every chunk on its own, a chunk which doesn't shrink is stored as is
+	std::vector<Lz4Codec> codecs((pPool != nullptr) ? pPool->GetWorkerCount() : 1);
+	auto compress = [pSources, &pending, &codecs](uint32_t jobIndex, uint32_t workerIndex)
+	{
+		PendingChunk& chunk = pending[jobIndex];
+		const uint8_t* pData = static_cast<const uint8_t*>(pSources[chunk.Source].pData) + chunk.SourceOffset;
+		chunk.Block.resize(chunk.Size);
+		size_t size = codecs[workerIndex].Compress(pData, chunk.Size, chunk.Block.data(), chunk.Size - 1);
+		chunk.Block.resize(size);
+		chunk.Block.shrink_to_fit();
+	};
+	if (pPool != nullptr)
+	{
+		pPool->Dispatch(static_cast<uint32_t>(pending.size()), compress);
+	}
+	else
+	{
+		for (uint32_t i = 0; i < static_cast<uint32_t>(pending.size()); ++i)
+		{
+			compress(i, 0);
+		}
+	}
+
+	// entries which don't shrink enough are worth more as zero-copy reads than as a few saved bytes
+	std::vector<uint64_t> storedSizes(count, 0);
+	for (const PendingChunk& chunk : pending)
+	{
+		storedSizes[chunk.Source] += chunk.Block.empty() ? chunk.Size : chunk.Block.size();
+	}
+	std::vector<bool> compressed(count, false);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		compressed[i] = pSources[i].Compress && pSources[i].Size > 0 && storedSizes[i] <= pSources[i].Size - pSources[i].Size / StoreThreshold;
+	}
+
+	// header, tables, then the contents in the order of the sources (assets packed together are read together)
+	std::vector<AssetArchiveChunk> chunks;
+	std::vector<uint32_t> pendingOfChunk;
+	for (uint32_t i = 0, p = 0; i < count; ++i)
+	{
+		if (compressed[i])
+		{
+			entries[i].FirstChunk = static_cast<uint32_t>(chunks.size());
+		}
+		for (; p < pending.size() && pending[p].Source == i; ++p)
+		{
+			if (compressed[i])
+			{
+				const PendingChunk& chunk = pending[p];
+				chunks.push_back(AssetArchiveChunk{ 0, chunk.Block.empty() ? chunk.Size : static_cast<uint32_t>(chunk.Block.size()), chunk.Size });
+				pendingOfChunk.push_back(p);
+				entries[i].ChunkCount++;
+			}
+		}
+	}
+
+	AssetArchiveHeader header = {};
+	header.Magic = AssetArchiveMagic;
+	header.Version = AssetArchiveVersion;
+	header.EntryCount = count;
+	header.ChunkCount = static_cast<uint32_t>(chunks.size());
+	header.EntriesOffset = AlignOffset(sizeof(AssetArchiveHeader));
+	header.ChunksOffset = AlignOffset(header.EntriesOffset + uint64_t(count) * sizeof(AssetArchiveEntry));
+	header.DataOffset = AlignOffset(header.ChunksOffset + chunks.size() * sizeof(AssetArchiveChunk));
+
+	uint64_t offset = header.DataOffset;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		AssetArchiveEntry& entry = entries[i];
+		if (entry.ChunkCount == 0)
+		{
+			entry.Offset = AlignOffset(offset);
+			offset = entry.Offset + entry.Size;
+			continue;
+		}
+
+		entry.Offset = offset;
+		for (uint32_t c = entry.FirstChunk; c < entry.FirstChunk + entry.ChunkCount; ++c)
+		{
+			chunks[c].Offset = offset;
+			offset += chunks[c].StoredSize;
+		}
+	}
+	header.FileSize = offset;
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return false;
+	}
+
+	offset = sizeof(AssetArchiveHeader);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	WritePadding(file, offset);
+	for (uint32_t source : sourceOfEntry)
+	{
+		file.write(reinterpret_cast<const char*>(&entries[source]), sizeof(AssetArchiveEntry));
+		offset += sizeof(AssetArchiveEntry);
+	}
+	WritePadding(file, offset);
+	file.write(reinterpret_cast<const char*>(chunks.data()), static_cast<std::streamsize>(chunks.size() * sizeof(AssetArchiveChunk)));
+	offset += chunks.size() * sizeof(AssetArchiveChunk);
+	WritePadding(file, offset);
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const AssetArchiveEntry& entry = entries[i];
+		if (entry.ChunkCount == 0)
+		{
+			WritePadding(file, offset);
+			file.write(static_cast<const char*>(pSources[i].pData), static_cast<std::streamsize>(entry.Size));
+			offset += entry.Size;
+			continue;
+		}
+
+		for (uint32_t c = entry.FirstChunk; c < entry.FirstChunk + entry.ChunkCount; ++c)
+		{
+			const PendingChunk& chunk = pending[pendingOfChunk[c]];
+			const char* pData = chunk.Block.empty()
+				? static_cast<const char*>(pSources[i].pData) + chunk.SourceOffset
+				: reinterpret_cast<const char*>(chunk.Block.data());
+			file.write(pData, chunks[c].StoredSize);
+			offset += chunks[c].StoredSize;
+		}
+	}
+
+	return static_cast<bool>(file.flush());
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 check the header and the tables (the contents themselves are not touched)
+//--------------------------------------------------------------------------------------------------------
+bool AssetArchive::Validate() const
+{
+	uint64_t fileSize = m_File.GetSize();
+	if (fileSize < sizeof(AssetArchiveHeader))
+	{
+		return false;
+	}
+
+	const AssetArchiveHeader& header = *reinterpret_cast<const AssetArchiveHeader*>(m_File.GetData());
+	if (header.Magic != AssetArchiveMagic || header.Version != AssetArchiveVersion || header.FileSize != fileSize)
+	{
+		return false;
+	}
+
+	// the tables follow each other between the header and the contents
+	if (header.EntriesOffset > fileSize || header.ChunksOffset > fileSize || header.DataOffset > fileSize)
+	{
+		return false;
+	}
+
+	uint64_t entriesEnd = header.EntriesOffset + uint64_t(header.EntryCount) * sizeof(AssetArchiveEntry);
+	uint64_t chunksEnd = header.ChunksOffset + uint64_t(header.ChunkCount) * sizeof(AssetArchiveChunk);
+	if ((header.EntriesOffset % AssetArchiveAlignment) != 0 || (header.ChunksOffset % AssetArchiveAlignment) != 0
+		|| header.EntriesOffset < sizeof(AssetArchiveHeader) || entriesEnd > header.ChunksOffset
+		|| chunksEnd > header.DataOffset)
+	{
+		return false;
+	}
+
+	const AssetArchiveEntry* pEntries = reinterpret_cast<const AssetArchiveEntry*>(m_File.GetData() + header.EntriesOffset);
+	const AssetArchiveChunk* pChunks = reinterpret_cast<const AssetArchiveChunk*>(m_File.GetData() + header.ChunksOffset);
+	for (uint32_t i = 0; i < header.EntryCount; ++i)
+	{
+		// keys are strictly increasing for the binary search
+		const AssetArchiveEntry& entry = pEntries[i];
+		if (i > 0 && pEntries[i - 1].PathKey >= entry.PathKey)
+		{
+			return false;
+		}
+
+		if (entry.ChunkCount == 0)
+		{
+			if ((entry.Offset % AssetArchiveAlignment) != 0 || entry.Offset < header.DataOffset || entry.Offset > fileSize || entry.Size > fileSize - entry.Offset)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		// every chunk but the last is full and lies among the contents
+		uint64_t chunkCount = (entry.Size + AssetArchiveChunkSize - 1) / AssetArchiveChunkSize;
+		if (entry.FirstChunk > header.ChunkCount || entry.ChunkCount != chunkCount || entry.ChunkCount > header.ChunkCount - entry.FirstChunk)
+		{
+			return false;
+		}
+
+		for (uint32_t c = 0; c < entry.ChunkCount; ++c)
+		{
+			const AssetArchiveChunk& chunk = pChunks[entry.FirstChunk + c];
+			uint64_t size = std::min<uint64_t>(entry.Size - uint64_t(c) * AssetArchiveChunkSize, AssetArchiveChunkSize);
+			if (chunk.Size != size || chunk.StoredSize == 0 || chunk.StoredSize > chunk.Size
+				|| chunk.Offset < header.DataOffset || chunk.Offset > fileSize || chunk.StoredSize > fileSize - chunk.Offset)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 one chunk into its range of the destination
+//--------------------------------------------------------------------------------------------------------
+bool AssetArchive::ReadChunk(const AssetArchiveChunk& chunk, uint8_t* pDest) const
+{
+	const uint8_t* pBlock = m_File.GetData() + chunk.Offset;
+	if (chunk.StoredSize == chunk.Size)
+	{
+		memcpy(pDest, pBlock, chunk.Size);
+		return true;
+	}
+	return Lz4Codec::Decompress(pBlock, chunk.StoredSize, pDest, chunk.Size);
+}
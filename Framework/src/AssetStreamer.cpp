@@ -0,0 +1,500 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <AssetStreamer.h>
+#include <AssetArchive.h>
+#include <MeshFile.h>
+#include <Profiler.h>
+#include <algorithm>
+#include <memory>
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t FullQueueSleep = 100; // microseconds an I/O thread sleeps while the completion queue is full
+
+	//----------------------------------------------------------------------------------------------------
+	// milliseconds between two time points
+	//----------------------------------------------------------------------------------------------------
+	double ElapsedMs(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - begin).count();
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// read a whole file with plain reads (the data is consumed once, a mapping would only add page faults)
+	//----------------------------------------------------------------------------------------------------
+	bool ReadWholeFile(const std::string& path, std::vector<uint8_t>& data)
+	{
+#if defined(_WIN32)
+		HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER size = {};
+		bool succeeded = GetFileSizeEx(hFile, &size) != FALSE;
+		if (succeeded)
+		{
+			data.resize(static_cast<size_t>(size.QuadPart));
+			for (uint64_t done = 0; succeeded && done < data.size();)
+			{
+				DWORD count = 0;
+				DWORD request = static_cast<DWORD>(std::min<uint64_t>(data.size() - done, 1u << 30));
+				succeeded = ReadFile(hFile, data.data() + done, request, &count, nullptr) != FALSE && count > 0;
+				done += count;
+			}
+		}
+		CloseHandle(hFile);
+		return succeeded;
+#else
+		int file = open(path.c_str(), O_RDONLY);
+		if (file < 0)
+		{
+			return false;
+		}
+
+		struct stat info = {};
+		bool succeeded = fstat(file, &info) == 0;
+		if (succeeded)
+		{
+			posix_fadvise(file, 0, 0, POSIX_FADV_SEQUENTIAL);
+			data.resize(static_cast<size_t>(info.st_size));
+			for (size_t done = 0; succeeded && done < data.size();)
+			{
+				ssize_t count = read(file, data.data() + done, data.size() - done);
+				succeeded = count > 0;
+				done += succeeded ? static_cast<size_t>(count) : 0;
+			}
+		}
+		close(file);
+		return succeeded;
+#endif
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AssetStreamer class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+AssetStreamer::AssetStreamer()
+	: m_NextSequence(0)
+	, m_Quit(false)
+	, m_pArchive(nullptr)
+	, m_PendingCount(0)
+	, m_Stats()
+{
+	// meshes are handed out as whole files, checked once here instead of on the render thread
+	m_Decoders[static_cast<uint32_t>(AssetType::Mesh)] = [](std::vector<uint8_t>& data)
+	{
+		return MeshFile::IsValid(data.data(), data.size());
+	};
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+AssetStreamer::~AssetStreamer()
+{
+	Term();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 initialization
+//--------------------------------------------------------------------------------------------------------
+bool AssetStreamer::Init(uint32_t ioThreadCount, uint32_t completionCapacity)
+{
+	if (ioThreadCount == 0)
+	{
+		return false;
+	}
+
+	Term();
+	if (!m_Completions.Init(completionCapacity))
+	{
+		return false;
+	}
+
+	m_Quit = false;
+	m_NextSequence = 0;
+	m_PendingCount = 0;
+	m_Stats = StreamStats();
+	m_VisibleLatencies.clear();
+
+	m_Threads.reserve(ioThreadCount);
+	for (uint32_t i = 0; i < ioThreadCount; ++i)
+	{
+		m_Threads.emplace_back(&AssetStreamer::ThreadMain, this, i);
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 termination
+//--------------------------------------------------------------------------------------------------------
+void AssetStreamer::Term()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Quit = true;
+		m_Queue.clear();
+	}
+	m_WakeCondition.notify_all();
+
+	for (std::thread& thread : m_Threads)
+	{
+		thread.join();
+	}
+	m_Threads.clear();
+
+	// results nobody picked up
+	if (m_Completions.GetCapacity() > 0)
+	{
+		Completion* pCompletion = nullptr;
+		while (m_Completions.Pop(pCompletion))
+		{
+			delete pCompletion;
+		}
+		m_Completions.Term();
+	}
+	for (Completion* pCompletion : m_Ready)
+	{
+		delete pCompletion;
+	}
+	m_Ready.clear();
+
+	m_Requests.clear();
+	m_FreeHandles.clear();
+	m_PendingCount = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 replace the decoder of a type
+//--------------------------------------------------------------------------------------------------------
+void AssetStreamer::SetDecoder(AssetType type, const DecodeFunc& decode)
+{
+	if (type < AssetType::Count)
+	{
+		m_Decoders[static_cast<uint32_t>(type)] = decode;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 queue a file for the I/O threads
+//--------------------------------------------------------------------------------------------------------
+uint32_t AssetStreamer::Request(const char* path, AssetType type, float priority, uint64_t userData)
+{
+	if (m_Threads.empty() || path == nullptr || type >= AssetType::Count)
+	{
+		return InvalidHandle;
+	}
+
+	uint32_t handle = InvalidHandle;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_FreeHandles.empty())
+		{
+			handle = static_cast<uint32_t>(m_Requests.size());
+			m_Requests.emplace_back();
+		}
+		else
+		{
+			handle = m_FreeHandles.back();
+			m_FreeHandles.pop_back();
+		}
+
+		RequestSlot& request = m_Requests[handle];
+		request.Path = path;
+		request.Type = type;
+		request.State = RequestState::Queued;
+		request.Priority = priority;
+		request.Sequence = m_NextSequence++;
+		request.UserData = userData;
+		request.RequestTime = Clock::now();
+		request.Visible = false;
+		m_Queue.insert(QueueKey{ priority, request.Sequence, handle });
+		m_Stats.MaxQueued = std::max(m_Stats.MaxQueued, static_cast<uint32_t>(m_Queue.size()));
+	}
+	m_WakeCondition.notify_one();
+
+	m_Stats.RequestCount++;
+	m_PendingCount++;
+	return handle;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 move a queued request
+//--------------------------------------------------------------------------------------------------------
+void AssetStreamer::SetPriority(uint32_t handle, float priority)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (handle >= m_Requests.size())
+	{
+		return;
+	}
+
+	// results waiting for delivery are sorted by the new priority as well
+	RequestSlot& request = m_Requests[handle];
+	if (request.State == RequestState::Queued)
+	{
+		m_Queue.erase(QueueKey{ request.Priority, request.Sequence, handle });
+		m_Queue.insert(QueueKey{ priority, request.Sequence, handle });
+	}
+	request.Priority = priority;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 cancel or free a request
+//--------------------------------------------------------------------------------------------------------
+void AssetStreamer::Release(uint32_t handle)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (handle >= m_Requests.size())
+	{
+		return;
+	}
+
+	RequestSlot& request = m_Requests[handle];
+	switch (request.State)
+	{
+	case RequestState::Queued:
+		m_Queue.erase(QueueKey{ request.Priority, request.Sequence, handle });
+		FreeHandle(handle);
+		m_Stats.CancelledCount++;
+		m_PendingCount--;
+		break;
+
+	case RequestState::Loading:
+		// an I/O thread has the request, its result is dropped by Update()
+		request.State = RequestState::Cancelled;
+		m_Stats.CancelledCount++;
+		m_PendingCount--;
+		break;
+
+	case RequestState::Delivered:
+		FreeHandle(handle);
+		break;
+
+	default:
+		/* DO_NOTHING */
+		break;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 record the time to the first frame drawing the asset
+//--------------------------------------------------------------------------------------------------------
+void AssetStreamer::MarkVisible(uint32_t handle)
+{
+	double ms = 0.0;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (handle >= m_Requests.size() || m_Requests[handle].State != RequestState::Delivered || m_Requests[handle].Visible)
+		{
+			return;
+		}
+
+		m_Requests[handle].Visible = true;
+		ms = ElapsedMs(m_Requests[handle].RequestTime, Clock::now());
+	}
+
+	m_Stats.VisibleCount++;
+	m_Stats.VisibleMs += ms;
+	m_Stats.MaxVisibleMs = std::max(m_Stats.MaxVisibleMs, ms);
+	m_VisibleLatencies.push_back(static_cast<float>(ms));
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 hand completed assets to the render thread within the budget of the frame
+//--------------------------------------------------------------------------------------------------------
+uint32_t AssetStreamer::Update(uint64_t budgetBytes, const DeliverFunc& deliver)
+{
+	if (m_Threads.empty())
+	{
+		return 0;
+	}
+
+	PROFILE_SCOPE("StreamAssets");
+	Completion* pCompletion = nullptr;
+	while (m_Completions.Pop(pCompletion))
+	{
+		m_Ready.push_back(pCompletion);
+		m_Stats.ReadMs += pCompletion->ReadMs;
+		m_Stats.DecodeMs += pCompletion->DecodeMs;
+	}
+	if (m_Ready.empty())
+	{
+		return 0;
+	}
+
+	// priorities may have changed since the requests were read
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (Completion* pReady : m_Ready)
+		{
+			pReady->Priority = m_Requests[pReady->Handle].Priority;
+			pReady->Sequence = m_Requests[pReady->Handle].Sequence;
+		}
+	}
+	std::sort(m_Ready.begin(), m_Ready.end(), [](const Completion* pLeft, const Completion* pRight)
+	{
+		return QueueKey{ pLeft->Priority, pLeft->Sequence, pLeft->Handle } < QueueKey{ pRight->Priority, pRight->Sequence, pRight->Handle };
+	});
+
+	// the first asset goes whatever its size, so that one larger than the budget doesn't wait forever
+	uint64_t bytes = 0;
+	uint32_t deliveredCount = 0;
+	size_t index = 0;
+	for (; index < m_Ready.size(); ++index)
+	{
+		std::unique_ptr<Completion> pReady(m_Ready[index]);
+		if (deliveredCount > 0 && bytes + pReady->Data.size() > budgetBytes)
+		{
+			pReady.release();
+			break;
+		}
+
+		// deliveries before may have released the request
+		StreamedAsset asset;
+		double deliverMs = 0.0;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			RequestSlot& request = m_Requests[pReady->Handle];
+			if (request.State == RequestState::Cancelled)
+			{
+				FreeHandle(pReady->Handle);
+				continue;
+			}
+
+			request.State = RequestState::Delivered;
+			asset.Type = request.Type;
+			asset.UserData = request.UserData;
+			deliverMs = ElapsedMs(request.RequestTime, Clock::now());
+		}
+
+		asset.Handle = pReady->Handle;
+		asset.Succeeded = pReady->Succeeded;
+		asset.Data.swap(pReady->Data);
+		bytes += asset.Data.size();
+		deliveredCount++;
+		m_PendingCount--;
+		if (asset.Succeeded)
+		{
+			m_Stats.DeliveredCount++;
+			m_Stats.DeliveredBytes += asset.Data.size();
+			m_Stats.DeliverMs += deliverMs;
+		}
+		else
+		{
+			m_Stats.FailedCount++;
+		}
+		deliver(asset);
+	}
+
+	m_Ready.erase(m_Ready.begin(), m_Ready.begin() + index);
+	m_Stats.DeferredCount += m_Ready.size();
+	return deliveredCount;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 priority from the distance to the camera and the visibility
+//--------------------------------------------------------------------------------------------------------
+float AssetStreamer::ComputePriority(float distance, bool visible)
+{
+	// (0, 1] for invisible assets, (1, 2] for visible ones
+	float nearness = 1.f / (1.f + std::max(distance, 0.f));
+	return visible ? 1.f + nearness : nearness;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 I/O thread
+//--------------------------------------------------------------------------------------------------------
+void AssetStreamer::ThreadMain(uint32_t threadIndex)
+{
+	Profiler::SetThreadName(("Stream I/O " + std::to_string(threadIndex)).c_str());
+	for (;;)
+	{
+		std::unique_ptr<Completion> pCompletion(new Completion());
+		std::string path;
+		AssetType type = AssetType::Mesh;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WakeCondition.wait(lock, [this] { return m_Quit || !m_Queue.empty(); });
+			if (m_Quit)
+			{
+				return;
+			}
+
+			// the most urgent request
+			auto it = m_Queue.begin();
+			RequestSlot& request = m_Requests[it->Handle];
+			pCompletion->Handle = it->Handle;
+			request.State = RequestState::Loading;
+			path = request.Path;
+			type = request.Type;
+			m_Queue.erase(it);
+		}
+
+		{
+			PROFILE_SCOPE("ReadAsset");
+			Clock::time_point begin = Clock::now();
+			const AssetArchiveEntry* pEntry = (m_pArchive != nullptr) ? m_pArchive->Find(path.c_str()) : nullptr;
+			pCompletion->Succeeded = (pEntry != nullptr) ? m_pArchive->Read(*pEntry, pCompletion->Data) : ReadWholeFile(path, pCompletion->Data);
+			pCompletion->ReadMs = ElapsedMs(begin, Clock::now());
+		}
+
+		const DecodeFunc& decode = m_Decoders[static_cast<uint32_t>(type)];
+		if (pCompletion->Succeeded && decode)
+		{
+			PROFILE_SCOPE("DecodeAsset");
+			Clock::time_point begin = Clock::now();
+			pCompletion->Succeeded = decode(pCompletion->Data);
+			pCompletion->DecodeMs = ElapsedMs(begin, Clock::now());
+		}
+		if (!pCompletion->Succeeded)
+		{
+			std::vector<uint8_t>().swap(pCompletion->Data);
+		}
+
+		// the render thread makes room every frame, until then the thread holds on to its result
+		while (!m_Completions.Push(pCompletion.get()))
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				if (m_Quit)
+				{
+					return;
+				}
+			}
+			std::this_thread::sleep_for(std::chrono::microseconds(FullQueueSleep));
+		}
+		pCompletion.release();
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 return a slot to the free list (m_Mutex is held by the caller)
+//--------------------------------------------------------------------------------------------------------
+void AssetStreamer::FreeHandle(uint32_t handle)
+{
+	RequestSlot& request = m_Requests[handle];
+	request.State = RequestState::Free;
+	std::string().swap(request.Path);
+	m_FreeHandles.push_back(handle);
+}
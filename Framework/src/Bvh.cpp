@@ -0,0 +1,668 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <Bvh.h>
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+
+namespace /* anonymous */ {
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Bounds structure - min/max accumulator
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Bounds
+	{
+		float Min[3];
+		float Max[3];
+
+		Bounds()
+		{
+			for (uint32_t a = 0; a < 3; ++a)
+			{
+				Min[a] = FLT_MAX;
+				Max[a] = -FLT_MAX;
+			}
+		}
+
+		void Grow(const float* pMin, const float* pMax)
+		{
+			for (uint32_t a = 0; a < 3; ++a)
+			{
+				Min[a] = std::min(Min[a], pMin[a]);
+				Max[a] = std::max(Max[a], pMax[a]);
+			}
+		}
+
+		// half of the surface area (the factor cancels in every comparison)
+		float HalfArea() const
+		{
+			float dx = Max[0] - Min[0];
+			float dy = Max[1] - Min[1];
+			float dz = Max[2] - Min[2];
+			return (dx < 0.f) ? 0.f : dx * dy + dy * dz + dz * dx;
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Split structure - best SAH candidate of a node
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Split
+	{
+		uint32_t Axis; // split axis
+		uint32_t Bin; // objects in bins [0, Bin] go left
+		float Origin; // lower centroid bound on the axis
+		float Scale; // bins per unit along the axis
+		float Cost; // sum of area * count of both sides
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// bin of a centroid coordinate
+	//----------------------------------------------------------------------------------------------------
+	inline uint32_t BinIndex(float value, float origin, float scale)
+	{
+		int32_t bin = static_cast<int32_t>((value - origin) * scale);
+		return static_cast<uint32_t>(std::min(std::max(bin, 0), int32_t(Bvh::BinCount) - 1));
+	}
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// BuildRef structure - object entry partitioned in place during the build
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct BuildRef
+	{
+		float Min[3]; // lower corner
+		float Max[3]; // upper corner
+		float Centroid[3]; // box center
+		uint32_t Object; // index of the object
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// cheapest binned SAH split of refs [first, first + count), false when all centroids coincide
+	//----------------------------------------------------------------------------------------------------
+	bool FindSplit(const BuildRef* pRefs, uint32_t count, const Bounds& centroidBounds, Split& best)
+	{
+		float origin[3];
+		float scale[3];
+		for (uint32_t axis = 0; axis < 3; ++axis)
+		{
+			float extent = centroidBounds.Max[axis] - centroidBounds.Min[axis];
+			origin[axis] = centroidBounds.Min[axis];
+			scale[axis] = (extent > 0.f) ? float(Bvh::BinCount) / extent : 0.f;
+		}
+
+		// one pass bins all three axes
+		Bounds bins[3][Bvh::BinCount];
+		uint32_t binCounts[3][Bvh::BinCount] = {};
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const BuildRef& ref = pRefs[i];
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				uint32_t bin = BinIndex(ref.Centroid[axis], origin[axis], scale[axis]);
+				bins[axis][bin].Grow(ref.Min, ref.Max);
+				binCounts[axis][bin]++;
+			}
+		}
+
+		best.Cost = FLT_MAX;
+		for (uint32_t axis = 0; axis < 3; ++axis)
+		{
+			if (!(scale[axis] > 0.f))
+			{
+				continue;
+			}
+
+			// left side costs of every split plane, then sweep from the right
+			float leftCost[Bvh::BinCount - 1];
+			uint32_t leftCount[Bvh::BinCount - 1];
+			Bounds left;
+			uint32_t total = 0;
+			for (uint32_t b = 0; b < Bvh::BinCount - 1; ++b)
+			{
+				left.Grow(bins[axis][b].Min, bins[axis][b].Max);
+				total += binCounts[axis][b];
+				leftCount[b] = total;
+				leftCost[b] = left.HalfArea() * float(total);
+			}
+
+			Bounds right;
+			total = 0;
+			for (uint32_t b = Bvh::BinCount - 1; b > 0; --b)
+			{
+				right.Grow(bins[axis][b].Min, bins[axis][b].Max);
+				total += binCounts[axis][b];
+
+				uint32_t split = b - 1;
+				if (leftCount[split] == 0 || total == 0)
+				{
+					continue;
+				}
+
+				float cost = leftCost[split] + right.HalfArea() * float(total);
+				if (cost < best.Cost)
+				{
+					best.Axis = axis;
+					best.Bin = split;
+					best.Origin = origin[axis];
+					best.Scale = scale[axis];
+					best.Cost = cost;
+				}
+			}
+		}
+		return best.Cost < FLT_MAX;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// slab test, returns the entry parameter or a negative value on a miss
+	//----------------------------------------------------------------------------------------------------
+	inline float IntersectSlabs(const float* pMin, const float* pMax, const float* pOrigin, const float* pInvDir, float maxDistance)
+	{
+		float tNear = 0.f;
+		float tFar = maxDistance;
+		for (uint32_t a = 0; a < 3; ++a)
+		{
+			float t0 = (pMin[a] - pOrigin[a]) * pInvDir[a];
+			float t1 = (pMax[a] - pOrigin[a]) * pInvDir[a];
+			tNear = std::max(tNear, std::min(t0, t1));
+			tFar = std::min(tFar, std::max(t0, t1));
+		}
+		return (tNear <= tFar) ? tNear : -1.f;
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Bvh class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+Bvh::Bvh()
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 build the tree
+//--------------------------------------------------------------------------------------------------------
+bool Bvh::Build(const BoxBounds& bounds, uint32_t count)
+{
+	Clear();
+
+	if (count == 0)
+	{
+		return false;
+	}
+
+	// the refs are partitioned instead of indices, so that every pass reads memory linearly
+	std::vector<BuildRef> refs(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		float center[3] = { bounds.pCenterX[i], bounds.pCenterY[i], bounds.pCenterZ[i] };
+		float extent[3] = { bounds.pExtentX[i], bounds.pExtentY[i], bounds.pExtentZ[i] };
+		for (uint32_t a = 0; a < 3; ++a)
+		{
+			refs[i].Min[a] = center[a] - extent[a];
+			refs[i].Max[a] = center[a] + extent[a];
+			refs[i].Centroid[a] = center[a];
+		}
+		refs[i].Object = i;
+	}
+
+	// a full binary tree with count leaves has 2 * count - 1 nodes
+	m_Nodes.reserve(size_t(count) * 2 - 1);
+
+	BvhNode root = {};
+	root.First = 0;
+	root.Count = count;
+	m_Nodes.push_back(root);
+
+	struct Pending
+	{
+		uint32_t Node; // node to split
+		uint32_t Depth; // depth of the node
+	};
+	std::vector<Pending> stack;
+	stack.push_back({ 0, 0 });
+
+	while (!stack.empty())
+	{
+		Pending pending = stack.back();
+		stack.pop_back();
+
+		uint32_t first = m_Nodes[pending.Node].First;
+		uint32_t objectCount = m_Nodes[pending.Node].Count;
+		if (objectCount <= 2 || pending.Depth + 1 >= MaxDepth)
+		{
+			continue;
+		}
+
+		BuildRef* pRefs = refs.data() + first;
+		Bounds nodeBounds;
+		Bounds centroidBounds;
+		for (uint32_t i = 0; i < objectCount; ++i)
+		{
+			nodeBounds.Grow(pRefs[i].Min, pRefs[i].Max);
+			centroidBounds.Grow(pRefs[i].Centroid, pRefs[i].Centroid);
+		}
+
+		Split split = {};
+		uint32_t leftCount = 0;
+		if (FindSplit(pRefs, objectCount, centroidBounds, split))
+		{
+			// small nodes stay leaves when testing their objects is cheaper than one more level
+			float leafCost = nodeBounds.HalfArea() * float(objectCount);
+			if (objectCount <= MaxLeafObjects && leafCost <= nodeBounds.HalfArea() + split.Cost)
+			{
+				continue;
+			}
+
+			BuildRef* pMiddle = std::partition(pRefs, pRefs + objectCount, [&split](const BuildRef& ref)
+			{
+				return BinIndex(ref.Centroid[split.Axis], split.Origin, split.Scale) <= split.Bin;
+			});
+			leftCount = static_cast<uint32_t>(pMiddle - pRefs);
+		}
+		else if (objectCount > MaxLeafObjects)
+		{
+			// every centroid is the same point, halve by count
+			leftCount = objectCount / 2;
+		}
+		else
+		{
+			continue;
+		}
+
+		// children are allocated as a pair after every existing node
+		uint32_t leftIndex = static_cast<uint32_t>(m_Nodes.size());
+
+		BvhNode left = {};
+		left.First = first;
+		left.Count = leftCount;
+
+		BvhNode right = {};
+		right.First = first + leftCount;
+		right.Count = objectCount - leftCount;
+
+		m_Nodes.push_back(left);
+		m_Nodes.push_back(right);
+
+		m_Nodes[pending.Node].First = leftIndex;
+		m_Nodes[pending.Node].Count = 0;
+
+		stack.push_back({ leftIndex + 1, pending.Depth + 1 });
+		stack.push_back({ leftIndex, pending.Depth + 1 });
+	}
+
+	m_Indices.resize(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		m_Indices[i] = refs[i].Object;
+	}
+
+	m_Boxes.resize(count);
+	LoadBoxes(bounds);
+	RefitNodes();
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 release the tree
+//--------------------------------------------------------------------------------------------------------
+void Bvh::Clear()
+{
+	m_Nodes.clear();
+	m_Indices.clear();
+	m_Boxes.clear();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 update bounds
+//--------------------------------------------------------------------------------------------------------
+void Bvh::Refit(const BoxBounds& bounds)
+{
+	if (m_Nodes.empty())
+	{
+		return;
+	}
+
+	LoadBoxes(bounds);
+	RefitNodes();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 hierarchical frustum culling
+//--------------------------------------------------------------------------------------------------------
+uint32_t Bvh::CullFrustum(const Frustum& frustum, uint32_t* pVisible) const
+{
+	if (m_Nodes.empty())
+	{
+		return 0;
+	}
+
+	float planes[6][4];
+	float absNormals[6][3];
+	for (uint32_t p = 0; p < 6; ++p)
+	{
+		planes[p][0] = frustum.Planes[p].x;
+		planes[p][1] = frustum.Planes[p].y;
+		planes[p][2] = frustum.Planes[p].z;
+		planes[p][3] = frustum.Planes[p].w;
+		absNormals[p][0] = fabsf(frustum.Planes[p].x);
+		absNormals[p][1] = fabsf(frustum.Planes[p].y);
+		absNormals[p][2] = fabsf(frustum.Planes[p].z);
+	}
+
+	// planes a node lies completely inside of are dropped for its whole subtree
+	struct Entry
+	{
+		uint32_t Node; // node to visit
+		uint32_t PlaneMask; // planes which still need testing
+	};
+	Entry stack[MaxDepth + 1];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = { 0, 0x3f };
+
+	uint32_t visibleCount = 0;
+	while (stackSize > 0)
+	{
+		Entry entry = stack[--stackSize];
+		const BvhNode& node = m_Nodes[entry.Node];
+
+		uint32_t mask = entry.PlaneMask;
+		if (mask != 0)
+		{
+			float center[3];
+			float extent[3];
+			for (uint32_t a = 0; a < 3; ++a)
+			{
+				center[a] = (node.Min[a] + node.Max[a]) * 0.5f;
+				extent[a] = (node.Max[a] - node.Min[a]) * 0.5f;
+			}
+
+			bool outside = false;
+			for (uint32_t p = 0; p < 6 && !outside; ++p)
+			{
+				if ((mask & (1u << p)) == 0)
+				{
+					continue;
+				}
+
+				float d = planes[p][0] * center[0] + planes[p][1] * center[1] + planes[p][2] * center[2] + planes[p][3];
+				float r = absNormals[p][0] * extent[0] + absNormals[p][1] * extent[1] + absNormals[p][2] * extent[2];
+				outside = (d + r < 0.f);
+				mask &= (d - r >= 0.f) ? ~(1u << p) : ~0u;
+			}
+
+			if (outside)
+			{
+				continue;
+			}
+		}
+
+		if (node.Count == 0)
+		{
+			stack[stackSize++] = { node.First + 1, mask };
+			stack[stackSize++] = { node.First, mask };
+			continue;
+		}
+
+		// objects are tested like FrustumCuller::CullBoxes() against the remaining planes
+		for (uint32_t i = node.First; i < node.First + node.Count; ++i)
+		{
+			const Box& box = m_Boxes[i];
+			bool visible = true;
+			for (uint32_t p = 0; p < 6; ++p)
+			{
+				if ((mask & (1u << p)) != 0)
+				{
+					float d = planes[p][0] * box.Center[0] + planes[p][1] * box.Center[1] + planes[p][2] * box.Center[2] + planes[p][3];
+					float r = absNormals[p][0] * box.Extent[0] + absNormals[p][1] * box.Extent[1] + absNormals[p][2] * box.Extent[2];
+					visible &= (d + r >= 0.f);
+				}
+			}
+
+			pVisible[visibleCount] = m_Indices[i];
+			visibleCount += visible ? 1 : 0;
+		}
+	}
+	return visibleCount;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 nearest hit along a ray
+//--------------------------------------------------------------------------------------------------------
+bool Bvh::Raycast(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& direction, float maxDistance, BvhHit& hit) const
+{
+	if (m_Nodes.empty())
+	{
+		return false;
+	}
+
+	// zero components become infinities, which the slab test handles
+	float rayOrigin[3] = { origin.x, origin.y, origin.z };
+	float invDir[3] = { 1.f / direction.x, 1.f / direction.y, 1.f / direction.z };
+
+	hit.Object = UINT32_MAX;
+	hit.Distance = maxDistance;
+
+	uint32_t stack[MaxDepth + 1];
+	uint32_t stackSize = 0;
+	if (IntersectSlabs(m_Nodes[0].Min, m_Nodes[0].Max, rayOrigin, invDir, maxDistance) >= 0.f)
+	{
+		stack[stackSize++] = 0;
+	}
+
+	while (stackSize > 0)
+	{
+		const BvhNode& node = m_Nodes[stack[--stackSize]];
+
+		if (node.Count > 0)
+		{
+			for (uint32_t i = node.First; i < node.First + node.Count; ++i)
+			{
+				const Box& box = m_Boxes[i];
+				float boxMin[3];
+				float boxMax[3];
+				for (uint32_t a = 0; a < 3; ++a)
+				{
+					boxMin[a] = box.Center[a] - box.Extent[a];
+					boxMax[a] = box.Center[a] + box.Extent[a];
+				}
+
+				// the lower object index wins ties, so the result doesn't depend on the tree
+				float t = IntersectSlabs(boxMin, boxMax, rayOrigin, invDir, hit.Distance);
+				if (t >= 0.f && (t < hit.Distance || (t == hit.Distance && m_Indices[i] < hit.Object)))
+				{
+					hit.Object = m_Indices[i];
+					hit.Distance = t;
+				}
+			}
+			continue;
+		}
+
+		// visit the nearer child first, the farther one is often skipped then
+		const BvhNode& left = m_Nodes[node.First];
+		const BvhNode& right = m_Nodes[node.First + 1];
+		float tLeft = IntersectSlabs(left.Min, left.Max, rayOrigin, invDir, hit.Distance);
+		float tRight = IntersectSlabs(right.Min, right.Max, rayOrigin, invDir, hit.Distance);
+
+		if (tLeft >= 0.f && tRight >= 0.f)
+		{
+			bool leftFirst = tLeft <= tRight;
+			stack[stackSize++] = leftFirst ? node.First + 1 : node.First;
+			stack[stackSize++] = leftFirst ? node.First : node.First + 1;
+		}
+		else if (tLeft >= 0.f)
+		{
+			stack[stackSize++] = node.First;
+		}
+		else if (tRight >= 0.f)
+		{
+			stack[stackSize++] = node.First + 1;
+		}
+	}
+
+	return hit.Object != UINT32_MAX;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 boxes containing a point
+//--------------------------------------------------------------------------------------------------------
+uint32_t Bvh::QueryPoint(const DirectX::XMFLOAT3& point, uint32_t* pResults, uint32_t maxResults) const
+{
+	if (m_Nodes.empty())
+	{
+		return 0;
+	}
+
+	float p[3] = { point.x, point.y, point.z };
+	auto contains = [&p](const float* pMin, const float* pMax)
+	{
+		return pMin[0] <= p[0] && p[0] <= pMax[0]
+			&& pMin[1] <= p[1] && p[1] <= pMax[1]
+			&& pMin[2] <= p[2] && p[2] <= pMax[2];
+	};
+
+	uint32_t stack[MaxDepth + 1];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+
+	uint32_t resultCount = 0;
+	while (stackSize > 0)
+	{
+		const BvhNode& node = m_Nodes[stack[--stackSize]];
+		if (!contains(node.Min, node.Max))
+		{
+			continue;
+		}
+
+		if (node.Count == 0)
+		{
+			stack[stackSize++] = node.First + 1;
+			stack[stackSize++] = node.First;
+			continue;
+		}
+
+		for (uint32_t i = node.First; i < node.First + node.Count; ++i)
+		{
+			const Box& box = m_Boxes[i];
+			float boxMin[3] = { box.Center[0] - box.Extent[0], box.Center[1] - box.Extent[1], box.Center[2] - box.Extent[2] };
+			float boxMax[3] = { box.Center[0] + box.Extent[0], box.Center[1] + box.Extent[1], box.Center[2] + box.Extent[2] };
+			if (contains(boxMin, boxMax))
+			{
+				if (resultCount < maxResults)
+				{
+					pResults[resultCount] = m_Indices[i];
+				}
+				resultCount++;
+			}
+		}
+	}
+	return resultCount;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 tree statistics
+//--------------------------------------------------------------------------------------------------------
+BvhStats Bvh::ComputeStats() const
+{
+	BvhStats stats = {};
+	if (m_Nodes.empty())
+	{
+		return stats;
+	}
+
+	auto halfArea = [](const BvhNode& node)
+	{
+		float dx = node.Max[0] - node.Min[0];
+		float dy = node.Max[1] - node.Min[1];
+		float dz = node.Max[2] - node.Min[2];
+		return dx * dy + dy * dz + dz * dx;
+	};
+
+	// children are stored after their parents, so depths fill in one forward pass
+	std::vector<uint32_t> depth(m_Nodes.size(), 0);
+	float rootArea = std::max(halfArea(m_Nodes[0]), FLT_MIN);
+	float cost = 0.f;
+
+	stats.NodeCount = static_cast<uint32_t>(m_Nodes.size());
+	for (size_t i = 0; i < m_Nodes.size(); ++i)
+	{
+		const BvhNode& node = m_Nodes[i];
+		float relativeArea = halfArea(node) / rootArea;
+		stats.MaxDepth = std::max(stats.MaxDepth, depth[i]);
+
+		if (node.Count > 0)
+		{
+			stats.LeafCount++;
+			stats.MaxLeafObjects = std::max(stats.MaxLeafObjects, node.Count);
+			cost += relativeArea * float(node.Count);
+		}
+		else
+		{
+			depth[node.First] = depth[i] + 1;
+			depth[node.First + 1] = depth[i] + 1;
+			cost += relativeArea;
+		}
+	}
+
+	stats.SahCost = cost / float(m_Indices.size());
+	return stats;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 copy object boxes in leaf order
+//--------------------------------------------------------------------------------------------------------
+void Bvh::LoadBoxes(const BoxBounds& bounds)
+{
+	for (size_t i = 0; i < m_Indices.size(); ++i)
+	{
+		uint32_t object = m_Indices[i];
+		Box& box = m_Boxes[i];
+		box.Center[0] = bounds.pCenterX[object];
+		box.Center[1] = bounds.pCenterY[object];
+		box.Center[2] = bounds.pCenterZ[object];
+		box.Extent[0] = bounds.pExtentX[object];
+		box.Extent[1] = bounds.pExtentY[object];
+		box.Extent[2] = bounds.pExtentZ[object];
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 recompute node bounds bottom up (children are stored after their parents)
+//--------------------------------------------------------------------------------------------------------
+void Bvh::RefitNodes()
+{
+	for (size_t i = m_Nodes.size(); i-- > 0; )
+	{
+		BvhNode& node = m_Nodes[i];
+		Bounds bounds;
+
+		if (node.Count > 0)
+		{
+			for (uint32_t j = node.First; j < node.First + node.Count; ++j)
+			{
+				const Box& box = m_Boxes[j];
+				float boxMin[3] = { box.Center[0] - box.Extent[0], box.Center[1] - box.Extent[1], box.Center[2] - box.Extent[2] };
+				float boxMax[3] = { box.Center[0] + box.Extent[0], box.Center[1] + box.Extent[1], box.Center[2] + box.Extent[2] };
+				bounds.Grow(boxMin, boxMax);
+			}
+		}
+		else
+		{
+			bounds.Grow(m_Nodes[node.First].Min, m_Nodes[node.First].Max);
+			bounds.Grow(m_Nodes[node.First + 1].Min, m_Nodes[node.First + 1].Max);
+		}
+
+		for (uint32_t a = 0; a < 3; ++a)
+		{
+			node.Min[a] = bounds.Min[a];
+			node.Max[a] = bounds.Max[a];
+		}
+	}
+}
@@ -0,0 +1,207 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <CommandListPool.h>
+#include <cassert>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// CommandListPool class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+CommandListPool::CommandListPool()
+	: m_FrameCount(0)
+	, m_RecordedCount(0)
+	, m_RecordedFrame(0)
+	, m_pStates(nullptr)
+	, m_BarrierStats()
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+CommandListPool::~CommandListPool()
+{
+	Term();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 initialization
+//--------------------------------------------------------------------------------------------------------
+bool CommandListPool::Init(GfxDevice* pDevice, GfxCommandListType type, uint32_t frameCount, uint32_t listCount, ResourceStates* pStates)
+{
+	if (pDevice == nullptr || frameCount == 0 || listCount == 0)
+	{
+		return false;
+	}
+
+	Term();
+
+	// generate command allocators
+	m_pAllocators.resize(size_t(frameCount) * listCount);
+	for (GfxPtr<GfxCommandAllocator>& pAllocator : m_pAllocators)
+	{
+		if (!pDevice->CreateCommandAllocator(type, pAllocator))
+		{
+			Term();
+			return false;
+		}
+	}
+
+	// generate command lists (created open, close them so that Record() can reset)
+	m_pCmdLists.resize(listCount);
+	for (uint32_t i = 0; i < listCount; ++i)
+	{
+		if (!pDevice->CreateCommandList(type, m_pAllocators[i].get(), m_pCmdLists[i]))
+		{
+			Term();
+			return false;
+		}
+		m_pCmdLists[i]->Close();
+	}
+
+	// fix-up lists take the barriers of first uses that don't match the committed states
+	if (pStates != nullptr)
+	{
+		m_pFixupAllocators.resize(size_t(frameCount) * listCount);
+		for (GfxPtr<GfxCommandAllocator>& pAllocator : m_pFixupAllocators)
+		{
+			if (!pDevice->CreateCommandAllocator(type, pAllocator))
+			{
+				Term();
+				return false;
+			}
+		}
+
+		m_pFixupLists.resize(listCount);
+		for (uint32_t i = 0; i < listCount; ++i)
+		{
+			if (!pDevice->CreateCommandList(type, m_pFixupAllocators[i].get(), m_pFixupLists[i]))
+			{
+				Term();
+				return false;
+			}
+			m_pFixupLists[i]->Close();
+		}
+
+		m_Trackers.resize(listCount);
+		m_pSubmit.resize(size_t(listCount) * 2, nullptr);
+	}
+
+	m_pRecorded.resize(listCount, nullptr);
+	m_FrameCount = frameCount;
+	m_pStates = pStates;
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 termination
+//--------------------------------------------------------------------------------------------------------
+void CommandListPool::Term()
+{
+	m_pRecorded.clear();
+	m_pSubmit.clear();
+	m_Trackers.clear();
+	m_pFixupLists.clear();
+	m_pFixupAllocators.clear();
+	m_pCmdLists.clear();
+	m_pAllocators.clear();
+	m_pStates = nullptr;
+	m_FrameCount = 0;
+	m_RecordedCount = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 record command lists in parallel
+//--------------------------------------------------------------------------------------------------------
+void CommandListPool::Record(WorkerPool& workers, uint32_t frameIndex, uint32_t listCount, const RecordFunc& func)
+{
+	assert(frameIndex < m_FrameCount);
+	assert(listCount <= m_pCmdLists.size());
+
+	const size_t listStride = m_pCmdLists.size();
+	workers.Dispatch(listCount, [&](uint32_t listIndex, uint32_t /* workerIndex */)
+	{
+		GfxCommandAllocator* pAllocator = m_pAllocators[frameIndex * listStride + listIndex].get();
+		GfxCommandList* pCmdList = m_pCmdLists[listIndex].get();
+
+		pAllocator->Reset();
+		pCmdList->Reset(pAllocator, nullptr);
+
+		// only the first list starts from the committed states, the lists before the others are still recorded
+		ResourceStateTracker* pTracker = GetStateTracker(listIndex);
+		if (pTracker != nullptr)
+		{
+			pTracker->Reset(m_pStates, listIndex == 0);
+		}
+
+		func(pCmdList, listIndex);
+
+		if (pTracker != nullptr)
+		{
+			pTracker->FlushBarriers(pCmdList);
+		}
+		pCmdList->Close();
+
+		m_pRecorded[listIndex] = pCmdList;
+	});
+
+	m_RecordedCount = listCount;
+	m_RecordedFrame = frameIndex;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 submit recorded command lists
+//--------------------------------------------------------------------------------------------------------
+void CommandListPool::Execute(GfxCommandQueue* pQueue)
+{
+	if (m_RecordedCount == 0)
+	{
+		return;
+	}
+
+	if (m_pStates == nullptr)
+	{
+		pQueue->ExecuteCommandLists(m_RecordedCount, m_pRecorded.data());
+		return;
+	}
+
+	// the committed states advance list by list in submission order
+	const size_t listStride = m_pCmdLists.size();
+	uint32_t submitCount = 0;
+	m_BarrierStats = ResourceBarrierStats();
+	for (uint32_t i = 0; i < m_RecordedCount; ++i)
+	{
+		const ResourceStateTracker& tracker = m_Trackers[i];
+		m_Fixups.clear();
+		m_pStates->Resolve(tracker, m_Fixups);
+
+		if (!m_Fixups.empty())
+		{
+			GfxCommandAllocator* pAllocator = m_pFixupAllocators[m_RecordedFrame * listStride + i].get();
+			GfxCommandList* pFixupList = m_pFixupLists[i].get();
+			pAllocator->Reset();
+			pFixupList->Reset(pAllocator, nullptr);
+			pFixupList->ResourceBarrier(static_cast<uint32_t>(m_Fixups.size()), m_Fixups.data());
+			pFixupList->Close();
+			m_pSubmit[submitCount++] = pFixupList;
+
+			m_BarrierStats.BarrierCount += m_Fixups.size();
+			m_BarrierStats.BatchCount++;
+			m_BarrierStats.FixupCount += m_Fixups.size();
+		}
+		m_pSubmit[submitCount++] = m_pRecorded[i];
+
+		const ResourceBarrierStats& stats = tracker.GetStats();
+		m_BarrierStats.BarrierCount += stats.BarrierCount;
+		m_BarrierStats.BatchCount += stats.BatchCount;
+		m_BarrierStats.ElidedCount += stats.ElidedCount;
+	}
+
+	pQueue->ExecuteCommandLists(submitCount, m_pSubmit.data());
+}
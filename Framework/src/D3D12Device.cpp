@@ -0,0 +1,1131 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#include <d3d12.h>
+#include <dxgi1_4.h>
+#include <wrl/client.h>
+#include <cassert>
+#include <vector>
+
+
+//--------------------------------------------------------------------------------------------------------
+// Linker
+//--------------------------------------------------------------------------------------------------------
+#pragma comment(lib, "d3d12.lib")
+#pragma comment(lib, "dxgi.lib")
+
+
+//--------------------------------------------------------------------------------------------------------
+// Type Alias
+//--------------------------------------------------------------------------------------------------------
+template<typename T> using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t MaxInlineElements = 16u; // elements converted on the stack before falling back to heap
+	const uint32_t MaxPipelineNameLength = 17u; // 16 hex digits of a pipeline key and the terminator
+
+	//----------------------------------------------------------------------------------------------------
+	// conversions
+	//----------------------------------------------------------------------------------------------------
+	inline DXGI_FORMAT ToD3D(GfxFormat format) { return static_cast<DXGI_FORMAT>(format); }
+	inline D3D12_RESOURCE_STATES ToD3D(GfxResourceState state) { return static_cast<D3D12_RESOURCE_STATES>(state); }
+	inline D3D12_RESOURCE_BARRIER_FLAGS ToD3D(GfxResourceBarrierFlags flags) { return static_cast<D3D12_RESOURCE_BARRIER_FLAGS>(flags); }
+	inline D3D12_COMMAND_LIST_TYPE ToD3D(GfxCommandListType type) { return static_cast<D3D12_COMMAND_LIST_TYPE>(type); }
+	inline D3D12_DESCRIPTOR_HEAP_TYPE ToD3D(GfxDescriptorHeapType type) { return static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(type); }
+	inline D3D12_CPU_DESCRIPTOR_HANDLE ToD3D(GfxCpuDescriptorHandle handle) { return D3D12_CPU_DESCRIPTOR_HANDLE{ handle.ptr }; }
+	inline D3D12_BLEND ToD3D(GfxBlend blend) { return static_cast<D3D12_BLEND>(blend); }
+	inline D3D12_BLEND_OP ToD3D(GfxBlendOp op) { return static_cast<D3D12_BLEND_OP>(op); }
+
+	//----------------------------------------------------------------------------------------------------
+	// buffer description
+	//----------------------------------------------------------------------------------------------------
+	D3D12_RESOURCE_DESC BufferDesc(uint64_t size)
+	{
+		D3D12_RESOURCE_DESC desc = {};
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+		desc.Alignment = 0;
+		desc.Width = size;
+		desc.Height = 1;
+		desc.DepthOrArraySize = 1;
+		desc.MipLevels = 1;
+		desc.Format = DXGI_FORMAT_UNKNOWN;
+		desc.SampleDesc.Count = 1;
+		desc.SampleDesc.Quality = 0;
+		desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+		desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+		return desc;
+	}
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// InlineArray class - small-size optimized scratch array for call translation
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	template<typename T> class InlineArray
+	{
+	public:
+		explicit InlineArray(uint32_t count)
+		{
+			if (count > MaxInlineElements)
+			{
+				m_Heap.resize(count);
+				m_pData = m_Heap.data();
+			}
+			else
+			{
+				m_pData = m_Inline;
+			}
+		}
+
+		T& operator[](uint32_t index) { return m_pData[index]; }
+		T* Get() { return m_pData; }
+
+	private:
+		T m_Inline[MaxInlineElements];
+		std::vector<T> m_Heap;
+		T* m_pData;
+	};
+
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// D3D12Resource class
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	class D3D12Resource : public GfxResource
+	{
+	public:
+		explicit D3D12Resource(ComPtr<ID3D12Resource> pResource) : m_pResource(pResource) { /* DO_NOTHING */ }
+
+		bool Map(void** ppData) override
+		{
+			return SUCCEEDED(m_pResource->Map(0, nullptr, ppData));
+		}
+
+		void Unmap() override { m_pResource->Unmap(0, nullptr); }
+		GfxGpuVirtualAddress GetGPUVirtualAddress() const override { return m_pResource->GetGPUVirtualAddress(); }
+		ID3D12Resource* Get() const { return m_pResource.Get(); }
+
+	private:
+		ComPtr<ID3D12Resource> m_pResource;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// D3D12DescriptorHeap class
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	class D3D12DescriptorHeap : public GfxDescriptorHeap
+	{
+	public:
+		D3D12DescriptorHeap(ComPtr<ID3D12DescriptorHeap> pHeap, bool shaderVisible)
+			: m_pHeap(pHeap)
+			, m_ShaderVisible(shaderVisible)
+		{ /* DO_NOTHING */ }
+
+		GfxCpuDescriptorHandle GetCPUDescriptorHandleForHeapStart() const override
+		{
+			return GfxCpuDescriptorHandle{ m_pHeap->GetCPUDescriptorHandleForHeapStart().ptr };
+		}
+
+		GfxGpuDescriptorHandle GetGPUDescriptorHandleForHeapStart() const override
+		{
+			// only shader visible heaps have GPU handles
+			return GfxGpuDescriptorHandle{ m_ShaderVisible ? m_pHeap->GetGPUDescriptorHandleForHeapStart().ptr : 0 };
+		}
+
+		ID3D12DescriptorHeap* Get() const { return m_pHeap.Get(); }
+
+	private:
+		ComPtr<ID3D12DescriptorHeap> m_pHeap;
+		bool m_ShaderVisible;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// D3D12RootSignature class
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	class D3D12RootSignature : public GfxRootSignature
+	{
+	public:
+		explicit D3D12RootSignature(ComPtr<ID3D12RootSignature> pRootSignature) : m_pRootSignature(pRootSignature) { /* DO_NOTHING */ }
+		ID3D12RootSignature* Get() const { return m_pRootSignature.Get(); }
+
+	private:
+		ComPtr<ID3D12RootSignature> m_pRootSignature;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// D3D12PipelineState class
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	class D3D12PipelineState : public GfxPipelineState
+	{
+	public:
+		explicit D3D12PipelineState(ComPtr<ID3D12PipelineState> pPipelineState) : m_pPipelineState(pPipelineState) { /* DO_NOTHING */ }
+		ID3D12PipelineState* Get() const { return m_pPipelineState.Get(); }
+
+	private:
+		ComPtr<ID3D12PipelineState> m_pPipelineState;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// D3D12PipelineDesc class - translation of GfxGraphicsPipelineDesc shared by creation and library loads
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	class D3D12PipelineDesc
+	{
+	public:
+		explicit D3D12PipelineDesc(const GfxGraphicsPipelineDesc& desc)
+			: m_Elements(desc.NumInputElements)
+		{
+			// configuration of input layout
+			for (uint32_t i = 0u; i < desc.NumInputElements; ++i)
+			{
+				const GfxInputElementDesc& src = desc.pInputElementDescs[i];
+				m_Elements[i].SemanticName = src.SemanticName;
+				m_Elements[i].SemanticIndex = src.SemanticIndex;
+				m_Elements[i].Format = ToD3D(src.Format);
+				m_Elements[i].InputSlot = src.InputSlot;
+				m_Elements[i].AlignedByteOffset = src.AlignedByteOffset;
+				m_Elements[i].InputSlotClass = static_cast<D3D12_INPUT_CLASSIFICATION>(src.InputSlotClass);
+				m_Elements[i].InstanceDataStepRate = src.InstanceDataStepRate;
+			}
+
+			// configuration of rasterizer state
+			D3D12_RASTERIZER_DESC descRS = {};
+			descRS.FillMode = static_cast<D3D12_FILL_MODE>(desc.RasterizerState.FillMode);
+			descRS.CullMode = static_cast<D3D12_CULL_MODE>(desc.RasterizerState.CullMode);
+			descRS.FrontCounterClockwise = desc.RasterizerState.FrontCounterClockwise ? TRUE : FALSE;
+			descRS.DepthBias = D3D12_DEFAULT_DEPTH_BIAS;
+			descRS.DepthBiasClamp = D3D12_DEFAULT_DEPTH_BIAS_CLAMP;
+			descRS.SlopeScaledDepthBias = D3D12_DEFAULT_SLOPE_SCALED_DEPTH_BIAS;
+			descRS.DepthClipEnable = desc.RasterizerState.DepthClipEnable ? TRUE : FALSE;
+			descRS.MultisampleEnable = FALSE;
+			descRS.AntialiasedLineEnable = FALSE;
+			descRS.ForcedSampleCount = 0;
+			descRS.ConservativeRaster = D3D12_CONSERVATIVE_RASTERIZATION_MODE_OFF;
+
+			// blend settings of render target
+			const GfxRenderTargetBlendDesc& blend = desc.BlendState;
+			D3D12_RENDER_TARGET_BLEND_DESC descRTBS = {
+				blend.BlendEnable ? TRUE : FALSE,
+				FALSE,
+				ToD3D(blend.SrcBlend),
+				ToD3D(blend.DestBlend),
+				ToD3D(blend.BlendOp),
+				ToD3D(blend.SrcBlendAlpha),
+				ToD3D(blend.DestBlendAlpha),
+				ToD3D(blend.BlendOpAlpha),
+				D3D12_LOGIC_OP_NOOP,
+				blend.RenderTargetWriteMask
+			};
+
+			// configuration of blend state
+			D3D12_BLEND_DESC descBS;
+			descBS.AlphaToCoverageEnable = FALSE;
+			descBS.IndependentBlendEnable = FALSE;
+			for (UINT i = 0; i < D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
+			{
+				descBS.RenderTarget[i] = descRTBS;
+			}
+
+			// configuration of pipeline state
+			m_Desc = {};
+			m_Desc.InputLayout = { m_Elements.Get(), desc.NumInputElements };
+			m_Desc.pRootSignature = static_cast<D3D12RootSignature*>(desc.pRootSignature)->Get();
+			m_Desc.VS = { desc.VS.pShaderBytecode, desc.VS.BytecodeLength };
+			m_Desc.PS = { desc.PS.pShaderBytecode, desc.PS.BytecodeLength };
+			m_Desc.RasterizerState = descRS;
+			m_Desc.BlendState = descBS;
+			m_Desc.DepthStencilState.DepthEnable = desc.DepthStencilState.DepthEnable ? TRUE : FALSE;
+			m_Desc.DepthStencilState.DepthWriteMask = desc.DepthStencilState.DepthWriteEnable ? D3D12_DEPTH_WRITE_MASK_ALL : D3D12_DEPTH_WRITE_MASK_ZERO;
+			m_Desc.DepthStencilState.DepthFunc = static_cast<D3D12_COMPARISON_FUNC>(desc.DepthStencilState.DepthFunc);
+			m_Desc.DepthStencilState.StencilEnable = FALSE;
+			m_Desc.SampleMask = UINT_MAX;
+			m_Desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+			m_Desc.NumRenderTargets = 1;
+			m_Desc.RTVFormats[0] = ToD3D(desc.RTVFormat);
+			m_Desc.DSVFormat = ToD3D(desc.DSVFormat);
+			m_Desc.SampleDesc.Count = 1;
+			m_Desc.SampleDesc.Quality = 0;
+		}
+
+		const D3D12_GRAPHICS_PIPELINE_STATE_DESC* Get() const { return &m_Desc; }
+
+	private:
+		InlineArray<D3D12_INPUT_ELEMENT_DESC> m_Elements; // input layout (m_Desc points into it)
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC m_Desc; // translated desc
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// D3D12PipelineLibrary class
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	class D3D12PipelineLibrary : public GfxPipelineLibrary
+	{
+	public:
+		explicit D3D12PipelineLibrary(ComPtr<ID3D12PipelineLibrary> pLibrary) : m_pLibrary(pLibrary) { /* DO_NOTHING */ }
+
+		bool LoadGraphicsPipeline(uint64_t key, const GfxGraphicsPipelineDesc& desc, GfxPtr<GfxPipelineState>& pPipelineState) override
+		{
+			wchar_t name[MaxPipelineNameLength];
+			D3D12PipelineDesc psoDesc(desc);
+
+			ComPtr<ID3D12PipelineState> pD3DPipelineState;
+			HRESULT hr = m_pLibrary->LoadGraphicsPipeline(PipelineName(key, name), psoDesc.Get(), IID_PPV_ARGS(pD3DPipelineState.GetAddressOf()));
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			pPipelineState.reset(new D3D12PipelineState(pD3DPipelineState));
+			return true;
+		}
+
+		bool StorePipeline(uint64_t key, GfxPipelineState* pPipelineState) override
+		{
+			wchar_t name[MaxPipelineNameLength];
+			return SUCCEEDED(m_pLibrary->StorePipeline(PipelineName(key, name), static_cast<D3D12PipelineState*>(pPipelineState)->Get()));
+		}
+
+		size_t GetSerializedSize() const override { return m_pLibrary->GetSerializedSize(); }
+		bool Serialize(void* pData, size_t size) const override { return SUCCEEDED(m_pLibrary->Serialize(pData, size)); }
+
+	private:
+		ComPtr<ID3D12PipelineLibrary> m_pLibrary;
+
+		// pipelines are named by the hex digits of their key
+		static const wchar_t* PipelineName(uint64_t key, wchar_t (&name)[MaxPipelineNameLength])
+		{
+			swprintf_s(name, L"%016llx", static_cast<unsigned long long>(key));
+			return name;
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// D3D12QueryHeap class
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	class D3D12QueryHeap : public GfxQueryHeap
+	{
+	public:
+		D3D12QueryHeap(ComPtr<ID3D12QueryHeap> pHeap, uint32_t count)
+			: m_pHeap(pHeap)
+			, m_Count(count)
+		{ /* DO_NOTHING */ }
+
+		uint32_t GetCount() const override { return m_Count; }
+		ID3D12QueryHeap* Get() const { return m_pHeap.Get(); }
+
+	private:
+		ComPtr<ID3D12QueryHeap> m_pHeap;
+		uint32_t m_Count;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// D3D12Heap class
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	class D3D12Heap : public GfxHeap
+	{
+	public:
+		D3D12Heap(ComPtr<ID3D12Heap> pHeap, uint64_t size)
+			: m_pHeap(pHeap)
+			, m_Size(size)
+		{ /* DO_NOTHING */ }
+
+		uint64_t GetSize() const override { return m_Size; }
+		ID3D12Heap* Get() const { return m_pHeap.Get(); }
+
+	private:
+		ComPtr<ID3D12Heap> m_pHeap;
+		uint64_t m_Size;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// D3D12CommandAllocator class
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	class D3D12CommandAllocator : public GfxCommandAllocator
+	{
+	public:
+		explicit D3D12CommandAllocator(ComPtr<ID3D12CommandAllocator> pAllocator) : m_pAllocator(pAllocator) { /* DO_NOTHING */ }
+		void Reset() override { m_pAllocator->Reset(); }
+		ID3D12CommandAllocator* Get() const { return m_pAllocator.Get(); }
+
+	private:
+		ComPtr<ID3D12CommandAllocator> m_pAllocator;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// D3D12Fence class
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	class D3D12Fence : public GfxFence
+	{
+	public:
+		D3D12Fence(ComPtr<ID3D12Fence> pFence, HANDLE event)
+			: m_pFence(pFence)
+			, m_Event(event)
+		{ /* DO_NOTHING */ }
+
+		~D3D12Fence() override
+		{
+			if (m_Event != nullptr)
+			{
+				CloseHandle(m_Event);
+				m_Event = nullptr;
+			}
+		}
+
+		uint64_t GetCompletedValue() const override { return m_pFence->GetCompletedValue(); }
+
+		void Wait(uint64_t value) override
+		{
+			if (m_pFence->GetCompletedValue() < value)
+			{
+				m_pFence->SetEventOnCompletion(value, m_Event);
+				WaitForSingleObjectEx(m_Event, INFINITE, FALSE);
+			}
+		}
+
+		ID3D12Fence* Get() const { return m_pFence.Get(); }
+
+	private:
+		ComPtr<ID3D12Fence> m_pFence;
+		HANDLE m_Event;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// D3D12CommandList class
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	class D3D12CommandList : public GfxCommandList
+	{
+	public:
+		explicit D3D12CommandList(ComPtr<ID3D12GraphicsCommandList> pCmdList) : m_pCmdList(pCmdList) { /* DO_NOTHING */ }
+
+		void Reset(GfxCommandAllocator* pAllocator, GfxPipelineState* pInitialState) override
+		{
+			m_pCmdList->Reset(
+				static_cast<D3D12CommandAllocator*>(pAllocator)->Get(),
+				(pInitialState != nullptr) ? static_cast<D3D12PipelineState*>(pInitialState)->Get() : nullptr);
+		}
+
+		void Close() override { m_pCmdList->Close(); }
+
+		void ResourceBarrier(uint32_t numBarriers, const GfxResourceBarrier* pBarriers) override
+		{
+			InlineArray<D3D12_RESOURCE_BARRIER> barriers(numBarriers);
+			for (uint32_t i = 0u; i < numBarriers; ++i)
+			{
+				D3D12_RESOURCE_BARRIER& barrier = barriers[i];
+				if (pBarriers[i].Type == GfxResourceBarrierType::Aliasing)
+				{
+					barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+					barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+					barrier.Aliasing.pResourceBefore = nullptr;
+					barrier.Aliasing.pResourceAfter = (pBarriers[i].pResource != nullptr) ? static_cast<D3D12Resource*>(pBarriers[i].pResource)->Get() : nullptr;
+					continue;
+				}
+
+				barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+				barrier.Flags = ToD3D(pBarriers[i].Flags);
+				barrier.Transition.pResource = static_cast<D3D12Resource*>(pBarriers[i].pResource)->Get();
+				barrier.Transition.StateBefore = ToD3D(pBarriers[i].StateBefore);
+				barrier.Transition.StateAfter = ToD3D(pBarriers[i].StateAfter);
+				barrier.Transition.Subresource = pBarriers[i].Subresource;
+			}
+			m_pCmdList->ResourceBarrier(numBarriers, barriers.Get());
+		}
+
+		void OMSetRenderTargets(uint32_t numRenderTargets, const GfxCpuDescriptorHandle* pRenderTargets) override
+		{
+			D3D12_CPU_DESCRIPTOR_HANDLE handles[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT];
+			for (uint32_t i = 0u; i < numRenderTargets; ++i)
+			{
+				handles[i] = ToD3D(pRenderTargets[i]);
+			}
+			m_pCmdList->OMSetRenderTargets(numRenderTargets, handles, FALSE, nullptr);
+		}
+
+		void ClearRenderTargetView(GfxCpuDescriptorHandle renderTarget, const float color[4]) override
+		{
+			m_pCmdList->ClearRenderTargetView(ToD3D(renderTarget), color, 0, nullptr);
+		}
+
+		void SetGraphicsRootSignature(GfxRootSignature* pRootSignature) override
+		{
+			m_pCmdList->SetGraphicsRootSignature(static_cast<D3D12RootSignature*>(pRootSignature)->Get());
+		}
+
+		void SetDescriptorHeaps(uint32_t numHeaps, GfxDescriptorHeap* const* ppHeaps) override
+		{
+			ID3D12DescriptorHeap* heaps[2] = {};
+			assert(numHeaps <= 2);
+			for (uint32_t i = 0u; i < numHeaps; ++i)
+			{
+				heaps[i] = static_cast<D3D12DescriptorHeap*>(ppHeaps[i])->Get();
+			}
+			m_pCmdList->SetDescriptorHeaps(numHeaps, heaps);
+		}
+
+		void SetGraphicsRootConstantBufferView(uint32_t rootParameterIndex, GfxGpuVirtualAddress bufferLocation) override
+		{
+			m_pCmdList->SetGraphicsRootConstantBufferView(rootParameterIndex, bufferLocation);
+		}
+
+		void SetGraphicsRootDescriptorTable(uint32_t rootParameterIndex, GfxGpuDescriptorHandle baseDescriptor) override
+		{
+			m_pCmdList->SetGraphicsRootDescriptorTable(rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE{ baseDescriptor.ptr });
+		}
+
+		void SetPipelineState(GfxPipelineState* pPipelineState) override
+		{
+			m_pCmdList->SetPipelineState(static_cast<D3D12PipelineState*>(pPipelineState)->Get());
+		}
+
+		void IASetPrimitiveTopology(GfxPrimitiveTopology topology) override
+		{
+			m_pCmdList->IASetPrimitiveTopology(static_cast<D3D12_PRIMITIVE_TOPOLOGY>(topology));
+		}
+
+		void IASetVertexBuffers(uint32_t startSlot, uint32_t numViews, const GfxVertexBufferView* pViews) override
+		{
+			D3D12_VERTEX_BUFFER_VIEW views[D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+			for (uint32_t i = 0u; i < numViews; ++i)
+			{
+				views[i].BufferLocation = pViews[i].BufferLocation;
+				views[i].SizeInBytes = pViews[i].SizeInBytes;
+				views[i].StrideInBytes = pViews[i].StrideInBytes;
+			}
+			m_pCmdList->IASetVertexBuffers(startSlot, numViews, views);
+		}
+
+		void IASetIndexBuffer(const GfxIndexBufferView* pView) override
+		{
+			if (pView == nullptr)
+			{
+				m_pCmdList->IASetIndexBuffer(nullptr);
+				return;
+			}
+
+			D3D12_INDEX_BUFFER_VIEW view;
+			view.BufferLocation = pView->BufferLocation;
+			view.SizeInBytes = pView->SizeInBytes;
+			view.Format = ToD3D(pView->Format);
+			m_pCmdList->IASetIndexBuffer(&view);
+		}
+
+		void RSSetViewports(uint32_t numViewports, const GfxViewport* pViewports) override
+		{
+			// GfxViewport has the same layout as D3D12_VIEWPORT
+			static_assert(sizeof(GfxViewport) == sizeof(D3D12_VIEWPORT), "layout mismatch");
+			m_pCmdList->RSSetViewports(numViewports, reinterpret_cast<const D3D12_VIEWPORT*>(pViewports));
+		}
+
+		void RSSetScissorRects(uint32_t numRects, const GfxRect* pRects) override
+		{
+			// GfxRect has the same layout as D3D12_RECT
+			static_assert(sizeof(GfxRect) == sizeof(D3D12_RECT), "layout mismatch");
+			m_pCmdList->RSSetScissorRects(numRects, reinterpret_cast<const D3D12_RECT*>(pRects));
+		}
+
+		void DrawIndexedInstanced(
+			uint32_t indexCountPerInstance,
+			uint32_t instanceCount,
+			uint32_t startIndexLocation,
+			int32_t baseVertexLocation,
+			uint32_t startInstanceLocation) override
+		{
+			m_pCmdList->DrawIndexedInstanced(
+				indexCountPerInstance,
+				instanceCount,
+				startIndexLocation,
+				baseVertexLocation,
+				startInstanceLocation);
+		}
+
+		void EndQuery(GfxQueryHeap* pQueryHeap, uint32_t index) override
+		{
+			m_pCmdList->EndQuery(static_cast<D3D12QueryHeap*>(pQueryHeap)->Get(), D3D12_QUERY_TYPE_TIMESTAMP, index);
+		}
+
+		void ResolveQueryData(
+			GfxQueryHeap* pQueryHeap,
+			uint32_t startIndex,
+			uint32_t numQueries,
+			GfxResource* pDestBuffer,
+			uint64_t alignedDestOffset) override
+		{
+			m_pCmdList->ResolveQueryData(
+				static_cast<D3D12QueryHeap*>(pQueryHeap)->Get(),
+				D3D12_QUERY_TYPE_TIMESTAMP,
+				startIndex,
+				numQueries,
+				static_cast<D3D12Resource*>(pDestBuffer)->Get(),
+				alignedDestOffset);
+		}
+
+		void CopyBufferRegion(
+			GfxResource* pDstBuffer,
+			uint64_t dstOffset,
+			GfxResource* pSrcBuffer,
+			uint64_t srcOffset,
+			uint64_t numBytes) override
+		{
+			m_pCmdList->CopyBufferRegion(
+				static_cast<D3D12Resource*>(pDstBuffer)->Get(),
+				dstOffset,
+				static_cast<D3D12Resource*>(pSrcBuffer)->Get(),
+				srcOffset,
+				numBytes);
+		}
+
+		ID3D12GraphicsCommandList* Get() const { return m_pCmdList.Get(); }
+
+	private:
+		ComPtr<ID3D12GraphicsCommandList> m_pCmdList;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// D3D12CommandQueue class
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	class D3D12CommandQueue : public GfxCommandQueue
+	{
+	public:
+		explicit D3D12CommandQueue(ComPtr<ID3D12CommandQueue> pQueue) : m_pQueue(pQueue) { /* DO_NOTHING */ }
+
+		void ExecuteCommandLists(uint32_t numCommandLists, GfxCommandList* const* ppCommandLists) override
+		{
+			InlineArray<ID3D12CommandList*> lists(numCommandLists);
+			for (uint32_t i = 0u; i < numCommandLists; ++i)
+			{
+				lists[i] = static_cast<D3D12CommandList*>(ppCommandLists[i])->Get();
+			}
+			m_pQueue->ExecuteCommandLists(numCommandLists, lists.Get());
+		}
+
+		void Signal(GfxFence* pFence, uint64_t value) override
+		{
+			m_pQueue->Signal(static_cast<D3D12Fence*>(pFence)->Get(), value);
+		}
+
+		void Wait(GfxFence* pFence, uint64_t value) override
+		{
+			m_pQueue->Wait(static_cast<D3D12Fence*>(pFence)->Get(), value);
+		}
+
+		uint64_t GetTimestampFrequency() const override
+		{
+			UINT64 frequency = 0;
+			return SUCCEEDED(m_pQueue->GetTimestampFrequency(&frequency)) ? frequency : 0;
+		}
+
+		bool GetClockCalibration(uint64_t& gpuTimestamp, uint64_t& cpuNanoseconds) const override
+		{
+			UINT64 gpu = 0;
+			UINT64 qpc = 0;
+			LARGE_INTEGER frequency;
+			if (FAILED(m_pQueue->GetClockCalibration(&gpu, &qpc)) || !QueryPerformanceFrequency(&frequency))
+			{
+				return false;
+			}
+
+			// steady_clock counts QueryPerformanceCounter ticks in nanoseconds, split so that it can't overflow
+			uint64_t ticks = static_cast<uint64_t>(frequency.QuadPart);
+			gpuTimestamp = gpu;
+			cpuNanoseconds = (qpc / ticks) * 1000000000ull + (qpc % ticks) * 1000000000ull / ticks;
+			return true;
+		}
+
+		ID3D12CommandQueue* Get() const { return m_pQueue.Get(); }
+
+	private:
+		ComPtr<ID3D12CommandQueue> m_pQueue;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// D3D12SwapChain class
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	class D3D12SwapChain : public GfxSwapChain
+	{
+	public:
+		explicit D3D12SwapChain(ComPtr<IDXGISwapChain3> pSwapChain) : m_pSwapChain(pSwapChain) { /* DO_NOTHING */ }
+
+		bool AcquireBuffers(uint32_t count)
+		{
+			for (uint32_t i = 0u; i < count; ++i)
+			{
+				ComPtr<ID3D12Resource> pBuffer;
+				HRESULT hr = m_pSwapChain->GetBuffer(i, IID_PPV_ARGS(pBuffer.GetAddressOf()));
+				if (FAILED(hr))
+				{
+					return false;
+				}
+				m_Buffers.emplace_back(new D3D12Resource(pBuffer));
+			}
+			return true;
+		}
+
+		GfxResource* GetBuffer(uint32_t index) const override
+		{
+			return (index < m_Buffers.size()) ? m_Buffers[index].get() : nullptr;
+		}
+
+		uint32_t GetCurrentBackBufferIndex() const override { return m_pSwapChain->GetCurrentBackBufferIndex(); }
+		void Present(uint32_t syncInterval) override { m_pSwapChain->Present(syncInterval, 0); }
+
+	private:
+		ComPtr<IDXGISwapChain3> m_pSwapChain;
+		std::vector<GfxPtr<GfxResource>> m_Buffers;
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// D3D12GfxDevice class
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	class D3D12GfxDevice : public GfxDevice
+	{
+	public:
+		explicit D3D12GfxDevice(ComPtr<ID3D12Device> pDevice) : m_pDevice(pDevice) { /* DO_NOTHING */ }
+
+		GfxBackend GetBackend() const override { return GfxBackend::D3D12; }
+		bool IsHeadless() const override { return false; }
+
+		bool CreateCommandQueue(GfxCommandListType type, GfxPtr<GfxCommandQueue>& pQueue) override
+		{
+			D3D12_COMMAND_QUEUE_DESC desc = {};
+			desc.Type = ToD3D(type);
+			desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+			desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+			desc.NodeMask = 0;
+
+			ComPtr<ID3D12CommandQueue> pD3DQueue;
+			HRESULT hr = m_pDevice->CreateCommandQueue(&desc, IID_PPV_ARGS(pD3DQueue.GetAddressOf()));
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			pQueue.reset(new D3D12CommandQueue(pD3DQueue));
+			return true;
+		}
+
+		bool CreateSwapChain(GfxCommandQueue* pQueue, const GfxSwapChainDesc& desc, GfxPtr<GfxSwapChain>& pSwapChain) override
+		{
+			// generate DXGI factory
+			ComPtr<IDXGIFactory4> pFactory = nullptr;
+			HRESULT hr = CreateDXGIFactory1(IID_PPV_ARGS(pFactory.GetAddressOf()));
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			// settings of swap chain
+			DXGI_SWAP_CHAIN_DESC swapChainDesc = {};
+			swapChainDesc.BufferDesc.Width = desc.Width;
+			swapChainDesc.BufferDesc.Height = desc.Height;
+			swapChainDesc.BufferDesc.RefreshRate.Numerator = 60;
+			swapChainDesc.BufferDesc.RefreshRate.Denominator = 1;
+			swapChainDesc.BufferDesc.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
+			swapChainDesc.BufferDesc.Scaling = DXGI_MODE_SCALING_UNSPECIFIED;
+			swapChainDesc.BufferDesc.Format = ToD3D(desc.Format);
+			swapChainDesc.SampleDesc.Count = 1;
+			swapChainDesc.SampleDesc.Quality = 0;
+			swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+			swapChainDesc.BufferCount = desc.BufferCount;
+			swapChainDesc.OutputWindow = static_cast<HWND>(desc.pNativeWindow);
+			swapChainDesc.Windowed = TRUE;
+			swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+			swapChainDesc.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
+
+			// generate swap chain
+			ComPtr<IDXGISwapChain> pDXGISwapChain = nullptr;
+			hr = pFactory->CreateSwapChain(
+				static_cast<D3D12CommandQueue*>(pQueue)->Get(),
+				&swapChainDesc,
+				pDXGISwapChain.GetAddressOf());
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			// get IDXGISwapChain3
+			ComPtr<IDXGISwapChain3> pSwapChain3;
+			hr = pDXGISwapChain.As(&pSwapChain3);
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			auto pD3D12SwapChain = new D3D12SwapChain(pSwapChain3);
+			pSwapChain.reset(pD3D12SwapChain);
+			return pD3D12SwapChain->AcquireBuffers(desc.BufferCount);
+		}
+
+		bool CreateCommandAllocator(GfxCommandListType type, GfxPtr<GfxCommandAllocator>& pAllocator) override
+		{
+			ComPtr<ID3D12CommandAllocator> pD3DAllocator;
+			HRESULT hr = m_pDevice->CreateCommandAllocator(ToD3D(type), IID_PPV_ARGS(pD3DAllocator.GetAddressOf()));
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			pAllocator.reset(new D3D12CommandAllocator(pD3DAllocator));
+			return true;
+		}
+
+		bool CreateCommandList(GfxCommandListType type, GfxCommandAllocator* pAllocator, GfxPtr<GfxCommandList>& pCmdList) override
+		{
+			ComPtr<ID3D12GraphicsCommandList> pD3DCmdList;
+			HRESULT hr = m_pDevice->CreateCommandList(
+				0,
+				ToD3D(type),
+				static_cast<D3D12CommandAllocator*>(pAllocator)->Get(),
+				nullptr,
+				IID_PPV_ARGS(pD3DCmdList.GetAddressOf()));
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			pCmdList.reset(new D3D12CommandList(pD3DCmdList));
+			return true;
+		}
+
+		bool CreateFence(uint64_t initialValue, GfxPtr<GfxFence>& pFence) override
+		{
+			ComPtr<ID3D12Fence> pD3DFence;
+			HRESULT hr = m_pDevice->CreateFence(initialValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(pD3DFence.GetAddressOf()));
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			// generate event
+			HANDLE event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+			if (event == nullptr)
+			{
+				return false;
+			}
+
+			pFence.reset(new D3D12Fence(pD3DFence, event));
+			return true;
+		}
+
+		bool CreateDescriptorHeap(const GfxDescriptorHeapDesc& desc, GfxPtr<GfxDescriptorHeap>& pHeap) override
+		{
+			D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+			heapDesc.Type = ToD3D(desc.Type);
+			heapDesc.NumDescriptors = desc.NumDescriptors;
+			heapDesc.Flags = desc.ShaderVisible ? D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE : D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+			heapDesc.NodeMask = 0;
+
+			ComPtr<ID3D12DescriptorHeap> pD3DHeap;
+			HRESULT hr = m_pDevice->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(pD3DHeap.GetAddressOf()));
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			pHeap.reset(new D3D12DescriptorHeap(pD3DHeap, desc.ShaderVisible));
+			return true;
+		}
+
+		bool CreateBuffer(const GfxBufferDesc& desc, GfxPtr<GfxResource>& pResource) override
+		{
+			// heap property
+			D3D12_HEAP_PROPERTIES prop = {};
+			prop.Type = static_cast<D3D12_HEAP_TYPE>(desc.HeapType);
+			prop.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+			prop.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+			prop.CreationNodeMask = 1;
+			prop.VisibleNodeMask = 1;
+
+			D3D12_RESOURCE_DESC resourceDesc = BufferDesc(desc.Size);
+
+			ComPtr<ID3D12Resource> pD3DResource;
+			HRESULT hr = m_pDevice->CreateCommittedResource(
+				&prop,
+				D3D12_HEAP_FLAG_NONE,
+				&resourceDesc,
+				ToD3D(desc.InitialState),
+				nullptr,
+				IID_PPV_ARGS(pD3DResource.GetAddressOf()));
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			pResource.reset(new D3D12Resource(pD3DResource));
+			return true;
+		}
+
+		bool CreateHeap(const GfxHeapDesc& desc, GfxPtr<GfxHeap>& pHeap) override
+		{
+			D3D12_HEAP_DESC heapDesc = {};
+			heapDesc.SizeInBytes = desc.Size;
+			heapDesc.Properties.Type = static_cast<D3D12_HEAP_TYPE>(desc.HeapType);
+			heapDesc.Properties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+			heapDesc.Properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+			heapDesc.Properties.CreationNodeMask = 1;
+			heapDesc.Properties.VisibleNodeMask = 1;
+			heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+			heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+
+			ComPtr<ID3D12Heap> pD3DHeap;
+			HRESULT hr = m_pDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(pD3DHeap.GetAddressOf()));
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			pHeap.reset(new D3D12Heap(pD3DHeap, desc.Size));
+			return true;
+		}
+
+		bool CreatePlacedBuffer(GfxHeap* pHeap, uint64_t offset, const GfxBufferDesc& desc, GfxPtr<GfxResource>& pResource) override
+		{
+			if (pHeap == nullptr || offset % GfxPlacementAlignment != 0 || offset + desc.Size > pHeap->GetSize())
+			{
+				return false;
+			}
+
+			D3D12_RESOURCE_DESC resourceDesc = BufferDesc(desc.Size);
+
+			ComPtr<ID3D12Resource> pD3DResource;
+			HRESULT hr = m_pDevice->CreatePlacedResource(
+				static_cast<D3D12Heap*>(pHeap)->Get(),
+				offset,
+				&resourceDesc,
+				ToD3D(desc.InitialState),
+				nullptr,
+				IID_PPV_ARGS(pD3DResource.GetAddressOf()));
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			pResource.reset(new D3D12Resource(pD3DResource));
+			return true;
+		}
+
+		bool CreateRootSignature(const GfxRootSignatureDesc& desc, GfxPtr<GfxRootSignature>& pRootSignature) override
+		{
+			D3D12_ROOT_SIGNATURE_FLAGS flag = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+			if (desc.AllowInputLayout)
+			{
+				flag |= D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
+			}
+			flag |= D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS;
+			flag |= D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS;
+			flag |= D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS;
+
+			// configuration of root parameters (descriptor tables have one range each)
+			InlineArray<D3D12_ROOT_PARAMETER> params(desc.NumParameters);
+			InlineArray<D3D12_DESCRIPTOR_RANGE> ranges(desc.NumParameters);
+			for (uint32_t i = 0u; i < desc.NumParameters; ++i)
+			{
+				const GfxRootParameter& src = desc.pParameters[i];
+				params[i] = {};
+				params[i].ParameterType = static_cast<D3D12_ROOT_PARAMETER_TYPE>(src.ParameterType);
+				params[i].ShaderVisibility = static_cast<D3D12_SHADER_VISIBILITY>(src.ShaderVisibility);
+
+				if (src.ParameterType == GfxRootParameterType::DescriptorTable)
+				{
+					ranges[i].RangeType = static_cast<D3D12_DESCRIPTOR_RANGE_TYPE>(src.RangeType);
+					ranges[i].NumDescriptors = src.NumDescriptors;
+					ranges[i].BaseShaderRegister = src.ShaderRegister;
+					ranges[i].RegisterSpace = src.RegisterSpace;
+					ranges[i].OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
+
+					params[i].DescriptorTable.NumDescriptorRanges = 1;
+					params[i].DescriptorTable.pDescriptorRanges = &ranges[i];
+				}
+				else
+				{
+					params[i].Descriptor.ShaderRegister = src.ShaderRegister;
+					params[i].Descriptor.RegisterSpace = src.RegisterSpace;
+				}
+			}
+
+			// configuration of root signature
+			D3D12_ROOT_SIGNATURE_DESC rootDesc = {};
+			rootDesc.NumParameters = desc.NumParameters;
+			rootDesc.NumStaticSamplers = 0;
+			rootDesc.pParameters = params.Get();
+			rootDesc.pStaticSamplers = nullptr;
+			rootDesc.Flags = flag;
+
+			ComPtr<ID3DBlob> pBlob;
+			ComPtr<ID3DBlob> pErrorBlob;
+
+			// serialize
+			HRESULT hr = D3D12SerializeRootSignature(
+				&rootDesc,
+				D3D_ROOT_SIGNATURE_VERSION_1_0,
+				pBlob.GetAddressOf(),
+				pErrorBlob.GetAddressOf());
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			// generate root signature
+			ComPtr<ID3D12RootSignature> pD3DRootSignature;
+			hr = m_pDevice->CreateRootSignature(
+				0,
+				pBlob->GetBufferPointer(),
+				pBlob->GetBufferSize(),
+				IID_PPV_ARGS(pD3DRootSignature.GetAddressOf()));
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			pRootSignature.reset(new D3D12RootSignature(pD3DRootSignature));
+			return true;
+		}
+
+		bool CreateGraphicsPipelineState(const GfxGraphicsPipelineDesc& desc, GfxPtr<GfxPipelineState>& pPipelineState) override
+		{
+			D3D12PipelineDesc psoDesc(desc);
+
+			// generate pipeline state
+			ComPtr<ID3D12PipelineState> pD3DPipelineState;
+			HRESULT hr = m_pDevice->CreateGraphicsPipelineState(psoDesc.Get(), IID_PPV_ARGS(pD3DPipelineState.GetAddressOf()));
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			pPipelineState.reset(new D3D12PipelineState(pD3DPipelineState));
+			return true;
+		}
+
+		bool CreatePipelineLibrary(const void* pBlob, size_t blobSize, GfxPtr<GfxPipelineLibrary>& pLibrary) override
+		{
+			// pipeline libraries need ID3D12Device1 (Windows 10 Anniversary Update)
+			ComPtr<ID3D12Device1> pDevice1;
+			if (FAILED(m_pDevice.As(&pDevice1)))
+			{
+				return false;
+			}
+
+			// blobs of another driver or adapter fail here and the caller starts over with an empty library
+			ComPtr<ID3D12PipelineLibrary> pD3DLibrary;
+			HRESULT hr = pDevice1->CreatePipelineLibrary(
+				pBlob,
+				(pBlob != nullptr) ? blobSize : 0,
+				IID_PPV_ARGS(pD3DLibrary.GetAddressOf()));
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			pLibrary.reset(new D3D12PipelineLibrary(pD3DLibrary));
+			return true;
+		}
+
+		bool CreateTimestampQueryHeap(uint32_t count, GfxPtr<GfxQueryHeap>& pQueryHeap) override
+		{
+			D3D12_QUERY_HEAP_DESC desc = {};
+			desc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+			desc.Count = count;
+			desc.NodeMask = 0;
+
+			ComPtr<ID3D12QueryHeap> pD3DHeap;
+			HRESULT hr = m_pDevice->CreateQueryHeap(&desc, IID_PPV_ARGS(pD3DHeap.GetAddressOf()));
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			pQueryHeap.reset(new D3D12QueryHeap(pD3DHeap, count));
+			return true;
+		}
+
+		uint32_t GetDescriptorHandleIncrementSize(GfxDescriptorHeapType type) const override
+		{
+			return m_pDevice->GetDescriptorHandleIncrementSize(ToD3D(type));
+		}
+
+		void CreateConstantBufferView(const GfxConstantBufferViewDesc& desc, GfxCpuDescriptorHandle destDescriptor) override
+		{
+			D3D12_CONSTANT_BUFFER_VIEW_DESC viewDesc = {};
+			viewDesc.BufferLocation = desc.BufferLocation;
+			viewDesc.SizeInBytes = desc.SizeInBytes;
+			m_pDevice->CreateConstantBufferView(&viewDesc, ToD3D(destDescriptor));
+		}
+
+		void CreateRenderTargetView(GfxResource* pResource, GfxFormat format, GfxCpuDescriptorHandle destDescriptor) override
+		{
+			D3D12_RENDER_TARGET_VIEW_DESC viewDesc = {};
+			viewDesc.Format = ToD3D(format);
+			viewDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
+			viewDesc.Texture2D.MipSlice = 0;
+			viewDesc.Texture2D.PlaneSlice = 0;
+			m_pDevice->CreateRenderTargetView(static_cast<D3D12Resource*>(pResource)->Get(), &viewDesc, ToD3D(destDescriptor));
+		}
+
+		void CopyDescriptorsSimple(
+			uint32_t numDescriptors,
+			GfxCpuDescriptorHandle destDescriptorRangeStart,
+			GfxCpuDescriptorHandle srcDescriptorRangeStart,
+			GfxDescriptorHeapType type) override
+		{
+			m_pDevice->CopyDescriptorsSimple(
+				numDescriptors,
+				ToD3D(destDescriptorRangeStart),
+				ToD3D(srcDescriptorRangeStart),
+				ToD3D(type));
+		}
+
+	private:
+		ComPtr<ID3D12Device> m_pDevice;
+	};
+
+} // namespace /* anonymous */
+
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate Direct3D 12 device
+//--------------------------------------------------------------------------------------------------------
+bool CreateD3D12GfxDevice(GfxPtr<GfxDevice>& pDevice)
+{
+#if defined(DEBUG) || defined(_DEBUG)
+	{
+		ComPtr<ID3D12Debug> debug;
+		auto hr = D3D12GetDebugInterface(IID_PPV_ARGS(debug.GetAddressOf()));
+
+		// enable debug layer
+		if (SUCCEEDED(hr))
+		{
+			debug->EnableDebugLayer();
+		}
+	}
+#endif
+
+	// generate device
+	ComPtr<ID3D12Device> pD3DDevice;
+	HRESULT hr = D3D12CreateDevice(
+		nullptr,
+		D3D_FEATURE_LEVEL_11_0,
+		IID_PPV_ARGS(pD3DDevice.GetAddressOf()));
+	if (FAILED(hr))
+	{
+		return false;
+	}
+
+	pDevice.reset(new D3D12GfxDevice(pD3DDevice));
+	return true;
+}
+
+#else
+
+//--------------------------------------------------------------------------------------------------------
+//	 Direct3D 12 is unavailable on this platform
+//--------------------------------------------------------------------------------------------------------
+bool CreateD3D12GfxDevice(GfxPtr<GfxDevice>& pDevice)
+{
+	pDevice.reset();
+	return false;
+}
+
+#endif // defined(_WIN32)
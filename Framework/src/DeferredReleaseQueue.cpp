@@ -0,0 +1,142 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <DeferredReleaseQueue.h>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DeferredReleaseQueue class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+DeferredReleaseQueue::DeferredReleaseQueue()
+	: m_Stats()
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+DeferredReleaseQueue::~DeferredReleaseQueue()
+{
+	Term();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 free everything (the GPU is idle)
+//--------------------------------------------------------------------------------------------------------
+void DeferredReleaseQueue::Term()
+{
+	for (Entry& entry : m_Entries)
+	{
+		FreeEntry(entry);
+	}
+	m_Entries.clear();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 queue an object
+//--------------------------------------------------------------------------------------------------------
+void DeferredReleaseQueue::Release(GfxPtr<GfxObject> pObject, uint64_t fenceValue, uint64_t size)
+{
+	if (pObject == nullptr)
+	{
+		return;
+	}
+
+	Entry entry = {};
+	entry.FenceValue = fenceValue;
+	entry.Size = size;
+	entry.pObject = std::move(pObject);
+	Push(std::move(entry));
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 queue a descriptor
+//--------------------------------------------------------------------------------------------------------
+void DeferredReleaseQueue::Release(DescriptorPool* pPool, DescriptorHandle& handle, uint64_t fenceValue)
+{
+	if (pPool == nullptr || !handle.IsValid())
+	{
+		return;
+	}
+
+	Entry entry = {};
+	entry.FenceValue = fenceValue;
+	entry.pPool = pPool;
+	entry.Descriptor = handle;
+	Push(std::move(entry));
+
+	// the caller's copy must not be used or freed again
+	handle.CPU.ptr = 0;
+	handle.Index = DescriptorHandle::InvalidIndex;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 queue a callback
+//--------------------------------------------------------------------------------------------------------
+void DeferredReleaseQueue::Release(std::function<void()> free, uint64_t fenceValue, uint64_t size)
+{
+	if (!free)
+	{
+		return;
+	}
+
+	Entry entry = {};
+	entry.FenceValue = fenceValue;
+	entry.Size = size;
+	entry.Free = std::move(free);
+	Push(std::move(entry));
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 free what the GPU has finished with
+//--------------------------------------------------------------------------------------------------------
+uint32_t DeferredReleaseQueue::Collect(uint64_t completedValue)
+{
+	// values are in submission order, the first one not reached ends the scan
+	uint32_t count = 0;
+	while (!m_Entries.empty() && m_Entries.front().FenceValue <= completedValue)
+	{
+		FreeEntry(m_Entries.front());
+		m_Entries.pop_front();
+		count++;
+	}
+	return count;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 append an entry
+//--------------------------------------------------------------------------------------------------------
+void DeferredReleaseQueue::Push(Entry&& entry)
+{
+	m_Stats.ReleaseCount++;
+	m_Stats.PendingCount++;
+	m_Stats.PendingBytes += entry.Size;
+	m_Stats.PeakPendingBytes = (m_Stats.PendingBytes > m_Stats.PeakPendingBytes) ? m_Stats.PendingBytes : m_Stats.PeakPendingBytes;
+	m_Entries.push_back(std::move(entry));
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 free an entry (it stays in the queue)
+//--------------------------------------------------------------------------------------------------------
+void DeferredReleaseQueue::FreeEntry(Entry& entry)
+{
+	entry.pObject.reset();
+	if (entry.pPool != nullptr)
+	{
+		entry.pPool->Free(entry.Descriptor);
+	}
+	if (entry.Free)
+	{
+		entry.Free();
+	}
+
+	m_Stats.FreeCount++;
+	m_Stats.PendingCount--;
+	m_Stats.PendingBytes -= entry.Size;
+	m_Stats.FreedBytes += entry.Size;
+}
@@ -0,0 +1,296 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <DescriptorAllocator.h>
+#include <cassert>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DescriptorPool class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+DescriptorPool::DescriptorPool()
+	: m_pDevice(nullptr)
+	, m_Type(GfxDescriptorHeapType::CBV_SRV_UAV)
+	, m_PageSize(0)
+	, m_IncrementSize(0)
+	, m_Allocated(0)
+	, m_PeakAllocated(0)
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+DescriptorPool::~DescriptorPool()
+{
+	Term();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 initialization
+//--------------------------------------------------------------------------------------------------------
+bool DescriptorPool::Init(GfxDevice* pDevice, GfxDescriptorHeapType type, uint32_t pageSize)
+{
+	if (pDevice == nullptr || pageSize == 0)
+	{
+		return false;
+	}
+
+	Term();
+
+	m_pDevice = pDevice;
+	m_Type = type;
+	m_PageSize = pageSize;
+	m_IncrementSize = pDevice->GetDescriptorHandleIncrementSize(type);
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 termination
+//--------------------------------------------------------------------------------------------------------
+void DescriptorPool::Term()
+{
+	m_Pages.clear();
+	m_FreeList.clear();
+	m_pDevice = nullptr;
+	m_PageSize = 0;
+	m_IncrementSize = 0;
+	m_Allocated = 0;
+	m_PeakAllocated = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 allocation
+//--------------------------------------------------------------------------------------------------------
+bool DescriptorPool::Allocate(DescriptorHandle& handle)
+{
+	if (m_FreeList.empty() && !AddPage())
+	{
+		handle.CPU.ptr = 0;
+		handle.Index = DescriptorHandle::InvalidIndex;
+		return false;
+	}
+
+	uint32_t index = m_FreeList.back();
+	m_FreeList.pop_back();
+
+	Page& page = m_Pages[index / m_PageSize];
+	page.UsedCount++;
+
+	handle.CPU.ptr = page.Start.ptr + size_t(index % m_PageSize) * m_IncrementSize;
+	handle.Index = index;
+
+	m_Allocated++;
+	if (m_Allocated > m_PeakAllocated)
+	{
+		m_PeakAllocated = m_Allocated;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 release
+//--------------------------------------------------------------------------------------------------------
+void DescriptorPool::Free(DescriptorHandle& handle)
+{
+	if (!handle.IsValid())
+	{
+		return;
+	}
+
+	assert(handle.Index < m_Pages.size() * m_PageSize);
+	m_Pages[handle.Index / m_PageSize].UsedCount--;
+	m_FreeList.push_back(handle.Index);
+	m_Allocated--;
+
+	handle.CPU.ptr = 0;
+	handle.Index = DescriptorHandle::InvalidIndex;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 statistics
+//--------------------------------------------------------------------------------------------------------
+DescriptorPoolStats DescriptorPool::GetStats() const
+{
+	DescriptorPoolStats stats = {};
+	stats.Allocated = m_Allocated;
+	stats.PeakAllocated = m_PeakAllocated;
+	stats.PageCount = static_cast<uint32_t>(m_Pages.size());
+	stats.Capacity = stats.PageCount * m_PageSize;
+
+	// holes are free slots below the highest used slot of a page, free slots above it are still one run
+	std::vector<bool> isFree(stats.Capacity, false);
+	for (uint32_t index : m_FreeList)
+	{
+		isFree[index] = true;
+	}
+
+	uint32_t holes = 0;
+	for (uint32_t page = 0; page < stats.PageCount; ++page)
+	{
+		uint32_t first = page * m_PageSize;
+		uint32_t end = first + m_PageSize;
+		while (end > first && isFree[end - 1])
+		{
+			--end;
+		}
+		holes += (end - first) - m_Pages[page].UsedCount;
+	}
+
+	uint32_t freeCount = stats.Capacity - stats.Allocated;
+	stats.Fragmentation = (freeCount > 0) ? float(holes) / float(freeCount) : 0.0f;
+	return stats;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 add a heap page
+//--------------------------------------------------------------------------------------------------------
+bool DescriptorPool::AddPage()
+{
+	if (m_pDevice == nullptr)
+	{
+		return false;
+	}
+
+	GfxDescriptorHeapDesc desc = {};
+	desc.Type = m_Type;
+	desc.NumDescriptors = m_PageSize;
+	desc.ShaderVisible = false;
+
+	Page page = {};
+	if (!m_pDevice->CreateDescriptorHeap(desc, page.pHeap))
+	{
+		return false;
+	}
+	page.Start = page.pHeap->GetCPUDescriptorHandleForHeapStart();
+
+	// push in reverse so that the lowest slot is handed out first
+	uint32_t first = static_cast<uint32_t>(m_Pages.size()) * m_PageSize;
+	for (uint32_t i = m_PageSize; i > 0; --i)
+	{
+		m_FreeList.push_back(first + i - 1);
+	}
+
+	m_Pages.push_back(std::move(page));
+	return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DescriptorRing class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+DescriptorRing::DescriptorRing()
+	: m_pDevice(nullptr)
+	, m_Type(GfxDescriptorHeapType::CBV_SRV_UAV)
+	, m_CPUStart{ 0 }
+	, m_GPUStart{ 0 }
+	, m_IncrementSize(0)
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+DescriptorRing::~DescriptorRing()
+{
+	Term();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 initialization
+//--------------------------------------------------------------------------------------------------------
+bool DescriptorRing::Init(GfxDevice* pDevice, GfxDescriptorHeapType type, uint32_t capacity)
+{
+	if (pDevice == nullptr || capacity == 0)
+	{
+		return false;
+	}
+
+	Term();
+
+	GfxDescriptorHeapDesc desc = {};
+	desc.Type = type;
+	desc.NumDescriptors = capacity;
+	desc.ShaderVisible = true;
+
+	if (!pDevice->CreateDescriptorHeap(desc, m_pHeap))
+	{
+		return false;
+	}
+
+	m_pDevice = pDevice;
+	m_Type = type;
+	m_CPUStart = m_pHeap->GetCPUDescriptorHandleForHeapStart();
+	m_GPUStart = m_pHeap->GetGPUDescriptorHandleForHeapStart();
+	m_IncrementSize = pDevice->GetDescriptorHandleIncrementSize(type);
+	m_Ring.Reset(capacity);
+	m_Ring.ResetStats();
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 termination
+//--------------------------------------------------------------------------------------------------------
+void DescriptorRing::Term()
+{
+	m_pHeap.reset();
+	m_pDevice = nullptr;
+	m_CPUStart.ptr = 0;
+	m_GPUStart.ptr = 0;
+	m_IncrementSize = 0;
+	m_Ring.Reset(0);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 allocation
+//--------------------------------------------------------------------------------------------------------
+bool DescriptorRing::Allocate(uint32_t count, GfxCpuDescriptorHandle& cpu, GfxGpuDescriptorHandle& gpu)
+{
+	uint64_t offset = 0;
+	if (!m_Ring.Allocate(count, 1, offset))
+	{
+		return false;
+	}
+
+	cpu.ptr = m_CPUStart.ptr + size_t(offset) * m_IncrementSize;
+	gpu.ptr = m_GPUStart.ptr + offset * m_IncrementSize;
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 copy descriptors into a table
+//--------------------------------------------------------------------------------------------------------
+bool DescriptorRing::Stage(const GfxCpuDescriptorHandle* pSources, uint32_t count, GfxGpuDescriptorHandle& table)
+{
+	GfxCpuDescriptorHandle dest = {};
+	if (pSources == nullptr || !Allocate(count, dest, table))
+	{
+		return false;
+	}
+
+	uint32_t runStart = 0;
+	for (uint32_t i = 1; i <= count; ++i)
+	{
+		// extend the run while the sources are neighbours in one heap
+		if (i < count && pSources[i].ptr == pSources[i - 1].ptr + m_IncrementSize)
+		{
+			continue;
+		}
+
+		GfxCpuDescriptorHandle runDest = { dest.ptr + size_t(runStart) * m_IncrementSize };
+		m_pDevice->CopyDescriptorsSimple(i - runStart, runDest, pSources[runStart], m_Type);
+		runStart = i;
+	}
+
+	return true;
+}
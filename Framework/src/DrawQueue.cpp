@@ -0,0 +1,134 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <DrawQueue.h>
+#include <algorithm>
+#include <cstring>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DrawQueue class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+DrawQueue::DrawQueue()
+	: m_Histograms(size_t(DigitCount) << DigitBits)
+	, m_SortPassCount(0)
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 room for the draws of a frame
+//--------------------------------------------------------------------------------------------------------
+void DrawQueue::Reserve(uint32_t count)
+{
+	m_Packets.reserve(count);
+	m_Scratch.reserve(count);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 sort the draws by key
+//--------------------------------------------------------------------------------------------------------
+void DrawQueue::Sort()
+{
+	m_SortPassCount = 0;
+	size_t count = m_Packets.size();
+	if (count < RadixThreshold)
+	{
+		std::stable_sort(m_Packets.begin(), m_Packets.end(), [](const DrawPacket& a, const DrawPacket& b) { return a.Key < b.Key; });
+		return;
+	}
+
+	// counts of every digit in one read of the keys
+	const uint32_t radix = 1u << DigitBits;
+	std::fill(m_Histograms.begin(), m_Histograms.end(), 0u);
+	for (const DrawPacket& packet : m_Packets)
+	{
+		uint64_t key = packet.Key;
+		for (uint32_t digit = 0; digit < DigitCount; ++digit)
+		{
+			m_Histograms[(digit << DigitBits) + ((key >> (digit * DigitBits)) & (radix - 1))]++;
+		}
+	}
+
+	m_Scratch.resize(count);
+	DrawPacket* pSource = m_Packets.data();
+	DrawPacket* pDest = m_Scratch.data();
+	uint64_t firstKey = m_Packets[0].Key;
+	for (uint32_t digit = 0; digit < DigitCount; ++digit)
+	{
+		// all keys share the digit, the order stays as it is
+		uint32_t* pCounts = &m_Histograms[digit << DigitBits];
+		uint32_t shift = digit * DigitBits;
+		if (pCounts[(firstKey >> shift) & (radix - 1)] == count)
+		{
+			continue;
+		}
+
+		// first position of each digit value, then every draw behind the ones before it
+		uint32_t offset = 0;
+		for (uint32_t value = 0; value < radix; ++value)
+		{
+			uint32_t valueCount = pCounts[value];
+			pCounts[value] = offset;
+			offset += valueCount;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const DrawPacket& packet = pSource[i];
+			pDest[pCounts[(packet.Key >> shift) & (radix - 1)]++] = packet;
+		}
+		std::swap(pSource, pDest);
+		m_SortPassCount++;
+	}
+
+	// an odd number of passes leaves the result in the scratch buffer
+	if (pSource != m_Packets.data())
+	{
+		m_Packets.swap(m_Scratch);
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 key of a draw
+//--------------------------------------------------------------------------------------------------------
+uint64_t DrawQueue::MakeKey(uint32_t pass, uint32_t pipeline, uint32_t material, float depth, bool backToFront)
+{
+	// the bits of non-negative floats grow with their value
+	uint32_t depthBits = 0;
+	if (depth > 0.f)
+	{
+		memcpy(&depthBits, &depth, sizeof(depthBits));
+	}
+	if (backToFront)
+	{
+		depthBits = ~depthBits;
+	}
+
+	return (uint64_t(pass & (MaxPasses - 1)) << (64 - PassBits))
+		| (uint64_t(pipeline & (MaxPipelines - 1)) << (32 + MaterialBits))
+		| (uint64_t(material & (MaxMaterials - 1)) << 32)
+		| depthBits;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 binds of a submission order
+//--------------------------------------------------------------------------------------------------------
+DrawStateChanges DrawQueue::CountStateChanges(const DrawPacket* pPackets, uint32_t count)
+{
+	// everything above the depth is state, the first draw binds all of it
+	DrawStateChanges changes = {};
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		uint64_t key = pPackets[i].Key;
+		uint64_t previous = (i > 0) ? pPackets[i - 1].Key : ~key;
+		changes.PassChanges += (GetPass(key) != GetPass(previous)) ? 1 : 0;
+		changes.PipelineChanges += ((key >> (32 + MaterialBits)) != (previous >> (32 + MaterialBits))) ? 1 : 0;
+		changes.MaterialChanges += ((key >> 32) != (previous >> 32)) ? 1 : 0;
+	}
+	return changes;
+}
@@ -0,0 +1,133 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <FrameTimeline.h>
+#include <Profiler.h>
+#include <chrono>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// FrameTimeline class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+FrameTimeline::FrameTimeline()
+	: m_pQueue(nullptr)
+	, m_pFence(nullptr)
+	, m_FramesInFlight(0)
+	, m_FrameSlot(0)
+	, m_FrameValue(0)
+	, m_Stats()
+{
+	for (uint32_t i = 0; i < MaxFramesInFlight; ++i)
+	{
+		m_SlotValues[i] = 0;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+FrameTimeline::~FrameTimeline()
+{
+	Term();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 initialization
+//--------------------------------------------------------------------------------------------------------
+bool FrameTimeline::Init(GfxDevice* pDevice, GfxCommandQueue* pQueue, uint32_t framesInFlight)
+{
+	if (pDevice == nullptr || pQueue == nullptr)
+	{
+		return false;
+	}
+
+	Term();
+
+	// the fence starts at 0, which every slot counts as completed
+	if (!pDevice->CreateFence(0, m_pFence))
+	{
+		return false;
+	}
+
+	m_pQueue = pQueue;
+	m_FramesInFlight = (framesInFlight < 1) ? 1 : (framesInFlight > MaxFramesInFlight) ? MaxFramesInFlight : framesInFlight;
+	m_FrameSlot = 0;
+	m_FrameValue = 1;
+	m_Stats = FrameTimelineStats();
+	for (uint32_t i = 0; i < MaxFramesInFlight; ++i)
+	{
+		m_SlotValues[i] = 0;
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 termination
+//--------------------------------------------------------------------------------------------------------
+void FrameTimeline::Term()
+{
+	if (m_pFence != nullptr)
+	{
+		WaitIdle();
+	}
+
+	m_pFence.reset();
+	m_pQueue = nullptr;
+	m_FramesInFlight = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 wait until the slot of the next frame is free
+//--------------------------------------------------------------------------------------------------------
+uint32_t FrameTimeline::BeginFrame()
+{
+	// the previous frame of the slot has to be done before its resources are reused
+	uint64_t slotValue = m_SlotValues[m_FrameSlot];
+	double stallMs = 0.0;
+	if (m_pFence->GetCompletedValue() < slotValue)
+	{
+		PROFILE_SCOPE("WaitForFrameSlot");
+		auto begin = std::chrono::steady_clock::now();
+		m_pFence->Wait(slotValue);
+		stallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+		m_Stats.StallCount++;
+		m_Stats.StallMs += stallMs;
+		m_Stats.MaxStallMs = (stallMs > m_Stats.MaxStallMs) ? stallMs : m_Stats.MaxStallMs;
+	}
+
+	m_Stats.FrameCount++;
+	m_Stats.LastStallMs = stallMs;
+	return m_FrameSlot;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 signal the end of the current frame
+//--------------------------------------------------------------------------------------------------------
+uint64_t FrameTimeline::EndFrame()
+{
+	uint64_t value = m_FrameValue++;
+	m_pQueue->Signal(m_pFence.get(), value);
+	m_SlotValues[m_FrameSlot] = value;
+	m_FrameSlot = (m_FrameSlot + 1) % m_FramesInFlight;
+	return value;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 wait for every frame ended so far
+//--------------------------------------------------------------------------------------------------------
+void FrameTimeline::WaitIdle()
+{
+	// no value of its own: things retired with the current frame's value must stay alive until it is submitted
+	uint64_t value = m_FrameValue - 1;
+	if (m_pFence->GetCompletedValue() < value)
+	{
+		PROFILE_SCOPE("WaitIdle");
+		m_pFence->Wait(value);
+	}
+	m_Stats.FlushCount++;
+}
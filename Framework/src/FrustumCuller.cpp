@@ -0,0 +1,346 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <FrustumCuller.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// FRUSTUM_CULLER_SSE2=0 forces the scalar path (which produces the same list)
+#if !defined(FRUSTUM_CULLER_SSE2)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRUSTUM_CULLER_SSE2 1
+#else
+#define FRUSTUM_CULLER_SSE2 0
+#endif
+#endif
+
+#if FRUSTUM_CULLER_SSE2
+#include <emmintrin.h>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+#endif
+
+
+namespace /* anonymous */ {
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// PlaneSet structure - planes unpacked for broadcasting
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct PlaneSet
+	{
+		float N[6][4]; // normal and distance
+		float AbsN[6][3]; // absolute normal (box extent projection)
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// unpack planes
+	//----------------------------------------------------------------------------------------------------
+	PlaneSet MakePlaneSet(const Frustum& frustum)
+	{
+		PlaneSet set;
+		for (uint32_t p = 0; p < 6; ++p)
+		{
+			set.N[p][0] = frustum.Planes[p].x;
+			set.N[p][1] = frustum.Planes[p].y;
+			set.N[p][2] = frustum.Planes[p].z;
+			set.N[p][3] = frustum.Planes[p].w;
+			set.AbsN[p][0] = fabsf(frustum.Planes[p].x);
+			set.AbsN[p][1] = fabsf(frustum.Planes[p].y);
+			set.AbsN[p][2] = fabsf(frustum.Planes[p].z);
+		}
+		return set;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// append the set bits of mask as indices (branchless, writes up to width entries)
+	//----------------------------------------------------------------------------------------------------
+	inline uint32_t Emit(uint32_t* pOut, uint32_t n, uint32_t index, uint32_t mask, uint32_t width)
+	{
+		for (uint32_t k = 0; k < width; ++k)
+		{
+			pOut[n] = index + k;
+			n += (mask >> k) & 1;
+		}
+		return n;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// single object tests (same operation order as the SIMD kernels)
+	//----------------------------------------------------------------------------------------------------
+	inline bool IsVisible(const PlaneSet& planes, const SphereBounds& bounds, uint32_t i)
+	{
+		bool visible = true;
+		for (uint32_t p = 0; p < 6; ++p)
+		{
+			float d = planes.N[p][0] * bounds.pCenterX[i] + planes.N[p][1] * bounds.pCenterY[i] + planes.N[p][2] * bounds.pCenterZ[i] + planes.N[p][3];
+			visible &= (d + bounds.pRadius[i] >= 0.f);
+		}
+		return visible;
+	}
+
+	inline bool IsVisible(const PlaneSet& planes, const BoxBounds& bounds, uint32_t i)
+	{
+		bool visible = true;
+		for (uint32_t p = 0; p < 6; ++p)
+		{
+			float d = planes.N[p][0] * bounds.pCenterX[i] + planes.N[p][1] * bounds.pCenterY[i] + planes.N[p][2] * bounds.pCenterZ[i] + planes.N[p][3];
+			float r = planes.AbsN[p][0] * bounds.pExtentX[i] + planes.AbsN[p][1] * bounds.pExtentY[i] + planes.AbsN[p][2] * bounds.pExtentZ[i];
+			visible &= (d + r >= 0.f);
+		}
+		return visible;
+	}
+
+#if FRUSTUM_CULLER_SSE2
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Lanes4 structure - 4 objects per register
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Lanes4
+	{
+		using V = __m128;
+		static const uint32_t Width = 4;
+
+		static V Load(const float* p) { return _mm_loadu_ps(p); }
+		static V Set1(float value) { return _mm_set1_ps(value); }
+		static V Add(V a, V b) { return _mm_add_ps(a, b); }
+		static V Mul(V a, V b) { return _mm_mul_ps(a, b); }
+		static V And(V a, V b) { return _mm_and_ps(a, b); }
+		static V CmpGE(V a, V b) { return _mm_cmpge_ps(a, b); }
+		static uint32_t MoveMask(V v) { return static_cast<uint32_t>(_mm_movemask_ps(v)); }
+	};
+
+#if defined(__AVX__)
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Lanes8 structure - 8 objects per register
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Lanes8
+	{
+		using V = __m256;
+		static const uint32_t Width = 8;
+
+		static V Load(const float* p) { return _mm256_loadu_ps(p); }
+		static V Set1(float value) { return _mm256_set1_ps(value); }
+		static V Add(V a, V b) { return _mm256_add_ps(a, b); }
+		static V Mul(V a, V b) { return _mm256_mul_ps(a, b); }
+		static V And(V a, V b) { return _mm256_and_ps(a, b); }
+		static V CmpGE(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+		static uint32_t MoveMask(V v) { return static_cast<uint32_t>(_mm256_movemask_ps(v)); }
+	};
+
+	using KernelLanes = Lanes8;
+#else
+	using KernelLanes = Lanes4;
+#endif
+
+	//----------------------------------------------------------------------------------------------------
+	// signed distances of L::Width centers to plane p
+	//----------------------------------------------------------------------------------------------------
+	template<typename L>
+	inline typename L::V PlaneDistance(const PlaneSet& planes, uint32_t p, typename L::V cx, typename L::V cy, typename L::V cz)
+	{
+		return L::Add(L::Add(L::Add(
+			L::Mul(L::Set1(planes.N[p][0]), cx),
+			L::Mul(L::Set1(planes.N[p][1]), cy)),
+			L::Mul(L::Set1(planes.N[p][2]), cz)),
+			L::Set1(planes.N[p][3]));
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// visible spheres of [begin, end)
+	//----------------------------------------------------------------------------------------------------
+	template<typename L>
+	uint32_t CullRange(const PlaneSet& planes, const SphereBounds& bounds, uint32_t begin, uint32_t end, uint32_t* pOut)
+	{
+		using V = typename L::V;
+		const V zero = L::Set1(0.f);
+
+		uint32_t n = 0;
+		uint32_t i = begin;
+		for (; i + L::Width <= end; i += L::Width)
+		{
+			V cx = L::Load(bounds.pCenterX + i);
+			V cy = L::Load(bounds.pCenterY + i);
+			V cz = L::Load(bounds.pCenterZ + i);
+			V r = L::Load(bounds.pRadius + i);
+
+			V inside = L::CmpGE(L::Add(PlaneDistance<L>(planes, 0, cx, cy, cz), r), zero);
+			for (uint32_t p = 1; p < 6; ++p)
+			{
+				inside = L::And(inside, L::CmpGE(L::Add(PlaneDistance<L>(planes, p, cx, cy, cz), r), zero));
+			}
+			n = Emit(pOut, n, i, L::MoveMask(inside), L::Width);
+		}
+
+		for (; i < end; ++i)
+		{
+			n = Emit(pOut, n, i, IsVisible(planes, bounds, i) ? 1 : 0, 1);
+		}
+		return n;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// visible boxes of [begin, end)
+	//----------------------------------------------------------------------------------------------------
+	template<typename L>
+	uint32_t CullRange(const PlaneSet& planes, const BoxBounds& bounds, uint32_t begin, uint32_t end, uint32_t* pOut)
+	{
+		using V = typename L::V;
+		const V zero = L::Set1(0.f);
+
+		uint32_t n = 0;
+		uint32_t i = begin;
+		for (; i + L::Width <= end; i += L::Width)
+		{
+			V cx = L::Load(bounds.pCenterX + i);
+			V cy = L::Load(bounds.pCenterY + i);
+			V cz = L::Load(bounds.pCenterZ + i);
+			V ex = L::Load(bounds.pExtentX + i);
+			V ey = L::Load(bounds.pExtentY + i);
+			V ez = L::Load(bounds.pExtentZ + i);
+
+			V inside = L::CmpGE(zero, zero);
+			for (uint32_t p = 0; p < 6; ++p)
+			{
+				V r = L::Add(L::Add(
+					L::Mul(L::Set1(planes.AbsN[p][0]), ex),
+					L::Mul(L::Set1(planes.AbsN[p][1]), ey)),
+					L::Mul(L::Set1(planes.AbsN[p][2]), ez));
+				inside = L::And(inside, L::CmpGE(L::Add(PlaneDistance<L>(planes, p, cx, cy, cz), r), zero));
+			}
+			n = Emit(pOut, n, i, L::MoveMask(inside), L::Width);
+		}
+
+		for (; i < end; ++i)
+		{
+			n = Emit(pOut, n, i, IsVisible(planes, bounds, i) ? 1 : 0, 1);
+		}
+		return n;
+	}
+#endif // FRUSTUM_CULLER_SSE2
+
+	//----------------------------------------------------------------------------------------------------
+	// visible objects of [begin, end) written to pOut
+	//----------------------------------------------------------------------------------------------------
+	template<typename Bounds>
+	uint32_t CullChunk(const PlaneSet& planes, const Bounds& bounds, uint32_t begin, uint32_t end, uint32_t* pOut)
+	{
+#if FRUSTUM_CULLER_SSE2
+		return CullRange<KernelLanes>(planes, bounds, begin, end, pOut);
+#else
+		uint32_t n = 0;
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			n = Emit(pOut, n, i, IsVisible(planes, bounds, i) ? 1 : 0, 1);
+		}
+		return n;
+#endif
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// FrustumCuller class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+FrustumCuller::FrustumCuller()
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 planes of the view-projection matrix
+//--------------------------------------------------------------------------------------------------------
+Frustum FrustumCuller::ExtractFrustum(const DirectX::XMMATRIX& viewProj)
+{
+	// clip = v * M, so each clip coordinate is the dot product with a column
+	DirectX::XMFLOAT4X4 m;
+	DirectX::XMStoreFloat4x4(&m, viewProj);
+
+	auto column = [&m](uint32_t c)
+	{
+		return DirectX::XMFLOAT4(m.m[0][c], m.m[1][c], m.m[2][c], m.m[3][c]);
+	};
+	DirectX::XMFLOAT4 x = column(0);
+	DirectX::XMFLOAT4 y = column(1);
+	DirectX::XMFLOAT4 z = column(2);
+	DirectX::XMFLOAT4 w = column(3);
+
+	Frustum frustum;
+	frustum.Planes[0] = DirectX::XMFLOAT4(w.x + x.x, w.y + x.y, w.z + x.z, w.w + x.w); // -w <= x
+	frustum.Planes[1] = DirectX::XMFLOAT4(w.x - x.x, w.y - x.y, w.z - x.z, w.w - x.w); // x <= w
+	frustum.Planes[2] = DirectX::XMFLOAT4(w.x + y.x, w.y + y.y, w.z + y.z, w.w + y.w); // -w <= y
+	frustum.Planes[3] = DirectX::XMFLOAT4(w.x - y.x, w.y - y.y, w.z - y.z, w.w - y.w); // y <= w
+	frustum.Planes[4] = z; // 0 <= z
+	frustum.Planes[5] = DirectX::XMFLOAT4(w.x - z.x, w.y - z.y, w.z - z.z, w.w - z.w); // z <= w
+
+	// unit normals, so that distances compare with radii
+	for (DirectX::XMFLOAT4& plane : frustum.Planes)
+	{
+		float length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		if (length > 0.f)
+		{
+			plane.x /= length;
+			plane.y /= length;
+			plane.z /= length;
+			plane.w /= length;
+		}
+	}
+	return frustum;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 cull bounding spheres
+//--------------------------------------------------------------------------------------------------------
+uint32_t FrustumCuller::CullSpheres(const Frustum& frustum, const SphereBounds& bounds, uint32_t count, uint32_t* pVisible, WorkerPool* pWorkers)
+{
+	return Cull(frustum, bounds, count, pVisible, pWorkers);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 cull axis aligned bounding boxes
+//--------------------------------------------------------------------------------------------------------
+uint32_t FrustumCuller::CullBoxes(const Frustum& frustum, const BoxBounds& bounds, uint32_t count, uint32_t* pVisible, WorkerPool* pWorkers)
+{
+	return Cull(frustum, bounds, count, pVisible, pWorkers);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 cull in chunks and compact the visible lists
+//--------------------------------------------------------------------------------------------------------
+template<typename Bounds>
+uint32_t FrustumCuller::Cull(const Frustum& frustum, const Bounds& bounds, uint32_t count, uint32_t* pVisible, WorkerPool* pWorkers)
+{
+	PlaneSet planes = MakePlaneSet(frustum);
+
+	uint32_t chunkCount = (count + ChunkSize - 1) / ChunkSize;
+	if (pWorkers == nullptr || chunkCount <= 1)
+	{
+		return CullChunk(planes, bounds, 0, count, pVisible);
+	}
+
+	// chunk c writes from pVisible[c * ChunkSize]
+	m_ChunkVisible.resize(chunkCount);
+	pWorkers->Dispatch(chunkCount, [&](uint32_t chunk, uint32_t /* workerIndex */)
+	{
+		uint32_t begin = chunk * ChunkSize;
+		uint32_t end = std::min(begin + ChunkSize, count);
+		m_ChunkVisible[chunk] = CullChunk(planes, bounds, begin, end, pVisible + begin);
+	});
+
+	// close the gaps, chunks only move toward the front
+	uint32_t visibleCount = m_ChunkVisible[0];
+	for (uint32_t chunk = 1; chunk < chunkCount; ++chunk)
+	{
+		if (m_ChunkVisible[chunk] > 0 && visibleCount != chunk * ChunkSize)
+		{
+			memmove(pVisible + visibleCount, pVisible + chunk * ChunkSize, m_ChunkVisible[chunk] * sizeof(uint32_t));
+		}
+		visibleCount += m_ChunkVisible[chunk];
+	}
+	return visibleCount;
+}
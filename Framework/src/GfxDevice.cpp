@@ -0,0 +1,43 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GfxDevice.h>
+#include <RecordingDevice.h>
+
+
+//--------------------------------------------------------------------------------------------------------
+// Backend factories
+//--------------------------------------------------------------------------------------------------------
+bool CreateD3D12GfxDevice(GfxPtr<GfxDevice>& pDevice);
+
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate device of the backend
+//--------------------------------------------------------------------------------------------------------
+bool CreateGfxDevice(GfxBackend backend, GfxPtr<GfxDevice>& pDevice)
+{
+	switch (backend)
+	{
+	case GfxBackend::D3D12:
+		return CreateD3D12GfxDevice(pDevice);
+
+	case GfxBackend::Recording:
+		pDevice.reset(new RecordingDevice());
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 default backend of the platform
+//--------------------------------------------------------------------------------------------------------
+GfxBackend GetDefaultGfxBackend()
+{
+#if defined(_WIN32)
+	return GfxBackend::D3D12;
+#else
+	return GfxBackend::Recording;
+#endif
+}
@@ -0,0 +1,236 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GpuMemoryAllocator.h>
+#include <algorithm>
+#include <cassert>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// round up to a power of two alignment
+	//----------------------------------------------------------------------------------------------------
+	inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// state buffers of a heap type are created in (and that upload and readback buffers have to stay in)
+	//----------------------------------------------------------------------------------------------------
+	GfxResourceState InitialState(GfxHeapType heapType)
+	{
+		switch (heapType)
+		{
+		case GfxHeapType::Upload: return GfxResourceState::GenericRead;
+		case GfxHeapType::Readback: return GfxResourceState::CopyDest;
+		default: return GfxResourceState::Common;
+		}
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GpuMemoryAllocator class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+GpuMemoryAllocator::GpuMemoryAllocator()
+	: m_pDevice(nullptr)
+	, m_HeapSize(0)
+	, m_HeapCreations(0)
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+GpuMemoryAllocator::~GpuMemoryAllocator()
+{
+	Term();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 initialization
+//--------------------------------------------------------------------------------------------------------
+bool GpuMemoryAllocator::Init(GfxDevice* pDevice, uint64_t heapSize)
+{
+	if (pDevice == nullptr || heapSize == 0)
+	{
+		return false;
+	}
+
+	Term();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_pDevice = pDevice;
+	m_HeapSize = AlignUp(heapSize, GfxPlacementAlignment);
+	m_HeapCreations = 0;
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 termination
+//--------------------------------------------------------------------------------------------------------
+void GpuMemoryAllocator::Term()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	for (uint32_t i = 0; i < m_Blocks.size(); ++i)
+	{
+		DestroyBlock(i);
+	}
+	m_Blocks.clear();
+	m_pDevice = nullptr;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 sub-allocation, a new heap when none of the type has room
+//--------------------------------------------------------------------------------------------------------
+bool GpuMemoryAllocator::Allocate(GfxHeapType heapType, uint64_t size, uint64_t alignment, GpuAllocation& allocation)
+{
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && alignment <= GfxPlacementAlignment);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_pDevice == nullptr || size == 0)
+	{
+		return false;
+	}
+
+	// shared heaps of the type in creation order, so that the first ones fill up and the last ones empty
+	uint32_t index = InvalidBlock;
+	TlsfAllocation range = {};
+	for (uint32_t i = 0; i < m_Blocks.size() && index == InvalidBlock; ++i)
+	{
+		Block& block = m_Blocks[i];
+		if (block.pHeap != nullptr && !block.Dedicated && block.HeapType == heapType && block.Ranges.Allocate(size, alignment, range))
+		{
+			index = i;
+		}
+	}
+
+	if (index == InvalidBlock)
+	{
+		bool dedicated = (size > m_HeapSize);
+		index = CreateBlock(heapType, dedicated ? AlignUp(size, GfxPlacementAlignment) : m_HeapSize, dedicated);
+		if (index == InvalidBlock || !m_Blocks[index].Ranges.Allocate(size, alignment, range))
+		{
+			return false;
+		}
+	}
+
+	const Block& block = m_Blocks[index];
+	allocation.pResource = block.pBuffer.get();
+	allocation.pCPU = (block.pCPU != nullptr) ? block.pCPU + range.Offset : nullptr;
+	allocation.GPU = block.pBuffer->GetGPUVirtualAddress() + range.Offset;
+	allocation.Offset = range.Offset;
+	allocation.Size = size;
+	allocation.Block = index;
+	allocation.Range = range;
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 release of a range, dedicated heaps go with their allocation
+//--------------------------------------------------------------------------------------------------------
+void GpuMemoryAllocator::Free(GpuAllocation& allocation)
+{
+	if (allocation.Block == InvalidBlock)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	assert(allocation.Block < m_Blocks.size() && m_Blocks[allocation.Block].pHeap != nullptr);
+	Block& block = m_Blocks[allocation.Block];
+	block.Ranges.Free(allocation.Range);
+	if (block.Dedicated)
+	{
+		DestroyBlock(allocation.Block);
+	}
+
+	allocation = GpuAllocation();
+	allocation.Block = InvalidBlock;
+	allocation.Range.Node = TlsfAllocator::InvalidNode;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 totals over the heaps
+//--------------------------------------------------------------------------------------------------------
+GpuMemoryStats GpuMemoryAllocator::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	GpuMemoryStats stats = {};
+	stats.HeapCreations = m_HeapCreations;
+	for (const Block& block : m_Blocks)
+	{
+		if (block.pHeap == nullptr)
+		{
+			continue;
+		}
+
+		TlsfStats ranges = block.Ranges.GetStats();
+		stats.HeapCount++;
+		stats.ReservedBytes += ranges.Capacity;
+		stats.UsedBytes += ranges.UsedSize;
+		stats.LargestFreeBlock = std::max(stats.LargestFreeBlock, ranges.LargestFreeBlock);
+		stats.AllocationCount += ranges.AllocationCount;
+		stats.FreeBlockCount += ranges.FreeBlockCount;
+	}
+	return stats;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 heap with a buffer over all of it (the caller holds the mutex)
+//--------------------------------------------------------------------------------------------------------
+uint32_t GpuMemoryAllocator::CreateBlock(GfxHeapType heapType, uint64_t size, bool dedicated)
+{
+	Block block;
+	GfxHeapDesc heapDesc = { size, heapType };
+	GfxBufferDesc bufferDesc = { size, heapType, InitialState(heapType) };
+	if (!m_pDevice->CreateHeap(heapDesc, block.pHeap) || !m_pDevice->CreatePlacedBuffer(block.pHeap.get(), 0, bufferDesc, block.pBuffer))
+	{
+		return InvalidBlock;
+	}
+
+	// upload and readback heaps stay mapped for their whole life
+	void* pCPU = nullptr;
+	block.pCPU = (heapType != GfxHeapType::Default && block.pBuffer->Map(&pCPU)) ? static_cast<uint8_t*>(pCPU) : nullptr;
+	block.HeapType = heapType;
+	block.Dedicated = dedicated;
+	block.Ranges.Reset(size, Granularity);
+	m_HeapCreations++;
+
+	for (uint32_t i = 0; i < m_Blocks.size(); ++i)
+	{
+		if (m_Blocks[i].pHeap == nullptr)
+		{
+			m_Blocks[i] = std::move(block);
+			return i;
+		}
+	}
+
+	m_Blocks.push_back(std::move(block));
+	return static_cast<uint32_t>(m_Blocks.size() - 1);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 release a heap, its entry is reused (the caller holds the mutex)
+//--------------------------------------------------------------------------------------------------------
+void GpuMemoryAllocator::DestroyBlock(uint32_t index)
+{
+	// the placed buffer goes before its heap
+	Block& block = m_Blocks[index];
+	if (block.pCPU != nullptr)
+	{
+		block.pBuffer->Unmap();
+		block.pCPU = nullptr;
+	}
+	block.pBuffer.reset();
+	block.pHeap.reset();
+	block.Ranges.Reset(0);
+}
@@ -0,0 +1,241 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <GpuProfiler.h>
+#include <Profiler.h>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GpuProfiler class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+GpuProfiler::GpuProfiler()
+	: m_pQueue(nullptr)
+	, m_pQueryHeap(nullptr)
+	, m_pReadback(nullptr)
+	, m_pTimestamps(nullptr)
+	, m_FramesInFlight(0)
+	, m_MaxRegions(0)
+	, m_FrameSlot(0)
+	, m_RegionCount(0)
+	, m_FrameResolved(false)
+	, m_TickNs(0.0)
+	, m_CalibrationGpu(0)
+	, m_CalibrationCpu(0)
+	, m_CalibrationFrames(0)
+	, m_Stats()
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+GpuProfiler::~GpuProfiler()
+{
+	Term();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 initialization
+//--------------------------------------------------------------------------------------------------------
+bool GpuProfiler::Init(GfxDevice* pDevice, GfxCommandQueue* pQueue, uint32_t framesInFlight, uint32_t maxRegionsPerFrame)
+{
+	if (pDevice == nullptr || pQueue == nullptr || framesInFlight == 0 || maxRegionsPerFrame == 0)
+	{
+		return false;
+	}
+
+	Term();
+
+	uint64_t frequency = pQueue->GetTimestampFrequency();
+	if (frequency == 0)
+	{
+		return false;
+	}
+
+	uint32_t queryCount = framesInFlight * maxRegionsPerFrame * 2;
+	GfxBufferDesc desc = { uint64_t(queryCount) * sizeof(uint64_t), GfxHeapType::Readback, GfxResourceState::CopyDest };
+	void* pData = nullptr;
+	if (!pDevice->CreateTimestampQueryHeap(queryCount, m_pQueryHeap)
+		|| !pDevice->CreateBuffer(desc, m_pReadback)
+		|| !m_pReadback->Map(&pData))
+	{
+		m_pQueryHeap.reset();
+		m_pReadback.reset();
+		return false;
+	}
+
+	m_pQueue = pQueue;
+	m_pTimestamps = static_cast<const uint64_t*>(pData);
+	m_FramesInFlight = framesInFlight;
+	m_MaxRegions = maxRegionsPerFrame;
+	m_FrameSlot = 0;
+	m_RegionCount.store(0, std::memory_order_relaxed);
+	m_FrameResolved = false;
+	m_Names.assign(size_t(framesInFlight) * maxRegionsPerFrame, nullptr);
+	m_Depths.assign(size_t(framesInFlight) * maxRegionsPerFrame, 0);
+	m_ResolvedCounts.assign(framesInFlight, 0);
+	m_TickNs = 1000000000.0 / double(frequency);
+	m_Stats = GpuProfilerStats();
+	Calibrate();
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 termination
+//--------------------------------------------------------------------------------------------------------
+void GpuProfiler::Term()
+{
+	if (m_pReadback != nullptr)
+	{
+		m_pReadback->Unmap();
+	}
+
+	m_pReadback.reset();
+	m_pQueryHeap.reset();
+	m_pTimestamps = nullptr;
+	m_pQueue = nullptr;
+	m_Names.clear();
+	m_Depths.clear();
+	m_ResolvedCounts.clear();
+	m_FramesInFlight = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 read back the slot's previous frame and start a new one
+//--------------------------------------------------------------------------------------------------------
+void GpuProfiler::BeginFrame(uint32_t slot)
+{
+	if (!IsValid())
+	{
+		return;
+	}
+
+	// recording of the previous frame is over, every region it opened has been resolved
+	if (m_FrameResolved)
+	{
+		uint32_t count = m_RegionCount.load(std::memory_order_relaxed);
+		if (count > m_MaxRegions)
+		{
+			m_Stats.DroppedCount += count - m_MaxRegions;
+			count = m_MaxRegions;
+		}
+		m_ResolvedCounts[m_FrameSlot] = count;
+	}
+
+	// calibrations are rare, the clocks drift apart only slowly
+	if (++m_CalibrationFrames >= CalibrationInterval)
+	{
+		Calibrate();
+	}
+
+	uint32_t base = slot * m_MaxRegions;
+	uint32_t count = m_ResolvedCounts[slot];
+	if (count > 0)
+	{
+		const uint64_t* pTimestamps = m_pTimestamps + size_t(base) * 2;
+		bool record = Profiler::IsEnabled();
+		uint64_t frameBegin = UINT64_MAX;
+		uint64_t frameEnd = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint64_t begin = ToCpuTime(pTimestamps[i * 2 + 0]);
+			uint64_t end = ToCpuTime(pTimestamps[i * 2 + 1]);
+			frameBegin = (begin < frameBegin) ? begin : frameBegin;
+			frameEnd = (end > frameEnd) ? end : frameEnd;
+			if (record)
+			{
+				Profiler::AddGpuEvent(m_Names[base + i], begin, end, m_Depths[base + i]);
+			}
+		}
+
+		m_Stats.FrameCount++;
+		m_Stats.RegionCount += count;
+		m_Stats.LastFrameMs = (frameEnd > frameBegin) ? double(frameEnd - frameBegin) / 1000000.0 : 0.0;
+		m_ResolvedCounts[slot] = 0;
+	}
+
+	m_FrameSlot = slot;
+	m_RegionCount.store(0, std::memory_order_relaxed);
+	m_FrameResolved = false;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 open a region
+//--------------------------------------------------------------------------------------------------------
+uint32_t GpuProfiler::BeginRegion(GfxCommandList* pCmdList, const char* name, uint32_t depth)
+{
+	if (!IsValid())
+	{
+		return InvalidRegion;
+	}
+
+	uint32_t region = m_RegionCount.fetch_add(1, std::memory_order_relaxed);
+	if (region >= m_MaxRegions)
+	{
+		return InvalidRegion;
+	}
+
+	uint32_t index = m_FrameSlot * m_MaxRegions + region;
+	m_Names[index] = name;
+	m_Depths[index] = depth;
+	pCmdList->EndQuery(m_pQueryHeap.get(), index * 2 + 0);
+	return region;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 close a region
+//--------------------------------------------------------------------------------------------------------
+void GpuProfiler::EndRegion(GfxCommandList* pCmdList, uint32_t region)
+{
+	if (region == InvalidRegion || !IsValid())
+	{
+		return;
+	}
+
+	uint32_t index = m_FrameSlot * m_MaxRegions + region;
+	pCmdList->EndQuery(m_pQueryHeap.get(), index * 2 + 1);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 resolve the frame's timestamps (queries of regions which were never opened are read back unused)
+//--------------------------------------------------------------------------------------------------------
+void GpuProfiler::EndFrame(GfxCommandList* pCmdList)
+{
+	if (!IsValid())
+	{
+		return;
+	}
+
+	uint32_t first = m_FrameSlot * m_MaxRegions * 2;
+	pCmdList->ResolveQueryData(m_pQueryHeap.get(), first, m_MaxRegions * 2, m_pReadback.get(), uint64_t(first) * sizeof(uint64_t));
+	m_FrameResolved = true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 sample both clocks
+//--------------------------------------------------------------------------------------------------------
+void GpuProfiler::Calibrate()
+{
+	uint64_t gpuTimestamp = 0;
+	uint64_t cpuNanoseconds = 0;
+	if (m_pQueue->GetClockCalibration(gpuTimestamp, cpuNanoseconds))
+	{
+		m_CalibrationGpu = gpuTimestamp;
+		m_CalibrationCpu = cpuNanoseconds;
+	}
+	m_CalibrationFrames = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 GPU timestamp in steady_clock nanoseconds
+//--------------------------------------------------------------------------------------------------------
+uint64_t GpuProfiler::ToCpuTime(uint64_t timestamp) const
+{
+	double delta = double(int64_t(timestamp - m_CalibrationGpu)) * m_TickNs;
+	return uint64_t(int64_t(m_CalibrationCpu) + int64_t(delta));
+}
@@ -0,0 +1,130 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <LinearRing.h>
+#include <cassert>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// round up to a power of two alignment
+	//----------------------------------------------------------------------------------------------------
+	inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// LinearRing class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+LinearRing::LinearRing()
+	: m_Stats()
+{
+	Reset(0);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 reset to an empty ring of the capacity
+//--------------------------------------------------------------------------------------------------------
+void LinearRing::Reset(uint64_t capacity)
+{
+	m_Capacity = capacity;
+	m_Head = 0;
+	m_Tail = 0;
+	m_FrameStart = 0;
+	m_PendingFirst = 0;
+	m_PendingCount = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 allocation
+//--------------------------------------------------------------------------------------------------------
+bool LinearRing::Allocate(uint64_t size, uint64_t alignment, uint64_t& offset)
+{
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	if (size == 0 || size > m_Capacity)
+	{
+		m_Stats.FailedAllocations++;
+		return false;
+	}
+
+	// place after the head, or wrap to the start when it doesn't fit before the end
+	uint64_t position = m_Head % m_Capacity;
+	uint64_t start = AlignUp(position, alignment);
+	if (start + size > m_Capacity)
+	{
+		start = 0;
+	}
+
+	uint64_t consumed = ((start >= position) ? start - position : m_Capacity - position) + size;
+	if (GetUsed() + consumed > m_Capacity)
+	{
+		m_Stats.FailedAllocations++;
+		return false;
+	}
+
+	m_Head += consumed;
+	offset = start;
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 recycle completed frames
+//--------------------------------------------------------------------------------------------------------
+void LinearRing::Retire(uint64_t completedValue)
+{
+	while (m_PendingCount > 0 && m_Pending[m_PendingFirst].FenceValue <= completedValue)
+	{
+		m_Tail = m_Pending[m_PendingFirst].End;
+		m_PendingFirst = (m_PendingFirst + 1) % MaxPendingFrames;
+		m_PendingCount--;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 close the current frame
+//--------------------------------------------------------------------------------------------------------
+void LinearRing::EndFrame(uint64_t fenceValue)
+{
+	uint64_t frameUnits = m_Head - m_FrameStart;
+
+	// update statistics
+	m_Stats.FrameCount++;
+	m_Stats.TotalUnits += frameUnits;
+	m_Stats.LastFrameUnits = frameUnits;
+	if (frameUnits > m_Stats.PeakFrameUnits)
+	{
+		m_Stats.PeakFrameUnits = frameUnits;
+	}
+
+	m_FrameStart = m_Head;
+
+	// nothing to recycle later
+	if (frameUnits == 0)
+	{
+		return;
+	}
+
+	if (m_PendingCount == MaxPendingFrames)
+	{
+		// out of slots, merge into the newest frame so the region is held until the later fence
+		PendingFrame& newest = m_Pending[(m_PendingFirst + m_PendingCount - 1) % MaxPendingFrames];
+		newest.FenceValue = fenceValue;
+		newest.End = m_Head;
+		return;
+	}
+
+	PendingFrame& frame = m_Pending[(m_PendingFirst + m_PendingCount) % MaxPendingFrames];
+	frame.FenceValue = fenceValue;
+	frame.End = m_Head;
+	m_PendingCount++;
+}
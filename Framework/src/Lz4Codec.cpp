@@ -0,0 +1,308 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <Lz4Codec.h>
+#include <algorithm>
+#include <cstring>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t MinMatch = 4; // shortest match of the format (a match length of 0 in the token)
+	const uint32_t LastLiterals = 5; // the block always ends with this many literals
+	const uint32_t MatchStartMargin = 12; // the last match starts at least this far before the end
+	const uint32_t SkipShift = 6; // the step grows by one every 64 bytes without a match
+	const uint32_t EmptyPosition = UINT32_MAX; // hash table entry without a position
+	const uint32_t LengthMask = 15; // length nibble which continues in the following bytes
+	const size_t WildCopyStep = 8; // bytes per step of the copies of the decompressor
+	const size_t ShortcutLiterals = 16; // fixed literal copy of short sequences (more than a nibble holds)
+	const size_t ShortcutInput = ShortcutLiterals + 2; // input left for the literal copy and the offset
+	const size_t ShortcutOutput = LengthMask - 1 + 3 * WildCopyStep; // output left for the literals and 3 steps of match
+
+	//----------------------------------------------------------------------------------------------------
+	// unaligned 4 byte load
+	//----------------------------------------------------------------------------------------------------
+	uint32_t Read32(const uint8_t* p)
+	{
+		uint32_t value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// length beyond the nibble as a run of 255 and a final byte below it
+	//----------------------------------------------------------------------------------------------------
+	void WriteLength(uint8_t*& pOut, size_t length)
+	{
+		for (; length >= 255; length -= 255)
+		{
+			*pOut++ = 255;
+		}
+		*pOut++ = static_cast<uint8_t>(length);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// token, literals and match (matchLength 0 writes the literals closing the block), false when it doesn't fit
+	//----------------------------------------------------------------------------------------------------
+	bool WriteSequence(uint8_t*& pOut, const uint8_t* pOutEnd, const uint8_t* pLiterals, size_t literalCount, size_t offset, size_t matchLength)
+	{
+		size_t needed = 1 + literalCount / 255 + 1 + literalCount + ((matchLength > 0) ? 2 + (matchLength - MinMatch) / 255 + 1 : 0);
+		if (static_cast<size_t>(pOutEnd - pOut) < needed)
+		{
+			return false;
+		}
+
+		uint8_t* pToken = pOut++;
+		uint8_t token = static_cast<uint8_t>(std::min<size_t>(literalCount, LengthMask) << 4);
+		if (literalCount >= LengthMask)
+		{
+			WriteLength(pOut, literalCount - LengthMask);
+		}
+		if (literalCount > 0)
+		{
+			memcpy(pOut, pLiterals, literalCount);
+			pOut += literalCount;
+		}
+
+		if (matchLength > 0)
+		{
+			*pOut++ = static_cast<uint8_t>(offset);
+			*pOut++ = static_cast<uint8_t>(offset >> 8);
+
+			size_t length = matchLength - MinMatch;
+			token |= static_cast<uint8_t>(std::min<size_t>(length, LengthMask));
+			if (length >= LengthMask)
+			{
+				WriteLength(pOut, length - LengthMask);
+			}
+		}
+
+		*pToken = token;
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// copy in steps of 8 bytes, rounded up past the count while both buffers have room for it (sequences are
+	// mostly short, fixed size copies beat one of the exact size), a source behind the destination must stay
+	// at least 8 bytes behind it
+	//----------------------------------------------------------------------------------------------------
+	void WildCopy(uint8_t* pDest, const uint8_t* pSource, size_t count, const uint8_t* pDestEnd, const uint8_t* pSourceEnd)
+	{
+		size_t rounded = (count + WildCopyStep - 1) & ~(WildCopyStep - 1);
+		size_t steps = (rounded <= static_cast<size_t>(pDestEnd - pDest) && rounded <= static_cast<size_t>(pSourceEnd - pSource)) ? rounded : count & ~(WildCopyStep - 1);
+
+		size_t i = 0;
+		for (; i < steps; i += WildCopyStep)
+		{
+			memcpy(pDest + i, pSource + i, WildCopyStep);
+		}
+		for (; i < count; ++i)
+		{
+			pDest[i] = pSource[i];
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// length beyond the nibble, false when the block ends in the middle of it
+	//----------------------------------------------------------------------------------------------------
+	bool ReadLength(const uint8_t*& pIn, const uint8_t* pInEnd, size_t& length)
+	{
+		uint8_t byte;
+		do
+		{
+			if (pIn == pInEnd)
+			{
+				return false;
+			}
+			byte = *pIn++;
+			length += byte;
+		} while (byte == 255);
+		return true;
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lz4Codec class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+Lz4Codec::Lz4Codec()
+	: m_HashTable(size_t(1) << HashBits)
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 compress a block
+//--------------------------------------------------------------------------------------------------------
+size_t Lz4Codec::Compress(const void* pSource, size_t size, void* pDest, size_t capacity)
+{
+	// positions are kept in 32 bits
+	if (size > UINT32_MAX)
+	{
+		return 0;
+	}
+
+	const uint8_t* pBegin = static_cast<const uint8_t*>(pSource);
+	const uint8_t* pEnd = pBegin + size;
+	const uint8_t* pAnchor = pBegin;
+	uint8_t* pOut = static_cast<uint8_t*>(pDest);
+	const uint8_t* pOutEnd = pOut + capacity;
+
+	// shorter blocks are literals only
+	if (size >= MatchStartMargin + 1)
+	{
+		std::fill(m_HashTable.begin(), m_HashTable.end(), EmptyPosition);
+
+		const uint8_t* pMatchLimit = pEnd - LastLiterals;
+		const uint8_t* pStartLimit = pEnd - MatchStartMargin;
+		const uint8_t* p = pBegin;
+		while (p <= pStartLimit)
+		{
+			// Knuth's multiplicative hash of the next 4 bytes
+			uint32_t sequence = Read32(p);
+			uint32_t& entry = m_HashTable[(sequence * 2654435761u) >> (32 - HashBits)];
+			uint32_t candidate = entry;
+			uint32_t position = static_cast<uint32_t>(p - pBegin);
+			entry = position;
+			if (candidate == EmptyPosition || position - candidate > MaxDistance || Read32(pBegin + candidate) != sequence)
+			{
+				p += 1 + ((p - pAnchor) >> SkipShift);
+				continue;
+			}
+
+			// grow the match backwards into the pending literals, then forwards up to the closing literals
+			const uint8_t* pMatch = pBegin + candidate;
+			while (p > pAnchor && pMatch > pBegin && p[-1] == pMatch[-1])
+			{
+				--p;
+				--pMatch;
+			}
+
+			size_t length = MinMatch;
+			while (p + length < pMatchLimit && p[length] == pMatch[length])
+			{
+				++length;
+			}
+
+			if (!WriteSequence(pOut, pOutEnd, pAnchor, static_cast<size_t>(p - pAnchor), static_cast<size_t>(p - pMatch), length))
+			{
+				return 0;
+			}
+			p += length;
+			pAnchor = p;
+		}
+	}
+
+	if (!WriteSequence(pOut, pOutEnd, pAnchor, static_cast<size_t>(pEnd - pAnchor), 0, 0))
+	{
+		return 0;
+	}
+	return static_cast<size_t>(pOut - static_cast<uint8_t*>(pDest));
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 decompress a block
+//--------------------------------------------------------------------------------------------------------
+bool Lz4Codec::Decompress(const void* pSource, size_t sourceSize, void* pDest, size_t size)
+{
+	const uint8_t* pIn = static_cast<const uint8_t*>(pSource);
+	const uint8_t* pInEnd = pIn + sourceSize;
+	uint8_t* pBegin = static_cast<uint8_t*>(pDest);
+	uint8_t* pOut = pBegin;
+	uint8_t* pOutEnd = pBegin + size;
+
+	for (;;)
+	{
+		if (pIn == pInEnd)
+		{
+			return false;
+		}
+		uint8_t token = *pIn++;
+		size_t literalCount = token >> 4;
+		size_t length = token & LengthMask;
+		size_t offset = 0;
+
+		// short sequences away from both ends (most of them) take fixed size copies, the input holds at least
+		// 4 more bytes after the literals, so this is never the last sequence
+		if (literalCount < LengthMask && length < LengthMask
+			&& static_cast<size_t>(pInEnd - pIn) >= ShortcutInput && static_cast<size_t>(pOutEnd - pOut) >= ShortcutOutput)
+		{
+			memcpy(pOut, pIn, ShortcutLiterals);
+			pIn += literalCount;
+			pOut += literalCount;
+
+			offset = size_t(pIn[0]) | (size_t(pIn[1]) << 8);
+			pIn += 2;
+			length += MinMatch;
+			if (offset >= WildCopyStep && offset <= static_cast<size_t>(pOut - pBegin))
+			{
+				const uint8_t* pMatch = pOut - offset;
+				memcpy(pOut, pMatch, WildCopyStep);
+				memcpy(pOut + WildCopyStep, pMatch + WildCopyStep, WildCopyStep);
+				memcpy(pOut + 2 * WildCopyStep, pMatch + 2 * WildCopyStep, WildCopyStep);
+				pOut += length;
+				continue;
+			}
+		}
+		else
+		{
+			if (literalCount == LengthMask && !ReadLength(pIn, pInEnd, literalCount))
+			{
+				return false;
+			}
+			if (literalCount > static_cast<size_t>(pInEnd - pIn) || literalCount > static_cast<size_t>(pOutEnd - pOut))
+			{
+				return false;
+			}
+			WildCopy(pOut, pIn, literalCount, pOutEnd, pInEnd);
+			pIn += literalCount;
+			pOut += literalCount;
+
+			// the last sequence has no match
+			if (pIn == pInEnd)
+			{
+				return pOut == pOutEnd;
+			}
+
+			if (pInEnd - pIn < 2)
+			{
+				return false;
+			}
+			offset = size_t(pIn[0]) | (size_t(pIn[1]) << 8);
+			pIn += 2;
+
+			if (length == LengthMask && !ReadLength(pIn, pInEnd, length))
+			{
+				return false;
+			}
+			length += MinMatch;
+		}
+
+		if (offset == 0 || offset > static_cast<size_t>(pOut - pBegin) || length > static_cast<size_t>(pOutEnd - pOut))
+		{
+			return false;
+		}
+
+		// 8 bytes per step while the source stays 8 bytes behind, repeating patterns of shorter periods byte by byte
+		const uint8_t* pMatch = pOut - offset;
+		if (offset >= WildCopyStep)
+		{
+			WildCopy(pOut, pMatch, length, pOutEnd, pOutEnd);
+			pOut += length;
+			continue;
+		}
+
+		for (uint8_t* pMatchEnd = pOut + length; pOut < pMatchEnd;)
+		{
+			*pOut++ = *pMatch++;
+		}
+	}
+}
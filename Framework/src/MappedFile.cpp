@@ -0,0 +1,144 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <MappedFile.h>
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MappedFile class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+MappedFile::MappedFile()
+	: m_pData(nullptr)
+	, m_Size(0)
+#if defined(_WIN32)
+	, m_hFile(INVALID_HANDLE_VALUE)
+	, m_hMapping(nullptr)
+#endif
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 map a file
+//--------------------------------------------------------------------------------------------------------
+bool MappedFile::Open(const char* path, bool sequential)
+{
+	Close();
+
+#if defined(_WIN32)
+	DWORD flags = sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+	HANDLE hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(hFile, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (hMapping == nullptr)
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	void* pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (pView == nullptr)
+	{
+		CloseHandle(hMapping);
+		CloseHandle(hFile);
+		return false;
+	}
+
+	m_hFile = hFile;
+	m_hMapping = hMapping;
+	m_pData = static_cast<const uint8_t*>(pView);
+	m_Size = static_cast<uint64_t>(size.QuadPart);
+#else
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat info = {};
+	if (fstat(fd, &info) != 0 || info.st_size <= 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	// the mapping keeps its own reference to the file
+	void* pView = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (pView == MAP_FAILED)
+	{
+		return false;
+	}
+
+	posix_madvise(pView, static_cast<size_t>(info.st_size), sequential ? POSIX_MADV_SEQUENTIAL : POSIX_MADV_RANDOM);
+
+	m_pData = static_cast<const uint8_t*>(pView);
+	m_Size = static_cast<uint64_t>(info.st_size);
+#endif
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 unmap
+//--------------------------------------------------------------------------------------------------------
+void MappedFile::Close()
+{
+#if defined(_WIN32)
+	if (m_pData != nullptr)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+
+	if (m_hMapping != nullptr)
+	{
+		CloseHandle(m_hMapping);
+		m_hMapping = nullptr;
+	}
+
+	if (m_hFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_hFile);
+		m_hFile = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (m_pData != nullptr)
+	{
+		munmap(const_cast<uint8_t*>(m_pData), static_cast<size_t>(m_Size));
+	}
+#endif
+
+	m_pData = nullptr;
+	m_Size = 0;
+}
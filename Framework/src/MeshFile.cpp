@@ -0,0 +1,252 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <MeshFile.h>
+#include <ShaderTypes.h>
+#include <cstring>
+#include <fstream>
+
+
+namespace /* anonymous */ {
+
+	// the header is read in place from the mapping, its layout must not depend on the compiler
+	static_assert(sizeof(MeshFileHeader) == 192, "MeshFileHeader layout changed, bump MeshFileVersion");
+	static_assert(sizeof(MeshFileSubmesh) == 40, "MeshFileSubmesh layout changed, bump MeshFileVersion");
+
+	//----------------------------------------------------------------------------------------------------
+	// offset rounded up to the placement of streams and tables
+	//----------------------------------------------------------------------------------------------------
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return (offset + MeshFileAlignment - 1) & ~(MeshFileAlignment - 1);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// range lies inside the file and is placed at MeshFileAlignment
+	//----------------------------------------------------------------------------------------------------
+	bool IsValidRange(uint64_t offset, uint64_t size, uint64_t fileSize)
+	{
+		return (offset % MeshFileAlignment) == 0 && offset <= fileSize && size <= fileSize - offset;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// zeros up to the next placement boundary
+	//----------------------------------------------------------------------------------------------------
+	void WritePadding(std::ofstream& file, uint64_t& offset)
+	{
+		static const char Zeros[MeshFileAlignment] = {};
+		uint64_t aligned = AlignOffset(offset);
+		file.write(Zeros, static_cast<std::streamsize>(aligned - offset));
+		offset = aligned;
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MeshFile class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+MeshFile::MeshFile()
+	: m_pHeader(nullptr)
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 map and validate a mesh file
+//--------------------------------------------------------------------------------------------------------
+bool MeshFile::Open(const char* path, bool sequential)
+{
+	Close();
+
+	if (!m_File.Open(path, sequential))
+	{
+		return false;
+	}
+
+	if (!IsValid(m_File.GetData(), m_File.GetSize()))
+	{
+		m_File.Close();
+		return false;
+	}
+
+	m_pHeader = reinterpret_cast<const MeshFileHeader*>(m_File.GetData());
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 unmap
+//--------------------------------------------------------------------------------------------------------
+void MeshFile::Close()
+{
+	m_pHeader = nullptr;
+	m_File.Close();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 bytes per index
+//--------------------------------------------------------------------------------------------------------
+uint32_t MeshFile::GetIndexSize(GfxFormat format)
+{
+	switch (format)
+	{
+	case GfxFormat::R16_Uint:
+		return 2;
+
+	case GfxFormat::R32_Uint:
+		return 4;
+
+	default:
+		return 0;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 bytes per vertex
+//--------------------------------------------------------------------------------------------------------
+uint32_t MeshFile::GetVertexSize(MeshVertexLayout layout)
+{
+	switch (layout)
+	{
+	case MeshVertexLayout::PositionColor:
+		return sizeof(Vertex);
+
+	case MeshVertexLayout::PackedPositionColor:
+		return sizeof(PackedVertex);
+
+	default:
+		return 0;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 write a mesh file (offline tools, not meant for the frame loop)
+//--------------------------------------------------------------------------------------------------------
+bool MeshFile::Write(const char* path, const MeshFileDesc& desc)
+{
+	uint32_t indexSize = GetIndexSize(desc.IndexFormat);
+	if (indexSize == 0 || desc.StreamCount == 0 || desc.StreamCount > MeshFileMaxStreams)
+	{
+		return false;
+	}
+
+	MeshFileHeader header = {};
+	header.Magic = MeshFileMagic;
+	header.Version = MeshFileVersion;
+	header.VertexCount = desc.VertexCount;
+	header.IndexCount = desc.IndexCount;
+	header.IndexFormat = desc.IndexFormat;
+	header.StreamCount = desc.StreamCount;
+	header.SubmeshCount = desc.SubmeshCount;
+	memcpy(header.BoundsMin, desc.BoundsMin, sizeof(header.BoundsMin));
+	memcpy(header.BoundsMax, desc.BoundsMax, sizeof(header.BoundsMax));
+
+	// header, vertex streams, index stream, submesh table
+	uint64_t offset = AlignOffset(sizeof(MeshFileHeader));
+	for (uint32_t i = 0; i < desc.StreamCount; ++i)
+	{
+		if (desc.Strides[i] == 0)
+		{
+			return false;
+		}
+
+		header.Streams[i].Offset = offset;
+		header.Streams[i].Size = uint64_t(desc.VertexCount) * desc.Strides[i];
+		header.Streams[i].Stride = desc.Strides[i];
+		header.Streams[i].Layout = desc.Layouts[i];
+		offset = AlignOffset(offset + header.Streams[i].Size);
+	}
+
+	header.Indices.Offset = offset;
+	header.Indices.Size = uint64_t(desc.IndexCount) * indexSize;
+	offset = AlignOffset(offset + header.Indices.Size);
+
+	header.Submeshes.Offset = offset;
+	header.Submeshes.Size = uint64_t(desc.SubmeshCount) * sizeof(MeshFileSubmesh);
+	header.FileSize = offset + header.Submeshes.Size;
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return false;
+	}
+
+	offset = sizeof(MeshFileHeader);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (uint32_t i = 0; i < desc.StreamCount; ++i)
+	{
+		WritePadding(file, offset);
+		file.write(static_cast<const char*>(desc.pStreams[i]), static_cast<std::streamsize>(header.Streams[i].Size));
+		offset += header.Streams[i].Size;
+	}
+
+	WritePadding(file, offset);
+	file.write(static_cast<const char*>(desc.pIndices), static_cast<std::streamsize>(header.Indices.Size));
+	offset += header.Indices.Size;
+
+	WritePadding(file, offset);
+	file.write(reinterpret_cast<const char*>(desc.pSubmeshes), static_cast<std::streamsize>(header.Submeshes.Size));
+
+	return static_cast<bool>(file.flush());
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 check the header and the tables (the streams themselves are not touched)
+//--------------------------------------------------------------------------------------------------------
+bool MeshFile::IsValid(const void* pData, uint64_t fileSize)
+{
+	if (pData == nullptr || fileSize < sizeof(MeshFileHeader))
+	{
+		return false;
+	}
+
+	const MeshFileHeader& header = *static_cast<const MeshFileHeader*>(pData);
+	if (header.Magic != MeshFileMagic || header.Version != MeshFileVersion || header.FileSize != fileSize)
+	{
+		return false;
+	}
+
+	if (header.StreamCount == 0 || header.StreamCount > MeshFileMaxStreams)
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < header.StreamCount; ++i)
+	{
+		const MeshFileStream& stream = header.Streams[i];
+		if (stream.Stride == 0 || stream.Size != uint64_t(header.VertexCount) * stream.Stride
+			|| !IsValidRange(stream.Offset, stream.Size, fileSize))
+		{
+			return false;
+		}
+	}
+
+	uint32_t indexSize = GetIndexSize(header.IndexFormat);
+	if (indexSize == 0 || header.Indices.Size != uint64_t(header.IndexCount) * indexSize
+		|| !IsValidRange(header.Indices.Offset, header.Indices.Size, fileSize))
+	{
+		return false;
+	}
+
+	if (header.Submeshes.Size != uint64_t(header.SubmeshCount) * sizeof(MeshFileSubmesh)
+		|| !IsValidRange(header.Submeshes.Offset, header.Submeshes.Size, fileSize))
+	{
+		return false;
+	}
+
+	// submeshes only reference the index stream (the index values are left to the GPU)
+	const MeshFileSubmesh* pSubmeshes = reinterpret_cast<const MeshFileSubmesh*>(static_cast<const uint8_t*>(pData) + header.Submeshes.Offset);
+	for (uint32_t i = 0; i < header.SubmeshCount; ++i)
+	{
+		if (pSubmeshes[i].IndexStart > header.IndexCount || pSubmeshes[i].IndexCount > header.IndexCount - pSubmeshes[i].IndexStart)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
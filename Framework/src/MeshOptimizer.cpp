@@ -0,0 +1,484 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <MeshOptimizer.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t InvalidIndex = ~0u; // no triangle / unmapped vertex
+	const uint32_t MaxValence = 32; // remaining triangle counts above this share the last score
+	const float LastTriangleScore = 0.75f; // vertices of the triangle emitted last
+	const float CacheDecayPower = 1.5f; // falloff of the score over the cache positions
+	const float ValenceBoostScale = 2.f; // weight of vertices with few triangles left
+	const float ValenceBoostPower = -0.5f; // falloff of that weight
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// ScoreTables structure - vertex score terms of Forsyth's algorithm
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct ScoreTables
+	{
+		float Cache[MeshOptimizer::CacheSize]; // by cache position
+		float Valence[MaxValence + 1]; // by remaining triangles
+
+		ScoreTables()
+		{
+			for (uint32_t i = 0; i < MeshOptimizer::CacheSize; ++i)
+			{
+				// the 3 most recent vertices get a fixed score so that the next triangle doesn't simply
+				// reuse the edge just emitted
+				float scale = 1.f - float(i - 3) / float(MeshOptimizer::CacheSize - 3);
+				Cache[i] = (i < 3) ? LastTriangleScore : powf(scale, CacheDecayPower);
+			}
+
+			Valence[0] = 0.f;
+			for (uint32_t i = 1; i <= MaxValence; ++i)
+			{
+				Valence[i] = ValenceBoostScale * powf(float(i), ValenceBoostPower);
+			}
+		}
+	};
+
+	const ScoreTables Scores;
+
+	//----------------------------------------------------------------------------------------------------
+	// score of a vertex (-1 once all its triangles are emitted)
+	//----------------------------------------------------------------------------------------------------
+	float VertexScore(int32_t cachePosition, uint32_t remaining)
+	{
+		if (remaining == 0)
+		{
+			return -1.f;
+		}
+
+		float score = Scores.Valence[std::min(remaining, MaxValence)];
+		if (cachePosition >= 0)
+		{
+			score += Scores.Cache[cachePosition];
+		}
+		return score;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// FIFO cache access, returns true on a miss (stamps start at 0, time at cacheSize + 1)
+	//----------------------------------------------------------------------------------------------------
+	bool CacheMiss(uint32_t* pStamps, uint32_t entry, uint32_t& time, uint32_t cacheSize)
+	{
+		if (time - pStamps[entry] <= cacheSize)
+		{
+			return false;
+		}
+
+		pStamps[entry] = time++;
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// position of a vertex
+	//----------------------------------------------------------------------------------------------------
+	const float* Position(const float* pPositions, uint32_t positionStride, uint32_t vertex)
+	{
+		return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(pPositions) + size_t(vertex) * positionStride);
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MeshOptimizer class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+MeshOptimizer::MeshOptimizer()
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 greedy triangle order, each step emits the best scoring triangle next to the simulated LRU cache
+//--------------------------------------------------------------------------------------------------------
+void MeshOptimizer::OptimizeVertexCache(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount)
+{
+	uint32_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// triangles of each vertex (degenerate triangles appear once per corner)
+	m_Offsets.assign(size_t(vertexCount) + 1, 0);
+	for (uint32_t i = 0; i < triangleCount * 3; ++i)
+	{
+		assert(pIndices[i] < vertexCount);
+		m_Offsets[pIndices[i] + 1]++;
+	}
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		m_Offsets[v + 1] += m_Offsets[v];
+	}
+
+	m_Remaining.assign(vertexCount, 0);
+	m_Adjacency.resize(size_t(triangleCount) * 3);
+	for (uint32_t i = 0; i < triangleCount * 3; ++i)
+	{
+		uint32_t v = pIndices[i];
+		m_Adjacency[m_Offsets[v] + m_Remaining[v]++] = i / 3;
+	}
+
+	m_VertexScore.resize(vertexCount);
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		m_VertexScore[v] = VertexScore(-1, m_Remaining[v]);
+	}
+
+	uint32_t bestTriangle = InvalidIndex;
+	float bestScore = -1.f;
+	m_TriangleScore.resize(triangleCount);
+	for (uint32_t t = 0; t < triangleCount; ++t)
+	{
+		const uint32_t* pTriangle = pIndices + t * 3;
+		m_TriangleScore[t] = m_VertexScore[pTriangle[0]] + m_VertexScore[pTriangle[1]] + m_VertexScore[pTriangle[2]];
+		if (m_TriangleScore[t] > bestScore)
+		{
+			bestScore = m_TriangleScore[t];
+			bestTriangle = t;
+		}
+	}
+
+	// the 3 vertices of the emitted triangle are pushed in front before the cache is trimmed
+	uint32_t cache[CacheSize + 3];
+	uint32_t cacheCount = 0;
+	uint32_t cursor = 0;
+
+	m_Output.resize(size_t(triangleCount) * 3);
+	for (uint32_t emitted = 0; emitted < triangleCount; ++emitted)
+	{
+		// dead end, continue with the next triangle of the input order
+		if (bestTriangle == InvalidIndex)
+		{
+			while (m_TriangleScore[cursor] < 0.f)
+			{
+				cursor++;
+			}
+			bestTriangle = cursor;
+		}
+
+		const uint32_t* pTriangle = pIndices + bestTriangle * 3;
+		memcpy(&m_Output[size_t(emitted) * 3], pTriangle, 3 * sizeof(uint32_t));
+		m_TriangleScore[bestTriangle] = -1.f;
+
+		// unique vertices of the triangle go to the front of the cache
+		uint32_t newCache[CacheSize + 3];
+		uint32_t newCount = 0;
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			uint32_t v = pTriangle[k];
+
+			// drop the triangle from the remaining list of the vertex
+			uint32_t* pList = &m_Adjacency[m_Offsets[v]];
+			uint32_t& remaining = m_Remaining[v];
+			for (uint32_t j = 0; j < remaining; ++j)
+			{
+				if (pList[j] == bestTriangle)
+				{
+					pList[j] = pList[--remaining];
+					break;
+				}
+			}
+
+			if (std::find(newCache, newCache + newCount, v) == newCache + newCount)
+			{
+				newCache[newCount++] = v;
+			}
+		}
+
+		uint32_t frontCount = newCount;
+		for (uint32_t j = 0; j < cacheCount; ++j)
+		{
+			if (std::find(newCache, newCache + frontCount, cache[j]) == newCache + frontCount)
+			{
+				newCache[newCount++] = cache[j];
+			}
+		}
+
+		// rescore the vertices that moved and the triangles still using them
+		bestTriangle = InvalidIndex;
+		bestScore = -1.f;
+		for (uint32_t j = 0; j < newCount; ++j)
+		{
+			uint32_t v = newCache[j];
+			int32_t position = (j < CacheSize) ? static_cast<int32_t>(j) : -1;
+
+			float score = VertexScore(position, m_Remaining[v]);
+			float delta = score - m_VertexScore[v];
+			m_VertexScore[v] = score;
+
+			const uint32_t* pList = &m_Adjacency[m_Offsets[v]];
+			for (uint32_t a = 0; a < m_Remaining[v]; ++a)
+			{
+				uint32_t t = pList[a];
+				m_TriangleScore[t] += delta;
+				if (m_TriangleScore[t] > bestScore)
+				{
+					bestScore = m_TriangleScore[t];
+					bestTriangle = t;
+				}
+			}
+		}
+
+		cacheCount = (newCount < CacheSize) ? newCount : CacheSize;
+		memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+	}
+
+	memcpy(pIndices, m_Output.data(), size_t(triangleCount) * 3 * sizeof(uint32_t));
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 split the cache-friendly order into clusters and draw the outward facing clusters first
+//--------------------------------------------------------------------------------------------------------
+void MeshOptimizer::OptimizeOverdraw(uint32_t* pIndices, uint32_t indexCount, const float* pPositions, uint32_t positionStride, uint32_t vertexCount, float threshold)
+{
+	uint32_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// hard boundaries where the FIFO cache has nothing to offer (all 3 vertices miss)
+	m_Stamps.assign(vertexCount, 0);
+	uint32_t time = AnalyzeCacheSize + 1;
+	std::vector<uint32_t>& hard = m_Order;
+	hard.assign(1, 0);
+	for (uint32_t t = 0; t < triangleCount; ++t)
+	{
+		uint32_t misses = 0;
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			misses += CacheMiss(m_Stamps.data(), pIndices[t * 3 + k], time, AnalyzeCacheSize) ? 1 : 0;
+		}
+
+		if (misses == 3 && t > 0)
+		{
+			hard.push_back(t);
+		}
+	}
+	hard.push_back(triangleCount);
+
+	// soft boundaries inside a hard cluster once the ACMR from its start (with a cold cache) is within the
+	// threshold of the ACMR of the whole hard cluster
+	m_Clusters.clear();
+	for (size_t h = 0; h + 1 < hard.size(); ++h)
+	{
+		uint32_t first = hard[h];
+		uint32_t last = hard[h + 1];
+
+		time += AnalyzeCacheSize + 1;
+		uint32_t clusterMisses = 0;
+		for (uint32_t i = first * 3; i < last * 3; ++i)
+		{
+			clusterMisses += CacheMiss(m_Stamps.data(), pIndices[i], time, AnalyzeCacheSize) ? 1 : 0;
+		}
+		float limit = threshold * float(clusterMisses) / float(last - first);
+
+		time += AnalyzeCacheSize + 1;
+		uint32_t start = first;
+		uint32_t misses = 0;
+		m_Clusters.push_back(start);
+		for (uint32_t t = first; t < last; ++t)
+		{
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				misses += CacheMiss(m_Stamps.data(), pIndices[t * 3 + k], time, AnalyzeCacheSize) ? 1 : 0;
+			}
+
+			if (t + 1 < last && float(misses) <= limit * float(t + 1 - start))
+			{
+				start = t + 1;
+				misses = 0;
+				time += AnalyzeCacheSize + 1;
+				m_Clusters.push_back(start);
+			}
+		}
+	}
+	uint32_t clusterCount = static_cast<uint32_t>(m_Clusters.size());
+	m_Clusters.push_back(triangleCount);
+
+	// center of the mesh
+	float meshCenter[3] = { 0.f, 0.f, 0.f };
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		const float* p = Position(pPositions, positionStride, v);
+		meshCenter[0] += p[0];
+		meshCenter[1] += p[1];
+		meshCenter[2] += p[2];
+	}
+	for (float& c : meshCenter)
+	{
+		c /= float(std::max(vertexCount, 1u));
+	}
+
+	// clusters facing away from the center are likely in front of the others
+	m_SortKeys.resize(clusterCount);
+	for (uint32_t c = 0; c < clusterCount; ++c)
+	{
+		float center[3] = { 0.f, 0.f, 0.f };
+		float normal[3] = { 0.f, 0.f, 0.f };
+		float area = 0.f;
+		for (uint32_t t = m_Clusters[c]; t < m_Clusters[c + 1]; ++t)
+		{
+			const float* p0 = Position(pPositions, positionStride, pIndices[t * 3 + 0]);
+			const float* p1 = Position(pPositions, positionStride, pIndices[t * 3 + 1]);
+			const float* p2 = Position(pPositions, positionStride, pIndices[t * 3 + 2]);
+
+			float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			float w = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+			for (uint32_t a = 0; a < 3; ++a)
+			{
+				center[a] += (p0[a] + p1[a] + p2[a]) * (w / 3.f);
+				normal[a] += n[a];
+			}
+			area += w;
+		}
+
+		float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		float key = 0.f;
+		if (area > 0.f && length > 0.f)
+		{
+			for (uint32_t a = 0; a < 3; ++a)
+			{
+				key += (center[a] / area - meshCenter[a]) * (normal[a] / length);
+			}
+		}
+		m_SortKeys[c] = key;
+	}
+
+	m_Order.resize(clusterCount);
+	for (uint32_t c = 0; c < clusterCount; ++c)
+	{
+		m_Order[c] = c;
+	}
+	std::stable_sort(m_Order.begin(), m_Order.end(), [this](uint32_t a, uint32_t b) { return m_SortKeys[a] > m_SortKeys[b]; });
+
+	m_Output.resize(size_t(triangleCount) * 3);
+	uint32_t* pOutput = m_Output.data();
+	for (uint32_t c : m_Order)
+	{
+		size_t count = size_t(m_Clusters[c + 1] - m_Clusters[c]) * 3;
+		memcpy(pOutput, pIndices + size_t(m_Clusters[c]) * 3, count * sizeof(uint32_t));
+		pOutput += count;
+	}
+
+	memcpy(pIndices, m_Output.data(), size_t(triangleCount) * 3 * sizeof(uint32_t));
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 vertices in the order the index buffer first references them
+//--------------------------------------------------------------------------------------------------------
+uint32_t MeshOptimizer::OptimizeVertexFetch(void* pVertices, uint32_t vertexCount, uint32_t vertexStride, uint32_t* pIndices, uint32_t indexCount)
+{
+	std::vector<uint32_t>& remap = m_Order;
+	remap.assign(vertexCount, InvalidIndex);
+	m_Vertices.resize(size_t(vertexCount) * vertexStride);
+
+	const uint8_t* pSource = static_cast<const uint8_t*>(pVertices);
+	uint32_t used = 0;
+	for (uint32_t i = 0; i < indexCount; ++i)
+	{
+		uint32_t v = pIndices[i];
+		assert(v < vertexCount);
+		if (remap[v] == InvalidIndex)
+		{
+			memcpy(&m_Vertices[size_t(used) * vertexStride], pSource + size_t(v) * vertexStride, vertexStride);
+			remap[v] = used++;
+		}
+		pIndices[i] = remap[v];
+	}
+
+	memcpy(pVertices, m_Vertices.data(), size_t(used) * vertexStride);
+	return used;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 vertices shaded by a FIFO post-transform cache
+//--------------------------------------------------------------------------------------------------------
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+{
+	m_Stamps.assign(vertexCount, 0);
+	uint32_t time = cacheSize + 1;
+	uint32_t referenced = 0;
+
+	VertexCacheStats stats = {};
+	for (uint32_t i = 0; i < indexCount; ++i)
+	{
+		uint32_t v = pIndices[i];
+		referenced += (m_Stamps[v] == 0) ? 1 : 0;
+		stats.VerticesShaded += CacheMiss(m_Stamps.data(), v, time, cacheSize) ? 1 : 0;
+	}
+
+	uint32_t triangleCount = indexCount / 3;
+	stats.ACMR = (triangleCount > 0) ? float(stats.VerticesShaded) / float(triangleCount) : 0.f;
+	stats.ATVR = (referenced > 0) ? float(stats.VerticesShaded) / float(referenced) : 0.f;
+	return stats;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 cache lines loaded by the vertices the post-transform cache misses
+//--------------------------------------------------------------------------------------------------------
+VertexFetchStats MeshOptimizer::AnalyzeVertexFetch(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t vertexStride)
+{
+	const uint32_t lineCapacity = FetchCacheSize / FetchLineSize;
+	uint64_t lineCount = (uint64_t(vertexCount) * vertexStride + FetchLineSize - 1) / FetchLineSize;
+
+	// vertex stamps first, line stamps after them
+	m_Stamps.assign(vertexCount + static_cast<size_t>(lineCount), 0);
+	uint32_t* pVertexStamps = m_Stamps.data();
+	uint32_t* pLineStamps = m_Stamps.data() + vertexCount;
+	uint32_t vertexTime = AnalyzeCacheSize + 1;
+	uint32_t lineTime = lineCapacity + 1;
+	uint32_t referenced = 0;
+
+	VertexFetchStats stats = {};
+	for (uint32_t i = 0; i < indexCount; ++i)
+	{
+		uint32_t v = pIndices[i];
+		referenced += (pVertexStamps[v] == 0) ? 1 : 0;
+		if (!CacheMiss(pVertexStamps, v, vertexTime, AnalyzeCacheSize))
+		{
+			continue;
+		}
+
+		uint64_t begin = uint64_t(v) * vertexStride / FetchLineSize;
+		uint64_t end = (uint64_t(v) * vertexStride + vertexStride - 1) / FetchLineSize;
+		for (uint64_t line = begin; line <= end; ++line)
+		{
+			stats.BytesFetched += CacheMiss(pLineStamps, static_cast<uint32_t>(line), lineTime, lineCapacity) ? FetchLineSize : 0;
+		}
+	}
+
+	stats.Overfetch = (referenced > 0) ? float(double(stats.BytesFetched) / (double(referenced) * vertexStride)) : 0.f;
+	return stats;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 narrow indices to 16 bits
+//--------------------------------------------------------------------------------------------------------
+void MeshOptimizer::Convert16BitIndices(const uint32_t* pSource, uint32_t indexCount, uint16_t* pDest)
+{
+	for (uint32_t i = 0; i < indexCount; ++i)
+	{
+		assert(pSource[i] <= 0xffffu);
+		pDest[i] = static_cast<uint16_t>(pSource[i]);
+	}
+}
@@ -0,0 +1,559 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <PipelineCache.h>
+#include <Profiler.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint64_t FnvOffsetBasis = 0xcbf29ce484222325ull; // FNV-1a 64-bit start value (keys are stored on disk, never change these)
+	const uint64_t FnvPrime = 0x100000001b3ull; // FNV-1a 64-bit multiplier
+	const uint32_t LibraryFileMagic = 0x4C4F5350; // "PSOL"
+	const uint32_t LibraryFileVersion = 1; // bumped when the file header changes
+
+	//----------------------------------------------------------------------------------------------------
+	// header of the library file, followed by the blob of the device
+	//----------------------------------------------------------------------------------------------------
+	struct LibraryFileHeader
+	{
+		uint32_t Magic; // LibraryFileMagic
+		uint32_t Version; // LibraryFileVersion
+		uint32_t Backend; // GfxBackend which serialized the blob
+		uint32_t Reserved;
+		uint64_t BlobSize; // size of the blob in bytes
+		uint64_t Padding; // keeps the blob 16 byte aligned in the mapping
+	};
+
+	static_assert(sizeof(LibraryFileHeader) == 32, "LibraryFileHeader layout changed, bump LibraryFileVersion");
+
+	//----------------------------------------------------------------------------------------------------
+	// hash helpers
+	//----------------------------------------------------------------------------------------------------
+	uint64_t HashBytes(uint64_t hash, const void* pData, size_t size)
+	{
+		// 8 bytes per step (shader bytecode is kilobytes), the shift carries high bits down into later steps
+		const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+		size_t i = 0;
+		for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+		{
+			uint64_t word;
+			memcpy(&word, pBytes + i, sizeof(word));
+			hash = (hash ^ word) * FnvPrime;
+			hash ^= hash >> 32;
+		}
+
+		for (; i < size; ++i)
+		{
+			hash = (hash ^ pBytes[i]) * FnvPrime;
+		}
+		return hash;
+	}
+
+	// integers, enums and bools are widened so that the key doesn't depend on their size in the struct
+	template<typename T> uint64_t HashValue(uint64_t hash, T value)
+	{
+		static_assert(std::is_integral<T>::value || std::is_enum<T>::value, "only plain values are hashed");
+		uint64_t wide = static_cast<uint64_t>(value);
+		return HashBytes(hash, &wide, sizeof(wide));
+	}
+
+	uint64_t HashString(uint64_t hash, const char* pString)
+	{
+		// the terminator separates consecutive strings
+		return HashBytes(hash, pString, (pString != nullptr) ? strlen(pString) + 1 : 0);
+	}
+
+	uint64_t HashBytecode(uint64_t hash, const GfxShaderBytecode& bytecode)
+	{
+		hash = HashValue(hash, bytecode.BytecodeLength);
+		return HashBytes(hash, bytecode.pShaderBytecode, (bytecode.pShaderBytecode != nullptr) ? bytecode.BytecodeLength : 0);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// milliseconds between two time points
+	//----------------------------------------------------------------------------------------------------
+	double ElapsedMs(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - begin).count();
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PipelineCache class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+PipelineCache::PipelineCache()
+	: m_pDevice(nullptr)
+	, m_Stats()
+	, m_Quit(false)
+	, m_LibraryDirty(false)
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+PipelineCache::~PipelineCache()
+{
+	Term();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 initialization
+//--------------------------------------------------------------------------------------------------------
+bool PipelineCache::Init(GfxDevice* pDevice, uint32_t threadCount, const char* pLibraryPath)
+{
+	if (pDevice == nullptr)
+	{
+		return false;
+	}
+
+	Term();
+
+	m_pDevice = pDevice;
+	m_Stats = PipelineCacheStats();
+	m_Quit = false;
+
+	if (pLibraryPath != nullptr)
+	{
+		m_LibraryPath = pLibraryPath;
+		OpenLibrary();
+	}
+
+	m_Threads.reserve(threadCount);
+	for (uint32_t i = 0; i < threadCount; ++i)
+	{
+		m_Threads.emplace_back(&PipelineCache::ThreadMain, this);
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 termination
+//--------------------------------------------------------------------------------------------------------
+void PipelineCache::Term()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Quit = true;
+		m_Queue.clear();
+	}
+	m_WakeCondition.notify_all();
+
+	for (std::thread& thread : m_Threads)
+	{
+		thread.join();
+	}
+	m_Threads.clear();
+
+	if (m_LibraryDirty)
+	{
+		SaveLibrary();
+	}
+
+	m_pLibrary.reset();
+	m_LibraryFile.Close();
+	m_LibraryPath.clear();
+	m_LibraryDirty = false;
+
+	m_Lookup.clear();
+	m_Entries.clear();
+	m_pDevice = nullptr;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 look up or queue the pipeline of a desc
+//--------------------------------------------------------------------------------------------------------
+PipelineHandle PipelineCache::Request(const GfxGraphicsPipelineDesc& desc, uint64_t rootSignatureKey)
+{
+	if (m_pDevice == nullptr)
+	{
+		return InvalidPipelineHandle;
+	}
+
+	uint64_t key = ComputeKey(desc, rootSignatureKey);
+	auto it = m_Lookup.find(key);
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stats.RequestCount++;
+		m_Stats.HitCount += (it != m_Lookup.end()) ? 1 : 0;
+	}
+
+	if (it != m_Lookup.end())
+	{
+		return it->second;
+	}
+
+	// the caller's desc may point at temporaries, the compile thread works on a copy
+	std::unique_ptr<Entry> pEntry(new Entry());
+	pEntry->Key = key;
+	pEntry->State.store(EntryState::Queued, std::memory_order_relaxed);
+	pEntry->Desc = desc;
+	pEntry->RequestTime = std::chrono::steady_clock::now();
+
+	pEntry->Elements.assign(desc.pInputElementDescs, desc.pInputElementDescs + desc.NumInputElements);
+	for (const GfxInputElementDesc& element : pEntry->Elements)
+	{
+		pEntry->SemanticNames.append(element.SemanticName);
+		pEntry->SemanticNames.push_back('\0');
+	}
+
+	const uint8_t* pVS = static_cast<const uint8_t*>(desc.VS.pShaderBytecode);
+	const uint8_t* pPS = static_cast<const uint8_t*>(desc.PS.pShaderBytecode);
+	size_t vsLength = (pVS != nullptr) ? desc.VS.BytecodeLength : 0;
+	size_t psLength = (pPS != nullptr) ? desc.PS.BytecodeLength : 0;
+	pEntry->Bytecode.reserve(vsLength + psLength);
+	pEntry->Bytecode.insert(pEntry->Bytecode.end(), pVS, pVS + vsLength);
+	pEntry->Bytecode.insert(pEntry->Bytecode.end(), pPS, pPS + psLength);
+
+	// point the copy at the owned storage (the string isn't touched any more, so the names stay put)
+	const char* pName = pEntry->SemanticNames.c_str();
+	for (GfxInputElementDesc& element : pEntry->Elements)
+	{
+		element.SemanticName = pName;
+		pName += strlen(pName) + 1;
+	}
+	pEntry->Desc.pInputElementDescs = pEntry->Elements.data();
+	pEntry->Desc.VS = { (vsLength > 0) ? pEntry->Bytecode.data() : nullptr, vsLength };
+	pEntry->Desc.PS = { (psLength > 0) ? pEntry->Bytecode.data() + vsLength : nullptr, psLength };
+
+	PipelineHandle handle = static_cast<PipelineHandle>(m_Entries.size());
+	Entry* pQueued = pEntry.get();
+	m_Entries.push_back(std::move(pEntry));
+	m_Lookup.emplace(key, handle);
+
+	if (m_Threads.empty())
+	{
+		pQueued->State.store(EntryState::Compiling, std::memory_order_relaxed);
+		Compile(*pQueued);
+		return handle;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Queue.push_back(pQueued);
+	}
+	m_WakeCondition.notify_one();
+	return handle;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 pipeline of the handle or the fallback
+//--------------------------------------------------------------------------------------------------------
+GfxPipelineState* PipelineCache::Get(PipelineHandle handle, GfxPipelineState* pFallback)
+{
+	if (handle < m_Entries.size() && m_Entries[handle]->State.load(std::memory_order_acquire) == EntryState::Ready)
+	{
+		return m_Entries[handle]->pPipelineState.get();
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stats.HitchCount++;
+	return pFallback;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 block until the pipeline is ready
+//--------------------------------------------------------------------------------------------------------
+bool PipelineCache::Wait(PipelineHandle handle)
+{
+	if (handle >= m_Entries.size())
+	{
+		return false;
+	}
+
+	Entry& entry = *m_Entries[handle];
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	if (entry.State.load(std::memory_order_relaxed) == EntryState::Queued)
+	{
+		// jump the queue instead of waiting for everything requested before
+		m_Queue.erase(std::find(m_Queue.begin(), m_Queue.end(), &entry));
+		entry.State.store(EntryState::Compiling, std::memory_order_relaxed);
+		lock.unlock();
+		Compile(entry);
+		lock.lock();
+	}
+
+	m_DoneCondition.wait(lock, [&entry]
+	{
+		EntryState state = entry.State.load(std::memory_order_acquire);
+		return state == EntryState::Ready || state == EntryState::Failed;
+	});
+	return entry.State.load(std::memory_order_acquire) == EntryState::Ready;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 block until every requested pipeline is ready
+//--------------------------------------------------------------------------------------------------------
+void PipelineCache::WaitAll()
+{
+	for (PipelineHandle handle = 0; handle < m_Entries.size(); ++handle)
+	{
+		Wait(handle);
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 key of the handle
+//--------------------------------------------------------------------------------------------------------
+uint64_t PipelineCache::GetKey(PipelineHandle handle) const
+{
+	return (handle < m_Entries.size()) ? m_Entries[handle]->Key : 0;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 number of pipelines neither ready nor failed
+//--------------------------------------------------------------------------------------------------------
+uint32_t PipelineCache::GetPendingCount() const
+{
+	uint32_t count = 0;
+	for (const std::unique_ptr<Entry>& pEntry : m_Entries)
+	{
+		EntryState state = pEntry->State.load(std::memory_order_acquire);
+		count += (state == EntryState::Queued || state == EntryState::Compiling) ? 1 : 0;
+	}
+	return count;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 totals since initialization
+//--------------------------------------------------------------------------------------------------------
+PipelineCacheStats PipelineCache::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Stats;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 key of a graphics pipeline desc
+//--------------------------------------------------------------------------------------------------------
+uint64_t PipelineCache::ComputeKey(const GfxGraphicsPipelineDesc& desc, uint64_t rootSignatureKey)
+{
+	uint64_t hash = HashValue(FnvOffsetBasis, rootSignatureKey);
+	hash = HashBytecode(hash, desc.VS);
+	hash = HashBytecode(hash, desc.PS);
+
+	hash = HashValue(hash, desc.NumInputElements);
+	for (uint32_t i = 0; i < desc.NumInputElements; ++i)
+	{
+		const GfxInputElementDesc& element = desc.pInputElementDescs[i];
+		hash = HashString(hash, element.SemanticName);
+		hash = HashValue(hash, element.SemanticIndex);
+		hash = HashValue(hash, element.Format);
+		hash = HashValue(hash, element.InputSlot);
+		hash = HashValue(hash, element.AlignedByteOffset);
+		hash = HashValue(hash, element.InputSlotClass);
+		hash = HashValue(hash, element.InstanceDataStepRate);
+	}
+
+	hash = HashValue(hash, desc.RasterizerState.FillMode);
+	hash = HashValue(hash, desc.RasterizerState.CullMode);
+	hash = HashValue(hash, desc.RasterizerState.FrontCounterClockwise);
+	hash = HashValue(hash, desc.RasterizerState.DepthClipEnable);
+
+	hash = HashValue(hash, desc.BlendState.BlendEnable);
+	hash = HashValue(hash, desc.BlendState.SrcBlend);
+	hash = HashValue(hash, desc.BlendState.DestBlend);
+	hash = HashValue(hash, desc.BlendState.BlendOp);
+	hash = HashValue(hash, desc.BlendState.SrcBlendAlpha);
+	hash = HashValue(hash, desc.BlendState.DestBlendAlpha);
+	hash = HashValue(hash, desc.BlendState.BlendOpAlpha);
+	hash = HashValue(hash, desc.BlendState.RenderTargetWriteMask);
+
+	hash = HashValue(hash, desc.DepthStencilState.DepthEnable);
+	hash = HashValue(hash, desc.DepthStencilState.DepthWriteEnable);
+	hash = HashValue(hash, desc.DepthStencilState.DepthFunc);
+
+	hash = HashValue(hash, desc.PrimitiveTopology);
+	hash = HashValue(hash, desc.RTVFormat);
+	hash = HashValue(hash, desc.DSVFormat);
+	return hash;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 key of a root signature desc
+//--------------------------------------------------------------------------------------------------------
+uint64_t PipelineCache::ComputeKey(const GfxRootSignatureDesc& desc)
+{
+	uint64_t hash = HashValue(FnvOffsetBasis, desc.NumParameters);
+	for (uint32_t i = 0; i < desc.NumParameters; ++i)
+	{
+		const GfxRootParameter& param = desc.pParameters[i];
+		hash = HashValue(hash, param.ParameterType);
+		hash = HashValue(hash, param.ShaderRegister);
+		hash = HashValue(hash, param.RegisterSpace);
+		hash = HashValue(hash, param.ShaderVisibility);
+		hash = HashValue(hash, param.RangeType);
+		hash = HashValue(hash, param.NumDescriptors);
+	}
+	return HashValue(hash, desc.AllowInputLayout);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 compile thread
+//--------------------------------------------------------------------------------------------------------
+void PipelineCache::ThreadMain()
+{
+	Profiler::SetThreadName("Pipeline compiler");
+	for (;;)
+	{
+		Entry* pEntry = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WakeCondition.wait(lock, [this] { return m_Quit || !m_Queue.empty(); });
+			if (m_Quit)
+			{
+				return;
+			}
+
+			pEntry = m_Queue.front();
+			m_Queue.pop_front();
+			pEntry->State.store(EntryState::Compiling, std::memory_order_relaxed);
+		}
+
+		Compile(*pEntry);
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 load the pipeline from the library or compile and store it
+//--------------------------------------------------------------------------------------------------------
+void PipelineCache::Compile(Entry& entry)
+{
+	PROFILE_SCOPE("CompilePipeline");
+	auto begin = std::chrono::steady_clock::now();
+	bool loaded = (m_pLibrary != nullptr) && m_pLibrary->LoadGraphicsPipeline(entry.Key, entry.Desc, entry.pPipelineState);
+	bool compiled = !loaded && m_pDevice->CreateGraphicsPipelineState(entry.Desc, entry.pPipelineState);
+	auto end = std::chrono::steady_clock::now();
+
+	if (compiled && m_pLibrary != nullptr && m_pLibrary->StorePipeline(entry.Key, entry.pPipelineState.get()))
+	{
+		m_LibraryDirty = true;
+	}
+
+	// the driver keeps what it needs, the copy of the desc goes
+	entry.Desc.pInputElementDescs = nullptr;
+	entry.Desc.VS = {};
+	entry.Desc.PS = {};
+	std::vector<GfxInputElementDesc>().swap(entry.Elements);
+	std::string().swap(entry.SemanticNames);
+	std::vector<uint8_t>().swap(entry.Bytecode);
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		double ms = ElapsedMs(begin, end);
+		if (loaded)
+		{
+			m_Stats.LibraryLoadCount++;
+			m_Stats.LoadMs += ms;
+		}
+		else if (compiled)
+		{
+			m_Stats.CompileCount++;
+			m_Stats.CompileMs += ms;
+			m_Stats.MaxCompileMs = std::max(m_Stats.MaxCompileMs, ms);
+		}
+		else
+		{
+			m_Stats.FailureCount++;
+		}
+		m_Stats.MaxReadyMs = std::max(m_Stats.MaxReadyMs, ElapsedMs(entry.RequestTime, end));
+
+		entry.State.store((loaded || compiled) ? EntryState::Ready : EntryState::Failed, std::memory_order_release);
+	}
+	m_DoneCondition.notify_all();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 map the library file and create the library from it
+//--------------------------------------------------------------------------------------------------------
+void PipelineCache::OpenLibrary()
+{
+	// a missing, foreign or stale file starts an empty library which is written back on Term()
+	const void* pBlob = nullptr;
+	size_t blobSize = 0;
+	if (m_LibraryFile.Open(m_LibraryPath.c_str()))
+	{
+		LibraryFileHeader header = {};
+		if (m_LibraryFile.GetSize() >= sizeof(header))
+		{
+			memcpy(&header, m_LibraryFile.GetData(), sizeof(header));
+		}
+
+		if (header.Magic == LibraryFileMagic
+			&& header.Version == LibraryFileVersion
+			&& header.Backend == static_cast<uint32_t>(m_pDevice->GetBackend())
+			&& header.BlobSize == m_LibraryFile.GetSize() - sizeof(header))
+		{
+			pBlob = m_LibraryFile.GetData() + sizeof(header);
+			blobSize = static_cast<size_t>(header.BlobSize);
+		}
+		else
+		{
+			m_LibraryFile.Close();
+		}
+	}
+
+	if (pBlob != nullptr && m_pDevice->CreatePipelineLibrary(pBlob, blobSize, m_pLibrary))
+	{
+		return;
+	}
+
+	// the device refuses blobs of another driver or adapter
+	m_LibraryFile.Close();
+	if (!m_pDevice->CreatePipelineLibrary(nullptr, 0, m_pLibrary))
+	{
+		m_pLibrary.reset();
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 write the library file
+//--------------------------------------------------------------------------------------------------------
+bool PipelineCache::SaveLibrary()
+{
+	if (m_pLibrary == nullptr)
+	{
+		return false;
+	}
+
+	LibraryFileHeader header = {};
+	header.Magic = LibraryFileMagic;
+	header.Version = LibraryFileVersion;
+	header.Backend = static_cast<uint32_t>(m_pDevice->GetBackend());
+	header.BlobSize = m_pLibrary->GetSerializedSize();
+
+	std::vector<uint8_t> data(sizeof(header) + static_cast<size_t>(header.BlobSize));
+	memcpy(data.data(), &header, sizeof(header));
+	if (!m_pLibrary->Serialize(data.data() + sizeof(header), static_cast<size_t>(header.BlobSize)))
+	{
+		return false;
+	}
+
+	// the library may reference the mapping, which has to go before the file is replaced
+	m_pLibrary.reset();
+	m_LibraryFile.Close();
+
+	std::ofstream file(m_LibraryPath, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	return static_cast<bool>(file.flush());
+}
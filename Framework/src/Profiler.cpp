@@ -0,0 +1,321 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <Profiler.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t CpuProcessId = 1; // trace process of the thread tracks
+	const uint32_t GpuProcessId = 2; // trace process of the GPU track
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Track structure
+	//
+	// Written by one thread only. Chunks are allocated before Count moves past their first event, so a
+	// reader which loads Count with acquire may read every event below it.
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Track
+	{
+		uint32_t Id; // trace thread id
+		uint32_t ProcessId; // CpuProcessId or GpuProcessId
+		std::string Name; // guarded by the registry mutex
+		uint32_t Depth; // open scopes (owner only)
+		std::atomic<uint32_t> Count; // published events
+		std::atomic<uint64_t> Dropped; // events lost because every chunk was full
+		std::unique_ptr<ProfileEvent[]> Chunks[Profiler::MaxChunkCount]; // event storage, kept over Reset()
+	};
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Registry structure
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Registry
+	{
+		std::mutex Mutex; // guards the members below and the names of the tracks
+		std::vector<std::unique_ptr<Track>> Tracks; // tracks in order of registration (live until exit)
+		Track* pGpuTrack = nullptr; // track of AddGpuEvent()
+	};
+
+	std::atomic<bool> g_Enabled(false); // whether scopes record
+	thread_local Track* t_pTrack = nullptr; // track of the calling thread
+
+	//----------------------------------------------------------------------------------------------------
+	// registry shared by every thread (constructed on first use)
+	//----------------------------------------------------------------------------------------------------
+	Registry& GetRegistry()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// register a new track
+	//----------------------------------------------------------------------------------------------------
+	Track* CreateTrack(Registry& registry, uint32_t processId, const char* name)
+	{
+		std::lock_guard<std::mutex> lock(registry.Mutex);
+		std::unique_ptr<Track> pTrack(new Track());
+		pTrack->Id = static_cast<uint32_t>(registry.Tracks.size()) + 1;
+		pTrack->ProcessId = processId;
+		pTrack->Name = (name != nullptr) ? name : "Thread " + std::to_string(pTrack->Id);
+		pTrack->Depth = 0;
+		pTrack->Count.store(0, std::memory_order_relaxed);
+		pTrack->Dropped.store(0, std::memory_order_relaxed);
+		registry.Tracks.push_back(std::move(pTrack));
+		return registry.Tracks.back().get();
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// track of the calling thread, registered on first use
+	//----------------------------------------------------------------------------------------------------
+	Track* GetThreadTrack()
+	{
+		if (t_pTrack == nullptr)
+		{
+			t_pTrack = CreateTrack(GetRegistry(), CpuProcessId, nullptr);
+		}
+		return t_pTrack;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// append an event (owner thread only)
+	//----------------------------------------------------------------------------------------------------
+	void Push(Track* pTrack, const ProfileEvent& event)
+	{
+		uint32_t count = pTrack->Count.load(std::memory_order_relaxed);
+		uint32_t chunk = count / Profiler::ChunkEventCount;
+		if (chunk >= Profiler::MaxChunkCount)
+		{
+			pTrack->Dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		if (pTrack->Chunks[chunk] == nullptr)
+		{
+			pTrack->Chunks[chunk].reset(new ProfileEvent[Profiler::ChunkEventCount]);
+		}
+		pTrack->Chunks[chunk][count % Profiler::ChunkEventCount] = event;
+		pTrack->Count.store(count + 1, std::memory_order_release);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// write a string as JSON string literal
+	//----------------------------------------------------------------------------------------------------
+	void WriteJsonString(FILE* pFile, const char* text)
+	{
+		fputc('"', pFile);
+		for (const char* ptr = (text != nullptr) ? text : ""; *ptr != '\0'; ++ptr)
+		{
+			unsigned char c = static_cast<unsigned char>(*ptr);
+			if (c == '"' || c == '\\')
+			{
+				fputc('\\', pFile);
+				fputc(c, pFile);
+			}
+			else if (c < 0x20)
+			{
+				fprintf(pFile, "\\u%04x", c);
+			}
+			else
+			{
+				fputc(c, pFile);
+			}
+		}
+		fputc('"', pFile);
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Profiler class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 turn recording on or off
+//--------------------------------------------------------------------------------------------------------
+void Profiler::SetEnabled(bool enabled)
+{
+	g_Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 whether scopes record
+//--------------------------------------------------------------------------------------------------------
+bool Profiler::IsEnabled()
+{
+	return g_Enabled.load(std::memory_order_relaxed);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 name the track of the calling thread
+//--------------------------------------------------------------------------------------------------------
+void Profiler::SetThreadName(const char* name)
+{
+	Track* pTrack = GetThreadTrack();
+	std::lock_guard<std::mutex> lock(GetRegistry().Mutex);
+	pTrack->Name = (name != nullptr) ? name : "";
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 current time
+//--------------------------------------------------------------------------------------------------------
+uint64_t Profiler::Now()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 open a scope on the calling thread, returns its depth
+//--------------------------------------------------------------------------------------------------------
+uint32_t Profiler::BeginScope()
+{
+	return GetThreadTrack()->Depth++;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 close the innermost scope of the calling thread
+//--------------------------------------------------------------------------------------------------------
+void Profiler::EndScope(const char* name, uint64_t beginNs, uint32_t depth)
+{
+	ProfileEvent event = { name, beginNs, Now(), depth, 0 };
+	Track* pTrack = GetThreadTrack();
+	pTrack->Depth = depth;
+	Push(pTrack, event);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 add a region of the GPU track (one thread at a time)
+//--------------------------------------------------------------------------------------------------------
+void Profiler::AddGpuEvent(const char* name, uint64_t beginNs, uint64_t endNs, uint32_t depth)
+{
+	Registry& registry = GetRegistry();
+	Track* pTrack = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(registry.Mutex);
+		pTrack = registry.pGpuTrack;
+	}
+
+	if (pTrack == nullptr)
+	{
+		pTrack = CreateTrack(registry, GpuProcessId, "GPU queue");
+		std::lock_guard<std::mutex> lock(registry.Mutex);
+		registry.pGpuTrack = pTrack;
+	}
+
+	ProfileEvent event = { name, beginNs, (endNs > beginNs) ? endNs : beginNs, depth, 0 };
+	Push(pTrack, event);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 forget recorded events
+//--------------------------------------------------------------------------------------------------------
+void Profiler::Reset()
+{
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	for (const std::unique_ptr<Track>& pTrack : registry.Tracks)
+	{
+		pTrack->Count.store(0, std::memory_order_release);
+		pTrack->Dropped.store(0, std::memory_order_relaxed);
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 events recorded on every track
+//--------------------------------------------------------------------------------------------------------
+uint64_t Profiler::GetEventCount()
+{
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	uint64_t count = 0;
+	for (const std::unique_ptr<Track>& pTrack : registry.Tracks)
+	{
+		count += pTrack->Count.load(std::memory_order_acquire);
+	}
+	return count;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 events lost to full tracks
+//--------------------------------------------------------------------------------------------------------
+uint64_t Profiler::GetDroppedCount()
+{
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	uint64_t count = 0;
+	for (const std::unique_ptr<Track>& pTrack : registry.Tracks)
+	{
+		count += pTrack->Dropped.load(std::memory_order_relaxed);
+	}
+	return count;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 write Chrome trace event JSON
+//--------------------------------------------------------------------------------------------------------
+bool Profiler::WriteChromeTrace(const char* path)
+{
+	FILE* pFile = fopen(path, "wb");
+	if (pFile == nullptr)
+	{
+		return false;
+	}
+
+	// the lock only keeps tracks from being added or renamed, owners go on recording meanwhile
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+
+	std::vector<uint32_t> counts(registry.Tracks.size());
+	uint64_t originNs = UINT64_MAX;
+	for (size_t i = 0; i < registry.Tracks.size(); ++i)
+	{
+		const Track& track = *registry.Tracks[i];
+		counts[i] = track.Count.load(std::memory_order_acquire);
+		for (uint32_t e = 0; e < counts[i]; ++e)
+		{
+			const ProfileEvent& event = track.Chunks[e / ChunkEventCount][e % ChunkEventCount];
+			originNs = (event.BeginNs < originNs) ? event.BeginNs : originNs;
+		}
+	}
+	originNs = (originNs == UINT64_MAX) ? 0 : originNs;
+
+	// process and thread names first, then complete ("X") events in microseconds since the first one
+	fprintf(pFile, "{\"traceEvents\":[\n");
+	fprintf(pFile, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n", CpuProcessId);
+	fprintf(pFile, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":0,\"args\":{\"name\":\"GPU\"}}", GpuProcessId);
+	for (const std::unique_ptr<Track>& pTrack : registry.Tracks)
+	{
+		fprintf(pFile, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":", pTrack->ProcessId, pTrack->Id);
+		WriteJsonString(pFile, pTrack->Name.c_str());
+		fprintf(pFile, "}}");
+	}
+
+	for (size_t i = 0; i < registry.Tracks.size(); ++i)
+	{
+		const Track& track = *registry.Tracks[i];
+		const char* category = (track.ProcessId == GpuProcessId) ? "gpu" : "cpu";
+		for (uint32_t e = 0; e < counts[i]; ++e)
+		{
+			const ProfileEvent& event = track.Chunks[e / ChunkEventCount][e % ChunkEventCount];
+			fprintf(pFile, ",\n{\"name\":");
+			WriteJsonString(pFile, event.Name);
+			fprintf(pFile, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"depth\":%u}}",
+				category, track.ProcessId, track.Id, double(event.BeginNs - originNs) / 1000.0, double(event.EndNs - event.BeginNs) / 1000.0, event.Depth);
+		}
+	}
+	fprintf(pFile, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	return (fclose(pFile) == 0);
+}
@@ -0,0 +1,1248 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <RecordingDevice.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <utility>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const GfxGpuVirtualAddress BaseAddress = 0x100000000ull; // first fake GPU virtual address
+	const uint64_t AddressAlignment = 0x10000ull; // alignment of fake GPU virtual addresses (64 KB)
+	const uintptr_t MapAlignment = 4096u; // alignment of mapped pointers
+	const uint32_t DescriptorSize = 32u; // fake descriptor increment size
+	const size_t DescriptorHeapShift = 24u; // handles of heap i start at (i + 1) << DescriptorHeapShift
+	const uint32_t LibraryMagic = 0x42494C52; // "RLIB", first word of a serialized pipeline library
+	const uint64_t TimestampFrequency = 1000000000ull; // timestamps are in nanoseconds
+
+	//----------------------------------------------------------------------------------------------------
+	// helper for ids of nullable objects
+	//----------------------------------------------------------------------------------------------------
+	template<typename T> uint32_t IdOf(const GfxObject* pObject)
+	{
+		return (pObject != nullptr) ? static_cast<const T*>(pObject)->GetId() : 0u;
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordingResource class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class RecordingResource : public GfxResource
+{
+public:
+	RecordingResource(uint32_t id, uint64_t size, GfxGpuVirtualAddress address)
+		: m_Id(id)
+		, m_Address(address)
+		, m_Size(size)
+		, m_Memory((size > 0) ? size + MapAlignment : 0)
+		, m_pData(nullptr)
+	{
+		// mapped pointers are page aligned like on real hardware
+		if (!m_Memory.empty())
+		{
+			uintptr_t ptr = reinterpret_cast<uintptr_t>(m_Memory.data());
+			m_pData = m_Memory.data() + ((MapAlignment - (ptr & (MapAlignment - 1))) & (MapAlignment - 1));
+		}
+	}
+
+	// placed buffer, pData is the memory of the heap at its offset (nullptr when the heap can't be mapped)
+	RecordingResource(uint32_t id, uint64_t size, GfxGpuVirtualAddress address, uint8_t* pData)
+		: m_Id(id)
+		, m_Address(address)
+		, m_Size(size)
+		, m_pData(pData)
+	{ /* DO_NOTHING */ }
+
+	bool Map(void** ppData) override
+	{
+		if (ppData == nullptr || m_pData == nullptr)
+		{
+			return false;
+		}
+		*ppData = m_pData;
+		return true;
+	}
+
+	void Unmap() override { /* DO_NOTHING */ }
+	GfxGpuVirtualAddress GetGPUVirtualAddress() const override { return m_Address; }
+	uint32_t GetId() const { return m_Id; }
+	uint64_t GetSize() const { return m_Size; }
+	uint8_t* GetData() const { return m_pData; }
+
+private:
+	uint32_t m_Id; // object id
+	GfxGpuVirtualAddress m_Address; // fake GPU virtual address
+	uint64_t m_Size; // size in bytes
+	std::vector<uint8_t> m_Memory; // backing memory
+	uint8_t* m_pData; // aligned start of backing memory
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordingDescriptorHeap class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class RecordingDescriptorHeap : public GfxDescriptorHeap
+{
+public:
+	RecordingDescriptorHeap(uint32_t id, size_t base)
+		: m_Id(id)
+		, m_Base(base)
+	{ /* DO_NOTHING */ }
+
+	GfxCpuDescriptorHandle GetCPUDescriptorHandleForHeapStart() const override { return GfxCpuDescriptorHandle{ m_Base }; }
+	GfxGpuDescriptorHandle GetGPUDescriptorHandleForHeapStart() const override { return GfxGpuDescriptorHandle{ m_Base }; }
+	uint32_t GetId() const { return m_Id; }
+
+private:
+	uint32_t m_Id; // object id
+	size_t m_Base; // first descriptor handle
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordingRootSignature class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class RecordingRootSignature : public GfxRootSignature
+{
+public:
+	explicit RecordingRootSignature(uint32_t id) : m_Id(id) { /* DO_NOTHING */ }
+	uint32_t GetId() const { return m_Id; }
+
+private:
+	uint32_t m_Id; // object id
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordingPipelineState class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class RecordingPipelineState : public GfxPipelineState
+{
+public:
+	explicit RecordingPipelineState(uint32_t id) : m_Id(id) { /* DO_NOTHING */ }
+	uint32_t GetId() const { return m_Id; }
+
+private:
+	uint32_t m_Id; // object id
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordingPipelineLibrary class
+//
+// Only the keys are kept (serialized as LibraryMagic, their count and the sorted keys), a load hands out a
+// new pipeline state without the simulated compile time of the device.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class RecordingPipelineLibrary : public GfxPipelineLibrary
+{
+public:
+	RecordingPipelineLibrary(RecordingDevice* pDevice, uint32_t id, std::vector<uint64_t>&& keys)
+		: m_pDevice(pDevice)
+		, m_Id(id)
+		, m_Keys(std::move(keys))
+	{ /* DO_NOTHING */ }
+
+	bool LoadGraphicsPipeline(uint64_t key, const GfxGraphicsPipelineDesc& desc, GfxPtr<GfxPipelineState>& pPipelineState) override
+	{
+		if (desc.pRootSignature == nullptr)
+		{
+			return false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (!std::binary_search(m_Keys.begin(), m_Keys.end(), key))
+			{
+				return false;
+			}
+		}
+
+		return m_pDevice->LoadGraphicsPipeline(m_Id, pPipelineState);
+	}
+
+	bool StorePipeline(uint64_t key, GfxPipelineState* pPipelineState) override
+	{
+		if (pPipelineState == nullptr)
+		{
+			return false;
+		}
+
+		// keys which are taken are refused like names in ID3D12PipelineLibrary
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto it = std::lower_bound(m_Keys.begin(), m_Keys.end(), key);
+		if (it != m_Keys.end() && *it == key)
+		{
+			return false;
+		}
+
+		m_Keys.insert(it, key);
+		return true;
+	}
+
+	size_t GetSerializedSize() const override
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return sizeof(uint32_t) * 2 + m_Keys.size() * sizeof(uint64_t);
+	}
+
+	bool Serialize(void* pData, size_t size) const override
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		uint32_t head[2] = { LibraryMagic, static_cast<uint32_t>(m_Keys.size()) };
+		if (pData == nullptr || size < sizeof(head) + m_Keys.size() * sizeof(uint64_t))
+		{
+			return false;
+		}
+
+		memcpy(pData, head, sizeof(head));
+		memcpy(static_cast<uint8_t*>(pData) + sizeof(head), m_Keys.data(), m_Keys.size() * sizeof(uint64_t));
+		return true;
+	}
+
+	uint32_t GetId() const { return m_Id; }
+
+private:
+	RecordingDevice* m_pDevice; // owner device
+	uint32_t m_Id; // object id
+	mutable std::mutex m_Mutex; // guards m_Keys
+	std::vector<uint64_t> m_Keys; // stored keys (sorted)
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordingHeap class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class RecordingHeap : public GfxHeap
+{
+public:
+	RecordingHeap(uint32_t id, const GfxHeapDesc& desc, GfxGpuVirtualAddress address)
+		: m_Id(id)
+		, m_Address(address)
+		, m_Size(desc.Size)
+		, m_HeapType(desc.HeapType)
+		, m_pData(nullptr)
+	{
+		// only memory the CPU can map is backed, placed buffers on it share it like on real hardware
+		if (desc.HeapType != GfxHeapType::Default)
+		{
+			m_Memory.resize(desc.Size + MapAlignment);
+			uintptr_t ptr = reinterpret_cast<uintptr_t>(m_Memory.data());
+			m_pData = m_Memory.data() + ((MapAlignment - (ptr & (MapAlignment - 1))) & (MapAlignment - 1));
+		}
+	}
+
+	uint64_t GetSize() const override { return m_Size; }
+	uint32_t GetId() const { return m_Id; }
+	GfxGpuVirtualAddress GetAddress() const { return m_Address; }
+	GfxHeapType GetHeapType() const { return m_HeapType; }
+	uint8_t* GetData() const { return m_pData; }
+
+private:
+	uint32_t m_Id; // object id
+	GfxGpuVirtualAddress m_Address; // fake GPU virtual address of offset 0
+	uint64_t m_Size; // size in bytes
+	GfxHeapType m_HeapType; // memory of the heap
+	std::vector<uint8_t> m_Memory; // backing memory of CPU visible heaps
+	uint8_t* m_pData; // aligned start of backing memory
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordingQueryHeap class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class RecordingQueryHeap : public GfxQueryHeap
+{
+public:
+	RecordingQueryHeap(uint32_t id, uint32_t count)
+		: m_Id(id)
+		, m_Timestamps(count, 0)
+	{ /* DO_NOTHING */ }
+
+	uint32_t GetCount() const override { return static_cast<uint32_t>(m_Timestamps.size()); }
+	uint32_t GetId() const { return m_Id; }
+
+	// written and read while the device mutex is held (only queues touch them)
+	uint64_t* GetTimestamps() { return m_Timestamps.data(); }
+
+private:
+	uint32_t m_Id; // object id
+	std::vector<uint64_t> m_Timestamps; // last value written per query
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordingCommandAllocator class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class RecordingCommandAllocator : public GfxCommandAllocator
+{
+public:
+	explicit RecordingCommandAllocator(uint32_t id) : m_Id(id) { /* DO_NOTHING */ }
+	void Reset() override { /* DO_NOTHING */ }
+	uint32_t GetId() const { return m_Id; }
+
+private:
+	uint32_t m_Id; // object id
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordingFence class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class RecordingFence : public GfxFence
+{
+public:
+	RecordingFence(uint32_t id, uint64_t initialValue)
+		: m_Id(id)
+		, m_CompletedValue(initialValue)
+		, m_PendingCount(0)
+	{ /* DO_NOTHING */ }
+
+	uint64_t GetCompletedValue() const override
+	{
+		if (m_PendingCount.load(std::memory_order_acquire) > 0)
+		{
+			Retire(std::chrono::steady_clock::now());
+		}
+		return m_CompletedValue.load(std::memory_order_acquire);
+	}
+
+	void Wait(uint64_t value) override
+	{
+		// signals complete in order, sleeping until the first one reaching the value is enough
+		std::chrono::steady_clock::time_point completeTime;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_CompletedValue.load(std::memory_order_acquire) >= value)
+			{
+				return;
+			}
+
+			auto it = std::find_if(m_Pending.begin(), m_Pending.end(), [value](const PendingSignal& signal) { return signal.Value >= value; });
+
+			// nothing signaled will ever reach the value, waiting would hang
+			assert(it != m_Pending.end());
+			if (it == m_Pending.end())
+			{
+				return;
+			}
+			completeTime = it->CompleteTime;
+		}
+
+		std::this_thread::sleep_until(completeTime);
+		Retire(completeTime);
+	}
+
+	// the value is reached once the simulated GPU gets to completeTime
+	void Signal(uint64_t value, std::chrono::steady_clock::time_point completeTime)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_Pending.empty() && completeTime <= std::chrono::steady_clock::now())
+		{
+			m_CompletedValue.store(value, std::memory_order_release);
+			return;
+		}
+
+		m_Pending.push_back(PendingSignal{ value, completeTime });
+		m_PendingCount.store(static_cast<uint32_t>(m_Pending.size()), std::memory_order_release);
+	}
+
+	// time the simulated GPU reaches the value, false when nothing signaled so far ever reaches it
+	bool GetCompleteTime(uint64_t value, std::chrono::steady_clock::time_point& completeTime) const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_CompletedValue.load(std::memory_order_acquire) >= value)
+		{
+			completeTime = std::chrono::steady_clock::time_point();
+			return true;
+		}
+
+		auto it = std::find_if(m_Pending.begin(), m_Pending.end(), [value](const PendingSignal& signal) { return signal.Value >= value; });
+		if (it == m_Pending.end())
+		{
+			return false;
+		}
+		completeTime = it->CompleteTime;
+		return true;
+	}
+
+	uint32_t GetId() const { return m_Id; }
+
+private:
+	struct PendingSignal
+	{
+		uint64_t Value; // value set on completion
+		std::chrono::steady_clock::time_point CompleteTime; // time the simulated GPU gets there
+	};
+
+	uint32_t m_Id; // object id
+	mutable std::atomic<uint64_t> m_CompletedValue; // value reached by the simulated GPU
+	mutable std::mutex m_Mutex; // guards m_Pending
+	mutable std::deque<PendingSignal> m_Pending; // signals the simulated GPU hasn't reached yet (in order)
+	mutable std::atomic<uint32_t> m_PendingCount; // size of m_Pending, checked without the lock
+
+	void Retire(std::chrono::steady_clock::time_point now) const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		while (!m_Pending.empty() && m_Pending.front().CompleteTime <= now)
+		{
+			m_CompletedValue.store(m_Pending.front().Value, std::memory_order_release);
+			m_Pending.pop_front();
+		}
+		m_PendingCount.store(static_cast<uint32_t>(m_Pending.size()), std::memory_order_release);
+	}
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordingCommandList class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class RecordingCommandList : public GfxCommandList
+{
+public:
+	explicit RecordingCommandList(uint32_t id)
+		: m_Id(id)
+		, m_Closed(false)
+	{ /* DO_NOTHING */ }
+
+	void Reset(GfxCommandAllocator* pAllocator, GfxPipelineState* pInitialState) override
+	{
+		assert(m_Closed);
+		m_Stream.Clear();
+		m_Closed = false;
+
+		RecordCount record = { IdOf<RecordingCommandAllocator>(pAllocator), IdOf<RecordingPipelineState>(pInitialState) };
+		m_Stream.Write(RecordOp::Reset, record);
+		m_Queries.clear();
+		m_Copies.clear();
+	}
+
+	void Close() override
+	{
+		assert(!m_Closed);
+		m_Stream.Write(RecordOp::Close, RecordObject{ m_Id });
+		m_Closed = true;
+	}
+
+	void ResourceBarrier(uint32_t numBarriers, const GfxResourceBarrier* pBarriers) override
+	{
+		RecordBarrier* ptr = static_cast<RecordBarrier*>(m_Stream.Allocate(
+			RecordOp::ResourceBarrier,
+			static_cast<uint32_t>(sizeof(RecordCount) + sizeof(RecordBarrier) * numBarriers)));
+
+		RecordCount head = { 0, numBarriers };
+		memcpy(ptr, &head, sizeof(head));
+		ptr = reinterpret_cast<RecordBarrier*>(reinterpret_cast<uint8_t*>(ptr) + sizeof(head));
+
+		for (uint32_t i = 0u; i < numBarriers; ++i)
+		{
+			RecordBarrier record;
+			record.ResourceId = IdOf<RecordingResource>(pBarriers[i].pResource);
+			record.Subresource = pBarriers[i].Subresource;
+			record.StateBefore = static_cast<uint32_t>(pBarriers[i].StateBefore);
+			record.StateAfter = static_cast<uint32_t>(pBarriers[i].StateAfter);
+			record.Flags = static_cast<uint32_t>(pBarriers[i].Flags);
+			record.Type = static_cast<uint32_t>(pBarriers[i].Type);
+			memcpy(ptr + i, &record, sizeof(record));
+		}
+	}
+
+	void OMSetRenderTargets(uint32_t numRenderTargets, const GfxCpuDescriptorHandle* pRenderTargets) override
+	{
+		m_Stream.Write(RecordOp::OMSetRenderTargets, RecordCount{ 0, numRenderTargets }, numRenderTargets, pRenderTargets);
+	}
+
+	void ClearRenderTargetView(GfxCpuDescriptorHandle renderTarget, const float color[4]) override
+	{
+		RecordClear record;
+		record.Handle = renderTarget.ptr;
+		memcpy(record.Color, color, sizeof(record.Color));
+		m_Stream.Write(RecordOp::ClearRenderTargetView, record);
+	}
+
+	void SetGraphicsRootSignature(GfxRootSignature* pRootSignature) override
+	{
+		m_Stream.Write(RecordOp::SetGraphicsRootSignature, RecordObject{ IdOf<RecordingRootSignature>(pRootSignature) });
+	}
+
+	void SetDescriptorHeaps(uint32_t numHeaps, GfxDescriptorHeap* const* ppHeaps) override
+	{
+		uint32_t ids[4] = {};
+		assert(numHeaps <= 4);
+		for (uint32_t i = 0u; i < numHeaps; ++i)
+		{
+			ids[i] = IdOf<RecordingDescriptorHeap>(ppHeaps[i]);
+		}
+		m_Stream.Write(RecordOp::SetDescriptorHeaps, RecordCount{ 0, numHeaps }, numHeaps, ids);
+	}
+
+	void SetGraphicsRootConstantBufferView(uint32_t rootParameterIndex, GfxGpuVirtualAddress bufferLocation) override
+	{
+		RecordRootCBV record = { rootParameterIndex, 0, bufferLocation };
+		m_Stream.Write(RecordOp::SetGraphicsRootConstantBufferView, record);
+	}
+
+	void SetGraphicsRootDescriptorTable(uint32_t rootParameterIndex, GfxGpuDescriptorHandle baseDescriptor) override
+	{
+		RecordRootCBV record = { rootParameterIndex, 0, baseDescriptor.ptr };
+		m_Stream.Write(RecordOp::SetGraphicsRootDescriptorTable, record);
+	}
+
+	void SetPipelineState(GfxPipelineState* pPipelineState) override
+	{
+		m_Stream.Write(RecordOp::SetPipelineState, RecordObject{ IdOf<RecordingPipelineState>(pPipelineState) });
+	}
+
+	void IASetPrimitiveTopology(GfxPrimitiveTopology topology) override
+	{
+		m_Stream.Write(RecordOp::IASetPrimitiveTopology, static_cast<uint32_t>(topology));
+	}
+
+	void IASetVertexBuffers(uint32_t startSlot, uint32_t numViews, const GfxVertexBufferView* pViews) override
+	{
+		m_Stream.Write(RecordOp::IASetVertexBuffers, RecordCount{ startSlot, numViews }, numViews, pViews);
+	}
+
+	void IASetIndexBuffer(const GfxIndexBufferView* pView) override
+	{
+		GfxIndexBufferView view = {};
+		if (pView != nullptr)
+		{
+			view = *pView;
+		}
+		m_Stream.Write(RecordOp::IASetIndexBuffer, view);
+	}
+
+	void RSSetViewports(uint32_t numViewports, const GfxViewport* pViewports) override
+	{
+		m_Stream.Write(RecordOp::RSSetViewports, RecordCount{ 0, numViewports }, numViewports, pViewports);
+	}
+
+	void RSSetScissorRects(uint32_t numRects, const GfxRect* pRects) override
+	{
+		m_Stream.Write(RecordOp::RSSetScissorRects, RecordCount{ 0, numRects }, numRects, pRects);
+	}
+
+	void DrawIndexedInstanced(
+		uint32_t indexCountPerInstance,
+		uint32_t instanceCount,
+		uint32_t startIndexLocation,
+		int32_t baseVertexLocation,
+		uint32_t startInstanceLocation) override
+	{
+		RecordDrawIndexed record = {
+			indexCountPerInstance,
+			instanceCount,
+			startIndexLocation,
+			baseVertexLocation,
+			startInstanceLocation
+		};
+		m_Stream.Write(RecordOp::DrawIndexedInstanced, record);
+	}
+
+	void EndQuery(GfxQueryHeap* pQueryHeap, uint32_t index) override
+	{
+		auto pHeap = static_cast<RecordingQueryHeap*>(pQueryHeap);
+		assert(pHeap != nullptr && index < pHeap->GetCount());
+		m_Queries.push_back(QueryCommand{ pHeap, nullptr, index, 0, 0, m_Stream.GetCommandCount() });
+		m_Stream.Write(RecordOp::EndQuery, RecordQuery{ pHeap->GetId(), index, 1, 0, 0 });
+	}
+
+	void ResolveQueryData(
+		GfxQueryHeap* pQueryHeap,
+		uint32_t startIndex,
+		uint32_t numQueries,
+		GfxResource* pDestBuffer,
+		uint64_t alignedDestOffset) override
+	{
+		auto pHeap = static_cast<RecordingQueryHeap*>(pQueryHeap);
+		auto pDest = static_cast<RecordingResource*>(pDestBuffer);
+		assert(pHeap != nullptr && startIndex + numQueries <= pHeap->GetCount());
+		assert(pDest != nullptr && pDest->GetData() != nullptr && (alignedDestOffset & 7) == 0);
+		assert(alignedDestOffset + uint64_t(numQueries) * sizeof(uint64_t) <= pDest->GetSize());
+		m_Queries.push_back(QueryCommand{ pHeap, pDest, startIndex, numQueries, alignedDestOffset, m_Stream.GetCommandCount() });
+		m_Stream.Write(RecordOp::ResolveQueryData, RecordQuery{ pHeap->GetId(), startIndex, numQueries, pDest->GetId(), alignedDestOffset });
+	}
+
+	void CopyBufferRegion(
+		GfxResource* pDstBuffer,
+		uint64_t dstOffset,
+		GfxResource* pSrcBuffer,
+		uint64_t srcOffset,
+		uint64_t numBytes) override
+	{
+		auto pDst = static_cast<RecordingResource*>(pDstBuffer);
+		auto pSrc = static_cast<RecordingResource*>(pSrcBuffer);
+		assert(pDst != nullptr && pSrc != nullptr && pDst != pSrc);
+		assert(dstOffset + numBytes <= pDst->GetSize() && srcOffset + numBytes <= pSrc->GetSize());
+		m_Copies.push_back(CopyCommand{ pDst, pSrc, dstOffset, srcOffset, numBytes });
+		m_Stream.Write(RecordOp::CopyBufferRegion, RecordCopy{ pDst->GetId(), pSrc->GetId(), dstOffset, srcOffset, numBytes });
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// run the copies of the list on the backing memory (placed buffers of default heaps have none)
+	//----------------------------------------------------------------------------------------------------
+	void ExecuteCopies() const
+	{
+		for (const CopyCommand& copy : m_Copies)
+		{
+			if (copy.pDst->GetData() != nullptr && copy.pSrc->GetData() != nullptr)
+			{
+				memcpy(copy.pDst->GetData() + copy.DstOffset, copy.pSrc->GetData() + copy.SrcOffset, static_cast<size_t>(copy.NumBytes));
+			}
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// run the queries of the list executed from begin to end, commandOffset of totalCommands submitted
+	// before it (the device mutex is held by the caller)
+	//----------------------------------------------------------------------------------------------------
+	void ExecuteQueries(
+		std::chrono::steady_clock::time_point begin,
+		std::chrono::steady_clock::time_point end,
+		uint32_t commandOffset,
+		uint32_t totalCommands) const
+	{
+		int64_t beginNs = std::chrono::duration_cast<std::chrono::nanoseconds>(begin.time_since_epoch()).count();
+		int64_t durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+		for (const QueryCommand& query : m_Queries)
+		{
+			uint64_t* pTimestamps = query.pHeap->GetTimestamps();
+			if (query.pDest == nullptr)
+			{
+				uint64_t command = commandOffset + query.CommandIndex;
+				pTimestamps[query.Index] = uint64_t(beginNs + durationNs * int64_t(command) / int64_t(totalCommands));
+			}
+			else
+			{
+				memcpy(query.pDest->GetData() + query.DestOffset, pTimestamps + query.Index, query.Count * sizeof(uint64_t));
+			}
+		}
+	}
+
+	uint32_t GetId() const { return m_Id; }
+	const RecordStream& GetStream() const { return m_Stream; }
+	bool IsClosed() const { return m_Closed; }
+
+private:
+	struct QueryCommand
+	{
+		RecordingQueryHeap* pHeap; // queried heap
+		RecordingResource* pDest; // destination of a resolve, nullptr for EndQuery
+		uint32_t Index; // query or first resolved query
+		uint32_t Count; // number of resolved queries
+		uint64_t DestOffset; // offset of the resolved data in pDest
+		uint32_t CommandIndex; // position in m_Stream
+	};
+
+	struct CopyCommand
+	{
+		RecordingResource* pDst; // destination buffer
+		RecordingResource* pSrc; // source buffer
+		uint64_t DstOffset; // offset in pDst
+		uint64_t SrcOffset; // offset in pSrc
+		uint64_t NumBytes; // bytes copied
+	};
+
+	uint32_t m_Id; // object id
+	bool m_Closed; // whether Close() has been called since the last Reset()
+	RecordStream m_Stream; // recorded commands
+	std::vector<QueryCommand> m_Queries; // queries in recording order, run when the list is executed
+	std::vector<CopyCommand> m_Copies; // copies in recording order, run when the list is executed
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordingCommandQueue class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class RecordingCommandQueue : public GfxCommandQueue
+{
+public:
+	RecordingCommandQueue(RecordingDevice* pDevice, uint32_t id)
+		: m_pDevice(pDevice)
+		, m_Id(id)
+	{ /* DO_NOTHING */ }
+
+	void ExecuteCommandLists(uint32_t numCommandLists, GfxCommandList* const* ppCommandLists) override
+	{
+		std::lock_guard<std::mutex> lock(m_pDevice->m_Mutex);
+		uint32_t* ids = static_cast<uint32_t*>(m_pDevice->m_Stream.Allocate(
+			RecordOp::ExecuteCommandLists,
+			static_cast<uint32_t>(sizeof(RecordCount) + sizeof(uint32_t) * numCommandLists)));
+
+		RecordCount head = { 0, numCommandLists };
+		memcpy(ids, &head, sizeof(head));
+		ids += sizeof(head) / sizeof(uint32_t);
+
+		for (uint32_t i = 0u; i < numCommandLists; ++i)
+		{
+			ids[i] = static_cast<RecordingCommandList*>(ppCommandLists[i])->GetId();
+		}
+
+		// commands follow in submission order
+		uint32_t totalCommands = 0;
+		for (uint32_t i = 0u; i < numCommandLists; ++i)
+		{
+			auto pList = static_cast<RecordingCommandList*>(ppCommandLists[i]);
+			assert(pList->IsClosed());
+			m_pDevice->Submit(pList->GetStream());
+			totalCommands += pList->GetStream().GetCommandCount();
+		}
+
+		std::chrono::steady_clock::time_point begin = m_pDevice->ScheduleGpuWork();
+		std::chrono::steady_clock::time_point end = std::max(begin, m_pDevice->m_GpuIdleTime);
+
+		uint32_t commandOffset = 0;
+		for (uint32_t i = 0u; i < numCommandLists; ++i)
+		{
+			auto pList = static_cast<RecordingCommandList*>(ppCommandLists[i]);
+			pList->ExecuteQueries(begin, end, commandOffset, totalCommands);
+			pList->ExecuteCopies();
+			commandOffset += pList->GetStream().GetCommandCount();
+		}
+	}
+
+	void Signal(GfxFence* pFence, uint64_t value) override
+	{
+		auto pRecordingFence = static_cast<RecordingFence*>(pFence);
+		RecordSignal record = { pRecordingFence->GetId(), 0, value };
+		std::chrono::steady_clock::time_point completeTime;
+		{
+			std::lock_guard<std::mutex> lock(m_pDevice->m_Mutex);
+			m_pDevice->m_Stream.Write(RecordOp::Signal, record);
+			completeTime = m_pDevice->m_GpuIdleTime;
+		}
+
+		// reached once the simulated GPU has done the work submitted before
+		pRecordingFence->Signal(value, completeTime);
+	}
+
+	void Wait(GfxFence* pFence, uint64_t value) override
+	{
+		auto pRecordingFence = static_cast<RecordingFence*>(pFence);
+		std::chrono::steady_clock::time_point completeTime;
+
+		// nothing signaled will ever reach the value, the queue would hang
+		bool signaled = pRecordingFence->GetCompleteTime(value, completeTime);
+		assert(signaled);
+
+		// the queues share one simulated timeline, work after the wait can't start before the value is reached
+		std::lock_guard<std::mutex> lock(m_pDevice->m_Mutex);
+		m_pDevice->m_Stream.Write(RecordOp::Wait, RecordSignal{ pRecordingFence->GetId(), 0, value });
+		if (signaled)
+		{
+			m_pDevice->m_GpuIdleTime = std::max(m_pDevice->m_GpuIdleTime, completeTime);
+		}
+	}
+
+	uint64_t GetTimestampFrequency() const override { return TimestampFrequency; }
+
+	bool GetClockCalibration(uint64_t& gpuTimestamp, uint64_t& cpuNanoseconds) const override
+	{
+		// the simulated GPU counts on the CPU clock
+		cpuNanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+		gpuTimestamp = cpuNanoseconds;
+		return true;
+	}
+
+	uint32_t GetId() const { return m_Id; }
+
+private:
+	RecordingDevice* m_pDevice; // owner device
+	uint32_t m_Id; // object id
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordingSwapChain class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+class RecordingSwapChain : public GfxSwapChain
+{
+public:
+	RecordingSwapChain(RecordingDevice* pDevice, uint32_t id)
+		: m_pDevice(pDevice)
+		, m_Id(id)
+		, m_BackBufferIndex(0)
+	{ /* DO_NOTHING */ }
+
+	GfxResource* GetBuffer(uint32_t index) const override
+	{
+		return (index < m_Buffers.size()) ? m_Buffers[index].get() : nullptr;
+	}
+
+	uint32_t GetCurrentBackBufferIndex() const override { return m_BackBufferIndex; }
+
+	void Present(uint32_t syncInterval) override
+	{
+		RecordPresent record = { syncInterval, m_BackBufferIndex };
+		std::lock_guard<std::mutex> lock(m_pDevice->m_Mutex);
+		m_pDevice->m_Stream.Write(RecordOp::Present, record);
+
+		m_BackBufferIndex = (m_BackBufferIndex + 1) % static_cast<uint32_t>(m_Buffers.size());
+		m_pDevice->EndFrame();
+	}
+
+	void AddBuffer(GfxPtr<GfxResource>&& pBuffer) { m_Buffers.push_back(std::move(pBuffer)); }
+	uint32_t GetId() const { return m_Id; }
+
+private:
+	RecordingDevice* m_pDevice; // owner device
+	uint32_t m_Id; // object id
+	uint32_t m_BackBufferIndex; // index of current back buffer
+	std::vector<GfxPtr<GfxResource>> m_Buffers; // back buffers
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordStream class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+RecordStream::RecordStream()
+	: m_CommandCount(0)
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 clear records
+//--------------------------------------------------------------------------------------------------------
+void RecordStream::Clear()
+{
+	m_Buffer.clear();
+	m_CommandCount = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 reserve a record
+//--------------------------------------------------------------------------------------------------------
+void* RecordStream::Allocate(RecordOp op, uint32_t payloadSize)
+{
+	size_t offset = m_Buffer.size();
+	m_Buffer.resize(offset + sizeof(RecordHeader) + AlignSize(payloadSize));
+
+	RecordHeader header = { static_cast<uint16_t>(op), 0, payloadSize };
+	memcpy(m_Buffer.data() + offset, &header, sizeof(header));
+
+	m_CommandCount++;
+	return m_Buffer.data() + offset + sizeof(header);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 append records of another stream
+//--------------------------------------------------------------------------------------------------------
+void RecordStream::Append(const RecordStream& other)
+{
+	m_Buffer.insert(m_Buffer.end(), other.m_Buffer.begin(), other.m_Buffer.end());
+	m_CommandCount += other.m_CommandCount;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordingDevice class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+RecordingDevice::RecordingDevice()
+	: m_Stats()
+	, m_NextId(1)
+	, m_NextHeapIndex(1)
+	, m_NextAddress(BaseAddress)
+	, m_PipelineCompileTime(0)
+	, m_GpuWorkTime(0)
+	, m_GpuJitter(0)
+	, m_GpuSeed(12345u)
+	, m_GpuIdleTime()
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+RecordingDevice::~RecordingDevice()
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate command queue
+//--------------------------------------------------------------------------------------------------------
+bool RecordingDevice::CreateCommandQueue(GfxCommandListType type, GfxPtr<GfxCommandQueue>& pQueue)
+{
+	uint32_t id = NewId();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CreateCommandQueue, RecordCreate{ id, static_cast<uint32_t>(type), 0 });
+	pQueue.reset(new RecordingCommandQueue(this, id));
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate swap chain
+//--------------------------------------------------------------------------------------------------------
+bool RecordingDevice::CreateSwapChain(GfxCommandQueue* pQueue, const GfxSwapChainDesc& desc, GfxPtr<GfxSwapChain>& pSwapChain)
+{
+	if (pQueue == nullptr || desc.BufferCount == 0)
+	{
+		return false;
+	}
+
+	uint32_t id = NewId();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CreateSwapChain, RecordCreate{ id, desc.BufferCount, uint64_t(desc.Width) << 32 | desc.Height });
+
+	auto pRecordingSwapChain = new RecordingSwapChain(this, id);
+	pSwapChain.reset(pRecordingSwapChain);
+
+	// back buffers have no backing memory, nothing reads them on the CPU
+	for (uint32_t i = 0u; i < desc.BufferCount; ++i)
+	{
+		pRecordingSwapChain->AddBuffer(GfxPtr<GfxResource>(new RecordingResource(NewId(), 0, 0)));
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate command allocator
+//--------------------------------------------------------------------------------------------------------
+bool RecordingDevice::CreateCommandAllocator(GfxCommandListType type, GfxPtr<GfxCommandAllocator>& pAllocator)
+{
+	uint32_t id = NewId();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CreateCommandAllocator, RecordCreate{ id, static_cast<uint32_t>(type), 0 });
+	pAllocator.reset(new RecordingCommandAllocator(id));
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate command list
+//--------------------------------------------------------------------------------------------------------
+bool RecordingDevice::CreateCommandList(GfxCommandListType type, GfxCommandAllocator* pAllocator, GfxPtr<GfxCommandList>& pCmdList)
+{
+	if (pAllocator == nullptr)
+	{
+		return false;
+	}
+
+	uint32_t id = NewId();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CreateCommandList, RecordCreate{ id, static_cast<uint32_t>(type), 0 });
+
+	// a new command list is open for recording, like in D3D12
+	auto pList = new RecordingCommandList(id);
+	pCmdList.reset(pList);
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate fence
+//--------------------------------------------------------------------------------------------------------
+bool RecordingDevice::CreateFence(uint64_t initialValue, GfxPtr<GfxFence>& pFence)
+{
+	uint32_t id = NewId();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CreateFence, RecordCreate{ id, 0, initialValue });
+	pFence.reset(new RecordingFence(id, initialValue));
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate descriptor heap
+//--------------------------------------------------------------------------------------------------------
+bool RecordingDevice::CreateDescriptorHeap(const GfxDescriptorHeapDesc& desc, GfxPtr<GfxDescriptorHeap>& pHeap)
+{
+	if (desc.NumDescriptors == 0 || size_t(desc.NumDescriptors) * DescriptorSize >= (size_t(1) << DescriptorHeapShift))
+	{
+		return false;
+	}
+
+	uint32_t id = NewId();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CreateDescriptorHeap, RecordCreate{ id, static_cast<uint32_t>(desc.Type), desc.NumDescriptors });
+
+	size_t base = size_t(m_NextHeapIndex++) << DescriptorHeapShift;
+	pHeap.reset(new RecordingDescriptorHeap(id, base));
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate buffer
+//--------------------------------------------------------------------------------------------------------
+bool RecordingDevice::CreateBuffer(const GfxBufferDesc& desc, GfxPtr<GfxResource>& pResource)
+{
+	if (desc.Size == 0)
+	{
+		return false;
+	}
+
+	uint32_t id = NewId();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CreateBuffer, RecordCreate{ id, static_cast<uint32_t>(desc.HeapType), desc.Size });
+
+	GfxGpuVirtualAddress address = m_NextAddress;
+	m_NextAddress += (desc.Size + AddressAlignment - 1) & ~(AddressAlignment - 1);
+
+	pResource.reset(new RecordingResource(id, desc.Size, address));
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate heap
+//--------------------------------------------------------------------------------------------------------
+bool RecordingDevice::CreateHeap(const GfxHeapDesc& desc, GfxPtr<GfxHeap>& pHeap)
+{
+	if (desc.Size == 0 || desc.Size % GfxPlacementAlignment != 0)
+	{
+		return false;
+	}
+
+	uint32_t id = NewId();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CreateHeap, RecordCreate{ id, static_cast<uint32_t>(desc.HeapType), desc.Size });
+
+	// placed buffers get addresses inside the heap's range, aliased ones the same
+	GfxGpuVirtualAddress address = m_NextAddress;
+	m_NextAddress += (desc.Size + AddressAlignment - 1) & ~(AddressAlignment - 1);
+
+	pHeap.reset(new RecordingHeap(id, desc, address));
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate buffer in a heap
+//--------------------------------------------------------------------------------------------------------
+bool RecordingDevice::CreatePlacedBuffer(GfxHeap* pHeap, uint64_t offset, const GfxBufferDesc& desc, GfxPtr<GfxResource>& pResource)
+{
+	RecordingHeap* pRecordingHeap = static_cast<RecordingHeap*>(pHeap);
+	if (pHeap == nullptr || desc.Size == 0 || offset % GfxPlacementAlignment != 0
+		|| offset + desc.Size > pHeap->GetSize() || desc.HeapType != pRecordingHeap->GetHeapType())
+	{
+		return false;
+	}
+
+	uint32_t id = NewId();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CreatePlacedBuffer, RecordCreatePlaced{ id, pRecordingHeap->GetId(), offset, desc.Size });
+
+	uint8_t* pData = (pRecordingHeap->GetData() != nullptr) ? pRecordingHeap->GetData() + offset : nullptr;
+	pResource.reset(new RecordingResource(id, desc.Size, pRecordingHeap->GetAddress() + offset, pData));
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate root signature
+//--------------------------------------------------------------------------------------------------------
+bool RecordingDevice::CreateRootSignature(const GfxRootSignatureDesc& desc, GfxPtr<GfxRootSignature>& pRootSignature)
+{
+	uint32_t id = NewId();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CreateRootSignature, RecordCreate{ id, desc.NumParameters, 0 });
+	pRootSignature.reset(new RecordingRootSignature(id));
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate graphics pipeline state
+//--------------------------------------------------------------------------------------------------------
+bool RecordingDevice::CreateGraphicsPipelineState(const GfxGraphicsPipelineDesc& desc, GfxPtr<GfxPipelineState>& pPipelineState)
+{
+	if (desc.pRootSignature == nullptr)
+	{
+		return false;
+	}
+
+	// the driver compile happens outside of any lock, other threads keep creating objects meanwhile
+	if (m_PipelineCompileTime > 0)
+	{
+		std::this_thread::sleep_for(std::chrono::microseconds(m_PipelineCompileTime));
+	}
+
+	uint32_t id = NewId();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CreateGraphicsPipelineState, RecordCreate{ id, desc.NumInputElements, 0 });
+	pPipelineState.reset(new RecordingPipelineState(id));
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate pipeline library
+//--------------------------------------------------------------------------------------------------------
+bool RecordingDevice::CreatePipelineLibrary(const void* pBlob, size_t blobSize, GfxPtr<GfxPipelineLibrary>& pLibrary)
+{
+	std::vector<uint64_t> keys;
+	if (pBlob != nullptr && blobSize > 0)
+	{
+		// corrupt blobs are rejected like D3D12 does, the caller starts over with an empty library
+		uint32_t head[2];
+		if (blobSize < sizeof(head))
+		{
+			return false;
+		}
+
+		memcpy(head, pBlob, sizeof(head));
+		if (head[0] != LibraryMagic || blobSize != sizeof(head) + uint64_t(head[1]) * sizeof(uint64_t))
+		{
+			return false;
+		}
+
+		keys.resize(head[1]);
+		memcpy(keys.data(), static_cast<const uint8_t*>(pBlob) + sizeof(head), keys.size() * sizeof(uint64_t));
+		std::sort(keys.begin(), keys.end());
+	}
+
+	uint32_t id = NewId();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CreatePipelineLibrary, RecordCreate{ id, static_cast<uint32_t>(keys.size()), blobSize });
+	pLibrary.reset(new RecordingPipelineLibrary(this, id, std::move(keys)));
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate timestamp query heap
+//--------------------------------------------------------------------------------------------------------
+bool RecordingDevice::CreateTimestampQueryHeap(uint32_t count, GfxPtr<GfxQueryHeap>& pQueryHeap)
+{
+	if (count == 0)
+	{
+		return false;
+	}
+
+	uint32_t id = NewId();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CreateQueryHeap, RecordCreate{ id, count, 0 });
+	pQueryHeap.reset(new RecordingQueryHeap(id, count));
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 get increment size of descriptor handles
+//--------------------------------------------------------------------------------------------------------
+uint32_t RecordingDevice::GetDescriptorHandleIncrementSize(GfxDescriptorHeapType type) const
+{
+	(void)type;
+	return DescriptorSize;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate constant buffer view
+//--------------------------------------------------------------------------------------------------------
+void RecordingDevice::CreateConstantBufferView(const GfxConstantBufferViewDesc& desc, GfxCpuDescriptorHandle destDescriptor)
+{
+	RecordCreateView record = { desc.BufferLocation, destDescriptor.ptr, desc.SizeInBytes, 0 };
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CreateConstantBufferView, record);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate render target view
+//--------------------------------------------------------------------------------------------------------
+void RecordingDevice::CreateRenderTargetView(GfxResource* pResource, GfxFormat format, GfxCpuDescriptorHandle destDescriptor)
+{
+	RecordCreateView record = { IdOf<RecordingResource>(pResource), destDescriptor.ptr, static_cast<uint32_t>(format), 0 };
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CreateRenderTargetView, record);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 copy descriptors
+//--------------------------------------------------------------------------------------------------------
+void RecordingDevice::CopyDescriptorsSimple(
+	uint32_t numDescriptors,
+	GfxCpuDescriptorHandle destDescriptorRangeStart,
+	GfxCpuDescriptorHandle srcDescriptorRangeStart,
+	GfxDescriptorHeapType type)
+{
+	RecordCopyDescriptors record = {
+		destDescriptorRangeStart.ptr,
+		srcDescriptorRangeStart.ptr,
+		numDescriptors,
+		static_cast<uint32_t>(type)
+	};
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::CopyDescriptors, record);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 generate graphics pipeline state stored in a library (no compile time)
+//--------------------------------------------------------------------------------------------------------
+bool RecordingDevice::LoadGraphicsPipeline(uint32_t libraryId, GfxPtr<GfxPipelineState>& pPipelineState)
+{
+	uint32_t id = NewId();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stream.Write(RecordOp::LoadGraphicsPipeline, RecordCreate{ id, libraryId, 0 });
+	pPipelineState.reset(new RecordingPipelineState(id));
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 simulated time of a submission
+//--------------------------------------------------------------------------------------------------------
+void RecordingDevice::SetGpuWorkTime(uint32_t microseconds, uint32_t jitterMicroseconds)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_GpuWorkTime = microseconds;
+	m_GpuJitter = (jitterMicroseconds < microseconds) ? jitterMicroseconds : microseconds;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 issue new object id
+//--------------------------------------------------------------------------------------------------------
+uint32_t RecordingDevice::NewId()
+{
+	return m_NextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 append the commands of an executed command list (m_Mutex is held by the caller)
+//--------------------------------------------------------------------------------------------------------
+void RecordingDevice::Submit(const RecordStream& stream)
+{
+	m_Stream.Append(stream);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 queue a submission on the simulated GPU timeline, returns the time the GPU starts on it (m_Mutex is
+//	 held by the caller)
+//--------------------------------------------------------------------------------------------------------
+std::chrono::steady_clock::time_point RecordingDevice::ScheduleGpuWork()
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (m_GpuWorkTime == 0)
+	{
+		return std::max(now, m_GpuIdleTime);
+	}
+
+	int64_t microseconds = m_GpuWorkTime;
+	if (m_GpuJitter > 0)
+	{
+		m_GpuSeed = m_GpuSeed * 1664525u + 1013904223u;
+		microseconds += int64_t((m_GpuSeed >> 8) % (2 * m_GpuJitter + 1)) - m_GpuJitter;
+	}
+
+	// the GPU starts on the submission when it is made or when the previous one is done, whichever is later
+	std::chrono::steady_clock::time_point begin = std::max(now, m_GpuIdleTime);
+	m_GpuIdleTime = begin + std::chrono::microseconds(microseconds);
+	return begin;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 fold the frame into statistics and start a new one (m_Mutex is held by the caller)
+//--------------------------------------------------------------------------------------------------------
+void RecordingDevice::EndFrame()
+{
+	m_Stats.FrameCount++;
+	m_Stats.CommandCount += m_Stream.GetCommandCount();
+	m_Stats.ByteCount += m_Stream.GetSize();
+	m_Stream.ForEach([this](RecordOp op, const void*, uint32_t)
+	{
+		m_Stats.OpCount[static_cast<size_t>(op)]++;
+	});
+
+	std::swap(m_Stream, m_LastFrameStream);
+	m_Stream.Clear();
+}
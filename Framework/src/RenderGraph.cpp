@@ -0,0 +1,740 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <RenderGraph.h>
+#include <Profiler.h>
+#include <algorithm>
+#include <cassert>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t WriteStates = uint32_t(GfxResourceState::RenderTarget) | uint32_t(GfxResourceState::CopyDest); // states the GPU writes in
+
+	//----------------------------------------------------------------------------------------------------
+	// round up to a power of two alignment
+	//----------------------------------------------------------------------------------------------------
+	inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RenderGraph class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+RenderGraph::RenderGraph()
+	: m_pDevice(nullptr)
+	, m_pStates(nullptr)
+	, m_pReleaseQueue(nullptr)
+	, m_PassCount(0)
+	, m_Stats()
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+RenderGraph::~RenderGraph()
+{
+	Term();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 initialization
+//--------------------------------------------------------------------------------------------------------
+bool RenderGraph::Init(GfxDevice* pDevice, ResourceStates* pStates, DeferredReleaseQueue* pReleaseQueue)
+{
+	if (pDevice == nullptr || pStates == nullptr)
+	{
+		return false;
+	}
+
+	Term();
+	m_pDevice = pDevice;
+	m_pStates = pStates;
+	m_pReleaseQueue = pReleaseQueue;
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 termination
+//--------------------------------------------------------------------------------------------------------
+void RenderGraph::Term()
+{
+	for (TransientBuffer& buffer : m_Buffers)
+	{
+		m_pStates->Unregister(buffer.pBuffer.get());
+	}
+
+	// the buffers go before their heap
+	m_Buffers.clear();
+	m_pHeap.reset();
+	m_Passes.clear();
+	m_PassCount = 0;
+	m_Resources.clear();
+	m_Items.clear();
+	m_Jobs.clear();
+	m_Splits.clear();
+	m_Handovers.clear();
+	m_pDevice = nullptr;
+	m_pStates = nullptr;
+	m_pReleaseQueue = nullptr;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 start declaring a frame
+//--------------------------------------------------------------------------------------------------------
+void RenderGraph::Reset()
+{
+	for (uint32_t i = 0; i < m_PassCount; ++i)
+	{
+		m_Passes[i].Execute = nullptr;
+	}
+
+	m_PassCount = 0;
+	m_Resources.clear();
+	m_Items.clear();
+	m_Jobs.clear();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 declare a resource owned outside of the graph
+//--------------------------------------------------------------------------------------------------------
+uint32_t RenderGraph::ImportResource(const char* name, GfxResource* pResource)
+{
+	if (pResource == nullptr)
+	{
+		return InvalidHandle;
+	}
+
+	uint32_t handle = static_cast<uint32_t>(m_Resources.size());
+	m_Resources.push_back(Resource{ name, pResource, 0, true, InvalidHandle, InvalidHandle, handle, TlsfAllocation(), false, InvalidHandle });
+	return handle;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 declare a transient buffer
+//--------------------------------------------------------------------------------------------------------
+uint32_t RenderGraph::CreateBuffer(const char* name, uint64_t size)
+{
+	if (size == 0)
+	{
+		return InvalidHandle;
+	}
+
+	uint32_t handle = static_cast<uint32_t>(m_Resources.size());
+	m_Resources.push_back(Resource{ name, nullptr, size, false, InvalidHandle, InvalidHandle, handle, TlsfAllocation(), false, InvalidHandle });
+	return handle;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 declare a pass
+//--------------------------------------------------------------------------------------------------------
+uint32_t RenderGraph::AddPass(const char* name, ExecuteFunc execute, uint32_t partCount)
+{
+	if (m_PassCount == m_Passes.size())
+	{
+		m_Passes.emplace_back();
+	}
+
+	Pass& pass = m_Passes[m_PassCount];
+	pass.Name = name;
+	pass.Execute = std::move(execute);
+	pass.Uses.clear();
+	pass.PartCount = (partCount > 0) ? partCount : 1;
+	pass.SideEffect = false;
+	pass.Culled = false;
+	return m_PassCount++;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 declare a read of a pass
+//--------------------------------------------------------------------------------------------------------
+void RenderGraph::Read(uint32_t pass, uint32_t resource, GfxResourceState state, uint32_t subresource)
+{
+	AddUse(pass, resource, state, subresource, false);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 declare a write of a pass
+//--------------------------------------------------------------------------------------------------------
+void RenderGraph::Write(uint32_t pass, uint32_t resource, GfxResourceState state, uint32_t subresource)
+{
+	AddUse(pass, resource, state, subresource, true);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 keep a pass whatever happens to its results
+//--------------------------------------------------------------------------------------------------------
+void RenderGraph::SetSideEffect(uint32_t pass)
+{
+	assert(pass < m_PassCount);
+	m_Passes[pass].SideEffect = true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 cull, combine reads, assign transient buffers, split into jobs and place the transitions
+//--------------------------------------------------------------------------------------------------------
+bool RenderGraph::Compile(uint32_t maxListCount, uint64_t fenceValue)
+{
+	PROFILE_SCOPE("CompileRenderGraph");
+	m_Stats = RenderGraphStats();
+	m_Stats.PassCount = m_PassCount;
+	m_Items.clear();
+	m_Jobs.clear();
+	m_Splits.clear();
+	m_Handovers.clear();
+
+	Cull();
+	if (!CombineReads() || !AssignBuffers(fenceValue))
+	{
+		return false;
+	}
+
+	BuildJobs((maxListCount > 0) ? maxListCount : 1);
+	PlaceTransitions();
+
+	for (uint32_t i = 0; i < m_PassCount; ++i)
+	{
+		m_Stats.CulledCount += m_Passes[i].Culled ? 1 : 0;
+	}
+	m_Stats.JobCount = static_cast<uint32_t>(m_Jobs.size());
+	m_Stats.SplitCount = static_cast<uint32_t>(m_Splits.size());
+	m_Stats.HandoverCount = static_cast<uint32_t>(m_Handovers.size());
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 record the jobs in parallel
+//--------------------------------------------------------------------------------------------------------
+void RenderGraph::Record(WorkerPool& workers, CommandListPool& cmdLists, uint32_t frameIndex)
+{
+	PROFILE_SCOPE("RecordRenderGraph");
+	assert(m_Jobs.size() <= cmdLists.GetMaxListCount());
+	cmdLists.Record(workers, frameIndex, static_cast<uint32_t>(m_Jobs.size()), [this, &cmdLists](GfxCommandList* pCmdList, uint32_t listIndex)
+	{
+		RecordJob(cmdLists.GetStateTracker(listIndex), pCmdList, listIndex);
+	});
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 lifetime of a resource in kept passes
+//--------------------------------------------------------------------------------------------------------
+bool RenderGraph::GetLifetime(uint32_t resource, uint32_t& firstPass, uint32_t& lastPass) const
+{
+	const Resource& entry = m_Resources[resource];
+	if (entry.FirstPass == InvalidHandle)
+	{
+		return false;
+	}
+
+	firstPass = entry.FirstPass;
+	lastPass = entry.LastPass;
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 add a resource access to a pass
+//--------------------------------------------------------------------------------------------------------
+void RenderGraph::AddUse(uint32_t pass, uint32_t resource, GfxResourceState state, uint32_t subresource, bool write)
+{
+	if (pass >= m_PassCount || resource >= m_Resources.size())
+	{
+		assert(pass == InvalidHandle || resource == InvalidHandle);
+		return;
+	}
+
+	m_Passes[pass].Uses.push_back(Use{ resource, subresource, state, write });
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 walk back from the last pass, a pass stays when something after it needs what it writes
+//--------------------------------------------------------------------------------------------------------
+void RenderGraph::Cull()
+{
+	// whatever is in an imported resource at the end of the frame is seen outside of the graph
+	m_Needed.assign(m_Resources.size(), false);
+	for (size_t i = 0; i < m_Resources.size(); ++i)
+	{
+		m_Needed[i] = m_Resources[i].Imported;
+	}
+
+	for (uint32_t p = m_PassCount; p-- > 0;)
+	{
+		Pass& pass = m_Passes[p];
+		bool keep = pass.SideEffect;
+		for (const Use& use : pass.Uses)
+		{
+			keep |= use.Write && m_Needed[use.Resource];
+		}
+
+		pass.Culled = !keep;
+		if (!keep)
+		{
+			continue;
+		}
+
+		// a write of the whole transient hides everything written before it, what the pass reads is needed
+		for (const Use& use : pass.Uses)
+		{
+			if (use.Write && use.Subresource == GfxAllSubresources && !m_Resources[use.Resource].Imported)
+			{
+				m_Needed[use.Resource] = false;
+			}
+		}
+		for (const Use& use : pass.Uses)
+		{
+			if (!use.Write)
+			{
+				m_Needed[use.Resource] = true;
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 consecutive reads of a subresource share the combination of their read states
+//--------------------------------------------------------------------------------------------------------
+bool RenderGraph::CombineReads()
+{
+	// m_Needed tells whether a transient has been written so far
+	m_Needed.assign(m_Resources.size(), false);
+	m_LastUses.clear();
+
+	for (uint32_t p = 0; p < m_PassCount; ++p)
+	{
+		if (m_Passes[p].Culled)
+		{
+			continue;
+		}
+
+		for (const Use& use : m_Passes[p].Uses)
+		{
+			LastUse& last = FindLastUse(use.Resource, use.Subresource);
+			if (use.Write)
+			{
+				m_Needed[use.Resource] = true;
+				FinishReadRun(last, p);
+				continue;
+			}
+
+			if (!m_Resources[use.Resource].Imported && !m_Needed[use.Resource])
+			{
+				return false;
+			}
+
+			uint32_t state = static_cast<uint32_t>(use.State);
+			if (last.RunLength == 0)
+			{
+				last.RunStart = p;
+				last.RunState = 0;
+				last.RunCombinable = true;
+			}
+			last.RunLength++;
+			last.RunState |= state;
+			last.RunCombinable &= (state != 0 && (state & WriteStates) == 0);
+		}
+	}
+
+	for (LastUse& last : m_LastUses)
+	{
+		FinishReadRun(last, m_PassCount);
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 give the reads of a run the combined state
+//--------------------------------------------------------------------------------------------------------
+void RenderGraph::FinishReadRun(LastUse& last, uint32_t end)
+{
+	if (last.RunLength > 1 && last.RunCombinable)
+	{
+		GfxResourceState state = static_cast<GfxResourceState>(last.RunState);
+		for (uint32_t p = last.RunStart; p < end; ++p)
+		{
+			if (m_Passes[p].Culled)
+			{
+				continue;
+			}
+
+			for (Use& use : m_Passes[p].Uses)
+			{
+				if (!use.Write && use.Resource == last.Resource && use.Subresource == last.Subresource)
+				{
+					use.State = state;
+				}
+			}
+		}
+	}
+
+	last.RunLength = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 lifetimes of the resources, transients whose lifetimes don't overlap are placed over the same memory
+//--------------------------------------------------------------------------------------------------------
+bool RenderGraph::AssignBuffers(uint64_t fenceValue)
+{
+	for (Resource& resource : m_Resources)
+	{
+		resource.FirstPass = InvalidHandle;
+		resource.LastPass = InvalidHandle;
+		resource.Aliased = false;
+		resource.FirstItem = InvalidHandle;
+	}
+
+	for (uint32_t p = 0; p < m_PassCount; ++p)
+	{
+		if (m_Passes[p].Culled)
+		{
+			continue;
+		}
+
+		for (const Use& use : m_Passes[p].Uses)
+		{
+			Resource& resource = m_Resources[use.Resource];
+			resource.FirstPass = (resource.FirstPass == InvalidHandle) ? p : resource.FirstPass;
+			resource.LastPass = p;
+		}
+	}
+
+	m_Order.clear();
+	uint64_t totalSize = 0;
+	for (uint32_t i = 0; i < m_Resources.size(); ++i)
+	{
+		if (!m_Resources[i].Imported && m_Resources[i].FirstPass != InvalidHandle)
+		{
+			m_Order.push_back(i);
+			totalSize += AlignUp(m_Resources[i].Size, GfxPlacementAlignment);
+		}
+	}
+	std::sort(m_Order.begin(), m_Order.end(), [this](uint32_t a, uint32_t b)
+	{
+		return m_Resources[a].FirstPass < m_Resources[b].FirstPass;
+	});
+
+	// ranges of the transients that are over before the next one starts are handed out again; the sum of
+	// the sizes is enough for the plan to always succeed, the heap only needs the highest end
+	m_Placement.Reset(totalSize, GfxPlacementAlignment);
+	m_Active.clear();
+	m_Pages.assign(static_cast<size_t>(totalSize / GfxPlacementAlignment), uint32_t(InvalidHandle));
+	uint64_t heapSize = 0;
+	for (uint32_t index : m_Order)
+	{
+		Resource& resource = m_Resources[index];
+		for (size_t a = 0; a < m_Active.size();)
+		{
+			if (m_Resources[m_Active[a]].LastPass < resource.FirstPass)
+			{
+				TlsfAllocation range = m_Resources[m_Active[a]].Range;
+				m_Placement.Free(range);
+				m_Active[a] = m_Active.back();
+				m_Active.pop_back();
+			}
+			else
+			{
+				++a;
+			}
+		}
+
+		if (!m_Placement.Allocate(resource.Size, GfxPlacementAlignment, resource.Range))
+		{
+			return false;
+		}
+		m_Active.push_back(index);
+		heapSize = std::max(heapSize, resource.Range.Offset + resource.Range.Size);
+
+		// another buffer was on part of the range before (the same range and size is the same buffer)
+		size_t firstPage = static_cast<size_t>(resource.Range.Offset / GfxPlacementAlignment);
+		size_t endPage = static_cast<size_t>((resource.Range.Offset + resource.Range.Size) / GfxPlacementAlignment);
+		for (size_t page = firstPage; page < endPage; ++page)
+		{
+			uint32_t last = m_Pages[page];
+			resource.Aliased |= (last != InvalidHandle)
+				&& (m_Resources[last].Range.Offset != resource.Range.Offset || m_Resources[last].Size != resource.Size);
+			m_Pages[page] = index;
+		}
+		m_Stats.AliasCount += resource.Aliased ? 1 : 0;
+	}
+
+	// a larger plan replaces the heap and every buffer placed in it
+	if (heapSize > 0 && (m_pHeap == nullptr || m_pHeap->GetSize() < heapSize))
+	{
+		for (TransientBuffer& buffer : m_Buffers)
+		{
+			ReleaseBuffer(buffer, fenceValue);
+		}
+		m_Buffers.clear();
+
+		if (m_pHeap != nullptr)
+		{
+			uint64_t size = m_pHeap->GetSize();
+			if (m_pReleaseQueue != nullptr)
+			{
+				m_pReleaseQueue->Release(std::move(m_pHeap), fenceValue, size);
+			}
+			m_pHeap.reset();
+		}
+
+		GfxHeapDesc desc = { heapSize, GfxHeapType::Default };
+		if (!m_pDevice->CreateHeap(desc, m_pHeap))
+		{
+			return false;
+		}
+	}
+	m_Stats.TransientHeapSize = (m_pHeap != nullptr) ? m_pHeap->GetSize() : 0;
+
+	for (TransientBuffer& buffer : m_Buffers)
+	{
+		buffer.Used = false;
+	}
+
+	// a buffer is kept for each range and size, transients on the same one share its states
+	for (uint32_t index : m_Order)
+	{
+		Resource& resource = m_Resources[index];
+		TransientBuffer* pBuffer = nullptr;
+		for (TransientBuffer& buffer : m_Buffers)
+		{
+			if (buffer.Offset == resource.Range.Offset && buffer.Size == resource.Size)
+			{
+				pBuffer = &buffer;
+				break;
+			}
+		}
+
+		if (pBuffer == nullptr)
+		{
+			TransientBuffer buffer;
+			GfxBufferDesc desc = { resource.Size, GfxHeapType::Default, GfxResourceState::Common };
+			if (!m_pDevice->CreatePlacedBuffer(m_pHeap.get(), resource.Range.Offset, desc, buffer.pBuffer))
+			{
+				return false;
+			}
+
+			m_pStates->Register(buffer.pBuffer.get(), GfxResourceState::Common);
+			buffer.Offset = resource.Range.Offset;
+			buffer.Size = resource.Size;
+			buffer.Used = false;
+			m_Buffers.push_back(std::move(buffer));
+			pBuffer = &m_Buffers.back();
+		}
+
+		if (!pBuffer->Used)
+		{
+			pBuffer->Used = true;
+			pBuffer->Owner = index;
+			m_Stats.TransientBufferCount++;
+		}
+		m_Stats.TransientCount++;
+		resource.pResource = pBuffer->pBuffer.get();
+		resource.Storage = pBuffer->Owner;
+	}
+
+	// buffers no resource of the frame is on anymore
+	for (size_t b = 0; b < m_Buffers.size();)
+	{
+		if (!m_Buffers[b].Used)
+		{
+			ReleaseBuffer(m_Buffers[b], fenceValue);
+			m_Buffers[b] = std::move(m_Buffers.back());
+			m_Buffers.pop_back();
+		}
+		else
+		{
+			++b;
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 release a transient buffer once the GPU is done with the frames before fenceValue
+//--------------------------------------------------------------------------------------------------------
+void RenderGraph::ReleaseBuffer(TransientBuffer& buffer, uint64_t fenceValue)
+{
+	m_pStates->Unregister(buffer.pBuffer.get());
+	if (m_pReleaseQueue != nullptr)
+	{
+		m_pReleaseQueue->Release(std::move(buffer.pBuffer), fenceValue, buffer.Size);
+	}
+	buffer.pBuffer.reset();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 one job per command list: serial passes join the current job, every further part of a pass opens one
+//--------------------------------------------------------------------------------------------------------
+void RenderGraph::BuildJobs(uint32_t maxListCount)
+{
+	// parts are taken from the widest passes until the jobs fit into the command lists
+	uint32_t jobCount = 1;
+	for (uint32_t p = 0; p < m_PassCount; ++p)
+	{
+		jobCount += m_Passes[p].Culled ? 0 : m_Passes[p].PartCount - 1;
+	}
+
+	while (jobCount > maxListCount)
+	{
+		Pass* pWidest = nullptr;
+		for (uint32_t p = 0; p < m_PassCount; ++p)
+		{
+			Pass& pass = m_Passes[p];
+			if (!pass.Culled && (pWidest == nullptr || pass.PartCount > pWidest->PartCount))
+			{
+				pWidest = &pass;
+			}
+		}
+		pWidest->PartCount--;
+		jobCount--;
+	}
+
+	for (uint32_t p = 0; p < m_PassCount; ++p)
+	{
+		if (m_Passes[p].Culled)
+		{
+			continue;
+		}
+
+		for (uint32_t part = 0; part < m_Passes[p].PartCount; ++part)
+		{
+			if (m_Jobs.empty() || part > 0)
+			{
+				m_Jobs.push_back(Job{ static_cast<uint32_t>(m_Items.size()), 0 });
+			}
+			m_Items.push_back(Item{ p, part });
+			m_Jobs.back().ItemCount++;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 transitions ahead of the next use: split barriers within a job, handovers between jobs
+//--------------------------------------------------------------------------------------------------------
+void RenderGraph::PlaceTransitions()
+{
+	m_LastUses.clear();
+	for (uint32_t j = 0; j < m_Jobs.size(); ++j)
+	{
+		const Job& job = m_Jobs[j];
+		for (uint32_t i = job.FirstItem; i < job.FirstItem + job.ItemCount; ++i)
+		{
+			uint32_t pass = m_Items[i].Pass;
+			for (const Use& use : m_Passes[pass].Uses)
+			{
+				Resource& resource = m_Resources[use.Resource];
+				resource.FirstItem = (resource.FirstItem == InvalidHandle) ? i : resource.FirstItem;
+
+				// transients sharing a buffer are one resource to the GPU; the first job knows the committed
+				// states, a first use further down is prepared in it
+				LastUse& last = FindLastUse(m_Resources[use.Resource].Storage, use.Subresource);
+				if (last.Item == InvalidHandle && j > 0)
+				{
+					m_Handovers.push_back(Transition{ 0, use.Resource, use.Subresource, use.State });
+				}
+				else if (last.Item != InvalidHandle && last.State != use.State)
+				{
+					// the list that starts with the use only expects the exact state, so covering read states
+					// are handed over as well
+					Transition transition = { 0, use.Resource, use.Subresource, use.State };
+					if (last.Job != j)
+					{
+						transition.Index = last.Job;
+						m_Handovers.push_back(transition);
+					}
+					else if (last.Item + 1 < i && m_Items[last.Item].Pass != pass)
+					{
+						transition.Index = last.Item;
+						m_Splits.push_back(transition);
+					}
+				}
+
+				last.Item = i;
+				last.Job = j;
+				last.State = use.State;
+			}
+		}
+	}
+
+	// a subresource is transitioned at most once per item or job, the order among them doesn't matter
+	auto byIndex = [](const Transition& a, const Transition& b) { return a.Index < b.Index; };
+	std::sort(m_Splits.begin(), m_Splits.end(), byIndex);
+	std::sort(m_Handovers.begin(), m_Handovers.end(), byIndex);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 latest access of a subresource (a graph uses a handful of resources, a linear search is enough)
+//--------------------------------------------------------------------------------------------------------
+RenderGraph::LastUse& RenderGraph::FindLastUse(uint32_t resource, uint32_t subresource)
+{
+	for (LastUse& last : m_LastUses)
+	{
+		if (last.Resource == resource && last.Subresource == subresource)
+		{
+			return last;
+		}
+	}
+
+	m_LastUses.push_back(LastUse{ resource, subresource, InvalidHandle, InvalidHandle, GfxResourceState::Common, 0, 0, 0, false });
+	return m_LastUses.back();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 record the items of a job (called on worker threads)
+//--------------------------------------------------------------------------------------------------------
+void RenderGraph::RecordJob(ResourceStateTracker* pTracker, GfxCommandList* pCmdList, uint32_t jobIndex)
+{
+	assert(pTracker != nullptr);
+	const Job& job = m_Jobs[jobIndex];
+	auto byIndex = [](const Transition& transition, uint32_t index) { return transition.Index < index; };
+	auto split = std::lower_bound(m_Splits.begin(), m_Splits.end(), job.FirstItem, byIndex);
+
+	for (uint32_t i = job.FirstItem; i < job.FirstItem + job.ItemCount; ++i)
+	{
+		const Pass& pass = m_Passes[m_Items[i].Pass];
+		PROFILE_SCOPE(pass.Name);
+
+		// the first use of a buffer over memory of an earlier one starts with an aliasing barrier
+		for (size_t u = 0; u < pass.Uses.size(); ++u)
+		{
+			const Resource& resource = m_Resources[pass.Uses[u].Resource];
+			bool first = std::none_of(pass.Uses.begin(), pass.Uses.begin() + u, [&pass, u](const Use& use) { return use.Resource == pass.Uses[u].Resource; });
+			if (resource.Aliased && resource.FirstItem == i && first)
+			{
+				pTracker->AliasingBarrier(resource.pResource);
+			}
+		}
+
+		for (const Use& use : pass.Uses)
+		{
+			pTracker->Transition(m_Resources[use.Resource].pResource, use.State, use.Subresource);
+		}
+		pTracker->FlushBarriers(pCmdList);
+
+		pass.Execute(pCmdList, m_Items[i].Part, pass.PartCount);
+
+		// the GPU may start on the transition while the passes in between run
+		for (; split != m_Splits.end() && split->Index == i; ++split)
+		{
+			pTracker->BeginTransition(m_Resources[split->Resource].pResource, split->State, split->Subresource);
+		}
+	}
+
+	// states later lists start with (CommandListPool flushes them before closing the list)
+	auto handover = std::lower_bound(m_Handovers.begin(), m_Handovers.end(), jobIndex, byIndex);
+	for (; handover != m_Handovers.end() && handover->Index == jobIndex; ++handover)
+	{
+		pTracker->Transition(m_Resources[handover->Resource].pResource, handover->State, handover->Subresource);
+	}
+}
@@ -0,0 +1,515 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <ResourceStateTracker.h>
+#include <cassert>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint32_t WriteStates = uint32_t(GfxResourceState::RenderTarget) | uint32_t(GfxResourceState::CopyDest); // states the GPU writes in
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ResourceStates class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+ResourceStates::ResourceStates()
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+ResourceStates::~ResourceStates()
+{
+	Clear();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 start tracking a resource
+//--------------------------------------------------------------------------------------------------------
+void ResourceStates::Register(GfxResource* pResource, GfxResourceState state, uint32_t subresourceCount)
+{
+	assert(pResource != nullptr);
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_States[pResource].assign((subresourceCount > 0) ? subresourceCount : 1, state);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 stop tracking a resource
+//--------------------------------------------------------------------------------------------------------
+void ResourceStates::Unregister(GfxResource* pResource)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_States.erase(pResource);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 stop tracking every resource
+//--------------------------------------------------------------------------------------------------------
+void ResourceStates::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_States.clear();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 number of subresources tracked
+//--------------------------------------------------------------------------------------------------------
+uint32_t ResourceStates::GetSubresourceCount(GfxResource* pResource) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto itr = m_States.find(pResource);
+	return (itr != m_States.end()) ? static_cast<uint32_t>(itr->second.size()) : 1;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 committed state of a subresource
+//--------------------------------------------------------------------------------------------------------
+bool ResourceStates::GetState(GfxResource* pResource, uint32_t subresource, GfxResourceState& state) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto itr = m_States.find(pResource);
+	uint32_t index = (subresource == GfxAllSubresources) ? 0 : subresource;
+	if (itr == m_States.end() || index >= itr->second.size())
+	{
+		return false;
+	}
+
+	state = itr->second[index];
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 barriers in front of a submitted list, then its final states become the committed ones
+//--------------------------------------------------------------------------------------------------------
+void ResourceStates::Resolve(const ResourceStateTracker& tracker, std::vector<GfxResourceBarrier>& fixups)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	// the list assumed exactly the state of its first use (a covering read state would make its own
+	// barriers start from the wrong state), so only equal states go without a barrier
+	for (const GfxResourceBarrier& pending : tracker.m_Pending)
+	{
+		auto itr = m_States.find(pending.pResource);
+		if (itr == m_States.end())
+		{
+			continue;
+		}
+
+		std::vector<GfxResourceState>& states = itr->second;
+		GfxResourceBarrier fixup = {};
+		fixup.pResource = pending.pResource;
+		fixup.StateAfter = pending.StateAfter;
+
+		if (pending.Subresource != GfxAllSubresources)
+		{
+			if (pending.Subresource < states.size() && states[pending.Subresource] != pending.StateAfter)
+			{
+				fixup.Subresource = pending.Subresource;
+				fixup.StateBefore = states[pending.Subresource];
+				fixups.push_back(fixup);
+			}
+			continue;
+		}
+
+		// one barrier for the whole resource while its subresources agree
+		bool uniform = true;
+		for (GfxResourceState state : states)
+		{
+			uniform &= (state == states[0]);
+		}
+
+		if (uniform)
+		{
+			if (states[0] != pending.StateAfter)
+			{
+				fixup.Subresource = GfxAllSubresources;
+				fixup.StateBefore = states[0];
+				fixups.push_back(fixup);
+			}
+			continue;
+		}
+
+		for (uint32_t i = 0; i < states.size(); ++i)
+		{
+			if (states[i] != pending.StateAfter)
+			{
+				fixup.Subresource = i;
+				fixup.StateBefore = states[i];
+				fixups.push_back(fixup);
+			}
+		}
+	}
+
+	// states the list leaves behind
+	for (uint32_t i = 0; i < tracker.m_EntryCount; ++i)
+	{
+		const ResourceStateTracker::Entry& entry = tracker.m_Entries[i];
+		auto itr = m_States.find(entry.pResource);
+		if (itr == m_States.end())
+		{
+			continue;
+		}
+
+		std::vector<GfxResourceState>& states = itr->second;
+		size_t count = (states.size() < entry.Subresources.size()) ? states.size() : entry.Subresources.size();
+		for (size_t j = 0; j < count; ++j)
+		{
+			if (entry.Subresources[j].Flags & ResourceStateTracker::StateKnown)
+			{
+				states[j] = entry.Subresources[j].State;
+			}
+		}
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ResourceStateTracker class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+ResourceStateTracker::ResourceStateTracker()
+	: m_pStates(nullptr)
+	, m_KnownAtStart(false)
+	, m_EntryCount(0)
+	, m_Stats()
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+ResourceStateTracker::~ResourceStateTracker()
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 start of a command list (barriers queued and not flushed are dropped)
+//--------------------------------------------------------------------------------------------------------
+void ResourceStateTracker::Reset(ResourceStates* pStates, bool knownAtStart)
+{
+	m_pStates = pStates;
+	m_KnownAtStart = knownAtStart && (pStates != nullptr);
+	m_EntryCount = 0;
+	m_Queued.clear();
+	m_Pending.clear();
+	m_Stats = ResourceBarrierStats();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 queue a transition
+//--------------------------------------------------------------------------------------------------------
+void ResourceStateTracker::Transition(GfxResource* pResource, GfxResourceState state, uint32_t subresource)
+{
+	Entry& entry = FindEntry(pResource);
+	uint32_t count = static_cast<uint32_t>(entry.Subresources.size());
+	if (count == 1 || subresource != GfxAllSubresources)
+	{
+		TransitionSubresource(entry, (count == 1) ? 0 : subresource, state, GfxResourceBarrierFlags::None);
+		return;
+	}
+
+	// a whole resource used for the first time stays a single pending barrier
+	if (!m_KnownAtStart)
+	{
+		bool unknown = true;
+		for (const SubresourceState& sub : entry.Subresources)
+		{
+			unknown &= (sub.Flags == 0);
+		}
+
+		if (unknown)
+		{
+			m_Pending.push_back(GfxResourceBarrier{ pResource, GfxAllSubresources, GfxResourceState::Common, state, GfxResourceBarrierFlags::None, GfxResourceBarrierType::Transition });
+			for (SubresourceState& sub : entry.Subresources)
+			{
+				sub.State = state;
+				sub.Flags = StateKnown;
+			}
+			return;
+		}
+	}
+
+	// subresources in the same state share one barrier for the whole resource
+	bool uniform = true;
+	for (SubresourceState& sub : entry.Subresources)
+	{
+		if (sub.Flags == 0 && m_KnownAtStart)
+		{
+			sub.Flags = m_pStates->GetState(pResource, uint32_t(&sub - entry.Subresources.data()), sub.State) ? StateKnown : 0;
+		}
+		uniform &= (sub.Flags == StateKnown && sub.State == entry.Subresources[0].State);
+	}
+
+	if (!uniform)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			TransitionSubresource(entry, i, state, GfxResourceBarrierFlags::None);
+		}
+		return;
+	}
+
+	GfxResourceState current = entry.Subresources[0].State;
+	if (IsCovered(current, state))
+	{
+		m_Stats.ElidedCount++;
+		return;
+	}
+
+	Queue(pResource, GfxAllSubresources, current, state, GfxResourceBarrierFlags::None);
+	for (SubresourceState& sub : entry.Subresources)
+	{
+		sub.State = state;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 begin a split barrier
+//--------------------------------------------------------------------------------------------------------
+void ResourceStateTracker::BeginTransition(GfxResource* pResource, GfxResourceState state, uint32_t subresource)
+{
+	Entry& entry = FindEntry(pResource);
+	uint32_t count = static_cast<uint32_t>(entry.Subresources.size());
+	if (count == 1 || subresource != GfxAllSubresources)
+	{
+		TransitionSubresource(entry, (count == 1) ? 0 : subresource, state, GfxResourceBarrierFlags::BeginOnly);
+		return;
+	}
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		TransitionSubresource(entry, i, state, GfxResourceBarrierFlags::BeginOnly);
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 end a split barrier
+//--------------------------------------------------------------------------------------------------------
+void ResourceStateTracker::EndTransition(GfxResource* pResource, uint32_t subresource)
+{
+	Entry& entry = FindEntry(pResource);
+	uint32_t count = static_cast<uint32_t>(entry.Subresources.size());
+	uint32_t first = (count == 1 || subresource == GfxAllSubresources) ? 0 : subresource;
+	uint32_t last = (count == 1 || subresource == GfxAllSubresources) ? count : subresource + 1;
+	for (uint32_t i = first; i < last; ++i)
+	{
+		if (entry.Subresources[i].Flags & StateSplit)
+		{
+			EndSplit(entry, i);
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 record the queued barriers
+//--------------------------------------------------------------------------------------------------------
+void ResourceStateTracker::FlushBarriers(GfxCommandList* pCmdList)
+{
+	if (m_Queued.empty())
+	{
+		return;
+	}
+
+	pCmdList->ResourceBarrier(static_cast<uint32_t>(m_Queued.size()), m_Queued.data());
+	m_Stats.BarrierCount += m_Queued.size();
+	m_Stats.BatchCount++;
+	m_Queued.clear();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 placed resource starting to use memory of others, goes out with the next flush in queue order
+//--------------------------------------------------------------------------------------------------------
+void ResourceStateTracker::AliasingBarrier(GfxResource* pResourceAfter)
+{
+	GfxResourceBarrier barrier = {};
+	barrier.pResource = pResourceAfter;
+	barrier.Subresource = GfxAllSubresources;
+	barrier.Type = GfxResourceBarrierType::Aliasing;
+	m_Queued.push_back(barrier);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 state of a subresource within the list
+//--------------------------------------------------------------------------------------------------------
+bool ResourceStateTracker::GetState(GfxResource* pResource, uint32_t subresource, GfxResourceState& state) const
+{
+	const Entry* pEntry = FindEntry(pResource);
+	uint32_t index = (subresource == GfxAllSubresources) ? 0 : subresource;
+	if (pEntry == nullptr || index >= pEntry->Subresources.size() || (pEntry->Subresources[index].Flags & StateKnown) == 0)
+	{
+		return false;
+	}
+
+	state = pEntry->Subresources[index].State;
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 whether a resource in state current can be used as requested without a barrier
+//--------------------------------------------------------------------------------------------------------
+bool ResourceStateTracker::IsCovered(GfxResourceState current, GfxResourceState requested)
+{
+	uint32_t c = static_cast<uint32_t>(current);
+	uint32_t r = static_cast<uint32_t>(requested);
+	if (c == r)
+	{
+		return true;
+	}
+
+	// a combined read state serves each of its read states, a write state only itself
+	return r != 0 && (c & r) == r && (c & WriteStates) == 0;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 entry of a resource, added on first use (lists touch few resources, a linear search is enough)
+//--------------------------------------------------------------------------------------------------------
+ResourceStateTracker::Entry& ResourceStateTracker::FindEntry(GfxResource* pResource)
+{
+	for (uint32_t i = 0; i < m_EntryCount; ++i)
+	{
+		if (m_Entries[i].pResource == pResource)
+		{
+			return m_Entries[i];
+		}
+	}
+
+	if (m_EntryCount == m_Entries.size())
+	{
+		m_Entries.emplace_back();
+	}
+
+	Entry& entry = m_Entries[m_EntryCount++];
+	uint32_t count = (m_pStates != nullptr) ? m_pStates->GetSubresourceCount(pResource) : 1;
+	entry.pResource = pResource;
+	entry.Subresources.assign(count, SubresourceState{ GfxResourceState::Common, GfxResourceState::Common, 0 });
+	return entry;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 entry of a resource or nullptr
+//--------------------------------------------------------------------------------------------------------
+const ResourceStateTracker::Entry* ResourceStateTracker::FindEntry(GfxResource* pResource) const
+{
+	for (uint32_t i = 0; i < m_EntryCount; ++i)
+	{
+		if (m_Entries[i].pResource == pResource)
+		{
+			return &m_Entries[i];
+		}
+	}
+	return nullptr;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 transition of one subresource (BeginOnly starts a split barrier)
+//--------------------------------------------------------------------------------------------------------
+void ResourceStateTracker::TransitionSubresource(Entry& entry, uint32_t index, GfxResourceState state, GfxResourceBarrierFlags flags)
+{
+	assert(index < entry.Subresources.size());
+	SubresourceState& sub = entry.Subresources[index];
+	uint32_t subresource = (entry.Subresources.size() == 1) ? GfxAllSubresources : index;
+
+	// first use, the state before is the committed one for the first list and unknown for the others
+	if ((sub.Flags & StateKnown) == 0)
+	{
+		if (m_KnownAtStart && m_pStates->GetState(entry.pResource, index, sub.State))
+		{
+			sub.Flags = StateKnown;
+		}
+		else
+		{
+			m_Pending.push_back(GfxResourceBarrier{ entry.pResource, subresource, GfxResourceState::Common, state, GfxResourceBarrierFlags::None, GfxResourceBarrierType::Transition });
+			sub.State = state;
+			sub.Flags = StateKnown;
+			return;
+		}
+	}
+
+	// a split barrier to the requested state is simply ended, any other transition ends it first
+	if (sub.Flags & StateSplit)
+	{
+		bool done = (flags == GfxResourceBarrierFlags::None && sub.State == state);
+		EndSplit(entry, index);
+		if (done)
+		{
+			return;
+		}
+	}
+
+	if (IsCovered(sub.State, state))
+	{
+		m_Stats.ElidedCount++;
+		return;
+	}
+
+	Queue(entry.pResource, subresource, sub.State, state, flags);
+	if (flags == GfxResourceBarrierFlags::BeginOnly)
+	{
+		sub.SplitBefore = sub.State;
+		sub.Flags |= StateSplit;
+	}
+	sub.State = state;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 second half of a split barrier
+//--------------------------------------------------------------------------------------------------------
+void ResourceStateTracker::EndSplit(Entry& entry, uint32_t index)
+{
+	SubresourceState& sub = entry.Subresources[index];
+	uint32_t subresource = (entry.Subresources.size() == 1) ? GfxAllSubresources : index;
+	Queue(entry.pResource, subresource, sub.SplitBefore, sub.State, GfxResourceBarrierFlags::EndOnly);
+	sub.Flags &= ~StateSplit;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 add a barrier to the next flush, merged with a queued one of the same subresource
+//--------------------------------------------------------------------------------------------------------
+void ResourceStateTracker::Queue(GfxResource* pResource, uint32_t subresource, GfxResourceState before, GfxResourceState after, GfxResourceBarrierFlags flags)
+{
+	if (flags == GfxResourceBarrierFlags::None)
+	{
+		// only the latest queued barrier of the resource may be merged, earlier ones are ordered before it
+		for (size_t i = m_Queued.size(); i-- > 0;)
+		{
+			GfxResourceBarrier& queued = m_Queued[i];
+			if (queued.pResource != pResource)
+			{
+				continue;
+			}
+
+			if (queued.Type == GfxResourceBarrierType::Transition && queued.Subresource == subresource
+				&& queued.Flags == GfxResourceBarrierFlags::None && queued.StateAfter == before)
+			{
+				m_Stats.ElidedCount++;
+				queued.StateAfter = after;
+				if (queued.StateBefore == after)
+				{
+					m_Stats.ElidedCount++;
+					m_Queued.erase(m_Queued.begin() + i);
+				}
+				return;
+			}
+			break;
+		}
+	}
+
+	m_Queued.push_back(GfxResourceBarrier{ pResource, subresource, before, after, flags, GfxResourceBarrierType::Transition });
+}
@@ -0,0 +1,381 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <ShaderStore.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+
+namespace /* anonymous */ {
+
+	// the header and the table are read in place from the mapping, their layout must not depend on the compiler
+	static_assert(sizeof(ShaderStoreHeader) == 32, "ShaderStoreHeader layout changed, bump ShaderStoreVersion");
+	static_assert(sizeof(ShaderStoreEntry) == 32, "ShaderStoreEntry layout changed, bump ShaderStoreVersion");
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const uint64_t FnvOffsetBasis = 0xcbf29ce484222325ull; // FNV-1a 64-bit start value (keys are stored in files)
+	const uint64_t FnvPrime = 0x100000001b3ull; // FNV-1a 64-bit multiplier
+
+	//----------------------------------------------------------------------------------------------------
+	// offset rounded up to the placement of blobs and the table
+	//----------------------------------------------------------------------------------------------------
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return (offset + ShaderStoreAlignment - 1) & ~(ShaderStoreAlignment - 1);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// zeros up to the next placement boundary
+	//----------------------------------------------------------------------------------------------------
+	void WritePadding(std::ofstream& file, uint64_t& offset)
+	{
+		static const char Zeros[ShaderStoreAlignment] = {};
+		uint64_t aligned = AlignOffset(offset);
+		file.write(Zeros, static_cast<std::streamsize>(aligned - offset));
+		offset = aligned;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// whole file into memory
+	//----------------------------------------------------------------------------------------------------
+	bool ReadWholeFile(const char* path, std::vector<uint8_t>& data)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			return false;
+		}
+
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0, std::ios::beg);
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())));
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ShaderStore class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+ShaderStore::ShaderStore()
+	: m_pHeader(nullptr)
+	, m_pEntries(nullptr)
+	, m_Generation(0)
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 map and validate a packed file
+//--------------------------------------------------------------------------------------------------------
+bool ShaderStore::Open(const char* path)
+{
+	Close();
+
+	// lookups jump around the table and the blobs
+	if (!m_File.Open(path, false))
+	{
+		return false;
+	}
+
+	if (!Validate())
+	{
+		m_File.Close();
+		return false;
+	}
+
+	m_pHeader = reinterpret_cast<const ShaderStoreHeader*>(m_File.GetData());
+	m_pEntries = reinterpret_cast<const ShaderStoreEntry*>(m_File.GetData() + m_pHeader->EntriesOffset);
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 unmap
+//--------------------------------------------------------------------------------------------------------
+void ShaderStore::Close()
+{
+	m_pHeader = nullptr;
+	m_pEntries = nullptr;
+	m_File.Close();
+	m_Overrides.clear();
+	m_Watches.clear();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 read a loose bytecode file
+//--------------------------------------------------------------------------------------------------------
+bool ShaderStore::LoadFile(const char* pName, const char* pBytecodePath)
+{
+	std::vector<uint8_t> bytecode;
+	if (!ReadWholeFile(pBytecodePath, bytecode))
+	{
+		return false;
+	}
+
+	m_Overrides[ComputePermutationKey(pName)] = std::move(bytecode);
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 bytecode of the permutation
+//--------------------------------------------------------------------------------------------------------
+GfxShaderBytecode ShaderStore::Find(uint64_t permutationKey) const
+{
+	if (!m_Overrides.empty())
+	{
+		auto it = m_Overrides.find(permutationKey);
+		if (it != m_Overrides.end())
+		{
+			return GfxShaderBytecode{ it->second.data(), it->second.size() };
+		}
+	}
+
+	if (m_pHeader == nullptr)
+	{
+		return GfxShaderBytecode{ nullptr, 0 };
+	}
+
+	const ShaderStoreEntry* pEnd = m_pEntries + m_pHeader->EntryCount;
+	const ShaderStoreEntry* pEntry = std::lower_bound(m_pEntries, pEnd, permutationKey,
+		[](const ShaderStoreEntry& entry, uint64_t key) { return entry.PermutationKey < key; });
+	if (pEntry == pEnd || pEntry->PermutationKey != permutationKey)
+	{
+		return GfxShaderBytecode{ nullptr, 0 };
+	}
+
+	return GfxShaderBytecode{ m_File.GetData() + pEntry->Offset, static_cast<size_t>(pEntry->Size) };
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 watch the source of a permutation
+//--------------------------------------------------------------------------------------------------------
+void ShaderStore::AddWatch(const char* pName, const char* pSourcePath, const char* pBytecodePath, const char* pCompileCommand)
+{
+	// a source which doesn't exist yet is picked up once it appears
+	Watch watch;
+	std::error_code error;
+	watch.PermutationKey = ComputePermutationKey(pName);
+	watch.SourcePath = pSourcePath;
+	watch.BytecodePath = pBytecodePath;
+	watch.CompileCommand = (pCompileCommand != nullptr) ? pCompileCommand : "";
+	watch.LastWrite = std::filesystem::last_write_time(watch.SourcePath, error);
+	if (error)
+	{
+		watch.LastWrite = std::filesystem::file_time_type::min();
+	}
+	m_Watches.push_back(std::move(watch));
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 rebuild changed sources and swap in their bytecode
+//--------------------------------------------------------------------------------------------------------
+uint32_t ShaderStore::PollChanges()
+{
+	uint32_t reloadCount = 0;
+	for (Watch& watch : m_Watches)
+	{
+		std::error_code error;
+		std::filesystem::file_time_type lastWrite = std::filesystem::last_write_time(watch.SourcePath, error);
+		if (error || lastWrite == watch.LastWrite)
+		{
+			continue;
+		}
+		watch.LastWrite = lastWrite;
+
+		// a failed build keeps the bytecode which works
+		if (!watch.CompileCommand.empty() && std::system(watch.CompileCommand.c_str()) != 0)
+		{
+			continue;
+		}
+
+		std::vector<uint8_t> bytecode;
+		if (!ReadWholeFile(watch.BytecodePath.c_str(), bytecode) || bytecode.empty())
+		{
+			continue;
+		}
+
+		// saving a source without changing the output keeps every pipeline built from it
+		GfxShaderBytecode current = Find(watch.PermutationKey);
+		if (current.BytecodeLength == bytecode.size()
+			&& ComputeContentHash(current.pShaderBytecode, current.BytecodeLength) == ComputeContentHash(bytecode.data(), bytecode.size()))
+		{
+			continue;
+		}
+
+		m_Overrides[watch.PermutationKey] = std::move(bytecode);
+		reloadCount++;
+	}
+
+	m_Generation += (reloadCount > 0) ? 1 : 0;
+	return reloadCount;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 key of a permutation name
+//--------------------------------------------------------------------------------------------------------
+uint64_t ShaderStore::ComputePermutationKey(const char* pName)
+{
+	uint64_t hash = FnvOffsetBasis;
+	for (const char* p = pName; *p != '\0'; ++p)
+	{
+		hash = (hash ^ static_cast<uint8_t>(*p)) * FnvPrime;
+	}
+	return hash;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 hash of bytecode (8 bytes per step, the shift carries high bits down into later steps)
+//--------------------------------------------------------------------------------------------------------
+uint64_t ShaderStore::ComputeContentHash(const void* pData, size_t size)
+{
+	const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+	uint64_t hash = FnvOffsetBasis ^ size;
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+	{
+		uint64_t word;
+		memcpy(&word, pBytes + i, sizeof(word));
+		hash = (hash ^ word) * FnvPrime;
+		hash ^= hash >> 32;
+	}
+
+	for (; i < size; ++i)
+	{
+		hash = (hash ^ pBytes[i]) * FnvPrime;
+	}
+	return hash;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 write a packed file
+//--------------------------------------------------------------------------------------------------------
+bool ShaderStore::Write(const char* path, const ShaderStoreSource* pSources, uint32_t count)
+{
+	// table sorted by permutation key, names must not collide
+	std::vector<ShaderStoreEntry> entries(count);
+	std::vector<uint32_t> sourceOfEntry(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		entries[i].PermutationKey = ComputePermutationKey(pSources[i].pName);
+		entries[i].ContentHash = ComputeContentHash(pSources[i].pBytecode, pSources[i].Size);
+		entries[i].Size = pSources[i].Size;
+		sourceOfEntry[i] = i;
+	}
+
+	std::sort(sourceOfEntry.begin(), sourceOfEntry.end(), [&entries](uint32_t a, uint32_t b) { return entries[a].PermutationKey < entries[b].PermutationKey; });
+	for (uint32_t i = 1; i < count; ++i)
+	{
+		if (entries[sourceOfEntry[i - 1]].PermutationKey == entries[sourceOfEntry[i]].PermutationKey)
+		{
+			return false;
+		}
+	}
+
+	// header, blobs (each distinct content once), table
+	std::unordered_map<uint64_t, uint32_t> blobOfContent;
+	std::vector<uint32_t> blobSources;
+	uint64_t offset = AlignOffset(sizeof(ShaderStoreHeader));
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		ShaderStoreEntry& entry = entries[i];
+		auto it = blobOfContent.find(entry.ContentHash);
+		if (it != blobOfContent.end())
+		{
+			// equal hashes of different bytecode would alias two permutations
+			const ShaderStoreSource& blob = pSources[blobSources[it->second]];
+			if (blob.Size != pSources[i].Size || memcmp(blob.pBytecode, pSources[i].pBytecode, blob.Size) != 0)
+			{
+				return false;
+			}
+			entry.Offset = entries[blobSources[it->second]].Offset;
+			continue;
+		}
+
+		blobOfContent.emplace(entry.ContentHash, static_cast<uint32_t>(blobSources.size()));
+		blobSources.push_back(i);
+		entry.Offset = offset;
+		offset = AlignOffset(offset + entry.Size);
+	}
+
+	ShaderStoreHeader header = {};
+	header.Magic = ShaderStoreMagic;
+	header.Version = ShaderStoreVersion;
+	header.EntryCount = count;
+	header.BlobCount = static_cast<uint32_t>(blobSources.size());
+	header.EntriesOffset = offset;
+	header.FileSize = offset + uint64_t(count) * sizeof(ShaderStoreEntry);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return false;
+	}
+
+	offset = sizeof(ShaderStoreHeader);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (uint32_t source : blobSources)
+	{
+		WritePadding(file, offset);
+		file.write(static_cast<const char*>(pSources[source].pBytecode), static_cast<std::streamsize>(pSources[source].Size));
+		offset += pSources[source].Size;
+	}
+
+	WritePadding(file, offset);
+	for (uint32_t source : sourceOfEntry)
+	{
+		file.write(reinterpret_cast<const char*>(&entries[source]), sizeof(ShaderStoreEntry));
+	}
+
+	return static_cast<bool>(file.flush());
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 check the header and the table (the blobs themselves are not touched)
+//--------------------------------------------------------------------------------------------------------
+bool ShaderStore::Validate() const
+{
+	uint64_t fileSize = m_File.GetSize();
+	if (fileSize < sizeof(ShaderStoreHeader))
+	{
+		return false;
+	}
+
+	const ShaderStoreHeader& header = *reinterpret_cast<const ShaderStoreHeader*>(m_File.GetData());
+	if (header.Magic != ShaderStoreMagic || header.Version != ShaderStoreVersion || header.FileSize != fileSize)
+	{
+		return false;
+	}
+
+	uint64_t tableSize = uint64_t(header.EntryCount) * sizeof(ShaderStoreEntry);
+	if ((header.EntriesOffset % ShaderStoreAlignment) != 0 || header.EntriesOffset > fileSize || tableSize != fileSize - header.EntriesOffset)
+	{
+		return false;
+	}
+
+	// blobs lie between the header and the table, keys are strictly increasing for the binary search
+	const ShaderStoreEntry* pEntries = reinterpret_cast<const ShaderStoreEntry*>(m_File.GetData() + header.EntriesOffset);
+	for (uint32_t i = 0; i < header.EntryCount; ++i)
+	{
+		const ShaderStoreEntry& entry = pEntries[i];
+		if ((entry.Offset % ShaderStoreAlignment) != 0 || entry.Offset < sizeof(ShaderStoreHeader)
+			|| entry.Offset > header.EntriesOffset || entry.Size > header.EntriesOffset - entry.Offset)
+		{
+			return false;
+		}
+
+		if (i > 0 && pEntries[i - 1].PermutationKey >= entry.PermutationKey)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,777 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <SoftRasterizer.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// SOFT_RASTERIZER_SSE2=0 forces the scalar path (which produces the same image)
+#if !defined(SOFT_RASTERIZER_SSE2)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOFT_RASTERIZER_SSE2 1
+#else
+#define SOFT_RASTERIZER_SSE2 0
+#endif
+#endif
+
+#if SOFT_RASTERIZER_SSE2
+#include <emmintrin.h>
+#endif
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const int32_t SubpixelBits = 4; // fractional bits of snapped positions
+	const int32_t SubpixelScale = 1 << SubpixelBits; // subpixels per pixel
+	const int32_t SubpixelHalf = SubpixelScale / 2; // offset of the pixel center
+	const float GuardBand = 8192.f; // pixels around the viewport center which need no clipping
+	const uint32_t SRGBTableSize = 16384; // entries of the linear to sRGB table
+	const uint32_t VertexChunk = 4096; // vertices shaded per worker job
+	const uint32_t MaxClipVertices = 9; // a triangle clipped by six planes
+
+	//----------------------------------------------------------------------------------------------------
+	// linear [0, 1] to 8-bit sRGB, indexed by value * (SRGBTableSize - 1)
+	//----------------------------------------------------------------------------------------------------
+	const uint8_t* GetSRGBTable()
+	{
+		static const std::vector<uint8_t> table = []
+		{
+			std::vector<uint8_t> result(SRGBTableSize);
+			for (uint32_t i = 0; i < SRGBTableSize; ++i)
+			{
+				double linear = double(i) / double(SRGBTableSize - 1);
+				double srgb = (linear <= 0.0031308) ? linear * 12.92 : 1.055 * pow(linear, 1.0 / 2.4) - 0.055;
+				result[i] = static_cast<uint8_t>(srgb * 255.0 + 0.5);
+			}
+			return result;
+		}();
+		return table.data();
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// pack a linear color the way an R8G8B8A8_UNORM_SRGB target stores it
+	//----------------------------------------------------------------------------------------------------
+	uint32_t PackSRGB(const float color[4])
+	{
+		const uint8_t* pTable = GetSRGBTable();
+		uint32_t packed = 0;
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			float c = std::min(std::max(color[i], 0.f), 1.f);
+			packed |= uint32_t(pTable[lrintf(c * float(SRGBTableSize - 1))]) << (i * 8);
+		}
+		float a = std::min(std::max(color[3], 0.f), 1.f);
+		return packed | (uint32_t(lrintf(a * 255.f)) << 24);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// floor of a / 2^SubpixelBits for negative values too
+	//----------------------------------------------------------------------------------------------------
+	inline int32_t FloorSubpixel(int32_t value)
+	{
+		return value >> SubpixelBits;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// distance of a clip space position inside a clip plane (negative is outside)
+	//----------------------------------------------------------------------------------------------------
+	inline float PlaneDistance(const float p[4], uint32_t plane, float guardX, float guardY)
+	{
+		switch (plane)
+		{
+		case 0: return p[0] + guardX * p[3];
+		case 1: return guardX * p[3] - p[0];
+		case 2: return p[1] + guardY * p[3];
+		case 3: return guardY * p[3] - p[1];
+		case 4: return p[2];
+		default: return p[3] - p[2];
+		}
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SoftRasterizer class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+SoftRasterizer::SoftRasterizer()
+	: m_Width(0)
+	, m_Height(0)
+	, m_Pitch(0)
+	, m_TilesX(0)
+	, m_TilesY(0)
+	, m_Viewport()
+	, m_CullMode(GfxCullMode::None)
+	, m_FrontCCW(false)
+	, m_ClearColor(0)
+	, m_Stats()
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+SoftRasterizer::~SoftRasterizer()
+{
+	Term();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 initialization
+//--------------------------------------------------------------------------------------------------------
+bool SoftRasterizer::Init(uint32_t width, uint32_t height)
+{
+	if (width == 0 || height == 0 || width > MaxSize || height > MaxSize)
+	{
+		return false;
+	}
+
+	m_Width = width;
+	m_Height = height;
+	m_TilesX = (width + TileSize - 1) / TileSize;
+	m_TilesY = (height + TileSize - 1) / TileSize;
+	m_Pitch = m_TilesX * TileSize;
+
+	// tiles write whole, the padding is never shown
+	m_Pixels.assign(size_t(m_Pitch) * m_TilesY * TileSize, 0);
+	m_Bins.assign(size_t(m_TilesX) * m_TilesY, std::vector<uint32_t>());
+	m_TilePixels.assign(m_Bins.size(), 0);
+
+	GfxViewport viewport = { 0.f, 0.f, float(width), float(height), 0.f, 1.f };
+	SetViewport(viewport);
+	m_Stats = SoftRasterizerStats();
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 termination
+//--------------------------------------------------------------------------------------------------------
+void SoftRasterizer::Term()
+{
+	m_Pixels.clear();
+	m_Bins.clear();
+	m_TilePixels.clear();
+	m_Triangles.clear();
+	m_Shaded.clear();
+	m_Width = 0;
+	m_Height = 0;
+	m_Pitch = 0;
+	m_TilesX = 0;
+	m_TilesY = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 set viewport
+//--------------------------------------------------------------------------------------------------------
+void SoftRasterizer::SetViewport(const GfxViewport& viewport)
+{
+	m_Viewport = viewport;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 set cull mode
+//--------------------------------------------------------------------------------------------------------
+void SoftRasterizer::SetCullMode(GfxCullMode cullMode, bool frontCounterClockwise)
+{
+	m_CullMode = cullMode;
+	m_FrontCCW = frontCounterClockwise;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 start a frame
+//--------------------------------------------------------------------------------------------------------
+void SoftRasterizer::BeginFrame(const float clearColor[4])
+{
+	m_ClearColor = PackSRGB(clearColor);
+	m_Triangles.clear();
+	for (std::vector<uint32_t>& bin : m_Bins)
+	{
+		bin.clear();
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 vertex shade and bin triangles
+//--------------------------------------------------------------------------------------------------------
+void SoftRasterizer::DrawIndexed(
+	const Vertex* pVertices,
+	uint32_t vertexCount,
+	const uint32_t* pIndices,
+	uint32_t indexCount,
+	const Transform& transform,
+	WorkerPool* pWorkers)
+{
+	// SimpleVS multiplies column-major constants, which is the row vector product with the XMMATRIX
+	DirectX::XMFLOAT4X4 wvp;
+	DirectX::XMStoreFloat4x4(&wvp,
+		DirectX::XMMatrixMultiply(DirectX::XMMatrixMultiply(transform.World, transform.View), transform.Proj));
+
+	// vertex stage
+	m_Shaded.resize(vertexCount);
+	uint32_t chunkCount = (vertexCount + VertexChunk - 1) / VertexChunk;
+	if (pWorkers != nullptr && chunkCount > 1)
+	{
+		pWorkers->Dispatch(chunkCount, [&](uint32_t chunk, uint32_t /* workerIndex */)
+		{
+			uint32_t first = chunk * VertexChunk;
+			ShadeVertices(pVertices, first, std::min(first + VertexChunk, vertexCount), wvp);
+		});
+	}
+	else
+	{
+		ShadeVertices(pVertices, 0, vertexCount, wvp);
+	}
+
+	// primitive assembly
+	uint32_t triangleCount = indexCount / 3;
+	m_Stats.TrianglesSubmitted += triangleCount;
+	for (uint32_t i = 0; i < triangleCount; ++i)
+	{
+		uint32_t i0 = pIndices[i * 3 + 0];
+		uint32_t i1 = pIndices[i * 3 + 1];
+		uint32_t i2 = pIndices[i * 3 + 2];
+		if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount)
+		{
+			m_Stats.TrianglesCulled++;
+			continue;
+		}
+		ClipAndSetup(m_Shaded[i0], m_Shaded[i1], m_Shaded[i2]);
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 rasterize all tiles
+//--------------------------------------------------------------------------------------------------------
+void SoftRasterizer::EndFrame(WorkerPool& workers)
+{
+	uint32_t tileCount = m_TilesX * m_TilesY;
+	workers.Dispatch(tileCount, [this](uint32_t tileIndex, uint32_t /* workerIndex */)
+	{
+		RasterizeTile(tileIndex);
+	});
+
+	for (uint32_t i = 0; i < tileCount; ++i)
+	{
+		m_Stats.PixelsShaded += m_TilePixels[i];
+		m_Bins[i].clear();
+	}
+	m_Triangles.clear();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 save as binary PPM
+//--------------------------------------------------------------------------------------------------------
+bool SoftRasterizer::SaveImage(const char* path) const
+{
+	FILE* pFile = fopen(path, "wb");
+	if (pFile == nullptr)
+	{
+		return false;
+	}
+
+	fprintf(pFile, "P6\n%u %u\n255\n", m_Width, m_Height);
+
+	std::vector<uint8_t> row(size_t(m_Width) * 3);
+	bool result = true;
+	for (uint32_t y = 0; y < m_Height && result; ++y)
+	{
+		const uint32_t* pSrc = &m_Pixels[size_t(y) * m_Pitch];
+		for (uint32_t x = 0; x < m_Width; ++x)
+		{
+			row[x * 3 + 0] = uint8_t(pSrc[x]);
+			row[x * 3 + 1] = uint8_t(pSrc[x] >> 8);
+			row[x * 3 + 2] = uint8_t(pSrc[x] >> 16);
+		}
+		result = fwrite(row.data(), 1, row.size(), pFile) == row.size();
+	}
+
+	return (fclose(pFile) == 0) && result;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 SimpleVS for a range of vertices
+//--------------------------------------------------------------------------------------------------------
+void SoftRasterizer::ShadeVertices(const Vertex* pVertices, uint32_t first, uint32_t last, const DirectX::XMFLOAT4X4& wvp)
+{
+#if SOFT_RASTERIZER_SSE2
+	const __m128 r0 = _mm_loadu_ps(&wvp.m[0][0]);
+	const __m128 r1 = _mm_loadu_ps(&wvp.m[1][0]);
+	const __m128 r2 = _mm_loadu_ps(&wvp.m[2][0]);
+	const __m128 r3 = _mm_loadu_ps(&wvp.m[3][0]);
+
+	for (uint32_t i = first; i < last; ++i)
+	{
+		const Vertex& src = pVertices[i];
+		__m128 position = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(src.Position.x), r0), _mm_mul_ps(_mm_set1_ps(src.Position.y), r1)),
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(src.Position.z), r2), r3));
+
+		_mm_storeu_ps(m_Shaded[i].Position, position);
+		_mm_storeu_ps(m_Shaded[i].Color, _mm_loadu_ps(&src.Color.x));
+	}
+#else
+	for (uint32_t i = first; i < last; ++i)
+	{
+		const Vertex& src = pVertices[i];
+		ClipVertex& dst = m_Shaded[i];
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			dst.Position[c] = (src.Position.x * wvp.m[0][c] + src.Position.y * wvp.m[1][c])
+				+ (src.Position.z * wvp.m[2][c] + wvp.m[3][c]);
+		}
+		dst.Color[0] = src.Color.x;
+		dst.Color[1] = src.Color.y;
+		dst.Color[2] = src.Color.z;
+		dst.Color[3] = src.Color.w;
+	}
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 clip against the guard band and the depth range
+//--------------------------------------------------------------------------------------------------------
+void SoftRasterizer::ClipAndSetup(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2)
+{
+	const float guardX = GuardBand / (0.5f * m_Viewport.Width);
+	const float guardY = GuardBand / (0.5f * m_Viewport.Height);
+	const ClipVertex* pInput[3] = { &v0, &v1, &v2 };
+
+	// outcodes
+	uint32_t outside[3] = {};
+	for (uint32_t v = 0; v < 3; ++v)
+	{
+		for (uint32_t plane = 0; plane < 6; ++plane)
+		{
+			if (PlaneDistance(pInput[v]->Position, plane, guardX, guardY) < 0.f)
+			{
+				outside[v] |= 1u << plane;
+			}
+		}
+	}
+
+	if ((outside[0] & outside[1] & outside[2]) != 0)
+	{
+		m_Stats.TrianglesCulled++;
+		return;
+	}
+
+	if ((outside[0] | outside[1] | outside[2]) == 0)
+	{
+		SetupAndBin(v0, v1, v2);
+		return;
+	}
+
+	// Sutherland-Hodgman against the planes which cut the triangle
+	m_Stats.TrianglesClipped++;
+
+	ClipVertex buffers[2][MaxClipVertices];
+	uint32_t count = 3;
+	buffers[0][0] = v0;
+	buffers[0][1] = v1;
+	buffers[0][2] = v2;
+
+	uint32_t current = 0;
+	uint32_t planes = outside[0] | outside[1] | outside[2];
+	for (uint32_t plane = 0; plane < 6 && count >= 3; ++plane)
+	{
+		if ((planes & (1u << plane)) == 0)
+		{
+			continue;
+		}
+
+		const ClipVertex* pSrc = buffers[current];
+		ClipVertex* pDst = buffers[current ^ 1];
+		uint32_t outCount = 0;
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const ClipVertex& a = pSrc[i];
+			const ClipVertex& b = pSrc[(i + 1) % count];
+			float da = PlaneDistance(a.Position, plane, guardX, guardY);
+			float db = PlaneDistance(b.Position, plane, guardX, guardY);
+
+			if (da >= 0.f)
+			{
+				pDst[outCount++] = a;
+			}
+
+			if ((da >= 0.f) != (db >= 0.f))
+			{
+				float t = da / (da - db);
+				ClipVertex& v = pDst[outCount++];
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					v.Position[c] = a.Position[c] + (b.Position[c] - a.Position[c]) * t;
+					v.Color[c] = a.Color[c] + (b.Color[c] - a.Color[c]) * t;
+				}
+			}
+		}
+
+		count = outCount;
+		current ^= 1;
+	}
+
+	if (count < 3)
+	{
+		m_Stats.TrianglesCulled++;
+		return;
+	}
+
+	for (uint32_t i = 1; i + 1 < count; ++i)
+	{
+		SetupAndBin(buffers[current][0], buffers[current][i], buffers[current][i + 1]);
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 snap to subpixels, build edge functions and attribute planes, add to the bins
+//--------------------------------------------------------------------------------------------------------
+void SoftRasterizer::SetupAndBin(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2)
+{
+	const ClipVertex* pVertex[3] = { &v0, &v1, &v2 };
+	int32_t x[3];
+	int32_t y[3];
+	float invW[3];
+
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		const float* p = pVertex[i]->Position;
+		if (p[3] <= 0.f)
+		{
+			m_Stats.TrianglesCulled++;
+			return;
+		}
+
+		// viewport transform (y goes down)
+		invW[i] = 1.f / p[3];
+		float sx = m_Viewport.TopLeftX + (p[0] * invW[i] * 0.5f + 0.5f) * m_Viewport.Width;
+		float sy = m_Viewport.TopLeftY + (0.5f - p[1] * invW[i] * 0.5f) * m_Viewport.Height;
+		x[i] = static_cast<int32_t>(lrintf(sx * SubpixelScale));
+		y[i] = static_cast<int32_t>(lrintf(sy * SubpixelScale));
+	}
+
+	// facing, positive area is clockwise on screen
+	int64_t area = int64_t(x[1] - x[0]) * (y[2] - y[0]) - int64_t(x[2] - x[0]) * (y[1] - y[0]);
+	if (area == 0)
+	{
+		m_Stats.TrianglesCulled++;
+		return;
+	}
+
+	bool front = (area > 0) != m_FrontCCW;
+	if ((m_CullMode == GfxCullMode::Back && !front) || (m_CullMode == GfxCullMode::Front && front))
+	{
+		m_Stats.TrianglesCulled++;
+		return;
+	}
+
+	// make the winding clockwise so that inside is non-negative on every edge
+	if (area < 0)
+	{
+		std::swap(pVertex[1], pVertex[2]);
+		std::swap(x[1], x[2]);
+		std::swap(y[1], y[2]);
+		std::swap(invW[1], invW[2]);
+		area = -area;
+	}
+
+	// pixel bounds clamped to the viewport and the target
+	int32_t vpMinX = std::max(0, static_cast<int32_t>(ceilf(m_Viewport.TopLeftX)));
+	int32_t vpMinY = std::max(0, static_cast<int32_t>(ceilf(m_Viewport.TopLeftY)));
+	int32_t vpMaxX = std::min(int32_t(m_Width), static_cast<int32_t>(ceilf(m_Viewport.TopLeftX + m_Viewport.Width))) - 1;
+	int32_t vpMaxY = std::min(int32_t(m_Height), static_cast<int32_t>(ceilf(m_Viewport.TopLeftY + m_Viewport.Height))) - 1;
+
+	SetupTriangle tri;
+	tri.MinX = std::max(vpMinX, FloorSubpixel(std::min({ x[0], x[1], x[2] }) - SubpixelHalf + SubpixelScale - 1));
+	tri.MinY = std::max(vpMinY, FloorSubpixel(std::min({ y[0], y[1], y[2] }) - SubpixelHalf + SubpixelScale - 1));
+	tri.MaxX = std::min(vpMaxX, FloorSubpixel(std::max({ x[0], x[1], x[2] }) - SubpixelHalf));
+	tri.MaxY = std::min(vpMaxY, FloorSubpixel(std::max({ y[0], y[1], y[2] }) - SubpixelHalf));
+	if (tri.MinX > tri.MaxX || tri.MinY > tri.MaxY)
+	{
+		m_Stats.TrianglesCulled++;
+		return;
+	}
+
+	// edge functions, pixels exactly on an edge belong to top and left edges only
+	for (uint32_t e = 0; e < 3; ++e)
+	{
+		uint32_t a = e;
+		uint32_t b = (e + 1) % 3;
+		int64_t edgeA = int64_t(y[a]) - y[b];
+		int64_t edgeB = int64_t(x[b]) - x[a];
+		bool topLeft = (edgeA > 0) || (edgeA == 0 && edgeB > 0);
+
+		tri.EdgeA[e] = edgeA;
+		tri.EdgeB[e] = edgeB;
+		tri.EdgeC[e] = int64_t(x[a]) * y[b] - int64_t(x[b]) * y[a] - (topLeft ? 0 : 1);
+	}
+
+	// attribute planes over pixel centers
+	double fx[3];
+	double fy[3];
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		fx[i] = double(x[i]) / SubpixelScale - 0.5;
+		fy[i] = double(y[i]) / SubpixelScale - 0.5;
+	}
+
+	double invArea = double(SubpixelScale * SubpixelScale) / double(area);
+	auto makePlane = [&](double a0, double a1, double a2)
+	{
+		double dx = ((a1 - a0) * (fy[2] - fy[0]) - (a2 - a0) * (fy[1] - fy[0])) * invArea;
+		double dy = ((a2 - a0) * (fx[1] - fx[0]) - (a1 - a0) * (fx[2] - fx[0])) * invArea;
+		Plane plane;
+		plane.Base = float(a0 - dx * fx[0] - dy * fy[0]);
+		plane.DX = float(dx);
+		plane.DY = float(dy);
+		return plane;
+	};
+
+	tri.InvW = makePlane(invW[0], invW[1], invW[2]);
+	for (uint32_t c = 0; c < 4; ++c)
+	{
+		tri.ColorOverW[c] = makePlane(
+			pVertex[0]->Color[c] * invW[0],
+			pVertex[1]->Color[c] * invW[1],
+			pVertex[2]->Color[c] * invW[2]);
+	}
+
+	// binning
+	uint32_t index = static_cast<uint32_t>(m_Triangles.size());
+	m_Triangles.push_back(tri);
+	m_Stats.TrianglesBinned++;
+
+	for (int32_t ty = tri.MinY / int32_t(TileSize); ty <= tri.MaxY / int32_t(TileSize); ++ty)
+	{
+		for (int32_t tx = tri.MinX / int32_t(TileSize); tx <= tri.MaxX / int32_t(TileSize); ++tx)
+		{
+			m_Bins[size_t(ty) * m_TilesX + tx].push_back(index);
+			m_Stats.BinEntries++;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 clear a tile and rasterize its triangles in submission order
+//--------------------------------------------------------------------------------------------------------
+void SoftRasterizer::RasterizeTile(uint32_t tileIndex)
+{
+	int32_t tileX = int32_t(tileIndex % m_TilesX * TileSize);
+	int32_t tileY = int32_t(tileIndex / m_TilesX * TileSize);
+
+	for (uint32_t row = 0; row < TileSize; ++row)
+	{
+		uint32_t* pRow = &m_Pixels[size_t(tileY + row) * m_Pitch + tileX];
+		std::fill(pRow, pRow + TileSize, m_ClearColor);
+	}
+
+	uint64_t pixels = 0;
+	for (uint32_t index : m_Bins[tileIndex])
+	{
+		const SetupTriangle& tri = m_Triangles[index];
+		int32_t x0 = std::max(tri.MinX, tileX);
+		int32_t y0 = std::max(tri.MinY, tileY);
+		int32_t x1 = std::min(tri.MaxX, tileX + int32_t(TileSize) - 1);
+		int32_t y1 = std::min(tri.MaxY, tileY + int32_t(TileSize) - 1);
+
+		// classify the block by the edge values at its corner pixels, only edges crossing it are tested
+		uint32_t edgeMask = 0;
+		bool rejected = false;
+		for (uint32_t e = 0; e < 3 && !rejected; ++e)
+		{
+			int32_t insideCorners = 0;
+			for (uint32_t corner = 0; corner < 4; ++corner)
+			{
+				int64_t px = int64_t((corner & 1) ? x1 : x0) * SubpixelScale + SubpixelHalf;
+				int64_t py = int64_t((corner & 2) ? y1 : y0) * SubpixelScale + SubpixelHalf;
+				insideCorners += (tri.EdgeA[e] * px + tri.EdgeB[e] * py + tri.EdgeC[e] >= 0) ? 1 : 0;
+			}
+			rejected = (insideCorners == 0);
+			edgeMask |= (insideCorners != 4) ? (1u << e) : 0u;
+		}
+
+		if (rejected)
+		{
+			continue;
+		}
+
+		pixels += (edgeMask != 0)
+			? RasterizeBlock<true>(tri, edgeMask, x0, y0, x1, y1)
+			: RasterizeBlock<false>(tri, edgeMask, x0, y0, x1, y1);
+	}
+
+	m_TilePixels[tileIndex] = pixels;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 SimplePS over a block of one tile (edges crossing the block keep their values in 32 bits)
+//--------------------------------------------------------------------------------------------------------
+template<bool TestEdges>
+uint64_t SoftRasterizer::RasterizeBlock(const SetupTriangle& tri, uint32_t edgeMask, int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+{
+	const uint8_t* pTable = GetSRGBTable();
+	uint64_t pixels = 0;
+	int32_t startX = x0 & ~3;
+
+#if SOFT_RASTERIZER_SSE2
+	const __m128i laneIndex = _mm_setr_epi32(0, 1, 2, 3);
+	const __m128 laneOffset = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+	const __m128 tableScale = _mm_set1_ps(float(SRGBTableSize - 1));
+	const __m128 alphaScale = _mm_set1_ps(255.f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128i minX = _mm_set1_epi32(x0 - 1);
+	const __m128i maxX = _mm_set1_epi32(x1 + 1);
+
+	// edges which don't cross the block stay at zero
+	__m128i edgeStep[3];
+	for (uint32_t e = 0; e < 3; ++e)
+	{
+		bool test = (edgeMask & (1u << e)) != 0;
+		edgeStep[e] = _mm_set1_epi32(test ? int32_t(tri.EdgeA[e] * SubpixelScale * 4) : 0);
+	}
+
+	for (int32_t y = y0; y <= y1; ++y)
+	{
+		uint32_t* pRow = &m_Pixels[size_t(y) * m_Pitch];
+		const __m128 fy = _mm_set1_ps(float(y));
+
+		__m128i edge[3] = { _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128() };
+		if (TestEdges)
+		{
+			for (uint32_t e = 0; e < 3; ++e)
+			{
+				if ((edgeMask & (1u << e)) == 0)
+				{
+					continue;
+				}
+
+				int32_t start = int32_t(tri.EdgeA[e] * (int64_t(startX) * SubpixelScale + SubpixelHalf)
+					+ tri.EdgeB[e] * (int64_t(y) * SubpixelScale + SubpixelHalf) + tri.EdgeC[e]);
+				int32_t step = int32_t(tri.EdgeA[e] * SubpixelScale);
+				edge[e] = _mm_setr_epi32(start, start + step, start + step * 2, start + step * 3);
+			}
+		}
+
+		for (int32_t x = startX; x <= x1; x += 4)
+		{
+			__m128i px = _mm_add_epi32(_mm_set1_epi32(x), laneIndex);
+			__m128i mask = _mm_and_si128(_mm_cmpgt_epi32(px, minX), _mm_cmplt_epi32(px, maxX));
+			if (TestEdges)
+			{
+				__m128i signs = _mm_or_si128(_mm_or_si128(edge[0], edge[1]), edge[2]);
+				mask = _mm_andnot_si128(_mm_srai_epi32(signs, 31), mask);
+				for (uint32_t e = 0; e < 3; ++e)
+				{
+					edge[e] = _mm_add_epi32(edge[e], edgeStep[e]);
+				}
+			}
+
+			int bits = _mm_movemask_ps(_mm_castsi128_ps(mask));
+			if (bits == 0)
+			{
+				continue;
+			}
+
+			// perspective-correct color
+			__m128 fx = _mm_add_ps(_mm_set1_ps(float(x)), laneOffset);
+			__m128 invW = _mm_add_ps(_mm_add_ps(_mm_set1_ps(tri.InvW.Base), _mm_mul_ps(_mm_set1_ps(tri.InvW.DX), fx)),
+				_mm_mul_ps(_mm_set1_ps(tri.InvW.DY), fy));
+			__m128 w = _mm_div_ps(one, invW);
+
+			alignas(16) int32_t index[4][4];
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				const Plane& plane = tri.ColorOverW[c];
+				__m128 value = _mm_add_ps(_mm_add_ps(_mm_set1_ps(plane.Base), _mm_mul_ps(_mm_set1_ps(plane.DX), fx)),
+					_mm_mul_ps(_mm_set1_ps(plane.DY), fy));
+				value = _mm_min_ps(_mm_max_ps(_mm_mul_ps(value, w), zero), one);
+				_mm_store_si128(reinterpret_cast<__m128i*>(index[c]), _mm_cvtps_epi32(_mm_mul_ps(value, (c < 3) ? tableScale : alphaScale)));
+			}
+
+			// output merger (sRGB encode, no blending)
+			alignas(16) uint32_t color[4];
+			for (uint32_t lane = 0; lane < 4; ++lane)
+			{
+				color[lane] = uint32_t(pTable[index[0][lane]])
+					| (uint32_t(pTable[index[1][lane]]) << 8)
+					| (uint32_t(pTable[index[2][lane]]) << 16)
+					| (uint32_t(index[3][lane]) << 24);
+			}
+
+			__m128i* pDst = reinterpret_cast<__m128i*>(pRow + x);
+			__m128i old = _mm_load_si128(pDst);
+			__m128i packed = _mm_load_si128(reinterpret_cast<const __m128i*>(color));
+			_mm_store_si128(pDst, _mm_or_si128(_mm_and_si128(mask, packed), _mm_andnot_si128(mask, old)));
+
+			pixels += uint32_t(((bits >> 0) & 1) + ((bits >> 1) & 1) + ((bits >> 2) & 1) + ((bits >> 3) & 1));
+		}
+	}
+#else
+	for (int32_t y = y0; y <= y1; ++y)
+	{
+		uint32_t* pRow = &m_Pixels[size_t(y) * m_Pitch];
+		const float fy = float(y);
+
+		for (int32_t x = startX; x <= x1; ++x)
+		{
+			if (x < x0)
+			{
+				continue;
+			}
+
+			if (TestEdges)
+			{
+				bool inside = true;
+				for (uint32_t e = 0; e < 3; ++e)
+				{
+					if ((edgeMask & (1u << e)) == 0)
+					{
+						continue;
+					}
+
+					int64_t value = tri.EdgeA[e] * (int64_t(x) * SubpixelScale + SubpixelHalf)
+						+ tri.EdgeB[e] * (int64_t(y) * SubpixelScale + SubpixelHalf) + tri.EdgeC[e];
+					inside &= (value >= 0);
+				}
+				if (!inside)
+				{
+					continue;
+				}
+			}
+
+			// perspective-correct color
+			const float fx = float(x);
+			float invW = (tri.InvW.Base + tri.InvW.DX * fx) + tri.InvW.DY * fy;
+			float w = 1.f / invW;
+
+			int32_t index[4];
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				const Plane& plane = tri.ColorOverW[c];
+				float value = (plane.Base + plane.DX * fx) + plane.DY * fy;
+				value = std::min(std::max(value * w, 0.f), 1.f);
+				index[c] = static_cast<int32_t>(lrintf(value * ((c < 3) ? float(SRGBTableSize - 1) : 255.f)));
+			}
+
+			// output merger (sRGB encode, no blending)
+			pRow[x] = uint32_t(pTable[index[0]])
+				| (uint32_t(pTable[index[1]]) << 8)
+				| (uint32_t(pTable[index[2]]) << 16)
+				| (uint32_t(index[3]) << 24);
+			pixels++;
+		}
+	}
+#endif
+
+	return pixels;
+}
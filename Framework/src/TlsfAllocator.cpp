@@ -0,0 +1,459 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <TlsfAllocator.h>
+#include <algorithm>
+#include <cassert>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// index of the highest set bit (value isn't 0)
+	//----------------------------------------------------------------------------------------------------
+	inline uint32_t HighestBit(uint64_t value)
+	{
+#if defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanReverse64(&index, value);
+		return static_cast<uint32_t>(index);
+#else
+		return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// index of the lowest set bit (value isn't 0)
+	//----------------------------------------------------------------------------------------------------
+	inline uint32_t LowestBit(uint64_t value)
+	{
+#if defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanForward64(&index, value);
+		return static_cast<uint32_t>(index);
+#else
+		return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// round up to a power of two alignment
+	//----------------------------------------------------------------------------------------------------
+	inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TlsfAllocator class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+TlsfAllocator::TlsfAllocator()
+{
+	Reset(0);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+TlsfAllocator::~TlsfAllocator()
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 reset to a single free block of the capacity
+//--------------------------------------------------------------------------------------------------------
+void TlsfAllocator::Reset(uint64_t capacity, uint64_t granularity)
+{
+	assert(granularity > 0 && (granularity & (granularity - 1)) == 0);
+
+	m_Granularity = granularity;
+	m_GranularityShift = LowestBit(granularity);
+	m_Capacity = capacity & ~(granularity - 1);
+	m_Nodes.clear();
+	m_UnusedNodes = InvalidNode;
+	m_FirstLevelMap = 0;
+	for (uint32_t fl = 0; fl < FirstLevelCount; ++fl)
+	{
+		m_SecondLevelMap[fl] = 0;
+		for (uint32_t sl = 0; sl < SecondLevelCount; ++sl)
+		{
+			m_Heads[fl][sl] = InvalidNode;
+		}
+	}
+	m_UsedGranules = 0;
+	m_AllocationCount = 0;
+	m_FreeBlockCount = 0;
+
+	if (m_Capacity > 0)
+	{
+		uint32_t node = NewNode();
+		m_Nodes[node] = Node{ 0, m_Capacity >> m_GranularityShift, InvalidNode, InvalidNode, InvalidNode, InvalidNode, false };
+		InsertFree(node);
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 allocation
+//--------------------------------------------------------------------------------------------------------
+bool TlsfAllocator::Allocate(uint64_t size, uint64_t alignment, TlsfAllocation& allocation)
+{
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	if (size == 0 || size > m_Capacity)
+	{
+		return false;
+	}
+
+	// a block with room for the worst padding always fits the aligned range
+	uint64_t granules = (size + m_Granularity - 1) >> m_GranularityShift;
+	uint64_t alignGranules = std::max(alignment, m_Granularity) >> m_GranularityShift;
+	uint32_t node = FindFree(granules + alignGranules - 1);
+	if (node == InvalidNode && alignGranules > 1)
+	{
+		// a block of the size may still be aligned well enough (the start of a range of the exact size)
+		node = FindFree(granules);
+		if (node != InvalidNode && AlignUp(m_Nodes[node].Offset, alignGranules) + granules > m_Nodes[node].Offset + m_Nodes[node].Size)
+		{
+			node = InvalidNode;
+		}
+	}
+	if (node == InvalidNode)
+	{
+		return false;
+	}
+
+	RemoveFree(node);
+	uint64_t aligned = AlignUp(m_Nodes[node].Offset, alignGranules);
+	uint64_t padding = aligned - m_Nodes[node].Offset;
+	if (padding > 0)
+	{
+		uint32_t front = node;
+		node = Split(front, padding);
+		InsertFree(front);
+	}
+	if (m_Nodes[node].Size > granules)
+	{
+		InsertFree(Split(node, granules));
+	}
+
+	m_UsedGranules += granules;
+	m_AllocationCount++;
+	allocation.Offset = aligned << m_GranularityShift;
+	allocation.Size = granules << m_GranularityShift;
+	allocation.Node = node;
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 release, merged with the free neighbours
+//--------------------------------------------------------------------------------------------------------
+void TlsfAllocator::Free(TlsfAllocation& allocation)
+{
+	uint32_t node = allocation.Node;
+	if (node == InvalidNode)
+	{
+		return;
+	}
+
+	assert(node < m_Nodes.size() && !m_Nodes[node].Free);
+	m_UsedGranules -= m_Nodes[node].Size;
+	m_AllocationCount--;
+	allocation = TlsfAllocation{ 0, 0, InvalidNode };
+
+	uint32_t prev = m_Nodes[node].PrevPhysical;
+	if (prev != InvalidNode && m_Nodes[prev].Free)
+	{
+		RemoveFree(prev);
+		m_Nodes[prev].Size += m_Nodes[node].Size;
+		m_Nodes[prev].NextPhysical = m_Nodes[node].NextPhysical;
+		if (m_Nodes[node].NextPhysical != InvalidNode)
+		{
+			m_Nodes[m_Nodes[node].NextPhysical].PrevPhysical = prev;
+		}
+		DeleteNode(node);
+		node = prev;
+	}
+
+	uint32_t next = m_Nodes[node].NextPhysical;
+	if (next != InvalidNode && m_Nodes[next].Free)
+	{
+		RemoveFree(next);
+		m_Nodes[node].Size += m_Nodes[next].Size;
+		m_Nodes[node].NextPhysical = m_Nodes[next].NextPhysical;
+		if (m_Nodes[next].NextPhysical != InvalidNode)
+		{
+			m_Nodes[m_Nodes[next].NextPhysical].PrevPhysical = node;
+		}
+		DeleteNode(next);
+	}
+
+	InsertFree(node);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 totals and the largest free block
+//--------------------------------------------------------------------------------------------------------
+TlsfStats TlsfAllocator::GetStats() const
+{
+	TlsfStats stats = {};
+	stats.Capacity = m_Capacity;
+	stats.UsedSize = m_UsedGranules << m_GranularityShift;
+	stats.AllocationCount = m_AllocationCount;
+	stats.FreeBlockCount = m_FreeBlockCount;
+
+	// the largest block is in the highest class, which isn't sorted
+	if (m_FirstLevelMap != 0)
+	{
+		uint32_t fl = HighestBit(m_FirstLevelMap);
+		uint32_t sl = HighestBit(m_SecondLevelMap[fl]);
+		for (uint32_t node = m_Heads[fl][sl]; node != InvalidNode; node = m_Nodes[node].NextFree)
+		{
+			stats.LargestFreeBlock = std::max(stats.LargestFreeBlock, m_Nodes[node].Size << m_GranularityShift);
+		}
+	}
+	return stats;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 consistency of the blocks, the class lists and the bitmaps
+//--------------------------------------------------------------------------------------------------------
+bool TlsfAllocator::Validate() const
+{
+	// blocks cover the range back to back, free ones never touch each other
+	uint64_t offset = 0;
+	uint64_t used = 0;
+	uint32_t allocations = 0;
+	uint32_t freeBlocks = 0;
+	uint32_t prev = InvalidNode;
+	for (uint32_t node = m_Nodes.empty() ? InvalidNode : 0; node != InvalidNode; node = m_Nodes[node].NextPhysical)
+	{
+		const Node& block = m_Nodes[node];
+		if (block.Offset != offset || block.Size == 0 || block.PrevPhysical != prev
+			|| (block.Free && prev != InvalidNode && m_Nodes[prev].Free))
+		{
+			return false;
+		}
+
+		offset += block.Size;
+		used += block.Free ? 0 : block.Size;
+		allocations += block.Free ? 0 : 1;
+		freeBlocks += block.Free ? 1 : 0;
+		prev = node;
+	}
+
+	if (offset != (m_Capacity >> m_GranularityShift) || used != m_UsedGranules
+		|| allocations != m_AllocationCount || freeBlocks != m_FreeBlockCount)
+	{
+		return false;
+	}
+
+	// every free block is listed once in its class, the bitmaps mark exactly the non-empty classes
+	uint32_t listed = 0;
+	for (uint32_t fl = 0; fl < FirstLevelCount; ++fl)
+	{
+		if (((m_FirstLevelMap >> fl) & 1) != (m_SecondLevelMap[fl] != 0 ? 1u : 0u))
+		{
+			return false;
+		}
+
+		for (uint32_t sl = 0; sl < SecondLevelCount; ++sl)
+		{
+			if (((m_SecondLevelMap[fl] >> sl) & 1) != (m_Heads[fl][sl] != InvalidNode ? 1u : 0u))
+			{
+				return false;
+			}
+
+			uint32_t prevFree = InvalidNode;
+			for (uint32_t node = m_Heads[fl][sl]; node != InvalidNode; node = m_Nodes[node].NextFree)
+			{
+				uint32_t nodeFl = 0;
+				uint32_t nodeSl = 0;
+				Mapping(m_Nodes[node].Size, nodeFl, nodeSl);
+				if (!m_Nodes[node].Free || m_Nodes[node].PrevFree != prevFree || nodeFl != fl || nodeSl != sl || ++listed > freeBlocks)
+				{
+					return false;
+				}
+				prevFree = node;
+			}
+		}
+	}
+	return listed == freeBlocks;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 size class of a block: exact below SecondLevelCount granules, 16 classes per power of two above
+//--------------------------------------------------------------------------------------------------------
+void TlsfAllocator::Mapping(uint64_t granules, uint32_t& firstLevel, uint32_t& secondLevel)
+{
+	if (granules < SecondLevelCount)
+	{
+		firstLevel = 0;
+		secondLevel = static_cast<uint32_t>(granules);
+		return;
+	}
+
+	uint32_t bit = HighestBit(granules);
+	firstLevel = bit - SecondLevelBits + 1;
+	secondLevel = static_cast<uint32_t>(granules >> (bit - SecondLevelBits)) & (SecondLevelCount - 1);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 free block of at least granules
+//--------------------------------------------------------------------------------------------------------
+uint32_t TlsfAllocator::FindFree(uint64_t granules) const
+{
+	// every block of the class above the one of the size fits, the class of the size itself is searched last
+	uint64_t rounded = granules;
+	if (granules >= SecondLevelCount)
+	{
+		rounded += (1ull << (HighestBit(granules) - SecondLevelBits)) - 1;
+	}
+
+	uint32_t fl = 0;
+	uint32_t sl = 0;
+	Mapping(rounded, fl, sl);
+	uint32_t secondMap = (fl < FirstLevelCount) ? m_SecondLevelMap[fl] & (~0u << sl) : 0;
+	if (secondMap == 0)
+	{
+		uint64_t firstMap = (fl + 1 < FirstLevelCount) ? m_FirstLevelMap & (~0ull << (fl + 1)) : 0;
+		if (firstMap != 0)
+		{
+			fl = LowestBit(firstMap);
+			secondMap = m_SecondLevelMap[fl];
+		}
+	}
+
+	if (secondMap != 0)
+	{
+		return m_Heads[fl][LowestBit(secondMap)];
+	}
+
+	// the size's own class may still hold a block large enough
+	Mapping(granules, fl, sl);
+	for (uint32_t node = m_Heads[fl][sl]; node != InvalidNode; node = m_Nodes[node].NextFree)
+	{
+		if (m_Nodes[node].Size >= granules)
+		{
+			return node;
+		}
+	}
+	return InvalidNode;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 add a block to the front of its class
+//--------------------------------------------------------------------------------------------------------
+void TlsfAllocator::InsertFree(uint32_t node)
+{
+	uint32_t fl = 0;
+	uint32_t sl = 0;
+	Mapping(m_Nodes[node].Size, fl, sl);
+
+	uint32_t head = m_Heads[fl][sl];
+	m_Nodes[node].PrevFree = InvalidNode;
+	m_Nodes[node].NextFree = head;
+	m_Nodes[node].Free = true;
+	if (head != InvalidNode)
+	{
+		m_Nodes[head].PrevFree = node;
+	}
+
+	m_Heads[fl][sl] = node;
+	m_SecondLevelMap[fl] |= 1u << sl;
+	m_FirstLevelMap |= 1ull << fl;
+	m_FreeBlockCount++;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 remove a block from its class
+//--------------------------------------------------------------------------------------------------------
+void TlsfAllocator::RemoveFree(uint32_t node)
+{
+	uint32_t fl = 0;
+	uint32_t sl = 0;
+	Mapping(m_Nodes[node].Size, fl, sl);
+
+	Node& block = m_Nodes[node];
+	if (block.PrevFree != InvalidNode)
+	{
+		m_Nodes[block.PrevFree].NextFree = block.NextFree;
+	}
+	if (block.NextFree != InvalidNode)
+	{
+		m_Nodes[block.NextFree].PrevFree = block.PrevFree;
+	}
+
+	if (m_Heads[fl][sl] == node)
+	{
+		m_Heads[fl][sl] = block.NextFree;
+		if (block.NextFree == InvalidNode)
+		{
+			m_SecondLevelMap[fl] &= ~(1u << sl);
+			if (m_SecondLevelMap[fl] == 0)
+			{
+				m_FirstLevelMap &= ~(1ull << fl);
+			}
+		}
+	}
+
+	block.PrevFree = InvalidNode;
+	block.NextFree = InvalidNode;
+	block.Free = false;
+	m_FreeBlockCount--;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 node for a new block, unused nodes first
+//--------------------------------------------------------------------------------------------------------
+uint32_t TlsfAllocator::NewNode()
+{
+	if (m_UnusedNodes != InvalidNode)
+	{
+		uint32_t node = m_UnusedNodes;
+		m_UnusedNodes = m_Nodes[node].NextFree;
+		return node;
+	}
+
+	m_Nodes.emplace_back();
+	return static_cast<uint32_t>(m_Nodes.size() - 1);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 node of a block merged into its neighbour
+//--------------------------------------------------------------------------------------------------------
+void TlsfAllocator::DeleteNode(uint32_t node)
+{
+	m_Nodes[node].Free = false;
+	m_Nodes[node].NextFree = m_UnusedNodes;
+	m_UnusedNodes = node;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 cut a block (not in a list) after granules, returns the node of the rest
+//--------------------------------------------------------------------------------------------------------
+uint32_t TlsfAllocator::Split(uint32_t node, uint64_t granules)
+{
+	assert(granules > 0 && granules < m_Nodes[node].Size);
+
+	uint32_t rest = NewNode();
+	Node& block = m_Nodes[node];
+	m_Nodes[rest] = Node{ block.Offset + granules, block.Size - granules, node, block.NextPhysical, InvalidNode, InvalidNode, false };
+	if (block.NextPhysical != InvalidNode)
+	{
+		m_Nodes[block.NextPhysical].PrevPhysical = rest;
+	}
+	block.NextPhysical = rest;
+	block.Size = granules;
+	return rest;
+}
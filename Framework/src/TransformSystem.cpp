@@ -0,0 +1,397 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <TransformSystem.h>
+#include <cassert>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_SYSTEM_SSE2 1
+#include <emmintrin.h>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+#else
+#define TRANSFORM_SYSTEM_SSE2 0
+#endif
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// stream size for count objects, a full load starting at any valid index stays inside
+	//----------------------------------------------------------------------------------------------------
+	inline uint32_t PadCount(uint32_t count)
+	{
+		return (count + 2 * TransformSystem::LaneCount - 2) & ~(TransformSystem::LaneCount - 1);
+	}
+
+#if TRANSFORM_SYSTEM_SSE2
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Lanes4 structure - 4 objects per register
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Lanes4
+	{
+		using V = __m128;
+		static const uint32_t Width = 4;
+
+		static V Load(const float* p) { return _mm_loadu_ps(p); }
+		static V Gather(const float* p, const uint32_t* i) { return _mm_setr_ps(p[i[0]], p[i[1]], p[i[2]], p[i[3]]); }
+		static V Set1(float value) { return _mm_set1_ps(value); }
+		static V Add(V a, V b) { return _mm_add_ps(a, b); }
+		static V Sub(V a, V b) { return _mm_sub_ps(a, b); }
+		static V Mul(V a, V b) { return _mm_mul_ps(a, b); }
+		static __m128 Quarter(V v, uint32_t /* index */) { return v; }
+	};
+
+#if defined(__AVX__)
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Lanes8 structure - 8 objects per register
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct Lanes8
+	{
+		using V = __m256;
+		static const uint32_t Width = 8;
+
+		static V Load(const float* p) { return _mm256_loadu_ps(p); }
+		static V Gather(const float* p, const uint32_t* i) { return _mm256_setr_ps(p[i[0]], p[i[1]], p[i[2]], p[i[3]], p[i[4]], p[i[5]], p[i[6]], p[i[7]]); }
+		static V Set1(float value) { return _mm256_set1_ps(value); }
+		static V Add(V a, V b) { return _mm256_add_ps(a, b); }
+		static V Sub(V a, V b) { return _mm256_sub_ps(a, b); }
+		static V Mul(V a, V b) { return _mm256_mul_ps(a, b); }
+		static __m128 Quarter(V v, uint32_t index) { return (index == 0) ? _mm256_castps256_ps128(v) : _mm256_extractf128_ps(v, 1); }
+	};
+
+	using KernelLanes = Lanes8;
+#else
+	using KernelLanes = Lanes4;
+#endif
+
+	//----------------------------------------------------------------------------------------------------
+	// write one 4x4 matrix per lane, element vectors are indexed [row * 4 + column]
+	//----------------------------------------------------------------------------------------------------
+	template<typename L>
+	void StoreMatrices(const typename L::V (&m)[16], uint8_t* pDst, size_t stride, uint32_t valid, bool stream)
+	{
+		for (uint32_t group = 0; group * 4 < valid; ++group)
+		{
+			// transpose element vectors into rows of 4 objects
+			__m128 rows[4][4];
+			for (uint32_t r = 0; r < 4; ++r)
+			{
+				__m128 c0 = L::Quarter(m[r * 4 + 0], group);
+				__m128 c1 = L::Quarter(m[r * 4 + 1], group);
+				__m128 c2 = L::Quarter(m[r * 4 + 2], group);
+				__m128 c3 = L::Quarter(m[r * 4 + 3], group);
+				_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+				rows[0][r] = c0;
+				rows[1][r] = c1;
+				rows[2][r] = c2;
+				rows[3][r] = c3;
+			}
+
+			uint32_t objects = (valid - group * 4 < 4) ? valid - group * 4 : 4;
+			for (uint32_t k = 0; k < objects; ++k)
+			{
+				float* pMatrix = reinterpret_cast<float*>(pDst + (group * 4 + k) * stride);
+				for (uint32_t r = 0; r < 4; ++r)
+				{
+					if (stream)
+					{
+						_mm_stream_ps(pMatrix + r * 4, rows[k][r]);
+					}
+					else
+					{
+						_mm_storeu_ps(pMatrix + r * 4, rows[k][r]);
+					}
+				}
+			}
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// world and world-view-projection matrices of L::Width objects per iteration, objects are
+	// [first, first + count) or pIndices[0...count) when given
+	//----------------------------------------------------------------------------------------------------
+	template<typename L>
+	void ComputeKernel(
+		const float* const* pStreams,
+		const uint32_t* pIndices,
+		uint32_t first,
+		uint32_t count,
+		const DirectX::XMFLOAT4X4& viewProj,
+		const TransformOutput& output,
+		bool stream)
+	{
+		using V = typename L::V;
+
+		const V one = L::Set1(1.f);
+		const V two = L::Set1(2.f);
+		const V zero = L::Set1(0.f);
+
+		V vp[16];
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			vp[i] = L::Set1(viewProj.m[i / 4][i % 4]);
+		}
+
+		uint8_t* pWorld = static_cast<uint8_t*>(output.pWorld);
+		uint8_t* pWVP = static_cast<uint8_t*>(output.pWorldViewProj);
+
+		for (uint32_t offset = 0; offset < count; offset += L::Width)
+		{
+			uint32_t index = first + offset;
+			uint32_t valid = (count - offset < L::Width) ? count - offset : L::Width;
+
+			// the last valid index fills the lanes after the end of the list
+			uint32_t lanes[L::Width];
+			if (pIndices != nullptr)
+			{
+				for (uint32_t k = 0; k < L::Width; ++k)
+				{
+					lanes[k] = pIndices[offset + ((k < valid) ? k : valid - 1)];
+				}
+			}
+
+			auto load = [&](uint32_t s)
+			{
+				return (pIndices != nullptr) ? L::Gather(pStreams[s], lanes) : L::Load(pStreams[s] + index);
+			};
+
+			V px = load(0);
+			V py = load(1);
+			V pz = load(2);
+			V qx = load(3);
+			V qy = load(4);
+			V qz = load(5);
+			V qw = load(6);
+			V sx = load(7);
+			V sy = load(8);
+			V sz = load(9);
+
+			// rotation (same terms as XMMatrixRotationQuaternion)
+			V xx = L::Mul(qx, qx), yy = L::Mul(qy, qy), zz = L::Mul(qz, qz);
+			V xy = L::Mul(qx, qy), xz = L::Mul(qx, qz), yz = L::Mul(qy, qz);
+			V wx = L::Mul(qw, qx), wy = L::Mul(qw, qy), wz = L::Mul(qw, qz);
+
+			// scale * rotation * translation
+			V m[16];
+			m[0] = L::Mul(L::Sub(one, L::Mul(two, L::Add(yy, zz))), sx);
+			m[1] = L::Mul(L::Mul(two, L::Add(xy, wz)), sx);
+			m[2] = L::Mul(L::Mul(two, L::Sub(xz, wy)), sx);
+			m[3] = zero;
+			m[4] = L::Mul(L::Mul(two, L::Sub(xy, wz)), sy);
+			m[5] = L::Mul(L::Sub(one, L::Mul(two, L::Add(xx, zz))), sy);
+			m[6] = L::Mul(L::Mul(two, L::Add(yz, wx)), sy);
+			m[7] = zero;
+			m[8] = L::Mul(L::Mul(two, L::Add(xz, wy)), sz);
+			m[9] = L::Mul(L::Mul(two, L::Sub(yz, wx)), sz);
+			m[10] = L::Mul(L::Sub(one, L::Mul(two, L::Add(xx, yy))), sz);
+			m[11] = zero;
+			m[12] = px;
+			m[13] = py;
+			m[14] = pz;
+			m[15] = one;
+
+			if (pWorld != nullptr)
+			{
+				StoreMatrices<L>(m, pWorld + size_t(offset) * output.Stride, output.Stride, valid, stream);
+			}
+
+			if (pWVP != nullptr)
+			{
+				// the last column of the affine rows is (0, 0, 0, 1)
+				V wvp[16];
+				for (uint32_t r = 0; r < 4; ++r)
+				{
+					for (uint32_t c = 0; c < 4; ++c)
+					{
+						V sum = L::Add(
+							L::Add(L::Mul(m[r * 4 + 0], vp[0 * 4 + c]), L::Mul(m[r * 4 + 1], vp[1 * 4 + c])),
+							L::Mul(m[r * 4 + 2], vp[2 * 4 + c]));
+						wvp[r * 4 + c] = (r == 3) ? L::Add(sum, vp[3 * 4 + c]) : sum;
+					}
+				}
+				StoreMatrices<L>(wvp, pWVP + size_t(offset) * output.Stride, output.Stride, valid, stream);
+			}
+		}
+
+		if (stream)
+		{
+			_mm_sfence();
+		}
+	}
+#endif // TRANSFORM_SYSTEM_SSE2
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TransformSystem class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+TransformSystem::TransformSystem()
+	: m_Count(0)
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 reserve memory
+//--------------------------------------------------------------------------------------------------------
+void TransformSystem::Reserve(uint32_t capacity)
+{
+	for (std::vector<float>& stream : m_Streams)
+	{
+		stream.reserve(PadCount(capacity));
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 remove all objects
+//--------------------------------------------------------------------------------------------------------
+void TransformSystem::Clear()
+{
+	for (std::vector<float>& stream : m_Streams)
+	{
+		stream.clear();
+	}
+	m_Count = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 add an object
+//--------------------------------------------------------------------------------------------------------
+uint32_t TransformSystem::Add(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT4& rotation, const DirectX::XMFLOAT3& scale)
+{
+	uint32_t index = m_Count;
+	Grow(m_Count + 1);
+	SetPosition(index, position);
+	SetRotation(index, rotation);
+	SetScale(index, scale);
+	return index;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 set position
+//--------------------------------------------------------------------------------------------------------
+void TransformSystem::SetPosition(uint32_t index, const DirectX::XMFLOAT3& position)
+{
+	assert(index < m_Count);
+	m_Streams[PositionX][index] = position.x;
+	m_Streams[PositionY][index] = position.y;
+	m_Streams[PositionZ][index] = position.z;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 set rotation quaternion
+//--------------------------------------------------------------------------------------------------------
+void TransformSystem::SetRotation(uint32_t index, const DirectX::XMFLOAT4& rotation)
+{
+	assert(index < m_Count);
+	m_Streams[RotationX][index] = rotation.x;
+	m_Streams[RotationY][index] = rotation.y;
+	m_Streams[RotationZ][index] = rotation.z;
+	m_Streams[RotationW][index] = rotation.w;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 set scale
+//--------------------------------------------------------------------------------------------------------
+void TransformSystem::SetScale(uint32_t index, const DirectX::XMFLOAT3& scale)
+{
+	assert(index < m_Count);
+	m_Streams[ScaleX][index] = scale.x;
+	m_Streams[ScaleY][index] = scale.y;
+	m_Streams[ScaleZ][index] = scale.z;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 build matrices of a range
+//--------------------------------------------------------------------------------------------------------
+void TransformSystem::Compute(uint32_t first, uint32_t count, const DirectX::XMMATRIX& viewProj, const TransformOutput& output) const
+{
+	assert(first + count <= m_Count);
+	ComputeObjects(nullptr, first, count, viewProj, output);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 build matrices of a list of objects
+//--------------------------------------------------------------------------------------------------------
+void TransformSystem::ComputeIndexed(const uint32_t* pIndices, uint32_t count, const DirectX::XMMATRIX& viewProj, const TransformOutput& output) const
+{
+	ComputeObjects(pIndices, 0, count, viewProj, output);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 build matrices
+//--------------------------------------------------------------------------------------------------------
+void TransformSystem::ComputeObjects(const uint32_t* pIndices, uint32_t first, uint32_t count, const DirectX::XMMATRIX& viewProj, const TransformOutput& output) const
+{
+	assert(output.Stride >= sizeof(DirectX::XMFLOAT4X4));
+
+	if (count == 0)
+	{
+		return;
+	}
+
+	DirectX::XMFLOAT4X4 vp;
+	DirectX::XMStoreFloat4x4(&vp, viewProj);
+
+#if TRANSFORM_SYSTEM_SSE2
+	// streaming stores need 16-byte aligned rows
+	uintptr_t alignment = uintptr_t(output.pWorld) | uintptr_t(output.pWorldViewProj) | uintptr_t(output.Stride);
+	bool stream = output.WriteCombined && (alignment & 15) == 0;
+
+	const float* pStreams[StreamCount];
+	for (uint32_t i = 0; i < StreamCount; ++i)
+	{
+		pStreams[i] = m_Streams[i].data();
+	}
+	ComputeKernel<KernelLanes>(pStreams, pIndices, first, count, vp, output, stream);
+#else
+	DirectX::XMMATRIX matViewProj = DirectX::XMLoadFloat4x4(&vp);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		uint32_t index = (pIndices != nullptr) ? pIndices[i] : first + i;
+		assert(index < m_Count);
+
+		DirectX::XMMATRIX world = DirectX::XMMatrixMultiply(
+			DirectX::XMMatrixMultiply(
+				DirectX::XMMatrixScaling(m_Streams[ScaleX][index], m_Streams[ScaleY][index], m_Streams[ScaleZ][index]),
+				DirectX::XMMatrixRotationQuaternion(DirectX::XMVectorSet(
+					m_Streams[RotationX][index], m_Streams[RotationY][index], m_Streams[RotationZ][index], m_Streams[RotationW][index]))),
+			DirectX::XMMatrixTranslation(m_Streams[PositionX][index], m_Streams[PositionY][index], m_Streams[PositionZ][index]));
+
+		if (output.pWorld != nullptr)
+		{
+			DirectX::XMStoreFloat4x4(reinterpret_cast<DirectX::XMFLOAT4X4*>(static_cast<uint8_t*>(output.pWorld) + i * output.Stride), world);
+		}
+
+		if (output.pWorldViewProj != nullptr)
+		{
+			DirectX::XMStoreFloat4x4(reinterpret_cast<DirectX::XMFLOAT4X4*>(static_cast<uint8_t*>(output.pWorldViewProj) + i * output.Stride),
+				DirectX::XMMatrixMultiply(world, matViewProj));
+		}
+	}
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 grow the streams to count objects (padding lanes stay readable)
+//--------------------------------------------------------------------------------------------------------
+void TransformSystem::Grow(uint32_t count)
+{
+	uint32_t padded = PadCount(count);
+	for (std::vector<float>& stream : m_Streams)
+	{
+		if (stream.size() < padded)
+		{
+			stream.resize(padded, 0.f);
+		}
+	}
+	m_Count = count;
+}
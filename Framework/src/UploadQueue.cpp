@@ -0,0 +1,246 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <UploadQueue.h>
+#include <Profiler.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// UploadQueue class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+UploadQueue::UploadQueue()
+	: m_NextBatch(0)
+	, m_SubmittedValue(0)
+	, m_SyncedValue(0)
+	, m_Stats()
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+UploadQueue::~UploadQueue()
+{
+	Term();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 initialization
+//--------------------------------------------------------------------------------------------------------
+bool UploadQueue::Init(GfxDevice* pDevice, uint64_t stagingSize)
+{
+	if (pDevice == nullptr || stagingSize == 0)
+	{
+		return false;
+	}
+
+	Term();
+	if (!pDevice->CreateCommandQueue(GfxCommandListType::Copy, m_pQueue) || !pDevice->CreateFence(0, m_pFence)
+		|| !m_Staging.Init(pDevice, stagingSize))
+	{
+		return false;
+	}
+
+	// command lists are created open, every batch resets its own
+	for (Batch& batch : m_Batches)
+	{
+		if (!pDevice->CreateCommandAllocator(GfxCommandListType::Copy, batch.pAllocator)
+			|| !pDevice->CreateCommandList(GfxCommandListType::Copy, batch.pAllocator.get(), batch.pCmdList))
+		{
+			return false;
+		}
+		batch.pCmdList->Close();
+		batch.FenceValue = 0;
+	}
+
+	m_NextBatch = 0;
+	m_SubmittedValue = 0;
+	m_SyncedValue = 0;
+	m_Stats = UploadStats();
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 termination
+//--------------------------------------------------------------------------------------------------------
+void UploadQueue::Term()
+{
+	// copies queued but not submitted are dropped
+	if (m_pFence != nullptr)
+	{
+		m_pFence->Wait(m_SubmittedValue);
+	}
+
+	m_Copies.clear();
+	for (Batch& batch : m_Batches)
+	{
+		batch.pCmdList.reset();
+		batch.pAllocator.reset();
+		batch.FenceValue = 0;
+	}
+	m_Staging.Term();
+	m_pFence.reset();
+	m_pQueue.reset();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 stage the data and queue its copy
+//--------------------------------------------------------------------------------------------------------
+bool UploadQueue::Upload(GfxResource* pDst, uint64_t dstOffset, const void* pData, uint64_t size)
+{
+	if (m_pQueue == nullptr || pDst == nullptr || pData == nullptr)
+	{
+		return false;
+	}
+
+	// chunks of a quarter of the ring, so that the first ones are copied while the next ones are staged
+	const uint8_t* pSrc = static_cast<const uint8_t*>(pData);
+	uint64_t chunkSize = std::max(m_Staging.GetCapacity() / 4, uint64_t(StagingAlignment));
+	for (uint64_t done = 0; done < size;)
+	{
+		uint64_t chunk = std::min(size - done, chunkSize);
+		UploadAllocation staging;
+		if (!Stage(chunk, staging))
+		{
+			return false;
+		}
+		memcpy(staging.pCPU, pSrc + done, static_cast<size_t>(chunk));
+
+		// the ring hands out ranges one after another, a chunk usually continues the previous copy
+		Copy* pLast = m_Copies.empty() ? nullptr : &m_Copies.back();
+		if (pLast != nullptr && pLast->pDst == pDst && pLast->DstOffset + pLast->Size == dstOffset + done
+			&& pLast->SrcOffset + pLast->Size == staging.Offset)
+		{
+			pLast->Size += chunk;
+		}
+		else
+		{
+			m_Copies.push_back(Copy{ pDst, dstOffset + done, staging.Offset, chunk });
+		}
+		done += chunk;
+	}
+
+	m_Stats.UploadCount++;
+	m_Stats.UploadedBytes += size;
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 record and execute the queued copies
+//--------------------------------------------------------------------------------------------------------
+uint64_t UploadQueue::Submit()
+{
+	if (m_Copies.empty())
+	{
+		return m_SubmittedValue;
+	}
+
+	PROFILE_SCOPE("SubmitUploads");
+	Batch& batch = m_Batches[m_NextBatch];
+	WaitForBatch(batch.FenceValue);
+
+	batch.pAllocator->Reset();
+	batch.pCmdList->Reset(batch.pAllocator.get(), nullptr);
+	for (const Copy& copy : m_Copies)
+	{
+		batch.pCmdList->CopyBufferRegion(copy.pDst, copy.DstOffset, m_Staging.GetBuffer(), copy.SrcOffset, copy.Size);
+	}
+	batch.pCmdList->Close();
+
+	GfxCommandList* pCmdList = batch.pCmdList.get();
+	m_pQueue->ExecuteCommandLists(1, &pCmdList);
+	m_pQueue->Signal(m_pFence.get(), ++m_SubmittedValue);
+	batch.FenceValue = m_SubmittedValue;
+	m_Staging.EndFrame(m_SubmittedValue);
+
+	m_NextBatch = (m_NextBatch + 1) % MaxBatches;
+	m_Stats.CopyCount += m_Copies.size();
+	m_Stats.BatchCount++;
+	m_Copies.clear();
+	return m_SubmittedValue;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 GPU side wait of another queue on the batches so far
+//--------------------------------------------------------------------------------------------------------
+bool UploadQueue::Sync(GfxCommandQueue* pQueue)
+{
+	if (pQueue == nullptr || m_SyncedValue >= m_SubmittedValue)
+	{
+		return false;
+	}
+
+	pQueue->Wait(m_pFence.get(), m_SubmittedValue);
+	m_SyncedValue = m_SubmittedValue;
+	m_Stats.SyncCount++;
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 recycle staging memory
+//--------------------------------------------------------------------------------------------------------
+void UploadQueue::Retire()
+{
+	if (m_pFence != nullptr)
+	{
+		m_Staging.Retire(m_pFence->GetCompletedValue());
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 staging memory, submitting and waiting for batches until the ring has room
+//--------------------------------------------------------------------------------------------------------
+bool UploadQueue::Stage(uint64_t size, UploadAllocation& allocation)
+{
+	while (!m_Staging.Allocate(size, StagingAlignment, allocation))
+	{
+		uint64_t completedValue = m_pFence->GetCompletedValue();
+		m_Staging.Retire(completedValue);
+		if (m_Staging.Allocate(size, StagingAlignment, allocation))
+		{
+			return true;
+		}
+
+		// the queued copies hold ranges that only come back once they are submitted and done
+		if (!m_Copies.empty())
+		{
+			Submit();
+		}
+		else if (completedValue < m_SubmittedValue)
+		{
+			WaitForBatch(completedValue + 1);
+			m_Staging.Retire(m_pFence->GetCompletedValue());
+		}
+		else
+		{
+			// nothing in flight, the ring is too small for the chunk
+			return false;
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 CPU wait for a batch, counted as a stall when the GPU isn't there yet
+//--------------------------------------------------------------------------------------------------------
+void UploadQueue::WaitForBatch(uint64_t fenceValue)
+{
+	if (fenceValue == 0 || m_pFence->GetCompletedValue() >= fenceValue)
+	{
+		return;
+	}
+
+	PROFILE_SCOPE("WaitForUploadBatch");
+	auto begin = std::chrono::steady_clock::now();
+	m_pFence->Wait(fenceValue);
+	m_Stats.StallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	m_Stats.StallCount++;
+}
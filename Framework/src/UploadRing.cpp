@@ -0,0 +1,120 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <UploadRing.h>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// UploadRing class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+UploadRing::UploadRing()
+	: m_pBuffer(nullptr)
+	, m_pCPUBase(nullptr)
+	, m_GPUBase(0)
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+UploadRing::~UploadRing()
+{
+	Term();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 initialization with an upload buffer of the device
+//--------------------------------------------------------------------------------------------------------
+bool UploadRing::Init(GfxDevice* pDevice, uint64_t capacity)
+{
+	if (pDevice == nullptr || capacity == 0)
+	{
+		return false;
+	}
+
+	// generate upload buffer
+	GfxBufferDesc desc = {};
+	desc.Size = capacity;
+	desc.HeapType = GfxHeapType::Upload;
+	desc.InitialState = GfxResourceState::GenericRead;
+
+	GfxPtr<GfxResource> pBuffer;
+	if (!pDevice->CreateBuffer(desc, pBuffer))
+	{
+		return false;
+	}
+
+	// keep mapped for the lifetime of the ring
+	void* ptr = nullptr;
+	if (!pBuffer->Map(&ptr))
+	{
+		return false;
+	}
+
+	if (!Init(ptr, pBuffer->GetGPUVirtualAddress(), capacity))
+	{
+		pBuffer->Unmap();
+		return false;
+	}
+
+	m_pBuffer = std::move(pBuffer);
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 initialization with caller-owned memory
+//--------------------------------------------------------------------------------------------------------
+bool UploadRing::Init(void* pCPUBase, GfxGpuVirtualAddress gpuBase, uint64_t capacity)
+{
+	if (pCPUBase == nullptr || capacity == 0)
+	{
+		return false;
+	}
+
+	Term();
+
+	m_pCPUBase = static_cast<uint8_t*>(pCPUBase);
+	m_GPUBase = gpuBase;
+	m_Ring.Reset(capacity);
+	m_Ring.ResetStats();
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 termination
+//--------------------------------------------------------------------------------------------------------
+void UploadRing::Term()
+{
+	if (m_pBuffer != nullptr)
+	{
+		m_pBuffer->Unmap();
+		m_pBuffer.reset();
+	}
+
+	m_pCPUBase = nullptr;
+	m_GPUBase = 0;
+	m_Ring.Reset(0);
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 allocation
+//--------------------------------------------------------------------------------------------------------
+bool UploadRing::Allocate(uint64_t size, uint64_t alignment, UploadAllocation& allocation)
+{
+	uint64_t offset = 0;
+	if (!m_Ring.Allocate(size, alignment, offset))
+	{
+		return false;
+	}
+
+	allocation.pCPU = m_pCPUBase + offset;
+	allocation.GPU = m_GPUBase + offset;
+	allocation.Offset = offset;
+	allocation.Size = size;
+	return true;
+}
@@ -0,0 +1,223 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <VertexFormat.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// VERTEX_FORMAT_SSE2=0 forces the scalar encoder (which produces the same bytes)
+#if !defined(VERTEX_FORMAT_SSE2)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VERTEX_FORMAT_SSE2 1
+#else
+#define VERTEX_FORMAT_SSE2 0
+#endif
+#endif
+
+#if VERTEX_FORMAT_SSE2
+#include <emmintrin.h>
+#endif
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// Constant Values
+	//----------------------------------------------------------------------------------------------------
+	const float SnormMax = 32767.f; // R16_SNORM of 1.0
+	const float UnormMax = 255.f; // R8_UNORM of 1.0
+
+	//----------------------------------------------------------------------------------------------------
+	// input element of slot 0 style data
+	//----------------------------------------------------------------------------------------------------
+	GfxInputElementDesc PerVertexElement(const char* pSemantic, GfxFormat format, uint32_t inputSlot)
+	{
+		GfxInputElementDesc element = {};
+		element.SemanticName = pSemantic;
+		element.SemanticIndex = 0;
+		element.Format = format;
+		element.InputSlot = inputSlot;
+		element.AlignedByteOffset = GfxAppendAlignedElement;
+		element.InputSlotClass = GfxInputClassification::PerVertexData;
+		element.InstanceDataStepRate = 0;
+		return element;
+	}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// VertexFormat class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 input layout of the vertex layout
+//--------------------------------------------------------------------------------------------------------
+uint32_t VertexFormat::GetInputLayout(MeshVertexLayout layout, uint32_t inputSlot, GfxInputElementDesc* pElements)
+{
+	switch (layout)
+	{
+	case MeshVertexLayout::PositionColor:
+		pElements[0] = PerVertexElement("POSITION", GfxFormat::R32G32B32_Float, inputSlot);
+		pElements[1] = PerVertexElement("COLOR", GfxFormat::R32G32B32A32_Float, inputSlot);
+		return 2;
+
+	case MeshVertexLayout::PackedPositionColor:
+		// there is no 3 component 16-bit format, w is padding
+		pElements[0] = PerVertexElement("POSITION", GfxFormat::R16G16B16A16_Snorm, inputSlot);
+		pElements[1] = PerVertexElement("COLOR", GfxFormat::R8G8B8A8_Unorm, inputSlot);
+		return 2;
+
+	default:
+		return 0;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 center and half size of the bounds per axis
+//--------------------------------------------------------------------------------------------------------
+VertexQuantization VertexFormat::ComputeQuantization(const float boundsMin[3], const float boundsMax[3])
+{
+	VertexQuantization quantization = GetIdentityQuantization();
+	float* pScale = &quantization.Scale.x;
+	float* pOffset = &quantization.Offset.x;
+	for (uint32_t a = 0; a < 3; ++a)
+	{
+		// flat axes keep a unit scale so that encoding never divides by zero
+		float halfSize = 0.5f * (boundsMax[a] - boundsMin[a]);
+		pScale[a] = (halfSize > 0.f) ? halfSize : 1.f;
+		pOffset[a] = 0.5f * (boundsMax[a] + boundsMin[a]);
+	}
+	return quantization;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 dequantization which leaves positions unchanged
+//--------------------------------------------------------------------------------------------------------
+VertexQuantization VertexFormat::GetIdentityQuantization()
+{
+	VertexQuantization quantization;
+	quantization.Scale = DirectX::XMFLOAT4(1.f, 1.f, 1.f, 0.f);
+	quantization.Offset = DirectX::XMFLOAT4(0.f, 0.f, 0.f, 0.f);
+	return quantization;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 quantize positions and colors (round to nearest, out of range values are clamped)
+//--------------------------------------------------------------------------------------------------------
+void VertexFormat::Encode(const Vertex* pSource, uint32_t count, const VertexQuantization& quantization, PackedVertex* pDest)
+{
+	float invScale[3];
+	const float* pScale = &quantization.Scale.x;
+	for (uint32_t a = 0; a < 3; ++a)
+	{
+		invScale[a] = 1.f / pScale[a];
+	}
+
+	uint32_t i = 0;
+#if VERTEX_FORMAT_SSE2
+	// one vertex per iteration, the components are the lanes (lane 3 of the position is forced to 0)
+	const __m128 offset = _mm_setr_ps(quantization.Offset.x, quantization.Offset.y, quantization.Offset.z, 0.f);
+	const __m128 positionScale = _mm_setr_ps(invScale[0] * SnormMax, invScale[1] * SnormMax, invScale[2] * SnormMax, 0.f);
+	const __m128 snormMax = _mm_set1_ps(SnormMax);
+	const __m128 unormMax = _mm_set1_ps(UnormMax);
+	const __m128 zero = _mm_setzero_ps();
+	for (; i < count; ++i)
+	{
+		// Position and Color are adjacent, the 4th lane of the position load is the red component
+		__m128 position = _mm_loadu_ps(&pSource[i].Position.x);
+		__m128 color = _mm_loadu_ps(&pSource[i].Color.x);
+
+		position = _mm_mul_ps(_mm_sub_ps(position, offset), positionScale);
+		position = _mm_min_ps(_mm_max_ps(position, _mm_sub_ps(zero, snormMax)), snormMax);
+		__m128i position16 = _mm_packs_epi32(_mm_cvtps_epi32(position), _mm_setzero_si128());
+
+		color = _mm_mul_ps(_mm_min_ps(_mm_max_ps(color, zero), _mm_set1_ps(1.f)), unormMax);
+		__m128i color16 = _mm_packs_epi32(_mm_cvtps_epi32(color), _mm_setzero_si128());
+		__m128i color8 = _mm_packus_epi16(color16, _mm_setzero_si128());
+
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(pDest[i].Position), position16);
+		int32_t packedColor = _mm_cvtsi128_si32(color8);
+		memcpy(pDest[i].Color, &packedColor, sizeof(packedColor));
+	}
+#endif
+
+	// scalar path rounds like cvtps2dq (nearest even in the default rounding mode)
+	for (; i < count; ++i)
+	{
+		const float position[3] = { pSource[i].Position.x, pSource[i].Position.y, pSource[i].Position.z };
+		const float* pOffset = &quantization.Offset.x;
+		for (uint32_t a = 0; a < 3; ++a)
+		{
+			float value = (position[a] - pOffset[a]) * (invScale[a] * SnormMax);
+			value = std::min(std::max(value, -SnormMax), SnormMax);
+			pDest[i].Position[a] = static_cast<int16_t>(lrintf(value));
+		}
+		pDest[i].Position[3] = 0;
+
+		const float color[4] = { pSource[i].Color.x, pSource[i].Color.y, pSource[i].Color.z, pSource[i].Color.w };
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			float value = std::min(std::max(color[c], 0.f), 1.f) * UnormMax;
+			pDest[i].Color[c] = static_cast<uint8_t>(lrintf(value));
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 expand packed vertices the way the input assembler and SimpleVS.hlsl do
+//--------------------------------------------------------------------------------------------------------
+void VertexFormat::Decode(const PackedVertex* pSource, uint32_t count, const VertexQuantization& quantization, Vertex* pDest)
+{
+	const float* pScale = &quantization.Scale.x;
+	const float* pOffset = &quantization.Offset.x;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		float position[3];
+		for (uint32_t a = 0; a < 3; ++a)
+		{
+			// SNORM maps -32768 and -32767 both to -1
+			float snorm = std::max(float(pSource[i].Position[a]) / SnormMax, -1.f);
+			position[a] = snorm * pScale[a] + pOffset[a];
+		}
+
+		pDest[i].Position = DirectX::XMFLOAT3(position[0], position[1], position[2]);
+		pDest[i].Color = DirectX::XMFLOAT4(
+			float(pSource[i].Color[0]) / UnormMax,
+			float(pSource[i].Color[1]) / UnormMax,
+			float(pSource[i].Color[2]) / UnormMax,
+			float(pSource[i].Color[3]) / UnormMax);
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 difference between the original and the decoded vertices
+//--------------------------------------------------------------------------------------------------------
+VertexQuantizationError VertexFormat::MeasureError(const Vertex* pOriginal, const PackedVertex* pEncoded, uint32_t count, const VertexQuantization& quantization)
+{
+	VertexQuantizationError error = {};
+	double sumSquared = 0.0;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		Vertex decoded;
+		Decode(&pEncoded[i], 1, quantization, &decoded);
+
+		float dx = decoded.Position.x - pOriginal[i].Position.x;
+		float dy = decoded.Position.y - pOriginal[i].Position.y;
+		float dz = decoded.Position.z - pOriginal[i].Position.z;
+		float distanceSq = dx * dx + dy * dy + dz * dz;
+		error.MaxPosition = std::max(error.MaxPosition, sqrtf(distanceSq));
+		sumSquared += distanceSq;
+
+		const float* pDecodedColor = &decoded.Color.x;
+		const float* pOriginalColor = &pOriginal[i].Color.x;
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			error.MaxColor = std::max(error.MaxColor, fabsf(pDecodedColor[c] - pOriginalColor[c]));
+		}
+	}
+
+	error.RmsPosition = (count > 0) ? float(sqrt(sumSquared / count)) : 0.f;
+	return error;
+}
@@ -0,0 +1,176 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <WorkerPool.h>
+#include <Profiler.h>
+#include <string>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// WorkerPool class
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------------------------
+//	 constructor
+//--------------------------------------------------------------------------------------------------------
+WorkerPool::WorkerPool()
+	: m_pJob(nullptr)
+	, m_JobCount(0)
+	, m_NextJob(0)
+	, m_BusyThreads(0)
+	, m_Generation(0)
+	, m_Quit(false)
+{
+	/* DO_NOTHING */
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 destructor
+//--------------------------------------------------------------------------------------------------------
+WorkerPool::~WorkerPool()
+{
+	Term();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 initialization
+//--------------------------------------------------------------------------------------------------------
+bool WorkerPool::Init(uint32_t workerCount)
+{
+	if (workerCount == 0)
+	{
+		return false;
+	}
+
+	Term();
+
+	// helpers start at generation 0, so they only wake for the next dispatch
+	m_Quit = false;
+	m_Generation = 0;
+	m_Threads.reserve(workerCount - 1);
+	for (uint32_t i = 1; i < workerCount; ++i)
+	{
+		m_Threads.emplace_back(&WorkerPool::ThreadMain, this, i);
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 termination
+//--------------------------------------------------------------------------------------------------------
+void WorkerPool::Term()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Quit = true;
+	}
+	m_WakeCondition.notify_all();
+
+	for (std::thread& thread : m_Threads)
+	{
+		thread.join();
+	}
+	m_Threads.clear();
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 run jobs on every worker
+//--------------------------------------------------------------------------------------------------------
+void WorkerPool::Dispatch(uint32_t jobCount, const Job& job)
+{
+	if (jobCount == 0)
+	{
+		return;
+	}
+
+	// nobody to share with
+	if (m_Threads.empty() || jobCount == 1)
+	{
+		for (uint32_t i = 0; i < jobCount; ++i)
+		{
+			job(i, 0);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_pJob = &job;
+		m_JobCount = jobCount;
+		m_NextJob.store(0, std::memory_order_relaxed);
+		m_BusyThreads = static_cast<uint32_t>(m_Threads.size());
+		m_Generation++;
+	}
+	m_WakeCondition.notify_all();
+
+	RunJobs(job, jobCount, 0);
+
+	// helpers may still hold a reference to the job
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_DoneCondition.wait(lock, [this] { return m_BusyThreads == 0; });
+	m_pJob = nullptr;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 number of hardware threads
+//--------------------------------------------------------------------------------------------------------
+uint32_t WorkerPool::GetHardwareWorkerCount()
+{
+	uint32_t count = std::thread::hardware_concurrency();
+	return (count > 0) ? count : 1;
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 helper thread
+//--------------------------------------------------------------------------------------------------------
+void WorkerPool::ThreadMain(uint32_t workerIndex)
+{
+	Profiler::SetThreadName(("Worker " + std::to_string(workerIndex)).c_str());
+	uint64_t generation = 0;
+
+	for (;;)
+	{
+		const Job* pJob = nullptr;
+		uint32_t jobCount = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WakeCondition.wait(lock, [&] { return m_Quit || m_Generation != generation; });
+			if (m_Quit)
+			{
+				return;
+			}
+
+			generation = m_Generation;
+			pJob = m_pJob;
+			jobCount = m_JobCount;
+		}
+
+		RunJobs(*pJob, jobCount, workerIndex);
+
+		bool last = false;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			last = (--m_BusyThreads == 0);
+		}
+		if (last)
+		{
+			m_DoneCondition.notify_one();
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------------
+//	 pick jobs until none is left
+//--------------------------------------------------------------------------------------------------------
+void WorkerPool::RunJobs(const Job& job, uint32_t jobCount, uint32_t workerIndex)
+{
+	for (;;)
+	{
+		uint32_t index = m_NextJob.fetch_add(1, std::memory_order_relaxed);
+		if (index >= jobCount)
+		{
+			return;
+		}
+		job(index, workerIndex);
+	}
+}
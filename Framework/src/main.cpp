@@ -2,16 +2,195 @@
 // Includes
 //--------------------------------------------------------
 #include "App.h"
+#include <Profiler.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <string>
+#if defined(_WIN32)
+#include <crtdbg.h>
+#endif
 
+namespace /* anonymous */ {
+
+	const uint32_t DefaultHeadlessFrames = 1000; // frames rendered by headless run
+	const uint32_t DefaultQuadCount = 1; // quads drawn per frame
+	const uint32_t DefaultFramesInFlight = 2; // frames the CPU may run ahead of the GPU
+
+	//----------------------------------------------------
+	// run the frame loop on the recording backend
+	//----------------------------------------------------
+	int RunHeadless(uint32_t frameCount, uint32_t quadCount, bool instancing, const char* pMeshPath, uint32_t framesInFlight, const char* pTracePath)
+	{
+		// the trace covers startup as well
+		if (pTracePath != nullptr)
+		{
+			Profiler::SetThreadName("Main");
+			Profiler::SetEnabled(true);
+		}
+
+		App app(960, 540, GfxBackend::Recording, quadCount, instancing, pMeshPath, framesInFlight);
+
+		// timings of an App which didn't come up would be meaningless
+		auto begin = std::chrono::steady_clock::now();
+		if (!app.Run(frameCount))
+		{
+			printf("headless: initialization failed\n");
+			return 1;
+		}
+		auto end = std::chrono::steady_clock::now();
+
+		double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+		printf("headless: %u frames, %u quads %s, %.3f ms (%.3f us/frame)\n",
+			frameCount, quadCount, instancing ? "instanced" : "per draw",
+			ms, (frameCount > 0) ? ms * 1000.0 / frameCount : 0.0);
+
+		PipelineCacheStats pipelines = app.GetPipelineStats();
+		printf("pipelines: %llu requested, %llu hits, %llu loaded from library, %llu compiled (%.3f ms max), %llu hitches\n",
+			static_cast<unsigned long long>(pipelines.RequestCount),
+			static_cast<unsigned long long>(pipelines.HitCount),
+			static_cast<unsigned long long>(pipelines.LibraryLoadCount),
+			static_cast<unsigned long long>(pipelines.CompileCount),
+			pipelines.MaxCompileMs,
+			static_cast<unsigned long long>(pipelines.HitchCount));
+
+		FrameTimelineStats timeline = app.GetFrameStats();
+		printf("frames in flight: %u, %llu stalls (%.3f ms, %.3f ms max), %llu flushes\n",
+			app.GetFramesInFlight(),
+			static_cast<unsigned long long>(timeline.StallCount),
+			timeline.StallMs,
+			timeline.MaxStallMs,
+			static_cast<unsigned long long>(timeline.FlushCount));
+
+		GpuProfilerStats gpu = app.GetGpuStats();
+		printf("gpu timestamps: %llu frames, %llu regions (%llu dropped), %.3f ms last frame\n",
+			static_cast<unsigned long long>(gpu.FrameCount),
+			static_cast<unsigned long long>(gpu.RegionCount),
+			static_cast<unsigned long long>(gpu.DroppedCount),
+			gpu.LastFrameMs);
+
+		ResourceBarrierStats barriers = app.GetBarrierStats();
+		printf("barriers: %llu in %llu batches, %llu elided, %llu fix-ups (last frame)\n",
+			static_cast<unsigned long long>(barriers.BarrierCount),
+			static_cast<unsigned long long>(barriers.BatchCount),
+			static_cast<unsigned long long>(barriers.ElidedCount),
+			static_cast<unsigned long long>(barriers.FixupCount));
+
+		UploadStats uploads = app.GetUploadStats();
+		printf("uploads: %llu KB in %llu copies, %llu batches, %llu sync points (%.3f per frame), %llu stalls (%.3f ms)\n",
+			static_cast<unsigned long long>(uploads.UploadedBytes / 1024),
+			static_cast<unsigned long long>(uploads.CopyCount),
+			static_cast<unsigned long long>(uploads.BatchCount),
+			static_cast<unsigned long long>(uploads.SyncCount),
+			(frameCount > 0) ? static_cast<double>(uploads.SyncCount) / frameCount : 0.0,
+			static_cast<unsigned long long>(uploads.StallCount),
+			uploads.StallMs);
+
+		DescriptorPoolStats descriptors = app.GetDescriptorStats();
+		printf("descriptors: %u RTVs allocated (%u peak), capacity %u, pages %u, fragmentation %.2f\n",
+			descriptors.Allocated,
+			descriptors.PeakAllocated,
+			descriptors.Capacity,
+			descriptors.PageCount,
+			descriptors.Fragmentation);
+
+		LinearRingStats ring = app.GetUploadRingStats();
+		printf("upload ring: %.1f KB per frame (%.1f KB peak), %llu failed allocations\n",
+			ring.GetAverageFrameUnits() / 1024.0,
+			static_cast<double>(ring.PeakFrameUnits) / 1024.0,
+			static_cast<unsigned long long>(ring.FailedAllocations));
+
+		StreamStats streaming = app.GetStreamStats();
+		if (streaming.RequestCount > 0)
+		{
+			printf("streaming: %llu of %llu assets (%llu KB), read %.3f ms, decode %.3f ms, first visible after %.3f ms\n",
+				static_cast<unsigned long long>(streaming.DeliveredCount),
+				static_cast<unsigned long long>(streaming.RequestCount),
+				static_cast<unsigned long long>(streaming.DeliveredBytes / 1024),
+				streaming.ReadMs,
+				streaming.DecodeMs,
+				streaming.MaxVisibleMs);
+		}
+
+		if (pTracePath != nullptr)
+		{
+			Profiler::SetEnabled(false);
+			if (!Profiler::WriteChromeTrace(pTracePath))
+			{
+				printf("trace: cannot write %s\n", pTracePath);
+				return 1;
+			}
+			printf("trace: %llu events (%llu dropped) written to %s\n",
+				static_cast<unsigned long long>(Profiler::GetEventCount()),
+				static_cast<unsigned long long>(Profiler::GetDroppedCount()),
+				pTracePath);
+		}
+
+		return 0;
+	}
+
+#if defined(_WIN32)
+	//----------------------------------------------------
+	// path argument for the narrow file APIs
+	//----------------------------------------------------
+	std::string NarrowPath(const wchar_t* pPath)
+	{
+		int size = WideCharToMultiByte(CP_ACP, 0, pPath, -1, nullptr, 0, nullptr, nullptr);
+		if (size <= 1)
+		{
+			return std::string();
+		}
+
+		std::string path(static_cast<size_t>(size), '\0');
+		WideCharToMultiByte(CP_ACP, 0, pPath, -1, &path[0], size, nullptr, nullptr);
+		path.resize(static_cast<size_t>(size - 1));
+		return path;
+	}
+#endif
+
+} // namespace /* anonymous */
+
+#if defined(_WIN32)
 int wmain(int argc, wchar_t** argv, wchar_t** envp)
 {
 #if defined(DEBUG) || defined(_DEBUG)
 	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
 #endif // defined(DEBUG) || defined(_DEBUG)
 
-	// run application
-	App app(960, 540);
-	app.Run();
+	// "-headless [frames] [quads] [instancing] [mesh|-] [frames in flight] [trace.json]" runs without window on the recording backend
+	if (argc > 1 && wcscmp(argv[1], L"-headless") == 0)
+	{
+		uint32_t frames = (argc > 2) ? static_cast<uint32_t>(wcstoul(argv[2], nullptr, 10)) : DefaultHeadlessFrames;
+		uint32_t quads = (argc > 3) ? static_cast<uint32_t>(wcstoul(argv[3], nullptr, 10)) : DefaultQuadCount;
+		bool instancing = (argc > 4) ? wcstoul(argv[4], nullptr, 10) != 0 : true;
+		std::string mesh = (argc > 5 && wcscmp(argv[5], L"-") != 0) ? NarrowPath(argv[5]) : std::string();
+		uint32_t framesInFlight = (argc > 6) ? static_cast<uint32_t>(wcstoul(argv[6], nullptr, 10)) : DefaultFramesInFlight;
+		std::string trace = (argc > 7) ? NarrowPath(argv[7]) : std::string();
+		return RunHeadless(frames, quads, instancing, mesh.empty() ? nullptr : mesh.c_str(), framesInFlight, trace.empty() ? nullptr : trace.c_str());
+	}
+
+	// "[quads] [instancing] [mesh|-] [frames in flight]" sets the scene of the window
+	uint32_t quads = (argc > 1) ? static_cast<uint32_t>(wcstoul(argv[1], nullptr, 10)) : DefaultQuadCount;
+	bool instancing = (argc > 2) ? wcstoul(argv[2], nullptr, 10) != 0 : true;
+	std::string mesh = (argc > 3 && wcscmp(argv[3], L"-") != 0) ? NarrowPath(argv[3]) : std::string();
+	uint32_t framesInFlight = (argc > 4) ? static_cast<uint32_t>(wcstoul(argv[4], nullptr, 10)) : DefaultFramesInFlight;
 
-	return 0;
-}
\ No newline at end of file
+	// run application
+	App app(960, 540, GetDefaultGfxBackend(), quads, instancing, mesh.empty() ? nullptr : mesh.c_str(), framesInFlight);
+	return app.Run() ? 0 : 1;
+}
+#else
+int main(int argc, char** argv)
+{
+	// there is no window on this platform, always run headless ("[frames] [quads] [instancing] [mesh|-] [frames in flight] [trace.json]")
+	uint32_t frames = (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : DefaultHeadlessFrames;
+	uint32_t quads = (argc > 2) ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : DefaultQuadCount;
+	bool instancing = (argc > 3) ? strtoul(argv[3], nullptr, 10) != 0 : true;
+	const char* pMeshPath = (argc > 4 && strcmp(argv[4], "-") != 0) ? argv[4] : nullptr;
+	uint32_t framesInFlight = (argc > 5) ? static_cast<uint32_t>(strtoul(argv[5], nullptr, 10)) : DefaultFramesInFlight;
+	const char* pTracePath = (argc > 6) ? argv[6] : nullptr;
+	return RunHeadless(frames, quads, instancing, pMeshPath, framesInFlight, pTracePath);
+}
+#endif
@@ -0,0 +1,113 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <AssetArchive.h>
+#include <WorkerPool.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// whole file into memory
+	//----------------------------------------------------------------------------------------------------
+	bool ReadFile(const char* path, std::vector<uint8_t>& data)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			return false;
+		}
+
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0, std::ios::beg);
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())));
+	}
+
+} // namespace /* anonymous */
+
+
+//--------------------------------------------------------------------------------------------------------
+//	 pack files into one archive ("path=file" names an asset, a plain file is named by its path; files after
+//	 -s are stored uncompressed for zero-copy reads, files after -c are compressed again)
+//--------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		printf("usage: %s <output> [-s|-c] <[path=]file>...\n", argv[0]);
+		return 1;
+	}
+	const char* pOutput = argv[1];
+
+	std::vector<std::string> paths;
+	std::vector<std::vector<uint8_t>> contents;
+	std::vector<bool> compress;
+	bool compressNext = true;
+	for (int i = 2; i < argc; ++i)
+	{
+		const char* pArg = argv[i];
+		if (strcmp(pArg, "-s") == 0 || strcmp(pArg, "-c") == 0)
+		{
+			compressNext = pArg[1] == 'c';
+			continue;
+		}
+
+		const char* pEqual = strchr(pArg, '=');
+		const char* pFile = (pEqual != nullptr) ? pEqual + 1 : pArg;
+		paths.push_back((pEqual != nullptr) ? std::string(pArg, pEqual) : std::string(pArg));
+		contents.emplace_back();
+		compress.push_back(compressNext);
+		if (!ReadFile(pFile, contents.back()))
+		{
+			printf("error: cannot open %s\n", pFile);
+			return 1;
+		}
+	}
+
+	uint32_t count = static_cast<uint32_t>(paths.size());
+	std::vector<AssetArchiveSource> sources(count);
+	uint64_t looseSize = 0;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		sources[i] = { paths[i].c_str(), contents[i].data(), contents[i].size(), compress[i] };
+		looseSize += contents[i].size();
+	}
+
+	// chunks are compressed on every hardware thread
+	WorkerPool pool;
+	pool.Init(WorkerPool::GetHardwareWorkerCount());
+	auto begin = std::chrono::steady_clock::now();
+	bool written = AssetArchive::Write(pOutput, sources.data(), count, &pool);
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	pool.Term();
+	if (!written)
+	{
+		printf("error: cannot write %s (colliding asset paths?)\n", pOutput);
+		return 1;
+	}
+
+	AssetArchive archive;
+	if (!archive.Open(pOutput))
+	{
+		printf("error: %s doesn't read back\n", pOutput);
+		return 1;
+	}
+
+	uint32_t compressedCount = 0;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const AssetArchiveEntry* pEntry = archive.Find(paths[i].c_str());
+		compressedCount += (pEntry != nullptr && pEntry->ChunkCount > 0) ? 1 : 0;
+	}
+
+	printf("%s: %u assets (%u compressed in %u chunks), %llu bytes loose, %llu bytes packed (%.1f%%) in %.1f ms\n",
+		pOutput, count, compressedCount, archive.GetChunkCount(), static_cast<unsigned long long>(looseSize),
+		static_cast<unsigned long long>(archive.GetFileSize()), (looseSize > 0) ? 100.0 * archive.GetFileSize() / looseSize : 0.0, ms);
+	return 0;
+}
@@ -0,0 +1,332 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <MeshFile.h>
+#include <MeshOptimizer.h>
+#include <ShaderTypes.h>
+#include <VertexFormat.h>
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	// ObjMesh structure - contents of an OBJ file
+	//////////////////////////////////////////////////////////////////////////////////////////////////////
+	struct ObjMesh
+	{
+		std::vector<Vertex> Vertices; // "v" lines (colors of the common "v x y z r g b" extension)
+		std::vector<uint32_t> Indices; // triangle list
+		std::vector<MeshFileSubmesh> Submeshes; // one per "g", "o" or "usemtl" block with faces
+	};
+
+	//----------------------------------------------------------------------------------------------------
+	// line starts with the keyword followed by white space
+	//----------------------------------------------------------------------------------------------------
+	bool IsKeyword(const char* pLine, const char* pKeyword)
+	{
+		size_t length = strlen(pKeyword);
+		return strncmp(pLine, pKeyword, length) == 0 && (pLine[length] == ' ' || pLine[length] == '\t');
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// close the current submesh if it has faces
+	//----------------------------------------------------------------------------------------------------
+	void EndSubmesh(ObjMesh& mesh)
+	{
+		MeshFileSubmesh& submesh = mesh.Submeshes.back();
+		submesh.IndexCount = static_cast<uint32_t>(mesh.Indices.size()) - submesh.IndexStart;
+		if (submesh.IndexCount > 0)
+		{
+			mesh.Submeshes.push_back(MeshFileSubmesh());
+			mesh.Submeshes.back().IndexStart = static_cast<uint32_t>(mesh.Indices.size());
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// parse "v", "f", "g", "o" and "usemtl" lines, everything else is skipped
+	//----------------------------------------------------------------------------------------------------
+	bool ParseObj(const char* path, ObjMesh& mesh)
+	{
+		std::ifstream file(path);
+		if (!file)
+		{
+			printf("error: cannot open %s\n", path);
+			return false;
+		}
+
+		mesh = ObjMesh();
+		mesh.Submeshes.push_back(MeshFileSubmesh());
+
+		std::string line;
+		std::vector<uint32_t> polygon;
+		uint32_t lineNumber = 0;
+		while (std::getline(file, line))
+		{
+			lineNumber++;
+			const char* p = line.c_str();
+			while (*p == ' ' || *p == '\t')
+			{
+				p++;
+			}
+
+			if (IsKeyword(p, "v"))
+			{
+				float values[7] = { 0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f };
+				char* pEnd = const_cast<char*>(p + 1);
+				uint32_t count = 0;
+				while (count < 7)
+				{
+					char* pNext = nullptr;
+					float value = strtof(pEnd, &pNext);
+					if (pNext == pEnd)
+					{
+						break;
+					}
+					values[count++] = value;
+					pEnd = pNext;
+				}
+
+				if (count < 3)
+				{
+					printf("error: %s(%u): vertex needs three coordinates\n", path, lineNumber);
+					return false;
+				}
+
+				// "x y z w" is a homogeneous position, "x y z r g b" carries a color
+				Vertex vertex;
+				vertex.Position = DirectX::XMFLOAT3(values[0], values[1], values[2]);
+				vertex.Color = (count >= 6)
+					? DirectX::XMFLOAT4(values[3], values[4], values[5], (count == 7) ? values[6] : 1.f)
+					: DirectX::XMFLOAT4(1.f, 1.f, 1.f, 1.f);
+				mesh.Vertices.push_back(vertex);
+			}
+			else if (IsKeyword(p, "f"))
+			{
+				// "i", "i/t", "i//n" and "i/t/n", only the position index is used
+				polygon.clear();
+				char* pEnd = const_cast<char*>(p + 1);
+				for (;;)
+				{
+					char* pNext = nullptr;
+					long index = strtol(pEnd, &pNext, 10);
+					if (pNext == pEnd)
+					{
+						break;
+					}
+
+					// negative indices count back from the last vertex
+					long vertexCount = static_cast<long>(mesh.Vertices.size());
+					long resolved = (index < 0) ? vertexCount + index : index - 1;
+					if (index == 0 || resolved < 0 || resolved >= vertexCount)
+					{
+						printf("error: %s(%u): vertex index %ld out of range\n", path, lineNumber, index);
+						return false;
+					}
+					polygon.push_back(static_cast<uint32_t>(resolved));
+
+					pEnd = pNext;
+					while (*pEnd != '\0' && *pEnd != ' ' && *pEnd != '\t')
+					{
+						pEnd++;
+					}
+				}
+
+				if (polygon.size() < 3)
+				{
+					printf("error: %s(%u): face needs three vertices\n", path, lineNumber);
+					return false;
+				}
+
+				// triangle fan (faces are expected to be convex)
+				for (size_t i = 2; i < polygon.size(); ++i)
+				{
+					mesh.Indices.push_back(polygon[0]);
+					mesh.Indices.push_back(polygon[i - 1]);
+					mesh.Indices.push_back(polygon[i]);
+				}
+			}
+			else if (IsKeyword(p, "g") || IsKeyword(p, "o") || IsKeyword(p, "usemtl"))
+			{
+				EndSubmesh(mesh);
+			}
+		}
+
+		// drop the trailing empty submesh
+		EndSubmesh(mesh);
+		mesh.Submeshes.pop_back();
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// bounds of the positions referenced by each submesh and of the whole mesh
+	//----------------------------------------------------------------------------------------------------
+	void ComputeBounds(ObjMesh& mesh, float boundsMin[3], float boundsMax[3])
+	{
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			boundsMin[i] = mesh.Vertices.empty() ? 0.f : FLT_MAX;
+			boundsMax[i] = mesh.Vertices.empty() ? 0.f : -FLT_MAX;
+		}
+
+		for (const Vertex& vertex : mesh.Vertices)
+		{
+			const float position[3] = { vertex.Position.x, vertex.Position.y, vertex.Position.z };
+			for (uint32_t i = 0; i < 3; ++i)
+			{
+				boundsMin[i] = std::min(boundsMin[i], position[i]);
+				boundsMax[i] = std::max(boundsMax[i], position[i]);
+			}
+		}
+
+		for (MeshFileSubmesh& submesh : mesh.Submeshes)
+		{
+			for (uint32_t i = 0; i < 3; ++i)
+			{
+				submesh.BoundsMin[i] = FLT_MAX;
+				submesh.BoundsMax[i] = -FLT_MAX;
+			}
+
+			for (uint32_t j = 0; j < submesh.IndexCount; ++j)
+			{
+				const Vertex& vertex = mesh.Vertices[mesh.Indices[submesh.IndexStart + j]];
+				const float position[3] = { vertex.Position.x, vertex.Position.y, vertex.Position.z };
+				for (uint32_t i = 0; i < 3; ++i)
+				{
+					submesh.BoundsMin[i] = std::min(submesh.BoundsMin[i], position[i]);
+					submesh.BoundsMax[i] = std::max(submesh.BoundsMax[i], position[i]);
+				}
+			}
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// print the cache and fetch behavior of the index buffer
+	//----------------------------------------------------------------------------------------------------
+	void PrintStats(const char* pLabel, MeshOptimizer& optimizer, const ObjMesh& mesh)
+	{
+		uint32_t indexCount = static_cast<uint32_t>(mesh.Indices.size());
+		uint32_t vertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+		VertexCacheStats cache = optimizer.AnalyzeVertexCache(mesh.Indices.data(), indexCount, vertexCount);
+		VertexFetchStats fetch = optimizer.AnalyzeVertexFetch(mesh.Indices.data(), indexCount, vertexCount, sizeof(Vertex));
+		printf("%-10s ACMR %.3f  ATVR %.3f  overfetch %.3f\n", pLabel, cache.ACMR, cache.ATVR, fetch.Overfetch);
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// reorder the triangles of every submesh, then the shared vertices
+	//----------------------------------------------------------------------------------------------------
+	void OptimizeMesh(MeshOptimizer& optimizer, ObjMesh& mesh)
+	{
+		uint32_t vertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+		for (const MeshFileSubmesh& submesh : mesh.Submeshes)
+		{
+			uint32_t* pIndices = mesh.Indices.data() + submesh.IndexStart;
+			optimizer.OptimizeVertexCache(pIndices, submesh.IndexCount, vertexCount);
+			optimizer.OptimizeOverdraw(pIndices, submesh.IndexCount, &mesh.Vertices[0].Position.x, sizeof(Vertex), vertexCount);
+		}
+
+		vertexCount = optimizer.OptimizeVertexFetch(mesh.Vertices.data(), vertexCount, sizeof(Vertex), mesh.Indices.data(), static_cast<uint32_t>(mesh.Indices.size()));
+		mesh.Vertices.resize(vertexCount);
+	}
+
+} // namespace /* anonymous */
+
+//--------------------------------------------------------------------------------------------------------
+// "MeshConverter [-noopt] [-packed] <input.obj> <output.mesh>" converts an OBJ file to the binary mesh
+// format of MeshFile, optimized for the vertex cache, overdraw and vertex fetch unless -noopt is given,
+// with 12 byte PackedVertex vertices when -packed is given
+//--------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	bool optimize = true;
+	bool packed = false;
+	int first = 1;
+	for (; first < argc && argv[first][0] == '-'; ++first)
+	{
+		optimize &= strcmp(argv[first], "-noopt") != 0;
+		packed |= strcmp(argv[first], "-packed") == 0;
+	}
+
+	if (argc < first + 2)
+	{
+		printf("usage: %s [-noopt] [-packed] <input.obj> <output.mesh>\n", argv[0]);
+		return 1;
+	}
+	const char* pInput = argv[first];
+	const char* pOutput = argv[first + 1];
+
+	ObjMesh mesh;
+	if (!ParseObj(pInput, mesh))
+	{
+		return 1;
+	}
+
+	if (mesh.Indices.empty())
+	{
+		printf("error: %s has no faces\n", pInput);
+		return 1;
+	}
+
+	MeshOptimizer optimizer;
+	if (optimize)
+	{
+		PrintStats("input", optimizer, mesh);
+		OptimizeMesh(optimizer, mesh);
+		PrintStats("optimized", optimizer, mesh);
+	}
+
+	// 16-bit indices whenever every vertex can be addressed
+	std::vector<uint16_t> indices16;
+	bool use16Bit = MeshOptimizer::Fits16BitIndices(static_cast<uint32_t>(mesh.Vertices.size()));
+	if (use16Bit)
+	{
+		indices16.resize(mesh.Indices.size());
+		MeshOptimizer::Convert16BitIndices(mesh.Indices.data(), static_cast<uint32_t>(mesh.Indices.size()), indices16.data());
+	}
+
+	MeshFileDesc desc = {};
+	ComputeBounds(mesh, desc.BoundsMin, desc.BoundsMax);
+	desc.VertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+	desc.StreamCount = 1;
+	desc.pStreams[0] = mesh.Vertices.data();
+	desc.Strides[0] = sizeof(Vertex);
+	desc.Layouts[0] = MeshVertexLayout::PositionColor;
+
+	// positions relative to the bounds of the file, which is how the loader gets the dequantization back
+	std::vector<PackedVertex> packedVertices;
+	if (packed)
+	{
+		VertexQuantization quantization = VertexFormat::ComputeQuantization(desc.BoundsMin, desc.BoundsMax);
+		packedVertices.resize(mesh.Vertices.size());
+		VertexFormat::Encode(mesh.Vertices.data(), desc.VertexCount, quantization, packedVertices.data());
+
+		VertexQuantizationError error = VertexFormat::MeasureError(mesh.Vertices.data(), packedVertices.data(), desc.VertexCount, quantization);
+		printf("packed     position error max %g rms %g, color error max %g\n", error.MaxPosition, error.RmsPosition, error.MaxColor);
+
+		desc.pStreams[0] = packedVertices.data();
+		desc.Strides[0] = sizeof(PackedVertex);
+		desc.Layouts[0] = MeshVertexLayout::PackedPositionColor;
+	}
+	desc.pIndices = use16Bit ? static_cast<const void*>(indices16.data()) : mesh.Indices.data();
+	desc.IndexCount = static_cast<uint32_t>(mesh.Indices.size());
+	desc.IndexFormat = use16Bit ? GfxFormat::R16_Uint : GfxFormat::R32_Uint;
+	desc.pSubmeshes = mesh.Submeshes.data();
+	desc.SubmeshCount = static_cast<uint32_t>(mesh.Submeshes.size());
+
+	if (!MeshFile::Write(pOutput, desc))
+	{
+		printf("error: cannot write %s\n", pOutput);
+		return 1;
+	}
+
+	printf("%s: %u vertices (%u bytes each), %u triangles, %u submeshes, %s indices\n",
+		pOutput, desc.VertexCount, desc.Strides[0], desc.IndexCount / 3, desc.SubmeshCount, use16Bit ? "16-bit" : "32-bit");
+	return 0;
+}
@@ -0,0 +1,105 @@
+//--------------------------------------------------------------------------------------------------------
+// Includes
+//--------------------------------------------------------------------------------------------------------
+#include <ShaderStore.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+	//----------------------------------------------------------------------------------------------------
+	// whole file into memory
+	//----------------------------------------------------------------------------------------------------
+	bool ReadFile(const char* path, std::vector<uint8_t>& data)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			return false;
+		}
+
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0, std::ios::beg);
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())));
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// file name without directory and extension ("../out/SimpleVS.cso" -> "SimpleVS")
+	//----------------------------------------------------------------------------------------------------
+	std::string GetStem(const char* path)
+	{
+		std::string name(path);
+		size_t slash = name.find_last_of("/\\");
+		if (slash != std::string::npos)
+		{
+			name.erase(0, slash + 1);
+		}
+
+		size_t dot = name.find_last_of('.');
+		if (dot != std::string::npos && dot > 0)
+		{
+			name.erase(dot);
+		}
+		return name;
+	}
+
+} // namespace /* anonymous */
+
+
+//--------------------------------------------------------------------------------------------------------
+//	 pack compiled shaders into one file ("name=file" names a permutation, a plain file is named by its stem)
+//--------------------------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		printf("usage: %s <output> <[name=]shader.cso>...\n", argv[0]);
+		return 1;
+	}
+	const char* pOutput = argv[1];
+
+	uint32_t count = static_cast<uint32_t>(argc - 2);
+	std::vector<std::string> names(count);
+	std::vector<std::vector<uint8_t>> blobs(count);
+	std::vector<ShaderStoreSource> sources(count);
+	uint64_t looseSize = 0;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const char* pArg = argv[i + 2];
+		const char* pEqual = strchr(pArg, '=');
+		const char* pPath = (pEqual != nullptr) ? pEqual + 1 : pArg;
+		names[i] = (pEqual != nullptr) ? std::string(pArg, pEqual) : GetStem(pArg);
+
+		if (!ReadFile(pPath, blobs[i]))
+		{
+			printf("error: cannot open %s\n", pPath);
+			return 1;
+		}
+
+		sources[i].pName = names[i].c_str();
+		sources[i].pBytecode = blobs[i].data();
+		sources[i].Size = blobs[i].size();
+		looseSize += blobs[i].size();
+	}
+
+	if (!ShaderStore::Write(pOutput, sources.data(), count))
+	{
+		printf("error: cannot write %s (duplicate permutation names?)\n", pOutput);
+		return 1;
+	}
+
+	ShaderStore store;
+	if (!store.Open(pOutput))
+	{
+		printf("error: %s doesn't read back\n", pOutput);
+		return 1;
+	}
+
+	printf("%s: %u permutations, %u distinct blobs, %llu bytes of bytecode\n",
+		pOutput, store.GetEntryCount(), store.GetBlobCount(), static_cast<unsigned long long>(looseSize));
+	return 0;
+}